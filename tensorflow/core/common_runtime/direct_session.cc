@@ -61,6 +61,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/costmodel.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_partition.h"
 #include "tensorflow/core/graph/subgraph.h"
@@ -406,6 +407,12 @@ DirectSession::DirectSession(const SessionOptions& options,
   if (!status.ok()) {
     LOG(ERROR) << status.message();
   }
+  const absl::Status priority_status =
+      ReadBoolFromEnvVar("TF_EXECUTOR_PRIORITIZE_CRITICAL_PATH", false,
+                         &prioritize_critical_path_);
+  if (!priority_status.ok()) {
+    LOG(ERROR) << priority_status.message();
+  }
   session_handle_ =
       absl::StrCat("direct", strings::FpToString(random::New64()));
   if (options.config.log_device_placement()) {
@@ -878,6 +885,9 @@ absl::Status DirectSession::RunInternal(
 
     mutex_lock l(executor_lock_);
     run_state.collector->BuildCostModel(&cost_model_manager_, device_to_graph);
+    if (prioritize_critical_path_) {
+      RecordMeasuredNodeCosts(*executors_and_keys);
+    }
 
     if (run_metadata != nullptr) {
       // annotate stats onto cost graph.
@@ -1476,6 +1486,7 @@ absl::Status DirectSession::CreateExecutors(
     params.device = device;
     params.session_metadata = session_metadata;
     params.function_library = lib;
+    params.prioritize_critical_path = prioritize_critical_path_;
     auto opseg = device->op_segment();
     params.create_kernel =
         [this, lib, opseg](const std::shared_ptr<const NodeProperties>& props,
@@ -1518,6 +1529,11 @@ absl::Status DirectSession::CreateExecutors(
 
     item->executor = nullptr;
     item->device = device;
+    std::unique_ptr<CostModel> cost_model;
+    if (prioritize_critical_path_) {
+      cost_model = MeasuredCostModel(device->name(), *partition_graph);
+      params.cost_model = cost_model.get();
+    }
     auto executor_type = options_.config.experimental().executor_type();
     TF_RETURN_IF_ERROR(
         NewExecutor(executor_type, params, *partition_graph, &item->executor));
@@ -1565,6 +1581,41 @@ absl::Status DirectSession::CreateExecutors(
   return absl::OkStatus();
 }
 
+void DirectSession::RecordMeasuredNodeCosts(
+    const ExecutorsAndKeys& executors_and_keys) {
+  for (const PerPartitionExecutorsAndLib& partition :
+       executors_and_keys.items) {
+    const Graph* graph = partition.graph.get();
+    const CostModel* cost_model =
+        cost_model_manager_.FindOrCreateCostModel(graph);
+    auto& node_costs = measured_node_costs_[partition.flib->device()->name()];
+    for (const Node* n : graph->op_nodes()) {
+      if (cost_model->TotalCount(n) > 0) {
+        node_costs[n->name()] = cost_model->TimeEstimate(n);
+      }
+    }
+  }
+}
+
+std::unique_ptr<CostModel> DirectSession::MeasuredCostModel(
+    const std::string& device, const Graph& graph) {
+  mutex_lock l(executor_lock_);
+  auto it = measured_node_costs_.find(device);
+  if (it == measured_node_costs_.end()) {
+    return nullptr;
+  }
+  auto cost_model = std::make_unique<CostModel>(/*is_global=*/false);
+  cost_model->InitFromGraph(graph);
+  for (const Node* n : graph.op_nodes()) {
+    auto cost = it->second.find(n->name());
+    if (cost != it->second.end()) {
+      cost_model->RecordCount(n, 1);
+      cost_model->RecordTime(n, cost->second);
+    }
+  }
+  return cost_model;
+}
+
 absl::Status DirectSession::GetOrCreateExecutors(
     absl::Span<const std::string> inputs, absl::Span<const std::string> outputs,
     absl::Span<const std::string> target_nodes,
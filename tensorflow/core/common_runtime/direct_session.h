@@ -261,6 +261,17 @@ class DirectSession : public Session {
       std::unique_ptr<FunctionInfo>* out_func_info,
       RunStateArgs* run_state_args);
 
+  // Records the execution time estimates of the cost models of
+  // `executors_and_keys` in `measured_node_costs_`.
+  void RecordMeasuredNodeCosts(const ExecutorsAndKeys& executors_and_keys)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(executor_lock_);
+
+  // Returns a cost model for the partition `graph` on `device` with the
+  // execution times measured for nodes of the same name, or nullptr if none
+  // were measured.
+  std::unique_ptr<CostModel> MeasuredCostModel(const std::string& device,
+                                               const Graph& graph);
+
   // Creates several graphs given the existing graph_def_ and the
   // input feeds and fetches, given 'devices'. The graphs share a common
   // function library 'flib_def'.
@@ -363,6 +374,10 @@ class DirectSession : public Session {
   // If true, blocks until device has finished all queued operations in a step.
   bool sync_on_finish_ = true;
 
+  // If true, executors dispatch ready nodes on the critical path of their
+  // graph first. See `LocalExecutorParams::prioritize_critical_path`.
+  bool prioritize_critical_path_ = false;
+
   std::vector<std::unique_ptr<FunctionInfo>> functions_
       TF_GUARDED_BY(executor_lock_);
 
@@ -430,6 +445,13 @@ class DirectSession : public Session {
   // Manages all the cost models for the graphs executed in this session.
   CostModelManager cost_model_manager_;
 
+  // If `prioritize_critical_path_` is true, the execution time estimates from
+  // `cost_model_manager_`, keyed by device and node name. Executors created
+  // after a cost model was built use them to weight the critical path.
+  std::unordered_map<std::string,
+                     std::unordered_map<std::string, Microseconds>>
+      measured_node_costs_ TF_GUARDED_BY(executor_lock_);
+
   // For testing collective graph key generation.
   mutex collective_graph_key_lock_;
   int64_t collective_graph_key_ TF_GUARDED_BY(collective_graph_key_lock_) = -1;
@@ -47,6 +47,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -2966,6 +2967,60 @@ BENCHMARK(BM_FeedFetchCallableSingleThreadExecutor)
     ->Arg(5)
     ->Arg(10);
 
+// Measures the time to create a session and run it for the first time, which
+// includes optimizing the graph with Grappler, with the Grappler result cache
+// disabled (cold) or already holding the optimized graph (warm).
+void BM_SessionCreateAndFirstRun(::testing::benchmark::State& state) {
+  const int num_nodes = state.range(0);
+  const bool warm_cache = state.range(1);
+
+  Tensor value(DT_FLOAT, TensorShape());
+  value.flat<float>()(0) = 37.0;
+  Graph g(OpRegistry::Global());
+  Node* placeholder;
+  TF_CHECK_OK(NodeBuilder(g.NewName("Placeholder"), "Placeholder")
+                  .Attr("shape", TensorShape())
+                  .Attr("dtype", DT_FLOAT)
+                  .Finalize(&g, &placeholder));
+  Node* sum = placeholder;
+  for (int i = 0; i < num_nodes; ++i) {
+    // Gives constant folding and the arithmetic optimizer some work to do.
+    Node* constant = test::graph::Constant(&g, value);
+    sum = test::graph::Binary(&g, "Add", sum,
+                              test::graph::Binary(&g, "Mul", constant,
+                                                  constant));
+  }
+  GraphDef gd;
+  g.ToGraphDef(&gd);
+  const std::vector<std::pair<std::string, Tensor>> inputs = {
+      {placeholder->name() + ":0", value}};
+  const std::vector<std::string> outputs = {sum->name() + ":0"};
+
+  auto create_and_run = [&]() {
+    std::unique_ptr<Session> session(NewSession(SessionOptions()));
+    TF_CHECK_OK(session->Create(gd));
+    std::vector<Tensor> output_values;
+    TF_CHECK_OK(session->Run(inputs, outputs, {}, &output_values));
+    TF_CHECK_OK(session->Close());
+  };
+
+  grappler::MetaOptimizerResultCache::ResetGlobal(
+      /*capacity_bytes=*/warm_cache ? int64_t{1} << 30 : 0,
+      /*directory=*/"");
+  if (warm_cache) create_and_run();
+  for (auto s : state) {
+    create_and_run();
+  }
+  grappler::MetaOptimizerResultCache::ResetGlobal(/*capacity_bytes=*/0,
+                                                  /*directory=*/"");
+}
+
+BENCHMARK(BM_SessionCreateAndFirstRun)
+    ->ArgPair(100, false)
+    ->ArgPair(100, true)
+    ->ArgPair(1000, false)
+    ->ArgPair(1000, true);
+
 }  // namespace
 
 class DirectSessionCollectiveTest : public ::testing::Test {
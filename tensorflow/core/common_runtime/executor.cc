@@ -373,6 +373,9 @@ class ExecutorState {
   // Schedule all the expensive nodes in '*ready', and put all the inexpensive
   // nodes in 'ready' into 'inline_ready'.
   //
+  // If the executor was created with `prioritize_critical_path`, the nodes in
+  // '*ready' are handled in decreasing order of their static priority.
+  //
   // This method will clear `*ready` before returning.
   //
   // REQUIRES: `!ready->empty()`.
@@ -1315,6 +1318,19 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
       tsl::profiler::GetTFTraceMeLevel(/*is_expensive=*/false));
   DCHECK(!ready->empty());
 
+  const bool prioritize_critical_path = immutable_state_.has_node_priorities();
+  if (prioritize_critical_path && ready->size() > 1) {
+    // Order the ready nodes by decreasing distance to the sink, so that the
+    // nodes on the critical path are dispatched (or run inline) first.
+    std::stable_sort(ready->begin(), ready->end(),
+                     [this](const TaggedNode& a, const TaggedNode& b) {
+                       return immutable_state_.node_priority(
+                                  a.get_node_item()) >
+                              immutable_state_.node_priority(
+                                  b.get_node_item());
+                     });
+  }
+
   int64_t scheduled_nsec = 0;
   if (stats_collector_) {
     scheduled_nsec = nodestats::NowInNsec();
@@ -1351,6 +1367,10 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
           // Inline this inexpensive node.
           inline_ready->push_back(tagged_node);
+        } else if (prioritize_critical_path && curr_expensive_node) {
+          // `*ready` is sorted by priority, so keep the first expensive node
+          // as the candidate to run on this thread.
+          expensive_nodes.push_back(tagged_node);
         } else {
           if (curr_expensive_node) {
             expensive_nodes.push_back(*curr_expensive_node);
@@ -1365,7 +1385,12 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
       } else {
         // There are inline nodes to run already. We dispatch this expensive
         // node to other thread.
-        expensive_nodes.push_back(*curr_expensive_node);
+        if (prioritize_critical_path) {
+          expensive_nodes.insert(expensive_nodes.begin(),
+                                 *curr_expensive_node);
+        } else {
+          expensive_nodes.push_back(*curr_expensive_node);
+        }
       }
     }
     if (!expensive_nodes.empty()) {
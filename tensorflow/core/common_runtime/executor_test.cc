@@ -16,6 +16,9 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor.h"
 
 #include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
 
 #include "tensorflow/cc/framework/ops.h"
 #include "tensorflow/cc/ops/array_ops.h"
@@ -38,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/costmodel.h"
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
@@ -77,10 +81,14 @@ class ExecutorTest : public ::testing::Test {
   }
 
   // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  void Create(std::unique_ptr<const Graph> graph,
+              bool prioritize_critical_path = false,
+              const CostModel* cost_model = nullptr) {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
+    params.prioritize_critical_path = prioritize_critical_path;
+    params.cost_model = cost_model;
     params.create_kernel =
         [this, version](const std::shared_ptr<const NodeProperties>& props,
                         OpKernel** kernel) {
@@ -104,6 +112,39 @@ class ExecutorTest : public ::testing::Test {
     return exec_->Run(args);
   }
 
+  // Runs the executor with a runner that defers each closure until the ones
+  // scheduled before it have finished, and returns the names of the nodes in
+  // the order in which they ran.
+  std::vector<std::string> RunAndGetNodeOrder() {
+    std::deque<std::function<void()>> closures;
+    Executor::Args args;
+    args.rendezvous = rendez_;
+    args.stats_collector = &step_stats_collector_;
+    args.runner = [&closures](std::function<void()> fn) {
+      closures.push_back(std::move(fn));
+    };
+    bool done = false;
+    absl::Status status;
+    exec_->RunAsync(args, [&done, &status](const absl::Status& s) {
+      done = true;
+      status = s;
+    });
+    while (!closures.empty()) {
+      std::function<void()> fn = std::move(closures.front());
+      closures.pop_front();
+      fn();
+    }
+    EXPECT_TRUE(done);
+    TF_EXPECT_OK(status);
+    std::vector<std::string> node_names;
+    for (const DeviceStepStats& dev_stats : GetStepStats().dev_stats()) {
+      for (const NodeExecStats& node_stats : dev_stats.node_stats()) {
+        node_names.push_back(node_stats.node_name());
+      }
+    }
+    return node_names;
+  }
+
   const StepStats& GetStepStats() {
     step_stats_collector_.Finalize();
     return step_stats_;
@@ -324,6 +365,108 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWithCriticalPathPriority) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), /*prioritize_critical_path=*/true);
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
+// Adds one chain of `depth` matrix multiplications and `width` independent
+// single matrix multiplications to `g`, all fed by the same constant. The head
+// of the chain is added between the side branches.
+void BuildChainAndSideBranches(int width, int depth, Graph* g,
+                               std::vector<std::string>* chain,
+                               std::vector<std::string>* side_branches) {
+  Tensor m(DT_FLOAT, TensorShape({16, 16}));
+  m.flat<float>().setConstant(1.0f / 16);
+  Node* w = test::graph::Constant(g, m);
+  for (int i = 0; i < width; ++i) {
+    if (i == width / 2) {
+      Node* n = w;
+      for (int j = 0; j < depth; ++j) {
+        n = test::graph::Matmul(g, n, w, false, false);
+        chain->push_back(n->name());
+      }
+    }
+    side_branches->push_back(
+        test::graph::Matmul(g, w, w, false, false)->name());
+  }
+}
+
+// Returns the position of `name` in `node_names`.
+int NodePosition(const std::vector<std::string>& node_names,
+                 const std::string& name) {
+  return std::find(node_names.begin(), node_names.end(), name) -
+         node_names.begin();
+}
+
+TEST_F(ExecutorTest, CriticalPathPriorityRunsLongChainFirst) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  std::vector<std::string> chain;
+  std::vector<std::string> side_branches;
+  BuildChainAndSideBranches(/*width=*/8, /*depth=*/4, g.get(), &chain,
+                            &side_branches);
+  Create(std::move(g), /*prioritize_critical_path=*/true);
+
+  const std::vector<std::string> node_names = RunAndGetNodeOrder();
+  const int num_nodes = node_names.size();
+  int last_chain_position = -1;
+  for (const std::string& name : chain) {
+    const int position = NodePosition(node_names, name);
+    ASSERT_LT(position, num_nodes) << name << " didn't run";
+    EXPECT_GT(position, last_chain_position) << name;
+    last_chain_position = position;
+  }
+  for (const std::string& name : side_branches) {
+    const int position = NodePosition(node_names, name);
+    ASSERT_LT(position, num_nodes) << name << " didn't run";
+    EXPECT_GT(position, last_chain_position) << name;
+  }
+}
+
+TEST_F(ExecutorTest, CriticalPathPriorityUsesCostModel) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  std::vector<std::string> chain;
+  std::vector<std::string> side_branches;
+  BuildChainAndSideBranches(/*width=*/8, /*depth=*/4, g.get(), &chain,
+                            &side_branches);
+  // Estimate one side branch to take longer than the whole chain.
+  const std::string& expensive_side_branch = side_branches.back();
+  CostModel cost_model(/*is_global=*/false);
+  cost_model.InitFromGraph(*g);
+  for (const Node* n : g->op_nodes()) {
+    if (n->name() == expensive_side_branch) {
+      cost_model.RecordCount(n, 1);
+      cost_model.RecordTime(n, Microseconds(1000));
+    }
+  }
+  Create(std::move(g), /*prioritize_critical_path=*/true, &cost_model);
+
+  const std::vector<std::string> node_names = RunAndGetNodeOrder();
+  const int num_nodes = node_names.size();
+  const int expensive_position =
+      NodePosition(node_names, expensive_side_branch);
+  ASSERT_LT(expensive_position, num_nodes);
+  for (const std::string& name : chain) {
+    EXPECT_GT(NodePosition(node_names, name), expensive_position) << name;
+  }
+  const int chain_tail_position = NodePosition(node_names, chain.back());
+  for (const std::string& name : side_branches) {
+    if (name != expensive_side_branch) {
+      EXPECT_GT(NodePosition(node_names, name), chain_tail_position) << name;
+    }
+  }
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -380,6 +523,25 @@ TEST_F(ExecutorTest, SimpleSwitchLive) {
   EXPECT_FALSE(is_dead);
 }
 
+TEST_F(ExecutorTest, SimpleSwitchLiveWithCriticalPathPriority) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Constant(g.get(), VB(false));
+  auto tmp = test::graph::Switch(g.get(), in0, in1);
+  test::graph::Send(g.get(), tmp, "c", BOB, 1, ALICE);
+  Create(std::move(g), /*prioritize_critical_path=*/true);
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_EQ(1.0, V(out));
+  EXPECT_FALSE(is_dead);
+}
+
 TEST_F(ExecutorTest, SimpleSwitchDead) {
   auto g = std::make_unique<Graph>(OpRegistry::Global());
   auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
@@ -579,6 +741,93 @@ BENCHMARK(BM_const_identity)
     ->ArgPair(100, 1)
     ->ArgPair(100, 100);
 
+// Creates a graph with one chain of `depth` matrix multiplications (the
+// critical path) and `width` independent single-op side branches. All side
+// branches and the head of the chain become ready at the same time.
+static Graph* CriticalPathGraph(int width, int depth) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor m(DT_FLOAT, TensorShape({128, 128}));
+  m.flat<float>().setConstant(1.0f / 128);
+  Node* w = test::graph::Constant(g, m);
+  // Add the side branches first, so that they precede the head of the chain
+  // in the ready queue of the default schedule.
+  for (int i = 0; i < width; ++i) {
+    test::graph::Matmul(g, w, w, false, false);
+  }
+  Node* chain = w;
+  for (int i = 0; i < depth; ++i) {
+    chain = test::graph::Matmul(g, chain, w, false, false);
+  }
+  FixupSourceAndSinkEdges(g);
+  return g;
+}
+
+// Reports the p50/p99 step time of `CriticalPathGraph()` with and without
+// critical-path-aware scheduling.
+static void BM_executor_critical_path(::testing::benchmark::State& state) {
+  const int width = state.range(0);
+  const int depth = state.range(1);
+  const bool prioritize_critical_path = state.range(2);
+
+  std::unique_ptr<Graph> g(CriticalPathGraph(width, depth));
+  std::unique_ptr<Device> device = DeviceFactory::NewDevice(
+      "CPU", {}, "/job:localhost/replica:0/task:0");
+  SessionOptions options;
+  thread::ThreadPool* pool = ComputePool(options);
+
+  const int version = g->versions().producer();
+  LocalExecutorParams params;
+  params.device = device.get();
+  params.prioritize_critical_path = prioritize_critical_path;
+  params.create_kernel =
+      [&device, version](const std::shared_ptr<const NodeProperties>& props,
+                         OpKernel** kernel) {
+        return CreateNonCachedKernel(device.get(), nullptr, props, version,
+                                     kernel);
+      };
+  params.delete_kernel = [](OpKernel* kernel) {
+    DeleteNonCachedKernel(kernel);
+  };
+  Executor* exec = nullptr;
+  TF_CHECK_OK(NewLocalExecutor(params, *g, &exec));
+  std::unique_ptr<Executor> exec_owner(exec);
+
+  Executor::Args args;
+  args.runner = [pool](std::function<void()> fn) {
+    pool->Schedule(std::move(fn));
+  };
+
+  std::vector<uint64_t> step_micros;
+  for (auto s : state) {
+    const uint64_t start_micros = Env::Default()->NowMicros();
+    TF_CHECK_OK(exec->Run(args));
+    step_micros.push_back(Env::Default()->NowMicros() - start_micros);
+  }
+
+  std::sort(step_micros.begin(), step_micros.end());
+  auto percentile = [&step_micros](double p) {
+    const size_t index = std::min(
+        step_micros.size() - 1, static_cast<size_t>(p * step_micros.size()));
+    return static_cast<double>(step_micros[index]);
+  };
+  state.counters["p50_us"] = percentile(0.50);
+  state.counters["p99_us"] = percentile(0.99);
+  state.SetLabel(absl::StrCat("Nodes = ", width + depth + 1,
+                              prioritize_critical_path ? ", critical path"
+                                                       : ", default"));
+  state.SetItemsProcessed((width + depth + 1) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_executor_critical_path)
+    ->UseRealTime()
+    ->Args({64, 16, 0})
+    ->Args({64, 16, 1})
+    ->Args({256, 64, 0})
+    ->Args({256, 64, 1})
+    ->Args({1024, 64, 0})
+    ->Args({1024, 64, 1});
+
 static void BM_FeedInputFetchOutput(::testing::benchmark::State& state) {
   Graph* g = new Graph(OpRegistry::Global());
   // z = x + y: x and y are provided as benchmark inputs.  z is the
@@ -15,10 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 
+#include <algorithm>
+
 #include "absl/memory/memory.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/costmodel.h"
 #include "tensorflow/core/graph/edgeset.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
@@ -259,6 +263,9 @@ absl::Status ImmutableExecutorState::Initialize(const Graph& graph) {
   // Initialize PendingCounts only after pending_ids_[node.id] is initialized
   // for all nodes.
   InitializePending(&graph, cf_info);
+  if (params_.prioritize_critical_path) {
+    InitializeNodePriorities(graph);
+  }
   return gview_.SetAllocAttrs(&graph, params_.device);
 }
 
@@ -378,4 +385,34 @@ void ImmutableExecutorState::InitializePending(const Graph* graph,
     }
   }
 }
+
+void ImmutableExecutorState::InitializeNodePriorities(const Graph& graph) {
+  const CostModel* cost_model = params_.cost_model;
+  node_priorities_.assign(gview_.num_nodes(), 0);
+  std::vector<bool> computed(gview_.num_nodes(), false);
+
+  // A post-order visits every node after all of its successors, except for
+  // successors that are only reachable through a loop back edge (i.e.
+  // NextIteration -> Merge). Those edges are ignored, so that the priorities
+  // remain well defined for graphs with control flow.
+  std::vector<Node*> order;
+  GetPostOrder(graph, &order);
+  for (const Node* n : order) {
+    const int id = n->id();
+    int64_t cost = 1;
+    if (cost_model != nullptr && n->IsOp()) {
+      cost = std::max<int64_t>(1, cost_model->TimeEstimate(n).value());
+    }
+    int64_t max_successor_priority = 0;
+    for (const Node* dst : n->out_nodes()) {
+      if (computed[dst->id()]) {
+        max_successor_priority =
+            std::max(max_successor_priority, node_priorities_[dst->id()]);
+      }
+    }
+    node_priorities_[id] = cost + max_successor_priority;
+    computed[id] = true;
+  }
+}
+
 }  // namespace tensorflow
@@ -101,6 +101,19 @@ class ImmutableExecutorState {
 
   bool requires_control_flow_support() const { return requires_control_flow_; }
 
+  // Returns true if static node priorities were computed for this graph, i.e.
+  // if `params().prioritize_critical_path` is true.
+  bool has_node_priorities() const { return !node_priorities_.empty(); }
+
+  // Returns the static priority of the given node: the estimated cost of the
+  // longest path from the node to the sink, including the node itself.
+  //
+  // REQUIRES: `has_node_priorities()`.
+  int64_t node_priority(const NodeItem& node_item) const {
+    DCHECK(has_node_priorities());
+    return node_priorities_[node_item.node_id];
+  }
+
   // Copies the pending counts for nodes in this graph to the given array.
   //
   // This method provides a more efficient way of initializing
@@ -125,6 +138,7 @@ class ImmutableExecutorState {
   static absl::Status BuildControlFlowInfo(const Graph* graph,
                                            ControlFlowInfo* cf_info);
   void InitializePending(const Graph* graph, const ControlFlowInfo& cf_info);
+  void InitializeNodePriorities(const Graph& graph);
 
   FrameInfo* EnsureFrameInfo(const std::string& fname);
 
@@ -152,6 +166,10 @@ class ImmutableExecutorState {
   // pending counts for the nodes in the graph, indexed by node ID.
   std::unique_ptr<std::atomic<int32_t>[]> atomic_pending_counts_;
 
+  // If `params_.prioritize_critical_path` is true, the static priority of
+  // each node, indexed by node ID. Empty otherwise.
+  std::vector<int64_t> node_priorities_;
+
   // Shallow copies of the constant tensors used in the graph.
   std::vector<Tensor> const_tensors_;
 
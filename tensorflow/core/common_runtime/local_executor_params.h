@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 
 namespace tensorflow {
+class CostModel;
 class Device;
 class StepStatsCollector;
 class SessionMetadata;
@@ -50,6 +51,18 @@ struct LocalExecutorParams {
 
   // Whether control flow nodes are allowed to be executed synchronously.
   bool allow_control_flow_sync_execution = false;
+
+  // If true, the executor precomputes a static priority for every node, equal
+  // to the estimated cost of the longest path from that node to the sink, and
+  // dispatches ready nodes in decreasing priority order so that the critical
+  // path of the graph runs first.
+  bool prioritize_critical_path = false;
+
+  // Optional per-node execution time estimates used to weight the critical
+  // path when `prioritize_critical_path` is true. Nodes without an estimate
+  // (or all nodes, if this is null) are assigned a unit cost. Not owned, and
+  // only used while the executor is being initialized.
+  const CostModel* cost_model = nullptr;
 };
 
 }  // end namespace tensorflow
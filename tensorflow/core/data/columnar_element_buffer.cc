@@ -0,0 +1,232 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/columnar_element_buffer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Slices of a slab can be returned without a copy if they start at a multiple
+// of this many bytes, so numeric values are padded to it.
+#if EIGEN_MAX_ALIGN_BYTES == 0
+constexpr int64_t kAlignment = 1;
+#else
+constexpr int64_t kAlignment = EIGEN_MAX_ALIGN_BYTES;
+#endif
+
+// Copies `n` scalars from `src` (starting at `src_offset`) to `dst` (starting
+// at `dst_offset`). The tensors must have the same, packable dtype.
+void CopyScalars(const Tensor& src, int64_t src_offset, Tensor* dst,
+                 int64_t dst_offset, int64_t n) {
+  if (src.dtype() == DT_STRING) {
+    auto src_flat = src.flat<tstring>();
+    auto dst_flat = dst->flat<tstring>();
+    for (int64_t i = 0; i < n; ++i) {
+      dst_flat(dst_offset + i) = src_flat(src_offset + i);
+    }
+    return;
+  }
+  const int64_t scalar_size = DataTypeSize(src.dtype());
+  std::memcpy(static_cast<char*>(dst->data()) + dst_offset * scalar_size,
+              static_cast<const char*>(src.data()) + src_offset * scalar_size,
+              n * scalar_size);
+}
+
+}  // namespace
+
+/* static */ constexpr int64_t ColumnarElementBuffer::kMaxPackedBytes;
+/* static */ constexpr int64_t ColumnarElementBuffer::kSlabBytes;
+
+ColumnarElementBuffer::ColumnarElementBuffer(ColumnarElementBuffer&& other)
+    : columns_(std::move(other.columns_)),
+      num_elements_(std::exchange(other.num_elements_, 0)) {
+  other.columns_.clear();
+}
+
+ColumnarElementBuffer& ColumnarElementBuffer::operator=(
+    ColumnarElementBuffer&& other) {
+  columns_ = std::move(other.columns_);
+  other.columns_.clear();
+  num_elements_ = std::exchange(other.num_elements_, 0);
+  return *this;
+}
+
+absl::Status ColumnarElementBuffer::Append(const std::vector<Tensor>& element) {
+  if (num_elements_ == 0) {
+    columns_.clear();
+    columns_.resize(element.size());
+    for (size_t i = 0; i < element.size(); ++i) {
+      InitColumn(element[i], &columns_[i]);
+    }
+  } else if (element.size() != columns_.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Expected an element with ", columns_.size(),
+                     " components, but got ", element.size()));
+  }
+  for (size_t i = 0; i < element.size(); ++i) {
+    const Tensor& value = element[i];
+    Column& column = columns_[i];
+    if (column.packed &&
+        (value.dtype() != column.dtype || value.shape() != column.shape)) {
+      Unpack(&column);
+    }
+    if (!column.packed) {
+      column.tensors.push_back(value);
+      continue;
+    }
+    const int64_t slab_index = num_elements_ / column.values_per_slab;
+    const int64_t offset =
+        (num_elements_ % column.values_per_slab) * column.value_stride;
+    const int64_t slab_size = column.values_per_slab * column.value_stride;
+    if (slab_index == static_cast<int64_t>(column.slabs.size())) {
+      column.slabs.emplace_back(column.dtype, TensorShape({slab_size}));
+    } else if (column.slabs[slab_index].NumElements() < slab_size) {
+      // The slab was shrunk by `Shrink()`.
+      Tensor slab(column.dtype, TensorShape({slab_size}));
+      CopyScalars(column.slabs[slab_index], 0, &slab, 0,
+                  column.slabs[slab_index].NumElements());
+      column.slabs[slab_index] = std::move(slab);
+    }
+    CopyScalars(value, 0, &column.slabs[slab_index], offset,
+                column.value_size);
+  }
+  ++num_elements_;
+  return absl::OkStatus();
+}
+
+void ColumnarElementBuffer::Get(int64_t index, std::vector<Tensor>* out) const {
+  DCHECK_GE(index, 0);
+  DCHECK_LT(index, num_elements_);
+  out->reserve(out->size() + columns_.size());
+  for (const Column& column : columns_) {
+    out->push_back(GetValue(column, index));
+  }
+}
+
+std::vector<std::vector<Tensor>> ColumnarElementBuffer::GetAll() const {
+  std::vector<std::vector<Tensor>> elements(num_elements_);
+  for (int64_t i = 0; i < num_elements_; ++i) {
+    Get(i, &elements[i]);
+  }
+  return elements;
+}
+
+void ColumnarElementBuffer::Shrink() {
+  for (Column& column : columns_) {
+    if (!column.packed || column.slabs.empty()) {
+      column.tensors.shrink_to_fit();
+      continue;
+    }
+    const int64_t num_values =
+        num_elements_ - (column.slabs.size() - 1) * column.values_per_slab;
+    const int64_t size = num_values * column.value_stride;
+    Tensor& last = column.slabs.back();
+    if (last.NumElements() == size) continue;
+    Tensor slab(column.dtype, TensorShape({size}));
+    CopyScalars(last, 0, &slab, 0, size);
+    last = std::move(slab);
+  }
+}
+
+void ColumnarElementBuffer::Clear() {
+  columns_.clear();
+  num_elements_ = 0;
+}
+
+std::vector<Tensor> ColumnarElementBuffer::StorageTensors() const {
+  std::vector<Tensor> tensors;
+  for (const Column& column : columns_) {
+    tensors.insert(tensors.end(), column.slabs.begin(), column.slabs.end());
+    tensors.insert(tensors.end(), column.tensors.begin(),
+                   column.tensors.end());
+  }
+  return tensors;
+}
+
+/* static */ void ColumnarElementBuffer::InitColumn(const Tensor& value,
+                                                    Column* column) {
+  column->dtype = value.dtype();
+  column->shape = value.shape();
+  column->value_size = value.NumElements();
+  if (column->dtype != DT_STRING && !DataTypeCanUseMemcpy(column->dtype)) {
+    return;
+  }
+  const int64_t scalar_size = column->dtype == DT_STRING
+                                  ? sizeof(tstring)
+                                  : DataTypeSize(column->dtype);
+  const int64_t value_bytes = column->value_size * scalar_size;
+  if (value_bytes == 0 || value_bytes > kMaxPackedBytes) return;
+  column->packed = true;
+  // String tensors have no alignment requirement. Scalar sizes and
+  // `kAlignment` are powers of two, so the larger is a multiple of both.
+  const int64_t alignment = column->dtype == DT_STRING
+                                ? scalar_size
+                                : std::max(kAlignment, scalar_size);
+  const int64_t stride_bytes =
+      (value_bytes + alignment - 1) / alignment * alignment;
+  column->value_stride = stride_bytes / scalar_size;
+  column->values_per_slab = std::max<int64_t>(1, kSlabBytes / stride_bytes);
+}
+
+/* static */ Tensor ColumnarElementBuffer::GetValue(const Column& column,
+                                                    int64_t index) {
+  if (!column.packed) return column.tensors[index];
+  const Tensor& slab = column.slabs[index / column.values_per_slab];
+  const int64_t offset =
+      (index % column.values_per_slab) * column.value_stride;
+  Tensor value;
+  CHECK(value.CopyFrom(slab.Slice(offset, offset + column.value_size),
+                       column.shape));
+  return value;
+}
+
+/* static */ Tensor ColumnarElementBuffer::CopyValue(const Column& column,
+                                                     int64_t index) {
+  const Tensor& slab = column.slabs[index / column.values_per_slab];
+  const int64_t offset =
+      (index % column.values_per_slab) * column.value_stride;
+  Tensor value(column.dtype, column.shape);
+  CopyScalars(slab, offset, &value, 0, column.value_size);
+  return value;
+}
+
+void ColumnarElementBuffer::Unpack(Column* column) const {
+  std::vector<Tensor> tensors;
+  tensors.reserve(num_elements_);
+  for (int64_t i = 0; i < num_elements_; ++i) {
+    // Copies, so that the slabs can be released.
+    tensors.push_back(CopyValue(*column, i));
+  }
+  column->packed = false;
+  column->slabs.clear();
+  column->tensors = std::move(tensors);
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,117 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_COLUMNAR_ELEMENT_BUFFER_H_
+#define TENSORFLOW_CORE_DATA_COLUMNAR_ELEMENT_BUFFER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+
+namespace tensorflow {
+namespace data {
+
+// A compact in-memory store for a sequence of dataset elements.
+//
+// Storing every element as a `std::vector<Tensor>` costs a few allocations
+// and ~100 bytes of bookkeeping per element, on top of the tensor data, which
+// dominates the memory use of small elements. Instead, this buffer stores
+// each component (a "column") of the elements separately: while all elements
+// have the same dtype and shape for a component, and the component is small,
+// its values are packed back to back into large tensors ("slabs"). Other
+// components fall back to one tensor per element.
+//
+// Packed values are returned as zero-copy slices of their slab. So that the
+// slices are aligned (as required by `Tensor::flat()` and friends), each
+// numeric value is padded to a multiple of `EIGEN_MAX_ALIGN_BYTES`, which still
+// costs far less than a tensor per value.
+//
+// This class is not thread-safe.
+class ColumnarElementBuffer {
+ public:
+  // Components with more bytes than this are stored as one tensor per element,
+  // as their bookkeeping overhead is already small.
+  static constexpr int64_t kMaxPackedBytes = 4 << 10;  // 4KB
+  // The size of the slabs that packed components are stored in.
+  static constexpr int64_t kSlabBytes = 1 << 20;  // 1MB
+
+  ColumnarElementBuffer() = default;
+  ColumnarElementBuffer(ColumnarElementBuffer&& other);
+  ColumnarElementBuffer& operator=(ColumnarElementBuffer&& other);
+
+  // Appends `element`, which must have as many components as the previously
+  // appended elements.
+  absl::Status Append(const std::vector<Tensor>& element);
+
+  // Appends the components of element `index` to `*out`.
+  void Get(int64_t index, std::vector<Tensor>* out) const;
+
+  // Returns all the elements, in order.
+  std::vector<std::vector<Tensor>> GetAll() const;
+
+  // Releases the unused capacity of the slabs. Call this once all the
+  // elements have been appended.
+  void Shrink();
+
+  // Removes all the elements.
+  void Clear();
+
+  int64_t size() const { return num_elements_; }
+  bool empty() const { return num_elements_ == 0; }
+
+  // Returns the tensors that hold the elements, e.g. to account for their
+  // memory.
+  std::vector<Tensor> StorageTensors() const;
+
+ private:
+  struct Column {
+    // Whether the values are packed into `slabs`, or stored in `tensors`.
+    bool packed = false;
+    DataType dtype = DT_INVALID;
+    // The shape of every value of a packed column.
+    TensorShape shape;
+    // The number of scalars in each value of a packed column.
+    int64_t value_size = 0;
+    // The number of scalars between the starts of consecutive values in a
+    // slab, i.e. `value_size` plus the alignment padding.
+    int64_t value_stride = 0;
+    // The number of values in each slab.
+    int64_t values_per_slab = 0;
+    // 1-D tensors of `values_per_slab * value_stride` scalars. The last slab
+    // may be smaller after `Shrink()`.
+    std::vector<Tensor> slabs;
+    std::vector<Tensor> tensors;
+  };
+
+  // Sets up `column` for components like `value`.
+  static void InitColumn(const Tensor& value, Column* column);
+  // Returns the value of `column` for element `index`.
+  static Tensor GetValue(const Column& column, int64_t index);
+  // Returns a copy of the value of packed `column` for element `index`.
+  static Tensor CopyValue(const Column& column, int64_t index);
+  // Stores the existing values of `column` as one tensor per element.
+  void Unpack(Column* column) const;
+
+  std::vector<Column> columns_;
+  int64_t num_elements_ = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_COLUMNAR_ELEMENT_BUFFER_H_
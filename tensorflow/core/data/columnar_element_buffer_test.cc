@@ -0,0 +1,250 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/columnar_element_buffer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Returns an element with a scalar, a small vector, and a string component.
+std::vector<Tensor> MakeElement(int64_t i) {
+  return {CreateTensor<int64_t>(TensorShape{}, {i}),
+          CreateTensor<float>(TensorShape{16}, std::vector<float>(16, i)),
+          CreateTensor<tstring>(TensorShape{}, {absl::StrCat("element ", i)})};
+}
+
+int64_t TotalBytes(const std::vector<Tensor>& tensors) {
+  int64_t total_bytes = 0;
+  for (const Tensor& tensor : tensors) {
+    total_bytes += tensor.TotalBytes();
+  }
+  return total_bytes;
+}
+
+TEST(ColumnarElementBufferTest, RoundTrip) {
+  ColumnarElementBuffer buffer;
+  std::vector<std::vector<Tensor>> elements;
+  for (int64_t i = 0; i < 1000; ++i) {
+    elements.push_back(MakeElement(i));
+    TF_ASSERT_OK(buffer.Append(elements.back()));
+  }
+  EXPECT_EQ(1000, buffer.size());
+  for (int64_t i : {999, 0, 500}) {
+    std::vector<Tensor> element;
+    buffer.Get(i, &element);
+    TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(elements[i], element,
+                                                 /*compare_order=*/true));
+    for (const Tensor& tensor : element) {
+      EXPECT_TRUE(tensor.IsAligned());
+    }
+  }
+  buffer.Shrink();
+  std::vector<std::vector<Tensor>> all_elements = buffer.GetAll();
+  ASSERT_EQ(elements.size(), all_elements.size());
+  for (size_t i = 0; i < elements.size(); ++i) {
+    TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(elements[i], all_elements[i],
+                                                 /*compare_order=*/true));
+  }
+}
+
+TEST(ColumnarElementBufferTest, PacksSmallComponents) {
+  ColumnarElementBuffer buffer;
+  for (int64_t i = 0; i < 10000; ++i) {
+    TF_ASSERT_OK(buffer.Append({CreateTensor<int64_t>(TensorShape{}, {i})}));
+  }
+  buffer.Shrink();
+  // The 10000 scalars, each padded to the alignment, fit in a single slab of
+  // exactly their size.
+  const int64_t value_bytes =
+      std::max<int64_t>(sizeof(int64_t), EIGEN_MAX_ALIGN_BYTES);
+  std::vector<Tensor> storage = buffer.StorageTensors();
+  ASSERT_EQ(1, storage.size());
+  EXPECT_EQ(10000 * value_bytes, TotalBytes(storage));
+
+  std::vector<Tensor> element;
+  buffer.Get(1234, &element);
+  test::ExpectEqual(CreateTensor<int64_t>(TensorShape{}, {1234}), element[0]);
+}
+
+TEST(ColumnarElementBufferTest, ReturnsAlignedSlicesOfSlabs) {
+  ColumnarElementBuffer buffer;
+  // Values of 4 and 12 bytes, which are not multiples of the alignment.
+  for (int32_t i = 0; i < 100; ++i) {
+    TF_ASSERT_OK(
+        buffer.Append({CreateTensor<int32_t>(TensorShape{}, {i}),
+                       CreateTensor<float>(TensorShape{3}, {1.0f * i, 0, 0})}));
+  }
+  std::vector<Tensor> storage = buffer.StorageTensors();
+  ASSERT_EQ(2, storage.size());
+  for (int32_t i : {0, 1, 99}) {
+    std::vector<Tensor> element;
+    buffer.Get(i, &element);
+    ASSERT_EQ(2, element.size());
+    test::ExpectEqual(CreateTensor<int32_t>(TensorShape{}, {i}), element[0]);
+    test::ExpectEqual(CreateTensor<float>(TensorShape{3}, {1.0f * i, 0, 0}),
+                      element[1]);
+    for (int c = 0; c < 2; ++c) {
+      EXPECT_TRUE(element[c].IsAligned());
+      EXPECT_TRUE(element[c].SharesBufferWith(storage[c]));
+    }
+  }
+}
+
+TEST(ColumnarElementBufferTest, DoesNotPackLargeComponents) {
+  const int64_t num_floats =
+      ColumnarElementBuffer::kMaxPackedBytes / sizeof(float) + 1;
+  ColumnarElementBuffer buffer;
+  std::vector<Tensor> element = {CreateTensor<float>(TensorShape{num_floats})};
+  for (int i = 0; i < 10; ++i) {
+    TF_ASSERT_OK(buffer.Append(element));
+  }
+  std::vector<Tensor> storage = buffer.StorageTensors();
+  ASSERT_EQ(10, storage.size());
+  // The tensors are shared with the input.
+  EXPECT_TRUE(storage[0].SharesBufferWith(element[0]));
+}
+
+TEST(ColumnarElementBufferTest, ShapeChange) {
+  ColumnarElementBuffer buffer;
+  std::vector<std::vector<Tensor>> elements;
+  for (int64_t i = 0; i < 10; ++i) {
+    elements.push_back({CreateTensor<int64_t>(
+        TensorShape{i < 5 ? 2 : 3}, std::vector<int64_t>(i < 5 ? 2 : 3, i))});
+    TF_ASSERT_OK(buffer.Append(elements.back()));
+  }
+  EXPECT_EQ(10, buffer.StorageTensors().size());
+  std::vector<std::vector<Tensor>> all_elements = buffer.GetAll();
+  ASSERT_EQ(elements.size(), all_elements.size());
+  for (size_t i = 0; i < elements.size(); ++i) {
+    TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(elements[i], all_elements[i],
+                                                 /*compare_order=*/true));
+  }
+}
+
+TEST(ColumnarElementBufferTest, AppendAfterShrink) {
+  ColumnarElementBuffer buffer;
+  for (int64_t i = 0; i < 10; ++i) {
+    TF_ASSERT_OK(buffer.Append(MakeElement(i)));
+    buffer.Shrink();
+  }
+  for (int64_t i = 0; i < 10; ++i) {
+    std::vector<Tensor> element;
+    buffer.Get(i, &element);
+    TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(MakeElement(i), element,
+                                                 /*compare_order=*/true));
+  }
+}
+
+TEST(ColumnarElementBufferTest, MoveAndClear) {
+  ColumnarElementBuffer buffer;
+  TF_ASSERT_OK(buffer.Append(MakeElement(0)));
+  ColumnarElementBuffer moved = std::move(buffer);
+  EXPECT_TRUE(buffer.empty());  // NOLINT(bugprone-use-after-move)
+  EXPECT_EQ(1, moved.size());
+  moved.Clear();
+  EXPECT_TRUE(moved.empty());
+  EXPECT_TRUE(moved.StorageTensors().empty());
+}
+
+TEST(ColumnarElementBufferTest, MismatchedElements) {
+  ColumnarElementBuffer buffer;
+  TF_ASSERT_OK(buffer.Append(MakeElement(0)));
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      buffer.Append({CreateTensor<int64_t>(TensorShape{}, {1})})));
+}
+
+constexpr int64_t kBenchmarkElements = 100000;
+
+// Returns the bytes allocated for `tensor`, other than the `Tensor` itself.
+int64_t AllocatedBytes(const Tensor& tensor) {
+  constexpr int64_t kAlign = Allocator::kAllocatorAlignment;
+  return sizeof(TensorBuffer) +
+         (tensor.TotalBytes() + kAlign - 1) / kAlign * kAlign;
+}
+
+// Reports the throughput of the second epoch of a memory cache of
+// `kBenchmarkElements` elements, and the memory used by the cache.
+// `state.range(0)` selects the layout: one `std::vector<Tensor>` per element as
+// in the previous `MemoryCache`, or a `ColumnarElementBuffer`.
+// `state.range(1)` selects the elements: int64 scalars, or `MakeElement()`.
+void BM_ReadCache(::testing::benchmark::State& state) {
+  const bool columnar = state.range(0);
+  const bool scalars = state.range(1) == 0;
+
+  std::vector<std::vector<Tensor>> vector_cache;
+  ColumnarElementBuffer columnar_cache;
+  int64_t cache_bytes = 0;
+  for (int64_t i = 0; i < kBenchmarkElements; ++i) {
+    std::vector<Tensor> element =
+        scalars ? std::vector<Tensor>{CreateTensor<int64_t>(TensorShape{}, {i})}
+                : MakeElement(i);
+    if (columnar) {
+      TF_CHECK_OK(columnar_cache.Append(element));
+      continue;
+    }
+    cache_bytes += sizeof(element) + element.size() * sizeof(Tensor);
+    for (const Tensor& tensor : element) {
+      cache_bytes += AllocatedBytes(tensor);
+    }
+    vector_cache.push_back(std::move(element));
+  }
+  if (columnar) {
+    columnar_cache.Shrink();
+    for (const Tensor& tensor : columnar_cache.StorageTensors()) {
+      cache_bytes += sizeof(Tensor) + AllocatedBytes(tensor);
+    }
+  }
+
+  int64_t i = 0;
+  for (auto s : state) {
+    std::vector<Tensor> element;
+    if (columnar) {
+      columnar_cache.Get(i, &element);
+    } else {
+      element.insert(element.end(), vector_cache[i].begin(),
+                     vector_cache[i].end());
+    }
+    i = (i + 1) % kBenchmarkElements;
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetLabel(absl::StrCat(columnar ? "columnar" : "vector", "/",
+                              scalars ? "scalars" : "mixed"));
+  state.counters["cache_bytes_per_element"] =
+      static_cast<double>(cache_bytes) / kBenchmarkElements;
+}
+
+BENCHMARK(BM_ReadCache)
+    ->ArgPair(0, 0)
+    ->ArgPair(1, 0)
+    ->ArgPair(0, 1)
+    ->ArgPair(1, 1);
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -16,13 +16,16 @@ limitations under the License.
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <limits>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -31,11 +34,15 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
+#include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/tstring.h"
 #include "tensorflow/core/platform/types.h"
 
+// NOTE: The way zstd is packaged in TF, we cannot include it as <zstd.h>.
+#include "zstd.h"  // NOLINT(build/include)
+
 namespace tensorflow {
 namespace data {
 namespace {
@@ -43,7 +50,72 @@ namespace {
 // Increment this when making changes to the `CompressedElement` proto. The
 // `UncompressElement` function will determine what to read according to the
 // version.
-constexpr int kCompressedElementVersion = 0;
+//
+// Version 1 adds the `codec` and `byte_shuffled` fields. Elements that use
+// neither are still written as version 0, so that older readers can read them.
+constexpr int kCompressedElementVersion = 1;
+constexpr int kSnappyElementVersion = 0;
+
+struct ZstdCCtxDeleter {
+  void operator()(ZSTD_CCtx* ctx) const { ZSTD_freeCCtx(ctx); }
+};
+
+struct ZstdDCtxDeleter {
+  void operator()(ZSTD_DCtx* ctx) const { ZSTD_freeDCtx(ctx); }
+};
+
+// Returns this thread's zstd compression context, reset to the default
+// parameters, or nullptr if it cannot be created. Contexts are reused across
+// elements, as each one allocates its own tables.
+ZSTD_CCtx* ThreadLocalZstdCCtx() {
+  thread_local std::unique_ptr<ZSTD_CCtx, ZstdCCtxDeleter> ctx;
+  if (ctx == nullptr) {
+    ctx.reset(ZSTD_createCCtx());
+  } else {
+    // Also discards a frame left unfinished by a failed compression.
+    ZSTD_CCtx_reset(ctx.get(), ZSTD_reset_session_and_parameters);
+  }
+  return ctx.get();
+}
+
+// Like `ThreadLocalZstdCCtx()`, for decompression.
+ZSTD_DCtx* ThreadLocalZstdDCtx() {
+  thread_local std::unique_ptr<ZSTD_DCtx, ZstdDCtxDeleter> ctx;
+  if (ctx == nullptr) {
+    ctx.reset(ZSTD_createDCtx());
+  } else {
+    ZSTD_DCtx_reset(ctx.get(), ZSTD_reset_session_and_parameters);
+  }
+  return ctx.get();
+}
+
+// Returns whether to shuffle the bytes of `component` before compressing it.
+bool ShouldByteShuffle(const ElementCompressionOptions& options,
+                       const Tensor& component) {
+  return options.byte_shuffle && DataTypeCanUseMemcpy(component.dtype()) &&
+         DataTypeSize(component.dtype()) > 1 && component.NumElements() > 0;
+}
+
+// Copies the `size` bytes of `src`, which holds scalars of `scalar_size`
+// bytes, to `dst`: first the first byte of every scalar, then the second byte
+// of every scalar, and so on. If `kUnshuffle`, does the reverse.
+template <bool kUnshuffle>
+void ShuffleBytes(const char* src, size_t size, size_t scalar_size,
+                  char* dst) {
+  const size_t num_scalars = size / scalar_size;
+  for (size_t i = 0; i < num_scalars; ++i) {
+    for (size_t b = 0; b < scalar_size; ++b) {
+      if (kUnshuffle) {
+        dst[i * scalar_size + b] = src[b * num_scalars + i];
+      } else {
+        dst[b * num_scalars + i] = src[i * scalar_size + b];
+      }
+    }
+  }
+  // Trailing bytes that do not make up a whole scalar are copied as is.
+  const size_t shuffled_size = num_scalars * scalar_size;
+  std::memcpy(dst + shuffled_size, src + shuffled_size, size - shuffled_size);
+}
 
 }  // namespace
 
@@ -70,13 +142,164 @@ class Iov {
   size_t num_bytes_;
 };
 
+namespace {
+
+absl::Status SnappyCompress(Iov& iov, std::string* out) {
+  if (iov.NumBytes() > std::numeric_limits<uint32_t>::max()) {
+    return absl::OutOfRangeError(
+        absl::StrCat("Encountered dataset element of size ", iov.NumBytes(),
+                     ", exceeding the 4GB Snappy limit. Use the ZSTD codec to "
+                     "compress larger elements."));
+  }
+  if (!port::Snappy_CompressFromIOVec(iov.Data(), iov.NumBytes(), out)) {
+    return absl::InternalError("Failed to compress using snappy.");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ZstdCompress(Iov& iov, int level, std::string* out) {
+  ZSTD_CCtx* ctx = ThreadLocalZstdCCtx();
+  if (ctx == nullptr) {
+    return absl::ResourceExhaustedError(
+        "Failed to create a zstd compression context.");
+  }
+  size_t result = ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, level);
+  if (!ZSTD_isError(result)) {
+    // Records the uncompressed size in the frame header.
+    result = ZSTD_CCtx_setPledgedSrcSize(ctx, iov.NumBytes());
+  }
+  if (ZSTD_isError(result)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Failed to set up zstd compression at level ", level,
+                     ": ", ZSTD_getErrorName(result)));
+  }
+  // With `ZSTD_compressBound` bytes of output, every call makes progress.
+  out->resize(ZSTD_compressBound(iov.NumBytes()));
+  ZSTD_outBuffer output = {out->data(), out->size(), 0};
+  for (size_t i = 0; i < iov.NumPieces(); ++i) {
+    ZSTD_inBuffer input = {iov.Data()[i].iov_base, iov.Data()[i].iov_len, 0};
+    while (input.pos < input.size) {
+      result = ZSTD_compressStream2(ctx, &output, &input, ZSTD_e_continue);
+      if (ZSTD_isError(result)) {
+        return absl::InternalError(absl::StrCat(
+            "Failed to compress using zstd: ", ZSTD_getErrorName(result)));
+      }
+    }
+  }
+  ZSTD_inBuffer input = {nullptr, 0, 0};
+  do {
+    result = ZSTD_compressStream2(ctx, &output, &input, ZSTD_e_end);
+    if (ZSTD_isError(result)) {
+      return absl::InternalError(absl::StrCat(
+          "Failed to compress using zstd: ", ZSTD_getErrorName(result)));
+    }
+  } while (result != 0);
+  out->resize(output.pos);
+  return absl::OkStatus();
+}
+
+absl::Status SnappyUncompress(const std::string& compressed_data, Iov& iov) {
+  size_t uncompressed_size;
+  if (!port::Snappy_GetUncompressedLength(
+          compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
+    return absl::InternalError(absl::StrCat(
+        "Could not get snappy uncompressed length. Compressed data size: ",
+        compressed_data.size()));
+  }
+  if (uncompressed_size != static_cast<size_t>(iov.NumBytes())) {
+    return absl::InternalError(absl::StrCat(
+        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
+        " whereas the tensor metadata suggests ", iov.NumBytes()));
+  }
+  if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
+                                      compressed_data.size(), iov.Data(),
+                                      iov.NumPieces())) {
+    return absl::InternalError("Failed to perform snappy decompression.");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ZstdUncompress(const std::string& compressed_data, Iov& iov) {
+  const unsigned long long uncompressed_size =  // NOLINT(runtime/int)
+      ZSTD_getFrameContentSize(compressed_data.data(), compressed_data.size());
+  if (uncompressed_size == ZSTD_CONTENTSIZE_ERROR ||
+      uncompressed_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+    return absl::InternalError(absl::StrCat(
+        "Could not get zstd uncompressed length. Compressed data size: ",
+        compressed_data.size()));
+  }
+  if (uncompressed_size != iov.NumBytes()) {
+    return absl::InternalError(absl::StrCat(
+        "Uncompressed size mismatch. Zstd expects ", uncompressed_size,
+        " whereas the tensor metadata suggests ", iov.NumBytes()));
+  }
+  ZSTD_DCtx* ctx = ThreadLocalZstdDCtx();
+  if (ctx == nullptr) {
+    return absl::ResourceExhaustedError(
+        "Failed to create a zstd decompression context.");
+  }
+  ZSTD_inBuffer input = {compressed_data.data(), compressed_data.size(), 0};
+  // Decompresses straight into the pieces, then reads the end of the frame
+  // into a scratch byte, which must stay empty.
+  char end_of_frame;
+  size_t result = 1;
+  for (size_t i = 0; i <= iov.NumPieces(); ++i) {
+    ZSTD_outBuffer output =
+        i < iov.NumPieces()
+            ? ZSTD_outBuffer{iov.Data()[i].iov_base, iov.Data()[i].iov_len, 0}
+            : ZSTD_outBuffer{&end_of_frame, sizeof(end_of_frame), 0};
+    while (output.pos < output.size && result != 0) {
+      const size_t input_pos = input.pos;
+      const size_t output_pos = output.pos;
+      result = ZSTD_decompressStream(ctx, &output, &input);
+      if (ZSTD_isError(result)) {
+        return absl::InternalError(absl::StrCat(
+            "Failed to perform zstd decompression: ",
+            ZSTD_getErrorName(result)));
+      }
+      if (input.pos == input_pos && output.pos == output_pos) {
+        return absl::InternalError(
+            "Failed to perform zstd decompression: truncated data.");
+      }
+    }
+    if (output.pos < output.size && i < iov.NumPieces()) {
+      return absl::InternalError(
+          "Failed to perform zstd decompression: truncated data.");
+    }
+    if (i == iov.NumPieces() && output.pos > 0) {
+      return absl::InternalError(
+          "Failed to perform zstd decompression: too much data.");
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status ParseCompressionCodec(absl::string_view name,
+                                   CompressedElement::Codec* codec) {
+  if (!CompressedElement::Codec_Parse(std::string(name), codec)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unknown compression codec: ", name,
+                     ". Supported codecs are SNAPPY and ZSTD."));
+  }
+  return absl::OkStatus();
+}
+
 absl::Status CompressElement(const std::vector<Tensor>& element,
                              CompressedElement* out) {
+  return CompressElement(element, ElementCompressionOptions(), out);
+}
+
+absl::Status CompressElement(const std::vector<Tensor>& element,
+                             const ElementCompressionOptions& options,
+                             CompressedElement* out) {
   // First pass: preprocess the non`memcpy`able tensors.
   size_t num_string_tensors = 0;
   size_t num_string_tensor_strings = 0;
   std::vector<TensorProto> nonmemcpyable_components;
   size_t total_nonmemcpyable_size = 0;
+  size_t total_shuffled_size = 0;
   for (const auto& component : element) {
     if (component.dtype() == DT_STRING) {
       ++num_string_tensors;
@@ -86,11 +309,14 @@ absl::Status CompressElement(const std::vector<Tensor>& element,
       component.AsProtoTensorContent(&nonmemcpyable_components.back());
       total_nonmemcpyable_size +=
           nonmemcpyable_components.back().ByteSizeLong();
+    } else if (ShouldByteShuffle(options, component)) {
+      total_shuffled_size += DMAHelper::buffer(&component)->size();
     }
   }
 
   // Second pass: build an iov array of the tensor data.
-  // - `memcpy`able tensors are pointed to directly from a single iovec.
+  // - `memcpy`able tensors are pointed to directly from a single iovec, or,
+  // if they are byte shuffled, shuffled into a string.
   // - String tensors are pointed to directly from multiple iovecs (one for each
   // string).
   // - All other tensors are serialized and copied into a string (a `tstring`
@@ -99,6 +325,9 @@ absl::Status CompressElement(const std::vector<Tensor>& element,
   tstring nonmemcpyable;
   nonmemcpyable.resize_uninitialized(total_nonmemcpyable_size);
   char* nonmemcpyable_pos = nonmemcpyable.mdata();
+  tstring shuffled;
+  shuffled.resize_uninitialized(total_shuffled_size);
+  char* shuffled_pos = shuffled.mdata();
   int nonmemcpyable_component_index = 0;
   for (int i = 0; i < element.size(); ++i) {
     const auto& component = element[i];
@@ -108,7 +337,16 @@ absl::Status CompressElement(const std::vector<Tensor>& element,
     component.shape().AsProto(metadata->mutable_tensor_shape());
     if (DataTypeCanUseMemcpy(component.dtype())) {
       const TensorBuffer* buffer = DMAHelper::buffer(&component);
-      if (buffer) {
+      if (buffer && ShouldByteShuffle(options, component)) {
+        ShuffleBytes</*kUnshuffle=*/false>(buffer->base<const char>(),
+                                           buffer->size(),
+                                           DataTypeSize(component.dtype()),
+                                           shuffled_pos);
+        iov.Add(shuffled_pos, buffer->size());
+        shuffled_pos += buffer->size();
+        metadata->set_byte_shuffled(true);
+        metadata->add_uncompressed_bytes(buffer->size());
+      } else if (buffer) {
         iov.Add(buffer->data(), buffer->size());
         metadata->add_uncompressed_bytes(buffer->size());
       }
@@ -129,24 +367,35 @@ absl::Status CompressElement(const std::vector<Tensor>& element,
     }
   }
 
-  if (iov.NumBytes() > std::numeric_limits<uint32_t>::max()) {
-    return absl::OutOfRangeError(
-        absl::StrCat("Encountered dataset element of size ", iov.NumBytes(),
-                     ", exceeding the 4GB Snappy limit."));
+  switch (options.codec) {
+    case CompressedElement::SNAPPY:
+      TF_RETURN_IF_ERROR(SnappyCompress(iov, out->mutable_data()));
+      break;
+    case CompressedElement::ZSTD:
+      TF_RETURN_IF_ERROR(
+          ZstdCompress(iov, options.level, out->mutable_data()));
+      break;
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unsupported compression codec: ",
+                       static_cast<int>(options.codec)));
   }
-  if (!port::Snappy_CompressFromIOVec(iov.Data(), iov.NumBytes(),
-                                      out->mutable_data())) {
-    return absl::InternalError("Failed to compress using snappy.");
+  if (options.codec == CompressedElement::SNAPPY && total_shuffled_size == 0) {
+    out->set_version(kSnappyElementVersion);
+  } else {
+    out->set_version(kCompressedElementVersion);
+    out->set_codec(options.codec);
   }
-  out->set_version(kCompressedElementVersion);
   VLOG(3) << "Compressed element from " << iov.NumBytes() << " bytes to "
-          << out->data().size() << " bytes";
+          << out->data().size() << " bytes using "
+          << CompressedElement::Codec_Name(options.codec);
   return absl::OkStatus();
 }
 
 absl::Status UncompressElement(const CompressedElement& compressed,
                                std::vector<Tensor>* out) {
-  if (compressed.version() != kCompressedElementVersion) {
+  if (compressed.version() != kSnappyElementVersion &&
+      compressed.version() != kCompressedElementVersion) {
     return absl::InternalError(absl::StrCat(
         "Unsupported compressed element version: ", compressed.version()));
   }
@@ -154,10 +403,11 @@ absl::Status UncompressElement(const CompressedElement& compressed,
   out->clear();
   out->reserve(num_components);
 
-  // First pass: preprocess the non`memcpy`able tensors.
+  // First pass: preprocess the non`memcpy`able and byte shuffled tensors.
   size_t num_string_tensors = 0;
   size_t num_string_tensor_strings = 0;
   size_t total_nonmemcpyable_size = 0;
+  size_t total_shuffled_size = 0;
   for (const auto& metadata : compressed.component_metadata()) {
     if (metadata.dtype() == DT_STRING) {
       ++num_string_tensors;
@@ -169,14 +419,26 @@ absl::Status UncompressElement(const CompressedElement& compressed,
         return absl::InvalidArgumentError(
             "Missing uncompressed_bytes metadata for non-empty tensor");
       }
+      if (metadata.byte_shuffled() &&
+          (!DataTypeCanUseMemcpy(metadata.dtype()) ||
+           DataTypeSize(metadata.dtype()) == 0 || num_elements == 0)) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Unexpected byte shuffled tensor of type ",
+            DataTypeString(metadata.dtype()), " and shape ",
+            shape.DebugString()));
+      }
       if (!DataTypeCanUseMemcpy(metadata.dtype()) && num_elements > 0) {
         total_nonmemcpyable_size += metadata.uncompressed_bytes(0);
       }
+      if (metadata.byte_shuffled()) {
+        total_shuffled_size += metadata.uncompressed_bytes(0);
+      }
     }
   }
 
   // Second pass: prepare the memory to be uncompressed into.
-  // - `memcpy`able tensors are directly uncompressed into via a single iovec.
+  // - `memcpy`able tensors are directly uncompressed into via a single iovec,
+  // or, if they are byte shuffled, uncompressed into a string.
   // - String tensors are directly uncompressed into via multiple iovecs (one
   // for each string).
   // - All other tensors are uncompressed into a string (a `tstring` for access
@@ -185,6 +447,9 @@ absl::Status UncompressElement(const CompressedElement& compressed,
   tstring nonmemcpyable;
   nonmemcpyable.resize_uninitialized(total_nonmemcpyable_size);
   char* nonmemcpyable_pos = nonmemcpyable.mdata();
+  tstring shuffled;
+  shuffled.resize_uninitialized(total_shuffled_size);
+  char* shuffled_pos = shuffled.mdata();
   for (const auto& metadata : compressed.component_metadata()) {
     if (DataTypeCanUseMemcpy(metadata.dtype())) {
       TensorShape shape(metadata.tensor_shape());
@@ -197,7 +462,12 @@ absl::Status UncompressElement(const CompressedElement& compressed,
               "uncompressed_bytes (", metadata.uncompressed_bytes(0),
               ") exceeds allocated buffer size (", buffer->size(), ")"));
         }
-        iov.Add(buffer->data(), metadata.uncompressed_bytes(0));
+        if (metadata.byte_shuffled()) {
+          iov.Add(shuffled_pos, metadata.uncompressed_bytes(0));
+          shuffled_pos += metadata.uncompressed_bytes(0);
+        } else {
+          iov.Add(buffer->data(), metadata.uncompressed_bytes(0));
+        }
       }
     } else if (metadata.dtype() == DT_STRING) {
       out->emplace_back(metadata.dtype(), metadata.tensor_shape());
@@ -224,32 +494,34 @@ absl::Status UncompressElement(const CompressedElement& compressed,
   }
 
   // Step 2: Uncompress into the iovec.
-  const std::string& compressed_data = compressed.data();
-  size_t uncompressed_size;
-  if (!port::Snappy_GetUncompressedLength(
-          compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
-    return absl::InternalError(absl::StrCat(
-        "Could not get snappy uncompressed length. Compressed data size: ",
-        compressed_data.size()));
-  }
-  if (uncompressed_size != static_cast<size_t>(iov.NumBytes())) {
-    return absl::InternalError(absl::StrCat(
-        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
-        " whereas the tensor metadata suggests ", iov.NumBytes()));
-  }
-  if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
-                                      compressed_data.size(), iov.Data(),
-                                      iov.NumPieces())) {
-    return absl::InternalError("Failed to perform snappy decompression.");
+  switch (compressed.codec()) {
+    case CompressedElement::SNAPPY:
+      TF_RETURN_IF_ERROR(SnappyUncompress(compressed.data(), iov));
+      break;
+    case CompressedElement::ZSTD:
+      TF_RETURN_IF_ERROR(ZstdUncompress(compressed.data(), iov));
+      break;
+    default:
+      return absl::InternalError(
+          absl::StrCat("Unsupported compression codec: ",
+                       static_cast<int>(compressed.codec())));
   }
 
-  // Third pass: deserialize nonstring, non`memcpy`able tensors.
+  // Third pass: deserialize nonstring, non`memcpy`able tensors, and unshuffle
+  // byte shuffled tensors.
   nonmemcpyable_pos = nonmemcpyable.mdata();
+  shuffled_pos = shuffled.mdata();
   for (int i = 0; i < num_components; ++i) {
     const CompressedComponentMetadata& metadata =
         compressed.component_metadata(i);
-    if (!DataTypeCanUseMemcpy(metadata.dtype()) &&
-        metadata.dtype() != DT_STRING) {
+    if (metadata.byte_shuffled()) {
+      ShuffleBytes</*kUnshuffle=*/true>(
+          shuffled_pos, metadata.uncompressed_bytes(0),
+          DataTypeSize(metadata.dtype()),
+          DMAHelper::buffer(&out->at(i))->base<char>());
+      shuffled_pos += metadata.uncompressed_bytes(0);
+    } else if (!DataTypeCanUseMemcpy(metadata.dtype()) &&
+               metadata.dtype() != DT_STRING) {
       TensorProto tp;
       if (!tp.ParseFromString(
               {nonmemcpyable_pos,
@@ -18,6 +18,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/status.h"
@@ -25,12 +26,34 @@ limitations under the License.
 namespace tensorflow {
 namespace data {
 
+// Options for `CompressElement`.
+struct ElementCompressionOptions {
+  CompressedElement::Codec codec = CompressedElement::SNAPPY;
+  // The ZSTD compression level. 0 selects the ZSTD default level; negative
+  // levels trade compression ratio for speed. Ignored by SNAPPY.
+  int level = 0;
+  // Whether to shuffle the bytes of numeric tensors before compressing them.
+  // Grouping the bytes by significance usually improves the compression
+  // ratio of numeric data, at the cost of one copy of the tensors.
+  bool byte_shuffle = false;
+};
+
+// Parses a codec name ("SNAPPY" or "ZSTD") into `codec`.
+absl::Status ParseCompressionCodec(absl::string_view name,
+                                   CompressedElement::Codec* codec);
+
 // Compresses the components of `element` into the `CompressedElement` proto.
 //
 // In addition to writing the actual compressed bytes, `Compress` fills
 // out the per-component metadata for the `CompressedElement`.
 //
-// Returns an error if the uncompressed size of the element exceeds 4GB.
+// Returns an error if the codec is SNAPPY and the uncompressed size of the
+// element exceeds 4GB.
+absl::Status CompressElement(const std::vector<Tensor>& element,
+                             const ElementCompressionOptions& options,
+                             CompressedElement* out);
+
+// Compresses `element` with the default options (SNAPPY, no byte shuffling).
 absl::Status CompressElement(const std::vector<Tensor>& element,
                              CompressedElement* out);
 
@@ -14,17 +14,21 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <cmath>
 #include <cstdint>
+#include <tuple>
 #include <vector>
 
 #include <gmock/gmock.h>
 #include "absl/status/status_matchers.h"
+#include "absl/strings/str_cat.h"
 #include "xla/tsl/platform/status_matchers.h"
 #include "xla/tsl/protobuf/error_codes.pb.h"
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 
 namespace tensorflow {
@@ -65,6 +69,11 @@ std::vector<std::vector<Tensor>> TestCases() {
       // Larger int64.
       {CreateTensor<int64_t>(TensorShape{128, 128}),
        CreateTensor<int64_t>(TensorShape{64, 2})},
+      // Mix of numeric types.
+      {CreateTensor<float>(TensorShape{2, 3}, {0.5, 1.5, 2.5, -3.5, 4.5, 5.5}),
+       CreateTensor<int32_t>(TensorShape{3}, {-1, 0, 1 << 20}),
+       CreateTensor<bool>(TensorShape{2}, {true, false}),
+       CreateTensor<Eigen::half>(TensorShape{1}, {Eigen::half(1.5)})},
       // Variants.
       {
           DatasetOpsTestBase::CreateTestVariantTensor(
@@ -103,7 +112,7 @@ TEST_P(ParameterizedCompressionUtilsTest, VersionMismatch) {
   CompressedElement compressed;
   TF_ASSERT_OK(CompressElement(element, &compressed));
 
-  compressed.set_version(1);
+  compressed.set_version(2);
   std::vector<Tensor> round_trip_element;
   EXPECT_THAT(UncompressElement(compressed, &round_trip_element),
               absl_testing::StatusIs(error::INTERNAL));
@@ -112,6 +121,189 @@ TEST_P(ParameterizedCompressionUtilsTest, VersionMismatch) {
 INSTANTIATE_TEST_SUITE_P(Instantiation, ParameterizedCompressionUtilsTest,
                          ::testing::ValuesIn(TestCases()));
 
+std::vector<ElementCompressionOptions> CompressionOptions() {
+  return {
+      {CompressedElement::SNAPPY, /*level=*/0, /*byte_shuffle=*/true},
+      {CompressedElement::ZSTD, /*level=*/0, /*byte_shuffle=*/false},
+      {CompressedElement::ZSTD, /*level=*/-5, /*byte_shuffle=*/false},
+      {CompressedElement::ZSTD, /*level=*/3, /*byte_shuffle=*/true},
+  };
+}
+
+class ParameterizedCodecTest
+    : public DatasetOpsTestBase,
+      public ::testing::WithParamInterface<
+          std::tuple<std::vector<Tensor>, ElementCompressionOptions>> {};
+
+TEST_P(ParameterizedCodecTest, RoundTrip) {
+  const auto& [element, options] = GetParam();
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, options, &compressed));
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(
+      ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+}
+
+TEST_P(ParameterizedCodecTest, TruncatedData) {
+  const auto& [element, options] = GetParam();
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, options, &compressed));
+  compressed.mutable_data()->resize(compressed.data().size() / 2);
+  std::vector<Tensor> round_trip_element;
+  EXPECT_THAT(UncompressElement(compressed, &round_trip_element),
+              absl_testing::StatusIs(error::INTERNAL));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Instantiation, ParameterizedCodecTest,
+    ::testing::Combine(::testing::ValuesIn(TestCases()),
+                       ::testing::ValuesIn(CompressionOptions())));
+
+TEST(CompressionUtilsTest, CodecVersion) {
+  std::vector<Tensor> element = {
+      CreateTensor<int64_t>(TensorShape{2}, {1, 2}),
+      CreateTensor<tstring>(TensorShape{}, {"abc"})};
+  CompressedElement compressed;
+  ElementCompressionOptions options;
+  options.codec = CompressedElement::ZSTD;
+  TF_ASSERT_OK(CompressElement(element, options, &compressed));
+  EXPECT_EQ(1, compressed.version());
+  EXPECT_EQ(CompressedElement::ZSTD, compressed.codec());
+
+  // Byte shuffling needs version 1, even with the default codec.
+  compressed.Clear();
+  options.codec = CompressedElement::SNAPPY;
+  options.byte_shuffle = true;
+  TF_ASSERT_OK(CompressElement(element, options, &compressed));
+  EXPECT_EQ(1, compressed.version());
+  EXPECT_TRUE(compressed.component_metadata(0).byte_shuffled());
+  EXPECT_FALSE(compressed.component_metadata(1).byte_shuffled());
+}
+
+TEST(CompressionUtilsTest, ZstdExceeds4GB) {
+  std::vector<Tensor> element = {
+      CreateTensor<int64_t>(TensorShape{1024, 1024, 513})};  // Just over 4GB.
+  element[0].flat<int64_t>().setZero();
+  CompressedElement compressed;
+  ElementCompressionOptions options;
+  options.codec = CompressedElement::ZSTD;
+  options.level = 1;
+  TF_ASSERT_OK(CompressElement(element, options, &compressed));
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  EXPECT_EQ(element[0].shape(), round_trip_element[0].shape());
+}
+
+TEST(CompressionUtilsTest, ParseCompressionCodec) {
+  CompressedElement::Codec codec;
+  TF_ASSERT_OK(ParseCompressionCodec("ZSTD", &codec));
+  EXPECT_EQ(CompressedElement::ZSTD, codec);
+  TF_ASSERT_OK(ParseCompressionCodec("SNAPPY", &codec));
+  EXPECT_EQ(CompressedElement::SNAPPY, codec);
+  EXPECT_THAT(ParseCompressionCodec("LZ4", &codec),
+              absl_testing::StatusIs(error::INVALID_ARGUMENT));
+}
+
+// Returns an element of the given kind for the benchmarks:
+// 0: a smooth float signal.
+// 1: small int64 values.
+// 2: short strings.
+std::vector<Tensor> BenchmarkElement(int kind) {
+  constexpr int kNumScalars = 1 << 16;
+  switch (kind) {
+    case 0: {
+      Tensor tensor(DT_FLOAT, TensorShape{kNumScalars});
+      auto flat = tensor.flat<float>();
+      for (int i = 0; i < kNumScalars; ++i) {
+        flat(i) = std::sin(i * 0.01f) * 100.0f;
+      }
+      return {tensor};
+    }
+    case 1: {
+      Tensor tensor(DT_INT64, TensorShape{kNumScalars});
+      auto flat = tensor.flat<int64_t>();
+      for (int i = 0; i < kNumScalars; ++i) {
+        flat(i) = (i * 7919) % 1000;
+      }
+      return {tensor};
+    }
+    default: {
+      Tensor tensor(DT_STRING, TensorShape{kNumScalars / 16});
+      auto flat = tensor.flat<tstring>();
+      for (int i = 0; i < flat.size(); ++i) {
+        flat(i) = absl::StrCat("element ", i);
+      }
+      return {tensor};
+    }
+  }
+}
+
+// Returns the compression options for the benchmarks:
+// 0: SNAPPY.
+// 1: SNAPPY with byte shuffling.
+// 2: ZSTD at level -5.
+// 3: ZSTD at level 1.
+// 4: ZSTD at level 1 with byte shuffling.
+ElementCompressionOptions BenchmarkOptions(int index) {
+  switch (index) {
+    case 0:
+      return {CompressedElement::SNAPPY, /*level=*/0, /*byte_shuffle=*/false};
+    case 1:
+      return {CompressedElement::SNAPPY, /*level=*/0, /*byte_shuffle=*/true};
+    case 2:
+      return {CompressedElement::ZSTD, /*level=*/-5, /*byte_shuffle=*/false};
+    case 3:
+      return {CompressedElement::ZSTD, /*level=*/1, /*byte_shuffle=*/false};
+    default:
+      return {CompressedElement::ZSTD, /*level=*/1, /*byte_shuffle=*/true};
+  }
+}
+
+int64_t ElementBytes(const std::vector<Tensor>& element) {
+  int64_t bytes = 0;
+  for (const Tensor& tensor : element) {
+    bytes += tensor.TotalBytes();
+  }
+  return bytes;
+}
+
+void BM_CompressElement(::testing::benchmark::State& state) {
+  std::vector<Tensor> element = BenchmarkElement(state.range(0));
+  ElementCompressionOptions options = BenchmarkOptions(state.range(1));
+  CompressedElement compressed;
+  for (auto s : state) {
+    compressed.Clear();
+    TF_CHECK_OK(CompressElement(element, options, &compressed));
+  }
+  state.SetBytesProcessed(state.iterations() * ElementBytes(element));
+  state.counters["compression_ratio"] =
+      static_cast<double>(ElementBytes(element)) / compressed.data().size();
+}
+
+void BM_UncompressElement(::testing::benchmark::State& state) {
+  std::vector<Tensor> element = BenchmarkElement(state.range(0));
+  CompressedElement compressed;
+  TF_CHECK_OK(
+      CompressElement(element, BenchmarkOptions(state.range(1)), &compressed));
+  for (auto s : state) {
+    std::vector<Tensor> uncompressed;
+    TF_CHECK_OK(UncompressElement(compressed, &uncompressed));
+  }
+  state.SetBytesProcessed(state.iterations() * ElementBytes(element));
+}
+
+void CodecBenchmarkArgs(::benchmark::internal::Benchmark* b) {
+  for (int kind = 0; kind < 3; ++kind) {
+    for (int options = 0; options < 5; ++options) {
+      b->ArgPair(kind, options);
+    }
+  }
+}
+
+BENCHMARK(BM_CompressElement)->Apply(CodecBenchmarkArgs);
+BENCHMARK(BM_UncompressElement)->Apply(CodecBenchmarkArgs);
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -20,6 +20,7 @@ limitations under the License.
 #include <cstdint>
 #include <cstdlib>
 #include <functional>
+#include <memory>
 #include <random>
 #include <string>
 #include <utility>
@@ -28,6 +29,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
@@ -48,6 +50,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/thread_factory.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
@@ -56,7 +59,9 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/regexp.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/tstring.h"
@@ -98,6 +103,7 @@ constexpr char kShuffleAndRepeatFusionOpt[] = "shuffle_and_repeat_fusion";
 constexpr char kFilterFusionOpt[] = "filter_fusion";
 constexpr char kMapAndFilterFusionOpt[] = "map_and_filter_fusion";
 constexpr char kMapFusionOpt[] = "map_fusion";
+constexpr char kMapVectorizationOpt[] = "map_vectorization";
 constexpr char kParallelBatchOpt[] = "parallel_batch";
 constexpr char kAutotuneBufferSizesOpt[] = "autotune_buffer_sizes";
 constexpr char kDisablePrefetchLegacyAutotuneOpt[] =
@@ -200,6 +206,14 @@ void DefaultOptimizationGraphRewrites(
       optimization_disabled->insert(kMapFusionOpt);
     }
   }
+  if (optimization_options.optional_map_vectorization_case() ==
+      OptimizationOptions::kMapVectorization) {
+    if (optimization_options.map_vectorization()) {
+      optimization_enabled->insert(kMapVectorizationOpt);
+    } else {
+      optimization_disabled->insert(kMapVectorizationOpt);
+    }
+  }
   if (optimization_options.optional_noop_elimination_case() ==
       OptimizationOptions::kNoopElimination) {
     if (optimization_options.noop_elimination()) {
@@ -448,6 +462,46 @@ std::function<void(std::function<void()>)> RunnerWithMaxParallelism(
       std::move(runner), std::placeholders::_1);
 }
 
+namespace {
+
+class NumaThreadFactory : public ThreadFactory {
+ public:
+  NumaThreadFactory(std::shared_ptr<ThreadFactory> thread_factory,
+                    int numa_node)
+      : thread_factory_(std::move(thread_factory)), numa_node_(numa_node) {}
+
+  std::unique_ptr<Thread> StartThread(const std::string& name,
+                                      std::function<void()> fn) override {
+    if (thread_factory_ == nullptr) {
+      ThreadOptions thread_options;
+      thread_options.numa_node = numa_node_;
+      return absl::WrapUnique(
+          Env::Default()->StartThread(thread_options, name, std::move(fn)));
+    }
+    // The threads of `thread_factory_` may be backed by physical threads that
+    // also run other work, so the affinity is restored when `fn` returns.
+    return thread_factory_->StartThread(
+        name, [numa_node = numa_node_, fn = std::move(fn)]() {
+          const int previous_numa_node = port::NUMAGetThreadNodeAffinity();
+          port::NUMASetThreadNodeAffinity(numa_node);
+          fn();
+          port::NUMASetThreadNodeAffinity(previous_numa_node);
+        });
+  }
+
+ private:
+  const std::shared_ptr<ThreadFactory> thread_factory_;
+  const int numa_node_;
+};
+
+}  // namespace
+
+std::shared_ptr<ThreadFactory> ThreadFactoryWithNumaAffinity(
+    std::shared_ptr<ThreadFactory> thread_factory, int numa_node) {
+  return std::make_shared<NumaThreadFactory>(std::move(thread_factory),
+                                             numa_node);
+}
+
 absl::Status DeterminismPolicy::FromString(const std::string& s,
                                            DeterminismPolicy* out) {
   DeterminismPolicy::Type type;
@@ -938,6 +992,11 @@ bool ShouldUsePrivateThreadPool(const Options& options) {
          ThreadingOptions::kPrivateThreadpoolSize;
 }
 
+bool ShouldUseNumaAffinity(const Options& options) {
+  return options.threading_options().optional_numa_node_case() ==
+         ThreadingOptions::kNumaNode;
+}
+
 bool ShouldUseAutotuning(const Options& options) {
   return options.autotune_options().optional_enabled_case() !=
              AutotuneOptions::kEnabled ||
@@ -225,6 +225,12 @@ absl::Status IsNodeStateful(const FunctionLibraryDefinition& library,
 std::function<void(std::function<void()>)> RunnerWithMaxParallelism(
     std::function<void(std::function<void()>)> runner, int max_parallelism);
 
+// Creates a thread factory that runs the threads of `thread_factory` (or of
+// `Env::Default()` if `thread_factory` is null) with affinity to the given NUMA
+// node.
+std::shared_ptr<ThreadFactory> ThreadFactoryWithNumaAffinity(
+    std::shared_ptr<ThreadFactory> thread_factory, int numa_node);
+
 // Op for creating a typed dummy resource.
 //
 // This op is used to provide a resource "placeholder" for ops such as
@@ -342,6 +348,9 @@ bool ShouldConfigureMaxIntraOpParallelism(const Options& options);
 // Determines whether private threadpool should be used.
 bool ShouldUsePrivateThreadPool(const Options& options);
 
+// Determines whether threads should be pinned to a NUMA node.
+bool ShouldUseNumaAffinity(const Options& options);
+
 // Determines whether autotuning should be used.
 bool ShouldUseAutotuning(const Options& options);
 
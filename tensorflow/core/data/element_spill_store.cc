@@ -0,0 +1,232 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/element_spill_store.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+
+namespace tensorflow {
+namespace data {
+
+ElementSpillStore::ElementSpillStore(Env* env, std::string directory,
+                                     int64_t block_size_bytes,
+                                     int64_t file_size_bytes)
+    : env_(env),
+      directory_(std::move(directory)),
+      block_size_bytes_(block_size_bytes),
+      file_size_bytes_(file_size_bytes) {}
+
+ElementSpillStore::~ElementSpillStore() {
+  while (!files_.empty()) {
+    Delete(files_.begin()->first);
+  }
+}
+
+absl::Status ElementSpillStore::Put(const std::vector<Tensor>& element,
+                                    Location* location) {
+  CompressedElement compressed;
+  TF_RETURN_IF_ERROR(CompressElement(element, &compressed));
+  std::string serialized;
+  if (!compressed.SerializeToString(&serialized)) {
+    return absl::InternalError(
+        "Failed to serialize a dataset element to spill it to disk.");
+  }
+  const int64_t id = next_id_++;
+  TF_RETURN_IF_ERROR(Append(id, serialized));
+  live_bytes_ += serialized.size();
+  location->id = id;
+  return absl::OkStatus();
+}
+
+absl::Status ElementSpillStore::Get(const Location& location,
+                                    std::vector<Tensor>* element) {
+  auto it = entries_.find(location.id);
+  if (it == entries_.end()) {
+    return absl::InternalError(absl::StrCat(
+        "Spilled dataset element ", location.id, " was already taken."));
+  }
+  std::string scratch;
+  absl::string_view data;
+  TF_RETURN_IF_ERROR(Read(it->second, &scratch, &data));
+  CompressedElement compressed;
+  if (!compressed.ParseFromArray(data.data(), data.size())) {
+    return absl::DataLossError(
+        absl::StrCat("Failed to parse a dataset element spilled to ",
+                     files_[it->second.file].filename));
+  }
+  element->clear();
+  return UncompressElement(compressed, element);
+}
+
+absl::Status ElementSpillStore::Take(const Location& location,
+                                     std::vector<Tensor>* element) {
+  TF_RETURN_IF_ERROR(Get(location, element));
+  auto it = entries_.find(location.id);
+  const Entry entry = it->second;
+  entries_.erase(it);
+  live_bytes_ -= entry.size;
+  File& file = files_[entry.file];
+  file.ids.erase(location.id);
+  file.live_bytes -= entry.size;
+  if (file.ids.empty() && entry.file != current_file_) {
+    Delete(entry.file);
+    return absl::OkStatus();
+  }
+  return MaybeCompact(entry.file);
+}
+
+absl::Status ElementSpillStore::Append(int64_t id,
+                                       absl::string_view serialized) {
+  if (current_file_ == -1) {
+    TF_RETURN_IF_ERROR(StartFile());
+  }
+  const int64_t file_id = current_file_;
+  File& file = files_[file_id];
+  Entry& entry = entries_[id];
+  entry.file = file_id;
+  entry.offset = file.written_bytes + file.block.size();
+  entry.size = serialized.size();
+  file.block.append(serialized.data(), serialized.size());
+  file.ids.insert(id);
+  file.live_bytes += serialized.size();
+  size_bytes_ += serialized.size();
+
+  if (static_cast<int64_t>(file.block.size()) >= block_size_bytes_) {
+    TF_RETURN_IF_ERROR(WriteBlock(file));
+  }
+  if (static_cast<int64_t>(file.written_bytes + file.block.size()) >=
+      file_size_bytes_) {
+    TF_RETURN_IF_ERROR(Seal(file));
+    current_file_ = -1;
+    // Elements may have been taken while the file was being written.
+    TF_RETURN_IF_ERROR(MaybeCompact(file_id));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ElementSpillStore::Read(const Entry& entry, std::string* scratch,
+                                     absl::string_view* data) {
+  File& file = files_[entry.file];
+  if (entry.offset >= file.written_bytes) {
+    // The element has not been written out yet.
+    *data = absl::string_view(file.block)
+                .substr(entry.offset - file.written_bytes, entry.size);
+    return absl::OkStatus();
+  }
+  scratch->resize(entry.size);
+  TF_RETURN_IF_ERROR(
+      file.reader->Read(entry.offset, entry.size, data, scratch->data()));
+  if (data->size() != entry.size) {
+    return absl::DataLossError(absl::StrCat(
+        "Scratch file ", file.filename, " is truncated: expected ", entry.size,
+        " bytes at offset ", entry.offset, ", got ", data->size()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ElementSpillStore::MaybeCompact(int64_t file_id) {
+  File& file = files_[file_id];
+  if (file.writer != nullptr || 2 * file.live_bytes >= file.written_bytes) {
+    return absl::OkStatus();
+  }
+  VLOG(2) << "Compacting scratch file " << file.filename << ": "
+          << file.live_bytes << " of " << file.written_bytes
+          << " bytes are held";
+  // Appending may seal and compact other files, but never this one, which is
+  // sealed already.
+  const std::vector<int64_t> ids(file.ids.begin(), file.ids.end());
+  std::string scratch;
+  for (int64_t id : ids) {
+    absl::string_view data;
+    TF_RETURN_IF_ERROR(Read(entries_[id], &scratch, &data));
+    TF_RETURN_IF_ERROR(Append(id, data));
+  }
+  Delete(file_id);
+  return absl::OkStatus();
+}
+
+absl::Status ElementSpillStore::StartFile() {
+  std::string filename;
+  if (directory_.empty()) {
+    filename = io::GetTempFilename("spill");
+  } else {
+    TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(directory_));
+    filename = io::JoinPath(directory_, "tf_data_spill");
+    if (!env_->CreateUniqueFileName(&filename, ".spill")) {
+      return absl::InternalError(absl::StrCat(
+          "Failed to create a unique scratch file name in ", directory_));
+    }
+  }
+  File file;
+  file.filename = filename;
+  TF_RETURN_IF_ERROR(env_->NewWritableFile(filename, &file.writer));
+  TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(filename, &file.reader));
+  VLOG(2) << "Spilling dataset elements to " << filename;
+  current_file_ = next_file_++;
+  files_[current_file_] = std::move(file);
+  return absl::OkStatus();
+}
+
+absl::Status ElementSpillStore::WriteBlock(File& file) {
+  if (file.block.empty()) return absl::OkStatus();
+  TF_RETURN_IF_ERROR(file.writer->Append(file.block));
+  // Flushes, so that the block is visible to `file.reader`.
+  TF_RETURN_IF_ERROR(file.writer->Flush());
+  file.written_bytes += file.block.size();
+  file.block.clear();
+  return absl::OkStatus();
+}
+
+absl::Status ElementSpillStore::Seal(File& file) {
+  TF_RETURN_IF_ERROR(WriteBlock(file));
+  absl::Status s = file.writer->Close();
+  file.writer.reset();
+  return s;
+}
+
+void ElementSpillStore::Delete(int64_t file_id) {
+  auto it = files_.find(file_id);
+  File& file = it->second;
+  if (file.writer != nullptr) {
+    file.writer->Close().IgnoreError();
+    file.writer.reset();
+  }
+  file.reader.reset();
+  size_bytes_ -= file.written_bytes + file.block.size();
+  absl::Status s = env_->DeleteFile(file.filename);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete scratch file " << file.filename << ": "
+                 << s;
+  }
+  files_.erase(it);
+  if (file_id == current_file_) current_file_ = -1;
+}
+
+}  // namespace data
+}  // namespace tensorflow
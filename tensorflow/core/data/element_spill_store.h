@@ -0,0 +1,144 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_ELEMENT_SPILL_STORE_H_
+#define TENSORFLOW_CORE_DATA_ELEMENT_SPILL_STORE_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+
+namespace tensorflow {
+namespace data {
+
+// Holds dataset elements in local scratch files, for buffers of elements that
+// do not fit in memory.
+//
+// Elements are compressed and appended to the current scratch file in blocks
+// of `block_size_bytes`, so that the disk sees large sequential writes. Each
+// element can then be read back individually. A scratch file is sealed once it
+// reaches `file_size_bytes`, and deleted once all of its elements have been
+// taken. A sealed file in which less than half of the bytes belong to elements
+// still held is compacted: its remaining elements are appended to the current
+// file and it is deleted. The scratch files therefore take at most about twice
+// the bytes of the elements held, plus `file_size_bytes` for the current file.
+//
+// All scratch files are deleted when the store is destroyed.
+//
+// This class is not thread-safe.
+class ElementSpillStore {
+ public:
+  static constexpr int64_t kDefaultBlockSizeBytes = 4 << 20;      // 4MB
+  static constexpr int64_t kDefaultFileSizeBytes = 256LL << 20;  // 256MB
+
+  // Identifies an element in the store. It stays valid while the element is
+  // held, even if compaction moves the element to another file.
+  struct Location {
+    int64_t id = -1;
+  };
+
+  // Scratch files are created in `directory`, or in a local temporary
+  // directory if `directory` is empty.
+  ElementSpillStore(Env* env, std::string directory,
+                    int64_t block_size_bytes = kDefaultBlockSizeBytes,
+                    int64_t file_size_bytes = kDefaultFileSizeBytes);
+  ~ElementSpillStore();
+
+  ElementSpillStore(const ElementSpillStore&) = delete;
+  ElementSpillStore& operator=(const ElementSpillStore&) = delete;
+
+  // Adds `element` to the store and returns its location in `*location`.
+  absl::Status Put(const std::vector<Tensor>& element, Location* location);
+
+  // Reads the element at `location`, which remains in the store.
+  absl::Status Get(const Location& location, std::vector<Tensor>* element);
+
+  // Reads the element at `location` and removes it from the store.
+  absl::Status Take(const Location& location, std::vector<Tensor>* element);
+
+  // Returns the number of elements in the store.
+  int64_t num_elements() const { return entries_.size(); }
+
+  // Returns the number of bytes of the elements in the store, as written to
+  // the scratch files.
+  int64_t live_bytes() const { return live_bytes_; }
+
+  // Returns the number of bytes of the scratch files, including data that has
+  // not been written out yet.
+  int64_t size_bytes() const { return size_bytes_; }
+
+ private:
+  // The position of an element in the scratch files.
+  struct Entry {
+    int64_t file = -1;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+  };
+
+  struct File {
+    std::string filename;
+    // Null once the file is sealed.
+    std::unique_ptr<WritableFile> writer;
+    std::unique_ptr<RandomAccessFile> reader;
+    // Number of bytes written to `writer`.
+    uint64_t written_bytes = 0;
+    // The block that follows the written bytes.
+    std::string block;
+    // The ids of the elements held in the file, and their total size.
+    absl::flat_hash_set<int64_t> ids;
+    uint64_t live_bytes = 0;
+  };
+
+  // Appends the serialized element `id` to the current file.
+  absl::Status Append(int64_t id, absl::string_view serialized);
+  // Returns the serialized element at `entry` in `*data`, which may point into
+  // `*scratch`.
+  absl::Status Read(const Entry& entry, std::string* scratch,
+                    absl::string_view* data);
+  // Compacts `file_id` if it is sealed and mostly holds taken elements.
+  absl::Status MaybeCompact(int64_t file_id);
+  absl::Status StartFile();
+  absl::Status WriteBlock(File& file);
+  absl::Status Seal(File& file);
+  void Delete(int64_t file_id);
+
+  Env* const env_;
+  const std::string directory_;
+  const int64_t block_size_bytes_;
+  const int64_t file_size_bytes_;
+
+  std::map<int64_t, File> files_;
+  // The file that elements are appended to, or -1 if there is none.
+  int64_t current_file_ = -1;
+  int64_t next_file_ = 0;
+  absl::flat_hash_map<int64_t, Entry> entries_;
+  int64_t next_id_ = 0;
+  int64_t live_bytes_ = 0;
+  int64_t size_bytes_ = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_ELEMENT_SPILL_STORE_H_
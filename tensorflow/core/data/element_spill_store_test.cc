@@ -0,0 +1,153 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/element_spill_store.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::vector<Tensor> MakeElement(int64_t i) {
+  return {CreateTensor<int64_t>(TensorShape{16}, std::vector<int64_t>(16, i)),
+          CreateTensor<tstring>(TensorShape{}, {absl::StrCat("element ", i)})};
+}
+
+// Returns a new empty directory for scratch files.
+std::string TestDirectory(const std::string& name) {
+  std::string directory =
+      io::JoinPath(testing::TmpDir(), "element_spill_store_test", name);
+  int64_t undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(directory, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  return directory;
+}
+
+int64_t NumFiles(const std::string& directory) {
+  std::vector<std::string> children;
+  TF_CHECK_OK(Env::Default()->GetChildren(directory, &children));
+  return children.size();
+}
+
+TEST(ElementSpillStoreTest, RoundTrip) {
+  // Small blocks and files, so that elements are read both from the block
+  // in memory and from written, sealed and unsealed files.
+  ElementSpillStore store(Env::Default(), TestDirectory("round_trip"),
+                          /*block_size_bytes=*/256,
+                          /*file_size_bytes=*/1024);
+  std::vector<ElementSpillStore::Location> locations(100);
+  for (int64_t i = 0; i < 100; ++i) {
+    TF_ASSERT_OK(store.Put(MakeElement(i), &locations[i]));
+  }
+  EXPECT_EQ(100, store.num_elements());
+  EXPECT_GT(store.size_bytes(), 0);
+
+  std::vector<Tensor> element;
+  for (int64_t i : {99, 0, 50}) {
+    TF_ASSERT_OK(store.Get(locations[i], &element));
+    TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(MakeElement(i), element,
+                                                 /*compare_order=*/true));
+  }
+  EXPECT_EQ(100, store.num_elements());
+  for (int64_t i = 99; i >= 0; --i) {
+    TF_ASSERT_OK(store.Take(locations[i], &element));
+    TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(MakeElement(i), element,
+                                                 /*compare_order=*/true));
+  }
+  EXPECT_EQ(0, store.num_elements());
+}
+
+TEST(ElementSpillStoreTest, DeletesDrainedFiles) {
+  const std::string directory = TestDirectory("drained");
+  auto store = std::make_unique<ElementSpillStore>(
+      Env::Default(), directory, /*block_size_bytes=*/256,
+      /*file_size_bytes=*/1024);
+  std::vector<ElementSpillStore::Location> locations(100);
+  for (int64_t i = 0; i < 100; ++i) {
+    TF_ASSERT_OK(store->Put(MakeElement(i), &locations[i]));
+  }
+  EXPECT_GT(NumFiles(directory), 2);
+
+  // Taking the elements in order drains the sealed files one by one.
+  std::vector<Tensor> element;
+  for (int64_t i = 0; i < 100; ++i) {
+    TF_ASSERT_OK(store->Take(locations[i], &element));
+  }
+  EXPECT_LE(NumFiles(directory), 1);
+  const int64_t size_bytes = store->size_bytes();
+  EXPECT_TRUE(absl::IsInternal(store->Get(locations[0], &element)));
+  EXPECT_EQ(size_bytes, store->size_bytes());
+
+  store.reset();
+  EXPECT_EQ(0, NumFiles(directory));
+}
+
+TEST(ElementSpillStoreTest, CompactsMostlyTakenFiles) {
+  const std::string directory = TestDirectory("compacted");
+  const int64_t file_size_bytes = 1024;
+  ElementSpillStore store(Env::Default(), directory, /*block_size_bytes=*/256,
+                          file_size_bytes);
+  std::vector<ElementSpillStore::Location> locations(200);
+  for (int64_t i = 0; i < 200; ++i) {
+    TF_ASSERT_OK(store.Put(MakeElement(i), &locations[i]));
+  }
+  const int64_t num_files = NumFiles(directory);
+
+  // Holding one element in ten would otherwise keep every file on disk.
+  std::vector<Tensor> element;
+  for (int64_t i = 0; i < 200; ++i) {
+    if (i % 10 != 0) {
+      TF_ASSERT_OK(store.Take(locations[i], &element));
+    }
+  }
+  EXPECT_EQ(20, store.num_elements());
+  EXPECT_LT(NumFiles(directory), num_files);
+  EXPECT_LE(store.size_bytes(), 2 * store.live_bytes() + 2 * file_size_bytes);
+
+  for (int64_t i = 0; i < 200; i += 10) {
+    TF_ASSERT_OK(store.Take(locations[i], &element));
+    TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(MakeElement(i), element,
+                                                 /*compare_order=*/true));
+  }
+  EXPECT_EQ(0, store.num_elements());
+  EXPECT_EQ(0, store.live_bytes());
+}
+
+TEST(ElementSpillStoreTest, DefaultDirectory) {
+  ElementSpillStore store(Env::Default(), /*directory=*/"");
+  ElementSpillStore::Location location;
+  TF_ASSERT_OK(store.Put(MakeElement(7), &location));
+  std::vector<Tensor> element;
+  TF_ASSERT_OK(store.Take(location, &element));
+  TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(MakeElement(7), element,
+                                               /*compare_order=*/true));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,241 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/prefetch_memory_arbiter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kLimitEnvVar[] = "TF_DATA_PREFETCH_MEMORY_LIMIT_BYTES";
+
+// Weight of the latest sample in the moving average of consumer wait times.
+constexpr double kWaitSmoothing = 0.1;
+
+int64_t DefaultLimitBytes() {
+  int64_t limit_bytes;
+  absl::Status s = ReadInt64FromEnvVar(
+      kLimitEnvVar,
+      static_cast<int64_t>(model::kRamBudgetShare * port::AvailableRam()),
+      &limit_bytes);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to read " << kLimitEnvVar << ": " << s
+                 << ". Prefetch buffers are not limited.";
+    return 0;
+  }
+  return limit_bytes;
+}
+
+}  // namespace
+
+PrefetchMemoryArbiter::TrackedBuffer::~TrackedBuffer() {
+  arbiter_->Deregister(this);
+}
+
+void PrefetchMemoryArbiter::TrackedBuffer::SetBufferedBytes(int64_t bytes) {
+  arbiter_->SetBufferedBytes(this, bytes);
+}
+
+void PrefetchMemoryArbiter::TrackedBuffer::RecordConsumerWait(
+    int64_t wait_us) {
+  arbiter_->RecordConsumerWait(this, wait_us);
+}
+
+bool PrefetchMemoryArbiter::TrackedBuffer::MayProduce() const {
+  return arbiter_->MayProduce(this);
+}
+
+bool PrefetchMemoryArbiter::TrackedBuffer::RequestGrowth(int64_t delta_bytes) {
+  return arbiter_->RequestGrowth(this, delta_bytes);
+}
+
+PrefetchMemoryArbiter::PrefetchMemoryArbiter(int64_t limit_bytes)
+    : limit_bytes_(limit_bytes) {}
+
+PrefetchMemoryArbiter& PrefetchMemoryArbiter::Global() {
+  static PrefetchMemoryArbiter* arbiter =
+      new PrefetchMemoryArbiter(DefaultLimitBytes());
+  return *arbiter;
+}
+
+std::unique_ptr<PrefetchMemoryArbiter::TrackedBuffer>
+PrefetchMemoryArbiter::Register(absl::string_view name) {
+  // `TrackedBuffer` has a private constructor.
+  auto buffer = absl::WrapUnique(new TrackedBuffer(this));
+  mutex_lock l(mu_);
+  buffers_[buffer.get()].name = std::string(name);
+  return buffer;
+}
+
+void PrefetchMemoryArbiter::SetLimit(int64_t limit_bytes) {
+  mutex_lock l(mu_);
+  limit_bytes_ = limit_bytes;
+  if (!Enabled()) {
+    for (auto& [buffer, state] : buffers_) {
+      state.cap_bytes.reset();
+    }
+    projected_bytes_ = buffered_bytes_;
+    return;
+  }
+  Shrink();
+}
+
+PrefetchMemoryArbiter::Stats PrefetchMemoryArbiter::GetStats() const {
+  tf_shared_lock l(mu_);
+  Stats stats;
+  stats.limit_bytes = limit_bytes_;
+  stats.buffered_bytes = buffered_bytes_;
+  stats.num_buffers = buffers_.size();
+  for (const auto& [buffer, state] : buffers_) {
+    if (state.cap_bytes.has_value()) {
+      ++stats.num_capped_buffers;
+    }
+  }
+  stats.num_shrinks = num_shrinks_;
+  stats.num_denied_growths = num_denied_growths_;
+  return stats;
+}
+
+void PrefetchMemoryArbiter::Deregister(const TrackedBuffer* buffer) {
+  mutex_lock l(mu_);
+  auto it = buffers_.find(buffer);
+  if (it == buffers_.end()) {
+    return;
+  }
+  buffered_bytes_ -= it->second.buffered_bytes;
+  projected_bytes_ -= ProjectedBytes(it->second);
+  buffers_.erase(it);
+}
+
+void PrefetchMemoryArbiter::SetBufferedBytes(const TrackedBuffer* buffer,
+                                             int64_t bytes) {
+  mutex_lock l(mu_);
+  BufferState& state = buffers_[buffer];
+  buffered_bytes_ += bytes - state.buffered_bytes;
+  projected_bytes_ -= ProjectedBytes(state);
+  state.buffered_bytes = bytes;
+  projected_bytes_ += ProjectedBytes(state);
+  if (Enabled() && buffered_bytes_ > kShrinkThreshold * limit_bytes_) {
+    Shrink();
+  }
+}
+
+void PrefetchMemoryArbiter::RecordConsumerWait(const TrackedBuffer* buffer,
+                                               int64_t wait_us) {
+  mutex_lock l(mu_);
+  BufferState& state = buffers_[buffer];
+  state.wait_us =
+      (1.0 - kWaitSmoothing) * state.wait_us + kWaitSmoothing * wait_us;
+  if (wait_us <= 0 || !state.cap_bytes.has_value()) {
+    return;
+  }
+  // The consumer is starved. Give the buffer more room if there is headroom.
+  projected_bytes_ -= ProjectedBytes(state);
+  if (!Enabled()) {
+    state.cap_bytes.reset();
+  } else if (buffered_bytes_ < kTargetFraction * limit_bytes_) {
+    *state.cap_bytes = std::max<int64_t>(*state.cap_bytes, 1) * 2;
+  }
+  projected_bytes_ += ProjectedBytes(state);
+}
+
+bool PrefetchMemoryArbiter::MayProduce(const TrackedBuffer* buffer) const {
+  tf_shared_lock l(mu_);
+  if (!Enabled()) {
+    return true;
+  }
+  auto it = buffers_.find(buffer);
+  if (it == buffers_.end() || it->second.buffered_bytes == 0) {
+    return true;
+  }
+  const BufferState& state = it->second;
+  if (state.cap_bytes.has_value()) {
+    return state.buffered_bytes < *state.cap_bytes;
+  }
+  return projected_bytes_ < limit_bytes_;
+}
+
+bool PrefetchMemoryArbiter::RequestGrowth(const TrackedBuffer* buffer,
+                                          int64_t delta_bytes) {
+  mutex_lock l(mu_);
+  if (!Enabled()) {
+    return true;
+  }
+  if (buffered_bytes_ + delta_bytes > kTargetFraction * limit_bytes_) {
+    ++num_denied_growths_;
+    return false;
+  }
+  BufferState& state = buffers_[buffer];
+  if (state.cap_bytes.has_value()) {
+    projected_bytes_ -= ProjectedBytes(state);
+    *state.cap_bytes += delta_bytes;
+    projected_bytes_ += ProjectedBytes(state);
+  }
+  return true;
+}
+
+int64_t PrefetchMemoryArbiter::ProjectedBytes(const BufferState& state) {
+  return state.cap_bytes.has_value()
+             ? std::min(state.buffered_bytes, *state.cap_bytes)
+             : state.buffered_bytes;
+}
+
+void PrefetchMemoryArbiter::Shrink() {
+  if (projected_bytes_ <= kShrinkThreshold * limit_bytes_) {
+    return;
+  }
+  std::vector<BufferState*> candidates;
+  candidates.reserve(buffers_.size());
+  for (auto& [buffer, state] : buffers_) {
+    candidates.push_back(&state);
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [](const BufferState* a, const BufferState* b) {
+              return a->wait_us < b->wait_us;
+            });
+  for (BufferState* state : candidates) {
+    if (projected_bytes_ <= kTargetFraction * limit_bytes_) {
+      break;
+    }
+    const int64_t old_bytes = ProjectedBytes(*state);
+    const int64_t new_cap_bytes = old_bytes / 2;
+    if (new_cap_bytes == 0) {
+      continue;
+    }
+    VLOG(2) << "Capping prefetch buffer " << state->name << " at "
+            << new_cap_bytes << " bytes; it holds " << state->buffered_bytes
+            << " bytes and its consumer waits " << state->wait_us
+            << " us on average.";
+    state->cap_bytes = new_cap_bytes;
+    projected_bytes_ -= old_bytes - new_cap_bytes;
+    ++num_shrinks_;
+  }
+}
+
+}  // namespace data
+}  // namespace tensorflow
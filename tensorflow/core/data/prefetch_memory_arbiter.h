@@ -0,0 +1,154 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_PREFETCH_MEMORY_ARBITER_H_
+#define TENSORFLOW_CORE_DATA_PREFETCH_MEMORY_ARBITER_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Arbitrates the memory of prefetch buffers across all the iterators of a
+// process.
+//
+// Each buffer reports the bytes it holds and how long its consumer waits for
+// it. Once the buffers together hold more than `kShrinkThreshold` of the
+// limit, the arbiter caps the buffers whose consumers wait the least, until
+// the capped buffers would hold no more than `kTargetFraction` of the limit.
+// A capped buffer stops producing elements until its consumer drains it below
+// the cap. Buffers without a cap stop producing elements while the buffers
+// would together hold more than the limit once the capped buffers have drained
+// to their caps. Every buffer may hold at least one element, so that no
+// pipeline stalls.
+//
+// Caps are raised again when their consumers wait and the buffers hold less
+// than `kTargetFraction` of the limit.
+//
+// PrefetchMemoryArbiter is thread safe.
+class PrefetchMemoryArbiter {
+ public:
+  // Fraction of the limit above which buffers are shrunk.
+  static constexpr double kShrinkThreshold = 0.9;
+  // Fraction of the limit that shrinking aims for, and below which buffers
+  // may grow.
+  static constexpr double kTargetFraction = 0.8;
+
+  // Statistics exported to /tfdataz.
+  struct Stats {
+    int64_t limit_bytes = 0;
+    int64_t buffered_bytes = 0;
+    int64_t num_buffers = 0;
+    int64_t num_capped_buffers = 0;
+    // Number of times a buffer was capped.
+    int64_t num_shrinks = 0;
+    // Number of growth requests that were denied for lack of headroom.
+    int64_t num_denied_growths = 0;
+  };
+
+  // A prefetch buffer registered with the arbiter. Deregisters on destruction.
+  class TrackedBuffer {
+   public:
+    ~TrackedBuffer();
+
+    // Records the number of bytes currently held by the buffer.
+    void SetBufferedBytes(int64_t bytes);
+
+    // Records how long the consumer of the buffer waited for an element, or 0
+    // if an element was available.
+    void RecordConsumerWait(int64_t wait_us);
+
+    // Returns whether the buffer may produce another element.
+    bool MayProduce() const;
+
+    // Returns whether the buffer may grow its size by `delta_bytes`. Raises
+    // the cap of the buffer, if any, accordingly.
+    bool RequestGrowth(int64_t delta_bytes);
+
+   private:
+    friend class PrefetchMemoryArbiter;
+    explicit TrackedBuffer(PrefetchMemoryArbiter* arbiter)
+        : arbiter_(arbiter) {}
+
+    PrefetchMemoryArbiter* const arbiter_;
+  };
+
+  // Creates an arbiter for buffers that together hold at most `limit_bytes`.
+  // A non-positive limit disables the arbiter.
+  explicit PrefetchMemoryArbiter(int64_t limit_bytes);
+
+  // Returns the arbiter shared by all iterators in the process. Its limit is
+  // read from the TF_DATA_PREFETCH_MEMORY_LIMIT_BYTES environment variable,
+  // and defaults to `model::kRamBudgetShare` of the available RAM.
+  static PrefetchMemoryArbiter& Global();
+
+  // Registers a buffer named `name`, used for logging.
+  std::unique_ptr<TrackedBuffer> Register(absl::string_view name);
+
+  void SetLimit(int64_t limit_bytes);
+
+  Stats GetStats() const;
+
+ private:
+  struct BufferState {
+    std::string name;
+    int64_t buffered_bytes = 0;
+    // Exponential moving average of the consumer wait time per element.
+    double wait_us = 0.0;
+    // If set, the buffer may not produce elements while it holds this many
+    // bytes or more.
+    std::optional<int64_t> cap_bytes;
+  };
+
+  void Deregister(const TrackedBuffer* buffer);
+  void SetBufferedBytes(const TrackedBuffer* buffer, int64_t bytes);
+  void RecordConsumerWait(const TrackedBuffer* buffer, int64_t wait_us);
+  bool MayProduce(const TrackedBuffer* buffer) const;
+  bool RequestGrowth(const TrackedBuffer* buffer, int64_t delta_bytes);
+
+  // Returns the bytes the buffer holds once it has drained to its cap, if any.
+  static int64_t ProjectedBytes(const BufferState& state);
+
+  // Caps the buffers whose consumers wait the least, until the capped
+  // buffers would hold at most `kTargetFraction` of the limit.
+  void Shrink() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  bool Enabled() const TF_SHARED_LOCKS_REQUIRED(mu_) {
+    return limit_bytes_ > 0;
+  }
+
+  mutable mutex mu_;
+  int64_t limit_bytes_ TF_GUARDED_BY(mu_);
+  int64_t buffered_bytes_ TF_GUARDED_BY(mu_) = 0;
+  // The sum of `ProjectedBytes()` over `buffers_`, kept up to date by every
+  // change of their bytes or caps.
+  int64_t projected_bytes_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_shrinks_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_denied_growths_ TF_GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<const TrackedBuffer*, BufferState> buffers_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_PREFETCH_MEMORY_ARBITER_H_
@@ -0,0 +1,126 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/prefetch_memory_arbiter.h"
+
+#include <memory>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+TEST(PrefetchMemoryArbiterTest, TrackBufferedBytes) {
+  PrefetchMemoryArbiter arbiter(/*limit_bytes=*/1000);
+  auto buffer_one = arbiter.Register("one");
+  auto buffer_two = arbiter.Register("two");
+  buffer_one->SetBufferedBytes(100);
+  buffer_two->SetBufferedBytes(200);
+  EXPECT_EQ(arbiter.GetStats().buffered_bytes, 300);
+  EXPECT_EQ(arbiter.GetStats().num_buffers, 2);
+
+  buffer_one->SetBufferedBytes(50);
+  EXPECT_EQ(arbiter.GetStats().buffered_bytes, 250);
+
+  buffer_two.reset();
+  EXPECT_EQ(arbiter.GetStats().buffered_bytes, 50);
+  EXPECT_EQ(arbiter.GetStats().num_buffers, 1);
+}
+
+TEST(PrefetchMemoryArbiterTest, ProduceBelowLimit) {
+  PrefetchMemoryArbiter arbiter(/*limit_bytes=*/1000);
+  auto buffer = arbiter.Register("prefetch");
+  EXPECT_TRUE(buffer->MayProduce());
+  buffer->SetBufferedBytes(850);
+  EXPECT_TRUE(buffer->MayProduce());
+}
+
+TEST(PrefetchMemoryArbiterTest, ShrinkBufferWithLeastConsumerWait) {
+  PrefetchMemoryArbiter arbiter(/*limit_bytes=*/1000);
+  auto starved = arbiter.Register("starved");
+  auto idle = arbiter.Register("idle");
+  starved->RecordConsumerWait(1000);
+  idle->RecordConsumerWait(0);
+  starved->SetBufferedBytes(400);
+  idle->SetBufferedBytes(650);
+
+  EXPECT_FALSE(idle->MayProduce());
+  EXPECT_TRUE(starved->MayProduce());
+  PrefetchMemoryArbiter::Stats stats = arbiter.GetStats();
+  EXPECT_EQ(stats.num_capped_buffers, 1);
+  EXPECT_EQ(stats.num_shrinks, 1);
+
+  // The capped buffer resumes once its consumer drains it below the cap.
+  idle->SetBufferedBytes(250);
+  EXPECT_TRUE(idle->MayProduce());
+}
+
+TEST(PrefetchMemoryArbiterTest, EmptyBufferMayAlwaysProduce) {
+  PrefetchMemoryArbiter arbiter(/*limit_bytes=*/1000);
+  auto full = arbiter.Register("full");
+  auto empty = arbiter.Register("empty");
+  full->SetBufferedBytes(2000);
+  EXPECT_FALSE(full->MayProduce());
+  EXPECT_TRUE(empty->MayProduce());
+}
+
+TEST(PrefetchMemoryArbiterTest, RelaxCapWhenConsumerWaits) {
+  PrefetchMemoryArbiter arbiter(/*limit_bytes=*/1000);
+  auto buffer = arbiter.Register("prefetch");
+  buffer->SetBufferedBytes(1000);
+  EXPECT_EQ(arbiter.GetStats().num_capped_buffers, 1);
+  buffer->SetBufferedBytes(500);
+  EXPECT_FALSE(buffer->MayProduce());
+
+  buffer->SetBufferedBytes(100);
+  buffer->RecordConsumerWait(1000);
+  buffer->SetBufferedBytes(500);
+  EXPECT_TRUE(buffer->MayProduce());
+}
+
+TEST(PrefetchMemoryArbiterTest, DenyGrowthWithoutHeadroom) {
+  PrefetchMemoryArbiter arbiter(/*limit_bytes=*/1000);
+  auto buffer = arbiter.Register("prefetch");
+  buffer->SetBufferedBytes(500);
+  EXPECT_TRUE(buffer->RequestGrowth(200));
+  EXPECT_FALSE(buffer->RequestGrowth(400));
+  EXPECT_EQ(arbiter.GetStats().num_denied_growths, 1);
+}
+
+TEST(PrefetchMemoryArbiterTest, Disabled) {
+  PrefetchMemoryArbiter arbiter(/*limit_bytes=*/0);
+  auto buffer = arbiter.Register("prefetch");
+  buffer->SetBufferedBytes(1 << 30);
+  EXPECT_TRUE(buffer->MayProduce());
+  EXPECT_TRUE(buffer->RequestGrowth(1 << 30));
+  EXPECT_EQ(arbiter.GetStats().num_shrinks, 0);
+}
+
+TEST(PrefetchMemoryArbiterTest, LowerLimit) {
+  PrefetchMemoryArbiter arbiter(/*limit_bytes=*/0);
+  auto buffer = arbiter.Register("prefetch");
+  buffer->SetBufferedBytes(1000);
+  arbiter.SetLimit(1000);
+  EXPECT_FALSE(buffer->MayProduce());
+  EXPECT_EQ(arbiter.GetStats().num_capped_buffers, 1);
+
+  arbiter.SetLimit(0);
+  EXPECT_TRUE(buffer->MayProduce());
+  EXPECT_EQ(arbiter.GetStats().num_capped_buffers, 0);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -23,17 +23,29 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/common_runtime/process_state.h"
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/hash_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/rewrite_utils.h"
+#include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/model.pb.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/stringprintf.h"
@@ -52,12 +64,21 @@ constexpr char kReadRoundtripLatency[] = "read_latency_usec";
 constexpr char kReadResponseBytes[] = "read_bytes";
 constexpr char kIntraOpParallelism[] = "intra_op_parallelism";
 constexpr char kMemBandwidth[] = "mem_bw_used_megabytes_per_sec";
+constexpr char kNumaNode[] = "numa_node";
 constexpr char kPrivateThreadpoolSize[] = "threadpool_size";
 constexpr char kRamBudget[] = "ram_budget_megabytes";
 constexpr char kRamUsage[] = "ram_usage_megabytes";
 constexpr char kMaxBufferBytes[] = "max_buffered_megabytes";
 constexpr char kWarmStart[] = "warm_start";
 
+// How often the tuned parameters are persisted, if
+// `AutotuneOptions.tunables_dir` is set.
+constexpr int64_t kSaveTunablesPeriodMs = 60 * EnvTime::kSecondsToMillis;
+
+// The value of `ThreadingOptions.numa_node` that selects the NUMA node of the
+// device that the iterator runs on.
+constexpr int kNumaNodeOfDevice = -1;
+
 // If value `x` matches `y`, returns default value `z`. Otherwise, return `x`.
 inline int64_t value_or_default(int64_t x, int64_t y, int64_t z) {
   return x == y ? z : x;
@@ -72,6 +93,9 @@ void SetRootDatasetParams(const Options& options, RootDataset::Params* params) {
     params->private_threadpool_size =
         options.threading_options().private_threadpool_size();
   }
+  if (ShouldUseNumaAffinity(options)) {
+    params->numa_node = options.threading_options().numa_node();
+  }
   params->autotune = ShouldUseAutotuning(options);
   params->autotune_algorithm = model::AutotuneAlgorithm::DEFAULT;
   auto experiments = GetExperiments();
@@ -105,6 +129,25 @@ void SetRootDatasetParams(const Options& options, RootDataset::Params* params) {
     ram_budget_share = model::kRamBudgetShare;
   }
   params->ram_budget_share = ram_budget_share;
+  params->autotune_tunables_dir = options.autotune_options().tunables_dir();
+}
+
+// Returns a fingerprint of the structure of `dataset`, which does not depend on
+// its data tensors or random seeds, so that different runs of an input pipeline
+// have the same fingerprint.
+absl::StatusOr<uint64_t> PipelineFingerprint(const DatasetBase* dataset) {
+  std::vector<std::pair<std::string, Tensor>> input_list;
+  SerializationContext::Params params;
+  params.input_list = &input_list;
+  params.external_state_policy = ExternalStatePolicy::POLICY_IGNORE;
+  params.is_graph_rewrite = true;
+  params.resource_mgr = nullptr;
+  GraphDef graph_def;
+  TF_RETURN_IF_ERROR(
+      AsGraphDef(dataset, SerializationContext(params), &graph_def));
+  uint64_t fingerprint = 0;
+  TF_RETURN_IF_ERROR(HashGraph(graph_def, &fingerprint));
+  return fingerprint;
 }
 
 void AddTraceMetadata(const RootDataset::Params& params, const Options& options,
@@ -135,6 +178,10 @@ void AddTraceMetadata(const RootDataset::Params& params, const Options& options,
                                     params.private_threadpool_size, 0,
                                     port::MaxParallelism())))));
   }
+  if (params.numa_node.has_value()) {
+    trace_metadata->push_back(std::make_pair(
+        kNumaNode, absl::StrFormat("%d", *params.numa_node)));
+  }
   auto experiments = GetExperiments();
   if (!experiments.empty()) {
     trace_metadata->push_back(
@@ -180,7 +227,9 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
           value_or_default(dataset()->params_.max_intra_op_parallelism, 0,
                            port::MaxParallelism());
     }
-    if (dataset()->params_.private_threadpool_size >= 0) {
+    // With NUMA affinity, the threadpool is created by `Initialize()`.
+    if (dataset()->params_.private_threadpool_size >= 0 &&
+        !dataset()->params_.numa_node.has_value()) {
       threadpool_size_ =
           value_or_default(dataset()->params_.private_threadpool_size, 0,
                            port::MaxParallelism());
@@ -191,7 +240,12 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
     cancellation_manager_ = std::make_unique<CancellationManager>();
   }
 
-  ~Iterator() override { cancellation_manager_->StartCancel(); }
+  ~Iterator() override {
+    if (!tunables_path_.empty()) {
+      SaveTunables(/*final=*/true);
+    }
+    cancellation_manager_->StartCancel();
+  }
 
   bool SymbolicCheckpointCompatible() const override { return true; }
 
@@ -201,6 +255,9 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
     // we need to pass ram_budget_manager_ to the downstream dataset operations
     ram_budget_manager_ = std::make_shared<model::RamBudgetManager>(
         dataset()->params_.ComputeInitialAutotuneRamBudget());
+    if (dataset()->params_.numa_node.has_value()) {
+      InitializeNumaAffinity(ctx);
+    }
 
     if (dataset()->params_.autotune) {
       if (ctx->model() != nullptr) {
@@ -228,6 +285,9 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
     TF_RETURN_IF_ERROR(dataset()->input_->MakeIterator(&iter_ctx, this,
                                                        prefix(), &input_impl_));
     ctx->MergeCheckpoint(iter_ctx.checkpoint());
+    if (model_ && !dataset()->params_.autotune_tunables_dir.empty()) {
+      InitializeTunables();
+    }
     return absl::OkStatus();
   }
 
@@ -328,7 +388,13 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
     // been set to a valid model in `Initialize()` if autotuning is on. We
     // should simply set `params.model` to `model_` here.
     params.model = model_;
-    if (dataset()->params_.private_threadpool_size >= 0) {
+    if (numa_thread_factory_) {
+      params.thread_factory = numa_thread_factory_;
+    }
+    if (numa_allocator_getter_) {
+      params.allocator_getter = numa_allocator_getter_;
+    }
+    if (thread_pool_) {
       params.runner = [pool = thread_pool_.get()](std::function<void()> c) {
         pool->Schedule(std::move(c));
       };
@@ -364,10 +430,171 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
           LOG(WARNING) << "Optimization loop failed: " << status;
         }
       });
+      if (!tunables_path_.empty()) {
+        save_tunables_thread_ = ctx->StartThread(
+            "tf_data_save_tunables", [this]() { SaveTunablesLoop(); });
+      }
     }
     return absl::OkStatus();
   }
 
+  // Pins the input pipeline to the NUMA node selected by the options: its
+  // threads run on the CPUs of the node, and the buffers allocated through the
+  // iterator context come from memory of the node.
+  void InitializeNumaAffinity(IteratorContext* ctx) {
+    int numa_node = *dataset()->params_.numa_node;
+    if (numa_node == kNumaNodeOfDevice && ctx->flr() != nullptr) {
+      numa_node = ctx->flr()->device()->NumaNode();
+    }
+    if (!port::NUMAEnabled() || numa_node < 0 ||
+        numa_node >= port::NUMANumNodes()) {
+      LOG(WARNING) << "Not pinning the input pipeline to NUMA node "
+                   << numa_node << ", as NUMA is "
+                   << (port::NUMAEnabled()
+                           ? absl::StrCat("limited to ", port::NUMANumNodes(),
+                                          " nodes")
+                           : "not supported")
+                   << " on this host.";
+      numa_node = port::kNUMANoAffinity;
+    }
+    const int64_t private_threadpool_size =
+        dataset()->params_.private_threadpool_size;
+    if (numa_node == port::kNUMANoAffinity && private_threadpool_size < 0) {
+      return;
+    }
+    // Unless configured otherwise, uses a thread for each CPU of the node, so
+    // that the functions of the input pipeline run on the node too.
+    threadpool_size_ = value_or_default(private_threadpool_size, 0,
+                                        port::MaxParallelism(numa_node));
+    if (threadpool_size_ < 0) {
+      threadpool_size_ = port::MaxParallelism(numa_node);
+    }
+    ThreadOptions thread_options;
+    thread_options.numa_node = numa_node;
+    thread_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), thread_options, "data_private_threadpool",
+        threadpool_size_);
+    if (numa_node == port::kNUMANoAffinity) {
+      return;
+    }
+    numa_thread_factory_ =
+        ThreadFactoryWithNumaAffinity(ctx->thread_factory(), numa_node);
+    if (ctx->flr() != nullptr &&
+        ctx->flr()->device()->device_type() != DEVICE_CPU) {
+      return;
+    }
+    numa_allocator_getter_ = [allocator_getter = ctx->allocator_getter(),
+                              numa_node](AllocatorAttributes attrs) {
+      // Host memory that is accessed by devices must come from the device's
+      // allocator.
+      if (attrs.gpu_compatible() && allocator_getter) {
+        return allocator_getter(attrs);
+      }
+      return ProcessState::singleton()->GetCPUAllocator(numa_node);
+    };
+  }
+
+  // Warm-starts `model_` from the tuned parameters persisted by an earlier run
+  // of the input pipeline, if any, and sets up `tunables_path_` to persist the
+  // tuned parameters of this run.
+  void InitializeTunables() {
+    absl::StatusOr<uint64_t> fingerprint =
+        PipelineFingerprint(dataset()->input_);
+    if (!fingerprint.ok()) {
+      LOG(WARNING) << "Not persisting the tuned parameters of the input "
+                   << "pipeline, as it could not be fingerprinted: "
+                   << fingerprint.status();
+      return;
+    }
+    fingerprint_ = *fingerprint;
+    tunables_path_ =
+        io::JoinPath(dataset()->params_.autotune_tunables_dir,
+                     absl::StrCat(absl::Hex(fingerprint_, absl::kZeroPad16),
+                                  ".pb"));
+    Env* env = Env::Default();
+    if (!env->FileExists(tunables_path_).ok()) {
+      return;
+    }
+    model::ModelTunables tunables;
+    absl::Status s = ReadBinaryProto(env, tunables_path_, &tunables);
+    if (!s.ok() || tunables.fingerprint() != fingerprint_) {
+      LOG(WARNING) << "Ignoring invalid tuned parameters in " << tunables_path_
+                   << ": " << s;
+      return;
+    }
+    const int64_t num_parameters =
+        model_->WarmStart(tunables, *ram_budget_manager_);
+    VLOG(1) << "Warm-started " << num_parameters
+            << " tunable parameters from " << tunables_path_;
+  }
+
+  // Persists the current tuned parameters of `model_` until the iterator is
+  // cancelled.
+  void SaveTunablesLoop() {
+    std::function<void()> deregister_fn;
+    absl::Status s = RegisterCancellationCallback(
+        cancellation_manager_.get(),
+        [this]() {
+          mutex_lock l(save_mu_);
+          save_cond_var_.notify_all();
+        },
+        &deregister_fn);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to persist the tuned parameters: " << s;
+      return;
+    }
+    auto cleanup = gtl::MakeCleanup(std::move(deregister_fn));
+    while (true) {
+      {
+        mutex_lock l(save_mu_);
+        if (!cancellation_manager_->IsCancelled()) {
+          save_cond_var_.wait_for(
+              l, std::chrono::milliseconds(kSaveTunablesPeriodMs));
+        }
+        if (cancellation_manager_->IsCancelled()) {
+          return;
+        }
+      }
+      SaveTunables(/*final=*/false);
+    }
+  }
+
+  // Writes the current tuned parameters of `model_` to `tunables_path_`. After
+  // the `final` save of the destructor, the input pipeline may be partially
+  // destroyed, so later saves are skipped.
+  void SaveTunables(bool final) TF_LOCKS_EXCLUDED(save_mu_) {
+    mutex_lock l(save_mu_);
+    if (tunables_saved_) {
+      return;
+    }
+    tunables_saved_ = final;
+    model::ModelTunables tunables = model_->ExportTunables();
+    tunables.set_fingerprint(fingerprint_);
+    Env* env = Env::Default();
+    std::string tmp_path = tunables_path_;
+    absl::Status s = env->RecursivelyCreateDir(
+        dataset()->params_.autotune_tunables_dir);
+    if (absl::IsAlreadyExists(s)) {
+      s = absl::OkStatus();
+    }
+    if (s.ok() && !env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+      s = absl::InternalError(
+          absl::StrCat("Failed to create a temporary file name for ",
+                       tunables_path_));
+    }
+    if (s.ok()) {
+      s = WriteBinaryProto(env, tmp_path, tunables);
+    }
+    // Renames the written file, so that readers never see a partial file.
+    if (s.ok()) {
+      s = env->RenameFile(tmp_path, tunables_path_);
+    }
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to persist the tuned parameters to "
+                   << tunables_path_ << ": " << s;
+    }
+  }
+
   std::shared_ptr<model::Model> model_ = nullptr;
   // `ram_budget_manager_` coordinates the memory budget and allocation
   // between prefetch legacy autotune and `tensorflow::data::model::Model`
@@ -377,9 +604,22 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
   std::unique_ptr<CancellationManager> cancellation_manager_;
   mutex mu_;
   std::unique_ptr<Thread> model_thread_ TF_GUARDED_BY(mu_);
+  // The fingerprint of the input pipeline and the file to persist its tuned
+  // parameters in, if `AutotuneOptions.tunables_dir` is set.
+  uint64_t fingerprint_ = 0;
+  std::string tunables_path_;
+  mutex save_mu_;
+  condition_variable save_cond_var_;
+  // Whether the destructor has saved the tuned parameters.
+  bool tunables_saved_ TF_GUARDED_BY(save_mu_) = false;
+  std::unique_ptr<Thread> save_tunables_thread_ TF_GUARDED_BY(mu_);
   int64_t max_intra_op_parallelism_;
   int64_t threadpool_size_;
   std::unique_ptr<thread::ThreadPool> thread_pool_;
+  // If the input pipeline is pinned to a NUMA node, used to start its threads
+  // and allocate its buffers.
+  std::shared_ptr<ThreadFactory> numa_thread_factory_;
+  std::function<Allocator*(AllocatorAttributes)> numa_allocator_getter_;
 
   // The end time of the previous `GetNextInternal` call.
   uint64_t end_time_usec_ TF_GUARDED_BY(mu_) = 0;
@@ -18,6 +18,8 @@ limitations under the License.
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
 #include "absl/status/status.h"
@@ -40,8 +42,13 @@ class RootDataset : public DatasetBase {
     std::function<int64_t()> autotune_cpu_budget_func;
     double ram_budget_share;
     int64_t autotune_ram_budget_from_options;
+    // If not empty, the directory to persist the tuned parameters in.
+    std::string autotune_tunables_dir;
     int64_t max_intra_op_parallelism = 1;
     int64_t private_threadpool_size = 0;
+    // If set, the NUMA node to pin the threads of the input pipeline to, or -1
+    // for the NUMA node of the device that the iterator runs on.
+    std::optional<int> numa_node;
 
     int64_t ComputeInitialAutotuneRamBudget() const {
       if (autotune_ram_budget_from_options > 0) {
@@ -54,6 +54,27 @@ absl::Status WriteElementsToCheckpoint(
     IteratorStateWriter* writer, absl::string_view key_prefix,
     const std::vector<std::vector<Tensor>>& elements);
 
+// Reads and writes the number of elements and the individual elements of a
+// list written by WriteElementsToCheckpoint, for callers that cannot hold the
+// whole list in memory at once. A list written with
+// WriteNumElementsToCheckpoint and one WriteElementToCheckpoint per index can
+// be read back with ReadElementsFromCheckpoint, and vice versa.
+absl::Status ReadNumElementsFromCheckpoint(IteratorStateReader* reader,
+                                           absl::string_view key_prefix,
+                                           int64_t* num_elements);
+absl::Status ReadElementFromCheckpoint(IteratorContext* ctx,
+                                       IteratorStateReader* reader,
+                                       absl::string_view key_prefix,
+                                       int64_t index,
+                                       std::vector<Tensor>* element);
+absl::Status WriteNumElementsToCheckpoint(IteratorStateWriter* writer,
+                                          absl::string_view key_prefix,
+                                          int64_t num_elements);
+absl::Status WriteElementToCheckpoint(IteratorStateWriter* writer,
+                                      absl::string_view key_prefix,
+                                      int64_t index,
+                                      const std::vector<Tensor>& element);
+
 // Updates the dataset elements in the checkpoint for given `checkpoint_indices`
 // using the given key prefix, assuming that vector of elements have
 // checkpointed these before. The elements can be read back by passing the same
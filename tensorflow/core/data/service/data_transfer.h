@@ -124,6 +124,10 @@ class DataTransferServer {
   // Return the port that this server is listening on.
   virtual int Port() const = 0;
 
+  // Returns the address that clients should connect to, if the server isn't
+  // reached through the worker's data transfer address and `Port()`.
+  virtual std::string Address() const { return std::string(); }
+
   // Register a DataTransferServer factory under `name`.
   static void Register(std::string name, ServerFactoryT factory);
 
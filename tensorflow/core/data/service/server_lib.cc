@@ -179,7 +179,11 @@ WorkerGrpcDataServer::WorkerGrpcDataServer(
                          std::move(options)),
       config_(config) {}
 
-WorkerGrpcDataServer::~WorkerGrpcDataServer() { delete service_; }
+WorkerGrpcDataServer::~WorkerGrpcDataServer() {
+  // The transfer server may call into `service_` until it is destroyed.
+  transfer_server_.reset();
+  delete service_;
+}
 
 void WorkerGrpcDataServer::AddDataServiceToBuilder(
     ::grpc::ServerBuilder& builder) {
@@ -208,16 +212,24 @@ void WorkerGrpcDataServer::MaybeStartAlternativeDataTransferServer(
                << s;
     return;
   }
-  LOG(INFO) << "Data transfer server started at 0.0.0.0:"
-            << transfer_server_->Port() << " for protocol "
-            << config_.data_transfer_protocol() << " for worker "
-            << config_.worker_address();
+  std::string address = transfer_server_->Address();
+  if (address.empty()) {
+    LOG(INFO) << "Data transfer server started at 0.0.0.0:"
+              << transfer_server_->Port() << " for protocol "
+              << config_.data_transfer_protocol() << " for worker "
+              << config_.worker_address();
+    address = str_util::StringReplace(
+        config_.data_transfer_address(), kDataTransferPortPlaceholder,
+        absl::StrCat(transfer_server_->Port()),
+        /*replace_all=*/false);
+  } else {
+    LOG(INFO) << "Data transfer server started at " << address
+              << " for protocol " << config_.data_transfer_protocol()
+              << " for worker " << config_.worker_address();
+  }
   DataTransferServerInfo alternative_transfer_server;
   alternative_transfer_server.set_protocol(config_.data_transfer_protocol());
-  alternative_transfer_server.set_address(str_util::StringReplace(
-      config_.data_transfer_address(), kDataTransferPortPlaceholder,
-      absl::StrCat(transfer_server_->Port()),
-      /*replace_all=*/false));
+  alternative_transfer_server.set_address(address);
   absl::StatusOr<std::string> compatibility_info =
       transfer_server_->GetCompatibilityInfo();
   if (!compatibility_info.ok()) {
@@ -0,0 +1,926 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tsl/platform/host_info.h"
+#endif  // defined(__linux__)
+
+namespace tensorflow {
+namespace data {
+
+#if defined(__linux__)
+
+namespace {
+
+// Every allocation in the ring buffer, and every component payload within an
+// allocation, starts at a multiple of `kAlignment` bytes.
+constexpr uint64_t kAlignment = 64;
+// The ring buffer starts one page into the shared memory, after the
+// `RingHeader`.
+constexpr uint64_t kRingOffset = 4096;
+// Upper bound on the size of a serialized `GetElementRequest`.
+constexpr uint64_t kMaxRequestBytes = 1 << 20;
+
+// Header at the start of the shared memory.
+struct RingHeader {
+  // Offset up to which the client has released the ring buffer. Offsets grow
+  // monotonically, and the position in the ring buffer is the offset modulo
+  // its capacity. Written by the client and read by the server.
+  std::atomic<uint64_t> released_offset;
+};
+static_assert(sizeof(RingHeader) <= kRingOffset);
+
+// Sent by the server along with the shared-memory file descriptor when a
+// client connects.
+struct Handshake {
+  uint64_t capacity;
+};
+
+// How a component is encoded.
+enum ComponentKind : int32_t {
+  // The tensor bytes, for types that can be copied with `memcpy`.
+  kRaw = 0,
+  // A serialized `CompressedElement`.
+  kCompressed = 1,
+  // A serialized `TensorProto`, for all other tensors.
+  kProto = 2,
+};
+
+// Precedes each component. Followed by `rank` dimension sizes, and by the
+// payload at the next multiple of `kAlignment`.
+struct ComponentHeader {
+  int32_t dtype;
+  int32_t kind;
+  int32_t rank;
+  int32_t unused;
+  uint64_t payload_bytes;
+};
+
+// Sent by the server in response to each request. Followed by `message_bytes`
+// bytes of error message and, if `in_line` is set, by the `element_bytes`
+// bytes of the encoded element.
+struct ResponseHeader {
+  int32_t code;
+  uint32_t message_bytes;
+  int64_t element_index;
+  uint64_t num_components;
+  // Offset of the encoded element in the ring buffer, unless `in_line` is set.
+  uint64_t element_offset;
+  uint64_t element_bytes;
+  uint8_t end_of_sequence;
+  uint8_t skip;
+  uint8_t in_line;
+  uint8_t unused[5];
+};
+
+uint64_t RoundUp(uint64_t bytes) {
+  return (bytes + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+uint64_t ComponentHeaderBytes(int rank) {
+  return RoundUp(sizeof(ComponentHeader) + rank * sizeof(int64_t));
+}
+
+absl::Status ErrnoError(int error, absl::string_view context) {
+  return absl::InternalError(absl::StrCat(context, ": ", strerror(error)));
+}
+
+absl::Status WriteAll(int fd, const void* data, size_t bytes) {
+  const char* p = static_cast<const char*>(data);
+  while (bytes > 0) {
+    ssize_t n = send(fd, p, bytes, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return ErrnoError(errno, "Failed to write to socket");
+    }
+    p += n;
+    bytes -= n;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ReadAll(int fd, void* data, size_t bytes) {
+  char* p = static_cast<char*>(data);
+  while (bytes > 0) {
+    ssize_t n = recv(fd, p, bytes, 0);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return ErrnoError(errno, "Failed to read from socket");
+    }
+    if (n == 0) {
+      return absl::InternalError("Socket was closed by the peer.");
+    }
+    p += n;
+    bytes -= n;
+  }
+  return absl::OkStatus();
+}
+
+// Converts `address`, an '@' followed by a name, to the address of a socket
+// with that name in the abstract namespace. Abstract sockets need no file
+// and disappear with the server.
+absl::Status ToSocketAddress(const std::string& address, sockaddr_un& addr,
+                             socklen_t& addr_len) {
+  if (address.empty() || address[0] != '@' ||
+      address.size() > sizeof(addr.sun_path)) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Invalid shared-memory data transfer address '", address,
+        "'; expected '@' followed by at most ", sizeof(addr.sun_path) - 1,
+        " characters."));
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  memcpy(addr.sun_path + 1, address.data() + 1, address.size() - 1);
+  addr_len = offsetof(sockaddr_un, sun_path) + address.size();
+  return absl::OkStatus();
+}
+
+// Creates an unlinked shared-memory file of `bytes` bytes. `mkostemp` in
+// /dev/shm is used rather than `memfd_create`, which needs glibc 2.27. The
+// pages are reserved up front, so that running out of shared memory fails
+// here rather than with SIGBUS on the first write.
+absl::StatusOr<int> CreateSharedMemoryFile(uint64_t bytes) {
+  char path[] = "/dev/shm/tf_data_shm_XXXXXX";
+  int fd = mkostemp(path, O_CLOEXEC);
+  if (fd < 0) {
+    return ErrnoError(errno, "Failed to create shared memory file");
+  }
+  unlink(path);
+  if (int error = posix_fallocate(fd, 0, bytes); error != 0) {
+    close(fd);
+    return ErrnoError(error, "Failed to allocate shared memory");
+  }
+  return fd;
+}
+
+absl::Status SendHandshake(int fd, Handshake handshake, int shm_fd) {
+  iovec iov = {&handshake, sizeof(handshake)};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+  msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  memcpy(CMSG_DATA(cmsg), &shm_fd, sizeof(int));
+  ssize_t n;
+  do {
+    n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+  } while (n < 0 && errno == EINTR);
+  if (n < 0) {
+    return ErrnoError(errno, "Failed to send shared memory to client");
+  }
+  if (n != sizeof(handshake)) {
+    return absl::InternalError("Failed to send shared memory to client.");
+  }
+  return absl::OkStatus();
+}
+
+// Receives the handshake and returns the shared-memory file descriptor.
+absl::StatusOr<int> ReceiveHandshake(int fd, Handshake& handshake) {
+  iovec iov = {&handshake, sizeof(handshake)};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+  msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  ssize_t n;
+  do {
+    n = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+  } while (n < 0 && errno == EINTR);
+  if (n < 0) {
+    return ErrnoError(errno, "Failed to receive shared memory from server");
+  }
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  if (cmsg == nullptr || cmsg->cmsg_level != SOL_SOCKET ||
+      cmsg->cmsg_type != SCM_RIGHTS ||
+      cmsg->cmsg_len != CMSG_LEN(sizeof(int))) {
+    return absl::InternalError("Server did not send shared memory.");
+  }
+  int shm_fd;
+  memcpy(&shm_fd, CMSG_DATA(cmsg), sizeof(int));
+  if (n != sizeof(handshake) || handshake.capacity == 0 ||
+      handshake.capacity % kAlignment != 0) {
+    close(shm_fd);
+    return absl::InternalError("Received an invalid handshake from server.");
+  }
+  return shm_fd;
+}
+
+// A component of an element, prepared for encoding.
+struct ComponentEncoder {
+  const Tensor* tensor = nullptr;
+  ComponentKind kind = kRaw;
+  const CompressedElement* compressed = nullptr;
+  TensorProto proto;
+  uint64_t payload_bytes = 0;
+};
+
+// Prepares `components` for encoding, and returns their encoded size.
+uint64_t PrepareElement(const std::vector<Tensor>& components,
+                        std::vector<ComponentEncoder>& encoders) {
+  encoders.resize(components.size());
+  uint64_t bytes = 0;
+  for (size_t i = 0; i < components.size(); ++i) {
+    const Tensor& tensor = components[i];
+    ComponentEncoder& encoder = encoders[i];
+    encoder.tensor = &tensor;
+    if (DataTypeCanUseMemcpy(tensor.dtype())) {
+      encoder.kind = kRaw;
+      encoder.payload_bytes = tensor.TotalBytes();
+    } else if (tensor.dtype() == DT_VARIANT && tensor.dims() == 0 &&
+               (encoder.compressed =
+                    tensor.scalar<Variant>()().get<CompressedElement>())) {
+      encoder.kind = kCompressed;
+      encoder.payload_bytes = encoder.compressed->ByteSizeLong();
+    } else {
+      encoder.kind = kProto;
+      tensor.AsProtoTensorContent(&encoder.proto);
+      encoder.payload_bytes = encoder.proto.ByteSizeLong();
+    }
+    bytes += ComponentHeaderBytes(tensor.dims()) +
+             RoundUp(encoder.payload_bytes);
+  }
+  return bytes;
+}
+
+// Encodes prepared components into `out`, which must hold the number of bytes
+// returned by `PrepareElement`.
+absl::Status EncodeElement(const std::vector<ComponentEncoder>& encoders,
+                           char* out) {
+  for (const ComponentEncoder& encoder : encoders) {
+    const Tensor& tensor = *encoder.tensor;
+    ComponentHeader header = {};
+    header.dtype = tensor.dtype();
+    header.kind = encoder.kind;
+    header.rank = tensor.dims();
+    header.payload_bytes = encoder.payload_bytes;
+    memcpy(out, &header, sizeof(header));
+    for (int d = 0; d < tensor.dims(); ++d) {
+      const int64_t dim_size = tensor.dim_size(d);
+      memcpy(out + sizeof(header) + d * sizeof(int64_t), &dim_size,
+             sizeof(int64_t));
+    }
+    out += ComponentHeaderBytes(tensor.dims());
+    bool success = true;
+    switch (encoder.kind) {
+      case kRaw:
+        if (encoder.payload_bytes > 0) {
+          memcpy(out, tensor.tensor_data().data(), encoder.payload_bytes);
+        }
+        break;
+      case kCompressed:
+        success =
+            encoder.compressed->SerializeToArray(out, encoder.payload_bytes);
+        break;
+      case kProto:
+        success = encoder.proto.SerializeToArray(out, encoder.payload_bytes);
+        break;
+    }
+    if (!success) {
+      return absl::InternalError(absl::StrCat(
+          "Failed to encode tensor of type ", DataTypeString(tensor.dtype())));
+    }
+    out += RoundUp(encoder.payload_bytes);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+// The client side of a ring buffer. Allocations may be released in any order;
+// the client hands space back to the server up to the oldest allocation that
+// is still in use.
+class ShmRingBuffer : public core::RefCounted {
+ public:
+  ShmRingBuffer(char* base, uint64_t capacity)
+      : base_(base), capacity_(capacity) {}
+
+  ~ShmRingBuffer() override { munmap(base_, kRingOffset + capacity_); }
+
+  // Records an allocation of `bytes` bytes at `offset` made by the server, and
+  // returns its data.
+  absl::StatusOr<const char*> Acquire(uint64_t offset, uint64_t bytes) {
+    if (bytes == 0 || bytes > capacity_ || offset % kAlignment != 0 ||
+        offset % capacity_ + bytes > capacity_) {
+      return absl::InternalError(absl::StrCat(
+          "Received invalid ring buffer allocation of ", bytes,
+          " bytes at offset ", offset, " from server."));
+    }
+    mutex_lock l(mu_);
+    allocations_.emplace(offset, std::make_pair(offset + bytes, false));
+    return base_ + kRingOffset + offset % capacity_;
+  }
+
+  // Releases the allocation at `offset`.
+  void Release(uint64_t offset) {
+    mutex_lock l(mu_);
+    auto it = allocations_.find(offset);
+    DCHECK(it != allocations_.end());
+    it->second.second = true;
+    uint64_t released_offset = 0;
+    bool advanced = false;
+    while (!allocations_.empty() && allocations_.begin()->second.second) {
+      released_offset = allocations_.begin()->second.first;
+      allocations_.erase(allocations_.begin());
+      advanced = true;
+    }
+    if (advanced) {
+      reinterpret_cast<RingHeader*>(base_)->released_offset.store(
+          released_offset, std::memory_order_release);
+    }
+  }
+
+ private:
+  char* const base_;
+  const uint64_t capacity_;
+  mutex mu_;
+  // Maps the offsets of allocations that are in use or that follow one that
+  // is in use to their end offsets and whether they have been released.
+  std::map<uint64_t, std::pair<uint64_t, bool>> allocations_
+      TF_GUARDED_BY(mu_);
+};
+
+namespace {
+
+// An element's allocation in the ring buffer. Released when the last tensor
+// that references it is destroyed.
+class RingRegion : public core::RefCounted {
+ public:
+  RingRegion(ShmRingBuffer* ring, uint64_t offset)
+      : ring_(ring), offset_(offset) {
+    ring_->Ref();
+  }
+
+  ~RingRegion() override {
+    ring_->Release(offset_);
+    ring_->Unref();
+  }
+
+ private:
+  ShmRingBuffer* const ring_;
+  const uint64_t offset_;
+};
+
+// A TensorBuffer that references a range of a `RingRegion`.
+//
+// Reports that it does not own its memory, so that Tensor::RefCountIsOne() is
+// never true and kernels copy the buffer rather than updating it in place.
+class ShmTensorBuffer : public TensorBuffer {
+ public:
+  ShmTensorBuffer(RingRegion* region, const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)), region_(region), size_(size) {
+    region_->Ref();
+  }
+
+  ~ShmTensorBuffer() override { region_->Unref(); }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  bool OwnsMemory() const override { return false; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("shm");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+ private:
+  RingRegion* const region_;
+  const size_t size_;
+};
+
+absl::Status InvalidElementError() {
+  return absl::InternalError("Received an invalid element from server.");
+}
+
+// Decodes the `num_components` components encoded in `data`. If `region` is
+// not null, `data` lies in it, and raw components reference it rather than
+// being copied into tensors allocated by `allocator`.
+absl::Status DecodeElement(const char* data, uint64_t bytes,
+                           uint64_t num_components, RingRegion* region,
+                           Allocator* allocator,
+                           std::vector<Tensor>& components) {
+  const char* const end = data + bytes;
+  auto remaining = [&]() -> uint64_t { return end - data; };
+  components.reserve(num_components);
+  for (uint64_t i = 0; i < num_components; ++i) {
+    ComponentHeader header;
+    if (remaining() < sizeof(header)) {
+      return InvalidElementError();
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.rank < 0 || header.rank > TensorShape::MaxDimensions() ||
+        remaining() < ComponentHeaderBytes(header.rank)) {
+      return InvalidElementError();
+    }
+    std::vector<int64_t> dims(header.rank);
+    for (int d = 0; d < header.rank; ++d) {
+      memcpy(&dims[d], data + sizeof(header) + d * sizeof(int64_t),
+             sizeof(int64_t));
+    }
+    data += ComponentHeaderBytes(header.rank);
+    if (remaining() < RoundUp(header.payload_bytes)) {
+      return InvalidElementError();
+    }
+    const char* payload = data;
+    data += RoundUp(header.payload_bytes);
+
+    const DataType dtype = static_cast<DataType>(header.dtype);
+    switch (header.kind) {
+      case kRaw: {
+        TensorShape shape;
+        TF_RETURN_IF_ERROR(TensorShape::BuildTensorShape(dims, &shape));
+        if (!DataTypeCanUseMemcpy(dtype) ||
+            shape.num_elements() * DataTypeSize(dtype) !=
+                header.payload_bytes) {
+          return InvalidElementError();
+        }
+        if (region != nullptr && allocator == nullptr) {
+          auto* buffer =
+              new ShmTensorBuffer(region, payload, header.payload_bytes);
+          components.push_back(Tensor(dtype, shape, buffer));
+          buffer->Unref();
+        } else {
+          components.emplace_back(
+              allocator != nullptr ? allocator : cpu_allocator(), dtype,
+              shape);
+          if (header.payload_bytes > 0) {
+            memcpy(const_cast<char*>(components.back().tensor_data().data()),
+                   payload, header.payload_bytes);
+          }
+        }
+        break;
+      }
+      case kCompressed: {
+        CompressedElement compressed;
+        if (!compressed.ParseFromArray(payload, header.payload_bytes)) {
+          return InvalidElementError();
+        }
+        Tensor tensor(DT_VARIANT, TensorShape{});
+        tensor.scalar<Variant>()() = std::move(compressed);
+        components.push_back(std::move(tensor));
+        break;
+      }
+      case kProto: {
+        TensorProto proto;
+        if (!proto.ParseFromArray(payload, header.payload_bytes)) {
+          return InvalidElementError();
+        }
+        components.emplace_back();
+        bool success = allocator != nullptr
+                           ? components.back().FromProto(allocator, proto)
+                           : components.back().FromProto(proto);
+        if (!success) {
+          return absl::InternalError("Failed to parse tensor.");
+        }
+        break;
+      }
+      default:
+        return InvalidElementError();
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+// A client connection and the ring buffer shared with it.
+struct ShmDataTransferServer::Connection {
+  ~Connection() {
+    // Joins the thread serving the connection.
+    thread.reset();
+    close(fd);
+    if (base != nullptr) {
+      munmap(base, kRingOffset + capacity);
+    }
+  }
+
+  RingHeader* header() { return reinterpret_cast<RingHeader*>(base); }
+  char* ring() { return base + kRingOffset; }
+
+  // Allocates `bytes` bytes in the ring buffer, and returns their offset.
+  // Returns `std::nullopt` if the ring buffer doesn't have enough free space.
+  std::optional<uint64_t> Allocate(uint64_t bytes) {
+    uint64_t offset = write_offset;
+    // Allocations don't wrap around the end of the ring buffer.
+    if (offset % capacity + bytes > capacity) {
+      offset += capacity - offset % capacity;
+    }
+    const uint64_t released_offset =
+        header()->released_offset.load(std::memory_order_acquire);
+    if (offset + bytes - released_offset > capacity) {
+      return std::nullopt;
+    }
+    write_offset = offset + bytes;
+    return offset;
+  }
+
+  int fd = -1;
+  char* base = nullptr;
+  uint64_t capacity = 0;
+  uint64_t write_offset = 0;
+  std::atomic<bool> done = false;
+  std::unique_ptr<Thread> thread;
+};
+
+ShmDataTransferServer::ShmDataTransferServer(GetElementT get_element,
+                                             int64_t ring_buffer_bytes)
+    : get_element_(std::move(get_element)),
+      ring_buffer_bytes_(RoundUp(ring_buffer_bytes)) {}
+
+ShmDataTransferServer::~ShmDataTransferServer() {
+  {
+    mutex_lock l(mu_);
+    stopped_ = true;
+    for (const auto& connection : connections_) {
+      shutdown(connection->fd, SHUT_RDWR);
+    }
+  }
+  if (listen_fd_ >= 0) {
+    shutdown(listen_fd_, SHUT_RDWR);
+  }
+  accept_thread_.reset();
+  std::vector<std::unique_ptr<Connection>> connections;
+  {
+    mutex_lock l(mu_);
+    connections = std::move(connections_);
+  }
+  connections.clear();
+  if (listen_fd_ >= 0) {
+    close(listen_fd_);
+  }
+}
+
+absl::Status ShmDataTransferServer::Start(
+    const experimental::WorkerConfig& config) {
+  address_ = absl::StrFormat("@tf_data_shm.%016x", random::New64());
+  sockaddr_un addr;
+  socklen_t addr_len;
+  TF_RETURN_IF_ERROR(ToSocketAddress(address_, addr, addr_len));
+  listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listen_fd_ < 0) {
+    return ErrnoError(errno, "Failed to create socket");
+  }
+  if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), addr_len) != 0) {
+    return ErrnoError(errno, absl::StrCat("Failed to bind to ", address_));
+  }
+  if (listen(listen_fd_, SOMAXCONN) != 0) {
+    return ErrnoError(errno, absl::StrCat("Failed to listen on ", address_));
+  }
+  accept_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+      ThreadOptions(), "tf_data_shm_transfer_server",
+      [this] { AcceptLoop(); }));
+  VLOG(1) << "Shared-memory data transfer server listening at " << address_;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::string> ShmDataTransferServer::GetCompatibilityInfo()
+    const {
+  return tsl::port::Hostname();
+}
+
+void ShmDataTransferServer::AcceptLoop() {
+  while (true) {
+    int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      const int error = errno;
+      {
+        mutex_lock l(mu_);
+        if (stopped_) {
+          return;
+        }
+      }
+      if (error != EINTR && error != ECONNABORTED) {
+        LOG(WARNING) << ErrnoError(error, "Failed to accept connection");
+        Env::Default()->SleepForMicroseconds(100 * 1000);
+      }
+      continue;
+    }
+    absl::Status status = AddConnection(fd);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to set up shared-memory data transfer for "
+                   << "client: " << status;
+    }
+  }
+}
+
+absl::Status ShmDataTransferServer::AddConnection(int fd) {
+  auto connection = std::make_unique<Connection>();
+  connection->fd = fd;
+  TF_ASSIGN_OR_RETURN(int shm_fd,
+                      CreateSharedMemoryFile(kRingOffset + ring_buffer_bytes_));
+  void* base = mmap(nullptr, kRingOffset + ring_buffer_bytes_,
+                    PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+  if (base == MAP_FAILED) {
+    absl::Status status = ErrnoError(errno, "Failed to map shared memory");
+    close(shm_fd);
+    return status;
+  }
+  connection->base = static_cast<char*>(base);
+  connection->capacity = ring_buffer_bytes_;
+  new (connection->base) RingHeader{0};
+  absl::Status status = SendHandshake(fd, {ring_buffer_bytes_}, shm_fd);
+  close(shm_fd);
+  TF_RETURN_IF_ERROR(status);
+
+  mutex_lock l(mu_);
+  if (stopped_) {
+    return absl::CancelledError("Server was stopped.");
+  }
+  // Drops connections that clients have closed.
+  connections_.erase(
+      std::remove_if(connections_.begin(), connections_.end(),
+                     [](const auto& c) { return c->done.load(); }),
+      connections_.end());
+  Connection* c = connection.get();
+  connection->thread = absl::WrapUnique(Env::Default()->StartThread(
+      ThreadOptions(), "tf_data_shm_transfer_connection",
+      [this, c] { Serve(c); }));
+  connections_.push_back(std::move(connection));
+  return absl::OkStatus();
+}
+
+void ShmDataTransferServer::Serve(Connection* connection) {
+  while (true) {
+    uint64_t request_bytes;
+    if (!ReadAll(connection->fd, &request_bytes, sizeof(request_bytes)).ok() ||
+        request_bytes > kMaxRequestBytes) {
+      break;
+    }
+    std::string serialized_request(request_bytes, '\0');
+    GetElementRequest request;
+    if (!ReadAll(connection->fd, serialized_request.data(), request_bytes)
+             .ok() ||
+        !request.ParseFromString(serialized_request)) {
+      break;
+    }
+    GetElementResult result;
+    absl::Status status = get_element_(&request, &result);
+    if (!SendResponse(*connection, status, result).ok()) {
+      break;
+    }
+  }
+  connection->done = true;
+}
+
+absl::Status ShmDataTransferServer::SendResponse(
+    Connection& connection, const absl::Status& status,
+    const GetElementResult& result) {
+  ResponseHeader header = {};
+  std::vector<ComponentEncoder> encoders;
+  std::string in_line_element;
+  absl::Status encode_status = status;
+  if (encode_status.ok() && !result.components.empty()) {
+    const uint64_t bytes = PrepareElement(result.components, encoders);
+    std::optional<uint64_t> offset = connection.Allocate(bytes);
+    if (offset.has_value()) {
+      encode_status = EncodeElement(
+          encoders, connection.ring() + *offset % connection.capacity);
+      header.element_offset = *offset;
+    } else {
+      in_line_element.resize(bytes);
+      encode_status = EncodeElement(encoders, in_line_element.data());
+      header.in_line = 1;
+    }
+    header.element_bytes = bytes;
+    header.num_components = result.components.size();
+  }
+  if (!encode_status.ok()) {
+    // The allocation, if any, is reclaimed when the client releases the next
+    // one.
+    header = {};
+    in_line_element.clear();
+  }
+  header.code = static_cast<int32_t>(encode_status.code());
+  header.message_bytes = encode_status.message().size();
+  header.element_index = result.element_index;
+  header.end_of_sequence = result.end_of_sequence;
+  header.skip = result.skip;
+  TF_RETURN_IF_ERROR(WriteAll(connection.fd, &header, sizeof(header)));
+  TF_RETURN_IF_ERROR(WriteAll(connection.fd, encode_status.message().data(),
+                              encode_status.message().size()));
+  return WriteAll(connection.fd, in_line_element.data(),
+                  in_line_element.size());
+}
+
+absl::StatusOr<std::unique_ptr<ShmDataTransferClient>>
+ShmDataTransferClient::Create(const std::string& address,
+                              Allocator* allocator) {
+  sockaddr_un addr;
+  socklen_t addr_len;
+  TF_RETURN_IF_ERROR(ToSocketAddress(address, addr, addr_len));
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return ErrnoError(errno, "Failed to create socket");
+  }
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), addr_len) != 0) {
+    absl::Status status =
+        ErrnoError(errno, absl::StrCat("Failed to connect to ", address));
+    close(fd);
+    return status;
+  }
+  Handshake handshake;
+  absl::StatusOr<int> shm_fd = ReceiveHandshake(fd, handshake);
+  if (!shm_fd.ok()) {
+    close(fd);
+    return shm_fd.status();
+  }
+  void* base = mmap(nullptr, kRingOffset + handshake.capacity,
+                    PROT_READ | PROT_WRITE, MAP_SHARED, *shm_fd, 0);
+  close(*shm_fd);
+  if (base == MAP_FAILED) {
+    absl::Status status = ErrnoError(errno, "Failed to map shared memory");
+    close(fd);
+    return status;
+  }
+  core::RefCountPtr<ShmRingBuffer> ring(
+      new ShmRingBuffer(static_cast<char*>(base), handshake.capacity));
+  return absl::WrapUnique(
+      new ShmDataTransferClient(address, fd, std::move(ring), allocator));
+}
+
+ShmDataTransferClient::ShmDataTransferClient(
+    std::string address, int fd, core::RefCountPtr<ShmRingBuffer> ring,
+    Allocator* allocator)
+    : address_(std::move(address)),
+      fd_(fd),
+      ring_(std::move(ring)),
+      allocator_(allocator) {
+  VLOG(2) << "Create ShmDataTransferClient for worker " << address_ << ".";
+}
+
+ShmDataTransferClient::~ShmDataTransferClient() { close(fd_); }
+
+absl::Status ShmDataTransferClient::GetElement(const GetElementRequest& req,
+                                               GetElementResult& result) {
+  if (cancelled_) {
+    return absl::CancelledError(absl::StrCat(
+        "Client for shared-memory worker ", address_, " has been cancelled."));
+  }
+  ResponseHeader header;
+  std::string message;
+  std::string in_line_element;
+  core::RefCountPtr<RingRegion> region;
+  const char* element = nullptr;
+  const int64_t start_time_us = env_->NowMicros();
+  {
+    mutex_lock l(mu_);
+    if (broken_) {
+      return absl::InternalError(absl::StrCat(
+          "Connection to shared-memory worker ", address_, " was lost."));
+    }
+    absl::Status status = [&]() -> absl::Status {
+      const std::string request = req.SerializeAsString();
+      const uint64_t request_bytes = request.size();
+      TF_RETURN_IF_ERROR(WriteAll(fd_, &request_bytes, sizeof(request_bytes)));
+      TF_RETURN_IF_ERROR(WriteAll(fd_, request.data(), request.size()));
+      TF_RETURN_IF_ERROR(ReadAll(fd_, &header, sizeof(header)));
+      message.resize(header.message_bytes);
+      TF_RETURN_IF_ERROR(ReadAll(fd_, message.data(), message.size()));
+      if (header.in_line) {
+        in_line_element.resize(header.element_bytes);
+        TF_RETURN_IF_ERROR(
+            ReadAll(fd_, in_line_element.data(), in_line_element.size()));
+        element = in_line_element.data();
+      } else if (header.element_bytes > 0) {
+        TF_ASSIGN_OR_RETURN(
+            element, ring_->Acquire(header.element_offset,
+                                    header.element_bytes));
+        region.reset(new RingRegion(ring_.get(), header.element_offset));
+      }
+      return absl::OkStatus();
+    }();
+    if (!status.ok()) {
+      broken_ = true;
+      if (cancelled_) {
+        return absl::CancelledError(
+            absl::StrCat("Client for shared-memory worker ", address_,
+                         " has been cancelled."));
+      }
+      return status;
+    }
+  }
+  metrics::RecordTFDataServiceGetElementDuration(
+      kShmTransferProtocol, env_->NowMicros() - start_time_us);
+  if (header.code != absl::StatusCode::kOk) {
+    return absl::Status(static_cast<absl::StatusCode>(header.code), message);
+  }
+  result.element_index = header.element_index;
+  result.end_of_sequence = header.end_of_sequence;
+  result.skip = header.skip;
+  return DecodeElement(element, header.element_bytes, header.num_components,
+                       region.get(), allocator_, result.components);
+}
+
+void ShmDataTransferClient::TryCancel() {
+  VLOG(2) << "Cancel ShmDataTransferClient.";
+  cancelled_ = true;
+  // Unblocks a `GetElement` call waiting for a response.
+  shutdown(fd_, SHUT_RDWR);
+}
+
+absl::Status ShmDataTransferClient::CheckCompatibility(
+    const std::string& server_compatibility_info) const {
+  const std::string hostname = tsl::port::Hostname();
+  if (server_compatibility_info != hostname) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "Shared-memory data transfer needs the worker to run on the same "
+        "host as the client, but the worker runs on '",
+        server_compatibility_info, "' and the client runs on '", hostname,
+        "'."));
+  }
+  return absl::OkStatus();
+}
+
+namespace {
+
+class ShmDataTransferRegistrar {
+ public:
+  ShmDataTransferRegistrar() {
+    DataTransferServer::Register(
+        kShmTransferProtocol, [](DataTransferServer::GetElementT get_element,
+                                 std::shared_ptr<DataTransferServer>* server) {
+          *server = std::make_shared<ShmDataTransferServer>(get_element);
+          return absl::OkStatus();
+        });
+    DataTransferClient::Register(
+        kShmTransferProtocol, [](DataTransferClient::Config config,
+                                 std::unique_ptr<DataTransferClient>* client) {
+          TF_ASSIGN_OR_RETURN(
+              *client,
+              ShmDataTransferClient::Create(config.address, config.allocator));
+          return absl::OkStatus();
+        });
+  }
+};
+static ShmDataTransferRegistrar shm_data_transfer_registrar;
+
+}  // namespace
+
+#endif  // defined(__linux__)
+
+}  // namespace data
+}  // namespace tensorflow
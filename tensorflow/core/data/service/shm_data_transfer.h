@@ -0,0 +1,131 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+
+// Data transfer protocol for clients running on the same host as the worker
+// (Linux only).
+//
+// Each client connects to the worker over a Unix domain socket, and the worker
+// hands it a shared-memory ring buffer. The worker writes the components of
+// each element into the ring buffer, so that only a small response header is
+// sent over the socket, and the client reads them in place. Elements that
+// don't fit in the free space of the ring buffer are sent over the socket.
+constexpr const char kShmTransferProtocol[] = "shm";
+
+// Default size of the ring buffer shared with each client.
+constexpr int64_t kShmDefaultRingBufferBytes = 64 << 20;
+
+// Client side of a ring buffer shared with a `ShmDataTransferServer`.
+class ShmRingBuffer;
+
+class ShmDataTransferServer : public DataTransferServer {
+ public:
+  explicit ShmDataTransferServer(
+      GetElementT get_element,
+      int64_t ring_buffer_bytes = kShmDefaultRingBufferBytes);
+  ~ShmDataTransferServer() override;
+
+  absl::Status Start(const experimental::WorkerConfig& config) override;
+
+  // The server listens on a Unix domain socket rather than a port.
+  int Port() const override { return -1; }
+
+  std::string Address() const override { return address_; }
+
+  // Returns the host name of the server. Clients on other hosts can't connect
+  // to it.
+  absl::StatusOr<std::string> GetCompatibilityInfo() const override;
+
+ private:
+  struct Connection;
+
+  void AcceptLoop();
+  absl::Status AddConnection(int fd);
+  void Serve(Connection* connection);
+  absl::Status SendResponse(Connection& connection, const absl::Status& status,
+                            const GetElementResult& result);
+
+  const GetElementT get_element_;
+  const uint64_t ring_buffer_bytes_;
+  std::string address_;
+  int listen_fd_ = -1;
+  std::unique_ptr<Thread> accept_thread_;
+
+  mutex mu_;
+  bool stopped_ TF_GUARDED_BY(mu_) = false;
+  std::vector<std::unique_ptr<Connection>> connections_ TF_GUARDED_BY(mu_);
+};
+
+class ShmDataTransferClient : public DataTransferClient {
+ public:
+  // Connects to the server listening at `address`. If `allocator` is not null,
+  // components are copied out of the ring buffer into tensors allocated by
+  // `allocator`. Otherwise, the returned tensors point into the ring buffer,
+  // and their space is handed back to the server when they are destroyed.
+  static absl::StatusOr<std::unique_ptr<ShmDataTransferClient>> Create(
+      const std::string& address, Allocator* allocator);
+  ~ShmDataTransferClient() override;
+
+  absl::Status GetElement(const GetElementRequest& req,
+                          GetElementResult& result) override;
+
+  void TryCancel() override;
+
+  // Returns an error if the server runs on a different host.
+  absl::Status CheckCompatibility(
+      const std::string& server_compatibility_info) const override;
+
+ private:
+  ShmDataTransferClient(std::string address, int fd,
+                        core::RefCountPtr<ShmRingBuffer> ring,
+                        Allocator* allocator);
+
+  const std::string address_;
+  const int fd_;
+  const core::RefCountPtr<ShmRingBuffer> ring_;
+  Allocator* const allocator_;
+  std::atomic<bool> cancelled_ = false;
+
+  // Serializes requests and responses on the socket.
+  mutex mu_;
+  // Set if the socket is in an unknown state after a failed read or write.
+  bool broken_ TF_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
@@ -0,0 +1,286 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/dispatcher_client.h"
+#include "tensorflow/core/data/service/test_cluster.h"
+#include "tensorflow/core/data/service/test_util.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/data/service/worker_client.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+#include "tsl/platform/host_info.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::data::testing::RangeSquareDataset;
+using ::testing::HasSubstr;
+
+// Returns whether `tensor` points into a shared-memory ring buffer.
+bool IsInSharedMemory(const Tensor& tensor) {
+  TensorDescription description;
+  tensor.FillDescription(&description);
+  return description.allocation_description().allocator_name() == "shm";
+}
+
+// Starts a server that returns `element` for every request.
+std::unique_ptr<ShmDataTransferServer> StartServer(
+    std::vector<Tensor> element,
+    int64_t ring_buffer_bytes = kShmDefaultRingBufferBytes) {
+  auto server = std::make_unique<ShmDataTransferServer>(
+      [element](const GetElementRequest* request, GetElementResult* result) {
+        result->components = element;
+        result->element_index = request->task_id();
+        return absl::OkStatus();
+      },
+      ring_buffer_bytes);
+  TF_CHECK_OK(server->Start(experimental::WorkerConfig()));
+  return server;
+}
+
+absl::StatusOr<GetElementResult> GetElement(ShmDataTransferClient& client,
+                                            int64_t task_id = 0) {
+  GetElementRequest request;
+  request.set_task_id(task_id);
+  GetElementResult result;
+  TF_RETURN_IF_ERROR(client.GetElement(request, result));
+  return result;
+}
+
+TEST(ShmDataTransferTest, TransferElement) {
+  std::vector<Tensor> element = {
+      Tensor(int64_t{42}),
+      test::AsTensor<float>({1.0, 2.0, 3.0, 4.0, 5.0, 6.0}, {2, 3}),
+      test::AsTensor<tstring>({"a", "bc", "def"}, {3}),
+      Tensor(DT_INT32, TensorShape({0, 4}))};
+  std::unique_ptr<ShmDataTransferServer> server = StartServer(element);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ShmDataTransferClient> client,
+      ShmDataTransferClient::Create(server->Address(), /*allocator=*/nullptr));
+  for (int64_t i = 0; i < 3; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(GetElementResult result, GetElement(*client, i));
+    EXPECT_EQ(result.element_index, i);
+    EXPECT_FALSE(result.end_of_sequence);
+    EXPECT_FALSE(result.skip);
+    ASSERT_EQ(result.components.size(), element.size());
+    for (size_t j = 0; j < element.size(); ++j) {
+      test::ExpectEqual(result.components[j], element[j]);
+    }
+    EXPECT_TRUE(IsInSharedMemory(result.components[1]));
+  }
+}
+
+TEST(ShmDataTransferTest, TransferCompressedElement) {
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(
+      {test::AsTensor<int64_t>({1, 2, 3}), Tensor(tstring("abc"))},
+      &compressed));
+  Tensor tensor(DT_VARIANT, TensorShape({}));
+  tensor.scalar<Variant>()() = compressed;
+  std::unique_ptr<ShmDataTransferServer> server = StartServer({tensor});
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ShmDataTransferClient> client,
+      ShmDataTransferClient::Create(server->Address(), /*allocator=*/nullptr));
+
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result, GetElement(*client));
+  ASSERT_EQ(result.components.size(), 1);
+  const CompressedElement* received =
+      result.components[0].scalar<Variant>()().get<CompressedElement>();
+  ASSERT_NE(received, nullptr);
+  std::vector<Tensor> uncompressed;
+  TF_ASSERT_OK(UncompressElement(*received, &uncompressed));
+  ASSERT_EQ(uncompressed.size(), 2);
+  test::ExpectEqual(uncompressed[0], test::AsTensor<int64_t>({1, 2, 3}));
+  test::ExpectEqual(uncompressed[1], Tensor(tstring("abc")));
+}
+
+TEST(ShmDataTransferTest, SendElementsOverSocketWhenRingBufferIsFull) {
+  // Each element takes 64 bytes of header and 2048 bytes of data, so that the
+  // ring buffer fits only one at a time.
+  Tensor tensor(DT_FLOAT, TensorShape({512}));
+  test::FillIota<float>(&tensor, 0.0);
+  std::unique_ptr<ShmDataTransferServer> server =
+      StartServer({tensor}, /*ring_buffer_bytes=*/4096);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ShmDataTransferClient> client,
+      ShmDataTransferClient::Create(server->Address(), /*allocator=*/nullptr));
+
+  std::optional<GetElementResult> held;
+  TF_ASSERT_OK_AND_ASSIGN(held, GetElement(*client));
+  EXPECT_TRUE(IsInSharedMemory(held->components[0]));
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult in_line, GetElement(*client));
+  EXPECT_FALSE(IsInSharedMemory(in_line.components[0]));
+  test::ExpectEqual(in_line.components[0], tensor);
+
+  // Releasing the first element frees its space in the ring buffer.
+  held.reset();
+  for (int i = 0; i < 5; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(GetElementResult result, GetElement(*client));
+    EXPECT_TRUE(IsInSharedMemory(result.components[0]));
+    test::ExpectEqual(result.components[0], tensor);
+  }
+}
+
+TEST(ShmDataTransferTest, CopyIntoAllocator) {
+  const Tensor tensor = test::AsTensor<int64_t>({1, 2, 3});
+  std::unique_ptr<ShmDataTransferServer> server = StartServer({tensor});
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ShmDataTransferClient> client,
+      ShmDataTransferClient::Create(server->Address(), cpu_allocator()));
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result, GetElement(*client));
+  EXPECT_FALSE(IsInSharedMemory(result.components[0]));
+  test::ExpectEqual(result.components[0], tensor);
+}
+
+TEST(ShmDataTransferTest, EndOfSequence) {
+  ShmDataTransferServer server(
+      [](const GetElementRequest* request, GetElementResult* result) {
+        result->end_of_sequence = true;
+        return absl::OkStatus();
+      });
+  TF_ASSERT_OK(server.Start(experimental::WorkerConfig()));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ShmDataTransferClient> client,
+      ShmDataTransferClient::Create(server.Address(), /*allocator=*/nullptr));
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result, GetElement(*client));
+  EXPECT_TRUE(result.end_of_sequence);
+  EXPECT_TRUE(result.components.empty());
+}
+
+TEST(ShmDataTransferTest, PropagateErrors) {
+  ShmDataTransferServer server(
+      [](const GetElementRequest* request, GetElementResult* result) {
+        return absl::NotFoundError("Task not found.");
+      });
+  TF_ASSERT_OK(server.Start(experimental::WorkerConfig()));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ShmDataTransferClient> client,
+      ShmDataTransferClient::Create(server.Address(), /*allocator=*/nullptr));
+  EXPECT_THAT(GetElement(*client),
+              absl_testing::StatusIs(error::NOT_FOUND, "Task not found."));
+}
+
+TEST(ShmDataTransferTest, CancelClient) {
+  std::unique_ptr<ShmDataTransferServer> server =
+      StartServer({Tensor(int64_t{0})});
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ShmDataTransferClient> client,
+      ShmDataTransferClient::Create(server->Address(), /*allocator=*/nullptr));
+  client->TryCancel();
+  EXPECT_THAT(GetElement(*client),
+              absl_testing::StatusIs(error::CANCELLED,
+                                     HasSubstr("has been cancelled")));
+}
+
+TEST(ShmDataTransferTest, ServerOnOtherHost) {
+  std::unique_ptr<ShmDataTransferServer> server =
+      StartServer({Tensor(int64_t{0})});
+  TF_ASSERT_OK_AND_ASSIGN(std::string compatibility_info,
+                          server->GetCompatibilityInfo());
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ShmDataTransferClient> client,
+      ShmDataTransferClient::Create(server->Address(), /*allocator=*/nullptr));
+  TF_EXPECT_OK(client->CheckCompatibility(compatibility_info));
+  EXPECT_THAT(
+      client->CheckCompatibility(tsl::port::Hostname() + ".other"),
+      absl_testing::StatusIs(error::FAILED_PRECONDITION,
+                             HasSubstr("same host as the client")));
+}
+
+TEST(ShmDataTransferTest, ServerNotRunning) {
+  EXPECT_THAT(
+      ShmDataTransferClient::Create("@tf_data_shm.not_running",
+                                    /*allocator=*/nullptr),
+      absl_testing::StatusIs(error::INTERNAL, HasSubstr("Failed to connect")));
+  EXPECT_THAT(ShmDataTransferClient::Create("localhost:1234",
+                                            /*allocator=*/nullptr),
+              absl_testing::StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST(ShmDataTransferTest, ReadFromTestCluster) {
+  TestCluster cluster(/*num_workers=*/1, kShmTransferProtocol);
+  TF_ASSERT_OK(cluster.Initialize());
+  DataServiceDispatcherClient dispatcher(cluster.DispatcherAddress(), "grpc");
+
+  const int64_t range = 10;
+  std::string dataset_id;
+  TF_ASSERT_OK(dispatcher.RegisterDataset(
+      RangeSquareDataset(range), DataServiceMetadata(),
+      /*requested_dataset_id=*/std::nullopt, dataset_id));
+  ProcessingModeDef processing_mode;
+  processing_mode.set_sharding_policy(ProcessingModeDef::OFF);
+  int64_t job_id = 0;
+  TF_ASSERT_OK(dispatcher.GetOrCreateJob(
+      dataset_id, processing_mode, /*job_name=*/std::nullopt,
+      /*num_consumers=*/std::nullopt, /*use_cross_trainer_cache=*/false,
+      TARGET_WORKERS_AUTO, job_id));
+  int64_t iteration_client_id = 0;
+  TF_ASSERT_OK(dispatcher.GetOrCreateIteration(job_id, /*repetition=*/0,
+                                               iteration_client_id));
+  ClientHeartbeatRequest request;
+  ClientHeartbeatResponse response;
+  request.set_iteration_client_id(iteration_client_id);
+  TF_ASSERT_OK(dispatcher.ClientHeartbeat(request, response));
+  ASSERT_EQ(response.task_info_size(), 1);
+  const TaskInfo& task = response.task_info(0);
+
+  std::optional<DataTransferServerInfo> transfer_server;
+  for (const DataTransferServerInfo& info : task.transfer_servers()) {
+    if (info.protocol() == kShmTransferProtocol) {
+      transfer_server = info;
+    }
+  }
+  ASSERT_TRUE(transfer_server.has_value());
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<DataServiceWorkerClient> client,
+      CreateDataServiceWorkerClient("grpc", *transfer_server,
+                                    /*accelerator_device_info=*/nullptr,
+                                    /*allocator=*/nullptr));
+  EXPECT_EQ(client->GetDataTransferProtocol(), kShmTransferProtocol);
+  for (int64_t i = 0; i < range; ++i) {
+    GetElementRequest get_element_request;
+    get_element_request.set_task_id(task.task_id());
+    GetElementResult result;
+    TF_ASSERT_OK(client->GetElement(get_element_request, result));
+    ASSERT_FALSE(result.end_of_sequence);
+    test::ExpectEqual(result.components[0], Tensor(int64_t{i * i}));
+  }
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
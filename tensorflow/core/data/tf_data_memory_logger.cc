@@ -24,6 +24,7 @@ limitations under the License.
 #include "absl/base/call_once.h"
 #include "absl/container/flat_hash_set.h"
 #include "xla/tsl/platform/logging.h"
+#include "tensorflow/core/data/prefetch_memory_arbiter.h"
 #include "tensorflow/core/data/tfdataz_metrics.h"
 #include "tensorflow/core/framework/model.pb.h"
 #include "tensorflow/core/platform/env.h"
@@ -72,6 +73,16 @@ void LogDatasetMemoryUsage() {
   VLOG(4) << "Total buffered bytes across all (" << metric_collectors.size()
           << ") tf.data iterators: "
           << strings::HumanReadableNumBytes(TotalMemoryUsage(usages));
+  PrefetchMemoryArbiter::Stats arbiter_stats =
+      TfDatazMetricsRegistry::GetPrefetchMemoryArbiterStats();
+  VLOG(4) << "Prefetch buffers hold "
+          << strings::HumanReadableNumBytes(arbiter_stats.buffered_bytes)
+          << " out of "
+          << strings::HumanReadableNumBytes(arbiter_stats.limit_bytes) << " ("
+          << arbiter_stats.num_capped_buffers << " of "
+          << arbiter_stats.num_buffers << " buffers capped, "
+          << arbiter_stats.num_shrinks << " shrinks, "
+          << arbiter_stats.num_denied_growths << " denied growths).";
   VLOG(4) << "Top usages: ";
   for (int i = 0; i < 5; ++i) {
     if (i >= usages.size()) {
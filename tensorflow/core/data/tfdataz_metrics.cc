@@ -170,5 +170,10 @@ TfDatazMetricsRegistry::GetIteratorMetricCollectors() {
   return tfdataz_metric_collectors();
 }
 
+PrefetchMemoryArbiter::Stats
+TfDatazMetricsRegistry::GetPrefetchMemoryArbiterStats() {
+  return PrefetchMemoryArbiter::Global().GetStats();
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
+#include "tensorflow/core/data/prefetch_memory_arbiter.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/platform/env.h"
@@ -142,6 +143,9 @@ class TfDatazMetricsRegistry {
   // Returns all the registered `TfDatazMetricsCollector`s.
   static absl::flat_hash_set<std::shared_ptr<TfDatazMetricsCollector>>
   GetIteratorMetricCollectors();
+
+  // Returns the statistics of the process-wide prefetch memory arbiter.
+  static PrefetchMemoryArbiter::Stats GetPrefetchMemoryArbiterStats();
 };
 
 }  // namespace data
@@ -18,6 +18,7 @@ limitations under the License.
 #include <utility>
 
 #include "absl/time/time.h"
+#include "tensorflow/core/data/prefetch_memory_arbiter.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
@@ -231,6 +232,17 @@ TEST(TfDatazMetricsRegistryTest, Deregister) {
   EXPECT_EQ(TfDatazMetricsRegistry::GetIteratorMetricCollectors().size(), 0);
 }
 
+TEST(TfDatazMetricsRegistryTest, PrefetchMemoryArbiterStats) {
+  const int64_t num_buffers =
+      TfDatazMetricsRegistry::GetPrefetchMemoryArbiterStats().num_buffers;
+  auto buffer = PrefetchMemoryArbiter::Global().Register("prefetch");
+  EXPECT_EQ(TfDatazMetricsRegistry::GetPrefetchMemoryArbiterStats().num_buffers,
+            num_buffers + 1);
+  buffer.reset();
+  EXPECT_EQ(TfDatazMetricsRegistry::GetPrefetchMemoryArbiterStats().num_buffers,
+            num_buffers);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
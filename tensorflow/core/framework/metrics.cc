@@ -436,6 +436,12 @@ auto* graph_optimization_cache_load_count = tsl::monitoring::Counter<1>::New(
     "source"  // graph optimization source
 );
 
+auto* grappler_result_cache_lookup_count = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/grappler/result_cache_lookup_count",
+    "The number of lookups in the Grappler MetaOptimizer result cache.",
+    "result"  // memory_hit, disk_hit or miss
+);
+
 auto* xla_compilations = tsl::monitoring::Counter<0>::New(
     "/tensorflow/core/xla_compilations",
     "The number of XLA compilations used to collect "
@@ -965,6 +971,14 @@ int64_t GetFunctionGraphOptimizationCacheLoadCount(
   return graph_optimization_cache_load_count->GetCell(mapped_source)->value();
 }
 
+void RecordGrapplerResultCacheLookup(const std::string& result) {
+  grappler_result_cache_lookup_count->GetCell(result)->IncrementBy(1);
+}
+
+int64_t GetGrapplerResultCacheLookupCount(const std::string& result) {
+  return grappler_result_cache_lookup_count->GetCell(result)->value();
+}
+
 void UpdateTpuVariableDistributionTime(const uint64_t distribution_time_usecs) {
   if (distribution_time_usecs > 0) {
     tpu_variable_distribution_time_usecs->GetCell()->IncrementBy(
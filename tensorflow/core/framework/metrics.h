@@ -362,6 +362,14 @@ void IncrementFunctionGraphOptimizationCacheLoadCount(
 int64_t GetFunctionGraphOptimizationCacheLoadCount(
     GraphOptimizationSource source);
 
+// Records a lookup in the Grappler MetaOptimizer result cache. `result` is one
+// of "memory_hit", "disk_hit" or "miss".
+void RecordGrapplerResultCacheLookup(const std::string& result);
+
+// Gets the number of Grappler MetaOptimizer result cache lookups with the
+// given `result`.
+int64_t GetGrapplerResultCacheLookupCount(const std::string& result);
+
 // Records the activity of the first phase of the mlir bridge using the
 // tf_metadata.tf_mlir_bridge_first_phase_v2_count metric.
 // bridge_type: replicated, nonreplicated, etc.
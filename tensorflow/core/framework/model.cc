@@ -22,7 +22,12 @@ limitations under the License.
 #include <memory>
 #include <optional>
 #include <queue>
+#include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
 #include "absl/time/clock.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -41,6 +46,7 @@ namespace model {
 
 constexpr int64_t Model::kOptimizationPeriodMinMs;
 constexpr int64_t Model::kOptimizationPeriodMaxMs;
+constexpr int64_t Model::kWarmStartOptimizationPeriodMs;
 
 namespace {
 
@@ -361,6 +367,29 @@ inline void UpdateStateValues(Node::ModelParameters* parameters) {
   }
 }
 
+// Returns the nodes of the tree rooted in `output` with their path from
+// `output`: the node names joined by "/". A node that has the same name as an
+// earlier sibling gets its position among those siblings appended, e.g.
+// "Zip/Range[1]", so that the paths are unique.
+std::vector<std::pair<std::string, std::shared_ptr<Node>>> CollectNodePaths(
+    std::shared_ptr<Node> output) {
+  std::vector<std::pair<std::string, std::shared_ptr<Node>>> nodes;
+  nodes.emplace_back(output->name(), output);
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    const std::string prefix = nodes[i].first;
+    absl::flat_hash_map<std::string, int64_t> name_counts;
+    for (const auto& input : nodes[i].second->inputs()) {
+      std::string path = absl::StrCat(prefix, "/", input->name());
+      const int64_t count = name_counts[input->name()]++;
+      if (count > 0) {
+        absl::StrAppend(&path, "[", count, "]");
+      }
+      nodes.emplace_back(std::move(path), input);
+    }
+  }
+  return nodes;
+}
+
 // Recursively produces protos for nodes in a subtree of `output` node and
 // appends them to nodes of the given model.
 absl::Status ModelToProtoHelper(std::shared_ptr<Node> output,
@@ -1649,6 +1678,20 @@ Node::ModelParameters Node::CollectNodeTunableParameters() const {
   return parameters;
 }
 
+std::vector<std::shared_ptr<Parameter>> Node::TunableParameters() const {
+  tf_shared_lock l(mu_);
+  std::vector<std::shared_ptr<Parameter>> parameters;
+  if (!autotune_) {
+    return parameters;
+  }
+  for (const auto& pair : parameters_) {
+    if (pair.second->state != nullptr && pair.second->state->tunable) {
+      parameters.push_back(pair.second);
+    }
+  }
+  return parameters;
+}
+
 std::string Node::DebugString() const {
   absl::flat_hash_map<std::string, std::string> debug_strings;
   tf_shared_lock l(mu_);
@@ -2554,6 +2597,13 @@ absl::Status Model::OptimizeLoop(AutotuneAlgorithm algorithm,
 
   int64_t last_optimization_ms = 0;
   int64_t current_time_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
+  {
+    tf_shared_lock l(mu_);
+    // After a warm start, the first optimization waits for a full period.
+    if (warm_started_) {
+      last_optimization_ms = current_time_ms;
+    }
+  }
   while (true) {
     {
       mutex_lock l(mu_);
@@ -2756,6 +2806,82 @@ void Model::OptimizeHillClimbHelper(
     UpdateStateValues(&parameters);
   }
 }
+
+ModelTunables Model::ExportTunables() {
+  std::shared_ptr<Node> output;
+  {
+    tf_shared_lock l(mu_);
+    output = output_;
+  }
+  ModelTunables tunables;
+  if (!output) {
+    return tunables;
+  }
+  for (const auto& [path, node] : CollectNodePaths(output)) {
+    for (const auto& parameter : node->TunableParameters()) {
+      double value;
+      {
+        tf_shared_lock l(*parameter->state->mu);
+        value = parameter->state->value;
+      }
+      // The parameter has not been tuned yet.
+      if (value == kAutotune) {
+        continue;
+      }
+      ModelTunables::Tunable* tunable = tunables.add_tunables();
+      tunable->set_node_path(path);
+      tunable->set_parameter(parameter->name);
+      tunable->set_value(value);
+    }
+  }
+  tunables.set_maximum_buffered_bytes(TotalMaximumBufferedBytes(output));
+  return tunables;
+}
+
+int64_t Model::WarmStart(const ModelTunables& tunables,
+                         RamBudgetManager& ram_budget_manager) {
+  std::shared_ptr<Node> output;
+  {
+    tf_shared_lock l(mu_);
+    output = output_;
+  }
+  if (!output) {
+    return 0;
+  }
+  absl::flat_hash_map<std::pair<std::string, std::string>, double> values;
+  for (const auto& tunable : tunables.tunables()) {
+    values[{tunable.node_path(), tunable.parameter()}] = tunable.value();
+  }
+  const bool set_buffer_sizes = ram_budget_manager.RequestModelAllocation(
+      tunables.maximum_buffered_bytes());
+  if (!set_buffer_sizes) {
+    VLOG(2) << "Not warm-starting buffer sizes, as the RAM budget cannot "
+            << "accommodate " << tunables.maximum_buffered_bytes()
+            << " buffered bytes.";
+  }
+  ModelParameters parameters;
+  for (const auto& [path, node] : CollectNodePaths(output)) {
+    for (const auto& parameter : node->TunableParameters()) {
+      auto it = values.find({path, parameter->name});
+      if (it == values.end() ||
+          (parameter->name == kBufferSize && !set_buffer_sizes)) {
+        continue;
+      }
+      parameter->value =
+          std::clamp(it->second, parameter->min, parameter->max);
+      parameters.push_back(std::make_pair(node->long_name(), parameter));
+    }
+  }
+  if (parameters.empty()) {
+    return 0;
+  }
+  UpdateStateValues(&parameters);
+  mutex_lock l(mu_);
+  warm_started_ = true;
+  optimization_period_ms_ = kWarmStartOptimizationPeriodMs;
+  return parameters.size();
+}
+
 void Model::RecordIteratorGapTime(uint64_t duration_usec) {
   mutex_lock l(gap_mu_);
   // Drop duration if it is too large.
@@ -566,6 +566,12 @@ class Node {
   // Collects tunable parameters in this node.
   ModelParameters CollectNodeTunableParameters() const TF_LOCKS_EXCLUDED(mu_);
 
+  // Returns the tunable parameters of this node. Unlike
+  // `CollectNodeTunableParameters()`, includes the parameters of a node that
+  // has not produced any elements yet.
+  std::vector<std::shared_ptr<Parameter>> TunableParameters() const
+      TF_LOCKS_EXCLUDED(mu_);
+
   // Returns a human-readable representation of this node.
   std::string DebugString() const TF_LOCKS_EXCLUDED(mu_);
 
@@ -1027,6 +1033,23 @@ class Model {
                            std::unique_ptr<Model>* model,
                            OptimizationParams* optimization_params);
 
+  // Exports the current values of the tunable parameters of the model, so
+  // that later runs of the same input pipeline can warm-start from them. The
+  // parameters are keyed by the path of their node from the output node,
+  // which, unlike the node id, is the same across runs.
+  ModelTunables ExportTunables() TF_LOCKS_EXCLUDED(mu_);
+
+  // Sets the tunable parameters of the model to the values in `tunables`,
+  // exported by an earlier run of the same input pipeline. Values are clamped
+  // to the range of their parameter, and buffer sizes are only set if
+  // `ram_budget_manager` can accommodate the memory they used in the earlier
+  // run. Autotuning continues from the new values, but the first optimization
+  // of `OptimizeLoop` is deferred until the model has recorded enough
+  // processing time to improve on them. Returns the number of parameters set.
+  int64_t WarmStart(const ModelTunables& tunables,
+                    RamBudgetManager& ram_budget_manager)
+      TF_LOCKS_EXCLUDED(mu_);
+
   // Records gap time between consecutive `GetNext()` calls.
   void RecordIteratorGapTime(uint64_t duration_usec);
 
@@ -1055,6 +1078,11 @@ class Model {
   static constexpr int64_t kOptimizationPeriodMinMs = 10;
   static constexpr int64_t kOptimizationPeriodMaxMs =
       60 * EnvTime::kSecondsToMillis;
+  // The optimization period after a warm start. Optimizing as early as a cold
+  // start would replace the warm-start values with ones computed from only a
+  // few recorded elements.
+  static constexpr int64_t kWarmStartOptimizationPeriodMs =
+      EnvTime::kSecondsToMillis;
 
   // Collects tunable parameters in the tree rooted in the given node, returning
   // a vector which contains pairs of node names and tunable parameters.
@@ -1190,6 +1218,8 @@ class Model {
   // Determines the time the optimization loop should wait between
   // running optimizations.
   int64_t optimization_period_ms_ TF_GUARDED_BY(mu_);
+  // Whether the tunable parameters were set by `WarmStart()`.
+  bool warm_started_ TF_GUARDED_BY(mu_) = false;
 
   // Gauge cell that can be used to collect the state of the model.
   monitoring::GaugeCell<std::function<std::string()>>* model_gauge_cell_ =
@@ -24,8 +24,10 @@ limitations under the License.
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/model.pb.h"
@@ -1387,6 +1389,193 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
                          ::testing::Values(0, 1, 2, 3));
 
+// A simulated input pipeline `Range -> Map -> ParallelMapV2 -> Prefetch`,
+// whose nodes take a fixed CPU time per element.
+class SimulatedPipeline {
+ public:
+  SimulatedPipeline() : ram_budget_manager_(kRamBudget) {
+    AddAsyncNode("Prefetch", nullptr, kBufferSize, /*max=*/8, &prefetch_);
+    AddAsyncNode("ParallelMapV2", prefetch_, kParallelism, /*max=*/16,
+                 &parallel_map_);
+    model_.AddNode(
+        [](Node::Args args) { return MakeKnownRatioNode(std::move(args), 1); },
+        "Map", parallel_map_, &map_);
+    model_.AddNode(
+        [](Node::Args args) { return MakeSourceNode(std::move(args)); },
+        "Range", map_, &range_);
+  }
+
+  // Records the elements the pipeline produces in `duration_usec` with the
+  // current parallelism of `ParallelMapV2`.
+  void Run(int64_t duration_usec) {
+    const int64_t num_elements = duration_usec * EnvTime::kMicrosToNanos *
+                                 parallelism_value() / kParallelMapTimeNsec;
+    for (const auto& [node, time_nsec] :
+         std::vector<std::pair<std::shared_ptr<Node>, int64_t>>{
+             {prefetch_, 10},
+             {parallel_map_, kParallelMapTimeNsec},
+             {map_, 1000},
+             {range_, 100}}) {
+      node->add_processing_time(num_elements * time_nsec);
+      for (int64_t i = 0; i < num_elements; ++i) {
+        node->record_element();
+      }
+    }
+    num_elements_ += num_elements;
+  }
+
+  // Runs one optimization round.
+  void Optimize() {
+    CancellationManager cancellation_manager;
+    model_.Optimize(AutotuneAlgorithm::HILL_CLIMB, CpuBudgetFunc(8),
+                    /*ram_budget_share=*/1.0, /*fixed_ram_budget=*/kRamBudget,
+                    /*model_input_time=*/0, ram_budget_manager_,
+                    &cancellation_manager);
+  }
+
+  // Simulates `OptimizeLoop` for `num_rounds` optimization rounds, starting
+  // with the given period. Returns the simulated time in microseconds of the
+  // last round that changed a tunable parameter, or 0 if none did.
+  int64_t SimulateOptimizeLoop(int64_t num_rounds, int64_t period_usec,
+                               bool optimize_first) {
+    int64_t time_usec = 0;
+    int64_t converged_usec = 0;
+    if (optimize_first) {
+      Optimize();
+    }
+    for (int64_t i = 0; i < num_rounds; ++i) {
+      Run(period_usec);
+      time_usec += period_usec;
+      const std::pair<double, double> values = tunable_values();
+      Optimize();
+      if (tunable_values() != values) {
+        converged_usec = time_usec;
+        elements_until_converged_ = num_elements_;
+      }
+      period_usec *= 2;
+    }
+    return converged_usec;
+  }
+
+  int64_t parallelism_value() const {
+    return std::max<int64_t>(
+        1, static_cast<int64_t>(parallel_map_->parameter_value(kParallelism)));
+  }
+  std::pair<double, double> tunable_values() const {
+    return {parallel_map_->parameter_value(kParallelism),
+            prefetch_->parameter_value(kBufferSize)};
+  }
+  int64_t elements_until_converged() const {
+    return elements_until_converged_;
+  }
+  Model& model() { return model_; }
+  RamBudgetManager& ram_budget_manager() { return ram_budget_manager_; }
+
+ private:
+  static constexpr int64_t kRamBudget = 1 << 30;
+  static constexpr int64_t kParallelMapTimeNsec = 100000;
+
+  void AddAsyncNode(const std::string& name, std::shared_ptr<Node> parent,
+                    const std::string& parameter_name, double max,
+                    std::shared_ptr<Node>* out_node) {
+    auto state = std::make_shared<SharedState>(
+        /*value=*/kAutotune, std::make_shared<mutex>(),
+        std::make_shared<condition_variable>());
+    // Like the iterators, start from the minimum value.
+    state->value = 1;
+    model_.AddNode(
+        [&](Node::Args args) {
+          return MakeAsyncKnownRatioNode(
+              std::move(args), /*ratio=*/1,
+              {MakeParameter(parameter_name, state, /*min=*/1, max)});
+        },
+        name, parent, out_node);
+  }
+
+  Model model_;
+  RamBudgetManager ram_budget_manager_;
+  std::shared_ptr<Node> prefetch_;
+  std::shared_ptr<Node> parallel_map_;
+  std::shared_ptr<Node> map_;
+  std::shared_ptr<Node> range_;
+  int64_t num_elements_ = 0;
+  int64_t elements_until_converged_ = 0;
+};
+
+TEST(WarmStartTest, ConvergesImmediately) {
+  constexpr int64_t kNumRounds = 4;
+  // The first optimization periods of `OptimizeLoop`.
+  constexpr int64_t kColdPeriodUsec = 10 * EnvTime::kMillisToMicros;
+  constexpr int64_t kWarmPeriodUsec = EnvTime::kSecondsToMicros;
+
+  SimulatedPipeline cold;
+  const int64_t cold_converged_usec = cold.SimulateOptimizeLoop(
+      kNumRounds, kColdPeriodUsec, /*optimize_first=*/true);
+  EXPECT_GT(cold_converged_usec, 0);
+  EXPECT_GT(cold.elements_until_converged(), 0);
+  EXPECT_GT(cold.parallelism_value(), 1);
+  ModelTunables tunables = cold.model().ExportTunables();
+  EXPECT_EQ(tunables.tunables_size(), 2);
+
+  SimulatedPipeline warm;
+  EXPECT_EQ(warm.model().WarmStart(tunables, warm.ram_budget_manager()), 2);
+  // The tunables are set before the pipeline produces any elements, and stay
+  // at the converged values as the model keeps optimizing.
+  EXPECT_EQ(warm.tunable_values(), cold.tunable_values());
+  const int64_t warm_converged_usec = warm.SimulateOptimizeLoop(
+      kNumRounds, kWarmPeriodUsec, /*optimize_first=*/false);
+  EXPECT_EQ(warm_converged_usec, 0);
+  EXPECT_EQ(warm.elements_until_converged(), 0);
+  EXPECT_EQ(warm.tunable_values(), cold.tunable_values());
+}
+
+TEST(WarmStartTest, ExportedTunables) {
+  SimulatedPipeline pipeline;
+  // Parameters that have not been tuned are exported with their current value.
+  ModelTunables tunables = pipeline.model().ExportTunables();
+  ASSERT_EQ(tunables.tunables_size(), 2);
+  absl::flat_hash_map<std::string, std::string> parameters;
+  for (const auto& tunable : tunables.tunables()) {
+    parameters[tunable.node_path()] = tunable.parameter();
+    EXPECT_EQ(tunable.value(), 1);
+  }
+  EXPECT_EQ(parameters["Prefetch"], kBufferSize);
+  EXPECT_EQ(parameters["Prefetch/ParallelMapV2"], kParallelism);
+}
+
+TEST(WarmStartTest, IgnoresUnknownAndOutOfRangeTunables) {
+  SimulatedPipeline pipeline;
+  ModelTunables tunables;
+  ModelTunables::Tunable* tunable = tunables.add_tunables();
+  tunable->set_node_path("Prefetch/ParallelMapV2/Map");
+  tunable->set_parameter(kParallelism);
+  tunable->set_value(4);
+  tunable = tunables.add_tunables();
+  tunable->set_node_path("Prefetch/ParallelMapV2");
+  tunable->set_parameter(kParallelism);
+  tunable->set_value(1000);
+  EXPECT_EQ(pipeline.model().WarmStart(tunables, pipeline.ram_budget_manager()),
+            1);
+  EXPECT_EQ(pipeline.parallelism_value(), 16);
+}
+
+TEST(WarmStartTest, SkipsBufferSizesOverRamBudget) {
+  SimulatedPipeline pipeline;
+  ModelTunables tunables;
+  ModelTunables::Tunable* tunable = tunables.add_tunables();
+  tunable->set_node_path("Prefetch");
+  tunable->set_parameter(kBufferSize);
+  tunable->set_value(8);
+  tunable = tunables.add_tunables();
+  tunable->set_node_path("Prefetch/ParallelMapV2");
+  tunable->set_parameter(kParallelism);
+  tunable->set_value(4);
+  tunables.set_maximum_buffered_bytes(int64_t{1} << 40);
+  EXPECT_EQ(pipeline.model().WarmStart(tunables, pipeline.ram_budget_manager()),
+            1);
+  EXPECT_EQ(pipeline.tunable_values(), std::make_pair(4.0, 1.0));
+}
+
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
   EXPECT_FALSE(source->is_recording());
@@ -0,0 +1,406 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/gtl/map_util.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kMapAndBatchDatasetOp[] = "MapAndBatchDataset";
+constexpr char kBatchDatasetV2Op[] = "BatchDatasetV2";
+constexpr char kParallelMapDatasetV2Op[] = "ParallelMapDatasetV2";
+constexpr char kMapDefunOp[] = "MapDefun";
+constexpr char kConstOp[] = "Const";
+constexpr char kOutputShapesAttr[] = "output_shapes";
+constexpr char kOutputTypesAttr[] = "output_types";
+
+// Returns the number of inputs of `op` if it is an elementwise op, i.e. an op
+// whose output elements only depend on the corresponding elements of its
+// (broadcast) inputs, and -1 otherwise.
+int NumElementwiseInputs(const std::string& op) {
+  static const auto* const kUnaryOps = new absl::flat_hash_set<std::string>(
+      {"Abs", "Cast", "Ceil", "Cos", "Elu", "Exp", "Expm1", "Floor", "Identity",
+       "IsFinite", "IsInf", "IsNan", "Log", "Log1p", "LogicalNot", "Neg",
+       "Reciprocal", "Relu", "Relu6", "Rint", "Round", "Rsqrt", "Selu",
+       "Sigmoid", "Sign", "Sin", "Softplus", "Sqrt", "Square", "Tan", "Tanh"});
+  static const auto* const kBinaryOps = new absl::flat_hash_set<std::string>(
+      {"Add", "AddV2", "BitwiseAnd", "BitwiseOr", "BitwiseXor", "Div",
+       "DivNoNan", "Equal", "FloorDiv", "FloorMod", "Greater", "GreaterEqual",
+       "Less", "LessEqual", "LogicalAnd", "LogicalOr", "Maximum", "Minimum",
+       "Mod", "Mul", "MulNoNan", "NotEqual", "Pow", "RealDiv",
+       "SquaredDifference", "Sub", "TruncateDiv", "TruncateMod"});
+  if (kUnaryOps->contains(op)) return 1;
+  if (kBinaryOps->contains(op)) return 2;
+  if (op == "SelectV2") return 3;
+  return -1;
+}
+
+// Describes how a value computed by the map function relates to the value
+// computed by the vectorized function.
+struct VectorizedValue {
+  enum Kind {
+    // The value depends on the element. The vectorized function computes the
+    // stack of its per-element values.
+    kBatched,
+    // The value is a scalar that does not depend on the element. The
+    // vectorized function computes the same value.
+    kScalar,
+    // The value cannot be computed by the vectorized function.
+    kUnvectorizable,
+  };
+
+  Kind kind = kUnvectorizable;
+  // The rank of the per-element value, for `kBatched` values.
+  int rank = -1;
+};
+
+// Determines which values of a map function can be computed on a batch of
+// stacked elements, by applying the function's ops to the whole batch.
+class Vectorizability {
+ public:
+  Vectorizability(const FunctionDef& function,
+                  absl::flat_hash_map<std::string, VectorizedValue> args)
+      : values_(std::move(args)) {
+    for (const NodeDef& node : function.node_def()) {
+      nodes_[node.name()] = &node;
+    }
+  }
+
+  // Returns how the function tensor `tensor` relates to its counterpart in
+  // the vectorized function. `tensor` is either an argument name or a
+  // `node_name:node_output:position` string.
+  VectorizedValue Classify(const std::string& tensor) {
+    if (tensor.empty() || tensor[0] == '^') return {};
+    const std::string name = tensor.substr(0, tensor.find(':'));
+    if (auto* value = gtl::FindOrNull(values_, name)) return *value;
+    const NodeDef* node = gtl::FindPtrOrNull(nodes_, name);
+    if (node == nullptr || !in_progress_.insert(name).second) return {};
+    VectorizedValue value = ClassifyNode(*node);
+    in_progress_.erase(name);
+    values_[name] = value;
+    return value;
+  }
+
+ private:
+  VectorizedValue ClassifyNode(const NodeDef& node) {
+    if (node.op() == kConstOp) {
+      const auto* value = gtl::FindOrNull(node.attr(), "value");
+      if (value && value->tensor().tensor_shape().dim_size() == 0) {
+        return {VectorizedValue::kScalar};
+      }
+      return {};
+    }
+    // Control inputs are counted as inputs, so that nodes with control
+    // dependencies are not vectorized.
+    if (NumElementwiseInputs(node.op()) != node.input_size()) return {};
+    VectorizedValue result = {VectorizedValue::kScalar};
+    for (const std::string& input : node.input()) {
+      VectorizedValue value = Classify(input);
+      if (value.kind == VectorizedValue::kUnvectorizable) return {};
+      if (value.kind == VectorizedValue::kScalar) continue;
+      // Broadcasting two per-element values against each other is only
+      // equivalent to broadcasting their stacks if they have the same rank.
+      if (result.kind == VectorizedValue::kBatched &&
+          result.rank != value.rank) {
+        return {};
+      }
+      result = value;
+    }
+    return result;
+  }
+
+  absl::flat_hash_map<std::string, VectorizedValue> values_;
+  absl::flat_hash_map<std::string, const NodeDef*> nodes_;
+  absl::flat_hash_set<std::string> in_progress_;
+};
+
+// Returns the function that computes `function` on a batch of stacked
+// elements, or nullptr if none of its outputs can be vectorized. The function,
+// and the per-element function it falls back to, are added to `library`.
+const FunctionDef* VectorizeFunction(
+    const FunctionDef& function, const DataTypeVector& arg_types,
+    const std::vector<PartialTensorShape>& arg_shapes,
+    const DataTypeVector& captured_types, const DataTypeVector& output_types,
+    const std::vector<PartialTensorShape>& output_shapes,
+    FunctionDefLibrary* library) {
+  const OpDef& signature = function.signature();
+  const int num_args = arg_types.size();
+  if (signature.input_arg_size() !=
+          num_args + static_cast<int>(captured_types.size()) ||
+      signature.output_arg_size() != static_cast<int>(output_types.size())) {
+    return nullptr;
+  }
+
+  absl::flat_hash_map<std::string, VectorizedValue> args;
+  for (int i = 0; i < signature.input_arg_size(); ++i) {
+    // Captured inputs are not batched, and their shapes are not known here,
+    // so ops that consume them are left to the per-element function.
+    args[signature.input_arg(i).name()] =
+        i < num_args
+            ? VectorizedValue{VectorizedValue::kBatched, arg_shapes[i].dims()}
+            : VectorizedValue{};
+  }
+  Vectorizability vectorizability(function, std::move(args));
+
+  std::vector<int> unvectorized_outputs;
+  for (int i = 0; i < signature.output_arg_size(); ++i) {
+    const std::string* ret =
+        gtl::FindOrNull(function.ret(), signature.output_arg(i).name());
+    if (ret == nullptr) return nullptr;
+    if (vectorizability.Classify(*ret).kind != VectorizedValue::kBatched) {
+      unvectorized_outputs.push_back(i);
+    }
+  }
+  if (unvectorized_outputs.size() == output_types.size()) {
+    return nullptr;
+  }
+
+  FunctionDef* vectorized = library->add_function();
+  *vectorized->mutable_signature() = signature;
+  graph_utils::SetUniqueGraphFunctionName(
+      absl::StrCat("vectorized_", signature.name()), library, vectorized);
+  *vectorized->mutable_attr() = function.attr();
+  for (const NodeDef& node : function.node_def()) {
+    if (vectorizability.Classify(node.name()).kind ==
+        VectorizedValue::kUnvectorizable) {
+      continue;
+    }
+    NodeDef* vectorized_node = vectorized->add_node_def();
+    *vectorized_node = node;
+    // The inferred shapes are per-element shapes.
+    vectorized_node->mutable_attr()->erase("_output_shapes");
+  }
+  for (const auto& output_arg : signature.output_arg()) {
+    (*vectorized->mutable_ret())[output_arg.name()] =
+        function.ret().at(output_arg.name());
+  }
+  if (unvectorized_outputs.empty()) return vectorized;
+
+  // Computes the remaining outputs by invoking a copy of `function`, pruned
+  // to these outputs, once per element.
+  FunctionDef* per_element = library->add_function();
+  *per_element = function;
+  graph_utils::SetUniqueGraphFunctionName(
+      absl::StrCat(signature.name(), "_per_element"), library, per_element);
+  per_element->mutable_signature()->clear_output_arg();
+  per_element->clear_ret();
+  DataTypeVector per_element_types;
+  std::vector<PartialTensorShape> per_element_shapes;
+  for (int i : unvectorized_outputs) {
+    const std::string& name = signature.output_arg(i).name();
+    *per_element->mutable_signature()->add_output_arg() =
+        signature.output_arg(i);
+    (*per_element->mutable_ret())[name] = function.ret().at(name);
+    per_element_types.push_back(output_types[i]);
+    per_element_shapes.push_back(output_shapes[i]);
+  }
+
+  std::vector<std::string> inputs;
+  for (const auto& input_arg : signature.input_arg()) {
+    inputs.push_back(input_arg.name());
+  }
+  std::vector<std::pair<std::string, AttrValue>> attrs(5);
+  SetAttrValue(arg_types, &attrs[0].second);
+  attrs[0].first = "Targuments";
+  SetAttrValue(captured_types, &attrs[1].second);
+  attrs[1].first = "Tcaptured";
+  SetAttrValue(per_element_types, &attrs[2].second);
+  attrs[2].first = kOutputTypesAttr;
+  SetAttrValue(per_element_shapes, &attrs[3].second);
+  attrs[3].first = kOutputShapesAttr;
+  attrs[4].first = "f";
+  attrs[4].second.mutable_func()->set_name(per_element->signature().name());
+  const NodeDef* map_defun =
+      function_utils::AddNode("", kMapDefunOp, inputs, attrs, vectorized);
+  for (int i = 0; i < static_cast<int>(unvectorized_outputs.size()); ++i) {
+    const std::string& name =
+        signature.output_arg(unvectorized_outputs[i]).name();
+    (*vectorized->mutable_ret())[name] =
+        absl::StrCat(map_defun->name(), ":output:", i);
+  }
+  return vectorized;
+}
+
+// Returns the per-element shapes of the given batched shapes, or an empty
+// vector if the batch dimension is unknown.
+std::vector<PartialTensorShape> UnbatchShapes(
+    const std::vector<PartialTensorShape>& batched_shapes) {
+  std::vector<PartialTensorShape> shapes;
+  for (const PartialTensorShape& batched_shape : batched_shapes) {
+    if (batched_shape.unknown_rank() || batched_shape.dims() < 1) return {};
+    const auto dims = batched_shape.dim_sizes();
+    shapes.emplace_back(std::vector<int64_t>(dims.begin() + 1, dims.end()));
+  }
+  return shapes;
+}
+
+NodeDef MakeBatchNode(const NodeDef& map_and_batch_node,
+                      const DataTypeVector& input_types,
+                      const std::vector<PartialTensorShape>& input_shapes,
+                      int64_t batch_dim, int num_captured,
+                      MutableGraphView* graph) {
+  NodeDef batch_node;
+  batch_node.set_op(kBatchDatasetV2Op);
+  graph_utils::SetUniqueGraphNodeName(kBatchDatasetV2Op, graph->graph(),
+                                      &batch_node);
+  batch_node.add_input(map_and_batch_node.input(0));
+  batch_node.add_input(map_and_batch_node.input(1 + num_captured));
+  batch_node.add_input(map_and_batch_node.input(3 + num_captured));
+
+  std::vector<PartialTensorShape> batch_shapes;
+  for (const PartialTensorShape& shape : input_shapes) {
+    batch_shapes.push_back(PartialTensorShape({batch_dim}).Concatenate(shape));
+  }
+  AddNodeAttr("parallel_copy", false, &batch_node);
+  AddNodeAttr(kOutputTypesAttr, input_types, &batch_node);
+  AddNodeAttr(kOutputShapesAttr, batch_shapes, &batch_node);
+  return batch_node;
+}
+
+NodeDef MakeMapNode(const NodeDef& map_and_batch_node,
+                    const NodeDef& batch_node,
+                    const FunctionDef& vectorized_function, int num_captured,
+                    MutableGraphView* graph) {
+  NodeDef map_node;
+  map_node.set_op(kParallelMapDatasetV2Op);
+  graph_utils::SetUniqueGraphNodeName(kParallelMapDatasetV2Op,
+                                      graph->graph(), &map_node);
+  map_node.add_input(batch_node.name());
+  for (int i = 0; i < num_captured; ++i) {
+    map_node.add_input(map_and_batch_node.input(1 + i));
+  }
+  map_node.add_input(map_and_batch_node.input(2 + num_captured));
+
+  AttrValue f;
+  f.mutable_func()->set_name(vectorized_function.signature().name());
+  (*map_node.mutable_attr())["f"] = f;
+  graph_utils::CopyAttribute("Targuments", map_and_batch_node, &map_node);
+  graph_utils::CopyShapesAndTypesAttrs(map_and_batch_node, &map_node);
+  AddNodeAttr("deterministic", "default", &map_node);
+  for (auto key : {"preserve_cardinality", "metadata"}) {
+    if (gtl::FindOrNull(map_and_batch_node.attr(), key)) {
+      graph_utils::CopyAttribute(key, map_and_batch_node, &map_node);
+    }
+  }
+  return map_node;
+}
+
+}  // namespace
+
+absl::Status MapVectorization::OptimizeAndCollectStats(
+    Cluster* cluster, const GrapplerItem& item, GraphDef* output,
+    OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<std::string> nodes_to_delete;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() != kMapAndBatchDatasetOp) continue;
+    const FunctionDef* function =
+        function_library.Find(node.attr().at("f").func().name());
+    if (function == nullptr || function->control_ret_size() > 0 ||
+        function_utils::IsFunctionStateful(function_library, *function)) {
+      continue;
+    }
+
+    // Batching before mapping is only equivalent to mapping before batching
+    // if all input elements are known to have the same shape.
+    const NodeDef* input_node = graph_utils::GetInputNode(node, graph);
+    DataTypeVector input_types;
+    std::vector<PartialTensorShape> input_shapes;
+    if (!graph_utils::GetDatasetOutputTypesAttr(*input_node, &input_types)
+             .ok() ||
+        !GetNodeAttr(*input_node, kOutputShapesAttr, &input_shapes).ok() ||
+        input_types.size() != input_shapes.size()) {
+      continue;
+    }
+    bool fully_defined = true;
+    for (const PartialTensorShape& shape : input_shapes) {
+      fully_defined &= shape.IsFullyDefined();
+    }
+    if (!fully_defined) continue;
+
+    DataTypeVector captured_types;
+    DataTypeVector output_types;
+    std::vector<PartialTensorShape> batched_output_shapes;
+    TF_RETURN_IF_ERROR(GetNodeAttr(node, "Targuments", &captured_types));
+    TF_RETURN_IF_ERROR(GetNodeAttr(node, kOutputTypesAttr, &output_types));
+    TF_RETURN_IF_ERROR(
+        GetNodeAttr(node, kOutputShapesAttr, &batched_output_shapes));
+    std::vector<PartialTensorShape> output_shapes =
+        UnbatchShapes(batched_output_shapes);
+    if (output_shapes.empty() || output_shapes.size() != output_types.size()) {
+      continue;
+    }
+
+    const FunctionDef* vectorized_function = VectorizeFunction(
+        *function, input_types, input_shapes, captured_types, output_types,
+        output_shapes, output->mutable_library());
+    if (vectorized_function == nullptr) {
+      VLOG(1) << "Not vectorizing " << node.name()
+              << " because none of the outputs of its map function are "
+                 "computed by elementwise ops only.";
+      continue;
+    }
+
+    // The batch dimension is the same as the one of the fused node.
+    const int64_t batch_dim = batched_output_shapes[0].dim_size(0);
+    const int num_captured = captured_types.size();
+    auto* batch_node = graph.AddNode(MakeBatchNode(
+        node, input_types, input_shapes, batch_dim, num_captured, &graph));
+    auto* map_node = graph.AddNode(MakeMapNode(
+        node, *batch_node, *vectorized_function, num_captured, &graph));
+    TF_RETURN_IF_ERROR(graph.UpdateFanouts(node.name(), map_node->name()));
+
+    nodes_to_delete.insert(node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return absl::OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapVectorization, "map_vectorization");
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,55 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_VECTORIZATION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_VECTORIZATION_H_
+
+#include "tensorflow/core/grappler/optimizers/data/optimizer_base.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// This optimization rewrites `MapAndBatchDataset(input, f)` into
+// `ParallelMapDatasetV2(BatchDatasetV2(input), g)`, where `g` applies `f` to a
+// whole batch of stacked inputs in a single function invocation.
+//
+// Outputs of `f` that are computed by elementwise ops only are computed by `g`
+// directly on the batch. The remaining outputs, if any, are computed by a
+// `MapDefun` node in `g` that invokes (a pruned copy of) `f` once per element.
+// If none of the outputs of `f` can be vectorized, the node is left as is.
+class MapVectorization : public TFDataOptimizerBase {
+ public:
+  MapVectorization() = default;
+  ~MapVectorization() override = default;
+
+  std::string name() const override { return "map_vectorization"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  absl::Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return absl::OkStatus();
+  }
+
+  absl::Status OptimizeAndCollectStats(Cluster* cluster,
+                                       const GrapplerItem& item,
+                                       GraphDef* output,
+                                       OptimizationStats* stats) override;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_VECTORIZATION_H_
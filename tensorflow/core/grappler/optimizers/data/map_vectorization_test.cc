@@ -0,0 +1,207 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+using FDH = FunctionDefHelper;
+
+// Returns a function that computes `y = x * 2` and `z = ExpandDims(x, 0)`.
+// Only `y` is computed by elementwise ops.
+FunctionDef XTimesTwoAndExpandDims() {
+  const Tensor kTwo = test::AsScalar<int64_t>(2);
+  const Tensor kZero = test::AsScalar<int32>(0);
+  return FDH::Define(
+      // Name
+      "XTimesTwoAndExpandDims",
+      // Args
+      {"x: int64"},
+      // Return values
+      {"y: int64", "z: int64"},
+      // Attr def
+      {},
+      // Nodes
+      {
+          {{"two"}, "Const", {}, {{"value", kTwo}, {"dtype", DT_INT64}}},
+          {{"y"}, "Mul", {"x", "two"}, {{"T", DT_INT64}}},
+          {{"zero"}, "Const", {}, {{"value", kZero}, {"dtype", DT_INT32}}},
+          {{"z"},
+           "ExpandDims",
+           {"x", "zero"},
+           {{"T", DT_INT64}, {"Tdim", DT_INT32}}},
+      });
+}
+
+// Returns a function that computes `z = ExpandDims(x, 0)`.
+FunctionDef XExpandDims() {
+  const Tensor kZero = test::AsScalar<int32>(0);
+  return FDH::Define(
+      // Name
+      "XExpandDims",
+      // Args
+      {"x: int64"},
+      // Return values
+      {"z: int64"},
+      // Attr def
+      {},
+      // Nodes
+      {
+          {{"zero"}, "Const", {}, {{"value", kZero}, {"dtype", DT_INT32}}},
+          {{"z"},
+           "ExpandDims",
+           {"x", "zero"},
+           {{"T", DT_INT64}, {"Tdim", DT_INT32}}},
+      });
+}
+
+GrapplerItem MakeMapAndBatchItem(
+    const std::string& function_name,
+    const std::vector<PartialTensorShape>& input_shapes,
+    const std::vector<PartialTensorShape>& output_shapes) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT64}}),
+       NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT64}}),
+       NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT64}}),
+       NDef("range", "RangeDataset", {"start", "stop", "step"},
+            {{"output_shapes", input_shapes},
+             {"output_types", DataTypeVector{DT_INT64}}}),
+       NDef("batch_size", "Const", {}, {{"value", 4}, {"dtype", DT_INT64}}),
+       NDef("num_parallel_calls", "Const", {},
+            {{"value", 2}, {"dtype", DT_INT64}}),
+       NDef("drop_remainder", "Const", {},
+            {{"value", false}, {"dtype", DT_BOOL}}),
+       NDef("map_and_batch", "MapAndBatchDataset",
+            {"range", "batch_size", "num_parallel_calls", "drop_remainder"},
+            {{"f", FDH::FunctionRef(function_name)},
+             {"Targuments", DataTypeVector{}},
+             {"output_shapes", output_shapes},
+             {"output_types",
+              DataTypeVector(output_shapes.size(), DT_INT64)}}),
+       NDef("Sink", "Identity", {"map_and_batch"}, {})},
+      // FunctionLib
+      {
+          test::function::XTimesTwo(),
+          XTimesTwoAndExpandDims(),
+          XExpandDims(),
+      });
+  item.fetch.push_back("Sink");
+  return item;
+}
+
+TEST(MapVectorizationTest, VectorizesElementwiseFunction) {
+  GrapplerItem item = MakeMapAndBatchItem(
+      "XTimesTwo", {PartialTensorShape({})}, {PartialTensorShape({-1})});
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_FALSE(graph_utils::ContainsNodeWithOp("MapAndBatchDataset", output));
+  const NodeDef& batch_node = output.node(
+      graph_utils::FindGraphNodeWithOp("BatchDatasetV2", output));
+  EXPECT_EQ(batch_node.input(0), "range");
+  EXPECT_EQ(batch_node.input(1), "batch_size");
+  EXPECT_EQ(batch_node.input(2), "drop_remainder");
+  const NodeDef& map_node = output.node(
+      graph_utils::FindGraphNodeWithOp("ParallelMapDatasetV2", output));
+  EXPECT_EQ(map_node.input(0), batch_node.name());
+  EXPECT_EQ(map_node.input(1), "num_parallel_calls");
+  const NodeDef& sink_node =
+      output.node(graph_utils::FindGraphNodeWithName("Sink", output));
+  EXPECT_EQ(sink_node.input(0), map_node.name());
+
+  const std::string& function_name = map_node.attr().at("f").func().name();
+  const FunctionDef& function = output.library().function(
+      graph_utils::FindGraphFunctionWithName(function_name, output.library()));
+  EXPECT_EQ(function_name, "vectorized_XTimesTwo");
+  EXPECT_TRUE(function_utils::ContainsFunctionNodeWithOp("Mul", function));
+  EXPECT_FALSE(
+      function_utils::ContainsFunctionNodeWithOp("MapDefun", function));
+}
+
+TEST(MapVectorizationTest, FallsBackToMapDefunForOtherOutputs) {
+  GrapplerItem item = MakeMapAndBatchItem(
+      "XTimesTwoAndExpandDims", {PartialTensorShape({})},
+      {PartialTensorShape({-1}), PartialTensorShape({-1, 1})});
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_FALSE(graph_utils::ContainsNodeWithOp("MapAndBatchDataset", output));
+  const NodeDef& map_node = output.node(
+      graph_utils::FindGraphNodeWithOp("ParallelMapDatasetV2", output));
+  const FunctionDef& function =
+      output.library().function(graph_utils::FindGraphFunctionWithName(
+          map_node.attr().at("f").func().name(), output.library()));
+  EXPECT_TRUE(function_utils::ContainsFunctionNodeWithOp("Mul", function));
+  EXPECT_FALSE(
+      function_utils::ContainsFunctionNodeWithOp("ExpandDims", function));
+
+  const NodeDef& map_defun = function.node_def(
+      function_utils::FindFunctionNodeWithOp("MapDefun", function));
+  EXPECT_EQ(function.ret().at("y"), "y:z:0");
+  EXPECT_EQ(function.ret().at("z"),
+            absl::StrCat(map_defun.name(), ":output:0"));
+  const FunctionDef& per_element =
+      output.library().function(graph_utils::FindGraphFunctionWithName(
+          map_defun.attr().at("f").func().name(), output.library()));
+  ASSERT_EQ(per_element.signature().output_arg_size(), 1);
+  EXPECT_EQ(per_element.signature().output_arg(0).name(), "z");
+  std::vector<PartialTensorShape> shapes;
+  TF_ASSERT_OK(GetNodeAttr(map_defun, "output_shapes", &shapes));
+  ASSERT_EQ(shapes.size(), 1);
+  EXPECT_TRUE(shapes[0].IsIdenticalTo(PartialTensorShape({1})));
+}
+
+TEST(MapVectorizationTest, DoesNotVectorizeNonElementwiseFunction) {
+  GrapplerItem item = MakeMapAndBatchItem(
+      "XExpandDims", {PartialTensorShape({})}, {PartialTensorShape({-1, 1})});
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::Compare(item.graph, output));
+}
+
+TEST(MapVectorizationTest, DoesNotVectorizeInputsOfUnknownShape) {
+  GrapplerItem item = MakeMapAndBatchItem(
+      "XTimesTwo", {PartialTensorShape({-1})}, {PartialTensorShape({-1, -1})});
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::Compare(item.graph, output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
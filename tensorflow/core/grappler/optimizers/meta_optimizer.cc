@@ -68,6 +68,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/implementation_selector.h"
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/remapper.h"
@@ -1110,6 +1111,21 @@ absl::Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster,
       "Deleted $0 unreachable functions from the graph (library size = $1)",
       old_library_size - new_library_size, new_library_size);
 
+  // If the result cache is enabled, reuse the result of a previous
+  // optimization of an identical item.
+  std::shared_ptr<MetaOptimizerResultCache> result_cache =
+      MetaOptimizerResultCache::Global();
+  std::string result_cache_key;
+  if (result_cache != nullptr) {
+    result_cache_key =
+        MetaOptimizerResultCache::Fingerprint(item, config_proto_, cluster);
+    if (result_cache->Lookup(result_cache_key, optimized_graph)) {
+      VLOG(1) << "Reusing cached optimized graph for grappler item: "
+              << item.id;
+      return absl::OkStatus();
+    }
+  }
+
   // Save a few small fields from item before we move it.
   bool optimize_function_library =
       item.optimization_options().optimize_function_library;
@@ -1341,6 +1357,10 @@ absl::Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster,
         *optimized_graph);
   }
 
+  if (result_cache != nullptr) {
+    result_cache->Insert(result_cache_key, *optimized_graph);
+  }
+
   return absl::OkStatus();
 }
 
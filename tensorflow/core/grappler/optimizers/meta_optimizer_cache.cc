@@ -0,0 +1,288 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kFileSuffix[] = ".graphdef";
+
+// Accumulates the inputs of the fingerprint. Every field is length-prefixed,
+// so that different sequences of fields never produce the same bytes.
+class FingerprintBuilder {
+ public:
+  void Add(absl::string_view field) {
+    absl::StrAppend(&buffer_, field.size(), ":", field);
+  }
+
+  void Add(int64_t field) { Add(absl::StrCat(field)); }
+
+  void Add(const protobuf::MessageLite& message) {
+    std::string serialized;
+    SerializeToStringDeterministic(message, &serialized);
+    Add(serialized);
+  }
+
+  // Adds the elements of `fields` in sorted order.
+  template <typename Container>
+  void AddSorted(const Container& fields) {
+    std::vector<absl::string_view> sorted(fields.begin(), fields.end());
+    std::sort(sorted.begin(), sorted.end());
+    Add(static_cast<int64_t>(sorted.size()));
+    for (absl::string_view field : sorted) Add(field);
+  }
+
+  std::string Finish() const {
+    const Fprint128 fingerprint = Fingerprint128(buffer_);
+    return absl::StrFormat("%016x%016x", fingerprint.high64,
+                           fingerprint.low64);
+  }
+
+ private:
+  std::string buffer_;
+};
+
+mutex* global_cache_mu = new mutex;
+
+std::shared_ptr<MetaOptimizerResultCache>* GlobalCacheLocked()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(*global_cache_mu) {
+  static auto* cache = [] {
+    int64_t capacity_bytes;
+    absl::Status s = ReadInt64FromEnvVar(
+        "TF_GRAPPLER_RESULT_CACHE_CAPACITY_BYTES", 0, &capacity_bytes);
+    if (!s.ok()) {
+      LOG(WARNING) << "Disabling the Grappler result cache: " << s;
+      capacity_bytes = 0;
+    }
+    std::string directory;
+    s = ReadStringFromEnvVar("TF_GRAPPLER_RESULT_CACHE_DIR", "", &directory);
+    if (!s.ok()) {
+      LOG(WARNING) << "Disabling the on-disk Grappler result cache: " << s;
+      directory.clear();
+    }
+    return new std::shared_ptr<MetaOptimizerResultCache>(
+        capacity_bytes > 0 ? std::make_shared<MetaOptimizerResultCache>(
+                                 capacity_bytes, std::move(directory))
+                           : nullptr);
+  }();
+  return cache;
+}
+
+}  // namespace
+
+MetaOptimizerResultCache::MetaOptimizerResultCache(int64_t capacity_bytes,
+                                                   std::string directory,
+                                                   Env* env)
+    : capacity_bytes_(capacity_bytes),
+      directory_(std::move(directory)),
+      env_(env) {}
+
+std::shared_ptr<MetaOptimizerResultCache> MetaOptimizerResultCache::Global() {
+  mutex_lock l(*global_cache_mu);
+  return *GlobalCacheLocked();
+}
+
+void MetaOptimizerResultCache::ResetGlobal(int64_t capacity_bytes,
+                                           const std::string& directory) {
+  mutex_lock l(*global_cache_mu);
+  *GlobalCacheLocked() = capacity_bytes > 0
+                             ? std::make_shared<MetaOptimizerResultCache>(
+                                   capacity_bytes, directory)
+                             : nullptr;
+}
+
+std::string MetaOptimizerResultCache::Fingerprint(const GrapplerItem& item,
+                                                  const ConfigProto& config,
+                                                  const Cluster* cluster) {
+  FingerprintBuilder builder;
+  // The optimizers themselves are part of the key: results written by one
+  // build of TensorFlow are not reused by another.
+  builder.Add(TF_VERSION_STRING);
+  builder.Add(TF_GRAPH_DEF_VERSION);
+
+  builder.Add(item.graph);
+  builder.Add(static_cast<int64_t>(item.feed.size()));
+  for (const auto& feed : item.feed) {
+    builder.Add(feed.first);
+    TensorProto tensor;
+    feed.second.AsProtoTensorContent(&tensor);
+    builder.Add(tensor);
+  }
+  builder.AddSorted(item.fetch);
+  builder.AddSorted(item.init_ops);
+  builder.AddSorted(item.keep_ops);
+  builder.Add(item.save_op);
+  builder.Add(item.restore_op);
+  builder.Add(item.save_restore_loc_tensor);
+  builder.Add(static_cast<int64_t>(item.queue_runners.size()));
+  for (const QueueRunnerDef& queue_runner : item.queue_runners) {
+    builder.Add(queue_runner);
+  }
+  builder.AddSorted(item.devices());
+
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  builder.Add(options.allow_non_differentiable_rewrites);
+  builder.Add(options.allow_pruning_stateful_and_dataset_ops);
+  builder.Add(options.optimize_function_library);
+  builder.Add(options.is_eager_mode);
+  builder.Add(options.intra_op_parallelism_threads);
+
+  builder.Add(config);
+
+  if (cluster == nullptr) {
+    builder.Add(-1);
+  } else {
+    std::vector<std::string> device_names;
+    for (const auto& device : cluster->GetDevices()) {
+      device_names.push_back(device.first);
+    }
+    std::sort(device_names.begin(), device_names.end());
+    builder.Add(static_cast<int64_t>(device_names.size()));
+    for (const std::string& name : device_names) {
+      builder.Add(name);
+      builder.Add(cluster->GetDevices().at(name));
+    }
+  }
+  return builder.Finish();
+}
+
+std::string MetaOptimizerResultCache::FilePath(const std::string& key) const {
+  return io::JoinPath(directory_, absl::StrCat(key, kFileSuffix));
+}
+
+bool MetaOptimizerResultCache::Lookup(const std::string& key,
+                                      GraphDef* optimized_graph) {
+  std::shared_ptr<const GraphDef> cached;
+  {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second);
+      cached = it->second->graph;
+    }
+  }
+  if (cached != nullptr) {
+    // Copy outside of the lock, since the graph may be large.
+    *optimized_graph = *cached;
+    metrics::RecordGrapplerResultCacheLookup("memory_hit");
+    return true;
+  }
+
+  if (!directory_.empty()) {
+    const std::string path = FilePath(key);
+    if (env_->FileExists(path).ok()) {
+      auto graph = std::make_shared<GraphDef>();
+      absl::Status s = ReadBinaryProto(env_, path, graph.get());
+      if (s.ok()) {
+        *optimized_graph = *graph;
+        InsertInMemory(key, std::move(graph));
+        metrics::RecordGrapplerResultCacheLookup("disk_hit");
+        return true;
+      }
+      LOG(WARNING) << "Ignoring unreadable Grappler result cache entry "
+                   << path << ": " << s;
+    }
+  }
+
+  metrics::RecordGrapplerResultCacheLookup("miss");
+  return false;
+}
+
+void MetaOptimizerResultCache::Insert(const std::string& key,
+                                      const GraphDef& optimized_graph) {
+  auto graph = std::make_shared<const GraphDef>(optimized_graph);
+
+  if (!directory_.empty()) {
+    // Write to a temporary file first, so that concurrent readers (possibly
+    // in other processes) never observe a partially written entry.
+    const std::string path = FilePath(key);
+    std::string tmp_path = path;
+    absl::Status s = env_->RecursivelyCreateDir(directory_);
+    if (s.ok() && !env_->CreateUniqueFileName(&tmp_path, ".tmp")) {
+      s = absl::InternalError(
+          absl::StrCat("Could not create a temporary file name for ", path));
+    }
+    if (s.ok()) s = WriteBinaryProto(env_, tmp_path, *graph);
+    if (s.ok()) s = env_->RenameFile(tmp_path, path);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to write Grappler result cache entry " << path
+                   << ": " << s;
+      env_->DeleteFile(tmp_path).IgnoreError();
+    }
+  }
+
+  InsertInMemory(key, std::move(graph));
+}
+
+void MetaOptimizerResultCache::InsertInMemory(
+    const std::string& key, std::shared_ptr<const GraphDef> graph) {
+  const int64_t size_bytes = graph->ByteSizeLong();
+  // A graph that exceeds the budget on its own would evict every other entry
+  // and then be evicted itself.
+  if (size_bytes > capacity_bytes_) return;
+
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    size_bytes_ -= it->second->size_bytes;
+    lru_.erase(it->second);
+    entries_.erase(it);
+  }
+  lru_.push_front(Entry{key, std::move(graph), size_bytes});
+  entries_[key] = lru_.begin();
+  size_bytes_ += size_bytes;
+
+  while (size_bytes_ > capacity_bytes_) {
+    const Entry& victim = lru_.back();
+    VLOG(2) << "Evicting Grappler result cache entry " << victim.key;
+    size_bytes_ -= victim.size_bytes;
+    entries_.erase(victim.key);
+    lru_.pop_back();
+  }
+}
+
+void MetaOptimizerResultCache::Clear() {
+  mutex_lock l(mu_);
+  lru_.clear();
+  entries_.clear();
+  size_bytes_ = 0;
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
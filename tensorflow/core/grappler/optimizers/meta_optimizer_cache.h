@@ -0,0 +1,129 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Caches the graphs produced by the MetaOptimizer, keyed by a fingerprint of
+// everything the optimization depends on: the input graph and its function
+// library, the fetch, feed and preserved nodes, the available devices, the
+// optimization options of the item and the session ConfigProto (which holds
+// the RewriterConfig).
+//
+// Entries are kept in memory up to a byte budget and evicted in LRU order. If
+// a directory is given, every entry is also written to
+// `<directory>/<fingerprint>.graphdef`, and in-memory misses fall back to that
+// directory, so the cache survives process restarts and can be shared by
+// processes that run the same models.
+//
+// The process-wide cache used by the MetaOptimizer is disabled by default. It
+// is enabled by setting TF_GRAPPLER_RESULT_CACHE_CAPACITY_BYTES to a positive
+// value, and TF_GRAPPLER_RESULT_CACHE_DIR to enable the on-disk tier.
+class MetaOptimizerResultCache {
+ public:
+  // `env` is used to access `directory`. An empty `directory` disables the
+  // on-disk tier.
+  MetaOptimizerResultCache(int64_t capacity_bytes, std::string directory,
+                           Env* env = Env::Default());
+
+  // Returns the process-wide cache, or nullptr if it is disabled.
+  static std::shared_ptr<MetaOptimizerResultCache> Global();
+
+  // Replaces the process-wide cache with a new, empty one. A non-positive
+  // `capacity_bytes` disables the cache.
+  static void ResetGlobal(int64_t capacity_bytes, const std::string& directory);
+
+  // Returns the key under which the result of optimizing `item` with `config`
+  // on `cluster` (which may be null) is cached.
+  static std::string Fingerprint(const GrapplerItem& item,
+                                 const ConfigProto& config,
+                                 const Cluster* cluster);
+
+  // Returns true and copies the cached graph into `optimized_graph` if `key`
+  // is in the cache.
+  bool Lookup(const std::string& key, GraphDef* optimized_graph);
+
+  // Adds the result of an optimization to the cache.
+  void Insert(const std::string& key, const GraphDef& optimized_graph);
+
+  // Drops all in-memory entries. Entries on disk are kept.
+  void Clear();
+
+  int64_t capacity_bytes() const { return capacity_bytes_; }
+  const std::string& directory() const { return directory_; }
+
+  int64_t size_bytes() const {
+    tf_shared_lock l(mu_);
+    return size_bytes_;
+  }
+
+  int64_t num_entries() const {
+    tf_shared_lock l(mu_);
+    return entries_.size();
+  }
+
+ private:
+  struct Entry {
+    std::string key;
+    std::shared_ptr<const GraphDef> graph;
+    int64_t size_bytes;
+  };
+  using EntryList = std::list<Entry>;
+
+  std::string FilePath(const std::string& key) const;
+
+  // Adds `graph` to the in-memory cache and evicts the least recently used
+  // entries until the cache fits in its budget.
+  void InsertInMemory(const std::string& key,
+                      std::shared_ptr<const GraphDef> graph)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  const int64_t capacity_bytes_;
+  const std::string directory_;
+  Env* const env_;
+
+  mutable mutex mu_;
+  // Most recently used entries first.
+  EntryList lru_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, EntryList::iterator> entries_
+      TF_GUARDED_BY(mu_);
+  int64_t size_bytes_ TF_GUARDED_BY(mu_) = 0;
+
+  MetaOptimizerResultCache(const MetaOptimizerResultCache&) = delete;
+  void operator=(const MetaOptimizerResultCache&) = delete;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
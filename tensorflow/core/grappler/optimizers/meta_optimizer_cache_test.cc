@@ -0,0 +1,205 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kDevice[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+
+GrapplerItem MakeItem(int num_stages) {
+  TrivialTestGraphInputYielder fake_input(num_stages, 2, 10, false, {kDevice});
+  GrapplerItem item;
+  CHECK(fake_input.NextItem(&item));
+  return item;
+}
+
+std::string TestDir(const std::string& name) {
+  const std::string dir = io::JoinPath(testing::TmpDir(), name);
+  int64_t undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  return dir;
+}
+
+TEST(MetaOptimizerResultCacheTest, FingerprintCoversInputs) {
+  const GrapplerItem item = MakeItem(4);
+  ConfigProto config;
+  const std::string key =
+      MetaOptimizerResultCache::Fingerprint(item, config, nullptr);
+  EXPECT_EQ(key, MetaOptimizerResultCache::Fingerprint(MakeItem(4), config,
+                                                       nullptr));
+  EXPECT_NE(key, MetaOptimizerResultCache::Fingerprint(MakeItem(5), config,
+                                                       nullptr));
+
+  GrapplerItem other_fetch = item;
+  other_fetch.fetch.push_back("x");
+  EXPECT_NE(key, MetaOptimizerResultCache::Fingerprint(other_fetch, config,
+                                                       nullptr));
+
+  GrapplerItem other_options = item;
+  other_options.optimization_options().allow_pruning_stateful_and_dataset_ops =
+      !item.optimization_options().allow_pruning_stateful_and_dataset_ops;
+  EXPECT_NE(key, MetaOptimizerResultCache::Fingerprint(other_options, config,
+                                                       nullptr));
+
+  ConfigProto other_config;
+  other_config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_constant_folding(RewriterConfig::OFF);
+  EXPECT_NE(key,
+            MetaOptimizerResultCache::Fingerprint(item, other_config, nullptr));
+
+  DeviceProperties cpu;
+  cpu.set_type("CPU");
+  VirtualCluster cluster({{kDevice, cpu}});
+  const std::string cluster_key =
+      MetaOptimizerResultCache::Fingerprint(item, config, &cluster);
+  EXPECT_NE(key, cluster_key);
+  cpu.set_num_cores(64);
+  VirtualCluster bigger_cluster({{kDevice, cpu}});
+  EXPECT_NE(cluster_key, MetaOptimizerResultCache::Fingerprint(
+                             item, config, &bigger_cluster));
+}
+
+TEST(MetaOptimizerResultCacheTest, LookupReturnsInsertedGraph) {
+  MetaOptimizerResultCache cache(/*capacity_bytes=*/1 << 20,
+                                 /*directory=*/"");
+  const GrapplerItem item = MakeItem(4);
+  const int64_t misses = metrics::GetGrapplerResultCacheLookupCount("miss");
+  const int64_t hits = metrics::GetGrapplerResultCacheLookupCount("memory_hit");
+
+  GraphDef graph;
+  EXPECT_FALSE(cache.Lookup("key", &graph));
+  cache.Insert("key", item.graph);
+  ASSERT_TRUE(cache.Lookup("key", &graph));
+  EXPECT_EQ(item.graph.SerializeAsString(), graph.SerializeAsString());
+  EXPECT_EQ(1, cache.num_entries());
+  EXPECT_EQ(item.graph.ByteSizeLong(), cache.size_bytes());
+
+  EXPECT_EQ(misses + 1, metrics::GetGrapplerResultCacheLookupCount("miss"));
+  EXPECT_EQ(hits + 1, metrics::GetGrapplerResultCacheLookupCount("memory_hit"));
+
+  cache.Clear();
+  EXPECT_FALSE(cache.Lookup("key", &graph));
+  EXPECT_EQ(0, cache.size_bytes());
+}
+
+TEST(MetaOptimizerResultCacheTest, EvictsLeastRecentlyUsed) {
+  const GrapplerItem item = MakeItem(4);
+  const int64_t size = item.graph.ByteSizeLong();
+  MetaOptimizerResultCache cache(/*capacity_bytes=*/2 * size,
+                                 /*directory=*/"");
+  GraphDef graph;
+  cache.Insert("a", item.graph);
+  cache.Insert("b", item.graph);
+  // Makes "b" the least recently used entry.
+  EXPECT_TRUE(cache.Lookup("a", &graph));
+  cache.Insert("c", item.graph);
+
+  EXPECT_EQ(2, cache.num_entries());
+  EXPECT_EQ(2 * size, cache.size_bytes());
+  EXPECT_TRUE(cache.Lookup("a", &graph));
+  EXPECT_FALSE(cache.Lookup("b", &graph));
+  EXPECT_TRUE(cache.Lookup("c", &graph));
+
+  // Graphs larger than the whole budget are not cached.
+  MetaOptimizerResultCache small_cache(/*capacity_bytes=*/size - 1,
+                                       /*directory=*/"");
+  small_cache.Insert("a", item.graph);
+  EXPECT_EQ(0, small_cache.num_entries());
+}
+
+TEST(MetaOptimizerResultCacheTest, DiskEntriesSurviveTheCache) {
+  const std::string dir = TestDir("meta_optimizer_cache_disk");
+  const GrapplerItem item = MakeItem(4);
+  {
+    MetaOptimizerResultCache cache(/*capacity_bytes=*/1 << 20, dir);
+    cache.Insert("key", item.graph);
+  }
+
+  const int64_t disk_hits =
+      metrics::GetGrapplerResultCacheLookupCount("disk_hit");
+  const int64_t memory_hits =
+      metrics::GetGrapplerResultCacheLookupCount("memory_hit");
+  MetaOptimizerResultCache cache(/*capacity_bytes=*/1 << 20, dir);
+  GraphDef graph;
+  ASSERT_TRUE(cache.Lookup("key", &graph));
+  EXPECT_EQ(item.graph.SerializeAsString(), graph.SerializeAsString());
+  // The entry read from disk is now cached in memory.
+  ASSERT_TRUE(cache.Lookup("key", &graph));
+  EXPECT_EQ(disk_hits + 1,
+            metrics::GetGrapplerResultCacheLookupCount("disk_hit"));
+  EXPECT_EQ(memory_hits + 1,
+            metrics::GetGrapplerResultCacheLookupCount("memory_hit"));
+
+  // No temporary files are left behind.
+  std::vector<std::string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(dir, &children));
+  EXPECT_EQ(std::vector<std::string>({"key.graphdef"}), children);
+}
+
+TEST(MetaOptimizerResultCacheTest, IgnoresCorruptDiskEntries) {
+  const std::string dir = TestDir("meta_optimizer_cache_corrupt");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(dir));
+  TF_ASSERT_OK(WriteStringToFile(
+      Env::Default(), io::JoinPath(dir, "key.graphdef"), "not a graph"));
+
+  MetaOptimizerResultCache cache(/*capacity_bytes=*/1 << 20, dir);
+  GraphDef graph;
+  EXPECT_FALSE(cache.Lookup("key", &graph));
+
+  // A new result replaces the corrupt entry.
+  const GrapplerItem item = MakeItem(4);
+  cache.Insert("key", item.graph);
+  MetaOptimizerResultCache other_cache(/*capacity_bytes=*/1 << 20, dir);
+  ASSERT_TRUE(other_cache.Lookup("key", &graph));
+  EXPECT_EQ(item.graph.SerializeAsString(), graph.SerializeAsString());
+}
+
+TEST(MetaOptimizerResultCacheTest, ResetGlobal) {
+  MetaOptimizerResultCache::ResetGlobal(/*capacity_bytes=*/1 << 20,
+                                        /*directory=*/"");
+  ASSERT_NE(nullptr, MetaOptimizerResultCache::Global());
+  EXPECT_EQ(1 << 20, MetaOptimizerResultCache::Global()->capacity_bytes());
+  MetaOptimizerResultCache::ResetGlobal(/*capacity_bytes=*/0,
+                                        /*directory=*/"");
+  EXPECT_EQ(nullptr, MetaOptimizerResultCache::Global());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
 #include "tensorflow/core/grappler/optimizers/custom_graph_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -150,6 +151,42 @@ TEST_F(MetaOptimizerTest, RunsCustomOptimizer) {
   EXPECT_TRUE(TestOptimizer::IsOptimized());
 }
 
+TEST_F(MetaOptimizerTest, ReusesCachedResults) {
+  MetaOptimizerResultCache::ResetGlobal(/*capacity_bytes=*/1 << 20,
+                                        /*directory=*/"");
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("TestOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+
+  GraphDef output;
+  TestOptimizer::SetOptimized(false);
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, item, &output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+
+  GraphDef cached_output;
+  TestOptimizer::SetOptimized(false);
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, item, &cached_output));
+  EXPECT_FALSE(TestOptimizer::IsOptimized());
+  CompareGraphs(output, cached_output);
+
+  // A different configuration is optimized again.
+  rewriter_config.set_constant_folding(RewriterConfig::OFF);
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, item, &output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+
+  MetaOptimizerResultCache::ResetGlobal(/*capacity_bytes=*/0,
+                                        /*directory=*/"");
+}
+
 TEST_F(MetaOptimizerTest, RunsCustomOptimizerWithParams) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
   GrapplerItem item;
@@ -259,6 +259,16 @@ class BasicBatchScheduler : public BatchScheduler<TaskType> {
     // equal to `max_batch_size`.
     int max_execution_batch_size = 10;
 
+    // If true, a batch is closed early when waiting any longer would make its
+    // tightest member miss its deadline, and tasks whose deadline has passed
+    // are shed before they are processed. See the equally named option of
+    // SharedBatchScheduler::QueueOptions.
+    bool enable_deadline_aware_batching = false;
+
+    // The expected time (in microseconds) to process a batch. Used iff
+    // `enable_deadline_aware_batching` is true.
+    int64_t expected_batch_processing_time_micros = 0;
+
     // The following options are typically only overridden by test code.
 
     // The environment to use.
@@ -329,6 +339,10 @@ absl::Status BasicBatchScheduler<TaskType>::Create(
       options.split_input_task_func;
   shared_scheduler_queue_options.max_execution_batch_size =
       options.max_execution_batch_size;
+  shared_scheduler_queue_options.enable_deadline_aware_batching =
+      options.enable_deadline_aware_batching;
+  shared_scheduler_queue_options.expected_batch_processing_time_micros =
+      options.expected_batch_processing_time_micros;
   std::unique_ptr<BatchScheduler<TaskType>> shared_scheduler_queue;
   TF_RETURN_IF_ERROR(shared_scheduler->AddQueue(shared_scheduler_queue_options,
                                                 process_batch_callback,
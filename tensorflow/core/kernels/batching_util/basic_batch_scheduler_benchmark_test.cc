@@ -16,8 +16,12 @@ limitations under the License.
 // Benchmarks for performance (throughput and latency) of BasicBatchScheduler
 // under various rates of task injection.
 
+#include <atomic>
 #include <memory>
+#include <optional>
 
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/kernels/batching_util/basic_batch_scheduler.h"
 #include "tensorflow/core/lib/histogram/histogram.h"
 #include "tensorflow/core/platform/init_main.h"
@@ -92,6 +96,10 @@ class BenchmarkBatchTask : public BatchTask {
  public:
   BenchmarkBatchTask();
 
+  // Creates a task that must complete within `slo_micros` of its creation.
+  // `num_shed_tasks` is incremented if the scheduler sheds the task.
+  BenchmarkBatchTask(int64_t slo_micros, std::atomic<int64_t>* num_shed_tasks);
+
   BenchmarkBatchTask(const BenchmarkBatchTask&) = delete;
   BenchmarkBatchTask& operator=(const BenchmarkBatchTask&) = delete;
 
@@ -101,14 +109,35 @@ class BenchmarkBatchTask : public BatchTask {
 
   uint64_t start_time_micros() const { return start_time_micros_; }
 
+  std::optional<absl::Time> deadline() const override { return deadline_; }
+
+  bool IsDeadlineExceeded(absl::Time now) const override {
+    return deadline_.has_value() && now > *deadline_;
+  }
+
+ protected:
+  void FinishTaskImpl(const absl::Status& status) override {
+    // Only shed tasks are finished by the scheduler.
+    if (num_shed_tasks_ != nullptr) ++*num_shed_tasks_;
+  }
+
  private:
   // The time at which the task was created, in microseconds.
   const uint64_t start_time_micros_;
+
+  std::optional<absl::Time> deadline_;
+  std::atomic<int64_t>* const num_shed_tasks_ = nullptr;
 };
 
 BenchmarkBatchTask::BenchmarkBatchTask()
     : start_time_micros_(Env::Default()->NowMicros()) {}
 
+BenchmarkBatchTask::BenchmarkBatchTask(int64_t slo_micros,
+                                       std::atomic<int64_t>* num_shed_tasks)
+    : start_time_micros_(Env::Default()->NowMicros()),
+      deadline_(absl::FromUnixMicros(start_time_micros_ + slo_micros)),
+      num_shed_tasks_(num_shed_tasks) {}
+
 // The state associated with a throughput benchmark
 class ThroughputBenchmark {
  public:
@@ -287,6 +316,105 @@ std::string LatencyBenchmark::ReportLatencyBatchSz() {
       "ms,batchsz_p99=", batch_size_histogram_.Percentile(99));
 }
 
+// The state associated with a goodput benchmark, which injects tasks with a
+// mix of tight and loose deadlines into a batch scheduler at a controlled rate
+// and counts the tasks that complete before their deadline.
+class GoodputBenchmark {
+ public:
+  GoodputBenchmark(
+      const BasicBatchScheduler<BenchmarkBatchTask>::Options& scheduler_options,
+      int64_t task_injection_interval_micros,
+      int64_t batch_processing_time_micros);
+
+  GoodputBenchmark(const GoodputBenchmark&) = delete;
+  GoodputBenchmark& operator=(const GoodputBenchmark&) = delete;
+
+  // Inject tasks at specified rate for `latency_benchmark_duration_secs`.
+  void InjectLoad();
+
+  // Reset scheduler. This has a side-effect of waiting for all work to be
+  // completed prior to reset.
+  void ResetScheduler() { return scheduler_.reset(); }
+
+  // Return goodput and the breakdown of task outcomes.
+  std::string ReportGoodput() const;
+
+ private:
+  // Every other task gets the tight SLO; the rest get the loose one.
+  static constexpr int64_t kTightSloMicros = 5 * 1000;
+  static constexpr int64_t kLooseSloMicros = 50 * 1000;
+
+  // Processes a batch of tasks. (Invoked by 'scheduler_' on one of its batch
+  // threads.)
+  void ProcessBatch(std::unique_ptr<Batch<BenchmarkBatchTask>> batch);
+
+  // The time interval between successively injected tasks, in microseconds.
+  const int64_t task_injection_interval_micros_;
+
+  // The simulated (device) time to process one batch, independent of the
+  // number of tasks in the batch.
+  const int64_t batch_processing_time_micros_;
+
+  std::atomic<int64_t> num_tasks_on_time_{0};
+  std::atomic<int64_t> num_tasks_late_{0};
+  std::atomic<int64_t> num_tasks_shed_{0};
+
+  // The BasicBatchScheduler being benchmarked.
+  std::unique_ptr<BasicBatchScheduler<BenchmarkBatchTask>> scheduler_;
+};
+
+GoodputBenchmark::GoodputBenchmark(
+    const BasicBatchScheduler<BenchmarkBatchTask>::Options& scheduler_options,
+    int64_t task_injection_interval_micros,
+    int64_t batch_processing_time_micros)
+    : task_injection_interval_micros_(task_injection_interval_micros),
+      batch_processing_time_micros_(batch_processing_time_micros) {
+  auto process_batch_callback =
+      [this](std::unique_ptr<Batch<BenchmarkBatchTask>> batch) {
+        ProcessBatch(std::move(batch));
+      };
+  TF_CHECK_OK(BasicBatchScheduler<BenchmarkBatchTask>::Create(
+      scheduler_options, process_batch_callback, &scheduler_));
+}
+
+void GoodputBenchmark::InjectLoad() {
+  const int64_t kTimeDurationMicros =
+      latency_benchmark_duration_secs * 1000 * 1000;
+  const int kNumTasks = kTimeDurationMicros / task_injection_interval_micros_;
+  int num_injected = 0;
+  UniformLoadInjector injector;
+  injector.InjectLoad(
+      [this, &num_injected] {
+        const int64_t slo_micros =
+            (num_injected++ % 2 == 0) ? kTightSloMicros : kLooseSloMicros;
+        auto task =
+            std::make_unique<BenchmarkBatchTask>(slo_micros, &num_tasks_shed_);
+        TF_CHECK_OK(scheduler_->Schedule(&task));
+      },
+      kNumTasks, task_injection_interval_micros_);
+}
+
+void GoodputBenchmark::ProcessBatch(
+    std::unique_ptr<Batch<BenchmarkBatchTask>> batch) {
+  Env::Default()->SleepForMicroseconds(batch_processing_time_micros_);
+  const absl::Time batch_completion_time =
+      absl::FromUnixMicros(Env::Default()->NowMicros());
+  for (int i = 0; i < batch->num_tasks(); ++i) {
+    if (batch->task(i).IsDeadlineExceeded(batch_completion_time)) {
+      ++num_tasks_late_;
+    } else {
+      ++num_tasks_on_time_;
+    }
+  }
+}
+
+std::string GoodputBenchmark::ReportGoodput() const {
+  return absl::StrCat(
+      "goodput=", num_tasks_on_time_.load() / latency_benchmark_duration_secs,
+      "/s,on_time=", num_tasks_on_time_.load(),
+      ",late=", num_tasks_late_.load(), ",shed=", num_tasks_shed_.load());
+}
+
 // Injects a large number of tasks into a batch scheduler and measures
 // the total time to process all the tasks.
 //
@@ -382,6 +510,40 @@ BENCHMARK(LatencyBM)
     ->ArgNames({"timeout", "batch_threads", "qps"})
     ->ArgsProduct({{0, 2, 10}, {1, 4, 8, 16}, {50000, 20000, 1000}});
 
+// Goodput benchmark is a long running fixed interval (by time) benchmark that
+// is run once. Half of the tasks must complete within 5ms and the other half
+// within 50ms; batch processing takes 2ms. We report the rate of tasks that
+// complete on time, with and without deadline-aware batching.
+void GoodputBM(::testing::benchmark::State& state) {
+  BasicBatchScheduler<BenchmarkBatchTask>::Options scheduler_options;
+  const int kMaxBatchSize = 100;
+  const int64_t kBatchProcessingTimeMicros = 2 * 1000;
+  scheduler_options.max_batch_size = kMaxBatchSize;
+  scheduler_options.max_execution_batch_size = kMaxBatchSize;
+  scheduler_options.batch_timeout_micros = state.range(0) * 1000;
+  scheduler_options.num_batch_threads = 4;
+  scheduler_options.max_enqueued_batches = INT_MAX;  // Unbounded queue.
+  scheduler_options.enable_deadline_aware_batching = state.range(1) != 0;
+  scheduler_options.expected_batch_processing_time_micros =
+      kBatchProcessingTimeMicros;
+  const int64_t kQps = state.range(2);
+  auto bm = std::make_unique<GoodputBenchmark>(
+      scheduler_options, 1000000 / kQps, kBatchProcessingTimeMicros);
+
+  for (auto s : state) {
+    bm->InjectLoad();
+  }
+
+  // Wait for the scheduler to process all tasks.
+  bm->ResetScheduler();
+  state.SetLabel(bm->ReportGoodput());
+}
+BENCHMARK(GoodputBM)
+    ->UseRealTime()
+    ->Iterations(1)
+    ->ArgNames({"timeout", "deadline_aware", "qps"})
+    ->ArgsProduct({{2, 10}, {0, 1}, {1000, 20000}});
+
 }  // namespace
 }  // namespace serving
 }  // namespace tensorflow
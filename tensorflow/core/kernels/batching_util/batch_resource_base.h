@@ -136,6 +136,8 @@ class BatchResourceBase : public ResourceBase {
 
     bool is_subtask() const override { return is_partial; }
 
+    std::optional<absl::Time> deadline() const override { return rpc_deadline; }
+
     bool IsDeadlineExceeded(absl::Time now) const override;
 
     bool IsCancelled() const override;
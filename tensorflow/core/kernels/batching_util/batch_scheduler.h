@@ -108,6 +108,11 @@ class BatchTask {
 
   virtual bool is_subtask() const { return false; }
 
+  // Returns the absolute time by which the task must complete, if any.
+  // Schedulers may use it to close a batch before its tightest member would
+  // miss the deadline.
+  virtual std::optional<absl::Time> deadline() const { return std::nullopt; }
+
   // Returns true if the task's deadline has expired.
   // `now` is passed by the caller to amortize absl::Now() across iterations.
   virtual bool IsDeadlineExceeded(absl::Time now) const { return false; }
@@ -311,6 +311,22 @@ class SharedBatchScheduler
     MixedPriorityBatchingPolicy mixed_priority_batching_policy =
         MixedPriorityBatchingPolicy::kLowPriorityPaddingWithMaxBatchSize;
 
+    // If true, the open batch is also closed as soon as waiting any longer
+    // would make its tightest member miss its deadline (see
+    // BatchTask::deadline()), i.e. once
+    // `now + expected_batch_processing_time_micros` reaches the earliest
+    // deadline in the batch. In addition, tasks whose deadline has already
+    // passed when their batch is handed to a batch thread are finished with a
+    // DEADLINE_EXCEEDED error instead of being processed.
+    //
+    // Ignored when `enable_priority_aware_batch_scheduler` is true; see
+    // `PriorityAwareSchedulerOptions::enable_lazy_cancellation_filtering`.
+    bool enable_deadline_aware_batching = false;
+
+    // The expected time (in microseconds) to process a batch once it has been
+    // scheduled. Used iff `enable_deadline_aware_batching` is true.
+    int64_t expected_batch_processing_time_micros = 0;
+
     // If true, use priority aware scheduler.
     // This enables the scheduler to support multiple priority levels based on
     // request criticality, with higher-criticality tasks prioritized over
@@ -939,6 +955,20 @@ class Queue {
   // fresh open batch behind it.
   void StartNewBatch() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns the deadline of `task`, if `TaskType` exposes one.
+  static std::optional<absl::Time> TaskDeadline(const TaskType& task);
+
+  // Folds the deadline of `task`, which was just added to the open batch, into
+  // `open_batch_earliest_deadline_`.
+  void UpdateOpenBatchDeadline(const TaskType& task)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Finishes the tasks of the closed `batch` whose deadline has passed with a
+  // DEADLINE_EXCEEDED error, and returns a closed batch with the remaining
+  // tasks (possibly `batch` itself, possibly empty).
+  std::unique_ptr<Batch<TaskType>> ShedExpiredTasks(
+      std::unique_ptr<Batch<TaskType>> batch) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Split `input task` into `output_tasks` according to 'task_sizes'.
   absl::Status SplitInputBatchIntoSubtasks(
       std::unique_ptr<TaskType>* input_task,
@@ -1061,6 +1091,12 @@ class Queue {
   // might contain an approximate value.
   uint64_t open_batch_start_time_micros_ TF_GUARDED_BY(mu_);
 
+  // The earliest deadline of the tasks in the open (back-most) batch in
+  // 'high_priority_batches_', or nullopt if none of them has a deadline. Only
+  // maintained when `enable_deadline_aware_batching` is true, and only valid
+  // while that batch contains at least one task.
+  std::optional<absl::Time> open_batch_earliest_deadline_ TF_GUARDED_BY(mu_);
+
   // Whether this queue contains a batch that is eligible to be scheduled.
   // Used to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ TF_GUARDED_BY(mu_) = false;
@@ -1197,6 +1233,11 @@ absl::Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         "max_enqueued_batches must be positive; was ",
         options.max_enqueued_batches);
   }
+  if (options.expected_batch_processing_time_micros < 0) {
+    return errors::InvalidArgument(
+        "expected_batch_processing_time_micros must be non-negative; was ",
+        options.expected_batch_processing_time_micros);
+  }
 
   if (options.enable_large_batch_splitting &&
       options.split_input_task_func == nullptr) {
@@ -1541,7 +1582,9 @@ absl::Status Queue<TaskType>::ScheduleWithoutOrEagerSplitImpl(
     }
     if (batches.back()->empty()) {
       open_batch_start_time_micros_ = env_->NowMicros();
+      open_batch_earliest_deadline_ = std::nullopt;
     }
+    UpdateOpenBatchDeadline(*output_tasks[i]);
     tsl::profiler::TraceMeProducer trace_me(
         [&output_tasks, i] {
           return profiler::TraceMeEncode("ScheduleOutputTask",
@@ -1611,10 +1654,12 @@ void Queue<TaskType>::PadOpenBatchWithLowPriorityTasks() {
 
       if (batches.back()->empty()) {
         open_batch_start_time_micros_ = task_time;
+        open_batch_earliest_deadline_ = std::nullopt;
       } else {
         open_batch_start_time_micros_ =
             std::min(open_batch_start_time_micros_, task_time);
       }
+      UpdateOpenBatchDeadline(*output_tasks[i]);
 
       tsl::profiler::TraceMeProducer trace_me(
           [&output_tasks, i] {
@@ -1871,7 +1916,9 @@ Queue<TaskType>::ScheduleBatch() {
 
           // Move the trimmed tasks, if any, into the new batch.
           Batch<TaskType>& new_batch = *batches[1];
+          open_batch_earliest_deadline_ = std::nullopt;
           for (std::unique_ptr<TaskType>& task : trimmed_tasks) {
+            UpdateOpenBatchDeadline(*task);
             new_batch.AddTask(std::move(task), old_batch_time);
           }
           if (!new_batch.empty()) {
@@ -1898,10 +1945,17 @@ Queue<TaskType>::ScheduleBatch() {
         }
       }
 
-      if (batches.size() >= 2) {
+      while (batch_to_schedule == nullptr && batches.size() >= 2) {
         // There is at least one closed batch that is ready to be scheduled.
         batch_to_schedule = std::move(batches.front());
         batches.pop_front();
+        if (options_.enable_deadline_aware_batching) {
+          batch_to_schedule = ShedExpiredTasks(std::move(batch_to_schedule));
+          if (batch_to_schedule->empty()) {
+            // Every task in the batch expired; move on to the next one.
+            batch_to_schedule = nullptr;
+          }
+        }
       }
 
       if (batch_to_schedule == nullptr) {
@@ -2035,6 +2089,57 @@ void Queue<TaskType>::StartNewBatch() {
   batches.emplace_back(new Batch<TaskType>(++traceme_context_id_counter_));
 }
 
+template <typename TaskType>
+std::optional<absl::Time> Queue<TaskType>::TaskDeadline(const TaskType& task) {
+  if constexpr (std::is_base_of_v<BatchTask, TaskType>) {
+    return task.deadline();
+  }
+  return std::nullopt;
+}
+
+template <typename TaskType>
+void Queue<TaskType>::UpdateOpenBatchDeadline(const TaskType& task) {
+  if (!options_.enable_deadline_aware_batching) return;
+  std::optional<absl::Time> deadline = TaskDeadline(task);
+  if (!deadline.has_value()) return;
+  if (!open_batch_earliest_deadline_.has_value() ||
+      *deadline < *open_batch_earliest_deadline_) {
+    open_batch_earliest_deadline_ = deadline;
+  }
+}
+
+template <typename TaskType>
+std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ShedExpiredTasks(
+    std::unique_ptr<Batch<TaskType>> batch) {
+  if constexpr (std::is_base_of_v<BatchTask, TaskType>) {
+    const absl::Time now = absl::FromUnixMicros(env_->NowMicros());
+    bool has_expired_task = false;
+    for (int i = 0; i < batch->num_tasks() && !has_expired_task; ++i) {
+      has_expired_task = batch->task(i).IsDeadlineExceeded(now);
+    }
+    if (!has_expired_task) {
+      return batch;
+    }
+
+    const uint64_t start_time_micros = batch->EarliestTaskStartTime().value();
+    auto live_batch =
+        std::make_unique<Batch<TaskType>>(batch->traceme_context_id());
+    for (std::unique_ptr<TaskType>& task : batch->RemoveAllTasks()) {
+      if (task->IsDeadlineExceeded(now)) {
+        RecordLazyCancelledTaskMetrics(task->size(),
+                                       kLazyCancellationReasonDeadlineExceeded);
+        task->FinishTask(absl::DeadlineExceededError(
+            "Task cancelled: RPC deadline exceeded."));
+      } else {
+        live_batch->AddTask(std::move(task), start_time_micros);
+      }
+    }
+    live_batch->Close();
+    return live_batch;
+  }
+  return batch;
+}
+
 template <typename TaskType>
 absl::Status Queue<TaskType>::SplitInputBatchIntoSubtasks(
     std::unique_ptr<TaskType>* input_task,
@@ -2127,6 +2232,17 @@ Queue<TaskType>::PeekBatchPriorityImpl() const {
                      env_->NowMicros() >= effective_start_time_micros +
                                               effective_batch_timeout_micros;
 
+  if (!schedulable && options_.enable_deadline_aware_batching &&
+      !open_batch->empty() && open_batch_earliest_deadline_.has_value()) {
+    // Close the batch early if waiting any longer would make its tightest
+    // member miss its deadline.
+    const absl::Duration expected_processing_time =
+        absl::Microseconds(options_.expected_batch_processing_time_micros);
+    schedulable = absl::FromUnixMicros(env_->NowMicros()) +
+                      expected_processing_time >=
+                  *open_batch_earliest_deadline_;
+  }
+
   if (!schedulable) {
     return std::nullopt;
   }
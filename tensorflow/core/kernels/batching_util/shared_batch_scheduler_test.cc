@@ -92,6 +92,8 @@ class FakeTask : public BatchTask {
   bool is_warmup() const override { return is_warmup_; }
   void set_is_warmup(bool is_warmup) { is_warmup_ = is_warmup; }
 
+  std::optional<absl::Time> deadline() const override { return deadline_; }
+
   bool IsDeadlineExceeded(absl::Time now) const override {
     return deadline_.has_value() && now > *deadline_;
   }
@@ -1196,6 +1198,144 @@ TEST_P(SharedBatchSchedulerTest, BatchPaddingPolicyBatchDown) {
   stop_teardown.Notify();
 }
 
+TEST_P(SharedBatchSchedulerTest, DeadlineAwareBatchingClosesBatchEarly) {
+  // Set up a fake clock, which only advances when we explicitly tell it to.
+  test_util::FakeClockEnv env(Env::Default());
+  absl::Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    absl::Notification batch_processed;
+    auto callback = [&batch_processed](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      EXPECT_EQ(2, batch->num_tasks());
+      batch_processed.Notify();
+    };
+
+    TF_ASSERT_OK_AND_ASSIGN(
+        std::shared_ptr<Scheduler> scheduler,
+        CreateSharedBatchScheduler(/*num_batch_threads=*/1, &env));
+
+    QueueOptions options = CreateQueueOptions(
+        /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+        /*batch_timeout_micros=*/1000 * 1000, /*max_enqueued_batches=*/2);
+    options.enable_deadline_aware_batching = true;
+    options.expected_batch_processing_time_micros = 100;
+    TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Queue> queue,
+                            CreateQueue(scheduler, options, callback));
+
+    // The batch holds one task without a deadline and one that must complete
+    // 1000us from now, so it has to be closed 900us from now even though the
+    // batch timeout is much longer.
+    TF_ASSERT_OK(ScheduleTask(/*task_size=*/1, queue.get()));
+    auto task = std::make_unique<FakeTask>(1);
+    task->set_deadline(absl::FromUnixMicros(env.NowMicros() + 1000));
+    TF_ASSERT_OK(queue->Schedule(&task));
+
+    env.AdvanceByMicroseconds(899);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(batch_processed.HasBeenNotified());
+    env.AdvanceByMicroseconds(1);
+    batch_processed.WaitForNotification();
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST_P(SharedBatchSchedulerTest, DeadlineAwareBatchingShedsExpiredTasks) {
+  absl::Notification block_thread, thread_blocked;
+  absl::Notification live_batch_processed;
+  const int kBlockerTaskSize = 10;
+  const int kExpiredTaskSize = 3;
+  const int kLiveTaskSize = 5;
+
+  auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+    EXPECT_TRUE(batch->IsClosed());
+    if (batch->size() == kBlockerTaskSize) {
+      thread_blocked.Notify();
+      block_thread.WaitForNotification();
+      return;
+    }
+    // Expired tasks are shed; batches without live tasks are never processed.
+    ASSERT_EQ(1, batch->num_tasks());
+    EXPECT_EQ(kLiveTaskSize, batch->task(0).size());
+    live_batch_processed.Notify();
+  };
+
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Scheduler> scheduler,
+                          CreateSharedBatchScheduler(/*num_batch_threads=*/1));
+
+  QueueOptions options = CreateQueueOptions(
+      /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+      /*batch_timeout_micros=*/1000 * 1000, /*max_enqueued_batches=*/10);
+  options.enable_deadline_aware_batching = true;
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Queue> queue,
+                          CreateQueue(scheduler, options, callback));
+
+  CellReader<int64_t> cancelled_task_count_reader(
+      "/tensorflow/serving/batching/lazy_cancelled_task_count");
+  CellReader<int64_t> cancelled_task_size_reader(
+      "/tensorflow/serving/batching/lazy_cancelled_task_size");
+
+  // Occupy the only batch thread.
+  TF_ASSERT_OK(ScheduleTask(kBlockerTaskSize, queue.get()));
+  thread_blocked.WaitForNotification();
+
+  // Form a batch of an expired task and a live one.
+  auto done_notification = std::make_shared<absl::Notification>();
+  auto status = std::make_shared<absl::Status>();
+  auto expired_task = std::make_unique<FakeTask>(
+      kExpiredTaskSize, tsl::criticality::Criticality::kCritical,
+      done_notification, status);
+  expired_task->set_deadline(absl::Now() - absl::Seconds(1));
+  TF_ASSERT_OK(queue->Schedule(&expired_task));
+  auto live_task = std::make_unique<FakeTask>(kLiveTaskSize);
+  live_task->set_deadline(absl::Now() + absl::Hours(1));
+  TF_ASSERT_OK(queue->Schedule(&live_task));
+
+  block_thread.Notify();
+  live_batch_processed.WaitForNotification();
+
+  done_notification->WaitForNotification();
+  EXPECT_THAT(*status,
+              absl_testing::StatusIs(absl::StatusCode::kDeadlineExceeded,
+                                     HasSubstr("RPC deadline exceeded")));
+  EXPECT_EQ(cancelled_task_count_reader.Delta(
+                std::string(kLazyCancellationReasonDeadlineExceeded)),
+            1);
+  EXPECT_EQ(cancelled_task_size_reader.Delta(
+                std::string(kLazyCancellationReasonDeadlineExceeded)),
+            kExpiredTaskSize);
+
+  // A batch whose tasks have all expired is dropped without being processed.
+  done_notification = std::make_shared<absl::Notification>();
+  expired_task = std::make_unique<FakeTask>(
+      kExpiredTaskSize, tsl::criticality::Criticality::kCritical,
+      done_notification, status);
+  expired_task->set_deadline(absl::Now() - absl::Seconds(1));
+  TF_ASSERT_OK(queue->Schedule(&expired_task));
+  done_notification->WaitForNotification();
+  EXPECT_THAT(*status,
+              absl_testing::StatusIs(absl::StatusCode::kDeadlineExceeded));
+}
+
+TEST_P(SharedBatchSchedulerTest, DeadlineAwareBatchingInvalidOptions) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {};
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Scheduler> scheduler,
+                          CreateSharedBatchScheduler(/*num_batch_threads=*/1));
+  QueueOptions options = CreateQueueOptions(
+      /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+      /*batch_timeout_micros=*/0, /*max_enqueued_batches=*/1);
+  options.enable_deadline_aware_batching = true;
+  options.expected_batch_processing_time_micros = -1;
+  EXPECT_THAT(CreateQueue(scheduler, options, callback),
+              absl_testing::StatusIs(
+                  absl::StatusCode::kInvalidArgument,
+                  HasSubstr("expected_batch_processing_time_micros")));
+}
+
 // TODO(b/161857471):
 // Add test coverage when input-split and no-split returns differently.
 INSTANTIATE_TEST_SUITE_P(Parameter, SharedBatchSchedulerTest,
@@ -25,6 +25,8 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/columnar_element_buffer.h"
 #include "tensorflow/core/data/global_shuffle_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
@@ -78,6 +80,19 @@ constexpr char kIncompleteCacheErrorMessage[] =
     "contents of the dataset  will be discarded. This can happen if you have "
     "an input pipeline similar to `dataset.cache().take(k).repeat()`. You "
     "should use `dataset.take(k).cache().repeat()` instead.";
+
+// Reads elements written by `WriteElementsToCheckpoint()` into `*elements`.
+absl::Status ReadColumnarElementsFromCheckpoint(
+    IteratorContext* ctx, IteratorStateReader* reader,
+    absl::string_view key_prefix, ColumnarElementBuffer* elements) {
+  std::vector<std::vector<Tensor>> temp_elements;
+  TF_RETURN_IF_ERROR(
+      ReadElementsFromCheckpoint(ctx, reader, key_prefix, &temp_elements));
+  for (const std::vector<Tensor>& element : temp_elements) {
+    TF_RETURN_IF_ERROR(elements->Append(element));
+  }
+  return absl::OkStatus();
+}
 }  // namespace
 
 class DatasetRandomAccessCache {
@@ -910,9 +925,9 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       iterator_.reset();
       cache_->Reset();
       if (reader->Contains(prefix(), kCacheCompleted)) {
-        std::vector<std::vector<Tensor>> temp_cache;
-        TF_RETURN_IF_ERROR(
-            ReadElementsFromCheckpoint(ctx, reader, prefix(), &temp_cache));
+        ColumnarElementBuffer temp_cache;
+        TF_RETURN_IF_ERROR(ReadColumnarElementsFromCheckpoint(
+            ctx, reader, prefix(), &temp_cache));
         cache_->Complete(std::move(temp_cache));
       }
       TF_RETURN_IF_ERROR(InitializeIterator(ctx));
@@ -952,7 +967,7 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
           return absl::OkStatus();
         }
         RecordBufferEnqueue(ctx, *out_tensors);
-        temp_cache_.emplace_back(*out_tensors);
+        TF_RETURN_IF_ERROR(temp_cache_.Append(*out_tensors));
         if (temp_cache_.size() == dataset()->input_->Cardinality()) {
           VLOG(2) << "Finalizing the cache because its size matches the "
                      "expected input cardinality.";
@@ -972,8 +987,8 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                                 IteratorStateWriter* writer) override {
         mutex_lock l(mu_);
         if (!cache_->IsCompleted()) {
-          TF_RETURN_IF_ERROR(
-              WriteElementsToCheckpoint(writer, prefix(), temp_cache_));
+          TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(writer, prefix(),
+                                                       temp_cache_.GetAll()));
         }
         return SaveInput(ctx, writer, input_impl_);
       }
@@ -982,8 +997,9 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                                    IteratorStateReader* reader) override {
         mutex_lock l(mu_);
         if (!reader->Contains(prefix(), kCacheCompleted)) {
-          TF_RETURN_IF_ERROR(
-              ReadElementsFromCheckpoint(ctx, reader, prefix(), &temp_cache_));
+          temp_cache_.Clear();
+          TF_RETURN_IF_ERROR(ReadColumnarElementsFromCheckpoint(
+              ctx, reader, prefix(), &temp_cache_));
         }
         return RestoreInput(ctx, reader, input_impl_);
       }
@@ -992,7 +1008,7 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       mutex mu_;
       std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
       MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
-      std::vector<std::vector<Tensor>> temp_cache_ TF_GUARDED_BY(mu_);
+      ColumnarElementBuffer temp_cache_ TF_GUARDED_BY(mu_);
     };  // MemoryWriterIterator
 
     class MemoryReaderIterator : public DatasetIterator<MemoryDatasetBase> {
@@ -1009,9 +1025,7 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         // is that this is incorrect if there are concurrent instances of this
         // iterator.
         tf_shared_lock l(mu_);
-        for (size_t i = 0; i < cache_->size(); ++i) {
-          RecordBufferEnqueue(ctx, cache_->at(i));
-        }
+        RecordBufferEnqueue(ctx, cache_->StorageTensors());
         return absl::OkStatus();
       }
 
@@ -1020,9 +1034,7 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                                    bool* end_of_sequence) override {
         mutex_lock l(mu_);
         if (index_ < cache_->size()) {
-          const std::vector<Tensor>& cache_tensors = cache_->at(index_);
-          out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
-                              cache_tensors.end());
+          cache_->Get(index_, out_tensors);
           index_++;
           *end_of_sequence = false;
           return absl::OkStatus();
@@ -42,10 +42,11 @@ constexpr char kMemoryCache[] = "MemoryCache";
 
 std::string MemoryCacheManager::DebugString() const { return kMemoryCache; }
 
-void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache) {
+void MemoryCache::Complete(ColumnarElementBuffer&& cache) {
   mutex_lock l(mu_);
   if (!completed_) {
     cache_ = std::move(cache);
+    cache_.Shrink();
     completed_ = true;
   }
 }
@@ -58,13 +59,13 @@ bool MemoryCache::IsCompleted() {
 void MemoryCache::Reset() {
   mutex_lock l(mu_);
   completed_ = false;
-  cache_.clear();
+  cache_.Clear();
 }
 
-const std::vector<Tensor>& MemoryCache::at(int64_t index) {
+void MemoryCache::Get(int64_t index, std::vector<Tensor>* out) {
   tf_shared_lock l(mu_);
   DCHECK(index < cache_.size());
-  return cache_[index];
+  cache_.Get(index, out);
 }
 
 size_t MemoryCache::size() {
@@ -72,9 +73,14 @@ size_t MemoryCache::size() {
   return cache_.size();
 }
 
-const std::vector<std::vector<Tensor>>& MemoryCache::data() {
+std::vector<std::vector<Tensor>> MemoryCache::data() {
   tf_shared_lock l(mu_);
-  return cache_;
+  return cache_.GetAll();
+}
+
+std::vector<Tensor> MemoryCache::StorageTensors() {
+  tf_shared_lock l(mu_);
+  return cache_.StorageTensors();
 }
 
 AnonymousMemoryCacheHandleOp::AnonymousMemoryCacheHandleOp(
@@ -16,7 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 
+#include <cstdint>
+#include <vector>
+
 #include "absl/status/status.h"
+#include "tensorflow/core/data/columnar_element_buffer.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 
@@ -28,12 +32,15 @@ namespace data {
 // The expected use is that a single `MemoryWriterIterator` populates the
 // cache with dataset elements. Once all elements are cached, the cache can
 // be used by one or more `MemoryReaderIterator`s.
+//
+// The elements are stored in a `ColumnarElementBuffer`, which packs small
+// components of the same shape into large tensors.
 class MemoryCache {
  public:
   MemoryCache() = default;
 
   // Marks the cache as completed.
-  void Complete(std::vector<std::vector<Tensor>>&& cache);
+  void Complete(ColumnarElementBuffer&& cache);
 
   // Returns whether the cache is completed.
   bool IsCompleted();
@@ -41,21 +48,23 @@ class MemoryCache {
   // Resets the cache.
   void Reset();
 
-  // Returns the element at the given index.
-  const std::vector<Tensor>& at(int64_t index);
+  // Appends the components of the element at the given index to `*out`.
+  void Get(int64_t index, std::vector<Tensor>* out);
 
   // Returns the size of the cache.
   size_t size();
 
-  // Returns a reference to the cache's data. The returned reference will be
-  // invalidated by any call to Reset().
-  const std::vector<std::vector<Tensor>>& data();
+  // Returns all the cached elements.
+  std::vector<std::vector<Tensor>> data();
+
+  // Returns the tensors that hold the cached elements.
+  std::vector<Tensor> StorageTensors();
 
  private:
   mutex mu_;
   // Determines whether all elements of the dataset have been cached.
   bool completed_ TF_GUARDED_BY(mu_) = false;
-  std::vector<std::vector<Tensor>> cache_ TF_GUARDED_BY(mu_);
+  ColumnarElementBuffer cache_ TF_GUARDED_BY(mu_);
 };
 
 // A resource wrapping a shared instance of a memory cache.
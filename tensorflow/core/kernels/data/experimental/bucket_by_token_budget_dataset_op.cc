@@ -0,0 +1,731 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/bucket_by_token_budget_dataset_op.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/kernels/ragged_tensor_variant.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kInputDataset;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kBucketBoundaries;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kMaxTokens;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kMaxBatchSize;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kPaddingValues;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kDropRemainder;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kLengthComponent;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kRaggedOutput;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kTpaddingValues;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kOutputShapes;
+
+namespace {
+
+constexpr char kInputExhausted[] = "input_exhausted";
+constexpr char kNumBuckets[] = "num_buckets";
+constexpr char kBucketSize[] = "bucket_size";
+constexpr char kBucketElement[] = "bucket_element";
+
+// Returns whether the elements of a component with static shape `shape` are
+// batched as ragged rows, i.e. when their first dimension varies.
+bool IsRaggedComponent(const PartialTensorShape& shape) {
+  return shape.dims() > 0 && shape.dim_size(0) < 0;
+}
+
+// Returns whether `element` only differs from `row_shape` in the size of its
+// first dimension, so that it is stored as a prefix of its padded row.
+bool IsRowPrefix(const TensorShape& element, const TensorShape& row_shape) {
+  for (int d = 1; d < element.dims(); ++d) {
+    if (element.dim_size(d) != row_shape.dim_size(d)) return false;
+  }
+  return true;
+}
+
+// Writes `element`, padded with `padding` to `row_shape`, to row `index` of
+// `batch`. Each value of the row is written once.
+template <typename T>
+void CopyPaddedRow(const Tensor& element, const T& padding,
+                   const TensorShape& row_shape, int64_t index, Tensor* batch) {
+  const int64_t row_size = row_shape.num_elements();
+  T* row = static_cast<T*>(batch->data()) + index * row_size;
+  const T* values = static_cast<const T*>(element.data());
+  const int64_t num_values = element.NumElements();
+  if (IsRowPrefix(element.shape(), row_shape)) {
+    std::copy_n(values, num_values, row);
+    std::fill_n(row + num_values, row_size - num_values, padding);
+    return;
+  }
+  // Copies the innermost runs of values one at a time, and pads the gaps
+  // between them.
+  const int rank = element.dims();
+  const int64_t run_size = element.dim_size(rank - 1);
+  std::vector<int64_t> row_strides(rank, 1);
+  for (int d = rank - 2; d >= 0; --d) {
+    row_strides[d] = row_strides[d + 1] * row_shape.dim_size(d + 1);
+  }
+  std::vector<int64_t> position(rank, 0);
+  int64_t row_offset = 0;
+  for (int64_t offset = 0; offset < num_values; offset += run_size) {
+    int64_t run_offset = 0;
+    for (int d = 0; d < rank - 1; ++d) {
+      run_offset += position[d] * row_strides[d];
+    }
+    std::fill(row + row_offset, row + run_offset, padding);
+    std::copy_n(values + offset, run_size, row + run_offset);
+    row_offset = run_offset + run_size;
+    for (int d = rank - 2; d >= 0; --d) {
+      if (++position[d] < element.dim_size(d)) break;
+      position[d] = 0;
+    }
+  }
+  std::fill(row + row_offset, row + row_size, padding);
+}
+
+// Copies the values of `element` to `values`, starting at value `offset`.
+template <typename T>
+void CopyRaggedRows(const Tensor& element, int64_t offset, Tensor* values) {
+  std::copy_n(static_cast<const T*>(element.data()), element.NumElements(),
+              static_cast<T*>(values->data()) + offset);
+}
+
+}  // namespace
+
+class BucketByTokenBudgetDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input,
+          std::vector<int64_t> bucket_boundaries, int64_t max_tokens,
+          int64_t max_batch_size, std::vector<Tensor> padding_values,
+          bool drop_remainder, int64_t length_component, bool ragged_output,
+          const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        bucket_boundaries_(std::move(bucket_boundaries)),
+        max_tokens_(max_tokens),
+        max_batch_size_(max_batch_size),
+        padding_values_(std::move(padding_values)),
+        drop_remainder_(drop_remainder),
+        length_component_(length_component),
+        ragged_output_(ragged_output),
+        output_types_(output_types),
+        output_shapes_(output_shapes),
+        traceme_metadata_(
+            {{"max_tokens",
+              absl::StrFormat("%lld", static_cast<long long>(max_tokens))},
+             {"num_buckets", absl::StrFormat("%lld", static_cast<long long>(
+                                                         num_buckets()))},
+             {"ragged_output", ragged_output ? "true" : "false"}}) {
+    input_->Ref();
+    for (const PartialTensorShape& shape : input_->output_shapes()) {
+      ragged_components_.push_back(ragged_output_ && IsRaggedComponent(shape));
+    }
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const std::string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return output_types_;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  std::string DebugString() const override {
+    name_utils::DatasetDebugStringParams params;
+    params.set_args(max_tokens_);
+    return name_utils::DatasetDebugString(kDatasetType, params);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    int64_t n = input_->Cardinality(options);
+    if (n == kInfiniteCardinality) {
+      return n;
+    }
+    return kUnknownCardinality;
+  }
+
+  absl::Status InputDatasets(
+      std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return absl::OkStatus();
+  }
+
+  absl::Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  absl::Status AsGraphDefInternal(SerializationContext* ctx,
+                                  DatasetGraphDefBuilder* b,
+                                  Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* bucket_boundaries = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(bucket_boundaries_, &bucket_boundaries));
+    Node* max_tokens = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(max_tokens_, &max_tokens));
+    Node* max_batch_size = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(max_batch_size_, &max_batch_size));
+    std::vector<Node*> padding_values;
+    padding_values.reserve(padding_values_.size());
+    for (const Tensor& t : padding_values_) {
+      Node* node;
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padding_values.push_back(node);
+    }
+    Node* drop_remainder = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(drop_remainder_, &drop_remainder));
+
+    AttrValue length_component;
+    b->BuildAttrValue(length_component_, &length_component);
+    AttrValue ragged_output;
+    b->BuildAttrValue(ragged_output_, &ragged_output);
+    AttrValue padding_types;
+    b->BuildAttrValue(input_->output_dtypes(), &padding_types);
+
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this,
+        {{0, input_graph_node},
+         {1, bucket_boundaries},
+         {2, max_tokens},
+         {3, max_batch_size},
+         {5, drop_remainder}},
+        {{4, padding_values}},
+        {{kLengthComponent, length_component},
+         {kRaggedOutput, ragged_output},
+         {kTpaddingValues, padding_types}},
+        output));
+    return absl::OkStatus();
+  }
+
+ private:
+  // The elements of a batch in the making.
+  struct Bucket {
+    void Add(std::vector<Tensor> element, int64_t length) {
+      elements.push_back(std::move(element));
+      max_length = std::max(max_length, length);
+      total_length += length;
+    }
+
+    std::vector<std::vector<Tensor>> elements;
+    int64_t max_length = 0;
+    int64_t total_length = 0;
+  };
+
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          buckets_(params.dataset->num_buckets()) {}
+
+    absl::Status Initialize(IteratorContext* ctx) override {
+      return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
+    }
+
+    absl::Status GetNextInternal(IteratorContext* ctx,
+                                 std::vector<Tensor>* out_tensors,
+                                 bool* end_of_sequence) override {
+      std::vector<std::vector<Tensor>> batch;
+      {
+        mutex_lock l(mu_);
+        while (input_impl_ && batch.empty()) {
+          std::vector<Tensor> element;
+          bool end_of_input = false;
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, &element, &end_of_input));
+          if (end_of_input) {
+            input_impl_.reset();
+            break;
+          }
+          int64_t length;
+          TF_RETURN_IF_ERROR(dataset()->ElementLength(element, &length));
+          Bucket& bucket = buckets_[dataset()->BucketIndex(length)];
+          // Emits the bucket before it goes over the budget, and as soon as
+          // it cannot take any more elements.
+          if (!bucket.elements.empty() && !dataset()->Fits(bucket, length)) {
+            batch = TakeBatch(&bucket);
+          }
+          bucket.Add(std::move(element), length);
+          if (batch.empty() && dataset()->IsFull(bucket)) {
+            batch = TakeBatch(&bucket);
+          }
+        }
+        if (batch.empty() && !dataset()->drop_remainder_) {
+          // The input is exhausted: emits the remaining partial batches.
+          for (Bucket& bucket : buckets_) {
+            if (!bucket.elements.empty()) {
+              batch = TakeBatch(&bucket);
+              break;
+            }
+          }
+        }
+      }
+      if (batch.empty()) {
+        *end_of_sequence = true;
+        return absl::OkStatus();
+      }
+      *end_of_sequence = false;
+      return dataset()->CopyBatch(ctx, batch, out_tensors);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeUnknownRatioNode(std::move(args));
+    }
+
+    absl::Status SaveInternal(SerializationContext* ctx,
+                              IteratorStateWriter* writer) override {
+      TF_RETURN_IF_ERROR(ctx->HandleCheckExternalStateStatus(
+          dataset()->input_->CheckExternalState()));
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kInputExhausted, static_cast<int64_t>(!input_impl_)));
+      if (input_impl_) {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      }
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kNumBuckets, static_cast<int64_t>(buckets_.size())));
+      for (size_t i = 0; i < buckets_.size(); ++i) {
+        const std::vector<std::vector<Tensor>>& elements =
+            buckets_[i].elements;
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), absl::StrCat(kBucketSize, "[", i, "]"),
+            static_cast<int64_t>(elements.size())));
+        for (size_t j = 0; j < elements.size(); ++j) {
+          for (size_t k = 0; k < elements[j].size(); ++k) {
+            TF_RETURN_IF_ERROR(writer->WriteTensor(
+                prefix(),
+                absl::StrCat(kBucketElement, "[", i, "][", j, "][", k, "]"),
+                elements[j][k]));
+          }
+        }
+      }
+      return absl::OkStatus();
+    }
+
+    absl::Status RestoreInternal(IteratorContext* ctx,
+                                 IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64_t input_exhausted;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kInputExhausted, &input_exhausted));
+      if (static_cast<bool>(input_exhausted)) {
+        input_impl_.reset();
+      } else {
+        TF_RETURN_IF_ERROR(
+            dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      }
+      int64_t num_buckets;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kNumBuckets, &num_buckets));
+      if (num_buckets != static_cast<int64_t>(buckets_.size())) {
+        return absl::FailedPreconditionError(
+            absl::StrCat("The checkpoint has ", num_buckets,
+                         " buckets, but the dataset has ", buckets_.size(),
+                         " buckets."));
+      }
+      const size_t num_components = dataset()->input_->output_dtypes().size();
+      for (size_t i = 0; i < buckets_.size(); ++i) {
+        buckets_[i] = Bucket();
+        int64_t bucket_size;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            prefix(), absl::StrCat(kBucketSize, "[", i, "]"), &bucket_size));
+        for (int64_t j = 0; j < bucket_size; ++j) {
+          std::vector<Tensor> element(num_components);
+          for (size_t k = 0; k < num_components; ++k) {
+            TF_RETURN_IF_ERROR(reader->ReadTensor(
+                ctx->flr(), prefix(),
+                absl::StrCat(kBucketElement, "[", i, "][", j, "][", k, "]"),
+                &element[k]));
+          }
+          int64_t length;
+          TF_RETURN_IF_ERROR(dataset()->ElementLength(element, &length));
+          buckets_[i].Add(std::move(element), length);
+        }
+      }
+      return absl::OkStatus();
+    }
+
+    TraceMeMetadata GetTraceMeMetadata() const override {
+      return dataset()->traceme_metadata_;
+    }
+
+   private:
+    static std::vector<std::vector<Tensor>> TakeBatch(Bucket* bucket) {
+      std::vector<std::vector<Tensor>> batch = std::move(bucket->elements);
+      *bucket = Bucket();
+      return batch;
+    }
+
+    mutex mu_;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    std::vector<Bucket> buckets_ TF_GUARDED_BY(mu_);
+  };
+
+  int64_t num_buckets() const { return bucket_boundaries_.size() + 1; }
+
+  // Bucket `i` holds the elements with lengths in
+  // [bucket_boundaries_[i - 1], bucket_boundaries_[i]).
+  int64_t BucketIndex(int64_t length) const {
+    return std::upper_bound(bucket_boundaries_.begin(),
+                            bucket_boundaries_.end(), length) -
+           bucket_boundaries_.begin();
+  }
+
+  // Returns the number of tokens of a batch of `num_elements` elements with
+  // the given lengths: the padded size for padded batches, and the total size
+  // for ragged ones.
+  int64_t NumTokens(int64_t num_elements, int64_t max_length,
+                    int64_t total_length) const {
+    return ragged_output_ ? total_length : num_elements * max_length;
+  }
+
+  // Returns whether an element of length `length` can join `bucket` without
+  // going over the budget.
+  bool Fits(const Bucket& bucket, int64_t length) const {
+    const int64_t num_elements = bucket.elements.size() + 1;
+    if (max_batch_size_ > 0 && num_elements > max_batch_size_) return false;
+    return NumTokens(num_elements, std::max(bucket.max_length, length),
+                     bucket.total_length + length) <= max_tokens_;
+  }
+
+  // Returns whether `bucket` cannot take any more elements.
+  bool IsFull(const Bucket& bucket) const {
+    const int64_t num_elements = bucket.elements.size();
+    if (max_batch_size_ > 0 && num_elements >= max_batch_size_) return true;
+    return NumTokens(num_elements, bucket.max_length, bucket.total_length) >=
+           max_tokens_;
+  }
+
+  // The length of an element is the value of its length component if that is
+  // an integer scalar, or the size of its first dimension otherwise.
+  absl::Status ElementLength(const std::vector<Tensor>& element,
+                             int64_t* length) const {
+    const Tensor& t = element[length_component_];
+    if (t.dims() > 0) {
+      *length = t.dim_size(0);
+      return absl::OkStatus();
+    }
+    if (t.dtype() == DT_INT32) {
+      *length = t.scalar<int32>()();
+    } else if (t.dtype() == DT_INT64) {
+      *length = t.scalar<int64_t>()();
+    } else {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "The length component ", length_component_,
+          " must be an integer scalar or have at least one dimension, but got "
+          "a scalar of type ",
+          DataTypeString(t.dtype()), "."));
+    }
+    if (*length < 0) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Element lengths must be non-negative, but got ",
+                       *length, "."));
+    }
+    return absl::OkStatus();
+  }
+
+  // Copies the elements of `batch` into one output tensor per component.
+  absl::Status CopyBatch(IteratorContext* ctx,
+                         const std::vector<std::vector<Tensor>>& batch,
+                         std::vector<Tensor>* out_tensors) const {
+    const size_t num_components = batch[0].size();
+    out_tensors->reserve(num_components);
+    for (size_t i = 0; i < num_components; ++i) {
+      if (ragged_components_[i]) {
+        TF_RETURN_IF_ERROR(CopyRaggedComponent(ctx, batch, i, out_tensors));
+      } else {
+        TF_RETURN_IF_ERROR(CopyPaddedComponent(ctx, batch, i, out_tensors));
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  // Stacks component `component` of the elements of `batch`, padded to the
+  // largest size of each dimension, in a single pass over the output.
+  absl::Status CopyPaddedComponent(
+      IteratorContext* ctx, const std::vector<std::vector<Tensor>>& batch,
+      size_t component, std::vector<Tensor>* out_tensors) const {
+    TensorShape row_shape = batch[0][component].shape();
+    for (const std::vector<Tensor>& element : batch) {
+      const TensorShape& shape = element[component].shape();
+      if (shape.dims() != row_shape.dims()) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "All elements in a batch must have the same rank for component ",
+            component, ": expected rank ", row_shape.dims(),
+            " but got element with rank ", shape.dims(), "."));
+      }
+      for (int d = 0; d < shape.dims(); ++d) {
+        row_shape.set_dim(d,
+                          std::max(row_shape.dim_size(d), shape.dim_size(d)));
+      }
+    }
+    TensorShape batch_shape({static_cast<int64_t>(batch.size())});
+    batch_shape.AppendShape(row_shape);
+    out_tensors->emplace_back(ctx->allocator({}), output_types_[component],
+                              batch_shape);
+    Tensor* out = &out_tensors->back();
+    if (row_shape.num_elements() == 0) {
+      return absl::OkStatus();
+    }
+    const Tensor& padding_value = padding_values_[component];
+    for (int64_t i = 0; i < batch.size(); ++i) {
+      const Tensor& value = batch[i][component];
+      switch (value.dtype()) {
+#define HANDLE_TYPE(T)                                                       \
+  case DataTypeToEnum<T>::value:                                             \
+    CopyPaddedRow<T>(value, padding_value.scalar<T>()(), row_shape, i, out); \
+    break;
+        TF_CALL_ALL_TYPES(HANDLE_TYPE);
+        TF_CALL_QUANTIZED_TYPES(HANDLE_TYPE);
+#undef HANDLE_TYPE
+        default:
+          return absl::UnimplementedError(
+              absl::StrCat("Padding elements of type ",
+                           DataTypeString(value.dtype()),
+                           " is not supported."));
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  // Concatenates component `component` of the elements of `batch` into the
+  // values of a ragged tensor with one row per element.
+  absl::Status CopyRaggedComponent(
+      IteratorContext* ctx, const std::vector<std::vector<Tensor>>& batch,
+      size_t component, std::vector<Tensor>* out_tensors) const {
+    const TensorShape& first_shape = batch[0][component].shape();
+    if (first_shape.dims() == 0) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Component ", component,
+          " must have at least one dimension to be batched as a ragged "
+          "tensor."));
+    }
+    Tensor row_splits(ctx->allocator({}), DT_INT64,
+                      TensorShape({static_cast<int64_t>(batch.size()) + 1}));
+    auto splits = row_splits.vec<int64_t>();
+    splits(0) = 0;
+    for (int64_t i = 0; i < batch.size(); ++i) {
+      const TensorShape& shape = batch[i][component].shape();
+      if (shape.dims() != first_shape.dims() ||
+          !IsRowPrefix(shape, first_shape)) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Ragged batching requires all elements to have the same shape "
+            "except for their first dimension, but component ",
+            component, " has shapes ", first_shape.DebugString(), " and ",
+            shape.DebugString(), "."));
+      }
+      splits(i + 1) = splits(i) + shape.dim_size(0);
+    }
+    TensorShape values_shape = first_shape;
+    values_shape.set_dim(0, splits(batch.size()));
+    Tensor values(ctx->allocator({}), batch[0][component].dtype(),
+                  values_shape);
+    const int64_t row_size =
+        values_shape.dim_size(0) == 0
+            ? 0
+            : values_shape.num_elements() / values_shape.dim_size(0);
+    for (int64_t i = 0; i < batch.size(); ++i) {
+      const Tensor& value = batch[i][component];
+      const int64_t offset = splits(i) * row_size;
+      switch (value.dtype()) {
+#define HANDLE_TYPE(T)                       \
+  case DataTypeToEnum<T>::value:             \
+    CopyRaggedRows<T>(value, offset, &values); \
+    break;
+        TF_CALL_ALL_TYPES(HANDLE_TYPE);
+        TF_CALL_QUANTIZED_TYPES(HANDLE_TYPE);
+#undef HANDLE_TYPE
+        default:
+          return absl::UnimplementedError(
+              absl::StrCat("Batching elements of type ",
+                           DataTypeString(value.dtype()),
+                           " as ragged tensors is not supported."));
+      }
+    }
+    out_tensors->emplace_back(ctx->allocator({}), DT_VARIANT, TensorShape({}));
+    out_tensors->back().scalar<Variant>()() =
+        RaggedTensorVariant(std::move(values), {std::move(row_splits)});
+    return absl::OkStatus();
+  }
+
+  const DatasetBase* const input_;
+  const std::vector<int64_t> bucket_boundaries_;
+  const int64_t max_tokens_;
+  const int64_t max_batch_size_;
+  const std::vector<Tensor> padding_values_;
+  const bool drop_remainder_;
+  const int64_t length_component_;
+  const bool ragged_output_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+  // Whether each component is batched as a ragged tensor.
+  std::vector<bool> ragged_components_;
+  const TraceMeMetadata traceme_metadata_;
+};
+
+BucketByTokenBudgetDatasetOp::BucketByTokenBudgetDatasetOp(
+    OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kLengthComponent, &length_component_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kRaggedOutput, &ragged_output_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+}
+
+void BucketByTokenBudgetDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                               DatasetBase* input,
+                                               DatasetBase** output) {
+  const DataTypeVector& input_types = input->output_dtypes();
+  OP_REQUIRES(ctx, length_component_ < static_cast<int64_t>(input_types.size()),
+              absl::InvalidArgumentError(absl::StrCat(
+                  "`length_component` is ", length_component_,
+                  ", but the input dataset's elements have ",
+                  input_types.size(), " components.")));
+  OP_REQUIRES(ctx, output_types_.size() == input_types.size(),
+              absl::InvalidArgumentError(absl::StrCat(
+                  "Expected ", input_types.size(), " output types, but got ",
+                  output_types_.size(), ".")));
+  for (size_t i = 0; i < input_types.size(); ++i) {
+    const bool ragged =
+        ragged_output_ && IsRaggedComponent(input->output_shapes()[i]);
+    OP_REQUIRES(ctx, !ragged || input_types[i] != DT_VARIANT,
+                absl::InvalidArgumentError(absl::StrCat(
+                    "Component ", i,
+                    " of the input dataset's elements is a variant, which "
+                    "cannot be batched as a ragged tensor.")));
+    const DataType expected_type = ragged ? DT_VARIANT : input_types[i];
+    OP_REQUIRES(ctx, output_types_[i] == expected_type,
+                absl::InvalidArgumentError(absl::StrCat(
+                    "Expected output type ", DataTypeString(expected_type),
+                    " for component ", i, ", but got ",
+                    DataTypeString(output_types_[i]), ".")));
+  }
+
+  const Tensor* bucket_boundaries_t;
+  OP_REQUIRES_OK(ctx, ctx->input(kBucketBoundaries, &bucket_boundaries_t));
+  OP_REQUIRES(
+      ctx, TensorShapeUtils::IsVector(bucket_boundaries_t->shape()),
+      absl::InvalidArgumentError("`bucket_boundaries` must be a vector."));
+  std::vector<int64_t> bucket_boundaries;
+  bucket_boundaries.reserve(bucket_boundaries_t->NumElements());
+  for (int64_t i = 0; i < bucket_boundaries_t->NumElements(); ++i) {
+    const int64_t boundary = bucket_boundaries_t->vec<int64_t>()(i);
+    OP_REQUIRES(ctx, i == 0 || boundary > bucket_boundaries.back(),
+                absl::InvalidArgumentError(
+                    "`bucket_boundaries` must be strictly increasing."));
+    bucket_boundaries.push_back(boundary);
+  }
+
+  int64_t max_tokens;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64_t>(ctx, kMaxTokens, &max_tokens));
+  OP_REQUIRES(ctx, max_tokens > 0,
+              absl::InvalidArgumentError(
+                  "`max_tokens` must be greater than zero."));
+
+  int64_t max_batch_size;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kMaxBatchSize,
+                                                   &max_batch_size));
+  OP_REQUIRES(ctx, max_batch_size > 0 || max_batch_size == -1,
+              absl::InvalidArgumentError(
+                  "`max_batch_size` must be greater than zero, or -1 for no "
+                  "limit."));
+
+  OpInputList padding_values_list;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddingValues, &padding_values_list));
+  OP_REQUIRES(ctx, padding_values_list.size() == input_types.size(),
+              absl::InvalidArgumentError(absl::StrCat(
+                  "Number of padding values (", padding_values_list.size(),
+                  ") must match the number of components in the input "
+                  "dataset's elements (",
+                  input_types.size(), ")")));
+  std::vector<Tensor> padding_values;
+  padding_values.reserve(padding_values_list.size());
+  for (int i = 0; i < padding_values_list.size(); ++i) {
+    const Tensor& padding_value_t = padding_values_list[i];
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::IsScalar(padding_value_t.shape()),
+        absl::InvalidArgumentError("All padding values must be scalars"));
+    OP_REQUIRES(ctx, padding_value_t.dtype() == input_types[i],
+                absl::InvalidArgumentError(absl::StrCat(
+                    "Mismatched type between padding value ", i,
+                    " and input dataset's component ", i, ": ",
+                    DataTypeString(padding_value_t.dtype()), " vs. ",
+                    DataTypeString(input_types[i]))));
+    padding_values.push_back(tensor::DeepCopy(padding_value_t));
+  }
+
+  bool drop_remainder;
+  OP_REQUIRES_OK(
+      ctx, ParseScalarArgument<bool>(ctx, kDropRemainder, &drop_remainder));
+
+  *output = new Dataset(ctx, input, std::move(bucket_boundaries), max_tokens,
+                        max_batch_size, std::move(padding_values),
+                        drop_remainder, length_component_, ragged_output_,
+                        output_types_, output_shapes_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("BucketByTokenBudgetDataset").Device(DEVICE_CPU),
+                        BucketByTokenBudgetDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,62 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_BUCKET_BY_TOKEN_BUDGET_DATASET_OP_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_BUCKET_BY_TOKEN_BUDGET_DATASET_OP_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/framework/dataset.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Groups the elements of its input into buckets by length, and batches the
+// elements of each bucket so that a batch holds at most `max_tokens` tokens.
+class BucketByTokenBudgetDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  static constexpr const char* const kDatasetType = "BucketByTokenBudget";
+  static constexpr const char* const kInputDataset = "input_dataset";
+  static constexpr const char* const kBucketBoundaries = "bucket_boundaries";
+  static constexpr const char* const kMaxTokens = "max_tokens";
+  static constexpr const char* const kMaxBatchSize = "max_batch_size";
+  static constexpr const char* const kPaddingValues = "padding_values";
+  static constexpr const char* const kDropRemainder = "drop_remainder";
+  static constexpr const char* const kLengthComponent = "length_component";
+  static constexpr const char* const kRaggedOutput = "ragged_output";
+  static constexpr const char* const kTpaddingValues = "Tpadding_values";
+  static constexpr const char* const kOutputTypes = "output_types";
+  static constexpr const char* const kOutputShapes = "output_shapes";
+
+  explicit BucketByTokenBudgetDatasetOp(OpKernelConstruction* ctx);
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override;
+
+ private:
+  class Dataset;
+  int64_t length_component_;
+  bool ragged_output_;
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_BUCKET_BY_TOKEN_BUDGET_DATASET_OP_H_
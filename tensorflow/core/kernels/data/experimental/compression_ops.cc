@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/experimental/compression_ops.h"
 
+#include <string>
+
 #include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
@@ -25,7 +27,19 @@ namespace data {
 namespace experimental {
 
 CompressElementOp::CompressElementOp(OpKernelConstruction* ctx)
-    : OpKernel(ctx) {}
+    : OpKernel(ctx) {
+  if (ctx->HasAttr(kCodec)) {
+    std::string codec;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kCodec, &codec));
+    OP_REQUIRES_OK(ctx, ParseCompressionCodec(codec, &options_.codec));
+  }
+  if (ctx->HasAttr(kLevel)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kLevel, &options_.level));
+  }
+  if (ctx->HasAttr(kByteShuffle)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kByteShuffle, &options_.byte_shuffle));
+  }
+}
 
 void CompressElementOp::Compute(OpKernelContext* ctx) {
   std::vector<Tensor> components;
@@ -34,7 +48,7 @@ void CompressElementOp::Compute(OpKernelContext* ctx) {
     components.push_back(ctx->input(i));
   }
   CompressedElement compressed;
-  OP_REQUIRES_OK(ctx, CompressElement(components, &compressed));
+  OP_REQUIRES_OK(ctx, CompressElement(components, options_, &compressed));
 
   Tensor* output;
   OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COMPRESSION_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COMPRESSION_OPS_H_
 
+#include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 
 namespace tensorflow {
@@ -23,9 +24,17 @@ namespace experimental {
 
 class CompressElementOp : public OpKernel {
  public:
+  static constexpr const char* const kCodec = "experimental_codec";
+  static constexpr const char* const kLevel = "experimental_level";
+  static constexpr const char* const kByteShuffle =
+      "experimental_byte_shuffle";
+
   explicit CompressElementOp(OpKernelConstruction* ctx);
 
   void Compute(OpKernelContext* ctx) override;
+
+ private:
+  ElementCompressionOptions options_;
 };
 
 class UncompressElementOp : public OpKernel {
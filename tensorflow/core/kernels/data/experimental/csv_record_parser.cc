@@ -0,0 +1,279 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/csv_record_parser.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "absl/log/check.h"
+#include "absl/numeric/bits.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+// Returns the offset of the first byte of `data` at or after `pos` that equals
+// `a`, `b`, `c` or `d`, or `data.size()` if there is none.
+size_t FindFirstOf(absl::string_view data, size_t pos, char a, char b, char c,
+                   char d) {
+  const char* const bytes = data.data();
+  const size_t size = data.size();
+#ifdef __SSE2__
+  const __m128i va = _mm_set1_epi8(a);
+  const __m128i vb = _mm_set1_epi8(b);
+  const __m128i vc = _mm_set1_epi8(c);
+  const __m128i vd = _mm_set1_epi8(d);
+  for (; pos + 16 <= size; pos += 16) {
+    const __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + pos));
+    const __m128i matches =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, va),
+                                  _mm_cmpeq_epi8(block, vb)),
+                     _mm_or_si128(_mm_cmpeq_epi8(block, vc),
+                                  _mm_cmpeq_epi8(block, vd)));
+    const uint32_t mask =
+        static_cast<uint32_t>(_mm_movemask_epi8(matches));
+    if (mask != 0) {
+      return pos + absl::countr_zero(mask);
+    }
+  }
+#endif  // __SSE2__
+  for (; pos < size; ++pos) {
+    const char ch = bytes[pos];
+    if (ch == a || ch == b || ch == c || ch == d) {
+      return pos;
+    }
+  }
+  return size;
+}
+
+bool IsLineBreak(char ch) { return ch == '\n' || ch == '\r'; }
+
+}  // namespace
+
+CsvRecordParser::Field CsvRecordParser::NextField() {
+  if (pos_ >= data_.size()) {
+    // The previous field was followed by a delimiter at the end of the input,
+    // so the last field is empty.
+    Field field;
+    field.end_of_record = true;
+    last_line_break_ = 0;
+    return field;
+  }
+  if (use_quote_delim_ && data_[pos_] == '"') {
+    return ParseQuotedField();
+  }
+  return ParseUnquotedField();
+}
+
+CsvRecordParser::Field CsvRecordParser::ParseQuotedField() {
+  Field field;
+  const size_t start = ++pos_;  // Skips the opening quote.
+  while (true) {
+    const size_t quote = data_.find('"', pos_);
+    if (quote == absl::string_view::npos) {
+      field.value = data_.substr(start);
+      field.end_of_record = true;
+      field.status = absl::InvalidArgumentError(
+          "Reached end of file without closing quoted field in record");
+      pos_ = data_.size();
+      last_line_break_ = 0;
+      return field;
+    }
+    if (quote + 1 == data_.size()) {
+      // The closing quote ends the input.
+      field.value = data_.substr(start, quote - start);
+      field.end_of_record = true;
+      pos_ = data_.size();
+      last_line_break_ = 0;
+      return field;
+    }
+    const char next = data_[quote + 1];
+    if (next == delim_) {
+      field.value = data_.substr(start, quote - start);
+      pos_ = quote + 2;
+      return field;
+    }
+    if (IsLineBreak(next)) {
+      field.value = data_.substr(start, quote - start);
+      field.end_of_record = true;
+      pos_ = quote + 1;
+      SkipLineBreak();
+      return field;
+    }
+    if (next == '"') {
+      field.has_escaped_quotes = true;
+    } else {
+      // Take note of the error, but keep going to the end of the field.
+      field.status.Update(absl::InvalidArgumentError(
+          "Quote inside a string has to be escaped by another quote"));
+    }
+    pos_ = quote + 2;
+  }
+}
+
+CsvRecordParser::Field CsvRecordParser::ParseUnquotedField() {
+  Field field;
+  const size_t start = pos_;
+  // Without quoting, quotes are regular characters: search for the delimiter
+  // in their place.
+  const char quote = use_quote_delim_ ? '"' : delim_;
+  while (true) {
+    const size_t end = FindFirstOf(data_, pos_, delim_, quote, '\n', '\r');
+    if (end == data_.size()) {
+      field.value = data_.substr(start);
+      field.end_of_record = true;
+      pos_ = data_.size();
+      last_line_break_ = 0;
+      return field;
+    }
+    const char ch = data_[end];
+    if (ch == delim_) {
+      field.value = data_.substr(start, end - start);
+      pos_ = end + 1;
+      return field;
+    }
+    if (IsLineBreak(ch)) {
+      field.value = data_.substr(start, end - start);
+      field.end_of_record = true;
+      pos_ = end;
+      SkipLineBreak();
+      return field;
+    }
+    // Take note of the error, but keep going to the end of the field.
+    field.status.Update(absl::InvalidArgumentError(
+        "Unquoted fields cannot have quotes inside"));
+    pos_ = end + 1;
+  }
+}
+
+void CsvRecordParser::SkipLineBreak() {
+  if (data_[pos_] == '\r' && pos_ + 1 < data_.size() &&
+      data_[pos_ + 1] == '\n') {
+    ++pos_;
+  }
+  last_line_break_ = data_[pos_];
+  ++pos_;
+}
+
+size_t CsvRecordParser::FindLastRecordEnd(absl::string_view data, char delim,
+                                          bool use_quote_delim) {
+  return CsvRecordEndFinder(delim, use_quote_delim).FindLastRecordEnd(data);
+}
+
+std::string CsvRecordParser::Unescape(absl::string_view value) {
+  std::string result;
+  result.reserve(value.size());
+  size_t from = 0;
+  size_t quote = value.find('"');
+  while (quote != absl::string_view::npos) {
+    // Keeps the first quote of each pair of quotes.
+    result.append(value.data() + from, quote + 1 - from);
+    from = quote + 2;
+    quote = from < value.size() ? value.find('"', from)
+                                : absl::string_view::npos;
+  }
+  if (from < value.size()) {
+    result.append(value.data() + from, value.size() - from);
+  }
+  return result;
+}
+
+size_t CsvRecordEndFinder::FindLastRecordEnd(absl::string_view data) {
+  // Without quoting, fields don't matter: only look for line breaks.
+  const char delim = use_quote_delim_ ? delim_ : '\n';
+  while (pos_ < data.size()) {
+    switch (state_) {
+      case State::kFieldStart:
+        if (use_quote_delim_ && data[pos_] == '"') {
+          state_ = State::kQuotedField;
+          ++pos_;
+        } else {
+          state_ = State::kUnquotedField;
+        }
+        break;
+      case State::kUnquotedField:
+        pos_ = FindFirstOf(data, pos_, delim, delim, '\n', '\r');
+        if (pos_ == data.size()) {
+          break;
+        }
+        if (data[pos_] == delim_ && use_quote_delim_) {
+          state_ = State::kFieldStart;
+          ++pos_;
+        } else if (!EndRecord(data)) {
+          return last_record_end_;
+        }
+        break;
+      case State::kQuotedField: {
+        const size_t quote = data.find('"', pos_);
+        if (quote == absl::string_view::npos) {
+          pos_ = data.size();
+          break;
+        }
+        state_ = State::kQuoteInQuotedField;
+        pos_ = quote + 1;
+        break;
+      }
+      case State::kQuoteInQuotedField:
+        if (data[pos_] == delim_) {
+          state_ = State::kFieldStart;
+          ++pos_;
+        } else if (IsLineBreak(data[pos_])) {
+          if (!EndRecord(data)) {
+            return last_record_end_;
+          }
+        } else {
+          // An escaped quote, or a malformed one, which `CsvRecordParser`
+          // skips along with the next byte.
+          state_ = State::kQuotedField;
+          ++pos_;
+        }
+        break;
+    }
+  }
+  return last_record_end_;
+}
+
+void CsvRecordEndFinder::Consume(size_t n) {
+  DCHECK_LE(n, last_record_end_);
+  pos_ -= n;
+  last_record_end_ -= n;
+}
+
+bool CsvRecordEndFinder::EndRecord(absl::string_view data) {
+  if (data[pos_] == '\r') {
+    if (pos_ + 1 == data.size()) {
+      return false;
+    }
+    if (data[pos_ + 1] == '\n') {
+      ++pos_;
+    }
+  }
+  last_record_end_ = ++pos_;
+  state_ = State::kFieldStart;
+  return true;
+}
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
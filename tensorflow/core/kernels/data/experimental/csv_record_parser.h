@@ -0,0 +1,133 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_CSV_RECORD_PARSER_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_CSV_RECORD_PARSER_H_
+
+#include <cstddef>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Splits CSV text into records and fields, following the rules of
+// `CSVDataset`: records end at "\n", "\r", "\r\n" or the end of the input, and
+// if `use_quote_delim` is set, fields that start with a quote extend to the
+// matching quote and may contain delimiters, line breaks and escaped ("")
+// quotes.
+//
+// Delimiters and quotes are located 16 bytes at a time where SSE2 is
+// available.
+class CsvRecordParser {
+ public:
+  struct Field {
+    // The contents of the field, without framing quotes. Escaped quotes are
+    // still escaped if `has_escaped_quotes` is set.
+    absl::string_view value;
+    bool has_escaped_quotes = false;
+    // Set if the field is the last one of its record.
+    bool end_of_record = false;
+    // Set if the field is malformed. Parsing continues with the next field.
+    absl::Status status;
+  };
+
+  CsvRecordParser(absl::string_view data, char delim, bool use_quote_delim)
+      : data_(data), delim_(delim), use_quote_delim_(use_quote_delim) {}
+
+  // Returns true if all records of `data` have been parsed.
+  bool Done() const { return pos_ >= data_.size(); }
+
+  // Returns the offset of the first unparsed byte of `data`.
+  size_t position() const { return pos_; }
+
+  // Parses the next field. Must not be called once `Done()`, unless the
+  // previous field was followed by a delimiter.
+  Field NextField();
+
+  // Returns the end of the last record of `data` that is known to be complete
+  // without looking past the end of `data`, or 0 if there is none. `data` must
+  // start at the beginning of a record. See `CsvRecordEndFinder` to search
+  // growing data.
+  static size_t FindLastRecordEnd(absl::string_view data, char delim,
+                                  bool use_quote_delim);
+
+  // Replaces each escaped ("") quote of `value` by a single quote.
+  static std::string Unescape(absl::string_view value);
+
+ private:
+  Field ParseQuotedField();
+  Field ParseUnquotedField();
+  // Consumes the line break at `pos_`, treating "\r\n" as one line break.
+  void SkipLineBreak();
+
+  const absl::string_view data_;
+  const char delim_;
+  const bool use_quote_delim_;
+  size_t pos_ = 0;
+  // The last byte of the line break that ended the last record, or 0 if the
+  // record ended at the end of `data`.
+  char last_line_break_ = 0;
+};
+
+// Finds the ends of the records of CSV text that grows at its end and is
+// consumed from its start, following the rules of `CsvRecordParser`.
+//
+// Only tracks whether each byte is inside a quoted field, without splitting
+// the fields, and resumes where the previous search stopped, so each byte is
+// scanned once however long the records are.
+class CsvRecordEndFinder {
+ public:
+  CsvRecordEndFinder(char delim, bool use_quote_delim)
+      : delim_(delim), use_quote_delim_(use_quote_delim) {}
+
+  // Returns the end of the last record of `data` that is known to be complete
+  // without looking past the end of `data`, or 0 if there is none. `data` must
+  // extend the `data` of the previous call, less the bytes passed to
+  // `Consume()` since.
+  size_t FindLastRecordEnd(absl::string_view data);
+
+  // Records that the first `n` bytes of the data were removed. `n` may not
+  // exceed the last record end found.
+  void Consume(size_t n);
+
+ private:
+  enum class State {
+    kFieldStart,
+    kUnquotedField,
+    kQuotedField,
+    // Right after a quote in a quoted field.
+    kQuoteInQuotedField,
+  };
+
+  // Ends the record at the line break at `pos_`. Returns false if the line
+  // break is a trailing "\r", which may be the first half of "\r\n".
+  bool EndRecord(absl::string_view data);
+
+  const char delim_;
+  const bool use_quote_delim_;
+  State state_ = State::kFieldStart;
+  // The offset of the first byte not scanned yet.
+  size_t pos_ = 0;
+  size_t last_record_end_ = 0;
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_CSV_RECORD_PARSER_H_
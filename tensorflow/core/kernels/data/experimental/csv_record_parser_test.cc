@@ -0,0 +1,214 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/csv_record_parser.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Parses `data` into records of unescaped fields.
+std::vector<std::vector<std::string>> ParseRecords(absl::string_view data,
+                                                   bool use_quote_delim = true,
+                                                   char delim = ',') {
+  CsvRecordParser parser(data, delim, use_quote_delim);
+  std::vector<std::vector<std::string>> records;
+  while (!parser.Done()) {
+    std::vector<std::string>& record = records.emplace_back();
+    CsvRecordParser::Field field;
+    do {
+      field = parser.NextField();
+      EXPECT_TRUE(field.status.ok()) << field.status;
+      record.push_back(field.has_escaped_quotes
+                           ? CsvRecordParser::Unescape(field.value)
+                           : std::string(field.value));
+    } while (!field.end_of_record);
+  }
+  return records;
+}
+
+// Returns the status of the first malformed field of `data`.
+absl::Status FirstError(absl::string_view data) {
+  CsvRecordParser parser(data, ',', /*use_quote_delim=*/true);
+  while (!parser.Done()) {
+    CsvRecordParser::Field field = parser.NextField();
+    if (!field.status.ok()) {
+      return field.status;
+    }
+  }
+  return absl::OkStatus();
+}
+
+TEST(CsvRecordParserTest, ParseUnquotedFields) {
+  EXPECT_THAT(ParseRecords("a,b,c\n1,,3"),
+              ElementsAre(ElementsAre("a", "b", "c"),
+                          ElementsAre("1", "", "3")));
+}
+
+TEST(CsvRecordParserTest, ParseLongFields) {
+  const std::string long_field(100, 'x');
+  EXPECT_THAT(ParseRecords(long_field + ";" + long_field + "\n",
+                           /*use_quote_delim=*/true, /*delim=*/';'),
+              ElementsAre(ElementsAre(long_field, long_field)));
+}
+
+TEST(CsvRecordParserTest, ParseLineBreaks) {
+  EXPECT_THAT(ParseRecords("a\nb\rc\r\nd\n"),
+              ElementsAre(ElementsAre("a"), ElementsAre("b"), ElementsAre("c"),
+                          ElementsAre("d")));
+  EXPECT_THAT(ParseRecords("\n\n"), ElementsAre(ElementsAre(""),
+                                                ElementsAre("")));
+}
+
+TEST(CsvRecordParserTest, ParseTrailingDelimiter) {
+  EXPECT_THAT(ParseRecords("a,"), ElementsAre(ElementsAre("a", "")));
+}
+
+TEST(CsvRecordParserTest, ParseQuotedFields) {
+  EXPECT_THAT(
+      ParseRecords("\"a,b\",\"c\nd\",\"\"\"e\"\"\"\r\n\"\",f"),
+      ElementsAre(ElementsAre("a,b", "c\nd", "\"e\""), ElementsAre("", "f")));
+}
+
+TEST(CsvRecordParserTest, QuotesAreRegularCharactersWithoutQuoteDelim) {
+  EXPECT_THAT(ParseRecords("\"a,b\"\n", /*use_quote_delim=*/false),
+              ElementsAre(ElementsAre("\"a", "b\"")));
+}
+
+TEST(CsvRecordParserTest, MalformedFields) {
+  EXPECT_EQ(FirstError("a,b\"c\n").message(),
+            "Unquoted fields cannot have quotes inside");
+  EXPECT_EQ(FirstError("\"a\"b\",c\n").message(),
+            "Quote inside a string has to be escaped by another quote");
+  EXPECT_EQ(FirstError("a,\"b\n").message(),
+            "Reached end of file without closing quoted field in record");
+}
+
+TEST(CsvRecordParserTest, ContinueAfterMalformedField) {
+  CsvRecordParser parser("a\"b,c\nd\n", ',', /*use_quote_delim=*/true);
+  EXPECT_FALSE(parser.NextField().status.ok());
+  CsvRecordParser::Field field = parser.NextField();
+  EXPECT_EQ(field.value, "c");
+  EXPECT_TRUE(field.end_of_record);
+  EXPECT_EQ(parser.NextField().value, "d");
+  EXPECT_TRUE(parser.Done());
+}
+
+TEST(CsvRecordParserTest, FindLastRecordEnd) {
+  for (bool use_quote_delim : {false, true}) {
+    EXPECT_EQ(CsvRecordParser::FindLastRecordEnd("", ',', use_quote_delim), 0);
+    EXPECT_EQ(CsvRecordParser::FindLastRecordEnd("a,b", ',', use_quote_delim),
+              0);
+    EXPECT_EQ(
+        CsvRecordParser::FindLastRecordEnd("a\nb\nc", ',', use_quote_delim), 4);
+    EXPECT_EQ(
+        CsvRecordParser::FindLastRecordEnd("a\nb\n", ',', use_quote_delim), 4);
+    // A trailing "\r" may be followed by "\n".
+    EXPECT_EQ(
+        CsvRecordParser::FindLastRecordEnd("a\nb\r", ',', use_quote_delim), 2);
+    EXPECT_EQ(CsvRecordParser::FindLastRecordEnd("a\r", ',', use_quote_delim),
+              0);
+    EXPECT_EQ(
+        CsvRecordParser::FindLastRecordEnd("a\r\nb", ',', use_quote_delim), 3);
+  }
+}
+
+TEST(CsvRecordParserTest, FindLastRecordEndWithQuotedLineBreaks) {
+  EXPECT_EQ(CsvRecordParser::FindLastRecordEnd("a\n\"b\nc", ',', true), 2);
+  EXPECT_EQ(CsvRecordParser::FindLastRecordEnd("a\n\"b\nc\"\nd", ',', true), 8);
+  // The closing quote may be the first of an escaped pair.
+  EXPECT_EQ(CsvRecordParser::FindLastRecordEnd("a\n\"b\"", ',', true), 2);
+  // Quotes inside unquoted fields don't open quoted fields.
+  EXPECT_EQ(CsvRecordParser::FindLastRecordEnd("a\"b\nc", ',', true), 4);
+  EXPECT_EQ(CsvRecordParser::FindLastRecordEnd("\"a\"\r", ',', true), 0);
+  EXPECT_EQ(CsvRecordParser::FindLastRecordEnd("a\"\nb", ',', false), 3);
+}
+
+TEST(CsvRecordEndFinderTest, ResumesAcrossCalls) {
+  CsvRecordEndFinder finder(',', /*use_quote_delim=*/true);
+  std::string data = "a,\"b\n";
+  EXPECT_EQ(finder.FindLastRecordEnd(data), 0);
+  data += "c\"\nd,\"e";
+  EXPECT_EQ(finder.FindLastRecordEnd(data), 8);
+  finder.Consume(8);
+  data.erase(0, 8);
+  data += "\"\r";
+  EXPECT_EQ(finder.FindLastRecordEnd(data), 0);
+  data += "\n";
+  EXPECT_EQ(finder.FindLastRecordEnd(data), 7);
+}
+
+// Checks that searching data in two steps, with and without consuming the
+// complete records in between, finds the same record ends as searching all
+// of it at once, for all short inputs.
+TEST(CsvRecordEndFinderTest, MatchesSearchOfWholeData) {
+  constexpr absl::string_view kAlphabet = "a,\"\n\r";
+  std::vector<std::string> inputs = {""};
+  for (size_t i = 0; i < inputs.size() && inputs[i].size() < 6; ++i) {
+    for (char ch : kAlphabet) {
+      inputs.push_back(inputs[i] + ch);
+    }
+  }
+  for (bool use_quote_delim : {false, true}) {
+    for (const std::string& input : inputs) {
+      const size_t expected_end =
+          CsvRecordParser::FindLastRecordEnd(input, ',', use_quote_delim);
+      for (size_t split = 0; split <= input.size(); ++split) {
+        const absl::string_view head =
+            absl::string_view(input).substr(0, split);
+        CsvRecordEndFinder finder(',', use_quote_delim);
+        finder.FindLastRecordEnd(head);
+        EXPECT_EQ(finder.FindLastRecordEnd(input), expected_end) << input;
+
+        CsvRecordEndFinder consuming_finder(',', use_quote_delim);
+        const size_t head_end = consuming_finder.FindLastRecordEnd(head);
+        consuming_finder.Consume(head_end);
+        EXPECT_EQ(head_end + consuming_finder.FindLastRecordEnd(
+                                 absl::string_view(input).substr(head_end)),
+                  expected_end)
+            << input;
+      }
+    }
+  }
+}
+
+TEST(CsvRecordParserTest, Unescape) {
+  EXPECT_EQ(CsvRecordParser::Unescape(""), "");
+  EXPECT_EQ(CsvRecordParser::Unescape("abc"), "abc");
+  EXPECT_EQ(CsvRecordParser::Unescape("a\"\"b"), "a\"b");
+  EXPECT_EQ(CsvRecordParser::Unescape("\"\"\"\""), "\"\"");
+}
+
+TEST(CsvRecordParserTest, EmptyInput) {
+  CsvRecordParser parser("", ',', /*use_quote_delim=*/true);
+  EXPECT_TRUE(parser.Done());
+  EXPECT_THAT(ParseRecords(""), IsEmpty());
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
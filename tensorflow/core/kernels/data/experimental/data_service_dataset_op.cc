@@ -706,7 +706,8 @@ void DataServiceDatasetOp::MakeDataset(OpKernelContext* ctx,
     should_uncompress =
         should_uncompress &&
         (*compression == DataServiceMetadata::COMPRESSION_SNAPPY ||
-         *compression == DataServiceMetadata::COMPRESSION_FORCED_SNAPPY);
+         *compression == DataServiceMetadata::COMPRESSION_FORCED_SNAPPY ||
+         *compression == DataServiceMetadata::COMPRESSION_FORCED_ZSTD);
   }
   if (should_uncompress) {
     absl::StatusOr<bool> disable_compression_at_runtime =
@@ -0,0 +1,843 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/parallel_csv_dataset_op.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/data/experimental/csv_record_parser.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/zlib_compression_options.h"
+#include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const ParallelCSVDatasetOp::kDatasetType;
+/* static */ constexpr const char* const ParallelCSVDatasetOp::kFilenames;
+/* static */ constexpr const char* const
+    ParallelCSVDatasetOp::kCompressionType;
+/* static */ constexpr const char* const ParallelCSVDatasetOp::kBufferSize;
+/* static */ constexpr const char* const ParallelCSVDatasetOp::kHeader;
+/* static */ constexpr const char* const ParallelCSVDatasetOp::kFieldDelim;
+/* static */ constexpr const char* const ParallelCSVDatasetOp::kUseQuoteDelim;
+/* static */ constexpr const char* const ParallelCSVDatasetOp::kNaValue;
+/* static */ constexpr const char* const ParallelCSVDatasetOp::kSelectCols;
+/* static */ constexpr const char* const
+    ParallelCSVDatasetOp::kRecordDefaults;
+/* static */ constexpr const char* const ParallelCSVDatasetOp::kExcludeCols;
+/* static */ constexpr const char* const
+    ParallelCSVDatasetOp::kNumParallelCalls;
+/* static */ constexpr const char* const ParallelCSVDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const ParallelCSVDatasetOp::kOutputShapes;
+
+namespace {
+
+constexpr char kFileIndex[] = "file_index";
+constexpr char kOffset[] = "offset";
+
+// A record of a chunk, converted to output tensors.
+struct ParsedRecord {
+  std::vector<Tensor> value;
+  // The first error of the record, in field order.
+  absl::Status status;
+  // The output column at which `status` was raised. Conversion errors of
+  // earlier columns take precedence, as they come from earlier fields.
+  size_t error_column = 0;
+  // The offset of the end of the record in the (uncompressed) file.
+  int64_t end_offset = 0;
+};
+
+// A run of whole records of one file, parsed by one parallel call.
+struct Chunk {
+  size_t file_index = 0;
+  // The offset of `data` in the (uncompressed) file.
+  int64_t start_offset = 0;
+  // Set if `data` ends at the end of the file.
+  bool end_of_file = false;
+  std::string data;
+  // An error to report after the records of the chunk, e.g. a read error.
+  absl::Status status;
+  std::vector<ParsedRecord> records;
+  // Set once `records` are ready.
+  bool done = false;
+};
+
+// Converts output column `column` of `records` to scalars of type `T`. The
+// fields of `records` are in `fields`, `num_columns` per record.
+template <typename T, typename ParseFn>
+void ConvertColumn(size_t column, size_t num_columns, DataType dtype,
+                   absl::string_view type_name, ParseFn parse,
+                   const Tensor& record_default, absl::string_view na_value,
+                   Allocator* allocator,
+                   absl::Span<const absl::string_view> fields,
+                   std::vector<ParsedRecord>* records) {
+  const bool has_default = record_default.NumElements() == 1;
+  for (size_t i = 0; i < records->size(); ++i) {
+    ParsedRecord& record = (*records)[i];
+    if (!record.status.ok() && column >= record.error_column) {
+      continue;
+    }
+    const absl::string_view field = fields[i * num_columns + column];
+    absl::Status status;
+    if (field.empty() || field == na_value) {
+      if (has_default) {
+        record.value[column] = Tensor(allocator, dtype, TensorShape({}));
+        record.value[column].scalar<T>()() = record_default.flat<T>()(0);
+      } else {
+        status = absl::InvalidArgumentError(absl::StrCat(
+            "Field ", column, " is required but missing in record!"));
+      }
+    } else {
+      T value;
+      if (parse(field, &value)) {
+        record.value[column] = Tensor(allocator, dtype, TensorShape({}));
+        record.value[column].scalar<T>()() = std::move(value);
+      } else {
+        status = absl::InvalidArgumentError(
+            absl::StrCat("Field ", column, " in record is not a valid ",
+                         type_name, ": ", field));
+      }
+    }
+    if (!status.ok()) {
+      record.status = std::move(status);
+      record.error_column = column;
+    }
+  }
+}
+
+}  // namespace
+
+class ParallelCSVDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, std::vector<std::string> filenames,
+          bool header, std::string compression_type,
+          io::ZlibCompressionOptions options,
+          const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes,
+          std::vector<Tensor> record_defaults,
+          std::vector<int64_t> select_cols, std::vector<int64_t> exclude_cols,
+          bool use_quote_delim, char delim, std::string na_value,
+          int64_t num_parallel_calls)
+      : DatasetBase(DatasetContext(ctx)),
+        filenames_(std::move(filenames)),
+        header_(header),
+        output_types_(output_types),
+        output_shapes_(output_shapes),
+        record_defaults_(std::move(record_defaults)),
+        select_cols_(std::move(select_cols)),
+        exclude_cols_(std::move(exclude_cols)),
+        use_quote_delim_(use_quote_delim),
+        delim_(delim),
+        na_value_(std::move(na_value)),
+        num_parallel_calls_(num_parallel_calls),
+        use_compression_(!compression_type.empty()),
+        compression_type_(std::move(compression_type)),
+        options_(options) {}
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const std::string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return output_types_;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  std::string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  absl::Status CheckExternalState() const override {
+    return absl::OkStatus();
+  }
+
+  absl::Status InputDatasets(
+      std::vector<const DatasetBase*>* inputs) const override {
+    inputs->clear();
+    return absl::OkStatus();
+  }
+
+ protected:
+  absl::Status AsGraphDefInternal(SerializationContext* ctx,
+                                  DatasetGraphDefBuilder* b,
+                                  Node** output) const override {
+    Node* filenames = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+    Node* compression_type = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
+    Node* buffer_size = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(options_.input_buffer_size, &buffer_size));
+    Node* header = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(header_, &header));
+    Node* delim = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(tstring(1, delim_), &delim));
+    Node* use_quote_delim = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(use_quote_delim_, &use_quote_delim));
+    Node* na_value = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(na_value_, &na_value));
+    Node* select_cols = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(select_cols_, &select_cols));
+    std::vector<Node*> record_defaults;
+    record_defaults.reserve(record_defaults_.size());
+    for (const Tensor& t : record_defaults_) {
+      Node* node;
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      record_defaults.push_back(node);
+    }
+    Node* exclude_cols = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(exclude_cols_, &exclude_cols));
+    Node* num_parallel_calls = nullptr;
+    TF_RETURN_IF_ERROR(
+        b->AddScalar(num_parallel_calls_, &num_parallel_calls));
+
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this,
+        {{0, filenames},
+         {1, compression_type},
+         {2, buffer_size},
+         {3, header},
+         {4, delim},
+         {5, use_quote_delim},
+         {6, na_value},
+         {7, select_cols},
+         {9, exclude_cols},
+         {10, num_parallel_calls}},
+        {{8, record_defaults}}, {}, output));
+    return absl::OkStatus();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    ~Iterator() override {
+      CancelThreads(/*wait=*/true);
+      if (deregister_fn_) deregister_fn_();
+    }
+
+    absl::Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      num_parallel_calls_ = dataset()->num_parallel_calls_;
+      if (num_parallel_calls_ == model::kAutotune) {
+        num_parallel_calls_ = GetAutotuneDefaultParallelism(ctx);
+      }
+      return RegisterCancellationCallback(
+          ctx->cancellation_manager(),
+          [this]() { CancelThreads(/*wait=*/false); }, &deregister_fn_);
+    }
+
+    absl::Status GetNextInternal(IteratorContext* ctx,
+                                 std::vector<Tensor>* out_tensors,
+                                 bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      EnsureThreadsStarted(ctx);
+      while (true) {
+        while (!cancelled_ && (chunks_.empty() ? !reader_finished_
+                                               : !chunks_.front()->done)) {
+          RecordStop(ctx);
+          cond_var_.wait(l);
+          RecordStart(ctx);
+        }
+        if (cancelled_) {
+          return absl::CancelledError("Iterator was cancelled");
+        }
+        if (chunks_.empty()) {
+          *end_of_sequence = true;
+          return absl::OkStatus();
+        }
+        Chunk& chunk = *chunks_.front();
+        if (next_record_ < chunk.records.size()) {
+          ParsedRecord& record = chunk.records[next_record_++];
+          next_file_index_ = chunk.file_index;
+          next_offset_ = record.end_offset;
+          *end_of_sequence = false;
+          if (!record.status.ok()) {
+            return record.status;
+          }
+          *out_tensors = std::move(record.value);
+          return absl::OkStatus();
+        }
+        std::shared_ptr<Chunk> consumed = std::move(chunks_.front());
+        chunks_.pop_front();
+        next_record_ = 0;
+        cond_var_.notify_all();
+        if (consumed->end_of_file) {
+          next_file_index_ = consumed->file_index + 1;
+          next_offset_ = 0;
+        }
+        if (!consumed->status.ok()) {
+          *end_of_sequence = false;
+          return consumed->status;
+        }
+      }
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    absl::Status SaveInternal(SerializationContext* ctx,
+                              IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kFileIndex, static_cast<int64_t>(next_file_index_)));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kOffset, next_offset_));
+      return absl::OkStatus();
+    }
+
+    absl::Status RestoreInternal(IteratorContext* ctx,
+                                 IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      DCHECK(!reader_thread_);
+      int64_t file_index;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kFileIndex, &file_index));
+      next_file_index_ = static_cast<size_t>(file_index);
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kOffset, &next_offset_));
+      return absl::OkStatus();
+    }
+
+   private:
+    void CancelThreads(bool wait) TF_LOCKS_EXCLUDED(mu_) {
+      mutex_lock l(mu_);
+      cancelled_ = true;
+      cond_var_.notify_all();
+      // Wait for all in-flight calls to complete.
+      while (wait && num_calls_ > 0) {
+        cond_var_.wait(l);
+      }
+    }
+
+    void EnsureThreadsStarted(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!reader_thread_) {
+        auto ctx_copy = std::make_shared<IteratorContext>(*ctx);
+        reader_thread_ = ctx->StartThread(
+            "tf_data_parallel_csv",
+            [this, ctx_copy, file_index = next_file_index_,
+             offset = next_offset_]() {
+              ReaderThread(ctx_copy, file_index, offset);
+            });
+      }
+    }
+
+    // Splits the files into chunks, starting at `offset` in file
+    // `file_index`, and schedules their parsing.
+    void ReaderThread(const std::shared_ptr<IteratorContext>& ctx,
+                      size_t file_index, int64_t offset)
+        TF_LOCKS_EXCLUDED(mu_) {
+      RecordStart(ctx.get());
+      auto cleanup = gtl::MakeCleanup([this, ctx] {
+        RecordStop(ctx.get());
+        mutex_lock l(mu_);
+        reader_finished_ = true;
+        cond_var_.notify_all();
+      });
+      for (; file_index < dataset()->filenames_.size();
+           ++file_index, offset = 0) {
+        if (!ReadFile(ctx, file_index, offset)) {
+          return;
+        }
+      }
+    }
+
+    // Splits file `file_index`, from `offset` on, into chunks that end at
+    // record boundaries. Returns false if the iterator was cancelled.
+    bool ReadFile(const std::shared_ptr<IteratorContext>& ctx,
+                  size_t file_index, int64_t offset) TF_LOCKS_EXCLUDED(mu_) {
+      auto new_chunk = [file_index, &offset]() {
+        auto chunk = std::make_shared<Chunk>();
+        chunk->file_index = file_index;
+        chunk->start_offset = offset;
+        return chunk;
+      };
+      // Reports `status` in place of the rest of the file.
+      auto fail = [&](absl::Status status) {
+        std::shared_ptr<Chunk> chunk = new_chunk();
+        chunk->end_of_file = true;
+        chunk->status = std::move(status);
+        return Schedule(ctx, std::move(chunk));
+      };
+
+      std::unique_ptr<RandomAccessFile> file;
+      absl::Status s = ctx->env()->NewRandomAccessFile(
+          dataset()->filenames_[file_index], &file);
+      if (!s.ok()) {
+        return fail(std::move(s));
+      }
+      io::RandomAccessInputStream file_stream(file.get());
+      std::unique_ptr<io::ZlibInputStream> zlib_stream;
+      io::InputStreamInterface* stream = &file_stream;
+      const int64_t buffer_size = dataset()->options_.input_buffer_size;
+      if (dataset()->use_compression_) {
+        zlib_stream = std::make_unique<io::ZlibInputStream>(
+            &file_stream, buffer_size, buffer_size, dataset()->options_);
+        stream = zlib_stream.get();
+      }
+      if (offset > 0) {
+        s = stream->SkipNBytes(offset);
+        if (!s.ok() && !absl::IsOutOfRange(s)) {
+          return fail(std::move(s));
+        }
+      }
+
+      bool skip_header = dataset()->header_ && offset == 0;
+      // Bytes read past the end of the last chunk.
+      std::string pending;
+      CsvRecordEndFinder record_end_finder(dataset()->delim_,
+                                           dataset()->use_quote_delim_);
+      bool end_of_file = false;
+      while (!end_of_file) {
+        tstring block;
+        s = stream->ReadNBytes(buffer_size, &block);
+        if (absl::IsOutOfRange(s)) {
+          end_of_file = true;
+        } else if (!s.ok()) {
+          return fail(std::move(s));
+        }
+        pending.append(block.data(), block.size());
+        size_t end = end_of_file ? pending.size()
+                                 : record_end_finder.FindLastRecordEnd(pending);
+        if (end == 0 && !end_of_file) {
+          // The first record continues past the end of what we read.
+          continue;
+        }
+        if (!end_of_file) {
+          // The first `end` bytes of `pending` go to the chunk.
+          record_end_finder.Consume(end);
+        }
+        if (skip_header) {
+          // `pending` starts with the whole header.
+          size_t header_end;
+          if (!SkipHeader(pending, &header_end)) {
+            return fail(
+                absl::InvalidArgumentError("Can't read header of file"));
+          }
+          pending.erase(0, header_end);
+          offset += header_end;
+          end -= header_end;
+          skip_header = false;
+        }
+        std::shared_ptr<Chunk> chunk = new_chunk();
+        chunk->end_of_file = end_of_file;
+        if (end == pending.size()) {
+          chunk->data = std::move(pending);
+          pending.clear();
+        } else {
+          chunk->data.assign(pending, 0, end);
+          pending.erase(0, end);
+        }
+        offset += end;
+        if (!Schedule(ctx, std::move(chunk))) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // Parses the header at the start of `data`. Returns false if it is
+    // missing or malformed, and sets `header_end` otherwise.
+    bool SkipHeader(absl::string_view data, size_t* header_end) const {
+      CsvRecordParser parser(data, dataset()->delim_,
+                             dataset()->use_quote_delim_);
+      if (parser.Done()) {
+        return false;
+      }
+      CsvRecordParser::Field field;
+      do {
+        field = parser.NextField();
+        if (!field.status.ok()) {
+          return false;
+        }
+      } while (!field.end_of_record);
+      *header_end = parser.position();
+      return true;
+    }
+
+    // Waits for room in `chunks_`, then adds `chunk` and schedules its
+    // parsing. Returns false if the iterator was cancelled.
+    bool Schedule(const std::shared_ptr<IteratorContext>& ctx,
+                  std::shared_ptr<Chunk> chunk) TF_LOCKS_EXCLUDED(mu_) {
+      {
+        mutex_lock l(mu_);
+        // Parsed chunks stay in `chunks_` until they are consumed: allow for
+        // as many as are being parsed, so that parsing does not stall on the
+        // consumer.
+        while (!cancelled_ && (num_calls_ >= num_parallel_calls_ ||
+                               chunks_.size() >= 2 * num_parallel_calls_)) {
+          RecordStop(ctx.get());
+          cond_var_.wait(l);
+          RecordStart(ctx.get());
+        }
+        if (cancelled_) {
+          return false;
+        }
+        chunks_.push_back(chunk);
+        if (chunk->data.empty()) {
+          chunk->done = true;
+          cond_var_.notify_all();
+          return true;
+        }
+        ++num_calls_;
+      }
+      (*ctx->runner())([this, ctx, chunk = std::move(chunk)]() {
+        // Check whether we are already recording to prevent invalid nesting
+        // of `RecordStart` calls.
+        const bool is_recording = IsRecording(ctx.get());
+        if (!is_recording) RecordStart(ctx.get());
+        ParseChunk(ctx.get(), chunk.get());
+        if (!is_recording) RecordStop(ctx.get());
+        mutex_lock l(mu_);
+        chunk->done = true;
+        --num_calls_;
+        cond_var_.notify_all();
+      });
+      return true;
+    }
+
+    // Parses the records of `chunk`. Fields are split first, and then
+    // converted one output column at a time.
+    void ParseChunk(IteratorContext* ctx, Chunk* chunk) const {
+      const size_t num_columns = dataset()->output_types_.size();
+      const std::vector<int64_t>& selected = dataset()->select_cols_;
+      const std::vector<int64_t>& excluded = dataset()->exclude_cols_;
+      const bool select_all = selected.empty() && excluded.empty();
+
+      CsvRecordParser parser(chunk->data, dataset()->delim_,
+                             dataset()->use_quote_delim_);
+      std::vector<ParsedRecord>& records = chunk->records;
+      std::vector<absl::string_view> fields;
+      // Holds the fields with escaped quotes, once unescaped.
+      std::deque<std::string> unescaped_fields;
+      while (!parser.Done()) {
+        ParsedRecord& record = records.emplace_back();
+        fields.resize(fields.size() + num_columns);
+        absl::string_view* record_fields = &fields[fields.size() - num_columns];
+        auto update_status = [&record](absl::Status status, size_t column) {
+          if (record.status.ok()) {
+            record.status = std::move(status);
+            record.error_column = column;
+          }
+        };
+        size_t num_parsed = 0;
+        size_t num_selected_parsed = 0;
+        size_t num_excluded_parsed = 0;
+        size_t num_included = 0;
+        CsvRecordParser::Field field;
+        do {
+          field = parser.NextField();
+          const bool explicit_exclude =
+              num_excluded_parsed < excluded.size() &&
+              excluded[num_excluded_parsed] == num_parsed;
+          const bool include = select_all ||
+                               (num_selected_parsed < selected.size() &&
+                                selected[num_selected_parsed] == num_parsed) ||
+                               (!excluded.empty() && !explicit_exclude);
+          if (!field.status.ok()) {
+            update_status(field.status, num_included);
+          }
+          if (include) {
+            if (num_included < num_columns) {
+              record_fields[num_included] =
+                  field.has_escaped_quotes
+                      ? unescaped_fields.emplace_back(
+                            CsvRecordParser::Unescape(field.value))
+                      : field.value;
+            } else {
+              update_status(absl::InvalidArgumentError(absl::StrCat(
+                                "Expect ", num_columns,
+                                " fields but have more in record")),
+                            num_columns);
+            }
+            ++num_included;
+            ++num_selected_parsed;
+          }
+          if (explicit_exclude) ++num_excluded_parsed;
+          ++num_parsed;
+        } while (!field.end_of_record);
+        if (num_included < num_columns) {
+          update_status(absl::InvalidArgumentError(
+                            absl::StrCat("Expect ", num_columns,
+                                         " fields but have ", num_included,
+                                         " in record")),
+                        num_included);
+        }
+        record.value.resize(num_columns);
+        record.end_offset = chunk->start_offset + parser.position();
+      }
+
+      Allocator* allocator = ctx->allocator({});
+      const absl::string_view na_value = dataset()->na_value_;
+      for (size_t column = 0; column < num_columns; ++column) {
+        const DataType dtype = dataset()->output_types_[column];
+        const Tensor& record_default = dataset()->record_defaults_[column];
+        switch (dtype) {
+          case DT_INT32:
+            ConvertColumn<int32_t>(
+                column, num_columns, dtype, "int32",
+                [](absl::string_view s, int32_t* v) {
+                  return absl::SimpleAtoi(s, v);
+                },
+                record_default, na_value, allocator, fields, &records);
+            break;
+          case DT_INT64:
+            ConvertColumn<int64_t>(
+                column, num_columns, dtype, "int64",
+                [](absl::string_view s, int64_t* v) {
+                  return absl::SimpleAtoi(s, v);
+                },
+                record_default, na_value, allocator, fields, &records);
+            break;
+          case DT_FLOAT:
+            ConvertColumn<float>(
+                column, num_columns, dtype, "float",
+                [](absl::string_view s, float* v) {
+                  return absl::SimpleAtof(s, v);
+                },
+                record_default, na_value, allocator, fields, &records);
+            break;
+          case DT_DOUBLE:
+            ConvertColumn<double>(
+                column, num_columns, dtype, "double",
+                [](absl::string_view s, double* v) {
+                  return absl::SimpleAtod(s, v);
+                },
+                record_default, na_value, allocator, fields, &records);
+            break;
+          case DT_STRING:
+            ConvertColumn<tstring>(
+                column, num_columns, dtype, "string",
+                [](absl::string_view s, tstring* v) {
+                  v->assign(s.data(), s.size());
+                  return true;
+                },
+                record_default, na_value, allocator, fields, &records);
+            break;
+          default:
+            for (ParsedRecord& record : records) {
+              if (record.status.ok() || column < record.error_column) {
+                record.status = absl::InvalidArgumentError(
+                    absl::StrCat("csv: data type ", dtype,
+                                 " not supported in field ", column));
+                record.error_column = column;
+              }
+            }
+        }
+      }
+      // The records no longer refer to the data of the chunk.
+      chunk->data = std::string();
+    }
+
+    mutex mu_;
+    condition_variable cond_var_;
+    int64_t num_parallel_calls_ TF_GUARDED_BY(mu_) = 0;
+    // The chunks being parsed or consumed, in file order.
+    std::deque<std::shared_ptr<Chunk>> chunks_ TF_GUARDED_BY(mu_);
+    // The index of the next record of `chunks_.front()` to consume.
+    size_t next_record_ TF_GUARDED_BY(mu_) = 0;
+    // The position of the next record to consume, i.e. the iterator state.
+    size_t next_file_index_ TF_GUARDED_BY(mu_) = 0;
+    int64_t next_offset_ TF_GUARDED_BY(mu_) = 0;
+    int64_t num_calls_ TF_GUARDED_BY(mu_) = 0;
+    bool reader_finished_ TF_GUARDED_BY(mu_) = false;
+    bool cancelled_ TF_GUARDED_BY(mu_) = false;
+    std::function<void()> deregister_fn_;
+    // Must be destroyed first, as it joins the reader thread.
+    std::unique_ptr<Thread> reader_thread_ TF_GUARDED_BY(mu_);
+  };
+
+  const std::vector<std::string> filenames_;
+  const bool header_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+  const std::vector<Tensor> record_defaults_;
+  const std::vector<int64_t> select_cols_;
+  const std::vector<int64_t> exclude_cols_;
+  const bool use_quote_delim_;
+  const char delim_;
+  const tstring na_value_;
+  const int64_t num_parallel_calls_;
+  const bool use_compression_;
+  const tstring compression_type_;
+  const io::ZlibCompressionOptions options_;
+};
+
+ParallelCSVDatasetOp::ParallelCSVDatasetOp(OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+}
+
+void ParallelCSVDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                       DatasetBase** output) {
+  const Tensor* filenames_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kFilenames, &filenames_tensor));
+  OP_REQUIRES(
+      ctx, filenames_tensor->dims() <= 1,
+      absl::InvalidArgumentError("`filenames` must be a scalar or a vector."));
+  std::vector<std::string> filenames;
+  filenames.reserve(filenames_tensor->NumElements());
+  for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+    filenames.push_back(filenames_tensor->flat<tstring>()(i));
+  }
+
+  tstring compression_type;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<tstring>(ctx, kCompressionType,
+                                                   &compression_type));
+
+  OpInputList record_defaults_list;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kRecordDefaults, &record_defaults_list));
+  std::vector<Tensor> record_defaults;
+  record_defaults.reserve(record_defaults_list.size());
+  for (int i = 0; i < record_defaults_list.size(); ++i) {
+    OP_REQUIRES(ctx, record_defaults_list[i].dims() <= 1,
+                absl::InvalidArgumentError(
+                    "Each record default should be at most rank 1"));
+    OP_REQUIRES(ctx, record_defaults_list[i].NumElements() < 2,
+                absl::InvalidArgumentError(absl::StrCat(
+                    "There should only be 1 default per field but field ", i,
+                    " has ", record_defaults_list[i].NumElements())));
+    record_defaults.push_back(record_defaults_list[i]);
+  }
+
+  const Tensor* select_cols_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kSelectCols, &select_cols_tensor));
+  OP_REQUIRES(ctx, select_cols_tensor->dims() == 1,
+              absl::InvalidArgumentError("`select_cols` must be a vector."));
+  std::vector<int64_t> select_cols;
+  select_cols.reserve(select_cols_tensor->NumElements());
+  for (int i = 0; i < select_cols_tensor->NumElements(); ++i) {
+    select_cols.push_back(select_cols_tensor->flat<int64_t>()(i));
+  }
+  OP_REQUIRES(
+      ctx, output_types_.size() == select_cols.size() || select_cols.empty(),
+      absl::InvalidArgumentError("select_cols should match output size"));
+  for (int i = 1; i < select_cols.size(); i++) {
+    OP_REQUIRES(ctx, select_cols[i - 1] < select_cols[i],
+                absl::InvalidArgumentError(
+                    "select_cols should be strictly increasing indices"));
+  }
+  OP_REQUIRES(
+      ctx, select_cols.empty() || select_cols.front() >= 0,
+      absl::InvalidArgumentError("select_cols should be non-negative indices"));
+
+  const Tensor* exclude_cols_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kExcludeCols, &exclude_cols_tensor));
+  OP_REQUIRES(ctx, exclude_cols_tensor->dims() == 1,
+              absl::InvalidArgumentError("`exclude_cols` must be a vector"));
+  std::vector<int64_t> exclude_cols;
+  exclude_cols.reserve(exclude_cols_tensor->NumElements());
+  for (int i = 0; i < exclude_cols_tensor->NumElements(); ++i) {
+    exclude_cols.push_back(exclude_cols_tensor->flat<int64_t>()(i));
+  }
+  OP_REQUIRES(ctx, select_cols.empty() || exclude_cols.empty(),
+              absl::InvalidArgumentError(
+                  "Either select_cols or exclude_cols should be empty"));
+  for (int i = 1; i < exclude_cols.size(); i++) {
+    OP_REQUIRES(ctx, exclude_cols[i - 1] < exclude_cols[i],
+                absl::InvalidArgumentError(
+                    "exclude_cols should be strictly increasing indices"));
+  }
+  OP_REQUIRES(ctx, exclude_cols.empty() || exclude_cols.front() >= 0,
+              absl::InvalidArgumentError(
+                  "exclude_cols should be non-negative indices"));
+
+  int64_t buffer_size = 0;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64_t>(ctx, kBufferSize, &buffer_size));
+  OP_REQUIRES(ctx, buffer_size > 0,
+              absl::InvalidArgumentError("buffer_size should be positive"));
+
+  tstring delim;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<tstring>(ctx, kFieldDelim, &delim));
+  OP_REQUIRES(ctx, delim.size() == 1,
+              absl::InvalidArgumentError("field_delim should be only 1 char"));
+
+  bool header;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<bool>(ctx, kHeader, &header));
+
+  bool use_quote_delim;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<bool>(ctx, kUseQuoteDelim,
+                                                &use_quote_delim));
+  tstring na_value;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<tstring>(ctx, kNaValue, &na_value));
+
+  int64_t num_parallel_calls = 0;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kNumParallelCalls,
+                                                   &num_parallel_calls));
+  OP_REQUIRES(ctx,
+              num_parallel_calls > 0 ||
+                  num_parallel_calls == model::kAutotune,
+              absl::InvalidArgumentError(
+                  "`num_parallel_calls` must be greater than zero."));
+
+  io::ZlibCompressionOptions zlib_compression_options =
+      io::ZlibCompressionOptions::DEFAULT();
+  if (compression_type == "GZIP") {
+    zlib_compression_options = io::ZlibCompressionOptions::GZIP();
+  } else {
+    OP_REQUIRES(ctx, compression_type.empty() || compression_type == "ZLIB",
+                absl::InvalidArgumentError(absl::StrCat(
+                    "Unsupported compression_type: ", compression_type, ".")));
+  }
+  zlib_compression_options.input_buffer_size = buffer_size;
+
+  *output = new Dataset(ctx, std::move(filenames), header,
+                        std::move(compression_type), zlib_compression_options,
+                        output_types_, output_shapes_,
+                        std::move(record_defaults), std::move(select_cols),
+                        std::move(exclude_cols), use_quote_delim, delim[0],
+                        std::move(na_value), num_parallel_calls);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("ParallelCSVDataset").Device(DEVICE_CPU),
+                        ParallelCSVDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
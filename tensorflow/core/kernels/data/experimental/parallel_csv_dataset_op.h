@@ -0,0 +1,61 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_PARALLEL_CSV_DATASET_OP_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_PARALLEL_CSV_DATASET_OP_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/dataset.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Reads the same records as `CSVDatasetV2`, in the same order, but splits each
+// file into chunks of whole records and parses up to `num_parallel_calls`
+// chunks at a time.
+class ParallelCSVDatasetOp : public DatasetOpKernel {
+ public:
+  static constexpr const char* const kDatasetType = "ParallelCSV";
+  static constexpr const char* const kFilenames = "filenames";
+  static constexpr const char* const kCompressionType = "compression_type";
+  static constexpr const char* const kBufferSize = "buffer_size";
+  static constexpr const char* const kHeader = "header";
+  static constexpr const char* const kFieldDelim = "field_delim";
+  static constexpr const char* const kUseQuoteDelim = "use_quote_delim";
+  static constexpr const char* const kNaValue = "na_value";
+  static constexpr const char* const kSelectCols = "select_cols";
+  static constexpr const char* const kRecordDefaults = "record_defaults";
+  static constexpr const char* const kExcludeCols = "exclude_cols";
+  static constexpr const char* const kNumParallelCalls = "num_parallel_calls";
+  static constexpr const char* const kOutputTypes = "output_types";
+  static constexpr const char* const kOutputShapes = "output_shapes";
+
+  explicit ParallelCSVDatasetOp(OpKernelConstruction* ctx);
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override;
+
+ private:
+  class Dataset;
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_PARALLEL_CSV_DATASET_OP_H_
@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "absl/log/log.h"
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/prefetch_memory_arbiter.h"
 #include "tensorflow/core/framework/model.h"
 
 namespace tensorflow {
@@ -29,9 +30,11 @@ namespace data {
 
 PrefetchAutotuner::PrefetchAutotuner(
     int64_t initial_buffer_size, int64_t buffer_size_min,
-    std::shared_ptr<model::RamBudgetManager> ram_budget_manager)
+    std::shared_ptr<model::RamBudgetManager> ram_budget_manager,
+    PrefetchMemoryArbiter::TrackedBuffer* tracked_buffer)
     : buffer_limit_(initial_buffer_size),
-      ram_budget_manager_(ram_budget_manager) {
+      ram_budget_manager_(ram_budget_manager),
+      tracked_buffer_(tracked_buffer) {
   if (initial_buffer_size == model::kAutotune) {
     mode_ = Mode::kUpswing;
     buffer_limit_ = std::max(int64_t{1}, buffer_size_min);
@@ -96,9 +99,14 @@ void PrefetchAutotuner::RecordConsumption(size_t current_buffer_size) {
         // the buffer size without checking available RAM
         // to match the legacy behavior before RamBudgetManager is introduced.
         // Otherwise, ask the `ram_budget_manager_` if there is enough memory to
-        // allocate. If not, abort this optimization attempt
-        if (!ram_budget_manager_ ||
-            ram_budget_manager_->RequestLegacyPrefetchBytes(delta_bytes)) {
+        // allocate. If not, abort this optimization attempt. The same holds
+        // for the process-wide prefetch memory arbiter.
+        if (tracked_buffer_ && !tracked_buffer_->RequestGrowth(delta_bytes)) {
+          VLOG(2) << "Prefetch memory arbiter denied growing the buffer limit "
+                  << "to " << attempt_new_buffer_limit << " elements.";
+        } else if (!ram_budget_manager_ ||
+                   ram_budget_manager_->RequestLegacyPrefetchBytes(
+                       delta_bytes)) {
           // Overwrite the current limit
           buffer_limit_ = attempt_new_buffer_limit;
         }
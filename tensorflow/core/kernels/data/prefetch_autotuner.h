@@ -20,6 +20,7 @@ limitations under the License.
 #include <memory>
 #include <optional>
 
+#include "tensorflow/core/data/prefetch_memory_arbiter.h"
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -39,14 +40,16 @@ namespace data {
 // current size.
 //
 // Note: in the current implementation, we never decrease the buffer_limit().
-// This should change in the future!
+// This should change in the future! If `tracked_buffer` is set, the buffer
+// limit only grows while the process-wide `PrefetchMemoryArbiter` has headroom.
 //
 // PrefetchAutotuner is NOT thread safe.
 class PrefetchAutotuner {
  public:
   explicit PrefetchAutotuner(
       int64_t initial_buffer_size, int64_t buffer_size_min,
-      std::shared_ptr<model::RamBudgetManager> ram_budget_manager);
+      std::shared_ptr<model::RamBudgetManager> ram_budget_manager,
+      PrefetchMemoryArbiter::TrackedBuffer* tracked_buffer = nullptr);
 
   int64_t buffer_limit() const { return buffer_limit_; }
 
@@ -78,6 +81,8 @@ class PrefetchAutotuner {
   std::optional<int64_t> element_size_bytes_;
   Mode mode_ = Mode::kDisabled;
   std::shared_ptr<model::RamBudgetManager> ram_budget_manager_;
+  // Not owned.
+  PrefetchMemoryArbiter::TrackedBuffer* const tracked_buffer_;
 };
 
 }  // namespace data
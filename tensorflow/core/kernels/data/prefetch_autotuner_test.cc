@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <vector>
 
+#include "tensorflow/core/data/prefetch_memory_arbiter.h"
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -158,6 +159,25 @@ TEST(PrefetchAutotuner, RespectRamManagerWhenThereIsModelAllocation) {
   EXPECT_EQ(16, t.buffer_limit());
 }
 
+TEST(PrefetchAutotuner, RespectPrefetchMemoryArbiter) {
+  PrefetchMemoryArbiter arbiter(/*limit_bytes=*/1000);
+  auto tracked_buffer = arbiter.Register("prefetch");
+  tracked_buffer->SetBufferedBytes(700);
+  PrefetchAutotuner t(model::kAutotune, 2, /*ram_budget_manager=*/nullptr,
+                      tracked_buffer.get());
+  t.SetElementSize(50);
+  EXPECT_EQ(2, t.buffer_limit());
+  // Buffer can grow once since 700 + 2*50 <= 0.8 * 1000.
+  t.RecordConsumption(2);
+  t.RecordConsumption(0);
+  EXPECT_EQ(4, t.buffer_limit());
+  // Buffer is not allowed to grow again since 700 + 4*50 > 0.8 * 1000.
+  t.RecordConsumption(4);
+  t.RecordConsumption(0);
+  EXPECT_EQ(4, t.buffer_limit());
+  EXPECT_EQ(1, arbiter.GetStats().num_denied_growths);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
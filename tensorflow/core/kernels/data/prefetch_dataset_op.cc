@@ -34,6 +34,7 @@ limitations under the License.
 #include "absl/strings/str_join.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/prefetch_memory_arbiter.h"
 #include "tensorflow/core/data/stats_utils.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -192,9 +193,11 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
 
     absl::Status Initialize(IteratorContext* ctx) override {
       mutex_lock l(*mu_);
+      tracked_buffer_ =
+          PrefetchMemoryArbiter::Global().Register(dataset()->node_name());
       auto_tuner_ = std::make_unique<PrefetchAutotuner>(
           dataset()->buffer_size_, dataset()->buffer_size_min_,
-          ctx->ram_budget_manager());
+          ctx->ram_budget_manager(), tracked_buffer_.get());
       interleave_depth_ = ctx->interleave_depth();
 
       if (buffer_size_->value == model::kAutotune) {
@@ -225,8 +228,12 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         TF_RETURN_IF_ERROR(EnsureThreadsStarted(ctx));
         // Wait until the next element in the buffer has been
         // produced, or we are shutting down.
+        int64_t wait_start_us = 0;
         while (buffer_.empty() && !prefetch_thread_finished_ &&
                buffer_limit() != 0) {
+          if (wait_start_us == 0) {
+            wait_start_us = EnvTime::NowMicros();
+          }
           if (legacy_autotune_) {
             auto_tuner_->RecordEmpty();
             buffer_size_->value = auto_tuner_->buffer_limit();
@@ -237,6 +244,8 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         }
 
         if (!buffer_.empty()) {
+          tracked_buffer_->RecordConsumerWait(
+              wait_start_us == 0 ? 0 : EnvTime::NowMicros() - wait_start_us);
           return Consume(ctx, out_tensors, end_of_sequence);
         }
 
@@ -382,6 +391,8 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       // The buffered data element.
       std::vector<Tensor> value;
       int64_t created_us;
+      // Bytes allocated by the tensors of `value`.
+      int64_t allocated_bytes = 0;
       const uint64_t uid;
       MemoryCheckpoint checkpoint;
     };
@@ -419,7 +430,11 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
           }
         }
         RecordBufferEnqueue(ctx, buffer_element.value);
+        buffer_element.allocated_bytes =
+            GetAllocatedBytes(buffer_element.value);
+        buffered_bytes_ += buffer_element.allocated_bytes;
       }
+      tracked_buffer_->SetBufferedBytes(buffered_bytes_);
       return absl::OkStatus();
     }
 
@@ -520,6 +535,8 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         auto_tuner_->RecordConsumption(buffer_.size());
         buffer_size_->value = auto_tuner_->buffer_limit();
       }
+      buffered_bytes_ -= buffer_.front().allocated_bytes;
+      tracked_buffer_->SetBufferedBytes(buffered_bytes_);
       buffer_.pop_front();
 
       metrics::RecordTFDataPrefetchDequeue(dataset()->node_name());
@@ -556,10 +573,12 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       // Keep track of where we are in an iteration "burst"
       int num_produced = 0;
       while (true) {
-        // 1. Wait for a slot in the buffer.
+        // 1. Wait for a slot in the buffer, and for the process-wide prefetch
+        // memory arbiter to allow the buffer to hold another element.
         {
           mutex_lock l(*mu_);
-          while (!cancelled_ && buffer_.size() >= buffer_limit()) {
+          while (!cancelled_ && (buffer_.size() >= buffer_limit() ||
+                                 !tracked_buffer_->MayProduce())) {
             RecordStop(ctx.get());
             cond_var_->wait(l);
             RecordStart(ctx.get());
@@ -607,10 +626,14 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         }
 
         // 3. Signal that the element has been produced.
+        buffer_element.allocated_bytes =
+            GetAllocatedBytes(buffer_element.value);
         {
           mutex_lock l(*mu_);
           RecordBufferEnqueue(ctx.get(), buffer_element.value);
           buffer_element.created_us = EnvTime::NowMicros();
+          buffered_bytes_ += buffer_element.allocated_bytes;
+          tracked_buffer_->SetBufferedBytes(buffered_bytes_);
           buffer_.push_back(std::move(buffer_element));
 
           metrics::RecordTFDataPrefetchEnqueue(dataset()->node_name());
@@ -678,8 +701,14 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(input_mu_);
     const std::shared_ptr<condition_variable> cond_var_;
     const int64_t buffer_size_min_;
+    // Registration with the process-wide prefetch memory arbiter. Must outlive
+    // `auto_tuner_` and `prefetch_thread_`.
+    std::unique_ptr<PrefetchMemoryArbiter::TrackedBuffer> tracked_buffer_
+        TF_GUARDED_BY(*mu_);
     std::unique_ptr<PrefetchAutotuner> auto_tuner_ TF_GUARDED_BY(*mu_);
     std::deque<BufferElement> buffer_ TF_GUARDED_BY(*mu_);
+    // Total bytes allocated by the elements in `buffer_`.
+    int64_t buffered_bytes_ TF_GUARDED_BY(*mu_) = 0;
     bool cancelled_ TF_GUARDED_BY(*mu_) = false;
     bool prefetch_thread_finished_ TF_GUARDED_BY(*mu_) = false;
     const bool legacy_autotune_;
@@ -25,10 +25,12 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/element_spill_store.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -57,6 +59,9 @@ namespace data {
 /* static */ constexpr const char* const ShuffleDatasetOpBase::kOutputShapes;
 /* static */ constexpr const char* const
     ShuffleDatasetOpBase::kReshuffleEachIteration;
+/* static */ constexpr const char* const
+    ShuffleDatasetOpBase::kSpillThresholdBytes;
+/* static */ constexpr const char* const ShuffleDatasetOpBase::kSpillDirectory;
 
 /* static */ constexpr const char* const ShuffleDatasetOp::kDatasetType;
 
@@ -85,7 +90,20 @@ constexpr char kShuffleAndRepeatDatasetV1[] = "ShuffleAndRepeatDataset";
 constexpr char kShuffleAndRepeatDatasetV2[] = "ShuffleAndRepeatDatasetV2";
 
 ShuffleDatasetOpBase::ShuffleDatasetOpBase(OpKernelConstruction* ctx)
-    : UnaryDatasetOpKernel(ctx) {}
+    : UnaryDatasetOpKernel(ctx) {
+  if (ctx->HasAttr(kSpillThresholdBytes)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kSpillThresholdBytes,
+                                     &spill_options_.threshold_bytes));
+    OP_REQUIRES(ctx, spill_options_.threshold_bytes >= 0,
+                absl::InvalidArgumentError(absl::StrCat(
+                    kSpillThresholdBytes, " must be non-negative, got ",
+                    spill_options_.threshold_bytes)));
+  }
+  if (ctx->HasAttr(kSpillDirectory)) {
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr(kSpillDirectory, &spill_options_.directory));
+  }
+}
 
 // Abstract base dataset that implements a shuffling iterator.
 class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
@@ -93,12 +111,13 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   ShuffleDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
                      int64_t buffer_size,
                      std::shared_ptr<SeedGenerator> seed_generator,
-                     int64_t count)
+                     int64_t count, SpillOptions spill_options = {})
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         buffer_size_(buffer_size),
         seed_generator_(std::move(seed_generator)),
         count_(count),
+        spill_options_(std::move(spill_options)),
         traceme_metadata_(
             {{"buffer_size",
               absl::StrFormat("%lld", static_cast<long long>(buffer_size))}}) {
@@ -169,6 +188,21 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         seed_generator_.get());
   }
 
+  // Appends the spill attrs to `attrs` if spilling is enabled. They are
+  // omitted otherwise, so that graphs of datasets that do not spill are
+  // unchanged.
+  void AddSpillAttrs(
+      DatasetGraphDefBuilder* b,
+      std::vector<std::pair<absl::string_view, AttrValue>>* attrs) const {
+    if (spill_options_.threshold_bytes == 0) return;
+    AttrValue threshold_bytes;
+    b->BuildAttrValue(spill_options_.threshold_bytes, &threshold_bytes);
+    attrs->emplace_back(kSpillThresholdBytes, threshold_bytes);
+    AttrValue directory;
+    b->BuildAttrValue(spill_options_.directory, &directory);
+    attrs->emplace_back(kSpillDirectory, directory);
+  }
+
   void InitializeRandomAccessIndices() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     const int64_t cardinality = Cardinality();
     shuffled_indices_ = std::vector<std::int64_t>(cardinality);
@@ -237,12 +271,18 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       int64_t offset =
           Random() % (slices_.front()->end - slices_.front()->start);
       int64_t index = (slices_.front()->start + offset) % buffer_->size();
-      *out_tensors = std::move(buffer_->at(index));
-      this->RecordBufferDequeue(ctx, *out_tensors);
-      std::swap(buffer_->at(index),
-                buffer_->at(slices_.front()->start % buffer_->size()));
+      int64_t start = slices_.front()->start % buffer_->size();
+      TF_RETURN_IF_ERROR(TakeFromBuffer(ctx, index, out_tensors));
+      std::swap(buffer_->at(index), buffer_->at(start));
+      auto it = spilled_.find(start);
+      if (it != spilled_.end()) {
+        // `index` is no longer spilled, as its element was just taken.
+        ElementSpillStore::Location location = it->second;
+        spilled_.erase(it);
+        spilled_[index] = location;
+      }
       checkpoint_indices_.insert(index);
-      checkpoint_indices_.insert(slices_.front()->start % buffer_->size());
+      checkpoint_indices_.insert(start);
       slices_.front()->start++;
       num_elements_--;
       return absl::OkStatus();
@@ -288,17 +328,21 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(prefix(), kNumElements, num_elements_));
       const std::string key_prefix = absl::StrCat(prefix(), kColon, "buffer");
+      TF_RETURN_IF_ERROR(
+          WriteNumElementsToCheckpoint(writer, key_prefix, buffer_->size()));
       if (ctx->symbolic_checkpoint()) {
         // When symbolic checkpointing is turned on, `writer`
         // already contains checkpoint of the shuffle buffer created by the
         // previous invocation of this instance and the indices that need to be
         // updated are stored in `checkpoint_indices`.
-        TF_RETURN_IF_ERROR(UpdateCheckpointElements(
-            writer, key_prefix, *buffer_, checkpoint_indices_));
+        for (int64_t index : checkpoint_indices_) {
+          TF_RETURN_IF_ERROR(WriteBufferElement(writer, key_prefix, index));
+        }
         checkpoint_indices_.clear();
       } else {
-        TF_RETURN_IF_ERROR(
-            WriteElementsToCheckpoint(writer, key_prefix, *buffer_));
+        for (int64_t index = 0; index < buffer_->size(); ++index) {
+          TF_RETURN_IF_ERROR(WriteBufferElement(writer, key_prefix, index));
+        }
       }
 
       TF_RETURN_IF_ERROR(
@@ -366,19 +410,29 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         }
         slices_size = static_cast<size_t>(temp);
       }
-      buffer_ = std::make_unique<std::vector<std::vector<Tensor>>>();
-      TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
-          ctx, reader, absl::StrCat(prefix(), kColon, "buffer"),
-          buffer_.get()));
+      const std::string key_prefix = absl::StrCat(prefix(), kColon, "buffer");
+      int64_t num_buffered;
+      TF_RETURN_IF_ERROR(
+          ReadNumElementsFromCheckpoint(reader, key_prefix, &num_buffered));
+      spill_store_.reset();
+      spilled_.clear();
+      resident_bytes_ = 0;
+      // Elements are restored one at a time, so that those beyond the spill
+      // threshold go straight to `spill_store_`.
+      buffer_ =
+          std::make_unique<std::vector<std::vector<Tensor>>>(num_buffered);
+      for (int64_t i = 0; i < num_buffered; ++i) {
+        std::vector<Tensor> element;
+        TF_RETURN_IF_ERROR(
+            ReadElementFromCheckpoint(ctx, reader, key_prefix, i, &element));
+        TF_RETURN_IF_ERROR(PutInBuffer(ctx, i, std::move(element)));
+      }
       if (ctx->symbolic_checkpoint()) {
         DCHECK(checkpoint_indices_.empty());
         for (size_t i = 0; i < buffer_->size(); ++i) {
           checkpoint_indices_.insert(i);
         }
       }
-      for (const auto& element : *buffer_) {
-        RecordBufferEnqueue(ctx, element);
-      }
       if (!IsShuffleAll()) {
         buffer_->resize(dataset()->buffer_size_);
       }
@@ -478,7 +532,8 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
           slices_.back()->reached_end_of_sequence = true;
         }
         if (!end_of_input_sequence) {
-          AddToShuffleBuffer(ctx, std::move(input_element));
+          TF_RETURN_IF_ERROR(
+              AddToShuffleBuffer(ctx, std::move(input_element)));
           continue;
         }
         input_impl_.reset();
@@ -535,25 +590,88 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       return absl::OkStatus();
     }
 
-    void AddToShuffleBuffer(IteratorContext* ctx, std::vector<Tensor>&& element)
+    absl::Status AddToShuffleBuffer(IteratorContext* ctx,
+                                    std::vector<Tensor>&& element)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       data_produced_ = true;
       if (num_elements_ == 0) {
         VLOG(1) << "Starting to fill up shuffle buffer of size: "
                 << BufferSizeString();
       }
-      this->RecordBufferEnqueue(ctx, element);
+      size_t index;
       if (num_elements_ == buffer_->size()) {
         DCHECK(IsShuffleAll());
-        checkpoint_indices_.insert(buffer_->size());
-        buffer_->push_back(element);
+        index = buffer_->size();
+        buffer_->emplace_back();
       } else {
-        size_t index = slices_.back()->end % buffer_->size();
-        checkpoint_indices_.insert(index);
-        buffer_->at(index) = std::move(element);
+        index = slices_.back()->end % buffer_->size();
       }
+      checkpoint_indices_.insert(index);
+      TF_RETURN_IF_ERROR(PutInBuffer(ctx, index, std::move(element)));
       num_elements_++;
       slices_.back()->end++;
+      return absl::OkStatus();
+    }
+
+    // Stores `element` at `index` of `buffer_`. If the elements held in memory
+    // would exceed the spill threshold, the element is written to
+    // `spill_store_` instead and the entry of `buffer_` is left empty.
+    absl::Status PutInBuffer(IteratorContext* ctx, size_t index,
+                             std::vector<Tensor>&& element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const SpillOptions& options = dataset()->spill_options_;
+      const int64_t num_bytes = GetAllocatedBytes(element);
+      if (options.threshold_bytes > 0 &&
+          resident_bytes_ + num_bytes > options.threshold_bytes) {
+        if (!spill_store_) {
+          spill_store_ = std::make_unique<ElementSpillStore>(
+              ctx->env(), options.directory);
+        }
+        ElementSpillStore::Location location;
+        TF_RETURN_IF_ERROR(spill_store_->Put(element, &location));
+        spilled_[index] = location;
+        buffer_->at(index).clear();
+        return absl::OkStatus();
+      }
+      resident_bytes_ += num_bytes;
+      this->RecordBufferEnqueue(ctx, element);
+      buffer_->at(index) = std::move(element);
+      return absl::OkStatus();
+    }
+
+    // Moves the element at `index` of the buffer into `*element`, reading it
+    // back from `spill_store_` if it was spilled.
+    absl::Status TakeFromBuffer(IteratorContext* ctx, size_t index,
+                                std::vector<Tensor>* element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      auto it = spilled_.find(index);
+      if (it != spilled_.end()) {
+        TF_RETURN_IF_ERROR(spill_store_->Take(it->second, element));
+        spilled_.erase(it);
+        return absl::OkStatus();
+      }
+      *element = std::move(buffer_->at(index));
+      resident_bytes_ -= GetAllocatedBytes(*element);
+      this->RecordBufferDequeue(ctx, *element);
+      return absl::OkStatus();
+    }
+
+    // Writes the element at `index` of the buffer to the checkpoint. A
+    // spilled element is read back for the write and dropped right after, so
+    // that the checkpoint does not depend on the scratch files and saving
+    // does not bring the whole buffer back into memory.
+    absl::Status WriteBufferElement(IteratorStateWriter* writer,
+                                    absl::string_view key_prefix,
+                                    int64_t index)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      auto it = spilled_.find(index);
+      if (it == spilled_.end()) {
+        return WriteElementToCheckpoint(writer, key_prefix, index,
+                                        buffer_->at(index));
+      }
+      std::vector<Tensor> element;
+      TF_RETURN_IF_ERROR(spill_store_->Get(it->second, &element));
+      return WriteElementToCheckpoint(writer, key_prefix, index, element);
     }
 
     void ClearEmptySlices() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -579,6 +697,16 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
     // `SaveInternal()` and need to be updated in the MemoryCheckpoint
     // (if symbolic checkpointing is used) in the next `SaveInternal()`.
     absl::flat_hash_set<int64_t> checkpoint_indices_ TF_GUARDED_BY(mu_);
+    // Holds the buffered elements that do not fit in the spill threshold.
+    // Created when the first element is spilled.
+    std::unique_ptr<ElementSpillStore> spill_store_ TF_GUARDED_BY(mu_);
+    // Maps the indices of `buffer_` whose elements are spilled to their
+    // location in `spill_store_`. The entries of `buffer_` at these indices
+    // are empty.
+    absl::flat_hash_map<int64_t, ElementSpillStore::Location> spilled_
+        TF_GUARDED_BY(mu_);
+    // The number of bytes of the elements held in `buffer_` itself.
+    int64_t resident_bytes_ TF_GUARDED_BY(mu_) = 0;
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_) = nullptr;
     int64_t epoch_ TF_GUARDED_BY(mu_) = 0;
     int64_t num_elements_ TF_GUARDED_BY(mu_) = 0;
@@ -603,6 +731,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   // fuse shuffle and repeat together, and make the shuffle dataset op
   // responsible for repeating as well.
   const int64_t count_;
+  const SpillOptions spill_options_;
   const TraceMeMetadata traceme_metadata_;
   mutable mutex mu_;
   mutable std::vector<std::int64_t> shuffled_indices_ TF_GUARDED_BY(mu_);
@@ -616,8 +745,9 @@ class ShuffleDatasetOp::Dataset : public ShuffleDatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
           int64_t count, RandomSeeds&& seeds, SeedGeneratorManager* manager,
-          ResourceHandle&& resource_handle)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+          ResourceHandle&& resource_handle, const SpillOptions& spill_options)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           spill_options),
         manager_(manager),
         resource_handle_(std::move(resource_handle)),
         resource_mgr_(ctx->resource_manager()),
@@ -650,12 +780,13 @@ class ShuffleDatasetOp::Dataset : public ShuffleDatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(seeds_.input_seed2(), &seed2_node));
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    std::vector<std::pair<absl::string_view, AttrValue>> attrs = {
+        std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration)};
+    AddSpillAttrs(b, &attrs);
     TF_RETURN_IF_ERROR(b->AddDataset(
         this,
         {input_graph_node, buffer_size_node, seed_node, seed2_node},  // Inputs
-        {std::make_pair(kReshuffleEachIteration,
-                        reshuffle_each_iteration)},  // Attrs
-        output));
+        attrs, output));
     return absl::OkStatus();
   }
 
@@ -728,8 +859,10 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
  public:
   DatasetV3(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
             int64_t count, RandomSeeds&& seeds, SeedGeneratorManager* manager,
-            ResourceHandle&& resource_handle, bool owns_resource)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+            ResourceHandle&& resource_handle, bool owns_resource,
+            const SpillOptions& spill_options)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           spill_options),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -768,13 +901,14 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
     AttrValue reshuffle_each_iteration;
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    std::vector<std::pair<absl::string_view, AttrValue>> attrs = {
+        std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration)};
+    AddSpillAttrs(b, &attrs);
     TF_RETURN_IF_ERROR(
         b->AddDataset(this,
                       {input_graph_node, buffer_size_node, seed_node,
                        seed2_node, resource_handle_node},  // Inputs
-                      {std::make_pair(kReshuffleEachIteration,
-                                      reshuffle_each_iteration)},  // Attrs
-                      output));
+                      attrs, output));
     return absl::OkStatus();
   }
 
@@ -852,9 +986,9 @@ void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
     }
 
     // Ownership of manager is transferred onto `DatasetV3`.
-    *output = new ShuffleDatasetOp::DatasetV3(ctx, input, buffer_size, count,
-                                              std::move(seeds), manager,
-                                              std::move(handle), owns_resource);
+    *output = new ShuffleDatasetOp::DatasetV3(
+        ctx, input, buffer_size, count, std::move(seeds), manager,
+        std::move(handle), owns_resource, spill_options_);
   } else if (op_version_ == 2) {
     ResourceHandle handle;
     OP_REQUIRES_OK(ctx, HandleFromInput(ctx, 2, &handle));
@@ -917,7 +1051,7 @@ void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
     // Ownership of manager is transferred onto `Dataset`.
     *output = new ShuffleDatasetOp::Dataset(ctx, input, buffer_size, count,
                                             std::move(seeds), manager,
-                                            std::move(handle));
+                                            std::move(handle), spill_options_);
   }
 }
 
@@ -925,8 +1059,9 @@ class ShuffleAndRepeatDatasetOp::Dataset : public ShuffleDatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
           RandomSeeds&& seeds, SeedGeneratorManager* manager, int64_t count,
-          ResourceHandle&& resource_handle)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+          ResourceHandle&& resource_handle, const SpillOptions& spill_options)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           spill_options),
         manager_(manager),
         resource_handle_(std::move(resource_handle)),
         resource_mgr_(ctx->resource_manager()),
@@ -961,11 +1096,12 @@ class ShuffleAndRepeatDatasetOp::Dataset : public ShuffleDatasetBase {
     AttrValue reshuffle_each_iteration;
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    std::vector<std::pair<absl::string_view, AttrValue>> attrs = {
+        std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration)};
+    AddSpillAttrs(b, &attrs);
     TF_RETURN_IF_ERROR(b->AddDataset(
         this, {input_graph_node, buffer_size, seed, seed2, count},  // Inputs
-        {std::make_pair(kReshuffleEachIteration,
-                        reshuffle_each_iteration)},  // Attrs
-        output));
+        attrs, output));
     return absl::OkStatus();
   }
 
@@ -980,8 +1116,10 @@ class ShuffleAndRepeatDatasetOp::DatasetV2 : public ShuffleDatasetBase {
  public:
   DatasetV2(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
             int64_t count, RandomSeeds&& seeds, SeedGeneratorManager* manager,
-            ResourceHandle&& resource_handle, bool owns_resource)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+            ResourceHandle&& resource_handle, bool owns_resource,
+            const SpillOptions& spill_options)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           spill_options),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -1022,13 +1160,14 @@ class ShuffleAndRepeatDatasetOp::DatasetV2 : public ShuffleDatasetBase {
     AttrValue reshuffle_each_iteration;
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    std::vector<std::pair<absl::string_view, AttrValue>> attrs = {
+        std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration)};
+    AddSpillAttrs(b, &attrs);
     TF_RETURN_IF_ERROR(
         b->AddDataset(this,
                       {input_graph_node, buffer_size_node, seed_node,
                        seed2_node, count_node, resource_handle_node},  // Inputs
-                      {std::make_pair(kReshuffleEachIteration,
-                                      reshuffle_each_iteration)},  // Attrs
-                      output));
+                      attrs, output));
     return absl::OkStatus();
   }
 
@@ -1116,7 +1255,7 @@ void ShuffleAndRepeatDatasetOp::MakeDataset(OpKernelContext* ctx,
     // Ownership of manager is transferred onto `DatasetV2`.
     *output = new ShuffleAndRepeatDatasetOp::DatasetV2(
         ctx, input, buffer_size, count, std::move(seeds), manager,
-        std::move(handle), owns_resource);
+        std::move(handle), owns_resource, spill_options_);
   } else {
     if (op_version_ != 1) {
       LOG(WARNING) << "Unsupported version of shuffle dataset op: "
@@ -1143,7 +1282,7 @@ void ShuffleAndRepeatDatasetOp::MakeDataset(OpKernelContext* ctx,
 
     // Ownership of manager is transferred onto `Dataset`.
     *output = new Dataset(ctx, input, buffer_size, std::move(seeds), manager,
-                          count, std::move(handle));
+                          count, std::move(handle), spill_options_);
   }
 }
 
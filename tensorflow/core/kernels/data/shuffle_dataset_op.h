@@ -15,6 +15,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_SHUFFLE_DATASET_OP_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_SHUFFLE_DATASET_OP_H_
 
+#include <cstdint>
+#include <string>
+
 #include "tensorflow/core/framework/dataset.h"
 
 namespace tensorflow {
@@ -30,11 +33,27 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
   static constexpr const char* const kOutputShapes = "output_shapes";
   static constexpr const char* const kReshuffleEachIteration =
       "reshuffle_each_iteration";
+  static constexpr const char* const kSpillThresholdBytes =
+      "experimental_spill_threshold_bytes";
+  static constexpr const char* const kSpillDirectory =
+      "experimental_spill_directory";
 
   explicit ShuffleDatasetOpBase(OpKernelConstruction* ctx);
 
  protected:
+  // Configures the shuffle buffer to keep at most `threshold_bytes` of
+  // elements in memory and to spill the others to scratch files in
+  // `directory`. Spilling is disabled if `threshold_bytes` is 0. The scratch
+  // files take at most about twice the compressed size of the spilled
+  // elements, plus one 256MB file being written.
+  struct SpillOptions {
+    int64_t threshold_bytes = 0;
+    std::string directory;
+  };
+
   class ShuffleDatasetBase;
+
+  SpillOptions spill_options_;
 };
 
 class ShuffleDatasetOp : public ShuffleDatasetOpBase {
@@ -11,12 +11,19 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/shuffle_dataset_op.h"
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace data {
@@ -79,6 +86,10 @@ class ShuffleDatasetParams : public DatasetParams {
     attr_vector->emplace_back("reshuffle_each_iteration",
                               reshuffle_each_iteration_);
     attr_vector->emplace_back("metadata", "");
+    attr_vector->emplace_back(ShuffleDatasetOpBase::kSpillThresholdBytes,
+                              spill_threshold_bytes_);
+    attr_vector->emplace_back(ShuffleDatasetOpBase::kSpillDirectory,
+                              spill_directory_);
     return absl::OkStatus();
   }
 
@@ -91,12 +102,22 @@ class ShuffleDatasetParams : public DatasetParams {
 
   int64_t count() const { return count_; }
 
+  void set_spill_threshold_bytes(int64_t spill_threshold_bytes) {
+    spill_threshold_bytes_ = spill_threshold_bytes;
+  }
+
+  void set_spill_directory(std::string spill_directory) {
+    spill_directory_ = std::move(spill_directory);
+  }
+
  private:
   int64_t buffer_size_;
   int64_t seed_;
   int64_t seed2_;
   int64_t count_;
   bool reshuffle_each_iteration_;
+  int64_t spill_threshold_bytes_ = 0;
+  std::string spill_directory_;
 };
 
 class ShuffleDatasetOpTest : public DatasetOpsTestBase {};
@@ -222,6 +243,22 @@ ShuffleDatasetParams ShuffleDatasetParamsWithUnknownCardinality() {
                               /*node_name=*/kShuffleNodeName);
 }
 
+// Test case: same as test case 2, but only two elements of the buffer fit in
+// memory and the others are spilled to disk.
+ShuffleDatasetParams ShuffleDatasetParamsWithSpilling() {
+  ShuffleDatasetParams params = ShuffleDatasetParams2();
+  params.set_spill_threshold_bytes(2 * sizeof(int64_t));
+  return params;
+}
+
+// Test case: same as test case 7, but only two elements of the buffer fit in
+// memory and the others are spilled to disk.
+ShuffleDatasetParams ShuffleAndRepeatDatasetParamsWithSpilling() {
+  ShuffleDatasetParams params = ShuffleDatasetParams7();
+  params.set_spill_threshold_bytes(2 * sizeof(int64_t));
+  return params;
+}
+
 ShuffleDatasetParams ShuffleDatasetParamsWithInvalidBufferSize() {
   return ShuffleDatasetParams(RangeDatasetParams(0, 0, 1),
                               /*buffer_size=*/-1,
@@ -338,7 +375,25 @@ std::vector<GetNextTestCase<ShuffleDatasetParams>> GetNextTestCases() {
        /*expected_reshuffle_outputs=*/
        CreateTensors<int64_t>(
            TensorShape({}),
-           {{1}, {6}, {0}, {5}, {2}, {7}, {4}, {3}, {9}, {8}})}};
+           {{1}, {6}, {0}, {5}, {2}, {7}, {4}, {3}, {9}, {8}})},
+      {/*dataset_params=*/ShuffleDatasetParamsWithSpilling(),
+       /*expected_shuffle_outputs=*/
+       CreateTensors<int64_t>(
+           TensorShape({}), {{2}, {6}, {1}, {3}, {9}, {5}, {0}, {8}, {7}, {4}}),
+       /*expected_reshuffle_outputs=*/
+       CreateTensors<int64_t>(
+           TensorShape({}),
+           {{1}, {6}, {0}, {5}, {2}, {7}, {4}, {3}, {9}, {8}})},
+      {/*dataset_params=*/ShuffleAndRepeatDatasetParamsWithSpilling(),
+       /*expected_shuffle_outputs=*/
+       CreateTensors<int64_t>(
+           TensorShape({}), {{9}, {0}, {8}, {6}, {1}, {3}, {7}, {2}, {4}, {5},
+                             {9}, {0}, {8}, {6}, {1}, {3}, {7}, {2}, {4}, {5}}),
+       /*expected_reshuffle_outputs=*/
+       CreateTensors<int64_t>(
+           TensorShape({}),
+           {{9}, {0}, {8}, {6}, {1}, {3}, {7}, {2}, {4}, {5},
+            {9}, {0}, {8}, {6}, {1}, {3}, {7}, {2}, {4}, {5}})}};
 }
 
 class ParameterizedGetNextTest : public ShuffleDatasetOpTest,
@@ -538,7 +593,20 @@ IteratorSaveAndRestoreTestCases() {
            /*expected_shuffle_outputs=*/
            CreateTensors<int64_t>(
                TensorShape({}),
-               {{2}, {6}, {1}, {3}, {9}, {5}, {0}, {8}, {7}, {4}})}};
+               {{2}, {6}, {1}, {3}, {9}, {5}, {0}, {8}, {7}, {4}})},
+          {/*dataset_params=*/ShuffleDatasetParamsWithSpilling(),
+           /*breakpoints=*/{0, 4, 11},
+           /*expected_shuffle_outputs=*/
+           CreateTensors<int64_t>(
+               TensorShape({}),
+               {{2}, {6}, {1}, {3}, {9}, {5}, {0}, {8}, {7}, {4}})},
+          {/*dataset_params=*/ShuffleAndRepeatDatasetParamsWithSpilling(),
+           /*breakpoints=*/{0, 5, 22},
+           /*expected_shuffle_outputs=*/
+           CreateTensors<int64_t>(
+               TensorShape({}),
+               {{9}, {0}, {8}, {6}, {1}, {3}, {7}, {2}, {4}, {5},
+                {9}, {0}, {8}, {6}, {1}, {3}, {7}, {2}, {4}, {5}})}};
 }
 
 class ParameterizedIteratorSaveAndRestoreTest
@@ -584,6 +652,68 @@ INSTANTIATE_TEST_CASE_P(ShuffleDatasetOpTest,
                         ParameterizedIteratorSaveAndRestoreTest,
                         ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
 
+TEST_F(ShuffleDatasetOpTest, SpilledElementsAreDeleted) {
+  const std::string directory =
+      io::JoinPath(testing::TmpDir(), "shuffle_dataset_op_test_spill");
+  auto dataset_params = ShuffleDatasetParamsWithSpilling();
+  dataset_params.set_spill_directory(directory);
+  TF_ASSERT_OK(Initialize(dataset_params));
+
+  // Filling the buffer spills all but two of its elements.
+  bool end_of_sequence = false;
+  std::vector<Tensor> next;
+  TF_ASSERT_OK(
+      iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+  std::vector<std::string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(directory, &children));
+  EXPECT_EQ(children.size(), 1);
+
+  iterator_.reset();
+  TF_ASSERT_OK(Env::Default()->GetChildren(directory, &children));
+  EXPECT_TRUE(children.empty());
+}
+
+TEST_F(ShuffleDatasetOpTest, SpillingKeepsResidentBytesBelowThreshold) {
+  // The buffer holds 1000 elements of at least 8 bytes each, but only 1KB of
+  // them may stay in memory.
+  constexpr int64_t kSpillThresholdBytes = 1024;
+  ShuffleDatasetParams dataset_params(
+      RangeDatasetParams(0, 1000, 1),
+      /*buffer_size=*/1000,
+      /*seed=*/1,
+      /*seed2=*/2,
+      /*count=*/1,
+      /*reshuffle_each_iteration=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kShuffleNodeName);
+  dataset_params.set_spill_threshold_bytes(kSpillThresholdBytes);
+  TF_ASSERT_OK(Initialize(dataset_params));
+
+  // Buffered bytes are only recorded when the iterator is modeled.
+  IteratorContext::Params params(iterator_ctx_.get());
+  auto model = std::make_shared<model::Model>();
+  params.model = model;
+  IteratorContext ctx(std::move(params));
+  std::unique_ptr<IteratorBase> iterator;
+  TF_ASSERT_OK(dataset_->MakeIterator(&ctx, /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &iterator));
+  int64_t num_elements = 0;
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(iterator->GetNext(&ctx, &next, &end_of_sequence));
+    num_elements += end_of_sequence ? 0 : 1;
+  }
+  EXPECT_EQ(num_elements, 1000);
+
+  std::shared_ptr<model::Node> node = model->output();
+  ASSERT_NE(node, nullptr);
+  EXPECT_GT(node->peak_buffered_bytes(), 0);
+  EXPECT_LE(node->peak_buffered_bytes(), kSpillThresholdBytes);
+}
+
 TEST_F(ShuffleDatasetOpTest, InvalidArguments) {
   std::vector<ShuffleDatasetParams> dataset_params_vec(
       {ShuffleDatasetParamsWithInvalidBufferSize(),
@@ -595,6 +725,57 @@ TEST_F(ShuffleDatasetOpTest, InvalidArguments) {
   }
 }
 
+// Iterates a shuffle dataset outside of a test.
+class ShuffleDatasetBenchmark : public ShuffleDatasetOpTest {
+ public:
+  void TestBody() override {}
+
+  absl::Status GetNext(std::vector<Tensor>* out_tensors,
+                       bool* end_of_sequence) {
+    return iterator_->GetNext(iterator_ctx_.get(), out_tensors,
+                              end_of_sequence);
+  }
+};
+
+// Reports the throughput of a repeated shuffle of scalars with a buffer of
+// `state.range(0)` elements, with all elements in memory or with a tenth of
+// the buffer in memory and the rest spilled to disk.
+static void BM_ShuffleWithSpilling(::testing::benchmark::State& state) {
+  const int64_t buffer_size = state.range(0);
+  const bool spill = state.range(1);
+
+  ShuffleDatasetParams dataset_params(
+      RangeDatasetParams(0, buffer_size, 1), buffer_size,
+      /*seed=*/1,
+      /*seed2=*/2,
+      /*count=*/-1,
+      /*reshuffle_each_iteration=*/true,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kShuffleAndRepeatNodeName);
+  if (spill) {
+    dataset_params.set_spill_threshold_bytes(buffer_size / 10 *
+                                             sizeof(int64_t));
+  }
+  ShuffleDatasetBenchmark benchmark;
+  TF_CHECK_OK(benchmark.Initialize(dataset_params));
+
+  bool end_of_sequence = false;
+  std::vector<Tensor> next;
+  for (auto s : state) {
+    TF_CHECK_OK(benchmark.GetNext(&next, &end_of_sequence));
+    CHECK(!end_of_sequence);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetLabel(spill ? "spill" : "in memory");
+}
+
+BENCHMARK(BM_ShuffleWithSpilling)
+    ->ArgPair(10000, 0)
+    ->ArgPair(10000, 1)
+    ->ArgPair(1000000, 0)
+    ->ArgPair(1000000, 1);
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
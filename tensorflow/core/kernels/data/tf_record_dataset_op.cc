@@ -14,8 +14,17 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
 #include <cstdint>
-
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/global_shuffle_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -26,9 +35,11 @@ limitations under the License.
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tsl/profiler/lib/traceme.h"
 
@@ -43,16 +54,21 @@ namespace data {
 /* static */ constexpr const char* const TFRecordDatasetOp::kCompressionType;
 /* static */ constexpr const char* const TFRecordDatasetOp::kBufferSize;
 /* static */ constexpr const char* const TFRecordDatasetOp::kByteOffsets;
+/* static */ constexpr const char* const TFRecordDatasetOp::kUseIndex;
 
 constexpr char kTFRecordDataset[] = "TFRecordDataset";
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kOffset[] = "offset";
+constexpr char kNextIndex[] = "next_index";
 constexpr char kGcsFsPrefix[] = "gs://";
 constexpr char kS3FsPrefix[] = "s3://";
 constexpr int64_t kUnspecifiedBufferSize = -1;
 constexpr int64_t kDefaultBufferSize = 256LL << 10;  // 256KB
 constexpr int64_t kCloudTpuBlockSize = 127LL << 20;  // 127MB.
 constexpr int64_t kS3BlockSize = kCloudTpuBlockSize;
+// Maximum number of concurrent reads of one file by an iterator that uses
+// record indexes.
+constexpr size_t kMaxParallelReads = 8;
 
 bool is_cloud_tpu_gcs_fs() {
 #if defined(LIBTPU_ON_GCE)
@@ -64,29 +80,76 @@ bool is_cloud_tpu_gcs_fs() {
 #endif
 }
 
+// Reads the record index of each of `filenames`, and checks that it matches
+// the current contents of the file.
+absl::Status ReadRecordIndexes(
+    Env* env, const std::vector<std::string>& filenames,
+    std::vector<std::unique_ptr<io::RecordIndex>>* indexes) {
+  indexes->reserve(filenames.size());
+  for (const std::string& filename : filenames) {
+    const std::string translated = TranslateFileName(filename);
+    std::unique_ptr<io::RecordIndex> index;
+    TF_RETURN_IF_ERROR(io::RecordIndex::Read(
+        env, io::RecordIndexFileName(translated), &index));
+    uint64_t file_size;
+    TF_RETURN_IF_ERROR(env->GetFileSize(translated, &file_size));
+    if (file_size != index->data_file_size()) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          "The record index of ", filename, " describes ",
+          index->data_file_size(), " bytes but the file has ", file_size,
+          " bytes. The index is stale and must be rewritten."));
+    }
+    indexes->push_back(std::move(index));
+  }
+  return absl::OkStatus();
+}
+
+void RecordBytesRead(int64_t bytes) {
+  static monitoring::CounterCell* bytes_counter =
+      metrics::GetTFDataBytesReadCounter(TFRecordDatasetOp::kDatasetType);
+  bytes_counter->IncrementBy(bytes);
+}
+
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<std::string> filenames,
                    const std::string& compression_type, int64_t buffer_size,
-                   std::vector<int64_t> byte_offsets, int op_version)
+                   std::vector<int64_t> byte_offsets, int op_version,
+                   bool use_index,
+                   std::vector<std::unique_ptr<io::RecordIndex>> indexes)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
             compression_type)),
         byte_offsets_(std::move(byte_offsets)),
-        op_version_(op_version) {
+        op_version_(op_version),
+        use_index_(use_index),
+        env_(ctx->env()),
+        indexes_(std::move(indexes)),
+        files_(indexes_.size()),
+        readers_(indexes_.size()) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
+    record_starts_.reserve(indexes_.size() + 1);
+    record_starts_.push_back(0);
+    for (const auto& index : indexes_) {
+      record_starts_.push_back(record_starts_.back() + index->num_records());
+    }
   }
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
       const std::string& prefix) const override {
     name_utils::IteratorPrefixParams params;
     params.op_version = op_version_;
-    return std::make_unique<Iterator>(Iterator::Params{
-        this, name_utils::IteratorPrefix(kDatasetType, prefix, params)});
+    const std::string iterator_prefix =
+        name_utils::IteratorPrefix(kDatasetType, prefix, params);
+    if (use_index_) {
+      return std::make_unique<IndexedIterator>(
+          IndexedIterator::Params{this, iterator_prefix});
+    }
+    return std::make_unique<Iterator>(Iterator::Params{this, iterator_prefix});
   }
 
   const DataTypeVector& output_dtypes() const override {
@@ -113,6 +176,39 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
   absl::Status CheckExternalState() const override { return absl::OkStatus(); }
 
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    return use_index_ ? record_starts_.back() : kUnknownCardinality;
+  }
+
+  absl::Status RandomIndexingCompatible() const override {
+    if (!use_index_) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          type_string(), " only supports random access with `", kUseIndex,
+          "=True`."));
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Get(OpKernelContext* ctx, int64_t index,
+                   std::vector<Tensor>* out_tensors) const override {
+    return Get(AnyContext(ctx), index, out_tensors);
+  }
+
+  absl::Status Get(AnyContext ctx, int64_t index,
+                   std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    const int64_t file_index = FileIndexOf(index);
+    const io::IndexedRecordReader* reader;
+    TF_RETURN_IF_ERROR(GetReader(file_index, &reader));
+    Tensor record(ctx.allocator, DT_STRING, TensorShape({}));
+    TF_RETURN_IF_ERROR(reader->ReadRecord(index - record_starts_[file_index],
+                                          &record.scalar<tstring>()()));
+    RecordBytesRead(record.scalar<tstring>()().size());
+    out_tensors->clear();
+    out_tensors->push_back(std::move(record));
+    return absl::OkStatus();
+  }
+
  protected:
   absl::Status AsGraphDefInternal(SerializationContext* ctx,
                                   DatasetGraphDefBuilder* b,
@@ -123,10 +219,18 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
     Node* buffer_size = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
-    TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {filenames, compression_type, buffer_size}, output));
     Node* byte_offsets = nullptr;
     TF_RETURN_IF_ERROR(b->AddVector(byte_offsets_, &byte_offsets));
+    if (use_index_) {
+      // Only TFRecordDatasetV2 has the attr.
+      AttrValue use_index;
+      b->BuildAttrValue(use_index_, &use_index);
+      return b->AddDataset(
+          this, {filenames, compression_type, buffer_size, byte_offsets},
+          {std::make_pair(kUseIndex, use_index)}, output);
+    }
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {filenames, compression_type, buffer_size}, output));
     return absl::OkStatus();
   }
 
@@ -315,16 +419,222 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
   };
 
+  // Reads the records of the files in order through their record indexes.
+  // Each refill of the buffer reads up to `kMaxParallelReads` consecutive
+  // ranges of about `buffer_size` bytes of the current file in parallel.
+  class IndexedIterator : public DatasetIterator<Dataset> {
+   public:
+    explicit IndexedIterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          global_shuffle_iterator_(dataset()) {}
+
+    absl::Status Initialize(IteratorContext* ctx) override {
+      LogFilenamesOptions log_filenames_options = {
+          .files = dataset()->filenames_,
+          .data_service_address = ctx->data_service_address()};
+      LogFilenames(log_filenames_options);
+      return absl::OkStatus();
+    }
+
+    bool SymbolicCheckpointCompatible() const override { return true; }
+
+    absl::Status GetNextInternal(IteratorContext* ctx,
+                                 std::vector<Tensor>* out_tensors,
+                                 bool* end_of_sequence) override {
+      if (ctx->index_mapper() != nullptr) {
+        return global_shuffle_iterator_.GetNext(ctx, out_tensors,
+                                                end_of_sequence);
+      }
+      mutex_lock l(mu_);
+      if (buffer_.empty()) {
+        if (next_index_ >= dataset()->record_starts_.back()) {
+          *end_of_sequence = true;
+          return absl::OkStatus();
+        }
+        TF_RETURN_IF_ERROR(FillBufferLocked(ctx));
+      }
+      out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                TensorShape({}));
+      out_tensors->back().scalar<tstring>()() = std::move(buffer_.front());
+      buffer_.pop_front();
+      ++next_index_;
+      RecordBytesRead(out_tensors->back().scalar<tstring>()().size());
+      *end_of_sequence = false;
+      return absl::OkStatus();
+    }
+
+    absl::Status SkipInternal(IteratorContext* ctx, int num_to_skip,
+                              bool* end_of_sequence,
+                              int* num_skipped) override {
+      if (ctx->index_mapper() != nullptr) {
+        return DatasetIterator<Dataset>::SkipInternal(
+            ctx, num_to_skip, end_of_sequence, num_skipped);
+      }
+      mutex_lock l(mu_);
+      *num_skipped = std::min<int64_t>(
+          num_to_skip, dataset()->record_starts_.back() - next_index_);
+      next_index_ += *num_skipped;
+      buffer_.erase(buffer_.begin(),
+                    buffer_.begin() +
+                        std::min<size_t>(*num_skipped, buffer_.size()));
+      *end_of_sequence = *num_skipped < num_to_skip;
+      return absl::OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    absl::Status SaveInternal(SerializationContext* ctx,
+                              IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(prefix(), kNextIndex, next_index_));
+      return global_shuffle_iterator_.Save(prefix(), ctx, writer);
+    }
+
+    absl::Status RestoreInternal(IteratorContext* ctx,
+                                 IteratorStateReader* reader) override {
+      if (ctx->restored_element_count().has_value()) {
+        return global_shuffle_iterator_.Restore(prefix(), ctx, reader);
+      }
+      mutex_lock l(mu_);
+      buffer_.clear();
+      return reader->ReadScalar(prefix(), kNextIndex, &next_index_);
+    }
+
+   private:
+    // Reads the records that follow `next_index_` in its file into `buffer_`.
+    absl::Status FillBufferLocked(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64_t file_index = dataset()->FileIndexOf(next_index_);
+      const int64_t file_start = dataset()->record_starts_[file_index];
+      const io::IndexedRecordReader* reader;
+      absl::Status s = dataset()->GetReader(file_index, &reader);
+      if (!s.ok()) {
+        // Moves on to the next file so that this works with ignore_errors.
+        next_index_ = dataset()->record_starts_[file_index + 1];
+        return s;
+      }
+
+      const io::RecordIndex& index = *dataset()->indexes_[file_index];
+      const uint64_t range_size =
+          std::max<int64_t>(dataset()->options_.buffer_size, 1);
+      std::vector<std::pair<int64_t, int64_t>> ranges;
+      int64_t begin = next_index_ - file_start;
+      while (begin < index.num_records() && ranges.size() < kMaxParallelReads) {
+        // Finds the last record that ends within `range_size` bytes of
+        // `begin`, taking at least one record.
+        const uint64_t limit = index.offset(begin) + range_size;
+        int64_t lo = begin + 1;
+        int64_t hi = index.num_records();
+        while (lo < hi) {
+          const int64_t mid = lo + (hi - lo + 1) / 2;
+          if (index.offset(mid) <= limit) {
+            lo = mid;
+          } else {
+            hi = mid - 1;
+          }
+        }
+        ranges.emplace_back(begin, lo);
+        begin = lo;
+      }
+
+      std::vector<std::vector<tstring>> records(ranges.size());
+      std::vector<absl::Status> statuses(ranges.size());
+      if (ranges.size() == 1) {
+        statuses[0] = reader->ReadRecords(ranges[0].first, ranges[0].second,
+                                          &records[0]);
+      } else {
+        BlockingCounter counter(ranges.size());
+        for (size_t i = 0; i < ranges.size(); ++i) {
+          (*ctx->runner())([&, i]() {
+            statuses[i] = reader->ReadRecords(ranges[i].first,
+                                              ranges[i].second, &records[i]);
+            counter.DecrementCount();
+          });
+        }
+        counter.Wait();
+      }
+      for (size_t i = 0; i < ranges.size() && statuses[i].ok(); ++i) {
+        for (tstring& record : records[i]) {
+          buffer_.push_back(std::move(record));
+        }
+      }
+      if (!buffer_.empty()) return absl::OkStatus();
+
+      // The first range is corrupt. Reads it one record at a time, so that
+      // only the corrupt records are dropped with ignore_errors.
+      tstring record;
+      s = reader->ReadRecord(next_index_ - file_start, &record);
+      if (!s.ok()) {
+        ++next_index_;
+        return s;
+      }
+      buffer_.push_back(std::move(record));
+      return absl::OkStatus();
+    }
+
+    mutex mu_;
+    // Index of the next record to produce, across all files.
+    int64_t next_index_ TF_GUARDED_BY(mu_) = 0;
+    // Records [next_index_, next_index_ + buffer_.size()).
+    std::deque<tstring> buffer_ TF_GUARDED_BY(mu_);
+    GlobalShuffleIterator global_shuffle_iterator_;
+  };
+
+  // Returns the index of the file that contains record `index`.
+  int64_t FileIndexOf(int64_t index) const {
+    return std::upper_bound(record_starts_.begin(), record_starts_.end(),
+                            index) -
+           record_starts_.begin() - 1;
+  }
+
+  // Returns a reader of file `file_index`, opening the file on first use.
+  absl::Status GetReader(int64_t file_index,
+                         const io::IndexedRecordReader** reader) const {
+    mutex_lock l(readers_mu_);
+    if (readers_[file_index] == nullptr) {
+      TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
+          TranslateFileName(filenames_[file_index]), &files_[file_index]));
+      readers_[file_index] = std::make_unique<io::IndexedRecordReader>(
+          files_[file_index].get(), indexes_[file_index].get());
+    }
+    *reader = readers_[file_index].get();
+    return absl::OkStatus();
+  }
+
   const std::vector<std::string> filenames_;
   const tstring compression_type_;
   io::RecordReaderOptions options_;
   const std::vector<int64_t> byte_offsets_;
   const int op_version_;
+  const bool use_index_;
+  Env* const env_;
+
+  // The following are only used with `use_index_`.
+  const std::vector<std::unique_ptr<io::RecordIndex>> indexes_;
+  // `record_starts_[i]` is the index of the first record of file `i` in the
+  // dataset. The last entry is the number of records of the dataset.
+  std::vector<int64_t> record_starts_;
+  // Readers are shared by all iterators and `Get()`, which read through them
+  // concurrently.
+  mutable mutex readers_mu_;
+  mutable std::vector<std::unique_ptr<RandomAccessFile>> files_
+      TF_GUARDED_BY(readers_mu_);
+  mutable std::vector<std::unique_ptr<io::IndexedRecordReader>> readers_
+      TF_GUARDED_BY(readers_mu_);
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
     : DatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kTFRecordDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kTFRecordDataset ? 1 : 2) {
+  if (ctx->HasAttr(kUseIndex)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kUseIndex, &use_index_));
+  }
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -401,8 +711,26 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
         << buffer_size;
   }
 
+  std::vector<std::unique_ptr<io::RecordIndex>> indexes;
+  if (use_index_) {
+    OP_REQUIRES(ctx,
+                io::RecordReaderOptions::CreateRecordReaderOptions(
+                    compression_type)
+                        .compression_type == io::RecordReaderOptions::NONE,
+                absl::InvalidArgumentError(absl::StrCat(
+                    "`", kUseIndex, "` requires uncompressed files, but ",
+                    "`compression_type` is \"", compression_type, "\".")));
+    OP_REQUIRES(ctx,
+                std::all_of(byte_offsets.begin(), byte_offsets.end(),
+                            [](int64_t offset) { return offset == 0; }),
+                absl::InvalidArgumentError(absl::StrCat(
+                    "`", kUseIndex, "` does not support `byte_offsets`.")));
+    OP_REQUIRES_OK(ctx, ReadRecordIndexes(ctx->env(), filenames, &indexes));
+  }
+
   *output = new Dataset(ctx, std::move(filenames), compression_type,
-                        buffer_size, std::move(byte_offsets), op_version_);
+                        buffer_size, std::move(byte_offsets), op_version_,
+                        use_index_, std::move(indexes));
 }
 
 namespace {
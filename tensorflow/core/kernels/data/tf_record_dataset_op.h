@@ -27,6 +27,7 @@ class TFRecordDatasetOp : public DatasetOpKernel {
   static constexpr const char* const kCompressionType = "compression_type";
   static constexpr const char* const kBufferSize = "buffer_size";
   static constexpr const char* const kByteOffsets = "byte_offsets";
+  static constexpr const char* const kUseIndex = "experimental_use_index";
 
   explicit TFRecordDatasetOp(OpKernelConstruction* ctx);
 
@@ -36,6 +37,7 @@ class TFRecordDatasetOp : public DatasetOpKernel {
  private:
   class Dataset;
   int op_version_;
+  bool use_index_ = false;
 };
 
 }  // namespace data
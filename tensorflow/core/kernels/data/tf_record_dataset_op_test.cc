@@ -32,7 +32,9 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/file_system.h"
@@ -69,13 +71,14 @@ class TFRecordDatasetParams : public DatasetParams {
   TFRecordDatasetParams(std::vector<tstring> filenames,
                         CompressionType compression_type, int64_t buffer_size,
                         std::vector<int64_t> byte_offsets,
-                        std::string node_name)
+                        std::string node_name, bool use_index = false)
       : DatasetParams({DT_STRING}, {PartialTensorShape({})},
                       std::move(node_name)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         buffer_size_(buffer_size),
-        byte_offsets_(std::move(byte_offsets)) {
+        byte_offsets_(std::move(byte_offsets)),
+        use_index_(use_index) {
     op_version_ = 2;
   }
 
@@ -104,6 +107,7 @@ class TFRecordDatasetParams : public DatasetParams {
   absl::Status GetAttributes(AttributeVector* attr_vector) const override {
     attr_vector->clear();
     attr_vector->emplace_back("metadata", "");
+    attr_vector->emplace_back(TFRecordDatasetOp::kUseIndex, use_index_);
     return absl::OkStatus();
   }
 
@@ -116,6 +120,7 @@ class TFRecordDatasetParams : public DatasetParams {
   CompressionType compression_type_;
   int64_t buffer_size_;
   std::vector<int64_t> byte_offsets_;
+  bool use_index_;
 };
 
 class TFRecordDatasetOpTest : public DatasetOpsTestBase {};
@@ -139,6 +144,32 @@ absl::Status CreateTestFiles(
   return absl::OkStatus();
 }
 
+// Writes uncompressed files along with their record indexes.
+absl::Status CreateIndexedTestFiles(
+    const std::vector<tstring>& filenames,
+    const std::vector<std::vector<std::string>>& contents) {
+  if (filenames.size() != contents.size()) {
+    return absl::InvalidArgumentError(
+        "The number of files does not match with the contents");
+  }
+  Env* env = Env::Default();
+  for (int i = 0; i < filenames.size(); ++i) {
+    std::unique_ptr<WritableFile> file;
+    std::unique_ptr<WritableFile> index_file;
+    TF_RETURN_IF_ERROR(env->NewWritableFile(filenames[i], &file));
+    TF_RETURN_IF_ERROR(env->NewWritableFile(
+        io::RecordIndexFileName(filenames[i]), &index_file));
+    io::RecordWriter writer(file.get(), index_file.get());
+    for (const std::string& record : contents[i]) {
+      TF_RETURN_IF_ERROR(writer.WriteRecord(record));
+    }
+    TF_RETURN_IF_ERROR(writer.Close());
+    TF_RETURN_IF_ERROR(file->Close());
+    TF_RETURN_IF_ERROR(index_file->Close());
+  }
+  return absl::OkStatus();
+}
+
 // Test case 1: multiple text files with ZLIB compression.
 TFRecordDatasetParams TFRecordDatasetParams1() {
   std::vector<tstring> filenames = {
@@ -218,7 +249,27 @@ TFRecordDatasetParams TFRecordDatasetParams4() {
                                /*node_name=*/kNodeName);
 }
 
-// Test case 5: Read invalid byte_offsets for records.
+// Test case 5: multiple indexed files, read in parallel ranges.
+TFRecordDatasetParams IndexedTFRecordDatasetParams() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_INDEXED_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_INDEXED_2"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_INDEXED_3")};
+  std::vector<std::vector<std::string>> contents = {
+      {"1", "22", "333"}, {}, {"a", "bb", "ccc"}};
+  absl::Status status = CreateIndexedTestFiles(filenames, contents);
+  TF_CHECK_OK(status) << "Failed to create the test files: "
+                      << absl::StrJoin(filenames, ", ") << ": " << status;
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/
+                               CompressionType::UNCOMPRESSED,
+                               /*buffer_size=*/20,
+                               /*byte_offsets=*/{0, 0, 0},
+                               /*node_name=*/kNodeName,
+                               /*use_index=*/true);
+}
+
+// Test case 6: Read invalid byte_offsets for records.
 TFRecordDatasetParams InvalidByteOffsets() {
   std::vector<tstring> filenames = {
       absl::StrCat(testing::TmpDir(), "/tf_record_UNCOMPRESSED_1")};
@@ -248,7 +299,10 @@ std::vector<GetNextTestCase<TFRecordDatasetParams>> GetNextTestCases() {
       {/*dataset_params=*/TFRecordDatasetParams4(),
        CreateTensors<tstring>(
            TensorShape({}),
-           {{"1"}, {"22"}, {"333"}, {"bb"}, {"ccc"}, {"zzz"}})}};
+           {{"1"}, {"22"}, {"333"}, {"bb"}, {"ccc"}, {"zzz"}})},
+      {/*dataset_params=*/IndexedTFRecordDatasetParams(),
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})}};
 }
 
 ITERATOR_GET_NEXT_TEST_P(TFRecordDatasetOpTest, TFRecordDatasetParams,
@@ -286,6 +340,17 @@ std::vector<SkipTestCase<TFRecordDatasetParams>> SkipTestCases() {
            /*expected_outputs=*/
            CreateTensors<tstring>(TensorShape({}), {{"bb"}})},
           {/*dataset_params=*/TFRecordDatasetParams3(),
+           /*num_to_skip*/ 7, /*expected_num_skipped*/ 6},
+
+          {/*dataset_params=*/IndexedTFRecordDatasetParams(),
+           /*num_to_skip*/ 2, /*expected_num_skipped*/ 2, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"333"}})},
+          {/*dataset_params=*/IndexedTFRecordDatasetParams(),
+           /*num_to_skip*/ 4, /*expected_num_skipped*/ 4, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"bb"}})},
+          {/*dataset_params=*/IndexedTFRecordDatasetParams(),
            /*num_to_skip*/ 7, /*expected_num_skipped*/ 6}};
 }
 
@@ -325,6 +390,57 @@ TEST_F(TFRecordDatasetOpTest, Cardinality) {
   TF_ASSERT_OK(CheckDatasetCardinality(kUnknownCardinality));
 }
 
+TEST_F(TFRecordDatasetOpTest, IndexedCardinality) {
+  auto dataset_params = IndexedTFRecordDatasetParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(6));
+}
+
+TEST_F(TFRecordDatasetOpTest, IndexedRandomAccess) {
+  auto dataset_params = IndexedTFRecordDatasetParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  const std::vector<std::string> expected = {"1", "22", "333",
+                                             "a", "bb", "ccc"};
+  for (int64_t i = expected.size() - 1; i >= 0; --i) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(
+        dataset_->Get(AnyContext(iterator_ctx_.get()), i, &out_tensors));
+    ASSERT_EQ(out_tensors.size(), 1);
+    EXPECT_EQ(out_tensors[0].scalar<tstring>()(), expected[i]);
+  }
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(dataset_->Get(AnyContext(iterator_ctx_.get()), 6, &out_tensors)
+                .code(),
+            absl::StatusCode::kOutOfRange);
+}
+
+TEST_F(TFRecordDatasetOpTest, IndexRequiresUncompressedFiles) {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_INDEXED_ZLIB")};
+  TF_ASSERT_OK(
+      CreateTestFiles(filenames, {{"1", "22"}}, CompressionType::ZLIB));
+  auto dataset_params = TFRecordDatasetParams(
+      filenames, /*compression_type=*/CompressionType::ZLIB,
+      /*buffer_size=*/10, /*byte_offsets=*/{0}, /*node_name=*/kNodeName,
+      /*use_index=*/true);
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST_F(TFRecordDatasetOpTest, StaleIndex) {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_INDEXED_STALE")};
+  TF_ASSERT_OK(CreateIndexedTestFiles(filenames, {{"1", "22"}}));
+  TF_ASSERT_OK(CreateTestFiles(filenames, {{"1", "22", "333"}},
+                               CompressionType::UNCOMPRESSED));
+  auto dataset_params = TFRecordDatasetParams(
+      filenames, /*compression_type=*/CompressionType::UNCOMPRESSED,
+      /*buffer_size=*/10, /*byte_offsets=*/{0}, /*node_name=*/kNodeName,
+      /*use_index=*/true);
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
 TEST_F(TFRecordDatasetOpTest, IteratorOutputDtypes) {
   auto dataset_params = TFRecordDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
@@ -371,6 +487,10 @@ IteratorSaveAndRestoreTestCases() {
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
       {/*dataset_params=*/TFRecordDatasetParams3(),
+       /*breakpoints=*/{0, 2, 7},
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/IndexedTFRecordDatasetParams(),
        /*breakpoints=*/{0, 2, 7},
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})}};
@@ -101,6 +101,19 @@ absl::Status InitializableLookupTable::Initialize(
   return absl::OkStatus();
 }
 
+absl::Status InitializableLookupTable::InitializeWith(
+    const std::function<absl::Status()>& populate,
+    std::unique_ptr<InitializerSerializer> serializer) {
+  mutex_lock l(mu_);
+  if (is_initialized()) {
+    return absl::OkStatus();
+  }
+  TF_RETURN_IF_ERROR(populate());
+  initializer_serializer_ = std::move(serializer);
+  is_initialized_.store(true, std::memory_order_release);
+  return absl::OkStatus();
+}
+
 absl::Status InitializableLookupTable::AreEntriesSame(
     const InitTableIterator& iter, bool* result) {
   *result = static_cast<size_t>(iter.total_size()) == size();
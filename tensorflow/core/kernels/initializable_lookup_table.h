@@ -17,6 +17,8 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_INITIALIZABLE_LOOKUP_TABLE_H_
 
 #include <atomic>
+#include <functional>
+#include <memory>
 
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/platform/macros.h"
@@ -203,6 +205,13 @@ class InitializableLookupTable : public LookupInterface {
   virtual absl::Status AreEntriesSame(const InitTableIterator& iter,
                                       bool* result);
 
+  // Initializes the table by invoking `populate`, for implementations whose
+  // contents are not built by inserting the elements of an InitTableIterator.
+  // Does nothing and returns OK if the table is already initialized.
+  absl::Status InitializeWith(
+      const std::function<absl::Status()>& populate,
+      std::unique_ptr<InitializerSerializer> serializer);
+
   mutex mu_;
 
  protected:
@@ -0,0 +1,421 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/lookup_table_image.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/random.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+constexpr char kMagic[8] = {'T', 'F', 'H', 'T', 'I', 'M', 'G', '\0'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kEndianCheck = 0x01020304;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t endian_check;
+  int32_t key_dtype;
+  int32_t value_dtype;
+  uint64_t num_entries;
+  uint64_t num_slots;
+  uint64_t slots_offset;
+  uint64_t keys_offset;
+  uint64_t keys_size;
+  char padding[8];
+};
+static_assert(sizeof(Header) == 64, "Unexpected hash table image header size");
+static_assert(sizeof(HashTableImage::Slot) == 24, "Unexpected slot size");
+
+// Zero marks an empty slot, so no key may hash to it.
+uint64_t NonZero(uint64_t hash) { return hash == 0 ? 1 : hash; }
+
+uint64_t HashKey(int64_t key) {
+  return NonZero(Hash64(reinterpret_cast<const char*>(&key), sizeof(key)));
+}
+
+uint64_t HashKey(absl::string_view key) {
+  return NonZero(Hash64(key.data(), key.size()));
+}
+
+// Returns the smallest power of two that is at least twice `num_entries`, so
+// that the table is at most half full.
+uint64_t NumSlotsFor(uint64_t num_entries) {
+  uint64_t num_slots = 1;
+  while (num_slots < 2 * num_entries) num_slots <<= 1;
+  return num_slots;
+}
+
+uint64_t EncodeValue(const Tensor& values, int64_t i) {
+  uint64_t encoded = 0;
+  switch (values.dtype()) {
+#define ENCODE_CASE(T)                        \
+  case DataTypeToEnum<T>::value: {            \
+    const T value = values.flat<T>()(i);      \
+    std::memcpy(&encoded, &value, sizeof(T)); \
+    break;                                    \
+  }
+    ENCODE_CASE(int32_t);
+    ENCODE_CASE(int64_t);
+    ENCODE_CASE(float);
+    ENCODE_CASE(double);
+#undef ENCODE_CASE
+    default:
+      break;
+  }
+  return encoded;
+}
+
+// Inserts the entries of `keys` and `values` into `slots`. `get_key(i)`
+// returns the i-th key, `slot_key(i)` its representation in a slot, and
+// `key_at(slot)` the key held by a non-empty slot.
+template <typename KeyFn, typename SlotKeyFn, typename KeyAtFn>
+absl::Status InsertAll(const Tensor& values, int64_t num_keys, KeyFn get_key,
+                       SlotKeyFn slot_key, KeyAtFn key_at,
+                       std::vector<HashTableImage::Slot>* slots,
+                       uint64_t* num_entries) {
+  const uint64_t mask = slots->size() - 1;
+  for (int64_t i = 0; i < num_keys; ++i) {
+    const auto key = get_key(i);
+    const uint64_t hash = HashKey(key);
+    const uint64_t value = EncodeValue(values, i);
+    for (uint64_t s = hash & mask;; s = (s + 1) & mask) {
+      HashTableImage::Slot& slot = (*slots)[s];
+      if (slot.hash == 0) {
+        slot.hash = hash;
+        slot.key = slot_key(i);
+        slot.value = value;
+        ++*num_entries;
+        break;
+      }
+      if (slot.hash == hash && key_at(slot) == key) {
+        if (slot.value != value) {
+          return absl::FailedPreconditionError(
+              absl::StrCat("Hash table image has duplicate key ", key,
+                           " with different values."));
+        }
+        break;
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+bool HashTableImage::IsSupportedKeyType(DataType dtype) {
+  return dtype == DT_INT64 || dtype == DT_STRING;
+}
+
+bool HashTableImage::IsSupportedValueType(DataType dtype) {
+  return dtype == DT_INT32 || dtype == DT_INT64 || dtype == DT_FLOAT ||
+         dtype == DT_DOUBLE;
+}
+
+absl::Status HashTableImage::Write(Env* env, const std::string& filename,
+                                   const Tensor& keys, const Tensor& values) {
+  if (!IsSupportedKeyType(keys.dtype())) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unsupported key type for a hash table image: ",
+                     DataTypeString(keys.dtype())));
+  }
+  if (!IsSupportedValueType(values.dtype())) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unsupported value type for a hash table image: ",
+                     DataTypeString(values.dtype())));
+  }
+  if (keys.dims() != 1 || values.dims() != 1 ||
+      keys.NumElements() != values.NumElements()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Expected keys and values to be 1-D tensors of the same size, got ",
+        keys.shape().DebugString(), " and ", values.shape().DebugString()));
+  }
+
+  const int64_t num_keys = keys.NumElements();
+  std::vector<Slot> slots(NumSlotsFor(num_keys), Slot{0, 0, 0});
+  uint64_t num_entries = 0;
+  std::string key_blob;
+  if (keys.dtype() == DT_INT64) {
+    const auto keys_flat = keys.flat<int64_t>();
+    TF_RETURN_IF_ERROR(InsertAll(
+        values, num_keys, [&](int64_t i) { return keys_flat(i); },
+        [&](int64_t i) { return static_cast<uint64_t>(keys_flat(i)); },
+        [](const Slot& slot) { return static_cast<int64_t>(slot.key); },
+        &slots, &num_entries));
+  } else {
+    const auto keys_flat = keys.flat<tstring>();
+    auto key_view = [&](int64_t i) {
+      return absl::string_view(keys_flat(i).data(), keys_flat(i).size());
+    };
+    // Key offsets are only recorded for keys that end up in a slot, so the
+    // blob of a table with duplicate keys holds each key once.
+    TF_RETURN_IF_ERROR(InsertAll(
+        values, num_keys, key_view,
+        [&](int64_t i) {
+          const absl::string_view key = key_view(i);
+          const uint64_t offset = key_blob.size();
+          const uint32_t length = key.size();
+          key_blob.append(reinterpret_cast<const char*>(&length),
+                          sizeof(length));
+          key_blob.append(key.data(), key.size());
+          return offset;
+        },
+        [&](const Slot& slot) {
+          uint32_t length;
+          std::memcpy(&length, key_blob.data() + slot.key, sizeof(length));
+          return absl::string_view(key_blob.data() + slot.key + sizeof(length),
+                                   length);
+        },
+        &slots, &num_entries));
+  }
+
+  Header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.endian_check = kEndianCheck;
+  header.key_dtype = keys.dtype();
+  header.value_dtype = values.dtype();
+  header.num_entries = num_entries;
+  header.num_slots = slots.size();
+  header.slots_offset = sizeof(Header);
+  header.keys_offset = header.slots_offset + slots.size() * sizeof(Slot);
+  header.keys_size = key_blob.size();
+
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+  TF_RETURN_IF_ERROR(file->Append(absl::string_view(
+      reinterpret_cast<const char*>(&header), sizeof(header))));
+  TF_RETURN_IF_ERROR(file->Append(
+      absl::string_view(reinterpret_cast<const char*>(slots.data()),
+                        slots.size() * sizeof(Slot))));
+  TF_RETURN_IF_ERROR(file->Append(key_blob));
+  return file->Close();
+}
+
+absl::Status HashTableImage::Open(Env* env, const std::string& filename,
+                                  std::unique_ptr<HashTableImage>* image) {
+  std::unique_ptr<HashTableImage> result(new HashTableImage);
+  absl::Status s =
+      env->NewReadOnlyMemoryRegionFromFile(filename, &result->region_);
+  if (s.ok()) {
+    TF_RETURN_IF_ERROR(
+        result->Parse(static_cast<const char*>(result->region_->data()),
+                      result->region_->length()));
+  } else if (absl::IsUnimplemented(s)) {
+    TF_RETURN_IF_ERROR(ReadFileToString(env, filename, &result->contents_));
+    TF_RETURN_IF_ERROR(
+        result->Parse(result->contents_.data(), result->contents_.size()));
+  } else {
+    return s;
+  }
+  *image = std::move(result);
+  return absl::OkStatus();
+}
+
+absl::Status HashTableImage::Parse(const char* data, uint64_t length) {
+  if (length < sizeof(Header)) {
+    return absl::DataLossError("Hash table image is truncated.");
+  }
+  Header header;
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    return absl::DataLossError("Not a hash table image.");
+  }
+  if (header.version != kVersion) {
+    return absl::DataLossError(absl::StrCat(
+        "Unsupported hash table image version ", header.version));
+  }
+  if (header.endian_check != kEndianCheck) {
+    return absl::DataLossError(
+        "Hash table image was written on a host with a different byte order.");
+  }
+  if (!IsSupportedKeyType(static_cast<DataType>(header.key_dtype)) ||
+      !IsSupportedValueType(static_cast<DataType>(header.value_dtype))) {
+    return absl::DataLossError("Hash table image has unsupported data types.");
+  }
+  const uint64_t num_slots = header.num_slots;
+  if (num_slots == 0 || (num_slots & (num_slots - 1)) != 0 ||
+      header.num_entries > num_slots) {
+    return absl::DataLossError("Hash table image has an invalid slot count.");
+  }
+  if (header.slots_offset != sizeof(Header) ||
+      num_slots > (length - header.slots_offset) / sizeof(Slot) ||
+      header.keys_offset != header.slots_offset + num_slots * sizeof(Slot) ||
+      header.keys_size > length - header.keys_offset) {
+    return absl::DataLossError("Hash table image is truncated.");
+  }
+  if (header.keys_size != length - header.keys_offset) {
+    return absl::DataLossError(absl::StrCat(
+        "Hash table image should be ", header.keys_offset + header.keys_size,
+        " bytes long but is ", length, " bytes long."));
+  }
+  if (reinterpret_cast<uintptr_t>(data + header.slots_offset) %
+          alignof(Slot) !=
+      0) {
+    return absl::InternalError("Hash table image is not suitably aligned.");
+  }
+  // Exporting the table sizes its outputs by `num_entries`, so it must match
+  // the number of non-empty slots exactly.
+  const Slot* slots = reinterpret_cast<const Slot*>(data + header.slots_offset);
+  uint64_t num_occupied = 0;
+  for (uint64_t s = 0; s < num_slots; ++s) {
+    if (slots[s].hash != 0) ++num_occupied;
+  }
+  if (num_occupied != header.num_entries) {
+    return absl::DataLossError(absl::StrCat(
+        "Hash table image records ", header.num_entries, " entries but has ",
+        num_occupied, " non-empty slots."));
+  }
+
+  key_dtype_ = static_cast<DataType>(header.key_dtype);
+  value_dtype_ = static_cast<DataType>(header.value_dtype);
+  num_entries_ = header.num_entries;
+  num_slots_ = num_slots;
+  length_ = length;
+  slots_ = slots;
+  key_blob_ = data + header.keys_offset;
+  key_blob_size_ = header.keys_size;
+  return absl::OkStatus();
+}
+
+absl::string_view HashTableImage::StringKey(const Slot& slot) const {
+  uint32_t length;
+  if (slot.key > key_blob_size_ ||
+      key_blob_size_ - slot.key < sizeof(length)) {
+    return absl::string_view();
+  }
+  std::memcpy(&length, key_blob_ + slot.key, sizeof(length));
+  const uint64_t start = slot.key + sizeof(length);
+  if (length > key_blob_size_ - start) {
+    return absl::string_view();
+  }
+  return absl::string_view(key_blob_ + start, length);
+}
+
+const HashTableImage::Slot* HashTableImage::Find(int64_t key) const {
+  const uint64_t hash = HashKey(key);
+  const uint64_t mask = num_slots_ - 1;
+  // The writer leaves at least half of the slots empty, but bound the probe
+  // sequence anyway so that a corrupt image cannot loop forever.
+  uint64_t s = hash & mask;
+  for (int64_t probes = 0; probes < num_slots_; ++probes, s = (s + 1) & mask) {
+    const Slot& slot = slots_[s];
+    if (slot.hash == 0) return nullptr;
+    if (slot.hash == hash && static_cast<int64_t>(slot.key) == key) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+const HashTableImage::Slot* HashTableImage::Find(absl::string_view key) const {
+  const uint64_t hash = HashKey(key);
+  const uint64_t mask = num_slots_ - 1;
+  uint64_t s = hash & mask;
+  for (int64_t probes = 0; probes < num_slots_; ++probes, s = (s + 1) & mask) {
+    const Slot& slot = slots_[s];
+    if (slot.hash == 0) return nullptr;
+    if (slot.hash == hash && StringKey(slot) == key) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+absl::Status MemoryMappedLookupTable::InitializeFromImage(
+    Env* env, const std::string& filename,
+    std::unique_ptr<InitializerSerializer> serializer) {
+  return InitializeWith(
+      [this, env, &filename]() -> absl::Status {
+        std::unique_ptr<HashTableImage> image;
+        TF_RETURN_IF_ERROR(HashTableImage::Open(env, filename, &image));
+        if (image->key_dtype() != key_dtype() ||
+            image->value_dtype() != value_dtype()) {
+          return absl::InvalidArgumentError(absl::StrCat(
+              "Hash table image ", filename, " maps ",
+              DataTypeString(image->key_dtype()), " to ",
+              DataTypeString(image->value_dtype()), ", but the table maps ",
+              DataTypeString(key_dtype()), " to ",
+              DataTypeString(value_dtype())));
+        }
+        image_ = std::move(image);
+        return absl::OkStatus();
+      },
+      std::move(serializer));
+}
+
+absl::Status MemoryMappedLookupTable::AsGraphDef(GraphDefBuilder* builder,
+                                                 Node** out) const {
+  // As for HashTable, use_node_name_sharing with a unique node name lets the
+  // resource outlive the kernel that creates it.
+  static std::atomic<int64_t> counter(0);
+  Node* table_node = ops::SourceOp(
+      "MemoryMappedHashTable",
+      builder->opts()
+          .WithName(absl::StrCat("MemoryMappedHashTableFromGraphDef/",
+                                 counter.fetch_add(1), "/", random::New64()))
+          .WithAttr("key_dtype", key_dtype())
+          .WithAttr("value_dtype", value_dtype())
+          .WithAttr("use_node_name_sharing", true));
+  if (!is_initialized()) {
+    *out = table_node;
+    return absl::OkStatus();
+  }
+  if (initializer_serializer_ == nullptr) {
+    return absl::UnimplementedError(
+        "Failed to serialize lookup table: no initialization function was "
+        "specified.");
+  }
+  Node* initializer;
+  TF_RETURN_IF_ERROR(
+      initializer_serializer_->AsGraphDef(builder, table_node, &initializer));
+  *out = ops::UnaryOp("Identity", table_node,
+                      builder->opts().WithControlInput(initializer));
+  return absl::OkStatus();
+}
+
+absl::Status MemoryMappedLookupTable::DoPrepare(size_t size) {
+  return absl::UnimplementedError(
+      "MemoryMappedHashTable can only be initialized from a hash table image.");
+}
+
+absl::Status MemoryMappedLookupTable::DoInsert(const Tensor& keys,
+                                               const Tensor& values) {
+  return absl::UnimplementedError(
+      "MemoryMappedHashTable can only be initialized from a hash table image.");
+}
+
+}  // namespace lookup
+}  // namespace tensorflow
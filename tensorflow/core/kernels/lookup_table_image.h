@@ -0,0 +1,229 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_IMAGE_H_
+#define TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_IMAGE_H_
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system.h"
+
+namespace tensorflow {
+namespace lookup {
+
+// A precompiled, read-only image of a hash table, stored in a single file.
+//
+// The image is an open-addressing (linear probing) hash table whose slots can
+// be probed in place, so the file can be memory-mapped and served without
+// parsing or copying it. Processes that map the same image share its physical
+// pages.
+//
+// File layout (host byte order, checked at load time):
+//
+//   Header                    64 bytes
+//   Slot[num_slots]           24 bytes each; `num_slots` is a power of two
+//   Key blob                  string keys only: {uint32 length, bytes}*
+//
+// A slot holds the (non-zero) hash of its key, the key itself for integer keys
+// or the offset of the key in the key blob for string keys, and the value,
+// stored in the low bytes of a 64-bit word. A zero hash marks an empty slot.
+//
+// Supported key types are int64 and string; supported value types are int32,
+// int64, float and double.
+class HashTableImage {
+ public:
+  struct Slot {
+    uint64_t hash;
+    uint64_t key;
+    uint64_t value;
+  };
+
+  // Writes an image containing the key/value pairs in the 1-D tensors `keys`
+  // and `values` to `filename`. Returns FailedPrecondition if a key appears
+  // more than once with different values.
+  static absl::Status Write(Env* env, const std::string& filename,
+                            const Tensor& keys, const Tensor& values);
+
+  // Opens the image in `filename`, memory-mapping it if the file system
+  // supports it and reading it into memory otherwise.
+  static absl::Status Open(Env* env, const std::string& filename,
+                           std::unique_ptr<HashTableImage>* image);
+
+  // Returns true if `dtype` can be used as a key (resp. value) type.
+  static bool IsSupportedKeyType(DataType dtype);
+  static bool IsSupportedValueType(DataType dtype);
+
+  DataType key_dtype() const { return key_dtype_; }
+  DataType value_dtype() const { return value_dtype_; }
+  int64_t size() const { return num_entries_; }
+  int64_t num_slots() const { return num_slots_; }
+  const Slot& slot(int64_t i) const { return slots_[i]; }
+
+  // Returns the number of bytes of the image.
+  uint64_t length() const { return length_; }
+
+  // Returns the string key of a non-empty slot of a table with string keys.
+  absl::string_view StringKey(const Slot& slot) const;
+
+  // Returns the slot holding `key`, or nullptr if the key is not present.
+  const Slot* Find(int64_t key) const;
+  const Slot* Find(absl::string_view key) const;
+
+  // Decodes the value of a slot.
+  template <typename V>
+  static V Value(const Slot& slot) {
+    static_assert(std::is_trivially_copyable<V>::value && sizeof(V) <= 8,
+                  "Unsupported value type");
+    V value;
+    std::memcpy(&value, &slot.value, sizeof(V));
+    return value;
+  }
+
+ private:
+  HashTableImage() = default;
+
+  absl::Status Parse(const char* data, uint64_t length);
+
+  // Exactly one of `region_` and `contents_` owns the image data.
+  std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  std::string contents_;
+
+  DataType key_dtype_ = DT_INVALID;
+  DataType value_dtype_ = DT_INVALID;
+  int64_t num_entries_ = 0;
+  int64_t num_slots_ = 0;
+  uint64_t length_ = 0;
+  const Slot* slots_ = nullptr;
+  const char* key_blob_ = nullptr;
+  uint64_t key_blob_size_ = 0;
+
+  HashTableImage(const HashTableImage&) = delete;
+  void operator=(const HashTableImage&) = delete;
+};
+
+// Base class of the lookup tables that serve lookups directly from a
+// HashTableImage.
+//
+// The table is initialized by `InitializeFromImage()` instead of by inserting
+// batches of keys and values, so initialization costs one `mmap` regardless
+// of the size of the table. Once initialized the table is read-only.
+class MemoryMappedLookupTable : public InitializableLookupTable {
+ public:
+  // Opens the image in `filename` and marks the table as initialized.
+  // `serializer` may specify how to represent the initializer as a GraphDef.
+  absl::Status InitializeFromImage(
+      Env* env, const std::string& filename,
+      std::unique_ptr<InitializerSerializer> serializer);
+
+  size_t size() const override {
+    return is_initialized() ? image_->size() : 0;
+  }
+
+  absl::Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override;
+
+  int64_t MemoryUsed() const override {
+    // The image is backed by (shared) file pages rather than the heap when it
+    // is memory-mapped, but account for it like any other table contents.
+    return is_initialized() ? image_->length() : 0;
+  }
+
+ protected:
+  absl::Status DoPrepare(size_t size) override;
+  absl::Status DoInsert(const Tensor& keys, const Tensor& values) override;
+
+  std::unique_ptr<HashTableImage> image_;
+};
+
+// A MemoryMappedLookupTable mapping keys of type K to values of type V.
+template <class K, class V>
+class MemoryMappedHashTable : public MemoryMappedLookupTable {
+ public:
+  MemoryMappedHashTable(OpKernelContext* ctx, OpKernel* kernel) {}
+
+  absl::Status ExportValues(OpKernelContext* context) override {
+    if (!is_initialized()) {
+      return absl::AbortedError("MemoryMappedHashTable is not initialized.");
+    }
+    const int64_t size = image_->size();
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(
+        context->allocate_output("keys", TensorShape({size}), &keys));
+    TF_RETURN_IF_ERROR(
+        context->allocate_output("values", TensorShape({size}), &values));
+    auto keys_data = keys->flat<K>();
+    auto values_data = values->flat<V>();
+    int64_t i = 0;
+    for (int64_t s = 0; s < image_->num_slots(); ++s) {
+      const HashTableImage::Slot& slot = image_->slot(s);
+      if (slot.hash == 0) continue;
+      keys_data(i) = GetKey(slot);
+      values_data(i) = HashTableImage::Value<V>(slot);
+      ++i;
+    }
+    return absl::OkStatus();
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+ protected:
+  absl::Status DoFind(const Tensor& key, Tensor* value,
+                      const Tensor& default_value) override {
+    const V default_val = default_value.flat<V>()(0);
+    const auto key_values = key.flat<K>();
+    auto value_values = value->flat<V>();
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      const HashTableImage::Slot* slot = image_->Find(LookupKey(key_values(i)));
+      value_values(i) =
+          slot == nullptr ? default_val : HashTableImage::Value<V>(*slot);
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  static int64_t LookupKey(int64_t key) { return key; }
+  static absl::string_view LookupKey(const tstring& key) {
+    return absl::string_view(key.data(), key.size());
+  }
+
+  template <typename T = K,
+            std::enable_if_t<std::is_same<T, int64_t>::value, bool> = true>
+  T GetKey(const HashTableImage::Slot& slot) const {
+    return static_cast<int64_t>(slot.key);
+  }
+  template <typename T = K,
+            std::enable_if_t<std::is_same<T, tstring>::value, bool> = true>
+  T GetKey(const HashTableImage::Slot& slot) const {
+    return tstring(image_->StringKey(slot));
+  }
+};
+
+}  // namespace lookup
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_IMAGE_H_
@@ -0,0 +1,243 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/lookup_table_image.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/lookup_table_op.h"
+#include "tensorflow/core/kernels/lookup_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+std::string ImagePath(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+TEST(HashTableImageTest, Int64Keys) {
+  const std::string filename = ImagePath("int64_keys.img");
+  TF_ASSERT_OK(HashTableImage::Write(
+      Env::Default(), filename,
+      test::AsTensor<int64_t>({-7, 0, 42, int64_t{1} << 40}),
+      test::AsTensor<float>({0.5f, 1.5f, 2.5f, 3.5f})));
+
+  std::unique_ptr<HashTableImage> image;
+  TF_ASSERT_OK(HashTableImage::Open(Env::Default(), filename, &image));
+  EXPECT_EQ(DT_INT64, image->key_dtype());
+  EXPECT_EQ(DT_FLOAT, image->value_dtype());
+  EXPECT_EQ(4, image->size());
+  EXPECT_EQ(8, image->num_slots());
+
+  const HashTableImage::Slot* slot = image->Find(int64_t{42});
+  ASSERT_NE(nullptr, slot);
+  EXPECT_EQ(2.5f, HashTableImage::Value<float>(*slot));
+  slot = image->Find(int64_t{1} << 40);
+  ASSERT_NE(nullptr, slot);
+  EXPECT_EQ(3.5f, HashTableImage::Value<float>(*slot));
+  EXPECT_EQ(nullptr, image->Find(int64_t{43}));
+}
+
+TEST(HashTableImageTest, StringKeys) {
+  const std::string filename = ImagePath("string_keys.img");
+  TF_ASSERT_OK(HashTableImage::Write(
+      Env::Default(), filename,
+      test::AsTensor<tstring>({"", "brain", "salad", "surgery"}),
+      test::AsTensor<int64_t>({0, 1, 2, 3})));
+
+  std::unique_ptr<HashTableImage> image;
+  TF_ASSERT_OK(HashTableImage::Open(Env::Default(), filename, &image));
+  EXPECT_EQ(DT_STRING, image->key_dtype());
+  EXPECT_EQ(4, image->size());
+  for (const auto& [key, value] :
+       {std::pair<std::string, int64_t>{"", 0}, {"brain", 1}, {"salad", 2},
+        {"surgery", 3}}) {
+    const HashTableImage::Slot* slot = image->Find(absl::string_view(key));
+    ASSERT_NE(nullptr, slot) << key;
+    EXPECT_EQ(key, image->StringKey(*slot));
+    EXPECT_EQ(value, HashTableImage::Value<int64_t>(*slot));
+  }
+  EXPECT_EQ(nullptr, image->Find(absl::string_view("brains")));
+}
+
+TEST(HashTableImageTest, EmptyTable) {
+  const std::string filename = ImagePath("empty.img");
+  TF_ASSERT_OK(HashTableImage::Write(Env::Default(), filename,
+                                     Tensor(DT_INT64, TensorShape({0})),
+                                     Tensor(DT_DOUBLE, TensorShape({0}))));
+
+  std::unique_ptr<HashTableImage> image;
+  TF_ASSERT_OK(HashTableImage::Open(Env::Default(), filename, &image));
+  EXPECT_EQ(0, image->size());
+  EXPECT_EQ(nullptr, image->Find(int64_t{0}));
+}
+
+TEST(HashTableImageTest, DuplicateKeys) {
+  const std::string filename = ImagePath("duplicates.img");
+  TF_ASSERT_OK(HashTableImage::Write(Env::Default(), filename,
+                                     test::AsTensor<tstring>({"a", "b", "a"}),
+                                     test::AsTensor<int32_t>({1, 2, 1})));
+  std::unique_ptr<HashTableImage> image;
+  TF_ASSERT_OK(HashTableImage::Open(Env::Default(), filename, &image));
+  EXPECT_EQ(2, image->size());
+
+  EXPECT_TRUE(absl::IsFailedPrecondition(HashTableImage::Write(
+      Env::Default(), filename, test::AsTensor<tstring>({"a", "b", "a"}),
+      test::AsTensor<int32_t>({1, 2, 3}))));
+}
+
+TEST(HashTableImageTest, UnsupportedTypes) {
+  EXPECT_TRUE(absl::IsInvalidArgument(HashTableImage::Write(
+      Env::Default(), ImagePath("unsupported.img"),
+      test::AsTensor<int32_t>({1}), test::AsTensor<int64_t>({1}))));
+  EXPECT_TRUE(absl::IsInvalidArgument(HashTableImage::Write(
+      Env::Default(), ImagePath("unsupported.img"),
+      test::AsTensor<int64_t>({1}), test::AsTensor<tstring>({"a"}))));
+}
+
+TEST(HashTableImageTest, RejectsCorruptImages) {
+  const std::string filename = ImagePath("corrupt.img");
+  TF_ASSERT_OK(HashTableImage::Write(Env::Default(), filename,
+                                     test::AsTensor<int64_t>({1, 2, 3}),
+                                     test::AsTensor<int64_t>({4, 5, 6})));
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+
+  std::unique_ptr<HashTableImage> image;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename,
+                                 contents.substr(0, contents.size() - 1)));
+  EXPECT_TRUE(absl::IsDataLoss(
+      HashTableImage::Open(Env::Default(), filename, &image)));
+
+  std::string bad_magic = contents;
+  bad_magic[0] = 'X';
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, bad_magic));
+  EXPECT_TRUE(absl::IsDataLoss(
+      HashTableImage::Open(Env::Default(), filename, &image)));
+
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename,
+                                 absl::StrCat(contents, "trailing")));
+  EXPECT_TRUE(absl::IsDataLoss(
+      HashTableImage::Open(Env::Default(), filename, &image)));
+
+  // The entry count lives at offset 24 of the header.
+  std::string bad_num_entries = contents;
+  const uint64_t num_entries = 2;
+  std::memcpy(&bad_num_entries[24], &num_entries, sizeof(num_entries));
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, bad_num_entries));
+  EXPECT_TRUE(absl::IsDataLoss(
+      HashTableImage::Open(Env::Default(), filename, &image)));
+}
+
+TEST(MemoryMappedHashTableTest, FindAfterInitialization) {
+  const std::string filename = ImagePath("table.img");
+  TF_ASSERT_OK(HashTableImage::Write(
+      Env::Default(), filename, test::AsTensor<tstring>({"a", "b", "c"}),
+      test::AsTensor<int64_t>({1, 2, 3})));
+
+  auto* table = new MemoryMappedHashTable<tstring, int64_t>(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  Tensor values(DT_INT64, TensorShape({4}));
+  EXPECT_TRUE(absl::IsFailedPrecondition(
+      table->Find(nullptr, test::AsTensor<tstring>({"a", "b", "c", "d"}),
+                  &values, test::AsScalar<int64_t>(-1))));
+
+  TF_ASSERT_OK(table->InitializeFromImage(Env::Default(), filename,
+                                          /*serializer=*/nullptr));
+  EXPECT_TRUE(table->is_initialized());
+  EXPECT_EQ(3, table->size());
+  TF_ASSERT_OK(table->Find(nullptr,
+                           test::AsTensor<tstring>({"a", "b", "c", "d"}),
+                           &values, test::AsScalar<int64_t>(-1)));
+  test::ExpectTensorEqual<int64_t>(test::AsTensor<int64_t>({1, 2, 3, -1}),
+                                   values);
+}
+
+TEST(MemoryMappedHashTableTest, RejectsMismatchedImage) {
+  const std::string filename = ImagePath("mismatched.img");
+  TF_ASSERT_OK(HashTableImage::Write(Env::Default(), filename,
+                                     test::AsTensor<int64_t>({1}),
+                                     test::AsTensor<float>({1.0f})));
+
+  auto* table = new MemoryMappedHashTable<int64_t, int64_t>(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  EXPECT_TRUE(absl::IsInvalidArgument(table->InitializeFromImage(
+      Env::Default(), filename, /*serializer=*/nullptr)));
+  EXPECT_FALSE(table->is_initialized());
+}
+
+// Writes a vocabulary of `num_words` words, one per line, and the equivalent
+// hash table image mapping each word to its line number.
+void WriteVocabulary(int num_words, std::string* vocab_filename,
+                     std::string* image_filename) {
+  *vocab_filename = ImagePath(absl::StrCat("vocab_", num_words, ".txt"));
+  *image_filename = ImagePath(absl::StrCat("vocab_", num_words, ".img"));
+  Tensor keys(DT_STRING, TensorShape({num_words}));
+  Tensor values(DT_INT64, TensorShape({num_words}));
+  std::string contents;
+  for (int i = 0; i < num_words; ++i) {
+    keys.flat<tstring>()(i) = absl::StrCat("word", i);
+    values.flat<int64_t>()(i) = i;
+    absl::StrAppend(&contents, "word", i, "\n");
+  }
+  TF_CHECK_OK(WriteStringToFile(Env::Default(), *vocab_filename, contents));
+  TF_CHECK_OK(HashTableImage::Write(Env::Default(), *image_filename, keys,
+                                    values));
+}
+
+// Measures the time to load a vocabulary into a HashTable from a text file.
+void BM_InitializeTableFromTextFile(::testing::benchmark::State& state) {
+  std::string vocab_filename, image_filename;
+  WriteVocabulary(state.range(0), &vocab_filename, &image_filename);
+  for (auto s : state) {
+    auto* table = new HashTable<tstring, int64_t>(nullptr, nullptr);
+    TF_CHECK_OK(InitializeTableFromTextFile(
+        vocab_filename, /*vocab_size=*/-1, /*delimiter=*/'\t',
+        /*key_index=*/-2 /* whole line */, /*value_index=*/-1 /* line number */,
+        /*offset=*/0, Env::Default(), table));
+    table->Unref();
+  }
+}
+BENCHMARK(BM_InitializeTableFromTextFile)->Arg(1 << 10)->Arg(1 << 20);
+
+// Measures the time to load the same vocabulary from a hash table image.
+void BM_InitializeTableFromHashTableImage(::testing::benchmark::State& state) {
+  std::string vocab_filename, image_filename;
+  WriteVocabulary(state.range(0), &vocab_filename, &image_filename);
+  for (auto s : state) {
+    auto* table = new MemoryMappedHashTable<tstring, int64_t>(nullptr, nullptr);
+    TF_CHECK_OK(table->InitializeFromImage(Env::Default(), image_filename,
+                                           /*serializer=*/nullptr));
+    table->Unref();
+  }
+}
+BENCHMARK(BM_InitializeTableFromHashTableImage)->Arg(1 << 10)->Arg(1 << 20);
+
+}  // namespace
+}  // namespace lookup
+}  // namespace tensorflow
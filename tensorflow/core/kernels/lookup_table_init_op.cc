@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/kernels/lookup_table_image.h"
 #include "tensorflow/core/kernels/lookup_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -199,4 +200,104 @@ REGISTER_KERNEL_BUILDER(Name("InitializeTableFromTextFile").Device(DEVICE_CPU),
 REGISTER_KERNEL_BUILDER(
     Name("InitializeTableFromTextFileV2").Device(DEVICE_CPU),
     InitializeTableFromTextFileOp);
+
+// Kernel to initialize a memory-mapped hash table from a hash table image.
+// After this operation, the table becomes read-only.
+class InitializeTableFromHashTableImageOp : public OpKernel {
+ public:
+  explicit InitializeTableFromHashTableImageOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    mutex_lock l(mu_);
+    lookup::InitializableLookupTable* table;
+    OP_REQUIRES_OK(ctx,
+                   GetInitializableLookupTable("table_handle", ctx, &table));
+    core::ScopedUnref unref_me(table);
+
+    lookup::MemoryMappedLookupTable* mapped_table =
+        dynamic_cast<lookup::MemoryMappedLookupTable*>(table);
+    OP_REQUIRES(ctx, mapped_table != nullptr,
+                absl::InvalidArgumentError(
+                    "Only tables created by MemoryMappedHashTable can be "
+                    "initialized from a hash table image."));
+
+    DataTypeVector expected_inputs = {DT_RESOURCE, DT_STRING};
+    DataTypeVector expected_outputs = {};
+    OP_REQUIRES_OK(ctx, ctx->MatchSignature(expected_inputs, expected_outputs));
+
+    const Tensor& filename_tensor = ctx->input(1);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(filename_tensor.shape()),
+                absl::InvalidArgumentError(
+                    absl::StrCat("filename should be a single string, but got ",
+                                 filename_tensor.shape().DebugString())));
+    const std::string& filename = filename_tensor.scalar<tstring>()();
+    OP_REQUIRES(ctx, !filename.empty(),
+                absl::InvalidArgumentError("filename cannot be empty."));
+
+    int64_t memory_used_before = 0;
+    if (ctx->track_allocations()) {
+      memory_used_before = table->MemoryUsed();
+    }
+    OP_REQUIRES_OK(ctx, mapped_table->InitializeFromImage(
+                            ctx->env(), filename,
+                            MakeInitializerSerializer(filename_tensor)));
+    if (ctx->track_allocations()) {
+      ctx->record_persistent_memory_allocation(table->MemoryUsed() -
+                                               memory_used_before);
+    }
+  }
+
+ private:
+  std::unique_ptr<InitializerSerializer> MakeInitializerSerializer(
+      Tensor filename) {
+    return std::make_unique<InitializerSerializer>(
+        [filename](GraphDefBuilder* builder, Node* table, Node** out) {
+          Node* filename_node =
+              ops::SourceOp("Const", builder->opts()
+                                         .WithAttr("dtype", filename.dtype())
+                                         .WithAttr("value", filename));
+          Node* import_table =
+              ops::BinaryOp("InitializeTableFromHashTableImage", table,
+                            filename_node, builder->opts());
+          *out = ops::UnaryOp("Identity", table,
+                              builder->opts().WithControlInput(import_table));
+          return absl::OkStatus();
+        });
+  }
+
+  mutex mu_;
+
+  InitializeTableFromHashTableImageOp(
+      const InitializeTableFromHashTableImageOp&) = delete;
+  void operator=(const InitializeTableFromHashTableImageOp&) = delete;
+};
+
+REGISTER_KERNEL_BUILDER(
+    Name("InitializeTableFromHashTableImage").Device(DEVICE_CPU),
+    InitializeTableFromHashTableImageOp);
+
+// Kernel to write the given keys and values to a hash table image.
+class WriteHashTableImageOp : public OpKernel {
+ public:
+  explicit WriteHashTableImageOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& filename_tensor = ctx->input(0);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(filename_tensor.shape()),
+                absl::InvalidArgumentError(
+                    absl::StrCat("filename should be a single string, but got ",
+                                 filename_tensor.shape().DebugString())));
+    const std::string& filename = filename_tensor.scalar<tstring>()();
+    OP_REQUIRES(ctx, !filename.empty(),
+                absl::InvalidArgumentError("filename cannot be empty."));
+    OP_REQUIRES_OK(ctx, lookup::HashTableImage::Write(
+                            ctx->env(), filename, ctx->input(1),
+                            ctx->input(2)));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("WriteHashTableImage").Device(DEVICE_CPU),
+                        WriteHashTableImageOp);
+
 }  // namespace tensorflow
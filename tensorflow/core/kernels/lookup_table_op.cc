@@ -19,12 +19,15 @@ limitations under the License.
 #include <type_traits>
 #include <utility>
 
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/kernels/lookup_table_image.h"
+#include "tensorflow/core/kernels/lookup_table_snapshot.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/random.h"
@@ -37,12 +40,31 @@ std::string UniqueNodeName(const std::string& base) {
   return strings::StrCat(base, "/", counter.fetch_add(1), "/", random::New64());
 }
 
+namespace {
+
+// Returns true if the table created by `kernel` should hold its contents in a
+// ReadOptimizedSnapshot. Only the V2 mutable hash table ops define the
+// "experimental_read_optimized" attr.
+bool IsReadOptimized(OpKernel* kernel) {
+  bool read_optimized = false;
+  return TryGetNodeAttr(kernel->def(), "experimental_read_optimized",
+                        &read_optimized) &&
+         read_optimized;
+}
+
+}  // namespace
+
 // Lookup table that wraps an unordered_map, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
 //
 // This table is mutable and thread safe - Insert can be called at any time.
 //
+// If the "experimental_read_optimized" attr is true, the map is held in a
+// ReadOptimizedSnapshot instead of behind a reader/writer lock: lookups do not
+// take any lock, and every Insert/Remove/Import publishes a new copy of the
+// map.
+//
 // Sample use case:
 //
 // MutableHashTableOfScalars<int64, int64> table;  // int64 -> int64.
@@ -54,11 +76,15 @@ std::string UniqueNodeName(const std::string& base) {
 template <class K, class V>
 class MutableHashTableOfScalars final : public LookupInterface {
  public:
-  MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
+  MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {
+    if (IsReadOptimized(kernel)) {
+      snapshot_ = std::make_unique<ReadOptimizedSnapshot<Map>>(
+          std::make_unique<Map>());
+    }
+  }
 
   size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
+    return ReadTable([](const Map& table) { return table.size(); });
   }
 
   absl::Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
@@ -71,34 +97,32 @@ class MutableHashTableOfScalars final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      // is_full_size_default is true:
-      //   Each key has an independent default value, key_values(i)
-      //   corresponding uses default_flat(i) as its default value.
-      //
-      // is_full_size_default is false:
-      //   All keys will share the default_flat(0) as default value.
-      value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)),
-          is_full_size_default ? default_flat(i) : default_flat(0));
-    }
-
-    return absl::OkStatus();
+    return ReadTable([&](const Map& table) {
+      for (int64_t i = 0; i < key_values.size(); ++i) {
+        // is_full_size_default is true:
+        //   Each key has an independent default value, key_values(i)
+        //   corresponding uses default_flat(i) as its default value.
+        //
+        // is_full_size_default is false:
+        //   All keys will share the default_flat(0) as default value.
+        value_values(i) = gtl::FindWithDefault(
+            table, SubtleMustCopyIfIntegral(key_values(i)),
+            is_full_size_default ? default_flat(i) : default_flat(0));
+      }
+      return absl::OkStatus();
+    });
   }
 
   absl::Status DoInsert(bool clear, const Tensor& keys, const Tensor& values) {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          SubtleMustCopyIfIntegral(value_values(i)));
-    }
+    UpdateTable(clear, [&](Map* table) {
+      for (int64_t i = 0; i < key_values.size(); ++i) {
+        gtl::InsertOrUpdate(table, SubtleMustCopyIfIntegral(key_values(i)),
+                            SubtleMustCopyIfIntegral(value_values(i)));
+      }
+    });
     return absl::OkStatus();
   }
 
@@ -110,10 +134,11 @@ class MutableHashTableOfScalars final : public LookupInterface {
   absl::Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    UpdateTable(/*clear=*/false, [&](Map* table) {
+      for (int64_t i = 0; i < key_values.size(); ++i) {
+        table->erase(SubtleMustCopyIfIntegral(key_values(i)));
+      }
+    });
     return absl::OkStatus();
   }
 
@@ -123,17 +148,18 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
   absl::Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("values", TensorShape({size}), &values));
-    ExportKeysAndValues(keys, values);
-    return absl::OkStatus();
+    return ReadTable([&](const Map& table) -> absl::Status {
+      int64_t size = table.size();
+
+      Tensor* keys;
+      Tensor* values;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("keys", TensorShape({size}), &keys));
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("values", TensorShape({size}), &values));
+      ExportKeysAndValues(table, keys, values);
+      return absl::OkStatus();
+    });
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -145,25 +171,30 @@ class MutableHashTableOfScalars final : public LookupInterface {
   TensorShape value_shape() const override { return TensorShape(); }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
+    int64_t ret = ReadTable([](const Map& table) {
+      int64_t num_entries = 0;
+      for (unsigned i = 0; i < table.bucket_count(); ++i) {
+        size_t bucket_size = table.bucket_size(i);
+        if (bucket_size == 0) {
+          num_entries++;
+        } else {
+          num_entries += bucket_size;
+        }
       }
-    }
+      return num_entries;
+    });
     return sizeof(MutableHashTableOfScalars) + ret;
   }
 
   absl::Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys;
+    Tensor values;
+    ReadTable([&](const Map& table) {
+      int64_t size = table.size();
+      keys = Tensor(key_dtype(), TensorShape({size}));
+      values = Tensor(value_dtype(), TensorShape({size}));
+      ExportKeysAndValues(table, &keys, &values);
+    });
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableV2 kernel. This means that the lifetime
@@ -171,13 +202,17 @@ class MutableHashTableOfScalars final : public LookupInterface {
     // is created in.
     // TODO(b/181695913): Provide a mechanism for deleting this resource
     // earlier when appropriate.
-    Node* table = ops::SourceOp(
-        "MutableHashTableV2",
+    const GraphDefBuilder::Options table_opts =
         builder->opts()
             .WithName(UniqueNodeName("MutableHashTableFromGraphDef"))
             .WithAttr("use_node_name_sharing", true)
             .WithAttr("key_dtype", key_dtype())
-            .WithAttr("value_dtype", value_dtype()));
+            .WithAttr("value_dtype", value_dtype());
+    Node* table = ops::SourceOp(
+        "MutableHashTableV2",
+        snapshot_ != nullptr
+            ? table_opts.WithAttr("experimental_read_optimized", true)
+            : table_opts);
     Node* keys_node = ops::SourceOp(
         "Const",
         builder->opts().WithAttr("dtype", key_dtype()).WithAttr("value", keys));
@@ -196,21 +231,49 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
  private:
+  typedef std::unordered_map<K, V> Map;
+
+  // Invokes `fn` on the contents of the table and returns its result.
+  template <typename Fn>
+  auto ReadTable(Fn&& fn) const {
+    if (snapshot_ != nullptr) {
+      return snapshot_->Read(std::forward<Fn>(fn));
+    }
+    tf_shared_lock l(mu_);
+    return fn(table_);
+  }
+
+  // Invokes `fn` on the contents of the table, after clearing them if `clear`
+  // is true, and makes the result visible to subsequent reads.
+  void UpdateTable(bool clear, absl::FunctionRef<void(Map*)> fn) {
+    if (snapshot_ != nullptr) {
+      snapshot_->Update(clear, fn);
+      return;
+    }
+    mutex_lock l(mu_);
+    if (clear) {
+      table_.clear();
+    }
+    fn(&table_);
+  }
+
   // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  // must point to tensors of size `table.size()`.
+  static void ExportKeysAndValues(const Map& table, Tensor* keys,
+                                  Tensor* values) {
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
+    for (auto it = table.begin(); it != table.end(); ++it, ++i) {
       keys_data(i) = it->first;
       values_data(i) = it->second;
     }
   }
 
   mutable mutex mu_;
-  std::unordered_map<K, V> table_ TF_GUARDED_BY(mu_);
+  Map table_ TF_GUARDED_BY(mu_);
+  // If not null, holds the contents of the table instead of `table_`.
+  std::unique_ptr<ReadOptimizedSnapshot<Map>> snapshot_;
 };
 
 // Lookup table that wraps an unordered_map. Behaves identical to
@@ -225,11 +288,14 @@ class MutableHashTableOfTensors final : public LookupInterface {
                 absl::InvalidArgumentError(
                     absl::StrCat("Default value must be a vector, got shape ",
                                  value_shape_.DebugString())));
+    if (IsReadOptimized(kernel)) {
+      snapshot_ = std::make_unique<ReadOptimizedSnapshot<Map>>(
+          std::make_unique<Map>());
+    }
   }
 
   size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
+    return ReadTable([](const Map& table) { return table.size(); });
   }
 
   absl::Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
@@ -243,29 +309,29 @@ class MutableHashTableOfTensors final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec =
-          gtl::FindOrNull(table_, SubtleMustCopyIfIntegral(key_values(i)));
-      if (value_vec != nullptr) {
-        for (int64_t j = 0; j < value_dim; j++) {
-          value_values(i, j) = value_vec->at(j);
-        }
-      } else {
-        // is_full_size_default is true:
-        //   Each key has an independent default value, key_values(i)
-        //   corresponding uses default_flat(i) as its default value.
-        //
-        // is_full_size_default is false:
-        //   All keys will share the default_flat(0) as default value.
-        for (int64_t j = 0; j < value_dim; j++) {
-          value_values(i, j) =
-              is_full_size_default ? default_flat(i, j) : default_flat(0, j);
+    return ReadTable([&](const Map& table) {
+      for (int64_t i = 0; i < key_values.size(); ++i) {
+        const ValueArray* value_vec =
+            gtl::FindOrNull(table, SubtleMustCopyIfIntegral(key_values(i)));
+        if (value_vec != nullptr) {
+          for (int64_t j = 0; j < value_dim; j++) {
+            value_values(i, j) = value_vec->at(j);
+          }
+        } else {
+          // is_full_size_default is true:
+          //   Each key has an independent default value, key_values(i)
+          //   corresponding uses default_flat(i) as its default value.
+          //
+          // is_full_size_default is false:
+          //   All keys will share the default_flat(0) as default value.
+          for (int64_t j = 0; j < value_dim; j++) {
+            value_values(i, j) =
+                is_full_size_default ? default_flat(i, j) : default_flat(0, j);
+          }
         }
       }
-    }
-
-    return absl::OkStatus();
+      return absl::OkStatus();
+    });
   }
 
   absl::Status DoInsert(bool clear, const Tensor& keys, const Tensor& values) {
@@ -273,19 +339,17 @@ class MutableHashTableOfTensors final : public LookupInterface {
     const auto value_values = values.flat_inner_dims<V, 2>();
     int64_t value_dim = value_shape_.dim_size(0);
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      ValueArray value_vec;
-      for (int64_t j = 0; j < value_dim; j++) {
-        V value = value_values(i, j);
-        value_vec.push_back(value);
+    UpdateTable(clear, [&](Map* table) {
+      for (int64_t i = 0; i < key_values.size(); ++i) {
+        ValueArray value_vec;
+        for (int64_t j = 0; j < value_dim; j++) {
+          V value = value_values(i, j);
+          value_vec.push_back(value);
+        }
+        gtl::InsertOrUpdate(table, SubtleMustCopyIfIntegral(key_values(i)),
+                            value_vec);
       }
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          value_vec);
-    }
+    });
     return absl::OkStatus();
   }
 
@@ -297,10 +361,11 @@ class MutableHashTableOfTensors final : public LookupInterface {
   absl::Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    UpdateTable(/*clear=*/false, [&](Map* table) {
+      for (int64_t i = 0; i < key_values.size(); ++i) {
+        table->erase(SubtleMustCopyIfIntegral(key_values(i)));
+      }
+    });
     return absl::OkStatus();
   }
 
@@ -310,18 +375,19 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   absl::Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    int64_t value_dim = value_shape_.dim_size(0);
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(ctx->allocate_output(
-        "values", TensorShape({size, value_dim}), &values));
-    ExportKeysAndValues(keys, values);
-    return absl::OkStatus();
+    return ReadTable([&](const Map& table) -> absl::Status {
+      int64_t size = table.size();
+      int64_t value_dim = value_shape_.dim_size(0);
+
+      Tensor* keys;
+      Tensor* values;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("keys", TensorShape({size}), &keys));
+      TF_RETURN_IF_ERROR(ctx->allocate_output(
+          "values", TensorShape({size, value_dim}), &values));
+      ExportKeysAndValues(table, keys, values);
+      return absl::OkStatus();
+    });
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -333,25 +399,31 @@ class MutableHashTableOfTensors final : public LookupInterface {
   TensorShape value_shape() const override { return value_shape_; }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
+    int64_t ret = ReadTable([](const Map& table) {
+      int64_t num_entries = 0;
+      for (unsigned i = 0; i < table.bucket_count(); ++i) {
+        size_t bucket_size = table.bucket_size(i);
+        if (bucket_size == 0) {
+          num_entries++;
+        } else {
+          num_entries += bucket_size;
+        }
       }
-    }
+      return num_entries;
+    });
     return sizeof(MutableHashTableOfTensors) + ret;
   }
 
   absl::Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size, value_shape_.dim_size(0)}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys;
+    Tensor values;
+    ReadTable([&](const Map& table) {
+      int64_t size = table.size();
+      keys = Tensor(key_dtype(), TensorShape({size}));
+      values =
+          Tensor(value_dtype(), TensorShape({size, value_shape_.dim_size(0)}));
+      ExportKeysAndValues(table, &keys, &values);
+    });
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableOfTensorsV2 kernel. This means that the
@@ -359,14 +431,18 @@ class MutableHashTableOfTensors final : public LookupInterface {
     // manager it is created in.
     // TODO(b/181695913): Provide a mechanism for deleting this resource
     // earlier when appropriate.
-    Node* table =
-        ops::SourceOp("MutableHashTableOfTensorsV2",
-                      builder->opts()
-                          .WithName(UniqueNodeName("MutableHashTableOfTensors"))
-                          .WithAttr("use_node_name_sharing", true)
-                          .WithAttr("key_dtype", key_dtype())
-                          .WithAttr("value_dtype", value_dtype())
-                          .WithAttr("value_shape", value_shape_));
+    const GraphDefBuilder::Options table_opts =
+        builder->opts()
+            .WithName(UniqueNodeName("MutableHashTableOfTensors"))
+            .WithAttr("use_node_name_sharing", true)
+            .WithAttr("key_dtype", key_dtype())
+            .WithAttr("value_dtype", value_dtype())
+            .WithAttr("value_shape", value_shape_);
+    Node* table = ops::SourceOp(
+        "MutableHashTableOfTensorsV2",
+        snapshot_ != nullptr
+            ? table_opts.WithAttr("experimental_read_optimized", true)
+            : table_opts);
     Node* keys_node = ops::SourceOp(
         "Const",
         builder->opts().WithAttr("dtype", key_dtype()).WithAttr("value", keys));
@@ -385,17 +461,44 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
  private:
+  typedef gtl::InlinedVector<V, 4> ValueArray;
+  typedef std::unordered_map<K, ValueArray> Map;
+
+  // Invokes `fn` on the contents of the table and returns its result.
+  template <typename Fn>
+  auto ReadTable(Fn&& fn) const {
+    if (snapshot_ != nullptr) {
+      return snapshot_->Read(std::forward<Fn>(fn));
+    }
+    tf_shared_lock l(mu_);
+    return fn(table_);
+  }
+
+  // Invokes `fn` on the contents of the table, after clearing them if `clear`
+  // is true, and makes the result visible to subsequent reads.
+  void UpdateTable(bool clear, absl::FunctionRef<void(Map*)> fn) {
+    if (snapshot_ != nullptr) {
+      snapshot_->Update(clear, fn);
+      return;
+    }
+    mutex_lock l(mu_);
+    if (clear) {
+      table_.clear();
+    }
+    fn(&table_);
+  }
+
   // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  // must point to tensors of size `table.size()`.
+  void ExportKeysAndValues(const Map& table, Tensor* keys,
+                           Tensor* values) const {
     int64_t value_dim = value_shape_.dim_size(0);
     auto keys_data = keys->flat<K>();
     auto values_data = values->matrix<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
+    for (auto it = table.begin(); it != table.end(); ++it, ++i) {
       K key = it->first;
-      ValueArray value = it->second;
+      const ValueArray& value = it->second;
       keys_data(i) = key;
       for (int64_t j = 0; j < value_dim; j++) {
         values_data(i, j) = value[j];
@@ -405,8 +508,9 @@ class MutableHashTableOfTensors final : public LookupInterface {
 
   TensorShape value_shape_;
   mutable mutex mu_;
-  typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ TF_GUARDED_BY(mu_);
+  Map table_ TF_GUARDED_BY(mu_);
+  // If not null, holds the contents of the table instead of `table_`.
+  std::unique_ptr<ReadOptimizedSnapshot<Map>> snapshot_;
 };
 
 namespace {
@@ -1128,6 +1232,28 @@ REGISTER_KERNEL(tstring, tstring);
 
 #undef REGISTER_KERNEL
 
+// Register the MemoryMappedHashTable op with the key and value types that
+// hash table images support.
+#define REGISTER_KERNEL(key_dtype, value_dtype)                            \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("MemoryMappedHashTable")                                        \
+          .Device(DEVICE_CPU)                                              \
+          .TypeConstraint<key_dtype>("key_dtype")                          \
+          .TypeConstraint<value_dtype>("value_dtype"),                     \
+      LookupTableOp<lookup::MemoryMappedHashTable<key_dtype, value_dtype>, \
+                    key_dtype, value_dtype>)
+
+REGISTER_KERNEL(int64_t, double);
+REGISTER_KERNEL(int64_t, float);
+REGISTER_KERNEL(int64_t, int32_t);
+REGISTER_KERNEL(int64_t, int64_t);
+REGISTER_KERNEL(tstring, double);
+REGISTER_KERNEL(tstring, float);
+REGISTER_KERNEL(tstring, int32_t);
+REGISTER_KERNEL(tstring, int64_t);
+
+#undef REGISTER_KERNEL
+
 // Register the MutableHashTable op.
 #define REGISTER_KERNEL(key_dtype, value_dtype)                                \
   REGISTER_KERNEL_BUILDER(                                                     \
@@ -0,0 +1,141 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_SNAPSHOT_H_
+#define TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_SNAPSHOT_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "absl/functional/function_ref.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace lookup {
+
+// Holds an immutable version of a value of type `T` that is read by many
+// threads and occasionally replaced by a writer.
+//
+// Readers never take a lock: `Read()` registers the calling thread in a
+// reader count that lives on a cache line shared only with the threads that
+// hash to the same stripe, and then dereferences the current version. This
+// keeps concurrent lookups from contending on the single cache line of a
+// reader/writer lock.
+//
+// Writers are serialized. `Update()` builds a new version (a copy of the
+// current one, or an empty one), publishes it, and deletes the previous
+// version once every reader that might still observe it has finished. The
+// grace period uses the two-phase scheme of user-space RCU: readers count
+// themselves under one of two epoch parities, and a writer flips the epoch
+// twice, each time waiting for the readers of the retired parity to drain.
+//
+// Every update therefore costs a full copy of `T` plus the wait for in-flight
+// readers, so this is only appropriate for read-mostly data.
+template <typename T>
+class ReadOptimizedSnapshot {
+ public:
+  explicit ReadOptimizedSnapshot(std::unique_ptr<T> initial)
+      : current_(initial.release()) {}
+
+  ~ReadOptimizedSnapshot() { delete current_.load(std::memory_order_acquire); }
+
+  // Invokes `fn(const T&)` on the current version and returns its result.
+  // The reference must not be retained after `fn` returns.
+  template <typename Fn>
+  auto Read(Fn&& fn) const {
+    ReaderRegistration registration(this);
+    return std::forward<Fn>(fn)(*current_.load(std::memory_order_seq_cst));
+  }
+
+  // Creates a new version, invokes `fn(T*)` on it, and publishes it. If
+  // `clear` is true the new version starts out default-constructed, otherwise
+  // it starts out as a copy of the current version. Blocks until the previous
+  // version is no longer visible to any reader.
+  void Update(bool clear, absl::FunctionRef<void(T*)> fn) {
+    mutex_lock l(writer_mu_);
+    std::unique_ptr<T> next =
+        clear ? std::make_unique<T>()
+              : std::make_unique<T>(*current_.load(std::memory_order_relaxed));
+    fn(next.get());
+    std::unique_ptr<T> previous(
+        current_.exchange(next.release(), std::memory_order_seq_cst));
+    WaitForReaders();
+  }
+
+ private:
+  static constexpr size_t kNumStripes = 64;
+
+  // The reader counts of the threads that hash to the same stripe, padded to
+  // a cache line to avoid false sharing between stripes.
+  struct alignas(64) Stripe {
+    std::atomic<int64_t> count[2] = {0, 0};
+  };
+
+  // Increments the reader count for the current epoch parity on construction,
+  // and decrements it on destruction.
+  class ReaderRegistration {
+   public:
+    explicit ReaderRegistration(const ReadOptimizedSnapshot* snapshot)
+        : count_(&snapshot->stripes_[StripeIndex()]
+                      .count[snapshot->epoch_.load(std::memory_order_seq_cst) &
+                             1]) {
+      count_->fetch_add(1, std::memory_order_seq_cst);
+    }
+    ~ReaderRegistration() { count_->fetch_sub(1, std::memory_order_release); }
+
+   private:
+    std::atomic<int64_t>* const count_;
+  };
+
+  static size_t StripeIndex() {
+    static thread_local const size_t index =
+        std::hash<std::thread::id>()(std::this_thread::get_id()) % kNumStripes;
+    return index;
+  }
+
+  // Waits until every reader that started before the last publication has
+  // finished.
+  void WaitForReaders() TF_EXCLUSIVE_LOCKS_REQUIRED(writer_mu_) {
+    for (int phase = 0; phase < 2; ++phase) {
+      const int retired_parity =
+          epoch_.fetch_add(1, std::memory_order_seq_cst) & 1;
+      for (const Stripe& stripe : stripes_) {
+        while (stripe.count[retired_parity].load(std::memory_order_acquire) !=
+               0) {
+          std::this_thread::yield();
+        }
+      }
+    }
+  }
+
+  std::atomic<T*> current_;
+  std::atomic<int64_t> epoch_{0};
+  mutable Stripe stripes_[kNumStripes];
+  mutex writer_mu_;
+
+  ReadOptimizedSnapshot(const ReadOptimizedSnapshot&) = delete;
+  void operator=(const ReadOptimizedSnapshot&) = delete;
+};
+
+}  // namespace lookup
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_SNAPSHOT_H_
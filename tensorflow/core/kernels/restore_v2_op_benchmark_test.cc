@@ -0,0 +1,116 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/util/tensor_bundle/naming.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace {
+
+// Sizes of the float tensors of a generated bundle, cycled through until the
+// bundle reaches the requested size.  Mixes the many small tensors (biases,
+// norms) and few large ones (embeddings, dense kernels) of typical models.
+constexpr int64_t kTensorBytes[] = {4 << 10, 64 << 10, 1 << 20, 16 << 20};
+
+// Writes a bundle of `total_mb` megabytes of float tensors, unless it already
+// exists, and returns its prefix and tensor names.
+std::string GenerateBundle(int64_t total_mb, std::vector<std::string>* names) {
+  const std::string prefix =
+      io::JoinPath(testing::TmpDir(), absl::StrCat("restore_v2_", total_mb));
+  const bool exists = Env::Default()->FileExists(MetaFilename(prefix)).ok();
+  std::unique_ptr<BundleWriter> writer;
+  if (!exists) writer = std::make_unique<BundleWriter>(Env::Default(), prefix);
+  names->clear();
+  int64_t bytes = 0;
+  for (int i = 0; bytes < (total_mb << 20); ++i) {
+    const int64_t tensor_bytes = kTensorBytes[i % std::size(kTensorBytes)];
+    names->push_back(absl::StrCat("tensor_", i));
+    if (writer != nullptr) {
+      Tensor t(DT_FLOAT, TensorShape({tensor_bytes / int64_t{sizeof(float)}}));
+      t.flat<float>().setRandom();
+      TF_CHECK_OK(writer->Add(names->back(), t));
+    }
+    bytes += tensor_bytes;
+  }
+  if (writer != nullptr) TF_CHECK_OK(writer->Finish());
+  return prefix;
+}
+
+Graph* RestoreV2(const std::string& prefix,
+                 const std::vector<std::string>& names) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor prefix_t(DT_STRING, TensorShape({}));
+  prefix_t.scalar<tstring>()() = prefix;
+  Tensor names_t(DT_STRING, TensorShape({static_cast<int64_t>(names.size())}));
+  Tensor shape_and_slices_t(DT_STRING, names_t.shape());
+  for (size_t i = 0; i < names.size(); ++i) {
+    names_t.flat<tstring>()(i) = names[i];
+    shape_and_slices_t.flat<tstring>()(i) = "";
+  }
+  Node* restore;
+  TF_CHECK_OK(NodeBuilder(g->NewName("restore"), "RestoreV2")
+                  .Input(test::graph::Constant(g, prefix_t))
+                  .Input(test::graph::Constant(g, names_t))
+                  .Input(test::graph::Constant(g, shape_and_slices_t))
+                  .Attr("dtypes", DataTypeVector(names.size(), DT_FLOAT))
+                  .Finalize(g, &restore));
+  return g;
+}
+
+// Restores a generated bundle of `state.range(0)` megabytes, with
+// `state.range(1)` parallel read threads (0 selects the default restore path).
+//
+// The bundle is read through the page cache after the first iteration, so
+// this measures the per-tensor overheads of restore rather than the storage.
+void BM_RestoreV2(::testing::benchmark::State& state) {
+  const int64_t total_mb = state.range(0);
+  const int num_threads = state.range(1);
+  std::vector<std::string> names;
+  const std::string prefix = GenerateBundle(total_mb, &names);
+  setenv("TF_RESTORE_V2_PARALLEL_READ_THREADS",
+         absl::StrCat(num_threads).c_str(), /*overwrite=*/1);
+  test::Benchmark("cpu", RestoreV2(prefix, names), /*old_benchmark_api=*/false)
+      .Run(state);
+  unsetenv("TF_RESTORE_V2_PARALLEL_READ_THREADS");
+  state.SetBytesProcessed(state.iterations() * (total_mb << 20));
+  state.SetItemsProcessed(state.iterations() * names.size());
+}
+
+BENCHMARK(BM_RestoreV2)
+    ->UseRealTime()
+    ->ArgPair(4 << 10, 0)
+    ->ArgPair(4 << 10, 8)
+    ->ArgPair(4 << 10, 32)
+    ->ArgPair(4 << 10, 64);
+
+}  // namespace
+}  // namespace tensorflow
@@ -14,11 +14,13 @@ limitations under the License.
 ==============================================================================*/
 
 #include <complex>
+#include <cstdlib>
 #include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/cleanup/cleanup.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -352,6 +354,19 @@ class RestoreV2OpTest : public OpsTestBase {
 
 // The intended use case (write in V2, read in V2).
 TEST_F(RestoreV2OpTest, RestoreAfterSaveV2) { RunTest("SaveV2"); }
+TEST_F(RestoreV2OpTest, RestoreAfterSaveV2WithParallelReads) {
+  setenv("TF_RESTORE_V2_PARALLEL_READ_THREADS", "4", /*overwrite=*/1);
+  absl::Cleanup unset_env = [] {
+    unsetenv("TF_RESTORE_V2_PARALLEL_READ_THREADS");
+  };
+  RunTest("SaveV2");
+}
+TEST_F(RestoreV2OpTest, RestoreAfterSaveV2WithMmap) {
+  setenv("TF_RESTORE_V2_USE_MMAP", "true", /*overwrite=*/1);
+  absl::Cleanup unset_env = [] { unsetenv("TF_RESTORE_V2_USE_MMAP"); };
+  RunTest("SaveV2");
+}
+
 // For backward compatibility.
 TEST_F(RestoreV2OpTest, RestoreAfterSaveSlicesV1) { RunTest("SaveSlices"); }
 TEST_F(RestoreV2OpTest, RestoreAfterSaveV1) { RunTest("Save"); }
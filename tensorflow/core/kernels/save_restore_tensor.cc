@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -260,13 +261,14 @@ const int64_t kLargeShapeThreshold = 16 << 20;  // 16M
 struct RestoreOp {
   RestoreOp(OpKernelContext* context, int idx, const std::string& tensor_name,
             const std::string& shape_and_slice,
-            const std::string& reader_prefix, DataType dtype)
+            const std::string& reader_prefix, DataType dtype, bool use_mmap)
       : context(context),
         idx(idx),
         tensor_name(tensor_name),
         shape_and_slice(shape_and_slice),
         reader_prefix(reader_prefix),
-        dtype(dtype) {}
+        dtype(dtype),
+        use_mmap(use_mmap) {}
 
   // Move-only. It does not make sense to "run()" a copied RestoreOp.
   RestoreOp(const RestoreOp&) = delete;
@@ -287,7 +289,10 @@ struct RestoreOp {
 
   // Run this restore operation using a new BundleReader.
   void run_with_new_reader(BundleCache* cache) {
-    BundleReader reader(tsl::Env::Default(), reader_prefix, {cache, false});
+    BundleReader::Options options;
+    options.cache = cache;
+    options.use_mmap = use_mmap;
+    BundleReader reader(tsl::Env::Default(), reader_prefix, options);
     if (!reader.status().ok()) {
       status = reader.status();
       return;
@@ -304,7 +309,14 @@ struct RestoreOp {
     VLOG(1) << "Restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
     Tensor* restored_tensor;
-    if (shape_and_slice.empty()) {
+    if (shape_and_slice.empty() && use_mmap) {
+      // Lookup the full tensor, which may reference the mapped data file, so
+      // no output buffer is allocated up front.
+      Tensor restored;
+      TF_RETURN_IF_ERROR(reader->Lookup(tensor_name, &restored));
+      context->set_output(idx, restored);
+      restored_tensor = context->mutable_output(idx);
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, restored_full_shape, &restored_tensor));
@@ -358,6 +370,8 @@ struct RestoreOp {
   std::string shape_and_slice;
   std::string reader_prefix;
   DataType dtype;
+  // Whether full tensors are looked up with BundleReader::Options::use_mmap.
+  bool use_mmap;
 
   absl::Status status;
 };
@@ -373,16 +387,24 @@ absl::Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   const auto& tensor_names_flat = tensor_names.flat<tstring>();
   const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
+  bool use_mmap;
+  TF_RETURN_IF_ERROR(
+      ReadBoolFromEnvVar("TF_RESTORE_V2_USE_MMAP", false, &use_mmap));
+
   std::vector<RestoreOp> restore_ops;
   restore_ops.reserve(tensor_names_flat.size());
   for (int i = 0; i < tensor_names_flat.size(); ++i) {
     restore_ops.push_back({context, i, tensor_names_flat(i),
-                           shape_and_slices_flat(i), prefix_string, dtypes[i]});
+                           shape_and_slices_flat(i), prefix_string, dtypes[i],
+                           use_mmap});
   }
 
   tsl::Env* const env = tsl::Env::Default();
   BundleCache cache(env);
-  BundleReader default_reader(env, prefix_string, {&cache, false});
+  BundleReader::Options reader_options;
+  reader_options.cache = &cache;
+  reader_options.use_mmap = use_mmap;
+  BundleReader default_reader(env, prefix_string, reader_options);
   TF_RETURN_IF_ERROR(default_reader.status());
 
   TF_RETURN_IF_ERROR(default_reader.SortForSequentialAccess<RestoreOp>(
@@ -419,8 +441,47 @@ absl::Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     }
   }
 
-  if (context->session_config() != nullptr &&
-      context->session_config()->intra_op_parallelism_threads() > 0) {
+  int64_t num_parallel_read_threads;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar(
+      "TF_RESTORE_V2_PARALLEL_READ_THREADS", 0, &num_parallel_read_threads));
+  // Mapping the data files does not read them, so there is nothing for a
+  // pool of readers to do.
+  if (num_parallel_read_threads > 0 && !use_mmap) {
+    // Restores all full tensors with a single BundleReader::ParallelLookup(),
+    // which coalesces reads of tensors that are adjacent in the data files
+    // and bounds the bytes being read at any time.
+    int64_t max_inflight_mb;
+    TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_RESTORE_V2_MAX_INFLIGHT_MB",
+                                           1024, &max_inflight_mb));
+    std::vector<std::string> keys;
+    std::vector<Tensor*> vals;
+    std::vector<RestoreOp*> slice_restore_ops;
+    for (RestoreOp& restore_op : restore_ops) {
+      if (!restore_op.shape_and_slice.empty()) {
+        slice_restore_ops.push_back(&restore_op);
+        continue;
+      }
+      TensorShape restored_full_shape;
+      TF_RETURN_IF_ERROR(default_reader.LookupTensorShape(
+          restore_op.tensor_name, &restored_full_shape));
+      Tensor* restored_tensor;
+      TF_RETURN_IF_ERROR(context->allocate_output(
+          restore_op.idx, restored_full_shape, &restored_tensor));
+      keys.push_back(restore_op.tensor_name);
+      vals.push_back(restored_tensor);
+    }
+
+    thread::ThreadPool reader_pool(Env::Default(), "restore_tensors",
+                                   num_parallel_read_threads);
+    BundleReader::ParallelLookupOptions options;
+    options.pool = &reader_pool;
+    options.max_inflight_bytes = max_inflight_mb << 20;
+    TF_RETURN_IF_ERROR(default_reader.ParallelLookup(keys, vals, options));
+    for (auto* op : slice_restore_ops) {
+      TF_RETURN_IF_ERROR(op->run(&default_reader));
+    }
+  } else if (context->session_config() != nullptr &&
+             context->session_config()->intra_op_parallelism_threads() > 0) {
     // If an explicit restore parallelism is specified, we use it to run
     // run both small and large restore ops in parallel.
     auto reader_pool = std::make_unique<thread::ThreadPool>(
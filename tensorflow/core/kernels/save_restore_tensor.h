@@ -59,6 +59,19 @@ void RestoreTensor(OpKernelContext* context,
 //
 // "context" is only used for allocating outputs.  In particular, the inputs are
 // explicitly provided and not accessed via the "input(i)" methods.
+//
+// If the environment variable TF_RESTORE_V2_PARALLEL_READ_THREADS is set to a
+// positive number, full tensors are read by a pool of that many threads, with
+// reads of tensors that are adjacent in the data files coalesced, and with at
+// most TF_RESTORE_V2_MAX_INFLIGHT_MB (default 1024) megabytes being read at
+// any time.
+//
+// If the environment variable TF_RESTORE_V2_USE_MMAP is set to true, full
+// tensors are looked up with BundleReader::Options::use_mmap, so that those
+// whose data is suitably aligned reference the memory-mapped data files
+// instead of being copied. This takes precedence over
+// TF_RESTORE_V2_PARALLEL_READ_THREADS. Sliced restores always read.
+//
 // REQUIRES:
 //   * "prefix" has 1 element, DT_STRING.
 //   * "tensor_names" and "shape_and_slices" shaped {N}, both DT_STRING.
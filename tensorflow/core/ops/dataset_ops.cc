@@ -610,6 +610,8 @@ REGISTER_OP("ShuffleDataset")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
     .Attr("metadata: string = ''")
+    .Attr("experimental_spill_threshold_bytes: int = 0")
+    .Attr("experimental_spill_directory: string = ''")
     .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
                                                            "output_types"))
     .SetShapeFn([](shape_inference::InferenceContext* c) {
@@ -650,6 +652,8 @@ REGISTER_OP("ShuffleDatasetV3")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
     .Attr("metadata: string = ''")
+    .Attr("experimental_spill_threshold_bytes: int = 0")
+    .Attr("experimental_spill_directory: string = ''")
     .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
                                                            "output_types"))
     .SetShapeFn([](shape_inference::InferenceContext* c) {
@@ -673,6 +677,8 @@ REGISTER_OP("ShuffleAndRepeatDataset")
     .Attr("output_shapes: list(shape) >= 1")
     .Attr("reshuffle_each_iteration: bool = true")
     .Attr("metadata: string = ''")
+    .Attr("experimental_spill_threshold_bytes: int = 0")
+    .Attr("experimental_spill_directory: string = ''")
     .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
                                                            "output_types"))
     .SetShapeFn([](shape_inference::InferenceContext* c) {
@@ -697,6 +703,8 @@ REGISTER_OP("ShuffleAndRepeatDatasetV2")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
     .Attr("metadata: string = ''")
+    .Attr("experimental_spill_threshold_bytes: int = 0")
+    .Attr("experimental_spill_directory: string = ''")
     .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
                                                            "output_types"))
     .SetShapeFn([](shape_inference::InferenceContext* c) {
@@ -862,6 +870,7 @@ REGISTER_OP("TFRecordDatasetV2")
     .Input("buffer_size: int64")
     .Input("byte_offsets: int64")
     .Attr("metadata: string = ''")
+    .Attr("experimental_use_index: bool = false")
     .Output("handle: variant")
     .SetDoNotOptimize()  // TODO(b/123753214): See comment in dataset_ops.cc.
     .SetTypeConstructor(full_type::UnaryTensorContainer(TFT_DATASET,
@@ -175,6 +175,9 @@ REGISTER_OP("CompressElement")
     .Input("components: input_types")
     .Output("compressed: variant")
     .Attr("input_types: list(type) >= 1")
+    .Attr("experimental_codec: string = 'SNAPPY'")
+    .Attr("experimental_level: int = 0")
+    .Attr("experimental_byte_shuffle: bool = false")
     .SetShapeFn(shape_inference::ScalarShape);
 
 REGISTER_OP("UncompressElement")
@@ -481,6 +484,35 @@ REGISTER_OP("GroupByWindowDataset")
                                                            "output_types"))
     .SetShapeFn(shape_inference::ScalarShape);
 
+REGISTER_OP("BucketByTokenBudgetDataset")
+    .Input("input_dataset: variant")
+    .Input("bucket_boundaries: int64")
+    .Input("max_tokens: int64")
+    .Input("max_batch_size: int64")
+    .Input("padding_values: Tpadding_values")
+    .Input("drop_remainder: bool")
+    .Output("handle: variant")
+    .Attr("length_component: int >= 0 = 0")
+    .Attr("ragged_output: bool = false")
+    .Attr("Tpadding_values: list(type) >= 1")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .Attr("metadata: string = ''")
+    .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
+                                                           "output_types"))
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      // bucket_boundaries should be a vector.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      // max_tokens and max_batch_size should be scalars.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 0, &unused));
+      // drop_remainder should be a scalar.
+      TF_RETURN_IF_ERROR(
+          c->WithRank(c->input(c->num_inputs() - 1), 0, &unused));
+      return shape_inference::ScalarShape(c);
+    });
+
 REGISTER_OP("GetElementAtIndex")
     .Input("dataset: variant")
     .Input("index: int64")
@@ -775,6 +807,53 @@ REGISTER_OP("ExperimentalNonSerializableDataset")
                                                            "output_types"))
     .SetShapeFn(shape_inference::ScalarShape);
 
+REGISTER_OP("ParallelCSVDataset")
+    .Input("filenames: string")
+    .Input("compression_type: string")
+    .Input("buffer_size: int64")
+    .Input("header: bool")
+    .Input("field_delim: string")
+    .Input("use_quote_delim: bool")
+    .Input("na_value: string")
+    .Input("select_cols: int64")
+    .Input("record_defaults: output_types")
+    .Input("exclude_cols: int64")
+    .Input("num_parallel_calls: int64")
+    .Output("handle: variant")
+    .Attr("output_types: list({float,double,int32,int64,string}) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetDoNotOptimize()  // TODO(b/123753214): See comment in dataset_ops.cc.
+    .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
+                                                           "output_types"))
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      // `filenames` must be a scalar or a vector.
+      TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(0), 1, &unused));
+      // `compression_type`, `buffer_size`, `header`, `field_delim`,
+      // `use_quote_delim`, `na_value` must be scalars
+      for (int i = 1; i <= 6; ++i) {
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+      }
+      // `select_cols` must be a vector
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(7), 1, &unused));
+      // `exclude_cols` must be a vector, and `num_parallel_calls` a scalar
+      TF_RETURN_IF_ERROR(
+          c->WithRank(c->input(c->num_inputs() - 2), 1, &unused));
+      TF_RETURN_IF_ERROR(
+          c->WithRank(c->input(c->num_inputs() - 1), 0, &unused));
+      // `record_defaults` must be lists of scalars
+      for (size_t i = 8; i < c->num_inputs() - 2; ++i) {
+        shape_inference::ShapeHandle v;
+        TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(i), 1, &v));
+        if (c->Rank(c->input(i)) == 1 && c->Value(c->Dim(v, 0)) > 1) {
+          return absl::InvalidArgumentError(
+              "Shape of a default must be a length-0 or length-1 vector, or a "
+              "scalar.");
+        }
+      }
+      return shape_inference::ScalarShape(c);
+    });
+
 REGISTER_OP("ParallelInterleaveDataset")
     .Input("input_dataset: variant")
     .Input("other_arguments: Targuments")
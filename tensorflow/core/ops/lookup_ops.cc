@@ -378,6 +378,16 @@ REGISTER_OP("HashTableV2")
     .SetIsStateful()
     .SetShapeFn(ScalarOutput);
 
+REGISTER_OP("MemoryMappedHashTable")
+    .Output("table_handle: resource")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("use_node_name_sharing: bool = false")
+    .Attr("key_dtype: type")
+    .Attr("value_dtype: type")
+    .SetIsStateful()
+    .SetShapeFn(ScalarOutput);
+
 REGISTER_OP("AnonymousHashTable")
     .Output("table_handle: resource")
     .Attr("key_dtype: type")
@@ -402,6 +412,7 @@ REGISTER_OP("MutableHashTableV2")
     .Attr("use_node_name_sharing: bool = false")
     .Attr("key_dtype: type")
     .Attr("value_dtype: type")
+    .Attr("experimental_read_optimized: bool = false")
     .SetIsStateful()
     .SetShapeFn(MutableHashTableShapeFn);
 
@@ -431,6 +442,7 @@ REGISTER_OP("MutableHashTableOfTensorsV2")
     .Attr("key_dtype: type")
     .Attr("value_dtype: type")
     .Attr("value_shape: shape = {}")
+    .Attr("experimental_read_optimized: bool = false")
     .SetIsStateful()
     .SetShapeFn(MutableHashTableOfTensorsShapeFn);
 
@@ -551,4 +563,30 @@ REGISTER_OP("InitializeTableFromTextFileV2")
       return absl::OkStatus();
     });
 
+REGISTER_OP("InitializeTableFromHashTableImage")
+    .Input("table_handle: resource")
+    .Input("filename: string")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &handle));
+      return absl::OkStatus();
+    });
+
+REGISTER_OP("WriteHashTableImage")
+    .Input("filename: string")
+    .Input("keys: Tkey")
+    .Input("values: Tval")
+    .Attr("Tkey: {int64, string}")
+    .Attr("Tval: {int32, int64, float, double}")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &handle));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &handle));
+      return absl::OkStatus();
+    });
+
 }  // namespace tensorflow
@@ -15,6 +15,9 @@ limitations under the License.
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <optional>
 #include <utility>
@@ -22,6 +25,7 @@ limitations under the License.
 
 #include "absl/base/casts.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/numeric/bits.h"
 #include "absl/status/status.h"
 #include "absl/strings/substitute.h"
 #include "tensorflow/core/example/example.pb.h"
@@ -119,6 +123,65 @@ constexpr uint8_t kVarintTag(uint32_t tag) { return (tag << 3) | 0; }
 constexpr uint8_t kDelimitedTag(uint32_t tag) { return (tag << 3) | 2; }
 constexpr uint8_t kFixed32Tag(uint32_t tag) { return (tag << 3) | 5; }
 
+// The continuation bits of eight consecutive bytes of a varint encoding.
+constexpr uint64_t kVarintContinuationBits = 0x8080808080808080ULL;
+
+// Returns the number of varints in the packed encoding [begin, end), i.e. the
+// number of bytes without a continuation bit. A truncated trailing varint is
+// not counted.
+inline size_t CountPackedVarints(const uint8_t* begin, const uint8_t* end) {
+  size_t count = 0;
+  const uint8_t* p = begin;
+  for (; end - p >= 8; p += 8) {
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    count += 8 - absl::popcount(word & kVarintContinuationBits);
+  }
+  for (; p < end; ++p) {
+    if ((*p & 0x80) == 0) ++count;
+  }
+  return count;
+}
+
+// Decodes the packed varints in [begin, end) into `out`, which must have room
+// for CountPackedVarints(begin, end) values. Returns false if the encoding is
+// malformed, in which case a prefix of `out` may have been written.
+//
+// Small values dominate most int64 features, so eight bytes are tested for
+// continuation bits at once, and a run of eight single-byte varints is
+// decoded with a loop the compiler turns into vector zero-extensions.
+inline bool DecodePackedVarints(const uint8_t* begin, const uint8_t* end,
+                                int64_t* out) {
+  const uint8_t* p = begin;
+  while (p < end) {
+    if (end - p >= 8) {
+      uint64_t word;
+      std::memcpy(&word, p, sizeof(word));
+      if ((word & kVarintContinuationBits) == 0) {
+        for (int i = 0; i < 8; ++i) out[i] = p[i];
+        out += 8;
+        p += 8;
+        continue;
+      }
+    }
+    // A varint takes at most 10 bytes, like in CodedInputStream::ReadVarint64.
+    uint64_t value = 0;
+    for (int shift = 0;; shift += 7) {
+      if (p == end || shift >= 70) return false;
+      const uint8_t byte = *p++;
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) break;
+    }
+    *out++ = static_cast<int64_t>(value);
+  }
+  return true;
+}
+
+// Whether packed int64 lists are decoded one ReadVarint64 call at a time
+// instead of with CountPackedVarints and DecodePackedVarints. See
+// SetScalarVarintDecodingForTesting.
+std::atomic<bool> scalar_varint_decoding{false};
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -311,15 +374,42 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32_t packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64_t>(n));
+        if (scalar_varint_decoding.load(std::memory_order_relaxed)) {
+          auto packed_limit = stream.PushLimit(packed_length);
+          while (!stream.ExpectAtEnd()) {
+            protobuf_uint64 n;  // There is no API for int64
+            if (!stream.ReadVarint64(&n)) return false;
+            int64_list->push_back(static_cast<int64_t>(n));
+          }
+          stream.PopLimit(packed_limit);
+        } else if (packed_length > 0) {
+          const void* packed_data;
+          int buffer_size;
+          if (!stream.GetDirectBufferPointer(&packed_data, &buffer_size) ||
+              static_cast<uint32_t>(buffer_size) < packed_length) {
+            return false;
+          }
+          const uint8_t* begin = static_cast<const uint8_t*>(packed_data);
+          const uint8_t* end = begin + packed_length;
+
+          // Size the output once and decode straight into it, which for
+          // fixed-length dense features is the batch output tensor.
+          const size_t initial_size = int64_list->size();
+          const size_t num_values = CountPackedVarints(begin, end);
+          int64_list->resize(initial_size + num_values);
+          if (int64_list->size() == initial_size + num_values) {
+            if (!DecodePackedVarints(begin, end,
+                                     int64_list->data() + initial_size)) {
+              return false;
+            }
+          } else {
+            // Too many values for a LimitedArraySlice. The caller reports the
+            // size mismatch, unless the values are malformed.
+            std::vector<int64_t> values(num_values);
+            if (!DecodePackedVarints(begin, end, values.data())) return false;
+          }
+          if (!stream.Skip(packed_length)) return false;
         }
-
-        stream.PopLimit(packed_limit);
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
@@ -468,6 +558,10 @@ bool ParseExample(absl::string_view serialized, parsed::Example* example) {
 
 }  // namespace
 
+void SetScalarVarintDecodingForTesting(bool enabled) {
+  scalar_varint_decoding.store(enabled, std::memory_order_relaxed);
+}
+
 bool TestFastParse(const std::string& serialized, Example* example) {
   DCHECK(example != nullptr);
   parsed::Example parsed_example;
@@ -596,26 +690,50 @@ void LogSparseFeatureDataLoss(absl::string_view feature_name) {
   duplicated_sparse_feature->GetCell()->IncrementBy(1);
 }
 
+// State that FastParseSerializedExample reuses across the examples of a
+// minibatch, so that wide examples don't allocate per example.
+struct ExampleParserScratch {
+  explicit ExampleParserScratch(const Config& config)
+      : sparse_feature_last_example(config.sparse.size(), -1),
+        dense_feature_last_example(config.dense.size(), -1),
+        ragged_feature_last_example(config.ragged.size(), -1) {}
+
+  parsed::Example parsed_example;
+
+  // The index of the last example each feature was found in. Entries are only
+  // compared with the index of the current example, so they don't need to be
+  // reset between examples.
+  std::vector<int64_t> sparse_feature_last_example;
+  std::vector<int64_t> dense_feature_last_example;
+  std::vector<int64_t> ragged_feature_last_example;
+};
+
 absl::Status FastParseSerializedExample(
     const tstring& serialized_example, const tstring& example_name,
     const size_t example_index, const Config& config,
     const PresizedCuckooMap<std::pair<size_t, Type>>& config_index,
-    SeededHasher hasher, std::vector<Tensor>* output_dense,
+    SeededHasher hasher, ExampleParserScratch* scratch,
+    std::vector<Tensor>* output_dense,
     std::vector<SparseBuffer>* output_varlen_dense,
     std::vector<SparseBuffer>* output_sparse,
     std::vector<SparseBuffer>* output_ragged,
     PerExampleFeatureStats* output_stats) {
+  DCHECK(scratch != nullptr);
   DCHECK(output_dense != nullptr);
   DCHECK(output_sparse != nullptr);
   DCHECK(output_ragged != nullptr);
-  parsed::Example parsed_example;
+  parsed::Example& parsed_example = scratch->parsed_example;
+  parsed_example.clear();
   if (!ParseExample(serialized_example, &parsed_example)) {
     return absl::InvalidArgumentError(absl::StrCat(
         "Could not parse example input, value: '", serialized_example, "'"));
   }
-  std::vector<int64_t> sparse_feature_last_example(config.sparse.size(), -1);
-  std::vector<int64_t> dense_feature_last_example(config.dense.size(), -1);
-  std::vector<int64_t> ragged_feature_last_example(config.ragged.size(), -1);
+  std::vector<int64_t>& sparse_feature_last_example =
+      scratch->sparse_feature_last_example;
+  std::vector<int64_t>& dense_feature_last_example =
+      scratch->dense_feature_last_example;
+  std::vector<int64_t>& ragged_feature_last_example =
+      scratch->ragged_feature_last_example;
 
   // Handle features present in the example.
   const size_t parsed_example_size = parsed_example.size();
@@ -1244,6 +1362,7 @@ absl::Status FastParseExample(const Config& config,
     ragged_buffers[minibatch].resize(config.ragged.size());
     size_t start = first_example_of_minibatch(minibatch);
     size_t end = first_example_of_minibatch(minibatch + 1);
+    ExampleParserScratch scratch(config);
     for (size_t e = start; e < end; ++e) {
       PerExampleFeatureStats* stats = nullptr;
       if (config.collect_feature_stats) {
@@ -1252,7 +1371,7 @@ absl::Status FastParseExample(const Config& config,
       status_of_minibatch[minibatch] = FastParseSerializedExample(
           serialized[e],
           (!example_names.empty() ? example_names[e] : "<unknown>"), e, config,
-          config_index, hasher, &fixed_dense_values,
+          config_index, hasher, &scratch, &fixed_dense_values,
           &varlen_dense_buffers[minibatch], &sparse_buffers[minibatch],
           &ragged_buffers[minibatch], stats);
       if (!status_of_minibatch[minibatch].ok()) break;
@@ -166,6 +166,11 @@ absl::Status FastParseSequenceExample(
 // It is exported here as a convenient API to test parser part separately.
 bool TestFastParse(const std::string& serialized, Example* example);
 
+// If `enabled`, packed int64 lists are decoded one varint at a time with
+// CodedInputStream, as before the word-at-a-time decoder was added. Used to
+// benchmark the two decoders against each other.
+void SetScalarVarintDecodingForTesting(bool enabled);
+
 }  // namespace example
 }  // namespace tensorflow
 
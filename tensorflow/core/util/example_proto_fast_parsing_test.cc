@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
 #include <cstdint>
+#include <limits>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -175,6 +176,43 @@ TEST(FastParse, Packed) {
       "\x0a\x0d\x0a\x0b\x0a\x03\x61\x67\x65\x12\x04\x1a\x02\x08\x0d");
 }
 
+TEST(FastParse, PackedInt64Varints) {
+  Example example;
+  auto* values = (*example.mutable_features()->mutable_feature())["ids"]
+                     .mutable_int64_list();
+  // Runs of single-byte varints of different lengths, interleaved with
+  // multi-byte and ten-byte (negative) varints.
+  for (int i = 0; i < 21; ++i) values->add_value(i);
+  values->add_value(300);
+  for (int i = 0; i < 8; ++i) values->add_value(127 - i);
+  values->add_value(-1);
+  values->add_value(std::numeric_limits<int64_t>::min());
+  values->add_value(std::numeric_limits<int64_t>::max());
+  for (int i = 0; i < 7; ++i) values->add_value(i);
+  values->add_value(1729);
+  TestCorrectness(Serialize(example));
+}
+
+TEST(FastParse, TruncatedPackedInt64Varint) {
+  // An int64_list whose packed values end with a continuation byte.
+  const std::string serialized(
+      "\x0a\x0d\x0a\x0b\x0a\x01"
+      "a"
+      "\x12\x06\x1a\x04\x0a\x02\x01\x80",
+      15);
+  Example example;
+  EXPECT_FALSE(TestFastParse(serialized, &example));
+
+  FastParseExampleConfig config;
+  config.sparse.emplace_back();
+  config.sparse.back().feature_name = "a";
+  config.sparse.back().dtype = DT_INT64;
+  Result result;
+  std::vector<tstring> serialized_vec = {tstring(serialized)};
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      FastParseExample(config, serialized_vec, {}, nullptr, &result)));
+}
+
 TEST(FastParse, ValueBeforeKeyInMap) {
   TestCorrectness("\x0a\x12\x0a\x10\x12\x09\x0a\x07\x0a\x05value\x0a\x03key");
 }
@@ -598,6 +636,76 @@ TEST(FastParse, DenseFloat_TooFewElements_ReportsError) {
             std::string::npos);
 }
 
+TEST(FastParse, DenseInt64PackedVarints) {
+  constexpr int kNumValues = 37;
+  Example example;
+  auto* values = (*example.mutable_features()->mutable_feature())["ids"]
+                     .mutable_int64_list();
+  for (int i = 0; i < kNumValues; ++i) {
+    values->add_value(i % 3 == 0 ? -i : i * i * i);
+  }
+  const std::vector<tstring> serialized = {tstring(Serialize(example)),
+                                           tstring(Serialize(example))};
+
+  {
+    FastParseExampleConfig config;
+    AddDenseFeature("ids", DT_INT64, {kNumValues}, false, kNumValues, &config);
+    Result result;
+    TF_CHECK_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+    ASSERT_EQ(1, result.dense_values.size());
+    const auto parsed = result.dense_values[0].matrix<int64_t>();
+    for (int b = 0; b < 2; ++b) {
+      for (int i = 0; i < kNumValues; ++i) {
+        EXPECT_EQ(values->value(i), parsed(b, i));
+      }
+    }
+  }
+
+  {
+    FastParseExampleConfig config;
+    AddDenseFeature("ids", DT_INT64, {kNumValues - 1}, false, kNumValues - 1,
+                    &config);
+    Result result;
+    absl::Status status =
+        FastParseExample(config, serialized, {}, nullptr, &result);
+    EXPECT_TRUE(absl::IsInvalidArgument(status));
+    EXPECT_NE(status.ToString().find(absl::StrCat(
+                  "Number of int64 values != expected.  Values size: ",
+                  kNumValues)),
+              std::string::npos)
+        << status;
+  }
+}
+
+TEST(FastParse, ScalarVarintDecodingMatches) {
+  constexpr int kNumValues = 37;
+  Example example;
+  auto* values = (*example.mutable_features()->mutable_feature())["ids"]
+                     .mutable_int64_list();
+  for (int i = 0; i < kNumValues; ++i) {
+    values->add_value(i % 3 == 0 ? -i : i * i * i);
+  }
+  const std::vector<tstring> serialized = {tstring(Serialize(example))};
+  FastParseExampleConfig config;
+  AddDenseFeature("ids", DT_INT64, {kNumValues}, false, kNumValues, &config);
+
+  Result result;
+  TF_CHECK_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  SetScalarVarintDecodingForTesting(true);
+  Result scalar_result;
+  TF_CHECK_OK(
+      FastParseExample(config, serialized, {}, nullptr, &scalar_result));
+  SetScalarVarintDecodingForTesting(false);
+
+  ASSERT_EQ(1, scalar_result.dense_values.size());
+  const auto parsed = result.dense_values[0].matrix<int64_t>();
+  const auto scalar_parsed = scalar_result.dense_values[0].matrix<int64_t>();
+  for (int i = 0; i < kNumValues; ++i) {
+    EXPECT_EQ(values->value(i), scalar_parsed(0, i));
+    EXPECT_EQ(parsed(0, i), scalar_parsed(0, i));
+  }
+}
+
 TEST(FastParse, OobWriteVulnerabilityMalformedSparseSequenceExample) {
   FastParseExampleConfig context_config;
   FastParseExampleConfig sequence_config;
@@ -619,6 +727,51 @@ TEST(FastParse, OobWriteVulnerabilityMalformedSparseSequenceExample) {
   EXPECT_TRUE(absl::IsInvalidArgument(status));
 }
 
+// Serializes `batch_size` examples with `num_features` features each, half
+// int64 lists of small ids and half float lists, of `num_values` values.
+std::vector<tstring> WideExamples(int batch_size, int num_features,
+                                  int num_values,
+                                  FastParseExampleConfig* config) {
+  Example example;
+  auto& features = *example.mutable_features()->mutable_feature();
+  for (int f = 0; f < num_features; ++f) {
+    const std::string name = absl::StrCat("feature_", f);
+    const DataType dtype = f % 2 == 0 ? DT_INT64 : DT_FLOAT;
+    for (int i = 0; i < num_values; ++i) {
+      if (dtype == DT_INT64) {
+        features[name].mutable_int64_list()->add_value((f * 31 + i) % 100);
+      } else {
+        features[name].mutable_float_list()->add_value(f + i / 8.0f);
+      }
+    }
+    AddDenseFeature(name.c_str(), dtype, {num_values}, false, num_values,
+                    config);
+  }
+  return std::vector<tstring>(batch_size, tstring(Serialize(example)));
+}
+
+// Parses a batch of examples with a wide schema (args: batch size, number of
+// features, values per feature, whether packed int64 lists are decoded with
+// the scalar baseline decoder).
+void BM_FastParseExampleWide(::testing::benchmark::State& state) {
+  const int batch_size = state.range(0);
+  const int num_features = state.range(1);
+  const int num_values = state.range(2);
+  const bool scalar = state.range(3);
+  FastParseExampleConfig config;
+  const std::vector<tstring> serialized =
+      WideExamples(batch_size, num_features, num_values, &config);
+  SetScalarVarintDecodingForTesting(scalar);
+  for (auto s : state) {
+    Result result;
+    TF_CHECK_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  }
+  SetScalarVarintDecodingForTesting(false);
+  state.SetItemsProcessed(state.iterations() * batch_size * num_features);
+}
+BENCHMARK(BM_FastParseExampleWide)
+    ->ArgsProduct({{128}, {512, 1024}, {1, 16}, {0, 1}});
+
 }  // namespace
 }  // namespace example
 }  // namespace tensorflow
@@ -15,15 +15,20 @@ limitations under the License.
 
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/base/call_once.h"
+#include "absl/synchronization/blocking_counter.h"
 #include "absl/synchronization/mutex.h"
 #include "xla/tsl/lib/io/buffered_file.h"
 #include "xla/tsl/util/byte_swap_array.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -237,6 +242,113 @@ tstring* GetStringBackingBuffer(const Tensor& val) {
   return const_cast<tstring*>(val.flat<tstring>().data());
 }
 
+// A TensorBuffer that references a range of a memory-mapped data file.
+//
+// Reports that it does not own its memory, so that Tensor::RefCountIsOne() is
+// never true and kernels copy the buffer rather than updating it in place.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region, char* data,
+                     size_t size)
+      : TensorBuffer(data), region_(std::move(region)), size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  bool OwnsMemory() const override { return false; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("mmap");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
+// Returns an error if "actual_crc32c" does not match the checksum stored in
+// "entry".
+absl::Status VerifyChecksum(absl::string_view prefix,
+                            const BundleEntryProto& entry,
+                            uint32_t actual_crc32c) {
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return absl::DataLossError(absl::StrCat(
+        "TensorBundle at ", prefix, " shard ", entry.shard_id(), " (",
+        entry.size(), " bytes): Checksum does not match: stored ",
+        absl::StrFormat("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the restored bytes ", actual_crc32c));
+  }
+  return absl::OkStatus();
+}
+
+// A range of a data file that holds the data of one or more fixed-size
+// tensors, fetched by a single read.
+struct CoalescedRead {
+  int32_t shard_id;
+  int64_t offset;
+  int64_t size;
+  // The tensors in the range, in file order, and where to restore them.
+  std::vector<std::pair<const BundleEntryProto*, Tensor*>> tensors;
+};
+
+// Reads "read" from "file" and restores the tensors it covers.
+absl::Status ReadCoalesced(RandomAccessFile* file, absl::string_view prefix,
+                           const CoalescedRead& read) {
+  absl::string_view sp;
+  if (read.tensors.size() == 1) {
+    // Reads straight into the tensor.
+    const BundleEntryProto& entry = *read.tensors[0].first;
+    char* backing_buffer = GetBackingBuffer(*read.tensors[0].second);
+    TF_RETURN_IF_ERROR(file->Read(
+        entry.offset(), sp, absl::MakeSpan(backing_buffer, entry.size())));
+    if (sp.data() != backing_buffer) {
+      memmove(backing_buffer, sp.data(), entry.size());
+    }
+    return VerifyChecksum(prefix, entry,
+                          crc32c::Value(backing_buffer, entry.size()));
+  }
+
+  std::unique_ptr<char[]> scratch(new char[read.size]);
+  TF_RETURN_IF_ERROR(
+      file->Read(read.offset, sp, absl::MakeSpan(scratch.get(), read.size)));
+  for (const auto& [entry, val] : read.tensors) {
+    const char* data = sp.data() + (entry->offset() - read.offset);
+    TF_RETURN_IF_ERROR(
+        VerifyChecksum(prefix, *entry, crc32c::Value(data, entry->size())));
+    memcpy(GetBackingBuffer(*val), data, entry->size());
+  }
+  return absl::OkStatus();
+}
+
+// Bounds the number of bytes of reads in flight.
+class InflightBytesBudget {
+ public:
+  explicit InflightBytesBudget(int64_t limit) : limit_(limit) {}
+
+  // Blocks until "bytes" more bytes fit in the budget.  A request larger than
+  // the whole budget is admitted once nothing else is in flight.
+  void Acquire(int64_t bytes) {
+    absl::MutexLock l(mu_);
+    while (in_flight_ > 0 && in_flight_ + bytes > limit_) {
+      released_.Wait(&mu_);
+    }
+    in_flight_ += bytes;
+  }
+
+  void Release(int64_t bytes) {
+    absl::MutexLock l(mu_);
+    in_flight_ -= bytes;
+    released_.SignalAll();
+  }
+
+ private:
+  const int64_t limit_;
+  absl::Mutex mu_;
+  absl::CondVar released_;
+  int64_t in_flight_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
 absl::Status ParseEntryProto(absl::string_view key, absl::string_view value,
                              protobuf::MessageLite* out) {
   if (!out->ParseFromString(value)) {
@@ -798,7 +910,8 @@ BundleReader::BundleReader(Env* env, absl::string_view prefix, Options options)
       iter_(nullptr),
       need_to_swap_bytes_(false),
       enable_multi_threading_for_testing_(
-          options.enable_multi_threading_for_testing) {
+          options.enable_multi_threading_for_testing),
+      use_mmap_(options.use_mmap) {
   if (cache_ == nullptr) {
     // Make a cache for use just by this BundleReader.
     owned_cache_ = std::make_unique<BundleCache>(env);
@@ -892,8 +1005,68 @@ absl::Status BundleReader::GetBundleEntryProto(absl::string_view key,
   return absl::OkStatus();
 }
 
+absl::Status BundleReader::GetMappedValue(const BundleEntryProto& entry,
+                                          Tensor* val, bool* mapped) {
+  *mapped = false;
+  const TensorShape shape =
+      val->NumElements() == 0 ? TensorShape(entry.shape()) : val->shape();
+  const size_t expected_size =
+      shape.num_elements() * DataTypeSize(entry.dtype());
+  if (entry.size() != expected_size) {
+    return absl::DataLossError(absl::StrCat(
+        "Invalid size in bundle entry: key ", key(), "; stored size ",
+        entry.size(), "; expected size ", expected_size));
+  }
+
+  auto it = mapped_data_.find(entry.shard_id());
+  if (it == mapped_data_.end()) {
+    const std::string filename =
+        DataFilename(prefix_, entry.shard_id(), num_shards_);
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    absl::Status s = env_->NewReadOnlyMemoryRegionFromFile(filename, &region);
+    if (!s.ok()) {
+      // Reading the file reports any error that is not specific to mapping.
+      VLOG(1) << "Unable to memory-map " << filename << ": " << s;
+      region = nullptr;
+    }
+    it = mapped_data_.emplace(entry.shard_id(), std::move(region)).first;
+  }
+  const std::shared_ptr<ReadOnlyMemoryRegion>& region = it->second;
+  if (region == nullptr) return absl::OkStatus();
+
+  if (entry.offset() + entry.size() > region->length()) {
+    return absl::OutOfRangeError(absl::StrCat(
+        "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+        region->length(), " bytes): tensor data at offset ", entry.offset(),
+        " (", entry.size(), " bytes) is past the end of the file"));
+  }
+  char* data = const_cast<char*>(static_cast<const char*>(region->data())) +
+               entry.offset();
+  if (reinterpret_cast<uintptr_t>(data) % Allocator::kAllocatorAlignment !=
+      0) {
+    return absl::OkStatus();
+  }
+
+  // Touches every page of the tensor once, which is the cost of restoring it.
+  const uint32_t actual_crc32c = crc32c::Value(data, entry.size());
+  TF_RETURN_IF_ERROR(VerifyChecksum(prefix_, entry, actual_crc32c));
+
+  auto* buffer = new MappedTensorBuffer(region, data, entry.size());
+  *val = Tensor(entry.dtype(), shape, buffer);
+  buffer->Unref();
+  *mapped = true;
+  return absl::OkStatus();
+}
+
 absl::Status BundleReader::GetValue(const BundleEntryProto& entry,
                                     Tensor* val) {
+  if (use_mmap_ && DataTypeCanUseMemcpy(entry.dtype()) &&
+      !need_to_swap_bytes_ && entry.size() > 0) {
+    bool mapped = false;
+    TF_RETURN_IF_ERROR(GetMappedValue(entry, val, &mapped));
+    if (mapped) return absl::OkStatus();
+  }
+
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
   if (val->NumElements() == 0) {
@@ -1023,13 +1196,7 @@ absl::Status BundleReader::GetValue(const BundleEntryProto& entry,
         buffered_file, ret->NumElements(), entry.offset(), entry.size(),
         GetStringBackingBuffer(*ret), &actual_crc32c, need_to_swap_bytes_));
   }
-  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
-    return absl::DataLossError(absl::StrCat(
-        "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
-        entry.size(), " bytes): Checksum does not match: stored ",
-        absl::StrFormat("%08u", crc32c::Unmask(entry.crc32c())),
-        " vs. calculated on the restored bytes ", actual_crc32c));
-  }
+  TF_RETURN_IF_ERROR(VerifyChecksum(prefix_, entry, actual_crc32c));
 
   *val = *ret;
   if (ret != val) delete ret;
@@ -1050,6 +1217,95 @@ absl::Status BundleReader::Lookup(absl::string_view key, Tensor* val) {
   }
 }
 
+absl::Status BundleReader::ParallelLookup(absl::Span<const std::string> keys,
+                                          absl::Span<Tensor* const> vals,
+                                          const ParallelLookupOptions& options) {
+  CHECK_EQ(keys.size(), vals.size());
+  CHECK(options.pool != nullptr);
+
+  // Reads all metadata up front, on this thread, as the table iterator is not
+  // thread-safe.
+  std::vector<BundleEntryProto> entries(keys.size());
+  std::vector<size_t> pooled;
+  std::vector<size_t> local;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    TF_RETURN_IF_ERROR(GetBundleEntryProto(keys[i], &entries[i]));
+    const BundleEntryProto& entry = entries[i];
+    if (use_mmap_ || need_to_swap_bytes_ || !entry.slices().empty() ||
+        !DataTypeCanUseMemcpy(entry.dtype()) || entry.size() == 0) {
+      local.push_back(i);
+      continue;
+    }
+    Tensor* val = vals[i];
+    if (val->NumElements() == 0) {
+      *val = Tensor(entry.dtype(), TensorShape(entry.shape()));
+    }
+    if (entry.size() != val->TotalBytes()) {
+      return absl::DataLossError(absl::StrCat(
+          "Invalid size in bundle entry: key ", keys[i], "; stored size ",
+          entry.size(), "; expected size ", val->TotalBytes()));
+    }
+    pooled.push_back(i);
+  }
+
+  // Groups the tensors read from the pool into coalesced reads.
+  absl::c_sort(pooled, [&entries](size_t a, size_t b) {
+    return std::make_pair(entries[a].shard_id(), entries[a].offset()) <
+           std::make_pair(entries[b].shard_id(), entries[b].offset());
+  });
+  std::vector<CoalescedRead> reads;
+  for (size_t i : pooled) {
+    const BundleEntryProto& entry = entries[i];
+    if (!reads.empty()) {
+      CoalescedRead& last = reads.back();
+      const int64_t end = last.offset + last.size;
+      const int64_t extended_size = entry.offset() + entry.size() - last.offset;
+      if (entry.shard_id() == last.shard_id && entry.offset() >= end &&
+          entry.offset() - end <= options.max_coalesced_gap_bytes &&
+          extended_size <= options.max_coalesced_read_bytes) {
+        last.size = extended_size;
+        last.tensors.emplace_back(&entry, vals[i]);
+        continue;
+      }
+    }
+    reads.push_back({entry.shard_id(),
+                     entry.offset(),
+                     static_cast<int64_t>(entry.size()),
+                     {{&entry, vals[i]}}});
+  }
+
+  std::vector<RandomAccessFile*> files(reads.size());
+  for (size_t r = 0; r < reads.size(); ++r) {
+    TF_RETURN_IF_ERROR(cache_->GetFile(
+        DataFilename(prefix_, reads[r].shard_id, num_shards_), &files[r]));
+  }
+
+  InflightBytesBudget budget(options.max_inflight_bytes);
+  std::vector<absl::Status> statuses(reads.size());
+  absl::BlockingCounter pending(reads.size());
+  for (size_t r = 0; r < reads.size(); ++r) {
+    budget.Acquire(reads[r].size);
+    options.pool->Schedule([&, r]() {
+      statuses[r] = ReadCoalesced(files[r], prefix_, reads[r]);
+      budget.Release(reads[r].size);
+      pending.DecrementCount();
+    });
+  }
+
+  // Looks up the remaining tensors while the last reads are in flight.
+  absl::Status status;
+  for (size_t i : local) {
+    status = Lookup(keys[i], vals[i]);
+    if (!status.ok()) break;
+  }
+
+  pending.Wait();
+  for (const absl::Status& s : statuses) {
+    status.Update(s);
+  }
+  return status;
+}
+
 absl::Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
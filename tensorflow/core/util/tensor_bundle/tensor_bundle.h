@@ -90,6 +90,7 @@ limitations under the License.
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/tstring.h"
 #include "tensorflow/core/protobuf/tensor_bundle.pb.h"
 #include "tensorflow/core/util/tensor_slice_set.h"
@@ -118,10 +119,19 @@ extern const char* const kHeaderEntryKey;
 // All threads accessing the same BundleWriter must synchronize.
 class BundleWriter {
  public:
+  // A `data_alignment` that places every tensor on a page boundary on all
+  // platforms TensorFlow supports.
+  static constexpr int kPageDataAlignment = 64 << 10;
+
   struct Options {
     Options() {}
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
+    //
+    // Aligning tensor data to a multiple of the page size (see
+    // kPageDataAlignment) lets a BundleReader with `use_mmap` set serve the
+    // tensors directly from the mapped data files, and keeps each tensor on
+    // pages of its own.
     int data_alignment{1};
   };
   BundleWriter(Env* env, absl::string_view prefix,
@@ -217,6 +227,22 @@ class BundleReader {
 
     // For tests only.
     bool enable_multi_threading_for_testing = false;
+
+    // If true, Lookup() of a tensor of a fixed-size type whose data is
+    // suitably aligned in the data file (see BundleWriter::Options) returns a
+    // tensor that references the memory-mapped file instead of reading its
+    // contents into a buffer. The data files are mapped read-only and the
+    // buffer reports that it does not own its memory, so it is never
+    // forwarded to a kernel that updates it in place: mutating such a tensor
+    // through the usual copy-on-write paths (e.g. assigning to a variable that
+    // holds it) copies it first. The mapping lives as long as any tensor that
+    // references it. Pass an empty tensor to Lookup() to avoid allocating a
+    // buffer that is then discarded.
+    //
+    // Falls back to reading the tensor if the file system does not support
+    // memory mapping, if the data is not aligned, or if the bundle has a
+    // different endianness than this machine.
+    bool use_mmap = false;
   };
   BundleReader(Env* env, absl::string_view prefix, Options options);
 
@@ -268,6 +294,36 @@ class BundleReader {
   // REQUIRES: status().ok()
   absl::Status Lookup(absl::string_view key, Tensor* val);
 
+  struct ParallelLookupOptions {
+    // Pool that reads the tensor data.  Not owned; must not be null, and must
+    // not be the pool running the calling thread.
+    thread::ThreadPool* pool = nullptr;
+
+    // Upper bound on the number of bytes being read at any time.  A single
+    // read larger than this is issued once no other read is in flight.
+    int64_t max_inflight_bytes = int64_t{1} << 30;
+
+    // Tensors that are stored at most "max_coalesced_gap_bytes" apart in the
+    // same data file are fetched with a single read, as long as that read
+    // spans at most "max_coalesced_read_bytes".
+    int64_t max_coalesced_gap_bytes = 64 << 10;
+    int64_t max_coalesced_read_bytes = 16 << 20;
+  };
+
+  // Looks up the tensors keyed by "keys" into "vals", as if by calling
+  // Lookup() on each pair, but reads the data of fixed-size tensors from
+  // "options.pool", coalescing reads of tensors that are adjacent in a data
+  // file.  Other tensors (partitioned, string and variant tensors, and all
+  // tensors of a bundle of a different endianness or of a reader using
+  // memory mapping) are looked up on the calling thread while the pool reads
+  // the rest.
+  //
+  // Validates the stored crc32c checksums against the restored bytes.
+  // REQUIRES: status().ok() && keys.size() == vals.size()
+  absl::Status ParallelLookup(absl::Span<const std::string> keys,
+                              absl::Span<Tensor* const> vals,
+                              const ParallelLookupOptions& options);
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -323,6 +379,12 @@ class BundleReader {
   // Usage for "val" follows the comment of "Lookup()".
   absl::Status GetValue(const BundleEntryProto& entry, Tensor* val);
 
+  // If "entry" can be served from the memory-mapped data file, points "val"
+  // at the mapped data and sets "*mapped" to true.  Otherwise leaves "val"
+  // untouched and sets "*mapped" to false.
+  absl::Status GetMappedValue(const BundleEntryProto& entry, Tensor* val,
+                              bool* mapped);
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -344,6 +406,12 @@ class BundleReader {
   // Owned InputBuffer objects. cache_ owns the underlying RandomAccessFiles.
   std::unordered_map<int32_t, io::InputBuffer*> data_;
 
+  // Memory-mapped data files, shared with the tensors that reference them.
+  // Holds nullptr for a shard that could not be mapped.  Only used if
+  // Options::use_mmap is set.
+  std::unordered_map<int32_t, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
+
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
   std::unordered_map<std::string, checkpoint::TensorSliceSet*> tensor_slices_;
@@ -360,6 +428,8 @@ class BundleReader {
 
   bool enable_multi_threading_for_testing_ = false;
 
+  bool use_mmap_ = false;
+
   BundleReader(const BundleReader&) = delete;
   void operator=(const BundleReader&) = delete;
 };
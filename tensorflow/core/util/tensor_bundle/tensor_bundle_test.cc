@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <random>
 #include <string>
 #include <vector>
@@ -25,7 +27,9 @@ limitations under the License.
 
 #include "absl/status/status.h"
 #include "xla/tsl/platform/errors.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -1261,6 +1265,183 @@ TEST(TensorBundleTest, LargeVariableLoadingTest) {
   }
 }
 
+// Returns true if "t" references a memory-mapped data file.
+bool IsMapped(const Tensor& t) {
+  TensorDescription description;
+  t.FillDescription(&description);
+  return description.allocation_description().allocator_name() == "mmap";
+}
+
+BundleReader::Options MmapOptions() {
+  BundleReader::Options options;
+  options.use_mmap = true;
+  return options;
+}
+
+TEST(TensorBundleTest, MmapLookup) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = BundleWriter::kPageDataAlignment;
+    BundleWriter writer(Env::Default(), Prefix("mmap"), opts);
+    TF_EXPECT_OK(writer.Add("float", Constant_100x100<float>(1.5)));
+    TF_EXPECT_OK(writer.Add("int64", Constant_2x3<int64_t>(7)));
+    TF_EXPECT_OK(writer.Add("string", Constant_2x3<tstring>("hello")));
+    TF_EXPECT_OK(writer.Add("empty", Constant<float>(0, TensorShape({0}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor mapped;
+  {
+    BundleReader reader(Env::Default(), Prefix("mmap"), MmapOptions());
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "float", Constant_100x100<float>(1.5));
+    Expect<int64_t>(&reader, "int64", Constant_2x3<int64_t>(7));
+    Expect<tstring>(&reader, "string", Constant_2x3<tstring>("hello"));
+    Expect<float>(&reader, "empty", Constant<float>(0, TensorShape({0})));
+
+    TF_ASSERT_OK(reader.Lookup("float", &mapped));
+    EXPECT_TRUE(IsMapped(mapped));
+    // Kernels must not update the mapped buffer in place.
+    EXPECT_FALSE(mapped.RefCountIsOne());
+
+    Tensor string_tensor;
+    TF_ASSERT_OK(reader.Lookup("string", &string_tensor));
+    EXPECT_FALSE(IsMapped(string_tensor));
+  }
+  // The mapping outlives the reader.
+  test::ExpectTensorEqual<float>(mapped, Constant_100x100<float>(1.5));
+}
+
+TEST(TensorBundleTest, MmapLookupFallsBackForUnalignedData) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("mmap_unaligned"));
+    TF_EXPECT_OK(writer.Add("a_bool", Constant(true, TensorShape({1}))));
+    TF_EXPECT_OK(writer.Add("b_float", Constant_2x3<float>(2)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("mmap_unaligned"), MmapOptions());
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("b_float", &val));
+  EXPECT_FALSE(IsMapped(val));
+  test::ExpectTensorEqual<float>(val, Constant_2x3<float>(2));
+}
+
+TEST(TensorBundleTest, MmapLookupValidatesData) {
+  Env* env = Env::Default();
+  {
+    BundleWriter writer(env, Prefix("mmap_corrupt"));
+    TF_EXPECT_OK(writer.Add("key", Constant_2x3<float>(1.0)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  const std::string datafile = DataFilename(Prefix("mmap_corrupt"), 0, 1);
+  std::string data;
+  TF_ASSERT_OK(ReadFileToString(env, datafile, &data));
+  ASSERT_TRUE(!data.empty());
+
+  std::string flipped = data;
+  flipped[0] = ~flipped[0];
+  TF_ASSERT_OK(WriteStringToFile(env, datafile, flipped));
+  {
+    BundleReader reader(env, Prefix("mmap_corrupt"), MmapOptions());
+    TF_ASSERT_OK(reader.status());
+    Tensor val;
+    EXPECT_TRUE(absl::IsDataLoss(reader.Lookup("key", &val)));
+  }
+
+  TF_ASSERT_OK(WriteStringToFile(
+      env, datafile, absl::string_view(data.data(), data.size() - 1)));
+  {
+    BundleReader reader(env, Prefix("mmap_corrupt"), MmapOptions());
+    TF_ASSERT_OK(reader.status());
+    Tensor val(DT_FLOAT, TensorShape({2, 3}));
+    EXPECT_TRUE(absl::IsOutOfRange(reader.Lookup("key", &val)));
+  }
+}
+
+TEST(TensorBundleTest, ParallelLookup) {
+  const TensorShape kFullShape({5, 10});
+  {
+    BundleWriter writer(Env::Default(), Prefix("parallel"));
+    TF_EXPECT_OK(writer.Add("a_float", Constant_100x100<float>(1)));
+    TF_EXPECT_OK(writer.Add("b_int64", Constant_2x3<int64_t>(2)));
+    TF_EXPECT_OK(writer.Add("c_string", Constant_2x3<tstring>("three")));
+    TF_EXPECT_OK(writer.Add("d_double", Constant_100x100<double>(4)));
+    TF_EXPECT_OK(writer.Add("e_empty", Constant<float>(0, TensorShape({0}))));
+    TF_EXPECT_OK(writer.AddSlice("f_partitioned", kFullShape,
+                                 TensorSlice::ParseOrDie("-:0,1"),
+                                 Constant<float>(5, TensorShape({5, 1}))));
+    TF_EXPECT_OK(writer.AddSlice("f_partitioned", kFullShape,
+                                 TensorSlice::ParseOrDie("-:1,9"),
+                                 Constant<float>(5, TensorShape({5, 9}))));
+    TF_EXPECT_OK(writer.Add("g_int32", Constant_2x3<int32_t>(6)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  const std::vector<std::string> keys = {"g_int32", "d_double", "c_string",
+                                         "a_float", "f_partitioned",
+                                         "e_empty", "b_int64"};
+
+  thread::ThreadPool pool(Env::Default(), "parallel_lookup", 4);
+  // Exercises uncoalesced reads, coalesced reads, and a budget smaller than
+  // the largest read.
+  for (int64_t max_coalesced_read_bytes : {int64_t{1}, int64_t{1} << 20}) {
+    BundleReader reader(Env::Default(), Prefix("parallel"));
+    TF_ASSERT_OK(reader.status());
+    BundleReader::ParallelLookupOptions options;
+    options.pool = &pool;
+    options.max_inflight_bytes = 1024;
+    options.max_coalesced_read_bytes = max_coalesced_read_bytes;
+
+    std::vector<Tensor> tensors(keys.size());
+    std::vector<Tensor*> vals;
+    for (Tensor& t : tensors) vals.push_back(&t);
+    tensors[0] = Tensor(DT_INT32, TensorShape({2, 3}));
+    tensors[4] = Tensor(DT_FLOAT, kFullShape);
+    TF_ASSERT_OK(reader.ParallelLookup(keys, vals, options));
+
+    test::ExpectTensorEqual<int32_t>(tensors[0], Constant_2x3<int32_t>(6));
+    test::ExpectTensorEqual<double>(tensors[1], Constant_100x100<double>(4));
+    test::ExpectTensorEqual<tstring>(tensors[2],
+                                     Constant_2x3<tstring>("three"));
+    test::ExpectTensorEqual<float>(tensors[3], Constant_100x100<float>(1));
+    test::ExpectTensorEqual<float>(tensors[4], Constant<float>(5, kFullShape));
+    EXPECT_EQ(0, tensors[5].NumElements());
+    test::ExpectTensorEqual<int64_t>(tensors[6], Constant_2x3<int64_t>(2));
+  }
+}
+
+TEST(TensorBundleTest, ParallelLookupErrors) {
+  Env* env = Env::Default();
+  {
+    BundleWriter writer(env, Prefix("parallel_corrupt"));
+    TF_EXPECT_OK(writer.Add("a", Constant_2x3<float>(1)));
+    TF_EXPECT_OK(writer.Add("b", Constant_2x3<float>(2)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  thread::ThreadPool pool(env, "parallel_lookup", 2);
+  BundleReader::ParallelLookupOptions options;
+  options.pool = &pool;
+  Tensor a, b;
+  std::vector<Tensor*> vals = {&a, &b};
+  {
+    BundleReader reader(env, Prefix("parallel_corrupt"));
+    TF_ASSERT_OK(reader.status());
+    EXPECT_TRUE(absl::IsNotFound(
+        reader.ParallelLookup({"a", "missing"}, vals, options)));
+  }
+
+  const std::string datafile = DataFilename(Prefix("parallel_corrupt"), 0, 1);
+  std::string data;
+  TF_ASSERT_OK(ReadFileToString(env, datafile, &data));
+  data[data.size() - 1] = ~data[data.size() - 1];
+  TF_ASSERT_OK(WriteStringToFile(env, datafile, data));
+  {
+    BundleReader reader(env, Prefix("parallel_corrupt"));
+    TF_ASSERT_OK(reader.status());
+    EXPECT_TRUE(
+        absl::IsDataLoss(reader.ParallelLookup({"a", "b"}, vals, options)));
+  }
+}
+
 absl::Status CreateFile(Env* env, const std::string& fname) {
   std::unique_ptr<WritableFile> file;
   TF_RETURN_IF_ERROR(env->NewWritableFile(fname, &file));
@@ -1432,4 +1613,48 @@ static void BM_BundleWriterLargeTensor(::testing::benchmark::State& state) {
 BENCHMARK(BM_BundleWriterLargeTensor)->Arg(1 << 10);
 BENCHMARK(BM_BundleWriterLargeTensor)->Arg(4 << 10);
 
+// Restores a bundle of `state.range(0)` MiB of float tensors, reading them
+// into buffers if `state.range(1)` is 0 and memory-mapping them otherwise.
+// Reports the peak number of bytes allocated on the heap while the restored
+// tensors are alive.
+static void BM_BundleRestore(::testing::benchmark::State& state) {
+  constexpr int64_t kTensorBytes = 16 << 20;
+  const int64_t total_bytes = state.range(0) * (int64_t{1} << 20);
+  const bool use_mmap = state.range(1) != 0;
+  const int num_tensors = total_bytes / kTensorBytes;
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = BundleWriter::kPageDataAlignment;
+    BundleWriter writer(Env::Default(), Prefix("restore"), opts);
+    const Tensor t =
+        Constant(1.0f, TensorShape({kTensorBytes / int64_t{sizeof(float)}}));
+    for (int i = 0; i < num_tensors; ++i) {
+      TF_CHECK_OK(writer.Add(absl::StrCat("t", i), t));
+    }
+    TF_CHECK_OK(writer.Finish());
+  }
+
+  EnableCPUAllocatorStats();
+  Allocator* allocator = cpu_allocator();
+  int64_t peak_bytes = 0;
+  BundleReader::Options options;
+  options.use_mmap = use_mmap;
+  for (auto s : state) {
+    allocator->ClearStats();
+    BundleReader reader(Env::Default(), Prefix("restore"), options);
+    TF_CHECK_OK(reader.status());
+    std::vector<Tensor> restored(num_tensors);
+    for (int i = 0; i < num_tensors; ++i) {
+      TF_CHECK_OK(reader.Lookup(absl::StrCat("t", i), &restored[i]));
+    }
+    peak_bytes = std::max(peak_bytes, allocator->GetStats()->peak_bytes_in_use);
+  }
+  DisableCPUAllocatorStats();
+  state.SetBytesProcessed(state.iterations() * num_tensors * kTensorBytes);
+  state.counters["peak_heap_mb"] = peak_bytes >> 20;
+}
+
+BENCHMARK(BM_BundleRestore)->ArgPair(256, 0)->ArgPair(256, 1);
+BENCHMARK(BM_BundleRestore)->ArgPair(4096, 0)->ArgPair(4096, 1);
+
 }  // namespace tensorflow
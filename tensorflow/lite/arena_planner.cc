@@ -18,8 +18,11 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <memory>
+#include <numeric>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -34,6 +37,56 @@ constexpr int32_t kLastActiveNodeUndefined =
 constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
 constexpr int32_t kScalarTensorBytes = 4;
 
+namespace {
+
+// Serialized plans are laid out as follows, in host byte order:
+//
+//   char magic[4]; uint32 version; int32 tensor_alignment; uint32 num_allocs;
+//   PlanRecord allocs[num_allocs];
+//   uint64 checksum;  // FNV-1a of all preceding bytes.
+constexpr char kPlanMagic[4] = {'T', 'F', 'L', 'P'};
+constexpr uint32_t kPlanVersion = 1;
+constexpr size_t kPlanHeaderSize = 16;
+constexpr size_t kPlanChecksumSize = sizeof(uint64_t);
+
+struct PlanRecord {
+  int32_t tensor;
+  int32_t allocation_type;
+  int32_t first_node;
+  int32_t last_node;
+  uint64_t size;
+  uint64_t offset;
+};
+static_assert(sizeof(PlanRecord) == 32, "PlanRecord must not be padded");
+
+uint64_t PlanChecksum(const char* data, size_t size) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+template <typename T>
+void AppendBytes(const T& value, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T ReadBytes(const char* data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+// Returns true if `value` can be represented as a size_t.
+bool FitsInSizeT(uint64_t value) {
+  return static_cast<uint64_t>(static_cast<size_t>(value)) == value;
+}
+
+}  // namespace
+
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
                            bool preserve_all_tensors, int tensor_alignment,
@@ -71,6 +124,7 @@ TfLiteStatus ArenaPlanner::ResetAllocations() {
   // all allocs to be cleared. if this is not set, the slow path is taken
   // (Purge) which inspects each alloc. Both paths give the exact same result.
   last_active_node_ = kLastActiveNodeUndefined;
+  allocations_reset_ = true;
   return kTfLiteOk;
 }
 
@@ -91,6 +145,7 @@ TfLiteStatus ArenaPlanner::ResetAllocationsAfter(int node) {
     arena_.PurgeAfter(node);
   }
   last_active_node_ = node;
+  allocations_reset_ = false;
   return kTfLiteOk;
 }
 
@@ -302,6 +357,9 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   // Go through the graph in execution order.
   for (size_t i = 0; i < num_execution_nodes; ++i) {
     const TfLiteNode& node = graph_info_->node(i);
+    // Nodes that may run concurrently allocate their outputs before the first
+    // of them runs, and release their inputs after the last of them ran.
+    const auto [first_node, last_node] = graph_info_->concurrent_node_range(i);
 
     // First queue output tensors for allocation.
     TfLiteIntArray* node_outputs = node.outputs;
@@ -309,8 +367,8 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
       int tensor_index = node_outputs->data[j];
       if (tensor_index == kTfLiteOptionalTensor) continue;
       //  Don't allocate output tensors here for shared memory parts.
-      nodes_to_tensors_[i].insert(tensor_index);
-      TF_LITE_ENSURE_STATUS(allocate(i, tensor_index));
+      nodes_to_tensors_[first_node].insert(tensor_index);
+      TF_LITE_ENSURE_STATUS(allocate(first_node, tensor_index));
     }
 
     // Then update the ref-counts of the node's inputs, and if necessary queue
@@ -325,7 +383,7 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
           tensor_index = FindSharedTensor(tensor_index);
           --refcounts[tensor_index];
           if (refcounts[tensor_index] == 0) {
-            TF_LITE_ENSURE_STATUS(deallocate(i, tensor_index));
+            TF_LITE_ENSURE_STATUS(deallocate(last_node, tensor_index));
           }
         }
       }
@@ -349,20 +407,24 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
   for (size_t i = first_node;
        i <= static_cast<size_t>(last_node) && i < num_execution_nodes; ++i) {
     const TfLiteNode& node = graph_info_->node(i);
+    const auto [first_concurrent_node, last_concurrent_node] =
+        graph_info_->concurrent_node_range(i);
     TfLiteIntArray* node_temporaries = node.temporaries;
     for (int j = 0; j < node_temporaries->size; ++j) {
       int tensor_index = node_temporaries->data[j];
-      alloc_node_[tensor_index] = i;
-      nodes_to_tensors_[i].insert(tensor_index);
+      alloc_node_[tensor_index] = first_concurrent_node;
+      nodes_to_tensors_[first_concurrent_node].insert(tensor_index);
       if (!preserve_all_tensors_) {
-        dealloc_node_[tensor_index] = i;
+        dealloc_node_[tensor_index] = last_concurrent_node;
       }
     }
   }
 
   std::vector<int32_t> tensors_allocated;
+  last_plan_source_ = PlanSource::kIncremental;
   TF_LITE_ENSURE_STATUS(
       CalculateAllocations(first_node, last_node, &tensors_allocated));
+  allocations_reset_ = false;
   bool arena_reallocated = false;
   TF_LITE_ENSURE_STATUS(Commit(&arena_reallocated));
 
@@ -518,7 +580,9 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
     arena_.PurgeActiveAllocs(first_node);
   }
   CreateTensorAllocationVector(tensors_allocated);
-  // Vector of ids of already allocated tensors, ordered by offset.
+  // Collect the allocations to make, in order.
+  std::vector<AllocationRequest> requests;
+  requests.reserve(tensors_allocated->size());
   for (const auto& tensor_index : *tensors_allocated) {
     TfLiteTensor& tensor = tensors[tensor_index];
     // Only allocate ArenaRw tensors which own their buffer.
@@ -541,28 +605,156 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       }
     }
     if (tensor.allocation_type == kTfLiteArenaRw) {
-      TF_LITE_ENSURE_STATUS(
-          arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
-                          tensor_index, alloc_node_[tensor_index],
-                          dealloc_node_[tensor_index], &allocs_[tensor_index]));
+      requests.push_back({tensor_index, kTfLiteArenaRw,
+                          alloc_node_[tensor_index],
+                          dealloc_node_[tensor_index], tensor.bytes});
     }
     // Check allocs_[].size to prevent from reallocation of persistent tensors.
     // Only allocate ArenaRwPersistent tensors which own their buffer.
     if (tensor.allocation_type == kTfLiteArenaRwPersistent &&
         allocs_[tensor_index].size == 0) {
       if (allocs_[tensor_index].size < tensor.bytes) {
-        TF_LITE_ENSURE_STATUS(persistent_arena_.Allocate(
-            context_, tensor_alignment_, tensor.bytes, tensor_index,
-            /*first_node=*/alloc_node_[tensor_index],
-            /*last_node=*/std::numeric_limits<int32_t>::max(),
-            &allocs_[tensor_index]));
+        requests.push_back({tensor_index, kTfLiteArenaRwPersistent,
+                            /*first_node=*/alloc_node_[tensor_index],
+                            /*last_node=*/std::numeric_limits<int32_t>::max(),
+                            tensor.bytes});
       }
     }
   }
+
+  // The greedy offset assignment is deterministic, so when starting from
+  // empty arenas the same requests always get the same offsets.
+  const bool from_scratch = allocations_reset_ && first_node == 0;
+  if (from_scratch && requests == plan_.requests) {
+    for (size_t i = 0; i < requests.size(); ++i) {
+      const AllocationRequest& request = requests[i];
+      SimpleMemoryArena& arena = request.allocation_type == kTfLiteArenaRw
+                                     ? arena_
+                                     : persistent_arena_;
+      TF_LITE_ENSURE_STATUS(arena.AllocateAt(
+          context_, tensor_alignment_, plan_.offsets[i], request.size,
+          request.tensor, request.first_node, request.last_node,
+          &allocs_[request.tensor]));
+    }
+    last_plan_source_ = PlanSource::kReused;
+    last_active_node_ = last_node;
+    return kTfLiteOk;
+  }
+
+  for (const AllocationRequest& request : requests) {
+    SimpleMemoryArena& arena =
+        request.allocation_type == kTfLiteArenaRw ? arena_ : persistent_arena_;
+    TF_LITE_ENSURE_STATUS(arena.Allocate(
+        context_, tensor_alignment_, request.size, request.tensor,
+        request.first_node, request.last_node, &allocs_[request.tensor]));
+  }
+  if (from_scratch) {
+    plan_.offsets.clear();
+    plan_.offsets.reserve(requests.size());
+    for (const AllocationRequest& request : requests) {
+      plan_.offsets.push_back(allocs_[request.tensor].offset);
+    }
+    plan_.requests = std::move(requests);
+    last_plan_source_ = PlanSource::kComputed;
+  }
   last_active_node_ = last_node;
   return kTfLiteOk;
 }
 
+bool ArenaPlanner::ExportPlan(std::string* plan) const {
+  if (plan_.requests.empty()) {
+    return false;
+  }
+  plan->clear();
+  plan->reserve(kPlanHeaderSize + plan_.requests.size() * sizeof(PlanRecord) +
+                kPlanChecksumSize);
+  plan->append(kPlanMagic, sizeof(kPlanMagic));
+  AppendBytes(kPlanVersion, plan);
+  AppendBytes(static_cast<int32_t>(tensor_alignment_), plan);
+  AppendBytes(static_cast<uint32_t>(plan_.requests.size()), plan);
+  for (size_t i = 0; i < plan_.requests.size(); ++i) {
+    const AllocationRequest& request = plan_.requests[i];
+    AppendBytes(PlanRecord{request.tensor, request.allocation_type,
+                           request.first_node, request.last_node,
+                           static_cast<uint64_t>(request.size),
+                           static_cast<uint64_t>(plan_.offsets[i])},
+                plan);
+  }
+  AppendBytes(PlanChecksum(plan->data(), plan->size()), plan);
+  return true;
+}
+
+bool ArenaPlanner::ImportPlan(const char* plan, size_t size) {
+  if (size < kPlanHeaderSize + kPlanChecksumSize ||
+      std::memcmp(plan, kPlanMagic, sizeof(kPlanMagic)) != 0 ||
+      ReadBytes<uint32_t>(plan + 4) != kPlanVersion ||
+      ReadBytes<int32_t>(plan + 8) != tensor_alignment_) {
+    return false;
+  }
+  const uint32_t num_allocs = ReadBytes<uint32_t>(plan + 12);
+  if ((size - kPlanHeaderSize - kPlanChecksumSize) / sizeof(PlanRecord) !=
+          num_allocs ||
+      (size - kPlanHeaderSize - kPlanChecksumSize) % sizeof(PlanRecord) != 0) {
+    return false;
+  }
+  if (ReadBytes<uint64_t>(plan + size - kPlanChecksumSize) !=
+      PlanChecksum(plan, size - kPlanChecksumSize)) {
+    return false;
+  }
+  AllocationPlan imported;
+  imported.requests.reserve(num_allocs);
+  imported.offsets.reserve(num_allocs);
+  const char* records = plan + kPlanHeaderSize;
+  for (uint32_t i = 0; i < num_allocs; ++i) {
+    const PlanRecord record =
+        ReadBytes<PlanRecord>(records + i * sizeof(PlanRecord));
+    if ((record.allocation_type != kTfLiteArenaRw &&
+         record.allocation_type != kTfLiteArenaRwPersistent) ||
+        record.tensor < 0 || record.first_node > record.last_node ||
+        !FitsInSizeT(record.size) || !FitsInSizeT(record.offset) ||
+        record.size > std::numeric_limits<size_t>::max() - record.offset ||
+        record.offset % tensor_alignment_ != 0) {
+      return false;
+    }
+    imported.requests.push_back(
+        {record.tensor, record.allocation_type, record.first_node,
+         record.last_node, static_cast<size_t>(record.size)});
+    imported.offsets.push_back(static_cast<size_t>(record.offset));
+  }
+  if (HasOverlappingAllocations(imported)) {
+    return false;
+  }
+  plan_ = std::move(imported);
+  return true;
+}
+
+bool ArenaPlanner::HasOverlappingAllocations(const AllocationPlan& plan) {
+  // Sorting by arena and offset, each allocation only needs to be compared
+  // with the ones that start before it ends.
+  std::vector<size_t> order(plan.requests.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&plan](size_t a, size_t b) {
+    return std::make_pair(plan.requests[a].allocation_type, plan.offsets[a]) <
+           std::make_pair(plan.requests[b].allocation_type, plan.offsets[b]);
+  });
+  for (size_t i = 0; i < order.size(); ++i) {
+    const AllocationRequest& request = plan.requests[order[i]];
+    const size_t end = plan.offsets[order[i]] + request.size;
+    for (size_t j = i + 1; j < order.size(); ++j) {
+      const AllocationRequest& other = plan.requests[order[j]];
+      if (other.allocation_type != request.allocation_type ||
+          plan.offsets[order[j]] >= end) {
+        break;
+      }
+      if (other.size != 0 && other.first_node <= request.last_node &&
+          request.first_node <= other.last_node) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 bool AreTensorsAllocatedInSameArena(int32_t root_tensor_index,
                                     int32_t tensor_index,
                                     const TfLiteTensor* tensors) {
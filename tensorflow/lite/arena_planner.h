@@ -18,6 +18,7 @@ limitations under the License.
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -45,8 +46,24 @@ constexpr const int kDefaultArenaAlignment = 64;
 // execution. Since dynamic tensors don't have sizes until after the
 // corresponding operation is executed, this class supports incremental
 // planning.
+//
+// The offsets assigned by the ExecuteAllocations phase can be exported and
+// imported into another planner (e.g. in a later process loading the same
+// model), which then reuses them instead of searching for a place for each
+// tensor, as long as exactly the same allocations are requested.
 class ArenaPlanner : public MemoryPlanner {
  public:
+  // Where the offsets of the last ExecuteAllocations() call came from.
+  enum class PlanSource {
+    // The call didn't start from the first node after ResetAllocations(), so
+    // it extended an existing plan.
+    kIncremental,
+    // The offsets were computed by the planner.
+    kComputed,
+    // The offsets were taken from a previously computed or imported plan.
+    kReused,
+  };
+
   // Ownership of 'context' is not taken and it must remain util the
   // ArenaPlanner is destroyed. The inputs to the graph will not share
   // memory with any other tensor, effectively preserving them until the end
@@ -72,7 +89,52 @@ class ArenaPlanner : public MemoryPlanner {
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
 
+  // Serializes into `plan` the offsets assigned by the last
+  // ExecuteAllocations() call that started from the first node after
+  // ResetAllocations(), or the last imported plan if that came later. Returns
+  // false if there is no such plan or it is empty.
+  bool ExportPlan(std::string* plan) const;
+
+  // Loads a plan serialized by ExportPlan(). Subsequent ExecuteAllocations()
+  // calls starting from the first node after ResetAllocations() reuse its
+  // offsets if they request exactly the same allocations (same tensors,
+  // sizes, lifetimes and order), and compute new offsets otherwise. Returns
+  // false, leaving the planner unchanged, if `plan` is malformed, assigns
+  // overlapping memory to tensors that are live at the same time, or was
+  // created for a different tensor alignment.
+  bool ImportPlan(const char* plan, size_t size);
+
+  PlanSource last_plan_source() const { return last_plan_source_; }
+
  private:
+  // An allocation made by CalculateAllocations(), in the order in which it was
+  // made.
+  struct AllocationRequest {
+    int32_t tensor;
+    int32_t allocation_type;
+    int32_t first_node;
+    int32_t last_node;
+    size_t size;
+
+    bool operator==(const AllocationRequest& other) const {
+      return tensor == other.tensor &&
+             allocation_type == other.allocation_type &&
+             first_node == other.first_node && last_node == other.last_node &&
+             size == other.size;
+    }
+  };
+
+  // The allocations made by an ExecuteAllocations() call starting from
+  // scratch, and the offsets they were assigned.
+  struct AllocationPlan {
+    std::vector<AllocationRequest> requests;
+    std::vector<size_t> offsets;
+  };
+
+  // Returns true if two allocations of `plan` in the same arena are live at
+  // the same time and were assigned overlapping ranges of the arena.
+  static bool HasOverlappingAllocations(const AllocationPlan& plan);
+
   // Check whether the input tensor's memory may be shared the output tensor.
   // tensor_changed: true if the output tensor modifies the tensor data. For
   // example, `Reshape` doesn't modify data but Add does.
@@ -166,6 +228,15 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Store number of references to each tensor.
   std::vector<int> refcounts_;
+
+  // True if no allocation was made since the last ResetAllocations().
+  bool allocations_reset_ = false;
+
+  // The plan of the last ExecuteAllocations() call starting from scratch, or
+  // the last imported plan, whichever came last.
+  AllocationPlan plan_;
+
+  PlanSource last_plan_source_ = PlanSource::kIncremental;
 };
 
 }  // namespace tflite
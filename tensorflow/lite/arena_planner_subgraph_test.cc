@@ -12,12 +12,21 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
 #include <vector>
 
 #include <gtest/gtest.h>
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/kernels/subgraph_test_util.h"
 
 namespace tflite {
@@ -156,5 +165,136 @@ TEST(ArenaPlannerSubgraphTest, HWTensor) {
   EXPECT_NE(reshape_output->data.data, nullptr);
 }
 
+std::string ReadFile(const std::string& filename) {
+  std::ifstream file(filename, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+}
+
+// Builds a residual ADD chain of `num_ops` nodes whose input has `input_size`
+// elements, and allocates its tensors.
+void BuildAndAllocateResidualAddChain(Interpreter* interpreter, int num_ops,
+                                      int input_size,
+                                      InterpreterOptions* options) {
+  subgraph_test_util::SubgraphBuilder builder;
+  builder.BuildResidualAddChainSubgraph(&interpreter->primary_subgraph(),
+                                        num_ops);
+  ASSERT_EQ(interpreter->ApplyOptions(options), kTfLiteOk);
+  ASSERT_EQ(interpreter->ResizeInputTensor(interpreter->inputs()[0],
+                                           {input_size}),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+}
+
+// Returns the offsets of the tensors of `interpreter` relative to its input.
+std::vector<std::ptrdiff_t> RelativeTensorOffsets(
+    const Interpreter& interpreter) {
+  const char* input = interpreter.tensor(interpreter.inputs()[0])->data.raw;
+  std::vector<std::ptrdiff_t> offsets;
+  for (int i = 0; i < interpreter.tensors_size(); ++i) {
+    offsets.push_back(interpreter.tensor(i)->data.raw - input);
+  }
+  return offsets;
+}
+
+// Runs the residual ADD chain of `num_ops` nodes on an input of ones and checks
+// its output.
+void InvokeAndCheckResidualAddChain(Interpreter* interpreter, int num_ops,
+                                    int input_size) {
+  std::vector<int32_t> values = {1};
+  for (int i = 0; i < num_ops; ++i) {
+    values.push_back(values[i] + values[std::max(0, i - 3)]);
+  }
+  subgraph_test_util::FillIntTensor(
+      interpreter->tensor(interpreter->inputs()[0]),
+      std::vector<int32_t>(input_size, 1));
+  ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+  subgraph_test_util::CheckIntTensor(
+      interpreter->tensor(interpreter->outputs()[0]), {input_size},
+      std::vector<int32_t>(input_size, values.back()));
+}
+
+TEST(ArenaPlannerSubgraphTest, ArenaPlanCache) {
+  constexpr int kNumOps = 16;
+  InterpreterOptions options;
+  const std::string cache_path = ::testing::TempDir() + "/residual_add_chain";
+  const std::string cache_file = cache_path + ".0";
+  std::remove(cache_file.c_str());
+  options.SetArenaPlanCachePath(cache_path);
+
+  Interpreter interpreter;
+  BuildAndAllocateResidualAddChain(&interpreter, kNumOps, 64, &options);
+  const std::string plan = ReadFile(cache_file);
+  ASSERT_FALSE(plan.empty());
+  InvokeAndCheckResidualAddChain(&interpreter, kNumOps, 64);
+
+  // A second interpreter of the same model gets the same allocations.
+  Interpreter cached_interpreter;
+  BuildAndAllocateResidualAddChain(&cached_interpreter, kNumOps, 64, &options);
+  EXPECT_EQ(RelativeTensorOffsets(cached_interpreter),
+            RelativeTensorOffsets(interpreter));
+  EXPECT_EQ(ReadFile(cache_file), plan);
+  InvokeAndCheckResidualAddChain(&cached_interpreter, kNumOps, 64);
+
+  // Resizing the input invalidates the plan, which is recomputed and saved.
+  ASSERT_EQ(cached_interpreter.ResizeInputTensor(cached_interpreter.inputs()[0],
+                                                 {128}),
+            kTfLiteOk);
+  ASSERT_EQ(cached_interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_NE(ReadFile(cache_file), plan);
+  InvokeAndCheckResidualAddChain(&cached_interpreter, kNumOps, 128);
+}
+
+TEST(ArenaPlannerSubgraphTest, ArenaPlanCacheIgnoresCorruptFiles) {
+  constexpr int kNumOps = 16;
+  InterpreterOptions options;
+  const std::string cache_path = ::testing::TempDir() + "/corrupt_plan";
+  const std::string cache_file = cache_path + ".0";
+  const std::string garbage = "not an allocation plan";
+  std::ofstream(cache_file, std::ios::binary) << garbage;
+  options.SetArenaPlanCachePath(cache_path);
+
+  Interpreter interpreter;
+  BuildAndAllocateResidualAddChain(&interpreter, kNumOps, 64, &options);
+  InvokeAndCheckResidualAddChain(&interpreter, kNumOps, 64);
+  const std::string plan = ReadFile(cache_file);
+  EXPECT_NE(plan, garbage);
+  EXPECT_FALSE(plan.empty());
+}
+
 }  // namespace
 }  // namespace tflite
+
+// Measures the latency of `AllocateTensors()` on a residual ADD chain of
+// `state.range(0)` nodes, computing the allocation plan if `state.range(1)` is
+// 0 and reusing a cached plan otherwise.
+void BM_AllocateTensors(benchmark::State& state) {
+  const int num_ops = state.range(0);
+  const bool cached = state.range(1);
+  tflite::InterpreterOptions options;
+  if (cached) {
+    options.SetArenaPlanCachePath(::testing::TempDir() + "/bm_plan_" +
+                                  std::to_string(num_ops));
+    // Populate the cache.
+    tflite::Interpreter interpreter;
+    tflite::BuildAndAllocateResidualAddChain(&interpreter, num_ops, 64,
+                                             &options);
+  }
+  for (auto _ : state) {
+    state.PauseTiming();
+    tflite::Interpreter interpreter;
+    tflite::subgraph_test_util::SubgraphBuilder builder;
+    builder.BuildResidualAddChainSubgraph(&interpreter.primary_subgraph(),
+                                          num_ops);
+    interpreter.ApplyOptions(&options);
+    interpreter.ResizeInputTensor(interpreter.inputs()[0], {64});
+    state.ResumeTiming();
+    if (interpreter.AllocateTensors() != kTfLiteOk) {
+      state.SkipWithError("AllocateTensors failed");
+      break;
+    }
+  }
+}
+BENCHMARK(BM_AllocateTensors)
+    ->ArgsProduct({{1000, 10000}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
@@ -19,9 +19,11 @@ limitations under the License.
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <initializer_list>
 #include <memory>
 #include <set>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -1114,5 +1116,148 @@ TEST_F(ArenaPlannerTest, SimpleProfilerTest) {
   EXPECT_EQ(gNumDealloc, 1);
 }
 
+// Returns the graph used by the allocation plan tests, with two persistent
+// tensors.
+std::unique_ptr<TestGraph> MakePlanTestGraph() {
+  auto graph = std::unique_ptr<TestGraph>(
+      new TestGraph({0, 1},
+                    {
+                        /* in, out, tmp */
+                        {{0, 1}, {2}, {7}},     // First op
+                        {{2, 0}, {4, 5}, {8}},  // Second op
+                        {{4, 5}, {6}, {}},      // Third op
+                        {{6, 2}, {3}, {9}},     // Fourth op
+                    },
+                    {3}));
+  (*graph->tensors())[5].allocation_type = kTfLiteArenaRwPersistent;
+  (*graph->tensors())[8].allocation_type = kTfLiteArenaRwPersistent;
+  return graph;
+}
+
+TEST_F(ArenaPlannerTest, ExportedPlanIsReused) {
+  std::unique_ptr<TestGraph> graph = MakePlanTestGraph();
+  SetGraph(graph.get());
+  std::string plan;
+  EXPECT_FALSE(planner_->ExportPlan(&plan));
+  Execute(0, graph->nodes().size() - 1);
+  EXPECT_EQ(planner_->last_plan_source(), ArenaPlanner::PlanSource::kComputed);
+  ASSERT_TRUE(planner_->ExportPlan(&plan));
+  std::vector<std::ptrdiff_t> offsets;
+  for (size_t i = 0; i < graph->tensors()->size(); ++i) {
+    offsets.push_back(GetOffset(i));
+  }
+  size_t arena_size, persistent_arena_size;
+  planner_->GetAllocInfo(&arena_size, &persistent_arena_size);
+
+  // A new planner for the same graph reuses the plan.
+  std::unique_ptr<TestGraph> same_graph = MakePlanTestGraph();
+  SetGraph(same_graph.get());
+  ASSERT_TRUE(planner_->ImportPlan(plan.data(), plan.size()));
+  Execute(0, same_graph->nodes().size() - 1);
+  EXPECT_EQ(planner_->last_plan_source(), ArenaPlanner::PlanSource::kReused);
+  for (size_t i = 0; i < same_graph->tensors()->size(); ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i]) << "tensor " << i;
+  }
+  size_t reused_arena_size, reused_persistent_arena_size;
+  planner_->GetAllocInfo(&reused_arena_size, &reused_persistent_arena_size);
+  EXPECT_EQ(reused_arena_size, arena_size);
+  EXPECT_EQ(reused_persistent_arena_size, persistent_arena_size);
+
+  // Incremental allocations don't use the plan.
+  ResetAllocationsAfter(1);
+  Execute(2, same_graph->nodes().size() - 1);
+  EXPECT_EQ(planner_->last_plan_source(),
+            ArenaPlanner::PlanSource::kIncremental);
+
+  // Allocations starting from scratch do.
+  ResetAllocations();
+  Execute(0, same_graph->nodes().size() - 1);
+  EXPECT_EQ(planner_->last_plan_source(), ArenaPlanner::PlanSource::kReused);
+  EXPECT_EQ(GetOffset(6), offsets[6]);
+}
+
+TEST_F(ArenaPlannerTest, ImportedPlanIsIgnoredOnMismatch) {
+  std::unique_ptr<TestGraph> graph = MakePlanTestGraph();
+  SetGraph(graph.get());
+  Execute(0, graph->nodes().size() - 1);
+  std::string plan;
+  ASSERT_TRUE(planner_->ExportPlan(&plan));
+
+  // Tensor 4 grows, so the plan no longer applies.
+  std::unique_ptr<TestGraph> resized_graph = MakePlanTestGraph();
+  (*resized_graph->tensors())[4].bytes = 1000;
+  SetGraph(resized_graph.get());
+  ASSERT_TRUE(planner_->ImportPlan(plan.data(), plan.size()));
+  Execute(0, resized_graph->nodes().size() - 1);
+  EXPECT_EQ(planner_->last_plan_source(), ArenaPlanner::PlanSource::kComputed);
+  std::vector<std::ptrdiff_t> offsets;
+  for (size_t i = 0; i < resized_graph->tensors()->size(); ++i) {
+    offsets.push_back(GetOffset(i));
+  }
+
+  // The computed offsets are the same as without a plan.
+  std::unique_ptr<TestGraph> unplanned_graph = MakePlanTestGraph();
+  (*unplanned_graph->tensors())[4].bytes = 1000;
+  SetGraph(unplanned_graph.get());
+  Execute(0, unplanned_graph->nodes().size() - 1);
+  for (size_t i = 0; i < unplanned_graph->tensors()->size(); ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i]) << "tensor " << i;
+  }
+}
+
+TEST_F(ArenaPlannerTest, MalformedPlansAreRejected) {
+  std::unique_ptr<TestGraph> graph = MakePlanTestGraph();
+  SetGraph(graph.get());
+  Execute(0, graph->nodes().size() - 1);
+  std::string plan;
+  ASSERT_TRUE(planner_->ExportPlan(&plan));
+  ASSERT_TRUE(planner_->ImportPlan(plan.data(), plan.size()));
+
+  EXPECT_FALSE(planner_->ImportPlan(plan.data(), 0));
+  EXPECT_FALSE(planner_->ImportPlan(plan.data(), plan.size() - 1));
+  std::string corrupt_plan = plan;
+  corrupt_plan[plan.size() / 2] ^= 1;
+  EXPECT_FALSE(planner_->ImportPlan(corrupt_plan.data(), corrupt_plan.size()));
+  std::string bad_magic = plan;
+  bad_magic[0] = 'X';
+  EXPECT_FALSE(planner_->ImportPlan(bad_magic.data(), bad_magic.size()));
+
+  // Plans are specific to a tensor alignment.
+  ArenaPlanner other_planner(&context_,
+                             std::make_unique<TestGraphInfo>(graph.get()),
+                             /*preserve_all_tensors=*/false,
+                             2 * kTensorAlignment);
+  EXPECT_FALSE(other_planner.ImportPlan(plan.data(), plan.size()));
+}
+
+TEST_F(ArenaPlannerTest, OverlappingPlansAreRejected) {
+  std::unique_ptr<TestGraph> graph = MakePlanTestGraph();
+  SetGraph(graph.get());
+  Execute(0, graph->nodes().size() - 1);
+  std::string plan;
+  ASSERT_TRUE(planner_->ExportPlan(&plan));
+
+  // Moves every allocation to offset 0 and updates the checksum, so that the
+  // plan is well formed but gives tensors that are live at the same time the
+  // same memory.
+  const size_t num_allocs = (plan.size() - 16 - 8) / 32;
+  for (size_t i = 0; i < num_allocs; ++i) {
+    std::memset(&plan[16 + i * 32 + 24], 0, sizeof(uint64_t));
+  }
+  uint64_t checksum = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < plan.size() - 8; ++i) {
+    checksum ^= static_cast<unsigned char>(plan[i]);
+    checksum *= 0x100000001b3ULL;
+  }
+  std::memcpy(&plan[plan.size() - 8], &checksum, sizeof(checksum));
+
+  // The planner computes new offsets instead.
+  std::unique_ptr<TestGraph> same_graph = MakePlanTestGraph();
+  SetGraph(same_graph.get());
+  EXPECT_FALSE(planner_->ImportPlan(plan.data(), plan.size()));
+  Execute(0, same_graph->nodes().size() - 1);
+  EXPECT_EQ(planner_->last_plan_source(), ArenaPlanner::PlanSource::kComputed);
+}
+
 }  // namespace
 }  // namespace tflite
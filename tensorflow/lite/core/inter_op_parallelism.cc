@@ -0,0 +1,322 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/inter_op_parallelism.h"
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <functional>
+#include <mutex>  // NOLINT(build/c++11)
+#include <numeric>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/builtin_ops.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/graph_info.h"
+
+namespace tflite {
+namespace internal {
+
+InterOpConcurrency GetInterOpConcurrency(
+    const TfLiteNode& node, const TfLiteRegistration& registration) {
+  if (node.delegate != nullptr || node.might_have_side_effect) {
+    return InterOpConcurrency::kExclusive;
+  }
+  switch (registration.builtin_code) {
+    // Kernels whose optimized implementations use the CpuBackendContext.
+    case kTfLiteBuiltinAddN:
+    case kTfLiteBuiltinBatchMatmul:
+    case kTfLiteBuiltinBidirectionalSequenceLstm:
+    case kTfLiteBuiltinConv2d:
+    case kTfLiteBuiltinConv3d:
+    case kTfLiteBuiltinConv3dTranspose:
+    case kTfLiteBuiltinDepthwiseConv2d:
+    case kTfLiteBuiltinFullyConnected:
+    case kTfLiteBuiltinLstm:
+    case kTfLiteBuiltinMean:
+    case kTfLiteBuiltinMirrorPad:
+    case kTfLiteBuiltinReduceMax:
+    case kTfLiteBuiltinReduceMin:
+    case kTfLiteBuiltinReduceProd:
+    case kTfLiteBuiltinSoftmax:
+    case kTfLiteBuiltinSum:
+    case kTfLiteBuiltinTransposeConv:
+    case kTfLiteBuiltinUnidirectionalSequenceLstm:
+      return InterOpConcurrency::kSharedCpuBackend;
+    // Kernels that only use the node's tensors and op data.
+    case kTfLiteBuiltinAbs:
+    case kTfLiteBuiltinAdd:
+    case kTfLiteBuiltinArgMax:
+    case kTfLiteBuiltinArgMin:
+    case kTfLiteBuiltinAveragePool2d:
+    case kTfLiteBuiltinBatchToSpaceNd:
+    case kTfLiteBuiltinBroadcastTo:
+    case kTfLiteBuiltinCast:
+    case kTfLiteBuiltinCeil:
+    case kTfLiteBuiltinConcatenation:
+    case kTfLiteBuiltinCos:
+    case kTfLiteBuiltinDepthToSpace:
+    case kTfLiteBuiltinDequantize:
+    case kTfLiteBuiltinDiv:
+    case kTfLiteBuiltinElu:
+    case kTfLiteBuiltinEmbeddingLookup:
+    case kTfLiteBuiltinEqual:
+    case kTfLiteBuiltinExp:
+    case kTfLiteBuiltinExpandDims:
+    case kTfLiteBuiltinFill:
+    case kTfLiteBuiltinFloor:
+    case kTfLiteBuiltinFloorDiv:
+    case kTfLiteBuiltinFloorMod:
+    case kTfLiteBuiltinGather:
+    case kTfLiteBuiltinGatherNd:
+    case kTfLiteBuiltinGelu:
+    case kTfLiteBuiltinGreater:
+    case kTfLiteBuiltinGreaterEqual:
+    case kTfLiteBuiltinHardSwish:
+    case kTfLiteBuiltinL2Normalization:
+    case kTfLiteBuiltinLeakyRelu:
+    case kTfLiteBuiltinLess:
+    case kTfLiteBuiltinLessEqual:
+    case kTfLiteBuiltinLog:
+    case kTfLiteBuiltinLogicalAnd:
+    case kTfLiteBuiltinLogicalNot:
+    case kTfLiteBuiltinLogicalOr:
+    case kTfLiteBuiltinLogistic:
+    case kTfLiteBuiltinMaxPool2d:
+    case kTfLiteBuiltinMaximum:
+    case kTfLiteBuiltinMinimum:
+    case kTfLiteBuiltinMul:
+    case kTfLiteBuiltinNeg:
+    case kTfLiteBuiltinNotEqual:
+    case kTfLiteBuiltinPack:
+    case kTfLiteBuiltinPad:
+    case kTfLiteBuiltinPadv2:
+    case kTfLiteBuiltinPow:
+    case kTfLiteBuiltinPrelu:
+    case kTfLiteBuiltinQuantize:
+    case kTfLiteBuiltinRelu:
+    case kTfLiteBuiltinRelu0To1:
+    case kTfLiteBuiltinRelu6:
+    case kTfLiteBuiltinReluN1To1:
+    case kTfLiteBuiltinReshape:
+    case kTfLiteBuiltinResizeBilinear:
+    case kTfLiteBuiltinResizeNearestNeighbor:
+    case kTfLiteBuiltinRound:
+    case kTfLiteBuiltinRsqrt:
+    case kTfLiteBuiltinSelect:
+    case kTfLiteBuiltinSelectV2:
+    case kTfLiteBuiltinShape:
+    case kTfLiteBuiltinSin:
+    case kTfLiteBuiltinSlice:
+    case kTfLiteBuiltinSpaceToBatchNd:
+    case kTfLiteBuiltinSpaceToDepth:
+    case kTfLiteBuiltinSplit:
+    case kTfLiteBuiltinSplitV:
+    case kTfLiteBuiltinSqrt:
+    case kTfLiteBuiltinSquare:
+    case kTfLiteBuiltinSquaredDifference:
+    case kTfLiteBuiltinSqueeze:
+    case kTfLiteBuiltinStridedSlice:
+    case kTfLiteBuiltinSub:
+    case kTfLiteBuiltinTanh:
+    case kTfLiteBuiltinTile:
+    case kTfLiteBuiltinTranspose:
+    case kTfLiteBuiltinUnpack:
+    case kTfLiteBuiltinZerosLike:
+      return InterOpConcurrency::kConcurrent;
+    default:
+      return InterOpConcurrency::kExclusive;
+  }
+}
+
+InterOpSchedule BuildInterOpSchedule(
+    const std::vector<int>& execution_plan,
+    const std::vector<std::pair<TfLiteNode, TfLiteRegistration>>&
+        nodes_and_registration,
+    const TfLiteTensor* tensors, size_t num_tensors,
+    const ControlEdges* control_edges) {
+  const int num_nodes = static_cast<int>(execution_plan.size());
+  // Control predecessors of each node, by node index.
+  std::vector<std::vector<int>> control_predecessors;
+  if (control_edges != nullptr) {
+    control_predecessors.resize(nodes_and_registration.size());
+    for (const ControlEdge& edge : *control_edges) {
+      if (edge.second >= 0 &&
+          edge.second < static_cast<int>(control_predecessors.size())) {
+        control_predecessors[edge.second].push_back(edge.first);
+      }
+    }
+  }
+
+  // Stage of each node, and last stage that wrote or read each tensor.
+  std::vector<int> node_stage(nodes_and_registration.size(), -1);
+  std::vector<int> last_write(num_tensors, -1);
+  std::vector<int> last_read(num_tensors, -1);
+  std::vector<int> stage(num_nodes);
+  std::vector<InterOpConcurrency> concurrency(num_nodes);
+  // No node may be scheduled before `first_stage`, the stage following the
+  // last exclusive node.
+  int first_stage = 0;
+  int last_stage = -1;
+  for (int i = 0; i < num_nodes; ++i) {
+    const int node_index = execution_plan[i];
+    const auto& [node, registration] = nodes_and_registration[node_index];
+    concurrency[i] = GetInterOpConcurrency(node, registration);
+
+    int s = first_stage;
+    for (int j = 0; j < node.inputs->size; ++j) {
+      const int tensor = node.inputs->data[j];
+      if (tensor == kTfLiteOptionalTensor) continue;
+      s = std::max(s, last_write[tensor] + 1);
+      if (tensors[tensor].is_variable) {
+        s = std::max(s, last_read[tensor] + 1);
+      }
+    }
+    for (int j = 0; j < node.outputs->size; ++j) {
+      const int tensor = node.outputs->data[j];
+      if (tensor == kTfLiteOptionalTensor) continue;
+      s = std::max({s, last_write[tensor] + 1, last_read[tensor] + 1});
+    }
+    if (!control_predecessors.empty()) {
+      for (const int predecessor : control_predecessors[node_index]) {
+        if (predecessor >= 0 &&
+            predecessor < static_cast<int>(node_stage.size())) {
+          s = std::max(s, node_stage[predecessor] + 1);
+        }
+      }
+    }
+    if (concurrency[i] == InterOpConcurrency::kExclusive) {
+      s = std::max(s, last_stage + 1);
+      first_stage = s + 1;
+    }
+
+    stage[i] = s;
+    node_stage[node_index] = s;
+    last_stage = std::max(last_stage, s);
+    for (int j = 0; j < node.inputs->size; ++j) {
+      const int tensor = node.inputs->data[j];
+      if (tensor == kTfLiteOptionalTensor) continue;
+      last_read[tensor] = std::max(last_read[tensor], s);
+      if (tensors[tensor].is_variable) {
+        last_write[tensor] = s;
+      }
+    }
+    for (int j = 0; j < node.outputs->size; ++j) {
+      const int tensor = node.outputs->data[j];
+      if (tensor == kTfLiteOptionalTensor) continue;
+      last_write[tensor] = s;
+    }
+  }
+
+  // Sort the nodes by stage, keeping the execution plan order within a stage.
+  std::vector<int> order(num_nodes);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](int a, int b) { return stage[a] < stage[b]; });
+
+  InterOpSchedule schedule;
+  schedule.execution_plan.reserve(num_nodes);
+  schedule.stage.reserve(num_nodes);
+  schedule.concurrency.reserve(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    const int original_index = order[i];
+    // Stage numbers may have gaps after exclusive nodes; renumber them.
+    if (i == 0 || stage[original_index] != stage[order[i - 1]]) {
+      schedule.stage_begin.push_back(i);
+    }
+    schedule.execution_plan.push_back(execution_plan[original_index]);
+    schedule.stage.push_back(schedule.stage_begin.size() - 1);
+    schedule.concurrency.push_back(concurrency[original_index]);
+  }
+  schedule.stage_begin.push_back(num_nodes);
+  for (int s = 0; s < schedule.num_stages(); ++s) {
+    schedule.max_stage_size =
+        std::max(schedule.max_stage_size,
+                 schedule.stage_begin[s + 1] - schedule.stage_begin[s]);
+  }
+  return schedule;
+}
+
+InterOpThreadPool::InterOpThreadPool(int num_threads) {
+  for (int i = 1; i < num_threads; ++i) {
+    workers_.emplace_back([this]() { WorkerLoop(); });
+  }
+}
+
+InterOpThreadPool::~InterOpThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_available_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void InterOpThreadPool::ParallelFor(int num_tasks,
+                                    const std::function<void(int)>& task) {
+  if (workers_.empty() || num_tasks <= 1) {
+    for (int i = 0; i < num_tasks; ++i) {
+      task(i);
+    }
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    num_tasks_ = num_tasks;
+    next_task_.store(0, std::memory_order_relaxed);
+    busy_workers_ = static_cast<int>(workers_.size());
+    ++generation_;
+  }
+  work_available_.notify_all();
+  RunTasks();
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this]() { return busy_workers_ == 0; });
+  task_ = nullptr;
+}
+
+void InterOpThreadPool::WorkerLoop() {
+  int64_t generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(
+          lock, [&]() { return stop_ || generation_ != generation; });
+      if (stop_) return;
+      generation = generation_;
+    }
+    RunTasks();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--busy_workers_ == 0) {
+        work_done_.notify_one();
+      }
+    }
+  }
+}
+
+void InterOpThreadPool::RunTasks() {
+  for (int i = next_task_.fetch_add(1, std::memory_order_relaxed);
+       i < num_tasks_; i = next_task_.fetch_add(1, std::memory_order_relaxed)) {
+    (*task_)(i);
+  }
+}
+
+}  // namespace internal
+}  // namespace tflite
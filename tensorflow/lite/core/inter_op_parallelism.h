@@ -0,0 +1,128 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_INTER_OP_PARALLELISM_H_
+#define TENSORFLOW_LITE_CORE_INTER_OP_PARALLELISM_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <functional>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/graph_info.h"
+
+namespace tflite {
+namespace internal {
+
+// How a node may run with respect to the other nodes of its stage.
+enum class InterOpConcurrency {
+  // The kernel only touches the node's tensors and op data, and may run
+  // concurrently with any other node.
+  kConcurrent,
+  // The kernel uses the CpuBackendContext of the subgraph (ruy, Eigen or the
+  // cpu_backend_threadpool), which can't be entered from several threads at
+  // once. It may run concurrently with kConcurrent nodes, but not with other
+  // kSharedCpuBackend nodes.
+  kSharedCpuBackend,
+  // The kernel may have effects outside of its tensors (delegate kernels,
+  // custom ops, control flow, resources...), or isn't known to be thread-safe.
+  // It runs alone, in execution plan order with respect to the other
+  // exclusive nodes.
+  kExclusive,
+};
+
+// Returns how `node`, registered with `registration`, may run.
+InterOpConcurrency GetInterOpConcurrency(
+    const TfLiteNode& node, const TfLiteRegistration& registration);
+
+// An execution plan split into stages of nodes that don't depend on each
+// other. The stages run one after the other, and the nodes of a stage may run
+// concurrently.
+struct InterOpSchedule {
+  // The execution plan, reordered so that the nodes of each stage are
+  // contiguous. This is still a valid topological order, so running the nodes
+  // one at a time in this order is correct as well.
+  std::vector<int> execution_plan;
+  // Stage `s` holds the execution plan indices [stage_begin[s],
+  // stage_begin[s + 1]). The last element is execution_plan.size().
+  std::vector<int> stage_begin;
+  // Stage of each execution plan index.
+  std::vector<int> stage;
+  // Concurrency of each execution plan index.
+  std::vector<InterOpConcurrency> concurrency;
+  // Number of nodes of the largest stage.
+  int max_stage_size = 0;
+
+  int num_stages() const { return static_cast<int>(stage_begin.size()) - 1; }
+};
+
+// Groups the nodes of `execution_plan` into stages. Each node is scheduled in
+// the earliest stage after the stages of the nodes that write its inputs, read
+// or write its outputs, or precede it by a control edge. Variable tensors used
+// as inputs are treated as written, since kernels update them in place.
+// Exclusive nodes (see InterOpConcurrency) get a stage of their own, and act as
+// a barrier: no node is moved across one.
+InterOpSchedule BuildInterOpSchedule(
+    const std::vector<int>& execution_plan,
+    const std::vector<std::pair<TfLiteNode, TfLiteRegistration>>&
+        nodes_and_registration,
+    const TfLiteTensor* tensors, size_t num_tensors,
+    const ControlEdges* control_edges);
+
+// A fixed set of threads running batches of tasks for the inter-op parallel
+// execution of a subgraph. The thread calling ParallelFor() runs tasks too, so
+// a pool of `num_threads` threads starts `num_threads - 1` workers.
+class InterOpThreadPool {
+ public:
+  explicit InterOpThreadPool(int num_threads);
+  ~InterOpThreadPool();
+  InterOpThreadPool(const InterOpThreadPool&) = delete;
+  InterOpThreadPool& operator=(const InterOpThreadPool&) = delete;
+
+  // Calls `task(i)` for each i in [0, num_tasks), and returns once all calls
+  // have returned. Must not be called concurrently or from a task.
+  void ParallelFor(int num_tasks, const std::function<void(int)>& task);
+
+  int num_threads() const { return static_cast<int>(workers_.size()) + 1; }
+
+ private:
+  void WorkerLoop();
+  void RunTasks();
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  // Incremented for each ParallelFor() call, guarded by `mutex_`.
+  int64_t generation_ = 0;
+  // Workers that haven't finished the current batch, guarded by `mutex_`.
+  int busy_workers_ = 0;
+  bool stop_ = false;
+  // The current batch. Set under `mutex_` before `generation_` is incremented.
+  const std::function<void(int)>* task_ = nullptr;
+  int num_tasks_ = 0;
+  std::atomic<int> next_task_{0};
+};
+
+}  // namespace internal
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_INTER_OP_PARALLELISM_H_
@@ -0,0 +1,260 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/inter_op_parallelism.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
+#include "tensorflow/lite/builtin_ops.h"
+#include "tensorflow/lite/c/c_api_types.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/graph_info.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_options.h"
+#include "tensorflow/lite/kernels/subgraph_test_util.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Builds the nodes of a graph by hand to schedule them.
+class InterOpScheduleTest : public ::testing::Test {
+ protected:
+  ~InterOpScheduleTest() override {
+    for (auto& [node, registration] : nodes_) {
+      TfLiteIntArrayFree(node.inputs);
+      TfLiteIntArrayFree(node.outputs);
+    }
+  }
+
+  void AddNode(const std::vector<int>& inputs, const std::vector<int>& outputs,
+               int builtin_code = kTfLiteBuiltinAdd) {
+    TfLiteNode node{};
+    node.inputs = ConvertVectorToTfLiteIntArray(inputs);
+    node.outputs = ConvertVectorToTfLiteIntArray(outputs);
+    TfLiteRegistration registration{};
+    registration.builtin_code = builtin_code;
+    execution_plan_.push_back(nodes_.size());
+    nodes_.emplace_back(node, registration);
+  }
+
+  InterOpSchedule Build(int num_tensors) {
+    tensors_.resize(num_tensors, TfLiteTensor{});
+    return BuildInterOpSchedule(execution_plan_, nodes_, tensors_.data(),
+                                tensors_.size(), &control_edges_);
+  }
+
+  std::vector<std::pair<TfLiteNode, TfLiteRegistration>> nodes_;
+  std::vector<int> execution_plan_;
+  std::vector<TfLiteTensor> tensors_;
+  ControlEdges control_edges_;
+};
+
+TEST_F(InterOpScheduleTest, IndependentChainsShareStages) {
+  AddNode({0}, {1});
+  AddNode({1}, {2});
+  AddNode({0}, {3});
+  AddNode({3}, {4});
+  AddNode({2, 4}, {5});
+  const InterOpSchedule schedule = Build(6);
+  EXPECT_THAT(schedule.execution_plan, ElementsAre(0, 2, 1, 3, 4));
+  EXPECT_THAT(schedule.stage_begin, ElementsAre(0, 2, 4, 5));
+  EXPECT_THAT(schedule.stage, ElementsAre(0, 0, 1, 1, 2));
+  EXPECT_EQ(schedule.num_stages(), 3);
+  EXPECT_EQ(schedule.max_stage_size, 2);
+}
+
+TEST_F(InterOpScheduleTest, ExclusiveNodesAreBarriers) {
+  AddNode({0}, {1});
+  AddNode({0}, {2}, kTfLiteBuiltinCustom);
+  AddNode({0}, {3});
+  AddNode({1}, {4});
+  const InterOpSchedule schedule = Build(5);
+  // The last node only depends on the first one, but can't move before the
+  // custom op.
+  EXPECT_THAT(schedule.execution_plan, ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(schedule.stage_begin, ElementsAre(0, 1, 2, 4));
+  EXPECT_EQ(schedule.concurrency[1], InterOpConcurrency::kExclusive);
+}
+
+TEST_F(InterOpScheduleTest, VariableInputsAreWritten) {
+  AddNode({0, 1}, {2});
+  AddNode({1}, {3});
+  tensors_.resize(4, TfLiteTensor{});
+  tensors_[1].is_variable = true;
+  const InterOpSchedule schedule = Build(4);
+  EXPECT_THAT(schedule.stage_begin, ElementsAre(0, 1, 2));
+}
+
+TEST_F(InterOpScheduleTest, ControlEdgesOrderNodes) {
+  AddNode({0}, {1});
+  AddNode({0}, {2});
+  AddNode({0}, {3});
+  control_edges_.push_back({0, 2});
+  const InterOpSchedule schedule = Build(4);
+  EXPECT_THAT(schedule.execution_plan, ElementsAre(0, 1, 2));
+  EXPECT_THAT(schedule.stage_begin, ElementsAre(0, 2, 3));
+}
+
+TEST(InterOpConcurrencyTest, Classification) {
+  TfLiteNode node{};
+  TfLiteRegistration registration{};
+  registration.builtin_code = kTfLiteBuiltinMul;
+  EXPECT_EQ(GetInterOpConcurrency(node, registration),
+            InterOpConcurrency::kConcurrent);
+  registration.builtin_code = kTfLiteBuiltinFullyConnected;
+  EXPECT_EQ(GetInterOpConcurrency(node, registration),
+            InterOpConcurrency::kSharedCpuBackend);
+  registration.builtin_code = kTfLiteBuiltinWhile;
+  EXPECT_EQ(GetInterOpConcurrency(node, registration),
+            InterOpConcurrency::kExclusive);
+  registration.builtin_code = kTfLiteBuiltinMul;
+  node.might_have_side_effect = true;
+  EXPECT_EQ(GetInterOpConcurrency(node, registration),
+            InterOpConcurrency::kExclusive);
+}
+
+TEST(InterOpThreadPoolTest, RunsEachTaskOnce) {
+  InterOpThreadPool pool(4);
+  EXPECT_EQ(pool.num_threads(), 4);
+  for (int num_tasks : {0, 1, 3, 4, 100}) {
+    std::vector<std::atomic<int>> counts(num_tasks);
+    for (int round = 0; round < 10; ++round) {
+      pool.ParallelFor(num_tasks, [&](int i) { ++counts[i]; });
+    }
+    for (int i = 0; i < num_tasks; ++i) {
+      EXPECT_EQ(counts[i].load(), 10);
+    }
+  }
+}
+
+// Builds and allocates a multi-branch ADD subgraph with an input of
+// `input_size` elements.
+void BuildMultiBranchInterpreter(Interpreter* interpreter, int num_branches,
+                                 int depth, int input_size,
+                                 int inter_op_parallelism) {
+  subgraph_test_util::SubgraphBuilder builder;
+  builder.BuildMultiBranchAddSubgraph(&interpreter->primary_subgraph(),
+                                      num_branches, depth);
+  InterpreterOptions options;
+  options.SetInterOpParallelism(inter_op_parallelism);
+  ASSERT_EQ(interpreter->ApplyOptions(&options), kTfLiteOk);
+  ASSERT_EQ(interpreter->ResizeInputTensor(interpreter->inputs()[0],
+                                           {input_size}),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+}
+
+TEST(InterOpParallelismTest, InvokesBranchesConcurrently) {
+  constexpr int kNumBranches = 4;
+  constexpr int kDepth = 8;
+  constexpr int kInputSize = 1024;
+  Interpreter interpreter;
+  BuildMultiBranchInterpreter(&interpreter, kNumBranches, kDepth, kInputSize,
+                              /*inter_op_parallelism=*/4);
+  const Subgraph& subgraph = interpreter.primary_subgraph();
+  // The first node of each branch runs in the first stage.
+  EXPECT_EQ(subgraph.ConcurrentNodeRange(0),
+            std::make_pair<size_t, size_t>(0, kNumBranches - 1));
+
+  // The outputs of the nodes of a stage don't share memory.
+  for (size_t i = 0; i < subgraph.execution_plan().size();) {
+    const auto [first, last] = subgraph.ConcurrentNodeRange(i);
+    std::vector<std::pair<const char*, const char*>> buffers;
+    for (size_t j = first; j <= last; ++j) {
+      const TfLiteNode& node =
+          subgraph.nodes_and_registration()[subgraph.execution_plan()[j]]
+              .first;
+      const TfLiteTensor* output = interpreter.tensor(node.outputs->data[0]);
+      for (const auto& [begin, end] : buffers) {
+        EXPECT_TRUE(output->data.raw + output->bytes <= begin ||
+                    end <= output->data.raw);
+      }
+      buffers.emplace_back(output->data.raw,
+                           output->data.raw + output->bytes);
+    }
+    i = last + 1;
+  }
+
+  std::vector<int32_t> input(kInputSize);
+  std::vector<int32_t> expected(kInputSize);
+  for (int i = 0; i < kInputSize; ++i) {
+    input[i] = i - kInputSize / 2;
+    expected[i] = kNumBranches * (kDepth + 1) * input[i];
+  }
+  for (int run = 0; run < 3; ++run) {
+    subgraph_test_util::FillIntTensor(
+        interpreter.tensor(interpreter.inputs()[0]), input);
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    subgraph_test_util::CheckIntTensor(
+        interpreter.tensor(interpreter.outputs()[0]), {kInputSize}, expected);
+  }
+}
+
+TEST(InterOpParallelismTest, SequentialWithOneThread) {
+  Interpreter interpreter;
+  BuildMultiBranchInterpreter(&interpreter, /*num_branches=*/4, /*depth=*/2,
+                              /*input_size=*/8, /*inter_op_parallelism=*/1);
+  EXPECT_EQ(interpreter.primary_subgraph().ConcurrentNodeRange(0),
+            std::make_pair<size_t, size_t>(0, 0));
+  // Nodes are still run in the original order.
+  const std::vector<int>& plan = interpreter.execution_plan();
+  for (size_t i = 0; i < plan.size(); ++i) {
+    EXPECT_EQ(plan[i], i);
+  }
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace tflite
+
+// Measures the latency of Invoke() on `state.range(0)` branches of 16 ADD
+// nodes over 64k elements, with `state.range(1)` inter-op threads.
+void BM_MultiBranchInvoke(benchmark::State& state) {
+  const int num_branches = state.range(0);
+  const int num_threads = state.range(1);
+  constexpr int kInputSize = 1 << 16;
+  tflite::Interpreter interpreter;
+  tflite::internal::BuildMultiBranchInterpreter(
+      &interpreter, num_branches, /*depth=*/16, kInputSize, num_threads);
+  tflite::subgraph_test_util::FillIntTensor(
+      interpreter.tensor(interpreter.inputs()[0]),
+      std::vector<int32_t>(kInputSize, 1));
+  for (auto _ : state) {
+    if (interpreter.Invoke() != kTfLiteOk) {
+      state.SkipWithError("Invoke failed");
+      break;
+    }
+  }
+  // Running branches concurrently keeps more of their tensors alive at once.
+  tflite::Subgraph::SubgraphAllocInfo alloc_info;
+  interpreter.primary_subgraph().GetMemoryAllocInfo(&alloc_info);
+  state.counters["arena_bytes"] = alloc_info.arena_size;
+}
+BENCHMARK(BM_MultiBranchInvoke)
+    ->ArgNames({"branches", "threads"})
+    ->ArgsProduct({{1, 4, 8}, {1, 2, 4, 8}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
@@ -20,11 +20,14 @@ limitations under the License.
 #include <cstdarg>
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <iterator>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <numeric>
+#include <random>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -44,6 +47,7 @@ limitations under the License.
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/inter_op_parallelism.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
 #include "tensorflow/lite/graph_info.h"
@@ -201,6 +205,74 @@ TfLiteStatus VerifyCustomAllocationForTensor(
   return kTfLiteOk;
 }
 
+#ifndef TFLITE_USE_SIMPLE_MEMORY_PLANNER
+// Returns the file caching the arena allocation plan of subgraph
+// `subgraph_index`, or an empty string if plans aren't cached.
+std::string ArenaPlanCacheFile(const InterpreterOptions* options,
+                               int subgraph_index) {
+  if (options == nullptr || options->GetArenaPlanCachePath().empty()) {
+    return "";
+  }
+  return options->GetArenaPlanCachePath() + "." +
+         std::to_string(subgraph_index);
+}
+
+// Imports the plan cached in `filename` into `planner`. Missing or invalid
+// files are ignored: the planner then computes a new plan.
+void LoadArenaPlan(const std::string& filename, ArenaPlanner* planner) {
+  FILE* file = std::fopen(filename.c_str(), "rb");
+  if (file == nullptr) return;
+  std::string plan;
+  char buffer[4096];
+  size_t bytes_read;
+  while ((bytes_read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    plan.append(buffer, bytes_read);
+  }
+  const bool read_error = std::ferror(file);
+  std::fclose(file);
+  if (read_error || !planner->ImportPlan(plan.data(), plan.size())) {
+    TFLITE_LOG(TFLITE_LOG_WARNING, "Ignoring invalid arena plan cache %s.",
+               filename.c_str());
+  }
+}
+
+// Returns a name for a temporary file next to `filename` that no other
+// writer, in this process or another one, uses at the same time.
+std::string UniqueTemporaryFilename(const std::string& filename) {
+  static std::atomic<uint64_t> counter{0};
+  std::random_device random;
+  const uint64_t suffix =
+      (static_cast<uint64_t>(random()) << 32 | random()) ^ counter++;
+  char hex[17];
+  std::snprintf(hex, sizeof(hex), "%016llx",
+                static_cast<unsigned long long>(suffix));  // NOLINT
+  return filename + ".tmp." + hex;
+}
+
+// Saves the plan of `planner` to `filename`. The plan is written to a file of
+// its own and renamed over `filename`, so that concurrent readers never
+// observe a partially written plan and concurrent writers never interleave.
+void SaveArenaPlan(const std::string& filename, const ArenaPlanner& planner) {
+  std::string plan;
+  if (!planner.ExportPlan(&plan)) return;
+  const std::string tmp_filename = UniqueTemporaryFilename(filename);
+  FILE* file = std::fopen(tmp_filename.c_str(), "wb");
+  if (file == nullptr) {
+    TFLITE_LOG(TFLITE_LOG_WARNING, "Failed to write arena plan cache %s.",
+               filename.c_str());
+    return;
+  }
+  const bool written =
+      std::fwrite(plan.data(), 1, plan.size(), file) == plan.size();
+  if (std::fclose(file) != 0 || !written ||
+      std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+    std::remove(tmp_filename.c_str());
+    TFLITE_LOG(TFLITE_LOG_WARNING, "Failed to write arena plan cache %s.",
+               filename.c_str());
+  }
+}
+#endif  // TFLITE_USE_SIMPLE_MEMORY_PLANNER
+
 }  // namespace
 
 // A trivial implementation of GraphInfo around the Interpreter.
@@ -240,6 +312,11 @@ class InterpreterInfo : public GraphInfo {
     return subgraph_->execution_plan()[index];
   }
 
+  std::pair<size_t, size_t> concurrent_node_range(
+      size_t index) const override {
+    return subgraph_->ConcurrentNodeRange(index);
+  }
+
   const std::vector<int>& inputs() const override {
     return subgraph_->inputs();
   }
@@ -1033,6 +1110,8 @@ TfLiteStatus Subgraph::AllocateTensors(InliningStrategy auto_inline) {
   // Profile "AllocateTensors" only when memory planning is needed.
   TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(), "AllocateTensors");
 
+  TF_LITE_ENSURE_STATUS(ScheduleInterOpStages());
+
   next_execution_plan_index_to_prepare_ = 0;
   next_execution_plan_index_to_plan_allocation_ = 0;
   next_original_execution_plan_index_to_prepare_ = 0;
@@ -1598,13 +1677,28 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
                            execution_plan_, &last_exec_plan_index_prepared));
   next_execution_plan_index_to_prepare_ = last_exec_plan_index_prepared + 1;
 
+  if (inter_op_schedule_active_ && has_dynamic_tensors_) {
+    // Dynamic tensors are sized and allocated during Invoke() one node at a
+    // time, so the nodes run sequentially, in the order of the stages.
+    inter_op_schedule_active_ = false;
+    if (memory_planner_) {
+      TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+    }
+  }
+
   if (!memory_planner_) {
 #ifdef TFLITE_USE_SIMPLE_MEMORY_PLANNER
     memory_planner_.reset(new SimplePlanner(&context_, CreateGraphInfo()));
 #else
-    memory_planner_ = std::make_unique<ArenaPlanner>(
+    auto arena_planner = std::make_unique<ArenaPlanner>(
         &context_, CreateGraphInfo(), ShouldPreserveAllTensors(),
         kDefaultTensorAlignment, subgraph_index_, allocator_);
+    const std::string plan_file =
+        ArenaPlanCacheFile(options_, subgraph_index_);
+    if (!plan_file.empty()) {
+      LoadArenaPlan(plan_file, arena_planner.get());
+    }
+    memory_planner_ = std::move(arena_planner);
 #endif
     memory_planner_->PlanAllocations();
   }
@@ -1613,6 +1707,20 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
   TF_LITE_ENSURE_STATUS(memory_planner_->ExecuteAllocations(
       next_execution_plan_index_to_plan_allocation_,
       last_exec_plan_index_prepared));
+#ifndef TFLITE_USE_SIMPLE_MEMORY_PLANNER
+  {
+    // Cache newly computed plans so that the next interpreter of this model
+    // can skip computing them.
+    const auto& arena_planner =
+        static_cast<const ArenaPlanner&>(*memory_planner_);
+    const std::string plan_file =
+        ArenaPlanCacheFile(options_, subgraph_index_);
+    if (!plan_file.empty() && arena_planner.last_plan_source() ==
+                                  ArenaPlanner::PlanSource::kComputed) {
+      SaveArenaPlan(plan_file, arena_planner);
+    }
+  }
+#endif
 
   if (!custom_allocations_.empty()) {
     // Verify custom allocations for output tensors from the ops that have just
@@ -1658,6 +1766,43 @@ TfLiteStatus Subgraph::RemoveUnusedInputs() {
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::EnsureOpInputsAreReadable(
+    const TfLiteNode& node, const TfLiteRegistration& registration) {
+  for (int i = 0; i < node.inputs->size; ++i) {
+    int tensor_index = node.inputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) {
+      continue;
+    }
+    TfLiteTensor* tensor = &tensors_[tensor_index];
+    if (tensor->delegate && tensor->delegate != node.delegate &&
+        tensor->data_is_stale) {
+      TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+    }
+    if (tensor->data.raw == nullptr && tensor->bytes > 0 &&
+        tensor->allocation_type != kTfLiteNonCpu) {
+      if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
+          tensor->dims->size != 1) {
+        // In general, having a tensor here with no buffer will be an error.
+        // However, for the reshape operator, the second input tensor is
+        // sometimes only used for the shape, not for the data. Thus, null
+        // buffer is ok in this situation.
+        // The situation where null buffer is not ok for reshape operator is
+        // only when there are 2 inputs given to the node and the one
+        // corresponding to the shape (i == 1) is a vector that contains all
+        // dimensions. See `GetOutputShape()` function in
+        // `tensorflow/lite/kernels/reshape.cc`
+        continue;
+      } else {
+        // In all other cases, we need to return an error as otherwise we will
+        // trigger a null pointer dereference (likely).
+        ReportError("Input tensor %d lacks data", tensor_index);
+        return kTfLiteError;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::Invoke() {
   auto status = InvokeImpl();
   telemetry::TelemetryReportEvent(&context_, "Invoke", status);
@@ -1684,6 +1829,14 @@ TfLiteStatus Subgraph::InvokeImpl() {
       tflite::OnTfLiteSubgraphInvoke(name_.c_str(), subgraph_index_);
 #endif  // TF_LITE_TENSORFLOW_PROFILER
 
+  if (CanInvokeInterOpStages()) {
+    status = InvokeInterOpStages();
+#ifdef TF_LITE_TENSORFLOW_PROFILER
+    tflite::OnTfLiteSubgraphInvokeEnd(trace_subgraph);
+#endif  // TF_LITE_TENSORFLOW_PROFILER
+    return status;
+  }
+
   // Invocations are always done in node order.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
@@ -1722,38 +1875,7 @@ TfLiteStatus Subgraph::InvokeImpl() {
     TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(
         profile_op ? profiler_.get() : nullptr, op_name, node_index);
 
-    for (int i = 0; i < node.inputs->size; ++i) {
-      int tensor_index = node.inputs->data[i];
-      if (tensor_index == kTfLiteOptionalTensor) {
-        continue;
-      }
-      TfLiteTensor* tensor = &tensors_[tensor_index];
-      if (tensor->delegate && tensor->delegate != node.delegate &&
-          tensor->data_is_stale) {
-        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
-      }
-      if (tensor->data.raw == nullptr && tensor->bytes > 0 &&
-          tensor->allocation_type != kTfLiteNonCpu) {
-        if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
-            tensor->dims->size != 1) {
-          // In general, having a tensor here with no buffer will be an error.
-          // However, for the reshape operator, the second input tensor is
-          // sometimes only used for the shape, not for the data. Thus, null
-          // buffer is ok in this situation.
-          // The situation where null buffer is not ok for reshape operator is
-          // only when there are 2 inputs given to the node and the one
-          // corresponding to the shape (i == 1) is a vector that contains all
-          // dimensions. See `GetOutputShape()` function in
-          // `tensorflow/lite/kernels/reshape.cc`
-          continue;
-        } else {
-          // In all other cases, we need to return an error as otherwise we will
-          // trigger a null pointer dereference (likely).
-          ReportError("Input tensor %d lacks data", tensor_index);
-          return kTfLiteError;
-        }
-      }
-    }
+    TF_LITE_ENSURE_STATUS(EnsureOpInputsAreReadable(node, registration));
     // Allocate dynamic tensors which memory is required to be allocated
     // before executing the node.
     MayAllocateOpOutput(&node);
@@ -1810,6 +1932,122 @@ TfLiteStatus Subgraph::InvokeImpl() {
   return status;
 }
 
+bool Subgraph::CanInvokeInterOpStages() const {
+  // Profilers aren't required to be thread-safe, and dynamic tensors are
+  // allocated one node at a time.
+  return inter_op_schedule_active_ && inter_op_thread_pool_ != nullptr &&
+         profiler_ == nullptr && !has_dynamic_tensors_ &&
+         next_execution_plan_index_to_prepare_ ==
+             static_cast<int>(execution_plan_.size()) &&
+         inter_op_schedule_.execution_plan == execution_plan_;
+}
+
+TfLiteStatus Subgraph::InvokeInterOpStages() {
+  const internal::InterOpSchedule& schedule = inter_op_schedule_;
+  std::vector<TfLiteStatus> statuses;
+  for (int stage = 0; stage < schedule.num_stages(); ++stage) {
+    const int first = schedule.stage_begin[stage];
+    const int num_nodes = schedule.stage_begin[stage + 1] - first;
+    for (int i = first; i < first + num_nodes; ++i) {
+      const auto& [node, registration] =
+          nodes_and_registration_[execution_plan_[i]];
+      TF_LITE_ENSURE_STATUS(EnsureOpInputsAreReadable(node, registration));
+    }
+
+    if (check_cancelled_func_ != nullptr &&
+        check_cancelled_func_(cancellation_data_)) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteError;
+    }
+
+    if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+      // `Cancel` is called and cancellation flag is flipped.
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteCancelled;
+    }
+
+    EnsureTensorsVectorCapacity();
+    statuses.assign(num_nodes, kTfLiteOk);
+    // Exclusive nodes are alone in their stage, so they run on the calling
+    // thread.
+    inter_op_thread_pool_->ParallelFor(num_nodes, [&](int task) {
+      tflite::internal::ScopedTfLiteAllocator scoped_allocator(allocator_);
+      const int execution_plan_index = first + task;
+      auto& [node, registration] =
+          nodes_and_registration_[execution_plan_[execution_plan_index]];
+      if (schedule.concurrency[execution_plan_index] ==
+          internal::InterOpConcurrency::kSharedCpuBackend) {
+        std::lock_guard<std::mutex> lock(*cpu_backend_mutex_);
+        statuses[task] = OpInvoke(registration, &node);
+      } else {
+        statuses[task] = OpInvoke(registration, &node);
+      }
+    });
+
+    for (int task = 0; task < num_nodes; ++task) {
+      if (statuses[task] != kTfLiteOk) {
+        const int node_index = execution_plan_[first + task];
+        const auto& [node, registration] = nodes_and_registration_[node_index];
+        auto err = ReportOpError(&context_, node, registration, node_index,
+                                 "failed to invoke");
+        return statuses[task] == kTfLiteCancelled ? statuses[task] : err;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::ScheduleInterOpStages() {
+  internal::InterOpSchedule schedule;
+  const int num_threads = options_ ? options_->GetInterOpParallelism() : 1;
+  if (num_threads > 1) {
+    schedule = internal::BuildInterOpSchedule(
+        execution_plan_, nodes_and_registration_, tensors_.data(),
+        tensors_.size(), control_edges_);
+  }
+  // Only worth it if at least two nodes may run at the same time.
+  const bool active = schedule.max_stage_size > 1;
+  if (!active) {
+    schedule = internal::InterOpSchedule();
+  }
+  const bool changed = active != inter_op_schedule_active_ ||
+                       schedule.execution_plan !=
+                           inter_op_schedule_.execution_plan ||
+                       schedule.stage_begin != inter_op_schedule_.stage_begin;
+  inter_op_schedule_ = std::move(schedule);
+  inter_op_schedule_active_ = active;
+  if (active) {
+    execution_plan_ = inter_op_schedule_.execution_plan;
+    const int pool_size =
+        std::min(num_threads, inter_op_schedule_.max_stage_size);
+    if (inter_op_thread_pool_ == nullptr ||
+        inter_op_thread_pool_->num_threads() != pool_size) {
+      inter_op_thread_pool_ =
+          std::make_unique<internal::InterOpThreadPool>(pool_size);
+      cpu_backend_mutex_ = std::make_unique<std::mutex>();
+    }
+  } else {
+    inter_op_thread_pool_.reset();
+    cpu_backend_mutex_.reset();
+  }
+  // The lifetimes of the tensors depend on which nodes may run concurrently.
+  if (changed && memory_planner_) {
+    TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+  }
+  return kTfLiteOk;
+}
+
+std::pair<size_t, size_t> Subgraph::ConcurrentNodeRange(
+    size_t execution_plan_index) const {
+  if (!inter_op_schedule_active_ ||
+      execution_plan_index >= inter_op_schedule_.stage.size()) {
+    return {execution_plan_index, execution_plan_index};
+  }
+  const int stage = inter_op_schedule_.stage[execution_plan_index];
+  return {inter_op_schedule_.stage_begin[stage],
+          inter_op_schedule_.stage_begin[stage + 1] - 1};
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
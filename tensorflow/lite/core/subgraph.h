@@ -23,6 +23,7 @@ limitations under the License.
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -37,6 +38,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/op_resolver.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/inter_op_parallelism.h"
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
@@ -555,6 +557,14 @@ class Subgraph {
     return (options_ && options_->GetForceDelegateNodeProfiling());
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // Returns the first and last execution plan indices of the nodes that may
+  // run concurrently with the node at `execution_plan_index`, as scheduled by
+  // `InterpreterOptions::SetInterOpParallelism()`. Without inter-op
+  // parallelism, this is just `execution_plan_index`.
+  std::pair<size_t, size_t> ConcurrentNodeRange(
+      size_t execution_plan_index) const;
+
   // Retrieves the corresponding TfLiteContext of a subgraph given a subgraph
   // index and switches to the delegate context for this subgraph. If an invalid
   // subgraph index is given, returns kTfLiteError.
@@ -812,6 +822,23 @@ class Subgraph {
   // Does not report invoke status through profiler.
   TfLiteStatus InvokeImpl();
 
+  // Makes sure the tensors of the inputs of `node` can be read by its kernel,
+  // copying them from their delegate if needed.
+  TfLiteStatus EnsureOpInputsAreReadable(
+      const TfLiteNode& node, const TfLiteRegistration& registration);
+
+  // Groups the execution plan into stages of independent nodes if inter-op
+  // parallelism is enabled, reordering `execution_plan_` accordingly, and
+  // re-plans the tensor lifetimes if the stages changed.
+  TfLiteStatus ScheduleInterOpStages();
+
+  // True if Invoke() can run the nodes of each stage concurrently.
+  bool CanInvokeInterOpStages() const;
+
+  // Runs the stages of `inter_op_schedule_` one after the other, running the
+  // nodes of each stage on `inter_op_thread_pool_`.
+  TfLiteStatus InvokeInterOpStages();
+
   // Allow a delegate to look at the graph and modify the graph to handle
   // parts of the graph themselves. After this is called, the graph may
   // contain new nodes that replace 1 more nodes.
@@ -1178,6 +1205,21 @@ class Subgraph {
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
 
+  // Stages of the execution plan for inter-op parallel execution. Empty unless
+  // `InterpreterOptions::SetInterOpParallelism()` asked for several threads
+  // and some nodes are independent.
+  internal::InterOpSchedule inter_op_schedule_;
+
+  // True if `execution_plan_` and the memory plan follow `inter_op_schedule_`.
+  // Cleared when the subgraph has dynamic tensors.
+  bool inter_op_schedule_active_ = false;
+
+  // Threads running the nodes of a stage.
+  std::unique_ptr<internal::InterOpThreadPool> inter_op_thread_pool_;
+
+  // Held by the nodes of a stage that use the CPU backend context.
+  std::unique_ptr<std::mutex> cpu_backend_mutex_;
+
   // Allocator used for runtime-owned CPU buffers. Not owned.
   TfLiteAllocator* allocator_ = nullptr;
 
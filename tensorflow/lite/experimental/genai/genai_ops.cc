@@ -24,6 +24,8 @@ namespace custom {
 extern "C" void GenAIOpsRegisterer(::tflite::MutableOpResolver* resolver) {
   resolver->AddCustom("odml.update_kv_cache",
                       tflite::ops::custom::Register_KV_CACHE());
+  resolver->AddCustom("odml.update_paged_kv_cache",
+                      tflite::ops::custom::Register_PAGED_KV_CACHE());
   resolver->AddCustom("odml.scaled_dot_product_attention",
                       tflite::ops::custom::Register_SDPA());
   resolver->AddCustom("odml.update_external_kv_cache",
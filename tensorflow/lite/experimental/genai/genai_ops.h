@@ -24,9 +24,23 @@ namespace ops {
 namespace custom {
 
 TfLiteRegistration* Register_KV_CACHE();
+// Writes the (B, S, N, H) keys and values of a batch of sequences to a paged
+// cache and outputs the cached keys and values of each sequence. The outputs
+// are (B, kv_cache_max, N, H), like those of KV_CACHE, so they can feed an
+// SDPA op with a kv_cache_max long mask. With the `trim_outputs` option, they
+// are (B, S', N, H) instead, where S' is the highest position written by the
+// batch rounded up to a whole block, capped at kv_cache_max. The mask of an
+// SDPA op that consumes trimmed outputs must then have a key dimension of 1.
+TfLiteRegistration* Register_PAGED_KV_CACHE();
 TfLiteRegistration* Register_EXTERNAL_KV_CACHE();
 TfLiteRegistration* Register_SDPA();
 
+// Resource id of the paged KV cache that the PAGED_KV_CACHE ops of a subgraph
+// share. Sequences are forked and released through
+// `resource::GetPagedCacheBuffer(&subgraph->resources(),
+// kPagedKVCacheResourceId)`.
+inline constexpr int kPagedKVCacheResourceId = 44;
+
 extern "C" void GenAIOpsRegisterer(::tflite::MutableOpResolver* resolver);
 
 }  // namespace custom
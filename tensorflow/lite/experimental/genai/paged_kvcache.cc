@@ -0,0 +1,291 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "flatbuffers/flexbuffers.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace llm {
+
+static const int kSequenceIdTensor = 0;
+static const int kPositionTensor = 1;
+static const int kKeyTensor = 2;
+static const int kValueTensor = 3;
+static const int kFullKeyTensor = 0;
+static const int kFullValueTensor = 1;
+static const int kRequiredNumDimensions = 4;
+static const int kDefaultMaxNumCacheEntries = 2048;
+static const int kDefaultNumTransformerLayers = 32;
+static const int kDefaultTransformerLayerId = 0;
+static const int kDefaultBlockSize = 16;
+
+struct PagedOpData {
+  int num_layers;
+  int layer_index;
+  int max_num_entries;
+  int block_size;
+  int max_num_blocks;
+  // Whether the outputs end at the highest position written rather than at
+  // `max_num_entries`.
+  bool trim_outputs;
+  // The cache shared by all the ops of the subgraph, owned by the subgraph's
+  // resources.
+  resource::PagedCacheBuffer* cache;
+};
+
+void* PagedKVCacheInit(TfLiteContext* context, const char* buffer,
+                       size_t length) {
+  PagedOpData* op_data = new PagedOpData();
+  int32_t max_num_entries = 0;
+  int32_t num_layers = 0;
+  int32_t layer_index = 0;
+  int32_t block_size = 0;
+  int32_t max_num_blocks = 0;
+  bool trim_outputs = false;
+  if (buffer != nullptr && length > 0) {
+    const uint8_t* buffer_t = reinterpret_cast<const uint8_t*>(buffer);
+    auto flexbuffer_map = flexbuffers::GetRoot(buffer_t, length).AsMap();
+    max_num_entries = flexbuffer_map["kv_cache_max"].AsInt32();
+    num_layers = flexbuffer_map["num_layers"].AsInt32();
+    layer_index = flexbuffer_map["layer_index"].AsInt32();
+    block_size = flexbuffer_map["block_size"].AsInt32();
+    max_num_blocks = flexbuffer_map["max_num_blocks"].AsInt32();
+    trim_outputs = flexbuffer_map["trim_outputs"].AsBool();
+  }
+  op_data->max_num_entries =
+      max_num_entries > 0 ? max_num_entries : kDefaultMaxNumCacheEntries;
+  op_data->num_layers =
+      num_layers > 0 ? num_layers : kDefaultNumTransformerLayers;
+  op_data->layer_index =
+      layer_index > 0 ? layer_index : kDefaultTransformerLayerId;
+  op_data->block_size = block_size > 0 ? block_size : kDefaultBlockSize;
+  // 0 lets the cache grow as long as memory allows.
+  op_data->max_num_blocks = max_num_blocks > 0 ? max_num_blocks : 0;
+  op_data->trim_outputs = trim_outputs;
+  op_data->cache = nullptr;
+  return op_data;
+}
+
+// Resizes `output` to (B, num_entries, N, H), where (B, S, N, H) is the shape
+// of `key`.
+TfLiteStatus ResizeOutput(TfLiteContext* context, const TfLiteTensor* key,
+                          int64_t num_entries, TfLiteTensor* output) {
+  TfLiteIntArray* dims = TfLiteIntArrayCopy(key->dims);
+  dims->data[1] = static_cast<int>(num_entries);
+  if (TfLiteIntArrayEqual(output->dims, dims)) {
+    TfLiteIntArrayFree(dims);
+    return kTfLiteOk;
+  }
+  return context->ResizeTensor(context, output, dims);
+}
+
+TfLiteStatus PagedKVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 4);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 2);
+
+  PagedOpData* op_data = reinterpret_cast<PagedOpData*>(node->user_data);
+  TF_LITE_ENSURE(context, op_data->layer_index < op_data->num_layers);
+
+  const TfLiteTensor* sequence_id;
+  const TfLiteTensor* position;
+  const TfLiteTensor* key;
+  const TfLiteTensor* value;
+  TF_LITE_ENSURE_OK(
+      context, GetInputSafe(context, node, kSequenceIdTensor, &sequence_id));
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kPositionTensor, &position));
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kKeyTensor, &key));
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kValueTensor, &value));
+
+  TF_LITE_ENSURE_EQ(context, sequence_id->type, kTfLiteInt32);
+  TF_LITE_ENSURE_EQ(context, position->type, kTfLiteInt64);
+  TF_LITE_ENSURE_EQ(context, key->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, value->type, kTfLiteFloat32);
+  // (B, S, N, H) keys and values, one sequence id per batch entry.
+  TF_LITE_ENSURE_EQ(context, NumDimensions(key), kRequiredNumDimensions);
+  TF_LITE_ENSURE(context, HaveSameShapes(key, value));
+  const int batch_size = SizeOfDimension(key, 0);
+  const int num_positions = SizeOfDimension(key, 1);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(sequence_id), 1);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(sequence_id, 0), batch_size);
+  // Positions are either shared by all the sequences, (S), or given for each
+  // sequence, (B, S).
+  if (NumDimensions(position) == 1) {
+    TF_LITE_ENSURE_EQ(context, SizeOfDimension(position, 0), num_positions);
+  } else {
+    TF_LITE_ENSURE_EQ(context, NumDimensions(position), 2);
+    TF_LITE_ENSURE_EQ(context, SizeOfDimension(position, 0), batch_size);
+    TF_LITE_ENSURE_EQ(context, SizeOfDimension(position, 1), num_positions);
+  }
+
+  // All the ops of the subgraph share one cache, created by the first one.
+  Subgraph* subgraph = reinterpret_cast<Subgraph*>(context->impl_);
+  auto& resources = subgraph->resources();
+  TF_LITE_ENSURE_OK(context, resource::CreatePagedCacheBufferIfNotAvailable(
+                                 &resources, kPagedKVCacheResourceId));
+  op_data->cache =
+      resource::GetPagedCacheBuffer(&resources, kPagedKVCacheResourceId);
+  const int entry_size = SizeOfDimension(key, 2) * SizeOfDimension(key, 3);
+  if (!op_data->cache->IsInitialized()) {
+    TF_LITE_ENSURE_OK(context, op_data->cache->Initialize(
+                                   op_data->num_layers, entry_size,
+                                   op_data->block_size,
+                                   op_data->max_num_blocks));
+  }
+  TF_LITE_ENSURE_EQ(context, op_data->cache->num_layers(), op_data->num_layers);
+  TF_LITE_ENSURE_EQ(context, op_data->cache->entry_size(), entry_size);
+
+  // The outputs hold the cached keys and values of each sequence, gathered
+  // into (B, kv_cache_max, N, H) tensors. With `trim_outputs`, they are
+  // (B, S', N, H) tensors instead, where S' depends on the positions written,
+  // so they are sized in Eval.
+  TfLiteTensor* kfull;
+  TfLiteTensor* vfull;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kFullKeyTensor, &kfull));
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kFullValueTensor, &vfull));
+  kfull->type = kTfLiteFloat32;
+  vfull->type = kTfLiteFloat32;
+  if (op_data->trim_outputs) {
+    SetTensorToDynamic(kfull);
+    SetTensorToDynamic(vfull);
+    return kTfLiteOk;
+  }
+  TF_LITE_ENSURE_OK(
+      context, ResizeOutput(context, key, op_data->max_num_entries, kfull));
+  TF_LITE_ENSURE_OK(
+      context, ResizeOutput(context, key, op_data->max_num_entries, vfull));
+  return kTfLiteOk;
+}
+
+void PagedKVCacheFree(TfLiteContext* context, void* buffer) {
+  delete static_cast<PagedOpData*>(buffer);
+}
+
+TfLiteStatus PagedKVCacheEval(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* sequence_id;
+  const TfLiteTensor* position;
+  const TfLiteTensor* key;
+  const TfLiteTensor* value;
+  TF_LITE_ENSURE_OK(
+      context, GetInputSafe(context, node, kSequenceIdTensor, &sequence_id));
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kPositionTensor, &position));
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kKeyTensor, &key));
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kValueTensor, &value));
+  TfLiteTensor* kfull;
+  TfLiteTensor* vfull;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kFullKeyTensor, &kfull));
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kFullValueTensor, &vfull));
+  PagedOpData* op_data = reinterpret_cast<PagedOpData*>(node->user_data);
+  resource::PagedCacheBuffer* cache = op_data->cache;
+
+  const int batch_size = SizeOfDimension(key, 0);
+  const int num_positions = SizeOfDimension(key, 1);
+  const int entry_size = cache->entry_size();
+  const int64_t max_num_entries = op_data->max_num_entries;
+  const bool per_sequence_positions = NumDimensions(position) == 2;
+  const int32_t* sequence_ids = GetTensorData<int32_t>(sequence_id);
+  const int64_t* positions = GetTensorData<int64_t>(position);
+  const float* key_data = GetTensorData<float>(key);
+  const float* value_data = GetTensorData<float>(value);
+
+  // Like KV_CACHE, the positions of a sequence are consecutive, starting at
+  // the first one. Unlike KV_CACHE, old entries are never evicted.
+  auto first_position_of = [&](int b) -> int64_t {
+    return num_positions == 0
+               ? 0
+               : positions[per_sequence_positions ? b * num_positions : 0];
+  };
+
+  // Trimmed outputs hold the entries up to the highest position written by
+  // the batch, rounded up to a whole block so that they are reallocated once
+  // per block of decode steps rather than on every step.
+  int64_t num_entries = 0;
+  for (int b = 0; b < batch_size; ++b) {
+    const int64_t first_position = first_position_of(b);
+    if (first_position < 0 ||
+        first_position + num_positions > max_num_entries) {
+      TF_LITE_KERNEL_LOG(context,
+                         "Positions [%lld, %lld) of sequence %d are outside of "
+                         "the cache of %lld entries.",
+                         static_cast<long long>(first_position),
+                         static_cast<long long>(first_position + num_positions),
+                         sequence_ids[b],
+                         static_cast<long long>(max_num_entries));
+      return kTfLiteError;
+    }
+    num_entries = std::max(num_entries, first_position + num_positions);
+  }
+  if (op_data->trim_outputs) {
+    const int block_size = op_data->block_size;
+    num_entries = std::min(
+        (num_entries + block_size - 1) / block_size * block_size,
+        max_num_entries);
+    TF_LITE_ENSURE_OK(context, ResizeOutput(context, key, num_entries, kfull));
+    TF_LITE_ENSURE_OK(context, ResizeOutput(context, key, num_entries, vfull));
+  } else {
+    num_entries = max_num_entries;
+  }
+  float* kfull_data = GetTensorData<float>(kfull);
+  float* vfull_data = GetTensorData<float>(vfull);
+
+  for (int b = 0; b < batch_size; ++b) {
+    const size_t input_offset =
+        static_cast<size_t>(b) * num_positions * entry_size;
+    if (cache->Write(sequence_ids[b], op_data->layer_index,
+                     first_position_of(b), num_positions,
+                     key_data + input_offset,
+                     value_data + input_offset) != kTfLiteOk) {
+      TF_LITE_KERNEL_LOG(context,
+                         "Out of KV cache blocks for sequence %d; release "
+                         "finished sequences or raise max_num_blocks.",
+                         sequence_ids[b]);
+      return kTfLiteError;
+    }
+    const size_t output_offset =
+        static_cast<size_t>(b) * num_entries * entry_size;
+    cache->Read(sequence_ids[b], op_data->layer_index, num_entries,
+                kfull_data + output_offset, vfull_data + output_offset);
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace llm
+
+TfLiteRegistration* Register_PAGED_KV_CACHE() {
+  static TfLiteRegistration r = {llm::PagedKVCacheInit, llm::PagedKVCacheFree,
+                                 llm::PagedKVCachePrepare,
+                                 llm::PagedKVCacheEval};
+  return &r;
+}
+
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
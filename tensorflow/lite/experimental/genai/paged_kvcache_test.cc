@@ -0,0 +1,464 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
+#include "flatbuffers/flexbuffers.h"
+#include "tensorflow/lite/c/c_api_types.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+std::vector<uint8_t> CacheOptions(int kv_cache_max, int num_layers,
+                                  int block_size, int max_num_blocks,
+                                  bool trim_outputs = false) {
+  flexbuffers::Builder fbb;
+  fbb.Map([&]() {
+    fbb.Int("kv_cache_max", kv_cache_max);
+    fbb.Int("num_layers", num_layers);
+    fbb.Int("layer_index", 0);
+    fbb.Int("block_size", block_size);
+    fbb.Int("max_num_blocks", max_num_blocks);
+    fbb.Bool("trim_outputs", trim_outputs);
+  });
+  fbb.Finish();
+  return fbb.GetBuffer();
+}
+
+// A `SingleOpModel` that reports the memory its interpreter allocated.
+class MemoryReportingOpModel : public SingleOpModel {
+ public:
+  Subgraph::SubgraphAllocInfo GetMemoryAllocInfo() {
+    Subgraph::SubgraphAllocInfo alloc_info;
+    interpreter_->primary_subgraph().GetMemoryAllocInfo(&alloc_info);
+    return alloc_info;
+  }
+};
+
+class PagedCacheOpModel : public MemoryReportingOpModel {
+ public:
+  PagedCacheOpModel(const TensorData& sequence_id_tensor,
+                    const TensorData& pos_tensor, const TensorData& k_tensor,
+                    const TensorData& v_tensor, int kv_cache_max,
+                    int block_size, int max_num_blocks = 0,
+                    bool trim_outputs = false) {
+    sequence_id_ = AddInput(sequence_id_tensor);
+    pos_ = AddInput(pos_tensor);
+    k_ = AddInput(k_tensor);
+    v_ = AddInput(v_tensor);
+    kfull_ = AddOutput(k_tensor.type);
+    vfull_ = AddOutput(v_tensor.type);
+    SetCustomOp("Paged_KV_Cache",
+                CacheOptions(kv_cache_max, /*num_layers=*/1, block_size,
+                             max_num_blocks, trim_outputs),
+                ops::custom::Register_PAGED_KV_CACHE);
+    BuildInterpreter({GetShape(sequence_id_), GetShape(pos_), GetShape(k_),
+                      GetShape(v_)});
+  }
+
+  void SetSequenceIds(const std::vector<int32_t>& data) {
+    PopulateTensor(sequence_id_, data);
+  }
+  void SetPosition(const std::vector<int64_t>& data) {
+    PopulateTensor(pos_, data);
+  }
+  void SetKey(const std::vector<float>& data) { PopulateTensor(k_, data); }
+  void SetValue(const std::vector<float>& data) { PopulateTensor(v_, data); }
+
+  std::vector<float> GetFullK() { return ExtractVector<float>(kfull_); }
+  std::vector<float> GetFullV() { return ExtractVector<float>(vfull_); }
+  std::vector<int> GetFullKShape() { return GetTensorShape(kfull_); }
+
+  resource::PagedCacheBuffer* GetCache() {
+    return resource::GetPagedCacheBuffer(
+        &interpreter_->primary_subgraph().resources(),
+        ops::custom::kPagedKVCacheResourceId);
+  }
+
+ protected:
+  int sequence_id_;
+  int pos_;
+  int k_;
+  int v_;
+  int kfull_;
+  int vfull_;
+};
+
+// Returns `entries` followed by zeros, up to `num_entries` entries of
+// `entry_size` floats.
+std::vector<float> Padded(std::vector<float> entries, int num_entries,
+                          int entry_size) {
+  entries.resize(num_entries * entry_size, 0.0f);
+  return entries;
+}
+
+TEST(PagedCacheOpTest, SequencesOfABatchAreSeparate) {
+  // Two sequences, two positions, one head of size 2.
+  PagedCacheOpModel m({TensorType_INT32, {2}}, {TensorType_INT64, {2}},
+                      {TensorType_FLOAT32, {2, 2, 1, 2}},
+                      {TensorType_FLOAT32, {2, 2, 1, 2}},
+                      /*kv_cache_max=*/4, /*block_size=*/2);
+  m.SetSequenceIds({7, 3});
+  m.SetPosition({0, 1});
+  m.SetKey({1, 2, 3, 4, 5, 6, 7, 8});
+  m.SetValue({-1, -2, -3, -4, -5, -6, -7, -8});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetFullKShape(), ElementsAreArray({2, 4, 1, 2}));
+  std::vector<float> expected_k = Padded({1, 2, 3, 4}, 4, 2);
+  std::vector<float> sequence_3_k = Padded({5, 6, 7, 8}, 4, 2);
+  expected_k.insert(expected_k.end(), sequence_3_k.begin(),
+                    sequence_3_k.end());
+  EXPECT_THAT(m.GetFullK(), ElementsAreArray(expected_k));
+  std::vector<float> expected_v = Padded({-1, -2, -3, -4}, 4, 2);
+  std::vector<float> sequence_3_v = Padded({-5, -6, -7, -8}, 4, 2);
+  expected_v.insert(expected_v.end(), sequence_3_v.begin(),
+                    sequence_3_v.end());
+  EXPECT_THAT(m.GetFullV(), ElementsAreArray(expected_v));
+
+  resource::PagedCacheBuffer* cache = m.GetCache();
+  ASSERT_NE(cache, nullptr);
+  EXPECT_EQ(cache->GetNumEntries(7, 0), 2);
+  EXPECT_EQ(cache->GetNumEntries(3, 0), 2);
+  EXPECT_EQ(cache->GetNumUsedBlocks(), 2);
+}
+
+TEST(PagedCacheOpTest, DecodeAtDifferentPositions) {
+  PagedCacheOpModel m({TensorType_INT32, {2}}, {TensorType_INT64, {2, 1}},
+                      {TensorType_FLOAT32, {2, 1, 1, 1}},
+                      {TensorType_FLOAT32, {2, 1, 1, 1}},
+                      /*kv_cache_max=*/5, /*block_size=*/2);
+  m.SetSequenceIds({0, 1});
+  // Sequence 0 writes positions 0 to 3, sequence 1 writes positions 0 to 1.
+  for (int step = 0; step < 4; ++step) {
+    m.SetPosition({step, step / 2});
+    m.SetKey({static_cast<float>(step + 1), static_cast<float>(10 + step)});
+    m.SetValue({0, 0});
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  }
+  // Sequence 1 overwrote each of its positions once.
+  EXPECT_THAT(m.GetFullK(),
+              ElementsAreArray({1, 2, 3, 4, 0, 11, 13, 0, 0, 0}));
+  EXPECT_EQ(m.GetCache()->GetNumUsedBlocks(), 3);
+}
+
+TEST(PagedCacheOpTest, TrimmedOutputsEndAtWrittenPositions) {
+  PagedCacheOpModel m({TensorType_INT32, {2}}, {TensorType_INT64, {2, 1}},
+                      {TensorType_FLOAT32, {2, 1, 1, 1}},
+                      {TensorType_FLOAT32, {2, 1, 1, 1}},
+                      /*kv_cache_max=*/5, /*block_size=*/2,
+                      /*max_num_blocks=*/0, /*trim_outputs=*/true);
+  m.SetSequenceIds({0, 1});
+  m.SetPosition({0, 0});
+  m.SetKey({1, 11});
+  m.SetValue({0, 0});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  // One position written, rounded up to a block of 2.
+  EXPECT_THAT(m.GetFullKShape(), ElementsAreArray({2, 2, 1, 1}));
+  EXPECT_THAT(m.GetFullK(), ElementsAreArray({1, 0, 11, 0}));
+
+  // Sequence 0 writes positions 1 to 4, sequence 1 stays at position 1.
+  for (int step = 1; step < 5; ++step) {
+    m.SetPosition({step, 1});
+    m.SetKey({static_cast<float>(step + 1), 12});
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  }
+  // 5 positions, rounded up to 6 but capped at kv_cache_max.
+  EXPECT_THAT(m.GetFullKShape(), ElementsAreArray({2, 5, 1, 1}));
+  EXPECT_THAT(m.GetFullK(),
+              ElementsAreArray({1, 2, 3, 4, 5, 11, 12, 0, 0, 0}));
+}
+
+TEST(PagedCacheOpTest, ForkedSequencesSharePrefix) {
+  PagedCacheOpModel m({TensorType_INT32, {1}}, {TensorType_INT64, {1}},
+                      {TensorType_FLOAT32, {1, 1, 1, 1}},
+                      {TensorType_FLOAT32, {1, 1, 1, 1}},
+                      /*kv_cache_max=*/4, /*block_size=*/2);
+  m.SetSequenceIds({0});
+  for (int step = 0; step < 3; ++step) {
+    m.SetPosition({step});
+    m.SetKey({static_cast<float>(step + 1)});
+    m.SetValue({0});
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  }
+  resource::PagedCacheBuffer* cache = m.GetCache();
+  ASSERT_EQ(cache->ForkSequence(0, 1), kTfLiteOk);
+  EXPECT_EQ(cache->GetNumUsedBlocks(), 2);
+
+  m.SetSequenceIds({1});
+  m.SetPosition({3});
+  m.SetKey({9});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetFullK(), ElementsAreArray({1, 2, 3, 9}));
+  // Only the block that sequence 1 wrote to was copied.
+  EXPECT_EQ(cache->GetNumUsedBlocks(), 3);
+
+  m.SetSequenceIds({0});
+  m.SetPosition({3});
+  m.SetKey({4});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetFullK(), ElementsAreArray({1, 2, 3, 4}));
+}
+
+TEST(PagedCacheOpTest, FailsOutsideOfCache) {
+  PagedCacheOpModel m({TensorType_INT32, {1}}, {TensorType_INT64, {2}},
+                      {TensorType_FLOAT32, {1, 2, 1, 1}},
+                      {TensorType_FLOAT32, {1, 2, 1, 1}},
+                      /*kv_cache_max=*/4, /*block_size=*/2);
+  m.SetSequenceIds({0});
+  m.SetPosition({3, 4});
+  m.SetKey({1, 2});
+  m.SetValue({1, 2});
+  EXPECT_EQ(m.Invoke(), kTfLiteError);
+}
+
+TEST(PagedCacheOpTest, FailsWhenOutOfBlocks) {
+  PagedCacheOpModel m({TensorType_INT32, {2}}, {TensorType_INT64, {2}},
+                      {TensorType_FLOAT32, {2, 2, 1, 1}},
+                      {TensorType_FLOAT32, {2, 2, 1, 1}},
+                      /*kv_cache_max=*/4, /*block_size=*/2,
+                      /*max_num_blocks=*/1);
+  m.SetSequenceIds({0, 1});
+  m.SetPosition({0, 1});
+  m.SetKey({1, 2, 3, 4});
+  m.SetValue({1, 2, 3, 4});
+  EXPECT_EQ(m.Invoke(), kTfLiteError);
+
+  // Releasing the first sequence makes room for the second one.
+  m.GetCache()->ReleaseSequence(0);
+  m.SetSequenceIds({1, 1});
+  EXPECT_EQ(m.Invoke(), kTfLiteOk);
+}
+
+TEST(PagedCacheOpTest, MemoryGrowsWithSequenceLength) {
+  PagedCacheOpModel m({TensorType_INT32, {1}}, {TensorType_INT64, {1}},
+                      {TensorType_FLOAT32, {1, 1, 2, 4}},
+                      {TensorType_FLOAT32, {1, 1, 2, 4}},
+                      /*kv_cache_max=*/1024, /*block_size=*/16,
+                      /*max_num_blocks=*/0, /*trim_outputs=*/true);
+  m.SetSequenceIds({0});
+  m.SetKey(std::vector<float>(8, 1.0f));
+  m.SetValue(std::vector<float>(8, 1.0f));
+  for (int step = 0; step < 20; ++step) {
+    m.SetPosition({step});
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  }
+  // Two blocks of 16 positions of keys and values, instead of 1024 positions.
+  EXPECT_EQ(m.GetCache()->GetMemoryUsage(), 2 * 2 * 16 * 8 * sizeof(float));
+  // Trimmed outputs grow a block at a time too.
+  EXPECT_THAT(m.GetFullKShape(), ElementsAreArray({1, 32, 2, 4}));
+}
+
+// A PAGED_KV_CACHE op whose outputs feed an SDPA op, as in a decoder layer.
+class PagedCacheAttentionModel : public MultiOpModel {
+ public:
+  PagedCacheAttentionModel(const std::vector<int>& kv_shape, int kv_cache_max,
+                           int block_size) {
+    const std::vector<int> mask_shape = {1, 1, kv_shape[1], kv_cache_max};
+    sequence_id_ = AddInput({TensorType_INT32, {kv_shape[0]}});
+    pos_ = AddInput({TensorType_INT64, {kv_shape[1]}});
+    k_ = AddInput({TensorType_FLOAT32, kv_shape});
+    v_ = AddInput({TensorType_FLOAT32, kv_shape});
+    query_ = AddInput({TensorType_FLOAT32, kv_shape});
+    mask_ = AddInput({TensorType_FLOAT32, mask_shape});
+    const int kfull = AddInnerTensor<float>({TensorType_FLOAT32, {}});
+    const int vfull = AddInnerTensor<float>({TensorType_FLOAT32, {}});
+    output_ = AddOutput({TensorType_FLOAT32, kv_shape});
+    AddCustomOp("odml.update_paged_kv_cache",
+                CacheOptions(kv_cache_max, /*num_layers=*/1, block_size,
+                             /*max_num_blocks=*/0),
+                ops::custom::Register_PAGED_KV_CACHE,
+                {sequence_id_, pos_, k_, v_}, {kfull, vfull});
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() { fbb.Float("scale", 0.0f); });
+    fbb.Finish();
+    AddCustomOp("odml.scaled_dot_product_attention", fbb.GetBuffer(),
+                ops::custom::Register_SDPA, {query_, kfull, vfull, mask_},
+                {output_});
+    BuildInterpreter({GetShape(sequence_id_), GetShape(pos_), GetShape(k_),
+                      GetShape(v_), GetShape(query_), GetShape(mask_)});
+  }
+
+  int sequence_id() const { return sequence_id_; }
+  int pos() const { return pos_; }
+  int k() const { return k_; }
+  int v() const { return v_; }
+  int query() const { return query_; }
+  int mask() const { return mask_; }
+
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ private:
+  int sequence_id_;
+  int pos_;
+  int k_;
+  int v_;
+  int query_;
+  int mask_;
+  int output_;
+};
+
+TEST(PagedCacheOpTest, FeedsAttentionWithCacheLongMask) {
+  // One sequence writes two positions of one head of size 2, and attends to
+  // the cache through a causal mask over all of kv_cache_max.
+  PagedCacheAttentionModel m({1, 2, 1, 2}, /*kv_cache_max=*/4,
+                             /*block_size=*/2);
+  const float kMasked = -std::numeric_limits<float>::infinity();
+  m.PopulateTensor<int32_t>(m.sequence_id(), {0});
+  m.PopulateTensor<int64_t>(m.pos(), {0, 1});
+  // With all-zero keys, each query attends evenly to the positions that its
+  // mask lets through.
+  m.PopulateTensor<float>(m.k(), {0, 0, 0, 0});
+  m.PopulateTensor<float>(m.v(), {2, 4, 6, 8});
+  m.PopulateTensor<float>(m.query(), {1, 1, 1, 1});
+  m.PopulateTensor<float>(m.mask(), {0, kMasked, kMasked, kMasked,  //
+                                     0, 0, kMasked, kMasked});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({2, 4, 4, 6})));
+}
+
+}  // namespace
+}  // namespace tflite
+
+namespace {
+
+constexpr int kBenchmarkNumHeads = 8;
+constexpr int kBenchmarkHeadDim = 64;
+constexpr int kBenchmarkCacheMax = 4096;
+
+}  // namespace
+
+// One decode step of `num_sequences` sequences that are `context_len` long,
+// with the paged cache: one interpreter runs all the sequences as a batch.
+void BM_PagedKVCacheDecode(benchmark::State& state) {
+  const int num_sequences = state.range(0);
+  const int context_len = state.range(1);
+  const bool trim_outputs = state.range(2);
+  const int entry_size = kBenchmarkNumHeads * kBenchmarkHeadDim;
+  const std::vector<int> kv_shape = {num_sequences, 1, kBenchmarkNumHeads,
+                                     kBenchmarkHeadDim};
+  tflite::PagedCacheOpModel m(
+      {tflite::TensorType_INT32, {num_sequences}},
+      {tflite::TensorType_INT64, {1}}, {tflite::TensorType_FLOAT32, kv_shape},
+      {tflite::TensorType_FLOAT32, kv_shape}, kBenchmarkCacheMax,
+      /*block_size=*/16, /*max_num_blocks=*/0, trim_outputs);
+  std::vector<int32_t> sequence_ids(num_sequences);
+  const std::vector<float> prefill(context_len * entry_size, 1.0f);
+  for (int i = 0; i < num_sequences; ++i) {
+    sequence_ids[i] = i;
+    m.GetCache()->Write(i, 0, 0, context_len, prefill.data(), prefill.data());
+  }
+  m.SetSequenceIds(sequence_ids);
+  m.SetPosition({context_len});
+  m.SetKey(std::vector<float>(num_sequences * entry_size, 2.0f));
+  m.SetValue(std::vector<float>(num_sequences * entry_size, 2.0f));
+
+  for (auto _ : state) {
+    m.Invoke();
+  }
+  state.counters["tokens_per_second"] = benchmark::Counter(
+      num_sequences, benchmark::Counter::kIsIterationInvariantRate);
+  // The cache blocks, plus the gathered outputs, which are arena tensors, or
+  // dynamic tensors when trimmed.
+  const tflite::Subgraph::SubgraphAllocInfo alloc_info =
+      m.GetMemoryAllocInfo();
+  const size_t cache_bytes = m.GetCache()->GetMemoryUsage();
+  state.counters["cache_bytes"] = cache_bytes;
+  state.counters["arena_bytes"] = alloc_info.arena_size;
+  state.counters["dynamic_bytes"] = alloc_info.dynamic_size;
+  state.counters["bytes_per_sequence"] =
+      static_cast<double>(cache_bytes + alloc_info.arena_size +
+                          alloc_info.dynamic_size) /
+      num_sequences;
+}
+BENCHMARK(BM_PagedKVCacheDecode)
+    ->ArgNames({"sequences", "context_len", "trim"})
+    ->ArgsProduct({{1, 8}, {256, 1024, 4000}, {0, 1}});
+
+// The same decode step with the contiguous KV_CACHE op, which needs one
+// interpreter per sequence.
+void BM_ContiguousKVCacheDecode(benchmark::State& state) {
+  const int num_sequences = state.range(0);
+  const int context_len = state.range(1);
+  const int entry_size = kBenchmarkNumHeads * kBenchmarkHeadDim;
+  const std::vector<int> kv_shape = {1, 1, kBenchmarkNumHeads,
+                                     kBenchmarkHeadDim};
+  flexbuffers::Builder fbb;
+  fbb.Map([&]() {
+    fbb.Int("kv_cache_max", kBenchmarkCacheMax);
+    fbb.Int("num_layers", 1);
+    fbb.Int("layer_index", 0);
+  });
+  fbb.Finish();
+  std::vector<std::unique_ptr<tflite::MemoryReportingOpModel>> models;
+  for (int i = 0; i < num_sequences; ++i) {
+    auto m = std::make_unique<tflite::MemoryReportingOpModel>();
+    const int pos = m->AddInput({tflite::TensorType_INT64, {1}});
+    const int k = m->AddInput({tflite::TensorType_FLOAT32, kv_shape});
+    const int v = m->AddInput({tflite::TensorType_FLOAT32, kv_shape});
+    m->AddOutput(tflite::TensorType_FLOAT32);
+    m->AddOutput(tflite::TensorType_FLOAT32);
+    m->SetCustomOp("KV_Cache", fbb.GetBuffer(),
+                   tflite::ops::custom::Register_KV_CACHE);
+    m->BuildInterpreter({{1}, kv_shape, kv_shape});
+    m->PopulateTensor<int64_t>(pos, {context_len});
+    m->PopulateTensor(k, std::vector<float>(entry_size, 2.0f));
+    m->PopulateTensor(v, std::vector<float>(entry_size, 2.0f));
+    models.push_back(std::move(m));
+  }
+
+  for (auto _ : state) {
+    for (auto& m : models) {
+      m->Invoke();
+    }
+  }
+  state.counters["tokens_per_second"] = benchmark::Counter(
+      num_sequences, benchmark::Counter::kIsIterationInvariantRate);
+  // Keys and values of every position up to kv_cache_max, for each sequence.
+  // The outputs alias the cache.
+  const size_t cache_bytes =
+      num_sequences * 2 * kBenchmarkCacheMax * entry_size * sizeof(float);
+  size_t arena_bytes = 0;
+  size_t dynamic_bytes = 0;
+  for (auto& m : models) {
+    const tflite::Subgraph::SubgraphAllocInfo alloc_info =
+        m->GetMemoryAllocInfo();
+    arena_bytes += alloc_info.arena_size;
+    dynamic_bytes += alloc_info.dynamic_size;
+  }
+  state.counters["cache_bytes"] = cache_bytes;
+  state.counters["arena_bytes"] = arena_bytes;
+  state.counters["dynamic_bytes"] = dynamic_bytes;
+  state.counters["bytes_per_sequence"] =
+      static_cast<double>(cache_bytes + arena_bytes + dynamic_bytes) /
+      num_sequences;
+}
+BENCHMARK(BM_ContiguousKVCacheDecode)
+    ->ArgNames({"sequences", "context_len"})
+    ->ArgsProduct({{1, 8}, {256, 1024, 4000}});
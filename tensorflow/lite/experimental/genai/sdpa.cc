@@ -15,24 +15,21 @@ limitations under the License.
 
 #include <math.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
-#include <cstring>
 #include <limits>
+#include <vector>
 
 #include "flatbuffers/flexbuffers.h"
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
-#include "tensorflow/lite/kernels/internal/common.h"
-#include "tensorflow/lite/kernels/internal/reference/add.h"
-#include "tensorflow/lite/kernels/internal/reference/batch_matmul.h"
-#include "tensorflow/lite/kernels/internal/reference/fully_connected.h"
-#include "tensorflow/lite/kernels/internal/reference/softmax.h"
-#include "tensorflow/lite/kernels/internal/reference/transpose.h"
-#include "tensorflow/lite/kernels/internal/runtime_shape.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
+#include "tensorflow/lite/kernels/internal/optimized/neon_check.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
-#include "tensorflow/lite/kernels/internal/types.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/types/half.h"
 
 namespace tflite {
 namespace ops {
@@ -45,23 +42,276 @@ static const int kValueTensor = 2;
 static const int kAttentionMaskTensor = 3;
 static const int kOutputTensor = 0;
 
-static const int kNumTempTensors = 10;
-static const int kTransposeQueryTempTensorIndex = 0;
-static const int kTransposeKeyTempTensorIndex = 1;
-static const int kMatMul1TempTensorIndex = 2;
-static const int kAddTempTensorIndex = 3;
-static const int kTransposeValueTempTensorIndex = 4;
-static const int kMatMul2TempTensorIndex = 5;
-static const int kReshape1TempTensorIndex = 6;
-static const int kReshape2TempTensorIndex = 7;
-static const int kBroadcastKTempTensorIndex = 8;
-static const int kBroadcastVTempTensorIndex = 9;
+static const int kNumTempTensors = 1;
+static const int kScratchTempTensorIndex = 0;
+
+// Keys and values are read in blocks of this many positions. A block of keys
+// or values is reused by every query row of a tile while it is in cache.
+static const int kKvBlockSize = 64;
+// Query rows (query heads of one KV head group times query positions)
+// computed together by one task.
+static const int kQueryTileSize = 16;
 
 struct OpData {
   float scale;
   int scratch_tensor_index;
 };
 
+namespace {
+
+// A key or value tensor, dequantized to float as it is read.
+struct KvData {
+  TfLiteType type;
+  const void* data;
+  float scale;
+  int32_t zero_point;
+  int seq_len;
+  int num_heads;
+  int head_dim;
+};
+
+struct AttentionParams {
+  const float* query;
+  KvData key;
+  KvData value;
+  const float* mask;
+  float* output;
+  int batch_size;
+  int query_len;
+  int num_heads;
+  // Strides of the batch, head, query and key dimensions of the mask, 0 for
+  // broadcast dimensions.
+  int mask_strides[4];
+  float scale;
+};
+
+bool IsSupportedKvType(TfLiteType type) {
+  return type == kTfLiteFloat32 || type == kTfLiteFloat16 ||
+         type == kTfLiteInt8;
+}
+
+// Number of floats of scratch memory used by each thread: the scaled queries
+// and output accumulators of a tile, one block of scores, the running maximum
+// and sum of each row, and one dequantized block of keys and values.
+int ScratchSizePerThread(int head_dim, int value_dim) {
+  return kQueryTileSize * (head_dim + value_dim + kKvBlockSize + 2) +
+         kKvBlockSize * (head_dim + value_dim);
+}
+
+float Dot(const float* a, const float* b, int size) {
+  int i = 0;
+  float result = 0.0f;
+#ifdef USE_NEON
+  float32x4_t acc = vdupq_n_f32(0.0f);
+  for (; i + 4 <= size; i += 4) {
+    acc = vmlaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+  }
+  result = vgetq_lane_f32(acc, 0) + vgetq_lane_f32(acc, 1) +
+           vgetq_lane_f32(acc, 2) + vgetq_lane_f32(acc, 3);
+#endif  // USE_NEON
+  for (; i < size; ++i) {
+    result += a[i] * b[i];
+  }
+  return result;
+}
+
+// y += alpha * x
+void MultiplyAccumulate(float alpha, const float* x, int size, float* y) {
+  int i = 0;
+#ifdef USE_NEON
+  const float32x4_t alpha_vec = vdupq_n_f32(alpha);
+  for (; i + 4 <= size; i += 4) {
+    vst1q_f32(y + i, vmlaq_f32(vld1q_f32(y + i), vld1q_f32(x + i), alpha_vec));
+  }
+#endif  // USE_NEON
+  for (; i < size; ++i) {
+    y[i] += alpha * x[i];
+  }
+}
+
+void Scale(float alpha, int size, float* y) {
+  int i = 0;
+#ifdef USE_NEON
+  const float32x4_t alpha_vec = vdupq_n_f32(alpha);
+  for (; i + 4 <= size; i += 4) {
+    vst1q_f32(y + i, vmulq_f32(vld1q_f32(y + i), alpha_vec));
+  }
+#endif  // USE_NEON
+  for (; i < size; ++i) {
+    y[i] *= alpha;
+  }
+}
+
+// Returns `size` positions of `head` of `kv`, starting at position `begin`, as
+// rows of floats `*stride` apart. Float inputs are returned in place, other
+// types are dequantized to `buffer`.
+const float* LoadKvBlock(const KvData& kv, int batch, int head, int begin,
+                         int size, float* buffer, int* stride) {
+  const int row_stride = kv.num_heads * kv.head_dim;
+  const size_t offset =
+      (static_cast<size_t>(batch) * kv.seq_len + begin) * row_stride +
+      head * kv.head_dim;
+  switch (kv.type) {
+    case kTfLiteFloat16: {
+      const half* data = static_cast<const half*>(kv.data) + offset;
+      for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < kv.head_dim; ++j) {
+          buffer[i * kv.head_dim + j] = data[i * row_stride + j];
+        }
+      }
+      break;
+    }
+    case kTfLiteInt8: {
+      const int8_t* data = static_cast<const int8_t*>(kv.data) + offset;
+      for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < kv.head_dim; ++j) {
+          buffer[i * kv.head_dim + j] =
+              kv.scale * (data[i * row_stride + j] - kv.zero_point);
+        }
+      }
+      break;
+    }
+    default:
+      *stride = row_stride;
+      return static_cast<const float*>(kv.data) + offset;
+  }
+  *stride = kv.head_dim;
+  return buffer;
+}
+
+// Computes `kQueryTileSize` query rows of the output. The rows are the query
+// heads that share KV head `kv_head`, for consecutive query positions.
+// Keys and values are visited one block at a time, and the softmax is computed
+// online: each row keeps the running maximum and sum of its exponentiated
+// scores, and rescales its output whenever the maximum grows. No more than one
+// block of scores is ever stored.
+void ComputeAttentionTile(const AttentionParams& params, int batch, int kv_head,
+                          int row_begin, float* scratch) {
+  const KvData& key = params.key;
+  const KvData& value = params.value;
+  const int head_dim = key.head_dim;
+  const int value_dim = value.head_dim;
+  const int group_size = params.num_heads / key.num_heads;
+  const int num_rows =
+      std::min(kQueryTileSize, group_size * params.query_len - row_begin);
+
+  float* query_tile = scratch;
+  float* acc = query_tile + kQueryTileSize * head_dim;
+  float* scores = acc + kQueryTileSize * value_dim;
+  float* row_max = scores + kQueryTileSize * kKvBlockSize;
+  float* row_sum = row_max + kQueryTileSize;
+  float* key_buffer = row_sum + kQueryTileSize;
+  float* value_buffer = key_buffer + kKvBlockSize * head_dim;
+
+  const float* mask_rows[kQueryTileSize];
+  float* output_rows[kQueryTileSize];
+  for (int r = 0; r < num_rows; ++r) {
+    const int t = (row_begin + r) / group_size;
+    const int head = kv_head * group_size + (row_begin + r) % group_size;
+    const size_t row =
+        (static_cast<size_t>(batch) * params.query_len + t) * params.num_heads +
+        head;
+    const float* query = params.query + row * head_dim;
+    for (int i = 0; i < head_dim; ++i) {
+      query_tile[r * head_dim + i] = query[i] * params.scale;
+    }
+    mask_rows[r] = params.mask + batch * params.mask_strides[0] +
+                   head * params.mask_strides[1] + t * params.mask_strides[2];
+    output_rows[r] = params.output + row * value_dim;
+    row_max[r] = -std::numeric_limits<float>::infinity();
+    row_sum[r] = 0.0f;
+  }
+  std::fill(acc, acc + num_rows * value_dim, 0.0f);
+
+  const int mask_key_stride = params.mask_strides[3];
+  for (int begin = 0; begin < key.seq_len; begin += kKvBlockSize) {
+    const int block_size = std::min(kKvBlockSize, key.seq_len - begin);
+    int key_stride;
+    const float* keys = LoadKvBlock(key, batch, kv_head, begin, block_size,
+                                    key_buffer, &key_stride);
+    int value_stride;
+    const float* values = LoadKvBlock(value, batch, kv_head, begin, block_size,
+                                      value_buffer, &value_stride);
+    for (int r = 0; r < num_rows; ++r) {
+      float* row_scores = scores + r * kKvBlockSize;
+      const float* mask = mask_rows[r] + begin * mask_key_stride;
+      float block_max = -std::numeric_limits<float>::infinity();
+      for (int j = 0; j < block_size; ++j) {
+        row_scores[j] = Dot(query_tile + r * head_dim, keys + j * key_stride,
+                            head_dim) +
+                        mask[j * mask_key_stride];
+        block_max = std::max(block_max, row_scores[j]);
+      }
+      const float new_max = std::max(row_max[r], block_max);
+      if (new_max == -std::numeric_limits<float>::infinity()) {
+        // Every key seen so far is masked out.
+        continue;
+      }
+      float* row_acc = acc + r * value_dim;
+      if (new_max > row_max[r]) {
+        const float correction = expf(row_max[r] - new_max);
+        row_sum[r] *= correction;
+        Scale(correction, value_dim, row_acc);
+        row_max[r] = new_max;
+      }
+      for (int j = 0; j < block_size; ++j) {
+        const float p = expf(row_scores[j] - new_max);
+        row_sum[r] += p;
+        MultiplyAccumulate(p, values + j * value_stride, value_dim, row_acc);
+      }
+    }
+  }
+
+  for (int r = 0; r < num_rows; ++r) {
+    const float inverse_sum = row_sum[r] > 0.0f ? 1.0f / row_sum[r] : 0.0f;
+    for (int i = 0; i < value_dim; ++i) {
+      output_rows[r][i] = acc[r * value_dim + i] * inverse_sum;
+    }
+  }
+}
+
+// Computes the query tiles [start, end) of the flattened
+// [batch, kv_head, query_tile] iteration space.
+struct SDPAWorkerTask : cpu_backend_threadpool::Task {
+  SDPAWorkerTask(const AttentionParams* params, int start, int end,
+                 float* scratch)
+      : params(params), start(start), end(end), scratch(scratch) {}
+  void Run() override {
+    const int num_kv_heads = params->key.num_heads;
+    const int rows_per_kv_head =
+        params->num_heads / num_kv_heads * params->query_len;
+    const int tiles_per_kv_head =
+        (rows_per_kv_head + kQueryTileSize - 1) / kQueryTileSize;
+    for (int i = start; i < end; ++i) {
+      const int tile = i % tiles_per_kv_head;
+      const int kv_head = i / tiles_per_kv_head % num_kv_heads;
+      const int batch = i / tiles_per_kv_head / num_kv_heads;
+      ComputeAttentionTile(*params, batch, kv_head, tile * kQueryTileSize,
+                           scratch);
+    }
+  }
+
+ private:
+  const AttentionParams* params;
+  int start;
+  int end;
+  float* scratch;
+};
+
+KvData GetKvData(const TfLiteTensor* tensor) {
+  KvData kv;
+  kv.type = tensor->type;
+  kv.data = tensor->data.data;
+  kv.scale = tensor->params.scale;
+  kv.zero_point = tensor->params.zero_point;
+  kv.seq_len = SizeOfDimension(tensor, 1);
+  kv.num_heads = SizeOfDimension(tensor, 2);
+  kv.head_dim = SizeOfDimension(tensor, 3);
+  return kv;
+}
+
+}  // namespace
+
 void* SDPAInit(TfLiteContext* context, const char* buffer, size_t length) {
   OpData* op_data = new OpData();
   op_data->scale = 0.0f;
@@ -86,12 +336,54 @@ TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* mask_tensor;
   TF_LITE_ENSURE_OK(
       context, GetInputSafe(context, node, kAttentionMaskTensor, &mask_tensor));
+  TfLiteTensor* output_tensor;
+  TF_LITE_ENSURE_OK(
+      context, GetOutputSafe(context, node, kOutputTensor, &output_tensor));
   TF_LITE_ENSURE_EQ(context, NumDimensions(q_tensor), NumDimensions(k_tensor));
   TF_LITE_ENSURE_EQ(context, NumDimensions(k_tensor), NumDimensions(v_tensor));
   TF_LITE_ENSURE_EQ(context, NumDimensions(v_tensor),
                     NumDimensions(mask_tensor));
   TF_LITE_ENSURE_EQ(context, NumDimensions(mask_tensor), 4);
 
+  TF_LITE_ENSURE_TYPES_EQ(context, q_tensor->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_TYPES_EQ(context, mask_tensor->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_TYPES_EQ(context, output_tensor->type, kTfLiteFloat32);
+  TF_LITE_ENSURE(context, IsSupportedKvType(k_tensor->type));
+  TF_LITE_ENSURE(context, IsSupportedKvType(v_tensor->type));
+  // Quantized keys and values use per-tensor parameters.
+  if (k_tensor->type == kTfLiteInt8) {
+    TF_LITE_ENSURE(context, k_tensor->params.scale > 0.0f);
+  }
+  if (v_tensor->type == kTfLiteInt8) {
+    TF_LITE_ENSURE(context, v_tensor->params.scale > 0.0f);
+  }
+
+  // q: [batch, query_len, num_heads, head_dim]
+  // k: [batch, kv_len, num_kv_heads, head_dim]
+  // v: [batch, kv_len, num_kv_heads, value_dim]
+  // mask: broadcastable to [batch, num_heads, query_len, kv_len]
+  const int batch_size = SizeOfDimension(q_tensor, 0);
+  const int query_len = SizeOfDimension(q_tensor, 1);
+  const int num_heads = SizeOfDimension(q_tensor, 2);
+  const int head_dim = SizeOfDimension(q_tensor, 3);
+  const int kv_len = SizeOfDimension(k_tensor, 1);
+  const int num_kv_heads = SizeOfDimension(k_tensor, 2);
+  const int value_dim = SizeOfDimension(v_tensor, 3);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(k_tensor, 0), batch_size);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(v_tensor, 0), batch_size);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(k_tensor, 3), head_dim);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(v_tensor, 1), kv_len);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(v_tensor, 2), num_kv_heads);
+  TF_LITE_ENSURE(context, num_kv_heads > 0);
+  TF_LITE_ENSURE_EQ(context, num_heads % num_kv_heads, 0);
+  const int attention_shape[4] = {batch_size, num_heads, query_len, kv_len};
+  for (int i = 0; i < 4; ++i) {
+    const int mask_dim = SizeOfDimension(mask_tensor, i);
+    TF_LITE_ENSURE(context, mask_dim == 1 || mask_dim == attention_shape[i]);
+  }
+  TF_LITE_ENSURE_EQ(context, NumElements(output_tensor),
+                    batch_size * query_len * num_heads * value_dim);
+
   // Get custom op params
   const uint8_t* buffer =
       reinterpret_cast<const uint8_t*>(node->custom_initial_data);
@@ -101,249 +393,26 @@ TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
   op_data->scale = scale > 0.0f ? scale : 0.0f;
 
   // If scale is not set, use sqrt(q_tensor->dims->data[3])
-  if (op_data->scale == 0.0f)
-    op_data->scale = 1 / sqrt(q_tensor->dims->data[3]);
+  if (op_data->scale == 0.0f) op_data->scale = 1 / sqrt(head_dim);
 
   TfLiteIntArrayFree(node->temporaries);
   node->temporaries = TfLiteIntArrayCreate(kNumTempTensors);
-  bool mqa = k_tensor->dims->data[2] == 1;
-
-  // Temp tensor for Transposed Q;
-  {
-    node->temporaries->data[kTransposeQueryTempTensorIndex] =
-        op_data->scratch_tensor_index + kTransposeQueryTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kTransposeQueryTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    for (int i = 0; i < 4; ++i) {
-      scratch_buffer_size->data[i] = q_tensor->dims->data[i];
-    }
-    // Swap middle two dimensions.
-    scratch_buffer_size->data[1] = q_tensor->dims->data[2];
-    scratch_buffer_size->data[2] = q_tensor->dims->data[1];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  // Temp tensor for Transposed K;
-  {
-    node->temporaries->data[kTransposeKeyTempTensorIndex] =
-        op_data->scratch_tensor_index + kTransposeKeyTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kTransposeKeyTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    for (int i = 0; i < 4; ++i) {
-      scratch_buffer_size->data[i] = k_tensor->dims->data[i];
-    }
-    // Swap to middle two dimensions.
-    scratch_buffer_size->data[1] = k_tensor->dims->data[2];
-    scratch_buffer_size->data[2] = k_tensor->dims->data[1];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  TfLiteIntArray* add_broadcast_shape = nullptr;
-  // Temp tensor for Matmul1 output;
-  {
-    node->temporaries->data[kMatMul1TempTensorIndex] =
-        op_data->scratch_tensor_index + kMatMul1TempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(
-        context,
-        GetTemporarySafe(context, node,
-                         /*index=*/kMatMul1TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    // mha/gqa: [permute_q[0], permute_q[1], permute_q[2], permute_k[2]]
-    int matmul_out_shape[4] = {q_tensor->dims->data[0], q_tensor->dims->data[2],
-                               q_tensor->dims->data[1],
-                               k_tensor->dims->data[1]};
-    for (int i = 0; i < 4; ++i) {
-      scratch_buffer_size->data[i] = matmul_out_shape[i];
-    }
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-    // get dims from attention_mask, matmul1_out for add broadcast
-    CalculateShapeForBroadcast(context, mask_tensor, scratch_buffer,
-                               &add_broadcast_shape);
-  }
-
-  // Temp tensor for add output;
-  int add_out_shape[4];
-  {
-    node->temporaries->data[kAddTempTensorIndex] =
-        op_data->scratch_tensor_index + kAddTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
-                                                /*index=*/kAddTempTensorIndex,
-                                                &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = add_broadcast_shape;
-    for (int i = 0; i < 4; ++i) {
-      add_out_shape[i] = scratch_buffer_size->data[i];
-    }
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
 
-  // Temp tensor for Transposed V;
+  // Temp tensor for the per-thread scratch memory. Its size only depends on
+  // the head dimensions, not on the sequence lengths.
   {
-    node->temporaries->data[kTransposeValueTempTensorIndex] =
-        op_data->scratch_tensor_index + kTransposeValueTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kTransposeValueTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    // Swap to {0, 2, 3, 1} dimensions.
-    scratch_buffer_size->data[0] = v_tensor->dims->data[0];
-    scratch_buffer_size->data[1] = v_tensor->dims->data[2];
-    scratch_buffer_size->data[2] = v_tensor->dims->data[3];
-    scratch_buffer_size->data[3] = v_tensor->dims->data[1];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  // Temp tensor for Matmul2 output;
-  {
-    node->temporaries->data[kMatMul2TempTensorIndex] =
-        op_data->scratch_tensor_index + kMatMul2TempTensorIndex;
+    node->temporaries->data[kScratchTempTensorIndex] =
+        op_data->scratch_tensor_index + kScratchTempTensorIndex;
     TfLiteTensor* scratch_buffer;
     TF_LITE_ENSURE_OK(
         context,
         GetTemporarySafe(context, node,
-                         /*index=*/kMatMul2TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    // logits_out_shape = add_out_shape
-    // mha/gqa: [logits_out[0], logits_out[1], logits_out[2], permute_v[2]]
-    scratch_buffer_size->data[0] = add_out_shape[0];
-    scratch_buffer_size->data[1] = add_out_shape[1];
-    scratch_buffer_size->data[2] = add_out_shape[2];
-    scratch_buffer_size->data[3] = v_tensor->dims->data[3];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  // Temp tensor for Reshape K / Transpose Q;
-  {
-    node->temporaries->data[kReshape1TempTensorIndex] =
-        op_data->scratch_tensor_index + kReshape1TempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(
-        context,
-        GetTemporarySafe(context, node,
-                         /*index=*/kReshape1TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size;
-    if (mqa)
-      scratch_buffer_size = TfLiteIntArrayCreate(2);
-    else
-      scratch_buffer_size = TfLiteIntArrayCreate(4);
-    if (mqa) {
-      scratch_buffer_size->data[0] = k_tensor->dims->data[1];
-      scratch_buffer_size->data[1] = k_tensor->dims->data[3];
-    } else {
-      scratch_buffer_size->data[0] = q_tensor->dims->data[0];
-      scratch_buffer_size->data[1] = q_tensor->dims->data[2];
-      scratch_buffer_size->data[2] = q_tensor->dims->data[3];
-      scratch_buffer_size->data[3] = q_tensor->dims->data[1];
-    }
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  // Temp tensor for Reshape V / Add_out (softmax_out);
-  {
-    node->temporaries->data[kReshape2TempTensorIndex] =
-        op_data->scratch_tensor_index + kReshape2TempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(
-        context,
-        GetTemporarySafe(context, node,
-                         /*index=*/kReshape2TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size;
-    if (mqa)
-      scratch_buffer_size = TfLiteIntArrayCreate(2);
-    else
-      scratch_buffer_size = TfLiteIntArrayCreate(4);
-    if (mqa) {
-      scratch_buffer_size->data[0] = v_tensor->dims->data[3];
-      scratch_buffer_size->data[1] = v_tensor->dims->data[1];
-    } else {
-      scratch_buffer_size->data[0] = add_out_shape[0];
-      scratch_buffer_size->data[1] = add_out_shape[1];
-      scratch_buffer_size->data[2] = add_out_shape[3];
-      scratch_buffer_size->data[3] = add_out_shape[2];
-    }
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  // Temp tensor for Broadcast K
-  {
-    node->temporaries->data[kBroadcastKTempTensorIndex] =
-        op_data->scratch_tensor_index + kBroadcastKTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kBroadcastKTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-
-    scratch_buffer_size->data[0] = k_tensor->dims->data[0];
-    scratch_buffer_size->data[1] = q_tensor->dims->data[2];  // num_heads
-    scratch_buffer_size->data[2] = k_tensor->dims->data[1];
-    scratch_buffer_size->data[3] = k_tensor->dims->data[3];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  // Temp tensor for Broadcast V
-  {
-    node->temporaries->data[kBroadcastVTempTensorIndex] =
-        op_data->scratch_tensor_index + kBroadcastVTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kBroadcastVTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-
-    scratch_buffer_size->data[0] = v_tensor->dims->data[0];
-    scratch_buffer_size->data[1] = q_tensor->dims->data[2];  // num_heads
-    scratch_buffer_size->data[2] = v_tensor->dims->data[3];
-    scratch_buffer_size->data[3] = v_tensor->dims->data[1];
+                         /*index=*/kScratchTempTensorIndex, &scratch_buffer));
+    const int num_threads = std::max(
+        1, CpuBackendContext::GetFromContext(context)->max_num_threads());
+    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(2);
+    scratch_buffer_size->data[0] = num_threads;
+    scratch_buffer_size->data[1] = ScratchSizePerThread(head_dim, value_dim);
 
     scratch_buffer->type = kTfLiteFloat32;
     scratch_buffer->allocation_type = kTfLiteArenaRw;
@@ -360,303 +429,88 @@ void SDPAFree(TfLiteContext* context, void* buffer) {
 
 TfLiteStatus SDPAEval(TfLiteContext* context, TfLiteNode* node) {
   /*
-  Simple implementation of Scaled Dot Product Attention.
+  Fused Scaled Dot Product Attention.
   Takes query_proj, key_proj, value_proj, mask tensors as inputs, and
   outputs the attention result.
 
   Notes:
   Scale is computed using 1/sqrt(head_dim),
   head_dim = q[-1] = embedding_dim // num_q_heads
-  Only support for FLOAT32 inputs for now.
-  Only support static tensors for now (k/v[1] = max sequence length)
+  Query, mask and output are FLOAT32. Key and value may also be FLOAT16 or
+  per-tensor quantized INT8.
+  Query heads are mapped to key/value heads like torch.repeat_interleave, which
+  covers MHA, GQA and MQA.
+  The attention scores are never materialized: see ComputeAttentionTile.
   */
 
   const TfLiteTensor* query_tensor;
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kQueryTensor, &query_tensor));
-  auto query_shape = GetTensorShape(query_tensor);
-  auto query_data = GetTensorData<float>(query_tensor);
   const TfLiteTensor* key_tensor;
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kKeyTensor, &key_tensor));
-  auto key_shape = GetTensorShape(key_tensor);
-  auto key_data = GetTensorData<float>(key_tensor);
   const TfLiteTensor* value_tensor;
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kValueTensor, &value_tensor));
-  auto value_shape = GetTensorShape(value_tensor);
-  auto value_data = GetTensorData<float>(value_tensor);
   const TfLiteTensor* attention_mask_tensor;
   TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kAttentionMaskTensor,
                                           &attention_mask_tensor));
-  auto attention_mask_shape = GetTensorShape(attention_mask_tensor);
-  auto attention_mask_data = GetTensorData<float>(attention_mask_tensor);
   TfLiteTensor* output_tensor;
   TF_LITE_ENSURE_OK(
       context, GetOutputSafe(context, node, kOutputTensor, &output_tensor));
-  auto output_shape = GetTensorShape(output_tensor);
-  auto output_data = GetTensorData<float>(output_tensor);
-
-  // temporaries
-  TfLiteTensor* transpose_q_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kTransposeQueryTempTensorIndex,
-                       &transpose_q_out_tensor));
-  auto transpose_q_out_shape = GetTensorShape(transpose_q_out_tensor);
-  auto transpose_q_out_data = GetTensorData<float>(transpose_q_out_tensor);
-  TfLiteTensor* transpose_k_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kTransposeKeyTempTensorIndex,
-                       &transpose_k_out_tensor));
-  auto transpose_k_out_shape = GetTensorShape(transpose_k_out_tensor);
-  auto transpose_k_out_data = GetTensorData<float>(transpose_k_out_tensor);
-  TfLiteTensor* matmul1_out_tensor;
-  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
-                                              /*index=*/kMatMul1TempTensorIndex,
-                                              &matmul1_out_tensor));
-  auto matmul1_out_shape = GetTensorShape(matmul1_out_tensor);
-  auto matmul1_out_data = GetTensorData<float>(matmul1_out_tensor);
-  TfLiteTensor* add_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context, GetTemporarySafe(context, node, /*index=*/kAddTempTensorIndex,
-                                &add_out_tensor));
-  auto add_out_shape = GetTensorShape(add_out_tensor);
-  auto add_out_data = GetTensorData<float>(add_out_tensor);
-  TfLiteTensor* transpose_v_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kTransposeValueTempTensorIndex,
-                       &transpose_v_out_tensor));
-  auto transpose_v_out_shape = GetTensorShape(transpose_v_out_tensor);
-  auto transpose_v_out_data = GetTensorData<float>(transpose_v_out_tensor);
-  TfLiteTensor* matmul2_out_tensor;
-  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
-                                              /*index=*/kMatMul2TempTensorIndex,
-                                              &matmul2_out_tensor));
-  auto matmul2_out_shape = GetTensorShape(matmul2_out_tensor);
-  auto matmul2_out_data = GetTensorData<float>(matmul2_out_tensor);
-  TfLiteTensor* reshape_k_or_q_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kReshape1TempTensorIndex,
-                       &reshape_k_or_q_out_tensor));
-  auto reshape_k_or_q_out_shape = GetTensorShape(reshape_k_or_q_out_tensor);
-  auto reshape_k_or_q_out_data =
-      GetTensorData<float>(reshape_k_or_q_out_tensor);
-  TfLiteTensor* reshape_v_or_add_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kReshape2TempTensorIndex,
-                       &reshape_v_or_add_out_tensor));
-  auto reshape_v_or_add_out_shape = GetTensorShape(reshape_v_or_add_out_tensor);
-  auto reshape_v_or_add_out_data =
-      GetTensorData<float>(reshape_v_or_add_out_tensor);
-  TfLiteTensor* broadcast_k_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kBroadcastKTempTensorIndex,
-                       &broadcast_k_out_tensor));
-  auto broadcast_k_out_shape = GetTensorShape(broadcast_k_out_tensor);
-  auto broadcast_k_out_data = GetTensorData<float>(broadcast_k_out_tensor);
-  TfLiteTensor* broadcast_v_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kBroadcastVTempTensorIndex,
-                       &broadcast_v_out_tensor));
-  auto broadcast_v_out_shape = GetTensorShape(broadcast_v_out_tensor);
-  auto broadcast_v_out_data = GetTensorData<float>(broadcast_v_out_tensor);
+  TfLiteTensor* scratch_tensor;
+  TF_LITE_ENSURE_OK(context,
+                    GetTemporarySafe(context, node,
+                                     /*index=*/kScratchTempTensorIndex,
+                                     &scratch_tensor));
 
   OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
 
-  bool mqa = key_tensor->dims->data[2] == 1;
-  bool gqa = !mqa && (key_tensor->dims->data[2] != query_tensor->dims->data[2]);
-
-  // scale * q
-  float scale = op_data->scale;
-  int flat_size = query_shape.FlatSize();
-  float output_min = -std::numeric_limits<float>::infinity();
-  float output_max = std::numeric_limits<float>::infinity();
-  for (int i = 0; i < flat_size; ++i) {
-    query_tensor->data.f[i] = ActivationFunctionWithMinMax(
-        query_tensor->data.f[i] * scale, output_min, output_max);
+  AttentionParams params;
+  params.query = GetTensorData<float>(query_tensor);
+  params.key = GetKvData(key_tensor);
+  params.value = GetKvData(value_tensor);
+  params.mask = GetTensorData<float>(attention_mask_tensor);
+  params.output = GetTensorData<float>(output_tensor);
+  params.batch_size = SizeOfDimension(query_tensor, 0);
+  params.query_len = SizeOfDimension(query_tensor, 1);
+  params.num_heads = SizeOfDimension(query_tensor, 2);
+  params.scale = op_data->scale;
+  int mask_stride = 1;
+  for (int i = 3; i >= 0; --i) {
+    const int mask_dim = SizeOfDimension(attention_mask_tensor, i);
+    params.mask_strides[i] = mask_dim == 1 ? 0 : mask_stride;
+    mask_stride *= mask_dim;
   }
 
-  // permute q {0, 2, 1, 3}
-  tflite::TransposeParams transpose_q_params;
-  transpose_q_params.perm_count = 4;
-  transpose_q_params.perm[0] = 0;
-  transpose_q_params.perm[1] = 2;
-  transpose_q_params.perm[2] = 1;
-  transpose_q_params.perm[3] = 3;
-  reference_ops::Transpose(transpose_q_params, query_shape, query_data,
-                           transpose_q_out_shape, transpose_q_out_data);
-
-  // permute k {0, 2, 1, 3}
-  tflite::TransposeParams transpose_k_params;
-  transpose_k_params.perm_count = 4;
-  transpose_k_params.perm[0] = 0;
-  transpose_k_params.perm[1] = 2;
-  transpose_k_params.perm[2] = 1;
-  transpose_k_params.perm[3] = 3;
-  reference_ops::Transpose(transpose_k_params, key_shape, key_data,
-                           transpose_k_out_shape, transpose_k_out_data);
-
-  // broadcast k to match num_heads
-  // broadcasting similar to torch.repeat_interleave
-  if (gqa) {
-    float* transpose_k_ptr = transpose_k_out_data;
-    float* broadcast_k_ptr = broadcast_k_out_data;
-    int num_elements =
-        transpose_k_out_shape.Dims(2) * transpose_k_out_shape.Dims(3);
-    int num_repeat =
-        broadcast_k_out_shape.Dims(1) / transpose_k_out_shape.Dims(1);
-    for (int i = 0; i < transpose_k_out_shape.Dims(0); ++i) {
-      for (int j = 0; j < transpose_k_out_shape.Dims(1); ++j) {
-        for (int k = 0; k < num_repeat; ++k) {
-          memcpy(broadcast_k_ptr, transpose_k_ptr,
-                 num_elements * sizeof(float));
-          broadcast_k_ptr += num_elements;
-        }
-        transpose_k_ptr += num_elements;
-      }
-    }
+  const int rows_per_kv_head =
+      params.num_heads / params.key.num_heads * params.query_len;
+  const int num_tiles =
+      params.batch_size * params.key.num_heads *
+      ((rows_per_kv_head + kQueryTileSize - 1) / kQueryTileSize);
+
+  CpuBackendContext* cpu_backend_context =
+      CpuBackendContext::GetFromContext(context);
+  // The scratch tensor holds memory for as many threads as were available
+  // during Prepare.
+  const int thread_count =
+      std::min({std::max(1, cpu_backend_context->max_num_threads()),
+                SizeOfDimension(scratch_tensor, 0), num_tiles});
+  if (thread_count <= 0) {
+    return kTfLiteOk;
   }
-
-  // reshape k for MQA, or transpose q for MHA
-  if (mqa) {
-    TF_LITE_ENSURE_EQ(context, transpose_k_out_tensor->bytes,
-                      reshape_k_or_q_out_tensor->bytes);
-    memcpy(reshape_k_or_q_out_tensor->data.data,
-           transpose_k_out_tensor->data.data, transpose_k_out_tensor->bytes);
-  } else {
-    // permute q2 {0, 1, 3, 2}
-    tflite::TransposeParams transpose_q2_params;
-    transpose_q2_params.perm_count = 4;
-    transpose_q2_params.perm[0] = 0;
-    transpose_q2_params.perm[1] = 1;
-    transpose_q2_params.perm[2] = 3;
-    transpose_q2_params.perm[3] = 2;
-    reference_ops::Transpose(transpose_q2_params, transpose_q_out_shape,
-                             transpose_q_out_data, reshape_k_or_q_out_shape,
-                             reshape_k_or_q_out_data);
+  const int scratch_size = SizeOfDimension(scratch_tensor, 1);
+  float* scratch = GetTensorData<float>(scratch_tensor);
+  std::vector<SDPAWorkerTask> tasks;
+  tasks.reserve(thread_count);
+  int start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    int end = start + (num_tiles - start) / (thread_count - i);
+    tasks.emplace_back(&params, start, end, scratch + i * scratch_size);
+    start = end;
   }
-
-  // mqa FC (q, squeezed_k)
-  // mha BMM(q, k) transpose_b = true
-  if (mqa) {
-    tflite::FullyConnectedParams fc_params;
-    fc_params.float_activation_min = output_min;
-    fc_params.float_activation_max = output_max;
-    reference_ops::FullyConnected(
-        fc_params, transpose_q_out_shape, transpose_q_out_data,
-        reshape_k_or_q_out_shape, reshape_k_or_q_out_data, RuntimeShape(),
-        nullptr, matmul1_out_shape, matmul1_out_data);
-  } else if (gqa) {
-    // pass rhs first (this is why we transpose q above)
-    reference_ops::BatchMatMul(
-        broadcast_k_out_shape, broadcast_k_out_data, reshape_k_or_q_out_shape,
-        reshape_k_or_q_out_data, matmul1_out_shape, matmul1_out_data);
-  } else {
-    reference_ops::BatchMatMul(
-        transpose_k_out_shape, transpose_k_out_data, reshape_k_or_q_out_shape,
-        reshape_k_or_q_out_data, matmul1_out_shape, matmul1_out_data);
-  }
-
-  // add matmul_out + mask
-  tflite::ArithmeticParams add_params;
-  SetActivationParams(output_min, output_max, &add_params);
-  reference_ops::BroadcastAdd6DSlow(
-      add_params, attention_mask_shape, attention_mask_data, matmul1_out_shape,
-      matmul1_out_data, add_out_shape, add_out_data);
-
-  // softmax, can do in-place
-  tflite::SoftmaxParams softmax_params;
-  softmax_params.beta = 1.0f;
-  reference_ops::Softmax(softmax_params, add_out_shape, add_out_data,
-                         add_out_shape, add_out_data);
-
-  // permute v {0, 2, 3, 1}
-  tflite::TransposeParams transpose_v_params;
-  transpose_v_params.perm_count = 4;
-  transpose_v_params.perm[0] = 0;
-  transpose_v_params.perm[1] = 2;
-  transpose_v_params.perm[2] = 3;
-  transpose_v_params.perm[3] = 1;
-  reference_ops::Transpose(transpose_v_params, value_shape, value_data,
-                           transpose_v_out_shape, transpose_v_out_data);
-
-  // broadcast v to match num_heads
-  // broadcasting similar to torch.repeat_interleave
-  if (gqa) {
-    float* transpose_v_ptr = transpose_v_out_data;
-    float* broadcast_v_ptr = broadcast_v_out_data;
-    int num_elements =
-        transpose_v_out_shape.Dims(2) * transpose_v_out_shape.Dims(3);
-    int num_repeat =
-        broadcast_v_out_shape.Dims(1) / transpose_v_out_shape.Dims(1);
-    for (int i = 0; i < transpose_v_out_shape.Dims(0); ++i) {
-      for (int j = 0; j < transpose_v_out_shape.Dims(1); ++j) {
-        for (int k = 0; k < num_repeat; ++k) {
-          memcpy(broadcast_v_ptr, transpose_v_ptr,
-                 num_elements * sizeof(float));
-          broadcast_v_ptr += num_elements;
-        }
-        transpose_v_ptr += num_elements;
-      }
-    }
-  }
-
-  // reshape v for MQA, or add_out (softmax_out)
-  if (mqa) {
-    TF_LITE_ENSURE_EQ(context, transpose_v_out_tensor->bytes,
-                      reshape_v_or_add_out_tensor->bytes);
-    memcpy(reshape_v_or_add_out_tensor->data.data,
-           transpose_v_out_tensor->data.data, transpose_v_out_tensor->bytes);
-  } else {
-    // permute softmax_out {0, 1, 3, 2}
-    tflite::TransposeParams transpose_softmax_out_params;
-    transpose_softmax_out_params.perm_count = 4;
-    transpose_softmax_out_params.perm[0] = 0;
-    transpose_softmax_out_params.perm[1] = 1;
-    transpose_softmax_out_params.perm[2] = 3;
-    transpose_softmax_out_params.perm[3] = 2;
-    reference_ops::Transpose(transpose_softmax_out_params, add_out_shape,
-                             add_out_data, reshape_v_or_add_out_shape,
-                             reshape_v_or_add_out_data);
-  }
-
-  // mqa FC (softmax_out, squeezed_v)
-  // mha BMM(softmax_out, v) transpose_b = true
-  if (mqa) {
-    tflite::FullyConnectedParams fc_params;
-    fc_params.float_activation_min = output_min;
-    fc_params.float_activation_max = output_max;
-    reference_ops::FullyConnected(fc_params, add_out_shape, add_out_data,
-                                  reshape_v_or_add_out_shape,
-                                  reshape_v_or_add_out_data, RuntimeShape(),
-                                  nullptr, matmul2_out_shape, matmul2_out_data);
-  } else if (gqa) {
-    // pass rhs first (this is why we transpose add_out above)
-    reference_ops::BatchMatMul(
-        broadcast_v_out_shape, broadcast_v_out_data, reshape_v_or_add_out_shape,
-        reshape_v_or_add_out_data, matmul2_out_shape, matmul2_out_data);
-  } else {
-    reference_ops::BatchMatMul(
-        transpose_v_out_shape, transpose_v_out_data, reshape_v_or_add_out_shape,
-        reshape_v_or_add_out_data, matmul2_out_shape, matmul2_out_data);
-  }
-
-  // permute out {0, 2, 1, 3}
-  tflite::TransposeParams transpose_out_params;
-  transpose_out_params.perm_count = 4;
-  transpose_out_params.perm[0] = 0;
-  transpose_out_params.perm[1] = 2;
-  transpose_out_params.perm[2] = 1;
-  transpose_out_params.perm[3] = 3;
-  reference_ops::Transpose(transpose_out_params, matmul2_out_shape,
-                           matmul2_out_data, output_shape, output_data);
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
 
   return kTfLiteOk;
 }
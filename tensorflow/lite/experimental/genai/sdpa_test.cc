@@ -0,0 +1,423 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
+#include "flatbuffers/flexbuffers.h"
+#include "tensorflow/lite/c/c_api_types.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/types/half.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+// Query: [batch, query_len, num_heads, head_dim]
+// Key/value: [batch, kv_len, num_kv_heads, head_dim]
+// Mask: broadcastable to [batch, num_heads, query_len, kv_len]
+class SDPAOpModel : public SingleOpModel {
+ public:
+  SDPAOpModel(const TensorData& query, const TensorData& key,
+              const TensorData& value, const TensorData& mask,
+              float scale = 0.0f, int num_threads = -1) {
+    query_ = AddInput(query);
+    key_ = AddInput(key);
+    value_ = AddInput(value);
+    mask_ = AddInput(mask);
+    output_ = AddOutput({TensorType_FLOAT32, query.shape});
+
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() { fbb.Float("scale", scale); });
+    fbb.Finish();
+    SetCustomOp("odml.scaled_dot_product_attention", fbb.GetBuffer(),
+                ops::custom::Register_SDPA);
+    BuildInterpreter(
+        {GetShape(query_), GetShape(key_), GetShape(value_), GetShape(mask_)},
+        num_threads, /*allow_fp32_relax_to_fp16=*/false,
+        /*apply_delegate=*/true);
+  }
+
+  int query() const { return query_; }
+  int key() const { return key_; }
+  int value() const { return value_; }
+  int mask() const { return mask_; }
+
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+  // Bytes of temporary memory requested by the op.
+  size_t GetScratchBytes() {
+    const TfLiteNode& node = interpreter_->node_and_registration(0)->first;
+    size_t bytes = 0;
+    for (int i = 0; i < node.temporaries->size; ++i) {
+      bytes += interpreter_->tensor(node.temporaries->data[i])->bytes;
+    }
+    return bytes;
+  }
+
+  // Bytes of the arena that holds the inputs, the output and the
+  // temporaries of the op.
+  size_t GetArenaBytes() {
+    Subgraph::SubgraphAllocInfo alloc_info;
+    interpreter_->primary_subgraph().GetMemoryAllocInfo(&alloc_info);
+    return alloc_info.arena_size;
+  }
+
+ private:
+  int query_;
+  int key_;
+  int value_;
+  int mask_;
+  int output_;
+};
+
+struct AttentionShape {
+  int batch_size;
+  int query_len;
+  int num_heads;
+  int kv_len;
+  int num_kv_heads;
+  int head_dim;
+};
+
+std::vector<float> RandomVector(int size, float min, float max,
+                                std::mt19937* random_engine) {
+  std::uniform_real_distribution<float> distribution(min, max);
+  std::vector<float> result(size);
+  for (float& x : result) {
+    x = distribution(*random_engine);
+  }
+  return result;
+}
+
+// Softmax(scale * q @ k^T + mask) @ v with the full score matrix, in double
+// precision. `mask_shape` is the 4D shape of `mask`.
+std::vector<float> ReferenceAttention(const AttentionShape& shape,
+                                      const std::vector<float>& query,
+                                      const std::vector<float>& key,
+                                      const std::vector<float>& value,
+                                      const std::vector<float>& mask,
+                                      const std::vector<int>& mask_shape,
+                                      float scale) {
+  const int group_size = shape.num_heads / shape.num_kv_heads;
+  std::vector<float> output(query.size());
+  std::vector<double> scores(shape.kv_len);
+  for (int b = 0; b < shape.batch_size; ++b) {
+    for (int t = 0; t < shape.query_len; ++t) {
+      for (int n = 0; n < shape.num_heads; ++n) {
+        const int kv_head = n / group_size;
+        const int q_offset =
+            ((b * shape.query_len + t) * shape.num_heads + n) * shape.head_dim;
+        double max_score = -std::numeric_limits<double>::infinity();
+        for (int s = 0; s < shape.kv_len; ++s) {
+          const int kv_offset =
+              ((b * shape.kv_len + s) * shape.num_kv_heads + kv_head) *
+              shape.head_dim;
+          double score = 0.0;
+          for (int h = 0; h < shape.head_dim; ++h) {
+            score += static_cast<double>(query[q_offset + h]) *
+                     key[kv_offset + h];
+          }
+          const int mask_b = mask_shape[0] == 1 ? 0 : b;
+          const int mask_n = mask_shape[1] == 1 ? 0 : n;
+          const int mask_t = mask_shape[2] == 1 ? 0 : t;
+          const int mask_s = mask_shape[3] == 1 ? 0 : s;
+          scores[s] = score * scale +
+                      mask[((mask_b * mask_shape[1] + mask_n) * mask_shape[2] +
+                            mask_t) *
+                               mask_shape[3] +
+                           mask_s];
+          max_score = std::max(max_score, scores[s]);
+        }
+        double sum = 0.0;
+        for (double& score : scores) {
+          score = std::exp(score - max_score);
+          sum += score;
+        }
+        for (int h = 0; h < shape.head_dim; ++h) {
+          double result = 0.0;
+          for (int s = 0; s < shape.kv_len; ++s) {
+            result +=
+                scores[s] *
+                value[((b * shape.kv_len + s) * shape.num_kv_heads + kv_head) *
+                          shape.head_dim +
+                      h];
+          }
+          output[q_offset + h] = result / sum;
+        }
+      }
+    }
+  }
+  return output;
+}
+
+// Returns a causal mask of shape [1, 1, query_len, kv_len] for queries at the
+// last `query_len` positions.
+std::vector<float> CausalMask(int query_len, int kv_len) {
+  std::vector<float> mask(query_len * kv_len);
+  for (int t = 0; t < query_len; ++t) {
+    for (int s = 0; s < kv_len; ++s) {
+      mask[t * kv_len + s] = s <= kv_len - query_len + t
+                                 ? 0.0f
+                                 : -std::numeric_limits<float>::infinity();
+    }
+  }
+  return mask;
+}
+
+void TestFloatAttention(const AttentionShape& shape, int num_threads) {
+  std::mt19937 random_engine(42);
+  const std::vector<int> q_shape = {shape.batch_size, shape.query_len,
+                                    shape.num_heads, shape.head_dim};
+  const std::vector<int> kv_shape = {shape.batch_size, shape.kv_len,
+                                     shape.num_kv_heads, shape.head_dim};
+  const std::vector<int> mask_shape = {1, 1, shape.query_len, shape.kv_len};
+  SDPAOpModel model({TensorType_FLOAT32, q_shape},
+                    {TensorType_FLOAT32, kv_shape},
+                    {TensorType_FLOAT32, kv_shape},
+                    {TensorType_FLOAT32, mask_shape}, /*scale=*/0.0f,
+                    num_threads);
+  const std::vector<float> query = RandomVector(
+      shape.batch_size * shape.query_len * shape.num_heads * shape.head_dim,
+      -2.0f, 2.0f, &random_engine);
+  const int kv_size =
+      shape.batch_size * shape.kv_len * shape.num_kv_heads * shape.head_dim;
+  const std::vector<float> key =
+      RandomVector(kv_size, -1.0f, 1.0f, &random_engine);
+  const std::vector<float> value =
+      RandomVector(kv_size, -1.0f, 1.0f, &random_engine);
+  const std::vector<float> mask = CausalMask(shape.query_len, shape.kv_len);
+  model.PopulateTensor(model.query(), query);
+  model.PopulateTensor(model.key(), key);
+  model.PopulateTensor(model.value(), value);
+  model.PopulateTensor(model.mask(), mask);
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+
+  const float scale = 1.0f / std::sqrt(shape.head_dim);
+  EXPECT_THAT(model.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  ReferenceAttention(shape, query, key, value, mask,
+                                     mask_shape, scale),
+                  1e-5)));
+  // The query is scaled on the fly, not in place.
+  EXPECT_THAT(model.ExtractVector<float>(model.query()),
+              ElementsAreArray(query));
+}
+
+TEST(SDPAOpTest, MultiHeadAttention) {
+  TestFloatAttention({/*batch_size=*/2, /*query_len=*/3, /*num_heads=*/4,
+                      /*kv_len=*/5, /*num_kv_heads=*/4, /*head_dim=*/8},
+                     /*num_threads=*/1);
+}
+
+TEST(SDPAOpTest, GroupedQueryAttention) {
+  TestFloatAttention({/*batch_size=*/1, /*query_len=*/4, /*num_heads=*/8,
+                      /*kv_len=*/6, /*num_kv_heads=*/2, /*head_dim=*/4},
+                     /*num_threads=*/1);
+}
+
+TEST(SDPAOpTest, MultiQueryAttention) {
+  TestFloatAttention({/*batch_size=*/1, /*query_len=*/2, /*num_heads=*/4,
+                      /*kv_len=*/7, /*num_kv_heads=*/1, /*head_dim=*/6},
+                     /*num_threads=*/1);
+}
+
+TEST(SDPAOpTest, SpansSeveralKeyBlocksAndQueryTiles) {
+  TestFloatAttention({/*batch_size=*/1, /*query_len=*/9, /*num_heads=*/4,
+                      /*kv_len=*/200, /*num_kv_heads=*/2, /*head_dim=*/12},
+                     /*num_threads=*/1);
+}
+
+TEST(SDPAOpTest, MultiThreaded) {
+  TestFloatAttention({/*batch_size=*/2, /*query_len=*/5, /*num_heads=*/8,
+                      /*kv_len=*/70, /*num_kv_heads=*/4, /*head_dim=*/16},
+                     /*num_threads=*/4);
+}
+
+TEST(SDPAOpTest, FullMaskAndExplicitScale) {
+  const AttentionShape shape = {/*batch_size=*/2, /*query_len=*/2,
+                                /*num_heads=*/2, /*kv_len=*/3,
+                                /*num_kv_heads=*/2, /*head_dim=*/2};
+  const std::vector<int> q_shape = {2, 2, 2, 2};
+  const std::vector<int> kv_shape = {2, 3, 2, 2};
+  const std::vector<int> mask_shape = {2, 2, 2, 3};
+  SDPAOpModel model({TensorType_FLOAT32, q_shape},
+                    {TensorType_FLOAT32, kv_shape},
+                    {TensorType_FLOAT32, kv_shape},
+                    {TensorType_FLOAT32, mask_shape}, /*scale=*/0.25f);
+  std::mt19937 random_engine(7);
+  const std::vector<float> query =
+      RandomVector(16, -2.0f, 2.0f, &random_engine);
+  const std::vector<float> key = RandomVector(24, -1.0f, 1.0f, &random_engine);
+  const std::vector<float> value =
+      RandomVector(24, -1.0f, 1.0f, &random_engine);
+  const std::vector<float> mask =
+      RandomVector(24, -3.0f, 0.0f, &random_engine);
+  model.PopulateTensor(model.query(), query);
+  model.PopulateTensor(model.key(), key);
+  model.PopulateTensor(model.value(), value);
+  model.PopulateTensor(model.mask(), mask);
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(model.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  ReferenceAttention(shape, query, key, value, mask,
+                                     mask_shape, /*scale=*/0.25f),
+                  1e-5)));
+}
+
+TEST(SDPAOpTest, Float16KeyValue) {
+  const AttentionShape shape = {/*batch_size=*/1, /*query_len=*/3,
+                                /*num_heads=*/4, /*kv_len=*/80,
+                                /*num_kv_heads=*/2, /*head_dim=*/8};
+  const std::vector<int> q_shape = {1, 3, 4, 8};
+  const std::vector<int> kv_shape = {1, 80, 2, 8};
+  const std::vector<int> mask_shape = {1, 1, 3, 80};
+  SDPAOpModel model({TensorType_FLOAT32, q_shape},
+                    {TensorType_FLOAT16, kv_shape},
+                    {TensorType_FLOAT16, kv_shape},
+                    {TensorType_FLOAT32, mask_shape});
+  std::mt19937 random_engine(3);
+  const std::vector<float> query =
+      RandomVector(96, -2.0f, 2.0f, &random_engine);
+  std::vector<float> key = RandomVector(1280, -1.0f, 1.0f, &random_engine);
+  std::vector<float> value = RandomVector(1280, -1.0f, 1.0f, &random_engine);
+  const std::vector<float> mask = CausalMask(3, 80);
+  std::vector<half> key_half(key.begin(), key.end());
+  std::vector<half> value_half(value.begin(), value.end());
+  // Compare against the values that are actually representable in fp16.
+  key.assign(key_half.begin(), key_half.end());
+  value.assign(value_half.begin(), value_half.end());
+  model.PopulateTensor(model.query(), query);
+  model.PopulateTensor<half>(model.key(), key_half);
+  model.PopulateTensor<half>(model.value(), value_half);
+  model.PopulateTensor(model.mask(), mask);
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(model.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  ReferenceAttention(shape, query, key, value, mask,
+                                     mask_shape, 1.0f / std::sqrt(8.0f)),
+                  1e-5)));
+}
+
+TEST(SDPAOpTest, Int8KeyValue) {
+  const AttentionShape shape = {/*batch_size=*/1, /*query_len=*/2,
+                                /*num_heads=*/2, /*kv_len=*/70,
+                                /*num_kv_heads=*/1, /*head_dim=*/16};
+  const std::vector<int> q_shape = {1, 2, 2, 16};
+  const std::vector<int> kv_shape = {1, 70, 1, 16};
+  const std::vector<int> mask_shape = {1, 1, 2, 70};
+  SDPAOpModel model({TensorType_FLOAT32, q_shape},
+                    {TensorType_INT8, kv_shape, -1.0f, 1.0f},
+                    {TensorType_INT8, kv_shape, -2.0f, 1.5f},
+                    {TensorType_FLOAT32, mask_shape});
+  std::mt19937 random_engine(5);
+  const std::vector<float> query =
+      RandomVector(64, -2.0f, 2.0f, &random_engine);
+  const std::vector<float> key =
+      RandomVector(1120, -1.0f, 1.0f, &random_engine);
+  const std::vector<float> value =
+      RandomVector(1120, -2.0f, 1.5f, &random_engine);
+  const std::vector<float> mask = CausalMask(2, 70);
+  model.PopulateTensor(model.query(), query);
+  model.QuantizeAndPopulate<int8_t>(model.key(), key);
+  model.QuantizeAndPopulate<int8_t>(model.value(), value);
+  model.PopulateTensor(model.mask(), mask);
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+
+  // Compare against the dequantized keys and values.
+  const std::vector<float> dequantized_key =
+      Dequantize<int8_t>(model.ExtractVector<int8_t>(model.key()),
+                         model.GetScale(model.key()),
+                         model.GetZeroPoint(model.key()));
+  const std::vector<float> dequantized_value =
+      Dequantize<int8_t>(model.ExtractVector<int8_t>(model.value()),
+                         model.GetScale(model.value()),
+                         model.GetZeroPoint(model.value()));
+  EXPECT_THAT(
+      model.GetOutput(),
+      ElementsAreArray(ArrayFloatNear(
+          ReferenceAttention(shape, query, dequantized_key, dequantized_value,
+                             mask, mask_shape, 1.0f / std::sqrt(16.0f)),
+          1e-5)));
+}
+
+TEST(SDPAOpTest, ScratchDoesNotDependOnSequenceLength) {
+  const auto scratch_bytes = [](int kv_len) {
+    SDPAOpModel model({TensorType_FLOAT32, {1, 4, 8, 64}},
+                      {TensorType_FLOAT32, {1, kv_len, 2, 64}},
+                      {TensorType_FLOAT32, {1, kv_len, 2, 64}},
+                      {TensorType_FLOAT32, {1, 1, 4, kv_len}},
+                      /*scale=*/0.0f, /*num_threads=*/1);
+    return model.GetScratchBytes();
+  };
+  EXPECT_EQ(scratch_bytes(128), scratch_bytes(4096));
+}
+
+}  // namespace
+}  // namespace tflite
+
+// Attention of `query_len` new tokens over a KV cache of `kv_len` positions,
+// with 32 query heads sharing 8 KV heads of 128 dimensions. Reports the size
+// of the interpreter's arena, which grows with `kv_len` only through the
+// inputs.
+void BM_SDPA(benchmark::State& state) {
+  const int kv_len = state.range(0);
+  const int query_len = state.range(1);
+  const tflite::TensorType kv_type =
+      static_cast<tflite::TensorType>(state.range(2));
+  const int num_threads = state.range(3);
+  const std::vector<int> q_shape = {1, query_len, 32, 128};
+  const std::vector<int> kv_shape = {1, kv_len, 8, 128};
+
+  tflite::SDPAOpModel model(
+      {tflite::TensorType_FLOAT32, q_shape},
+      {kv_type, kv_shape, -1.0f, 1.0f}, {kv_type, kv_shape, -1.0f, 1.0f},
+      {tflite::TensorType_FLOAT32, {1, 1, query_len, kv_len}},
+      /*scale=*/0.0f, num_threads);
+  model.PopulateTensor(model.query(),
+                       std::vector<float>(query_len * 32 * 128, 0.5f));
+  model.PopulateTensor(model.mask(),
+                       std::vector<float>(query_len * kv_len, 0.0f));
+
+  for (auto _ : state) {
+    model.Invoke();
+  }
+  state.counters["tokens_per_second"] = benchmark::Counter(
+      query_len, benchmark::Counter::kIsIterationInvariantRate);
+  state.counters["arena_bytes"] = model.GetArenaBytes();
+}
+BENCHMARK(BM_SDPA)
+    ->ArgNames({"kv_len", "query_len", "kv_type", "threads"})
+    ->ArgsProduct({{2048, 8192, 32768},
+                   {1, 128},
+                   {tflite::TensorType_FLOAT32, tflite::TensorType_FLOAT16,
+                    tflite::TensorType_INT8},
+                   {1, 4}})
+    ->UseRealTime();
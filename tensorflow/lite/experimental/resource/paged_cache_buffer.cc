@@ -0,0 +1,199 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+
+namespace tflite {
+namespace resource {
+
+TfLiteStatus PagedCacheBuffer::Initialize(int num_layers, int entry_size,
+                                          int block_size, int max_num_blocks) {
+  if (num_layers <= 0 || entry_size <= 0 || block_size <= 0 ||
+      max_num_blocks < 0) {
+    return kTfLiteError;
+  }
+  num_layers_ = num_layers;
+  entry_size_ = entry_size;
+  block_size_ = block_size;
+  max_num_blocks_ = max_num_blocks;
+  block_num_elements_ = 2 * static_cast<size_t>(num_layers) * block_size *
+                        static_cast<size_t>(entry_size);
+  is_initialized_ = true;
+  return kTfLiteOk;
+}
+
+size_t PagedCacheBuffer::GetMemoryUsage() {
+  return blocks_.size() * block_num_elements_ * sizeof(float);
+}
+
+int PagedCacheBuffer::AllocateBlock() {
+  int block;
+  if (!free_blocks_.empty()) {
+    block = free_blocks_.back();
+    free_blocks_.pop_back();
+  } else if (max_num_blocks_ == 0 ||
+             blocks_.size() < static_cast<size_t>(max_num_blocks_)) {
+    block = blocks_.size();
+    blocks_.emplace_back(new float[block_num_elements_]);
+    ref_counts_.push_back(0);
+  } else {
+    return -1;
+  }
+  memset(GetBlock(block), 0, sizeof(float) * block_num_elements_);
+  ref_counts_[block] = 1;
+  return block;
+}
+
+void PagedCacheBuffer::UnreferenceBlock(int block) {
+  TFLITE_DCHECK_GT(ref_counts_[block], 0);
+  if (--ref_counts_[block] == 0) {
+    free_blocks_.push_back(block);
+  }
+}
+
+TfLiteStatus PagedCacheBuffer::Write(int sequence_id, int layer,
+                                     int64_t position, int num_positions,
+                                     const float* key, const float* value) {
+  if (!is_initialized_ || layer < 0 || layer >= num_layers_ || position < 0 ||
+      num_positions < 0) {
+    return kTfLiteError;
+  }
+  Sequence& sequence = sequences_[sequence_id];
+  if (sequence.num_entries.empty()) {
+    sequence.num_entries.resize(num_layers_, 0);
+  }
+
+  const size_t entry_bytes = sizeof(float) * entry_size_;
+  const size_t layer_elements =
+      static_cast<size_t>(block_size_) * entry_size_;
+  for (int i = 0; i < num_positions;) {
+    const int64_t current = position + i;
+    const size_t block_index = current / block_size_;
+    const int offset = current % block_size_;
+    const int count = std::min(num_positions - i, block_size_ - offset);
+    while (sequence.block_table.size() <= block_index) {
+      const int block = AllocateBlock();
+      if (block < 0) return kTfLiteError;
+      sequence.block_table.push_back(block);
+    }
+    int& block = sequence.block_table[block_index];
+    if (ref_counts_[block] > 1) {
+      // Copy on write.
+      const int copy = AllocateBlock();
+      if (copy < 0) return kTfLiteError;
+      memcpy(GetBlock(copy), GetBlock(block),
+             sizeof(float) * block_num_elements_);
+      UnreferenceBlock(block);
+      block = copy;
+    }
+    float* keys = GetBlock(block) + layer * layer_elements;
+    float* values = keys + num_layers_ * layer_elements;
+    memcpy(keys + offset * entry_size_, key + i * entry_size_,
+           count * entry_bytes);
+    memcpy(values + offset * entry_size_, value + i * entry_size_,
+           count * entry_bytes);
+    i += count;
+  }
+  int64_t& num_entries = sequence.num_entries[layer];
+  num_entries = std::max(num_entries, position + num_positions);
+  return kTfLiteOk;
+}
+
+void PagedCacheBuffer::Read(int sequence_id, int layer, int64_t num_positions,
+                            float* key, float* value) const {
+  const size_t layer_elements =
+      static_cast<size_t>(block_size_) * entry_size_;
+  int64_t position = 0;
+  auto it = sequences_.find(sequence_id);
+  if (it != sequences_.end()) {
+    for (const int block : it->second.block_table) {
+      if (position >= num_positions) break;
+      const int64_t count =
+          std::min<int64_t>(block_size_, num_positions - position);
+      const float* keys = GetBlock(block) + layer * layer_elements;
+      const float* values = keys + num_layers_ * layer_elements;
+      memcpy(key + position * entry_size_, keys,
+             sizeof(float) * count * entry_size_);
+      memcpy(value + position * entry_size_, values,
+             sizeof(float) * count * entry_size_);
+      position += count;
+    }
+  }
+  if (position < num_positions) {
+    const size_t tail = (num_positions - position) * entry_size_;
+    memset(key + position * entry_size_, 0, sizeof(float) * tail);
+    memset(value + position * entry_size_, 0, sizeof(float) * tail);
+  }
+}
+
+TfLiteStatus PagedCacheBuffer::ForkSequence(int source_id, int target_id) {
+  if (source_id == target_id) return kTfLiteOk;
+  auto it = sequences_.find(source_id);
+  if (it == sequences_.end()) return kTfLiteError;
+  // References to map elements, unlike iterators, survive the erase and the
+  // insertion below.
+  const Sequence& source = it->second;
+  ReleaseSequence(target_id);
+  Sequence& target = sequences_[target_id];
+  target = source;
+  for (const int block : target.block_table) {
+    ++ref_counts_[block];
+  }
+  return kTfLiteOk;
+}
+
+void PagedCacheBuffer::ReleaseSequence(int sequence_id) {
+  auto it = sequences_.find(sequence_id);
+  if (it == sequences_.end()) return;
+  for (const int block : it->second.block_table) {
+    UnreferenceBlock(block);
+  }
+  sequences_.erase(it);
+}
+
+int64_t PagedCacheBuffer::GetNumEntries(int sequence_id, int layer) const {
+  auto it = sequences_.find(sequence_id);
+  if (it == sequences_.end() || it->second.num_entries.empty()) return 0;
+  return it->second.num_entries[layer];
+}
+
+int PagedCacheBuffer::GetNumUsedBlocks() const {
+  return blocks_.size() - free_blocks_.size();
+}
+
+TfLiteStatus CreatePagedCacheBufferIfNotAvailable(ResourceMap* resources,
+                                                  int resource_id) {
+  return CreateTypedResourceIfNotAvailable(
+      resources, resource_id, ResourceBase::ResourceType::kPagedCacheBuffer,
+      []() { return std::make_unique<PagedCacheBuffer>(); });
+}
+
+PagedCacheBuffer* GetPagedCacheBuffer(ResourceMap* resources, int resource_id) {
+  return GetTypedResource<PagedCacheBuffer>(
+      resources, resource_id, ResourceBase::ResourceType::kPagedCacheBuffer);
+}
+
+}  // namespace resource
+}  // namespace tflite
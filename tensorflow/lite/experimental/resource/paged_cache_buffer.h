@@ -0,0 +1,139 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_CACHE_BUFFER_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_CACHE_BUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/resource/resource_base.h"
+
+namespace tflite {
+namespace resource {
+
+/// WARNING: Experimental interface, subject to change.
+// A paged cache for the keys and values of the attention layers of a
+// transformer, shared by many sequences.
+//
+// Storage is split into blocks of `block_size` positions. Each block holds the
+// keys and values of all layers for those positions. Blocks are allocated as
+// sequences grow, and each sequence maps its positions to blocks with a block
+// table. A sequence therefore only uses memory for the positions it has
+// written, instead of the maximum sequence length.
+//
+// Blocks are reference counted so that sequences can share a common prefix
+// (see `ForkSequence`). A shared block is copied the first time one of its
+// sequences writes to it.
+class PagedCacheBuffer : public ResourceBase {
+ public:
+  PagedCacheBuffer() = default;
+  PagedCacheBuffer(const PagedCacheBuffer&) = delete;
+  PagedCacheBuffer& operator=(const PagedCacheBuffer&) = delete;
+
+  ResourceType GetResourceType() const override {
+    return ResourceType::kPagedCacheBuffer;
+  }
+
+  // Sets the geometry of the cache. `entry_size` is the number of floats of
+  // the key (or value) of one position of one layer, i.e. num_heads *
+  // head_dim. No more than `max_num_blocks` blocks are allocated; 0 means no
+  // limit.
+  TfLiteStatus Initialize(int num_layers, int entry_size, int block_size,
+                          int max_num_blocks);
+
+  bool IsInitialized() override { return is_initialized_; }
+
+  // Returns the bytes of all allocated blocks, including free ones.
+  size_t GetMemoryUsage() override;
+
+  // Writes `num_positions` consecutive keys and values of `layer` for
+  // `sequence_id`, starting at `position`. Allocates the blocks that the
+  // positions fall into, and copies shared blocks before writing to them.
+  // Creates the sequence if it doesn't exist.
+  TfLiteStatus Write(int sequence_id, int layer, int64_t position,
+                     int num_positions, const float* key, const float* value);
+
+  // Copies the first `num_positions` keys and values of `layer` for
+  // `sequence_id` into the contiguous [num_positions, entry_size] arrays `key`
+  // and `value`. Positions that were never written read as zeros.
+  void Read(int sequence_id, int layer, int64_t num_positions, float* key,
+            float* value) const;
+
+  // Makes `target_id` share all the blocks of `source_id`, so that both
+  // sequences continue from the same prefix. `target_id` is released first if
+  // it exists.
+  TfLiteStatus ForkSequence(int source_id, int target_id);
+
+  // Drops `sequence_id` and frees the blocks that no other sequence uses.
+  void ReleaseSequence(int sequence_id);
+
+  // Returns the number of positions of `layer` that have been written for
+  // `sequence_id`, i.e. one past the largest written position.
+  int64_t GetNumEntries(int sequence_id, int layer) const;
+
+  // Returns the number of blocks in use by at least one sequence.
+  int GetNumUsedBlocks() const;
+
+  int num_layers() const { return num_layers_; }
+  int entry_size() const { return entry_size_; }
+  int block_size() const { return block_size_; }
+
+ private:
+  struct Sequence {
+    // Block index of each group of `block_size_` positions.
+    std::vector<int> block_table;
+    // Number of written positions of each layer.
+    std::vector<int64_t> num_entries;
+  };
+
+  // Returns the index of a block that isn't used by any sequence, or -1 if
+  // `max_num_blocks_` blocks are used.
+  int AllocateBlock();
+  void UnreferenceBlock(int block);
+  float* GetBlock(int block) { return blocks_[block].get(); }
+  const float* GetBlock(int block) const { return blocks_[block].get(); }
+
+  int num_layers_ = 0;
+  int entry_size_ = 0;
+  int block_size_ = 0;
+  int max_num_blocks_ = 0;
+  // Floats per block: keys then values of each layer, each layer holding
+  // `block_size_` entries.
+  size_t block_num_elements_ = 0;
+  std::vector<std::unique_ptr<float[]>> blocks_;
+  std::vector<int> ref_counts_;
+  std::vector<int> free_blocks_;
+  std::unordered_map<int, Sequence> sequences_;
+  bool is_initialized_ = false;
+};
+
+// Creates a paged cache buffer with the given resource id if there isn't one
+// yet. Returns kTfLiteError if the id is used by a resource of another type.
+// WARNING: Experimental interface, subject to change.
+TfLiteStatus CreatePagedCacheBufferIfNotAvailable(ResourceMap* resources,
+                                                  int resource_id);
+
+// Returns the corresponding paged cache buffer, or nullptr if none.
+// WARNING: Experimental interface, subject to change.
+PagedCacheBuffer* GetPagedCacheBuffer(ResourceMap* resources, int resource_id);
+
+}  // namespace resource
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_CACHE_BUFFER_H_
@@ -0,0 +1,147 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/experimental/resource/resource_base.h"
+
+namespace tflite {
+namespace resource {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Cache with 2 layers, entries of 2 floats and blocks of 2 positions.
+class PagedCacheBufferTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(cache_.Initialize(/*num_layers=*/2, /*entry_size=*/2,
+                                /*block_size=*/2, /*max_num_blocks=*/4),
+              kTfLiteOk);
+  }
+
+  std::vector<float> ReadKeys(int sequence_id, int layer, int num_positions) {
+    std::vector<float> key(num_positions * 2);
+    std::vector<float> value(num_positions * 2);
+    cache_.Read(sequence_id, layer, num_positions, key.data(), value.data());
+    return key;
+  }
+
+  std::vector<float> ReadValues(int sequence_id, int layer,
+                                int num_positions) {
+    std::vector<float> key(num_positions * 2);
+    std::vector<float> value(num_positions * 2);
+    cache_.Read(sequence_id, layer, num_positions, key.data(), value.data());
+    return value;
+  }
+
+  PagedCacheBuffer cache_;
+};
+
+TEST_F(PagedCacheBufferTest, WriteAndRead) {
+  EXPECT_TRUE(cache_.IsInitialized());
+  const std::vector<float> key = {1, 2, 3, 4, 5, 6};
+  const std::vector<float> value = {-1, -2, -3, -4, -5, -6};
+  ASSERT_EQ(cache_.Write(/*sequence_id=*/0, /*layer=*/1, /*position=*/0,
+                         /*num_positions=*/3, key.data(), value.data()),
+            kTfLiteOk);
+
+  EXPECT_EQ(cache_.GetNumEntries(0, 1), 3);
+  EXPECT_EQ(cache_.GetNumEntries(0, 0), 0);
+  EXPECT_EQ(cache_.GetNumUsedBlocks(), 2);
+  EXPECT_THAT(ReadKeys(0, 1, 4), ElementsAre(1, 2, 3, 4, 5, 6, 0, 0));
+  EXPECT_THAT(ReadValues(0, 1, 4), ElementsAre(-1, -2, -3, -4, -5, -6, 0, 0));
+  // Layer 0 shares the blocks but was never written.
+  EXPECT_THAT(ReadKeys(0, 0, 2), ElementsAre(0, 0, 0, 0));
+  // Unknown sequences read as zeros.
+  EXPECT_THAT(ReadKeys(1, 1, 1), ElementsAre(0, 0));
+}
+
+TEST_F(PagedCacheBufferTest, AppendAcrossBlocks) {
+  const std::vector<float> entry = {7, 8};
+  for (int position = 0; position < 3; ++position) {
+    ASSERT_EQ(
+        cache_.Write(0, 0, position, 1, entry.data(), entry.data()),
+        kTfLiteOk);
+  }
+  EXPECT_EQ(cache_.GetNumEntries(0, 0), 3);
+  EXPECT_EQ(cache_.GetNumUsedBlocks(), 2);
+  EXPECT_THAT(ReadKeys(0, 0, 3), ElementsAre(7, 8, 7, 8, 7, 8));
+}
+
+TEST_F(PagedCacheBufferTest, ForkSharesBlocksUntilWritten) {
+  const std::vector<float> prefix = {1, 2, 3, 4, 5, 6};
+  ASSERT_EQ(cache_.Write(0, 0, 0, 3, prefix.data(), prefix.data()),
+            kTfLiteOk);
+  ASSERT_EQ(cache_.ForkSequence(0, 1), kTfLiteOk);
+  EXPECT_EQ(cache_.GetNumUsedBlocks(), 2);
+  EXPECT_EQ(cache_.GetNumEntries(1, 0), 3);
+
+  // Writing to the shared, partially filled block copies it.
+  const std::vector<float> suffix = {9, 9};
+  ASSERT_EQ(cache_.Write(1, 0, 3, 1, suffix.data(), suffix.data()),
+            kTfLiteOk);
+  EXPECT_EQ(cache_.GetNumUsedBlocks(), 3);
+  EXPECT_THAT(ReadKeys(0, 0, 4), ElementsAre(1, 2, 3, 4, 5, 6, 0, 0));
+  EXPECT_THAT(ReadKeys(1, 0, 4), ElementsAre(1, 2, 3, 4, 5, 6, 9, 9));
+
+  // The first block is still shared, so releasing the source keeps it.
+  cache_.ReleaseSequence(0);
+  EXPECT_EQ(cache_.GetNumUsedBlocks(), 2);
+  EXPECT_THAT(ReadKeys(1, 0, 4), ElementsAre(1, 2, 3, 4, 5, 6, 9, 9));
+  cache_.ReleaseSequence(1);
+  EXPECT_EQ(cache_.GetNumUsedBlocks(), 0);
+}
+
+TEST_F(PagedCacheBufferTest, ForkUnknownSequenceFails) {
+  EXPECT_EQ(cache_.ForkSequence(0, 1), kTfLiteError);
+}
+
+TEST_F(PagedCacheBufferTest, ReusesFreedBlocks) {
+  const std::vector<float> entries(16, 1.0f);
+  ASSERT_EQ(cache_.Write(0, 0, 0, 8, entries.data(), entries.data()),
+            kTfLiteOk);
+  const size_t memory_usage = cache_.GetMemoryUsage();
+  EXPECT_EQ(memory_usage, 4 * 2 * 2 * 2 * 2 * sizeof(float));
+  // All 4 blocks are in use.
+  EXPECT_EQ(cache_.Write(1, 0, 0, 1, entries.data(), entries.data()),
+            kTfLiteError);
+
+  cache_.ReleaseSequence(0);
+  ASSERT_EQ(cache_.Write(1, 0, 0, 1, entries.data(), entries.data()),
+            kTfLiteOk);
+  EXPECT_EQ(cache_.GetMemoryUsage(), memory_usage);
+  // Recycled blocks are cleared.
+  EXPECT_THAT(ReadKeys(1, 0, 2), ElementsAre(1, 1, 0, 0));
+}
+
+TEST(PagedCacheBufferResourceTest, CreateAndGet) {
+  ResourceMap resources;
+  EXPECT_EQ(GetPagedCacheBuffer(&resources, 1), nullptr);
+  ASSERT_EQ(CreatePagedCacheBufferIfNotAvailable(&resources, 1), kTfLiteOk);
+  PagedCacheBuffer* cache = GetPagedCacheBuffer(&resources, 1);
+  ASSERT_NE(cache, nullptr);
+  EXPECT_FALSE(cache->IsInitialized());
+  ASSERT_EQ(CreatePagedCacheBufferIfNotAvailable(&resources, 1), kTfLiteOk);
+  EXPECT_EQ(GetPagedCacheBuffer(&resources, 1), cache);
+}
+
+}  // namespace
+}  // namespace resource
+}  // namespace tflite
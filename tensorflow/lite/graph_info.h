@@ -62,6 +62,14 @@ class GraphInfo {
   // Expected to be between 0 and num_total_nodes().
   virtual size_t node_index(size_t index) const = 0;
 
+  // Returns the first and last execution plan indices of the nodes that may
+  // run concurrently with the node at execution plan index `index`, including
+  // it. The tensors used by these nodes must not share memory with each other.
+  // By default, nodes run one at a time.
+  virtual std::pair<size_t, size_t> concurrent_node_range(size_t index) const {
+    return {index, index};
+  }
+
   // Returns the indices of the input tensors.
   virtual const std::vector<int>& inputs() const = 0;
 
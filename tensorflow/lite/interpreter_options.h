@@ -19,6 +19,8 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_INTERPRETER_OPTIONS_H_
 #define TENSORFLOW_LITE_INTERPRETER_OPTIONS_H_
 
+#include <string>
+
 namespace tflite {
 
 /// Options class for `Interpreter`.
@@ -170,6 +172,48 @@ class InterpreterOptions {
     return experimental_force_delegate_node_profiling_;
   }
 
+  /// If not empty, the arena allocation plan of subgraph `i` is cached in the
+  /// file `<path>.<i>`. `AllocateTensors()` reuses a cached plan instead of
+  /// recomputing the tensor offsets when the model and tensor sizes haven't
+  /// changed since the plan was saved, and saves a new plan otherwise.
+  /// The files must only be shared by interpreters of the same model.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetArenaPlanCachePath(const std::string& path) {
+    experimental_arena_plan_cache_path_ = path;
+  }
+
+  /// Returns the prefix of the arena allocation plan cache files.
+  /// WARNING: This is an experimental API and subject to change.
+  const std::string& GetArenaPlanCachePath() const {
+    return experimental_arena_plan_cache_path_;
+  }
+
+  /// Runs the nodes of each subgraph that don't depend on each other
+  /// concurrently, on up to `num_threads` threads including the one calling
+  /// `Invoke()`. Values below 2 run the nodes one at a time, which is the
+  /// default. This is independent of the intra-op threads set with
+  /// `SetNumThreads()`, which kernels use to split a single node.
+  ///
+  /// The execution plan is reordered so that independent nodes are adjacent,
+  /// and tensors used by nodes that may run at the same time never share
+  /// memory, which may increase the arena size. Nodes that aren't known to be
+  /// thread-safe (delegate kernels, custom ops, control flow, resources...)
+  /// still run alone, and kernels using the shared CPU backend (e.g.
+  /// FULLY_CONNECTED, CONV_2D) don't run concurrently with each other.
+  /// Subgraphs with dynamic tensors, or with a profiler installed, run
+  /// sequentially. This must be set before `AllocateTensors()`.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetInterOpParallelism(int num_threads) {
+    experimental_inter_op_parallelism_ = num_threads;
+  }
+
+  /// Returns the number of threads running independent nodes concurrently,
+  /// or a value below 2 if the nodes run one at a time.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetInterOpParallelism() const {
+    return experimental_inter_op_parallelism_;
+  }
+
  private:
   bool experimental_preserve_all_tensors_ = false;
   bool experimental_ensure_dynamic_tensors_are_released_ = false;
@@ -181,6 +225,8 @@ class InterpreterOptions {
   bool experimental_compress_quantization_zero_points_ = false;
   bool experimental_disable_delegate_node_fusion_ = false;
   bool experimental_force_delegate_node_profiling_ = false;
+  std::string experimental_arena_plan_cache_path_;
+  int experimental_inter_op_parallelism_ = 1;
 };
 
 }  // namespace tflite
@@ -22,6 +22,7 @@ limitations under the License.
 #include <cstdint>
 #include <cstdlib>
 #include <limits>
+#include <memory>
 
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
@@ -33,6 +34,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/internal/types.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/prepacked_weights_cache.h"
 
 namespace tflite {
 namespace ops {
@@ -59,6 +61,9 @@ struct OpData {
   int scratch_tensor_index;
   bool rhs_transposed;
   bool compute_row_sums = false;
+  // The transposed RHS, when it's constant and shared with the other
+  // interpreters of the model.
+  std::shared_ptr<const PrepackedWeights> shared_rhs_transposed;
 };
 
 struct OpContext {
@@ -114,6 +119,10 @@ TfLiteStatus ResizeOutputTensor(TfLiteContext* context,
   return stat;
 }
 
+TfLiteStatus TransposeRowsColumns(TfLiteContext* context,
+                                  const TfLiteTensor* tensor_in,
+                                  TfLiteTensor* tensor_out);
+
 // Initializes temp tensors to store transposed operands.
 TfLiteStatus InitializeTemporaries(TfLiteContext* context, TfLiteNode* node,
                                    OpContext* op_context) {
@@ -183,14 +192,31 @@ TfLiteStatus InitializeTemporaries(TfLiteContext* context, TfLiteNode* node,
     scratch_buffer_size->data[rhs_rank - 2] = rhs->dims->data[rhs_rank - 1];
     scratch_buffer_size->data[rhs_rank - 1] = rhs->dims->data[rhs_rank - 2];
 
-    if (IsConstantTensor(op_context->rhs)) {
-      scratch_buffer->allocation_type = kTfLiteArenaRwPersistent;
+    scratch_buffer->type = op_context->rhs->type;
+    if (!op_context->params->adj_y && CanSharePrepackedWeights(rhs) &&
+        (rhs->type == kTfLiteFloat32 || rhs->type == kTfLiteInt8 ||
+         rhs->type == kTfLiteInt16)) {
+      // The RHS is only transposed once for all the interpreters of the
+      // model.
+      TF_LITE_ENSURE_OK(
+          context,
+          ResizeAndSharePrepackedWeights(
+              context, rhs, WeightsPackingFormat::kBatchMatMulTransposedRhs,
+              scratch_buffer_size, scratch_buffer,
+              [context, rhs](TfLiteTensor* packed) {
+                TransposeRowsColumns(context, rhs, packed);
+              },
+              &op_data->shared_rhs_transposed));
+      op_data->rhs_transposed = true;
     } else {
-      scratch_buffer->allocation_type = kTfLiteArenaRw;
+      if (IsConstantTensor(op_context->rhs)) {
+        scratch_buffer->allocation_type = kTfLiteArenaRwPersistent;
+      } else {
+        scratch_buffer->allocation_type = kTfLiteArenaRw;
+      }
+      TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
+                                                       scratch_buffer_size));
     }
-    scratch_buffer->type = op_context->rhs->type;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
   }
 
   // If we have to perform on-the-fly quantization (with quantized weights and
@@ -48,6 +48,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/kernels/prepacked_weights_cache.h"
 #include "tensorflow/lite/util.h"
 
 namespace tflite {
@@ -111,6 +112,9 @@ struct OpData {
 
   bool need_hwcn_weights = false;
   bool have_weights_been_transposed = false;
+  // The HWCN weights, when they're shared with the other interpreters of the
+  // model.
+  std::shared_ptr<const PrepackedWeights> shared_hwcn_weights;
   bool need_im2col = false;
   // If it's true, it means im2col is needed but gets disabled because the
   // temporary im2col tensor requires too much memory (i.e.
@@ -637,15 +641,27 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
         &context->tensors[node->temporaries->data[data->hwcn_weights_index]];
     hwcn_weights->type = input_type;
     hwcn_weights->name = "Conv_hwcn_weights";
-    hwcn_weights->allocation_type = kTfLiteArenaRwPersistent;
+    if (CanSharePrepackedWeights(filter)) {
+      // All the interpreters of the model share one transposed copy.
+      TF_LITE_ENSURE_STATUS(ResizeAndSharePrepackedWeights(
+          context, filter, WeightsPackingFormat::kConvHwcn,
+          hwcn_weights_size.release(), hwcn_weights,
+          [filter](TfLiteTensor* packed) {
+            TransposeFloatTensor(filter, packed);
+          },
+          &data->shared_hwcn_weights));
+      data->have_weights_been_transposed = true;
+    } else {
+      hwcn_weights->allocation_type = kTfLiteArenaRwPersistent;
 
-    auto hwcn_weights_status = context->ResizeTensor(
-        context, hwcn_weights, hwcn_weights_size.release());
-    if (hwcn_weights_status != kTfLiteOk) return hwcn_weights_status;
+      auto hwcn_weights_status = context->ResizeTensor(
+          context, hwcn_weights, hwcn_weights_size.release());
+      if (hwcn_weights_status != kTfLiteOk) return hwcn_weights_status;
 
-    // TODO(petewarden): If Resize() is called when the size hasn't actually
-    // changed, this will do extra redundant work.
-    data->have_weights_been_transposed = false;
+      // TODO(petewarden): If Resize() is called when the size hasn't actually
+      // changed, this will do extra redundant work.
+      data->have_weights_been_transposed = false;
+    }
   }
 
   if (is_hybrid) {
@@ -0,0 +1,127 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/prepacked_weights_cache.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <tuple>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+
+bool PrepackedWeightsCache::Key::operator<(const Key& other) const {
+  return std::tie(weights, weights_bytes, format, packed_type, packed_dims) <
+         std::tie(other.weights, other.weights_bytes, other.format,
+                  other.packed_type, other.packed_dims);
+}
+
+PrepackedWeightsCache& PrepackedWeightsCache::GetInstance() {
+  // Never destroyed, so that kernels may release their weights at exit.
+  static PrepackedWeightsCache* const cache = new PrepackedWeightsCache();
+  return *cache;
+}
+
+std::shared_ptr<const PrepackedWeights> PrepackedWeightsCache::GetOrPack(
+    const TfLiteTensor& weights, WeightsPackingFormat format,
+    TfLiteType packed_type, const TfLiteIntArray& packed_dims,
+    size_t packed_bytes, const PackFunction& pack) {
+  Key key{weights.data.raw_const, weights.bytes, format, packed_type,
+          std::vector<int>(packed_dims.data,
+                           packed_dims.data + packed_dims.size)};
+  std::shared_ptr<PrepackedWeights> packed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      packed = it->second.lock();
+    }
+    if (packed == nullptr) {
+      packed = std::shared_ptr<PrepackedWeights>(
+          new PrepackedWeights(packed_bytes),
+          [this, key](PrepackedWeights* entry) { Release(key, entry); });
+      entries_[key] = packed;
+      bytes_ += packed_bytes;
+    }
+  }
+  // Packing may take a while, so it's done without holding the lock.
+  std::call_once(packed->packed_, [&]() { pack(packed->data_.get()); });
+  return packed;
+}
+
+void PrepackedWeightsCache::Release(const Key& key, PrepackedWeights* packed) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    // The entry may already have been replaced by new packed weights.
+    if (it != entries_.end() && it->second.expired()) {
+      entries_.erase(it);
+    }
+    bytes_ -= packed->bytes();
+  }
+  delete packed;
+}
+
+size_t PrepackedWeightsCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t num_entries = 0;
+  for (const auto& [key, packed] : entries_) {
+    num_entries += packed.expired() ? 0 : 1;
+  }
+  return num_entries;
+}
+
+size_t PrepackedWeightsCache::bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_;
+}
+
+bool CanSharePrepackedWeights(const TfLiteTensor* weights) {
+  // Other constant tensors, e.g. kTfLitePersistentRo ones, are owned by one
+  // interpreter and may be rewritten when it's prepared again.
+  return weights != nullptr && weights->allocation_type == kTfLiteMmapRo &&
+         weights->data.raw != nullptr;
+}
+
+TfLiteStatus ResizeAndSharePrepackedWeights(
+    TfLiteContext* context, const TfLiteTensor* weights,
+    WeightsPackingFormat format, TfLiteIntArray* packed_dims,
+    TfLiteTensor* packed, const std::function<void(TfLiteTensor*)>& pack,
+    std::shared_ptr<const PrepackedWeights>* holder) {
+  if (packed->allocation_type == kTfLiteDynamic) {
+    TfLiteTensorDataFree(packed);
+  }
+  // The buffer is owned by the cache, so it must not be allocated or freed by
+  // the interpreter.
+  packed->allocation_type = kTfLiteCustom;
+  packed->data.raw = nullptr;
+  TF_LITE_ENSURE_OK(context,
+                    context->ResizeTensor(context, packed, packed_dims));
+  *holder = PrepackedWeightsCache::GetInstance().GetOrPack(
+      *weights, format, packed->type, *packed->dims, packed->bytes,
+      [packed, &pack](void* buffer) {
+        packed->data.raw = static_cast<char*>(buffer);
+        pack(packed);
+      });
+  // Kernels only read the packed weights.
+  packed->data.raw =
+      const_cast<char*>(static_cast<const char*>((*holder)->data()));
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
@@ -0,0 +1,134 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_PREPACKED_WEIGHTS_CACHE_H_
+#define TENSORFLOW_LITE_KERNELS_PREPACKED_WEIGHTS_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+
+// The ways builtin kernels repack their constant weights. Together with the
+// type and shape of the packed weights, they make up the packing parameters
+// of the entries of the PrepackedWeightsCache.
+enum class WeightsPackingFormat : int32_t {
+  // CONV_2D filter, transposed to HWCN for the multithreaded Eigen kernel.
+  kConvHwcn,
+  // TRANSPOSE_CONV weights, transposed from OHWI to HWOI.
+  kTransposeConvHwoi,
+  // BATCH_MATMUL RHS, with its last two dimensions swapped.
+  kBatchMatMulTransposedRhs,
+};
+
+// A buffer holding the repacked copy of constant weights.
+class PrepackedWeights {
+ public:
+  explicit PrepackedWeights(size_t bytes)
+      : data_(new char[bytes > 0 ? bytes : 1]), bytes_(bytes) {}
+  PrepackedWeights(const PrepackedWeights&) = delete;
+  PrepackedWeights& operator=(const PrepackedWeights&) = delete;
+
+  const void* data() const { return data_.get(); }
+  size_t bytes() const { return bytes_; }
+
+ private:
+  friend class PrepackedWeightsCache;
+
+  std::unique_ptr<char[]> data_;
+  const size_t bytes_;
+  // Set once the weights have been packed into `data_`.
+  std::once_flag packed_;
+};
+
+// A process-wide cache of the constant weights repacked by builtin kernels.
+//
+// All the interpreters built from one FlatBufferModel read their constant
+// tensors from the same model buffer. The packed copies made by their kernels
+// are identical, so they're only packed once and shared, instead of taking
+// memory in each interpreter. Entries are keyed by the address and size of
+// the source weights and by the packing parameters, and are refcounted: an
+// entry is released when the last kernel using it is freed. Since a model
+// outlives its interpreters, the source buffer can't be reused for other
+// weights while an entry exists.
+//
+// This class is thread-safe.
+class PrepackedWeightsCache {
+ public:
+  // Returns the cache of the process.
+  static PrepackedWeightsCache& GetInstance();
+
+  // The function writing the packed weights to a buffer of `packed_bytes`.
+  using PackFunction = std::function<void(void* packed)>;
+
+  // Returns the copy of `weights` packed with `format` into a buffer of
+  // `packed_bytes` with the given type and dims. `pack` is only called if no
+  // one holds such a copy yet. Concurrent calls for the same weights wait for
+  // the first one to pack them.
+  std::shared_ptr<const PrepackedWeights> GetOrPack(
+      const TfLiteTensor& weights, WeightsPackingFormat format,
+      TfLiteType packed_type, const TfLiteIntArray& packed_dims,
+      size_t packed_bytes, const PackFunction& pack);
+
+  // Number of packed weights currently held.
+  size_t size() const;
+  // Total size of the packed weights currently held.
+  size_t bytes() const;
+
+ private:
+  struct Key {
+    const void* weights;
+    size_t weights_bytes;
+    WeightsPackingFormat format;
+    TfLiteType packed_type;
+    std::vector<int> packed_dims;
+
+    bool operator<(const Key& other) const;
+  };
+
+  PrepackedWeightsCache() = default;
+  void Release(const Key& key, PrepackedWeights* packed);
+
+  mutable std::mutex mutex_;
+  std::map<Key, std::weak_ptr<PrepackedWeights>> entries_;
+  size_t bytes_ = 0;
+};
+
+// Returns true if the packed copies of `weights` may be shared through the
+// PrepackedWeightsCache, i.e. if they are read from the model.
+bool CanSharePrepackedWeights(const TfLiteTensor* weights);
+
+// Resizes `packed` to `packed_dims`, taking ownership of them, and points it
+// at the copy of `weights` packed with `format` that's shared by all the
+// interpreters of the model. `pack(packed)` is only called to fill it if no
+// interpreter holds one yet. `packed` becomes a kTfLiteCustom tensor, whose
+// buffer is kept alive by `*holder`, and must not be written by the kernel.
+//
+// Kernels usually keep `holder` in their op data.
+TfLiteStatus ResizeAndSharePrepackedWeights(
+    TfLiteContext* context, const TfLiteTensor* weights,
+    WeightsPackingFormat format, TfLiteIntArray* packed_dims,
+    TfLiteTensor* packed, const std::function<void(TfLiteTensor*)>& pack,
+    std::shared_ptr<const PrepackedWeights>* holder);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_PREPACKED_WEIGHTS_CACHE_H_
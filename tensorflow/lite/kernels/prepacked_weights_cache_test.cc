@@ -0,0 +1,321 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/prepacked_weights_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/interpreter_builder.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::FloatEq;
+using ::testing::Pointwise;
+
+// A float tensor of `size` elements, viewing `data`.
+class WeightsTensor {
+ public:
+  WeightsTensor(float* data, int size) : dims_(TfLiteIntArrayCreate(1)) {
+    dims_->data[0] = size;
+    tensor_.type = kTfLiteFloat32;
+    tensor_.allocation_type = kTfLiteMmapRo;
+    tensor_.data.f = data;
+    tensor_.bytes = size * sizeof(float);
+    tensor_.dims = dims_;
+  }
+  ~WeightsTensor() { TfLiteIntArrayFree(dims_); }
+
+  const TfLiteTensor& tensor() const { return tensor_; }
+  const TfLiteIntArray& dims() const { return *dims_; }
+
+ private:
+  TfLiteIntArray* dims_;
+  TfLiteTensor tensor_{};
+};
+
+TEST(PrepackedWeightsCacheTest, SharesPackedWeights) {
+  PrepackedWeightsCache& cache = PrepackedWeightsCache::GetInstance();
+  std::vector<float> data = {1, 2, 3, 4};
+  WeightsTensor weights(data.data(), data.size());
+  int num_packs = 0;
+  auto pack = [&](void* packed) {
+    ++num_packs;
+    std::memcpy(packed, data.data(), weights.tensor().bytes);
+  };
+
+  auto first = cache.GetOrPack(weights.tensor(),
+                               WeightsPackingFormat::kConvHwcn,
+                               kTfLiteFloat32, weights.dims(),
+                               weights.tensor().bytes, pack);
+  auto second = cache.GetOrPack(weights.tensor(),
+                                WeightsPackingFormat::kConvHwcn,
+                                kTfLiteFloat32, weights.dims(),
+                                weights.tensor().bytes, pack);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(num_packs, 1);
+  EXPECT_EQ(cache.size(), 1);
+  EXPECT_EQ(cache.bytes(), weights.tensor().bytes);
+  EXPECT_EQ(std::memcmp(first->data(), data.data(), first->bytes()), 0);
+}
+
+TEST(PrepackedWeightsCacheTest, SeparatesPackingParameters) {
+  PrepackedWeightsCache& cache = PrepackedWeightsCache::GetInstance();
+  std::vector<float> data = {1, 2, 3, 4};
+  WeightsTensor weights(data.data(), data.size());
+  WeightsTensor prefix(data.data(), 2);
+  auto pack = [](void* packed) {};
+
+  auto hwcn = cache.GetOrPack(weights.tensor(),
+                              WeightsPackingFormat::kConvHwcn, kTfLiteFloat32,
+                              weights.dims(), weights.tensor().bytes, pack);
+  auto hwoi = cache.GetOrPack(
+      weights.tensor(), WeightsPackingFormat::kTransposeConvHwoi,
+      kTfLiteFloat32, weights.dims(), weights.tensor().bytes, pack);
+  auto smaller = cache.GetOrPack(prefix.tensor(),
+                                 WeightsPackingFormat::kConvHwcn,
+                                 kTfLiteFloat32, prefix.dims(),
+                                 prefix.tensor().bytes, pack);
+  EXPECT_NE(hwcn, hwoi);
+  EXPECT_NE(hwcn, smaller);
+  EXPECT_EQ(cache.size(), 3);
+}
+
+TEST(PrepackedWeightsCacheTest, ReleasesUnusedWeights) {
+  PrepackedWeightsCache& cache = PrepackedWeightsCache::GetInstance();
+  std::vector<float> data = {1, 2, 3, 4};
+  WeightsTensor weights(data.data(), data.size());
+  int num_packs = 0;
+  auto pack = [&](void* packed) { ++num_packs; };
+
+  auto packed = cache.GetOrPack(weights.tensor(),
+                                WeightsPackingFormat::kConvHwcn,
+                                kTfLiteFloat32, weights.dims(),
+                                weights.tensor().bytes, pack);
+  packed.reset();
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_EQ(cache.bytes(), 0);
+
+  packed = cache.GetOrPack(weights.tensor(), WeightsPackingFormat::kConvHwcn,
+                           kTfLiteFloat32, weights.dims(),
+                           weights.tensor().bytes, pack);
+  EXPECT_EQ(num_packs, 2);
+}
+
+TEST(PrepackedWeightsCacheTest, PacksOnceForConcurrentCallers) {
+  PrepackedWeightsCache& cache = PrepackedWeightsCache::GetInstance();
+  std::vector<float> data(1 << 16, 1.0f);
+  WeightsTensor weights(data.data(), data.size());
+  std::atomic<int> num_packs{0};
+  auto pack = [&](void* packed) {
+    ++num_packs;
+    std::memcpy(packed, data.data(), weights.tensor().bytes);
+  };
+
+  constexpr int kNumThreads = 8;
+  std::vector<std::shared_ptr<const PrepackedWeights>> packed(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&, i]() {
+      packed[i] = cache.GetOrPack(weights.tensor(),
+                                  WeightsPackingFormat::kConvHwcn,
+                                  kTfLiteFloat32, weights.dims(),
+                                  weights.tensor().bytes, pack);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_packs.load(), 1);
+  for (int i = 0; i < kNumThreads; ++i) {
+    EXPECT_EQ(packed[i], packed[0]);
+    // All callers return once the weights are packed.
+    EXPECT_EQ(static_cast<const float*>(packed[i]->data())[data.size() - 1],
+              1.0f);
+  }
+}
+
+// A BATCH_MATMUL of a float input by constant weights, from whose model more
+// interpreters may be built.
+class ConstWeightsMatMulModel : public SingleOpModel {
+ public:
+  ConstWeightsMatMulModel(int rows, int depth, int units)
+      : rows_(rows), depth_(depth), units_(units), weights_(depth * units) {
+    for (size_t i = 0; i < weights_.size(); ++i) {
+      weights_[i] = static_cast<float>(i % 7) - 3.0f;
+    }
+    input_id_ = AddInput({TensorType_FLOAT32, {rows, depth}});
+    AddConstInput<float>(TensorType_FLOAT32, weights_, {depth, units});
+    output_id_ = AddOutput(TensorType_FLOAT32);
+    SetBuiltinOp(BuiltinOperator_BATCH_MATMUL,
+                 BuiltinOptions_BatchMatMulOptions,
+                 CreateBatchMatMulOptions(builder_, /*adj_x=*/false,
+                                          /*adj_y=*/false)
+                     .Union());
+    SetBypassDefaultDelegates();
+    BuildInterpreter({GetShape(input_id_)});
+  }
+
+  Interpreter* interpreter() { return interpreter_.get(); }
+
+  // Builds another interpreter from the model of this one.
+  std::unique_ptr<Interpreter> BuildInterpreterOfSameModel() {
+    std::unique_ptr<Interpreter> interpreter;
+    InterpreterBuilder(GetModel(builder_.GetBufferPointer()), *resolver_)(
+        &interpreter);
+    if (interpreter == nullptr ||
+        interpreter->AllocateTensors() != kTfLiteOk) {
+      return nullptr;
+    }
+    return interpreter;
+  }
+
+  // Returns the transposed weights used by the kernel of `interpreter`.
+  static const TfLiteTensor* TransposedWeights(Interpreter* interpreter) {
+    const TfLiteNode& node = interpreter->node_and_registration(0)->first;
+    return interpreter->tensor(node.temporaries->data[1]);
+  }
+
+  std::vector<float> Run(Interpreter* interpreter,
+                         const std::vector<float>& input) {
+    std::copy(input.begin(), input.end(),
+              interpreter->typed_input_tensor<float>(0));
+    if (interpreter->Invoke() != kTfLiteOk) return {};
+    const float* output = interpreter->typed_output_tensor<float>(0);
+    return std::vector<float>(output, output + rows_ * units_);
+  }
+
+  std::vector<float> Expected(const std::vector<float>& input) const {
+    std::vector<float> output(rows_ * units_, 0.0f);
+    for (int r = 0; r < rows_; ++r) {
+      for (int u = 0; u < units_; ++u) {
+        for (int d = 0; d < depth_; ++d) {
+          output[r * units_ + u] +=
+              input[r * depth_ + d] * weights_[d * units_ + u];
+        }
+      }
+    }
+    return output;
+  }
+
+ private:
+  int rows_;
+  int depth_;
+  int units_;
+  std::vector<float> weights_;
+  int input_id_;
+  int output_id_;
+};
+
+TEST(PrepackedWeightsCacheTest, InterpretersOfAModelShareWeights) {
+  ConstWeightsMatMulModel model(/*rows=*/2, /*depth=*/3, /*units=*/4);
+  std::unique_ptr<Interpreter> other = model.BuildInterpreterOfSameModel();
+  ASSERT_NE(other, nullptr);
+
+  const TfLiteTensor* transposed =
+      ConstWeightsMatMulModel::TransposedWeights(model.interpreter());
+  const TfLiteTensor* other_transposed =
+      ConstWeightsMatMulModel::TransposedWeights(other.get());
+  EXPECT_EQ(transposed->allocation_type, kTfLiteCustom);
+  EXPECT_EQ(transposed->data.raw, other_transposed->data.raw);
+  EXPECT_EQ(PrepackedWeightsCache::GetInstance().size(), 1);
+  EXPECT_EQ(PrepackedWeightsCache::GetInstance().bytes(), transposed->bytes);
+
+  const std::vector<float> input = {1, 2, 3, -4, -5, -6};
+  EXPECT_THAT(model.Run(model.interpreter(), input),
+              Pointwise(FloatEq(), model.Expected(input)));
+  EXPECT_THAT(model.Run(other.get(), input),
+              Pointwise(FloatEq(), model.Expected(input)));
+
+  // The weights outlive the first interpreter.
+  ConstWeightsMatMulModel second_model(/*rows=*/2, /*depth=*/3, /*units=*/4);
+  EXPECT_NE(ConstWeightsMatMulModel::TransposedWeights(
+                second_model.interpreter())
+                ->data.raw,
+            transposed->data.raw);
+  EXPECT_EQ(PrepackedWeightsCache::GetInstance().size(), 2);
+}
+
+TEST(PrepackedWeightsCacheTest, WeightsAreReleasedWithTheInterpreters) {
+  {
+    ConstWeightsMatMulModel model(/*rows=*/1, /*depth=*/8, /*units=*/8);
+    EXPECT_EQ(PrepackedWeightsCache::GetInstance().size(), 1);
+  }
+  EXPECT_EQ(PrepackedWeightsCache::GetInstance().size(), 0);
+  EXPECT_EQ(PrepackedWeightsCache::GetInstance().bytes(), 0);
+}
+
+}  // namespace
+}  // namespace tflite
+
+// Builds `state.range(0)` interpreters of a 512x512 BATCH_MATMUL, either of
+// one model, sharing their transposed weights, or of separate copies of the
+// model when `state.range(1)` is 0, as if each had its own copy. Reports the
+// memory used by the interpreters and the packed weights.
+void BM_MultiInterpreterMemory(benchmark::State& state) {
+  const int num_interpreters = state.range(0);
+  const bool same_model = state.range(1) != 0;
+  constexpr int kDepth = 512;
+  constexpr int kUnits = 512;
+  size_t packed_bytes = 0;
+  size_t total_bytes = 0;
+  for (auto _ : state) {
+    std::vector<std::unique_ptr<tflite::ConstWeightsMatMulModel>> models;
+    std::vector<std::unique_ptr<tflite::Interpreter>> shared_interpreters;
+    std::vector<tflite::Interpreter*> interpreters;
+    models.push_back(std::make_unique<tflite::ConstWeightsMatMulModel>(
+        /*rows=*/1, kDepth, kUnits));
+    interpreters.push_back(models.back()->interpreter());
+    for (int i = 1; i < num_interpreters; ++i) {
+      if (same_model) {
+        shared_interpreters.push_back(
+            models.front()->BuildInterpreterOfSameModel());
+        interpreters.push_back(shared_interpreters.back().get());
+      } else {
+        models.push_back(std::make_unique<tflite::ConstWeightsMatMulModel>(
+            /*rows=*/1, kDepth, kUnits));
+        interpreters.push_back(models.back()->interpreter());
+      }
+    }
+    packed_bytes = tflite::PrepackedWeightsCache::GetInstance().bytes();
+    total_bytes = packed_bytes;
+    for (tflite::Interpreter* interpreter : interpreters) {
+      tflite::Subgraph::SubgraphAllocInfo alloc_info;
+      interpreter->primary_subgraph().GetMemoryAllocInfo(&alloc_info);
+      total_bytes += alloc_info.arena_size + alloc_info.arena_persist_size +
+                     alloc_info.dynamic_size;
+    }
+  }
+  state.counters["packed_weights_bytes"] = packed_bytes;
+  state.counters["bytes_per_interpreter"] =
+      static_cast<double>(total_bytes) / num_interpreters;
+}
+BENCHMARK(BM_MultiInterpreterMemory)
+    ->ArgNames({"interpreters", "same_model"})
+    ->ArgsProduct({{1, 8, 32, 64}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
@@ -186,14 +186,14 @@ TfLiteRegistration* Register_ASSIGN_VARIABLE();
 TfLiteRegistration* Register_BITCAST();
 TfLiteRegistration* Register_BITWISE_XOR();
 TfLiteRegistration* Register_RIGHT_SHIFT();
-TfLiteRegistration* Register_STABLEHLO_SCATTER();
+TfLiteRegistration* Register_STABLEHLO_SCATTER_REF();
 TfLiteRegistration* Register_DILATE();
 TfLiteRegistration* Register_STABLEHLO_RNG_BIT_GENERATOR();
-TfLiteRegistration* Register_REDUCE_WINDOW();
-TfLiteRegistration* Register_STABLEHLO_GATHER();
+TfLiteRegistration* Register_REDUCE_WINDOW_REF();
+TfLiteRegistration* Register_STABLEHLO_GATHER_REF();
 TfLiteRegistration* Register_STABLEHLO_ADD();
 TfLiteRegistration* Register_STABLEHLO_MULTIPLY();
-TfLiteRegistration* Register_STABLEHLO_REDUCE_WINDOW();
+TfLiteRegistration* Register_STABLEHLO_REDUCE_WINDOW_REF();
 TfLiteRegistration* Register_STABLEHLO_MAXIMUM();
 TfLiteRegistration* Register_STABLEHLO_MINIMUM();
 TfLiteRegistration* Register_STABLEHLO_PAD();
@@ -560,7 +560,8 @@ BuiltinRefOpResolver::BuiltinRefOpResolver() {
   AddBuiltin(BuiltinOperator_BITCAST, Register_BITCAST());
   AddBuiltin(BuiltinOperator_BITWISE_XOR, Register_BITWISE_XOR());
   AddBuiltin(BuiltinOperator_RIGHT_SHIFT, Register_RIGHT_SHIFT());
-  AddBuiltin(BuiltinOperator_STABLEHLO_SCATTER, Register_STABLEHLO_SCATTER());
+  AddBuiltin(BuiltinOperator_STABLEHLO_SCATTER,
+             Register_STABLEHLO_SCATTER_REF());
   AddBuiltin(BuiltinOperator_STABLEHLO_ADD, Register_STABLEHLO_ADD());
   AddBuiltin(BuiltinOperator_STABLEHLO_MULTIPLY, Register_STABLEHLO_MULTIPLY());
   AddBuiltin(BuiltinOperator_STABLEHLO_MAXIMUM, Register_STABLEHLO_MAXIMUM());
@@ -568,10 +569,11 @@ BuiltinRefOpResolver::BuiltinRefOpResolver() {
   AddBuiltin(BuiltinOperator_DILATE, Register_DILATE());
   AddBuiltin(BuiltinOperator_STABLEHLO_RNG_BIT_GENERATOR,
              Register_STABLEHLO_RNG_BIT_GENERATOR());
-  AddBuiltin(BuiltinOperator_REDUCE_WINDOW, Register_REDUCE_WINDOW());
+  AddBuiltin(BuiltinOperator_REDUCE_WINDOW, Register_REDUCE_WINDOW_REF());
   AddBuiltin(BuiltinOperator_STABLEHLO_REDUCE_WINDOW,
-             Register_STABLEHLO_REDUCE_WINDOW());
-  AddBuiltin(BuiltinOperator_STABLEHLO_GATHER, Register_STABLEHLO_GATHER());
+             Register_STABLEHLO_REDUCE_WINDOW_REF());
+  AddBuiltin(BuiltinOperator_STABLEHLO_GATHER,
+             Register_STABLEHLO_GATHER_REF());
   AddBuiltin(BuiltinOperator_STABLEHLO_PAD, Register_STABLEHLO_PAD());
   AddBuiltin(BuiltinOperator_STABLEHLO_COMPOSITE,
              Register_STABLEHLO_COMPOSITE());
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -22,6 +23,8 @@ limitations under the License.
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 #include "tensorflow/lite/kernels/internal/runtime_shape.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/internal/types.h"
@@ -32,12 +35,23 @@ namespace tflite {
 namespace ops {
 namespace builtin {
 namespace stablehlo_gather {
+
+// This file has a reference implementation of the gather, walking the result
+// one element at a time, and an optimized one for the common dimension numbers.
+enum KernelType {
+  kReference,
+  kGenericOptimized,
+};
+
 namespace {
 
 constexpr int kOperandTensor = 0;
 constexpr int kStartIndicesTensor = 1;
 constexpr int kOutputTensor = 0;
 
+// Minimum number of bytes copied by each thread of a sharded gather.
+constexpr int64_t kMinBytesPerThread = 16 * 1024;
+
 using TfLiteIntArrayUniquePtr =
     std::unique_ptr<TfLiteIntArray, decltype(&TfLiteIntArrayFree)>;
 
@@ -149,9 +163,220 @@ TfLiteStatus SetBatchAndOffsetIndices(const Index<IndexType>& result_index,
   return kTfLiteOk;
 }
 
+// Holds the parameters of a gather whose result is a sequence of whole slices
+// of the operand, one per batch index.
+//
+// This is the case when the offset dims are the trailing dims of the result
+// and the index vectors are the innermost dim of start_indices, which covers
+// most gathers in practice, e.g. embedding lookups or slicing rows of a
+// matrix. Each slice is then copied with memcpy, one contiguous run of the
+// operand at a time, instead of looking up each result element.
+struct SliceGather {
+  int64_t num_batches = 0;
+  int64_t index_vector_size = 0;
+  int64_t slice_bytes = 0;
+  std::vector<int64_t> operand_dims;
+  std::vector<int64_t> slice_sizes;
+  // Strides of the operand, in bytes.
+  std::vector<int64_t> operand_strides;
+  // The leading dims of the slice that are walked over. The other dims are
+  // contiguous in the operand and copied as runs of `run_bytes`.
+  int outer_rank = 0;
+  int64_t run_bytes = 0;
+};
+
+// Returns true if the gather can be computed with a SliceGather, and fills
+// `gather`.
+bool GetSliceGather(const TfLiteStablehloGatherParams& params,
+                    const RuntimeShape& operand_shape,
+                    const RuntimeShape& start_indices_shape,
+                    const RuntimeShape& result_shape, int64_t element_size,
+                    SliceGather* gather) {
+  const int operand_rank = operand_shape.DimensionsCount();
+  const int indices_rank = start_indices_shape.DimensionsCount();
+  const int num_batch_dims =
+      result_shape.DimensionsCount() - params.num_offset_dims;
+  if (operand_rank == 0 || params.num_slice_sizes != operand_rank) {
+    return false;
+  }
+  for (int i = 0; i < params.num_offset_dims; ++i) {
+    if (params.offset_dims[i] != num_batch_dims + i) {
+      return false;
+    }
+  }
+  if (params.index_vector_dim == indices_rank) {
+    gather->index_vector_size = 1;
+  } else if (params.index_vector_dim == indices_rank - 1) {
+    gather->index_vector_size = start_indices_shape.Dims(indices_rank - 1);
+  } else {
+    return false;
+  }
+  if (params.num_start_index_map != gather->index_vector_size) {
+    return false;
+  }
+  for (int i = 0; i < params.num_start_index_map; ++i) {
+    if (params.start_index_map[i] < 0 ||
+        params.start_index_map[i] >= operand_rank) {
+      return false;
+    }
+  }
+
+  gather->operand_dims.resize(operand_rank);
+  gather->slice_sizes.assign(params.slice_sizes,
+                             params.slice_sizes + operand_rank);
+  int64_t slice_elements = 1;
+  for (int dim = 0; dim < operand_rank; ++dim) {
+    gather->operand_dims[dim] = operand_shape.Dims(dim);
+    if (gather->slice_sizes[dim] < 0 ||
+        gather->slice_sizes[dim] > gather->operand_dims[dim]) {
+      return false;
+    }
+    slice_elements *= gather->slice_sizes[dim];
+  }
+  gather->num_batches = 1;
+  for (int dim = 0; dim < num_batch_dims; ++dim) {
+    gather->num_batches *= result_shape.Dims(dim);
+  }
+  if (gather->num_batches * slice_elements != result_shape.FlatSize()) {
+    return false;
+  }
+
+  gather->slice_bytes = slice_elements * element_size;
+  gather->operand_strides.resize(operand_rank);
+  gather->operand_strides[operand_rank - 1] = element_size;
+  for (int dim = operand_rank - 2; dim >= 0; --dim) {
+    gather->operand_strides[dim] =
+        gather->operand_strides[dim + 1] * gather->operand_dims[dim + 1];
+  }
+  // The slice is contiguous along the innermost dims that it spans entirely,
+  // and along the first dim that it doesn't.
+  int run_dim = operand_rank - 1;
+  gather->run_bytes = gather->slice_sizes[run_dim] * element_size;
+  while (run_dim > 0 &&
+         gather->slice_sizes[run_dim] == gather->operand_dims[run_dim]) {
+    --run_dim;
+    gather->run_bytes *= gather->slice_sizes[run_dim];
+  }
+  gather->outer_rank = run_dim;
+  return true;
+}
+
+// Copies the slice of the operand starting at `operand` to `result` and
+// returns the end of the copied data in `result`.
+char* CopySlice(const SliceGather& gather, const char* operand, char* result,
+                int depth) {
+  if (depth == gather.outer_rank) {
+    std::memcpy(result, operand, gather.run_bytes);
+    return result + gather.run_bytes;
+  }
+  for (int64_t i = 0; i < gather.slice_sizes[depth]; ++i) {
+    result = CopySlice(gather, operand, result, depth + 1);
+    operand += gather.operand_strides[depth];
+  }
+  return result;
+}
+
+// Gathers the slices of the batch indices in [batch_begin, batch_end).
+template <typename IndexType>
+void GatherSlices(const SliceGather& gather,
+                  const TfLiteStablehloGatherParams& params,
+                  const IndexType* start_indices, const char* operand,
+                  int64_t batch_begin, int64_t batch_end, char* result) {
+  const int operand_rank = gather.operand_dims.size();
+  std::vector<int64_t> starting_index(operand_rank);
+  result += batch_begin * gather.slice_bytes;
+  for (int64_t batch = batch_begin; batch < batch_end; ++batch) {
+    const IndexType* index_vector =
+        start_indices + batch * gather.index_vector_size;
+    std::fill(starting_index.begin(), starting_index.end(), 0);
+    for (int i = 0; i < params.num_start_index_map; ++i) {
+      starting_index[params.start_index_map[i]] = index_vector[i];
+    }
+    // Clips the starting index like ClipStartingIndex.
+    int64_t offset = 0;
+    for (int dim = 0; dim < operand_rank; ++dim) {
+      const int64_t max_start =
+          gather.operand_dims[dim] - gather.slice_sizes[dim];
+      const int64_t start = std::max<int64_t>(
+          0, std::min<int64_t>(starting_index[dim], max_start));
+      offset += start * gather.operand_strides[dim];
+    }
+    result = CopySlice(gather, operand + offset, result, /*depth=*/0);
+  }
+}
+
+template <typename IndexType>
+struct GatherSlicesTask : cpu_backend_threadpool::Task {
+  GatherSlicesTask(const SliceGather& gather,
+                   const TfLiteStablehloGatherParams& params,
+                   const IndexType* start_indices, const char* operand,
+                   int64_t batch_begin, int64_t batch_end, char* result)
+      : gather(gather),
+        params(params),
+        start_indices(start_indices),
+        operand(operand),
+        batch_begin(batch_begin),
+        batch_end(batch_end),
+        result(result) {}
+
+  void Run() override {
+    GatherSlices(gather, params, start_indices, operand, batch_begin,
+                 batch_end, result);
+  }
+
+ private:
+  const SliceGather& gather;
+  const TfLiteStablehloGatherParams& params;
+  const IndexType* start_indices;
+  const char* operand;
+  int64_t batch_begin;
+  int64_t batch_end;
+  char* result;
+};
+
+// Computes a SliceGather, sharding the batch indices over the threads of the
+// CPU backend when there is enough data to copy.
+template <typename IndexType>
+TfLiteStatus EvalSliceGather(TfLiteContext* context, const SliceGather& gather,
+                             const TfLiteStablehloGatherParams& params,
+                             const TfLiteTensor* operand,
+                             const TfLiteTensor* start_indices,
+                             TfLiteTensor* output) {
+  const IndexType* start_indices_data = GetTensorData<IndexType>(start_indices);
+  const char* operand_data = operand->data.raw_const;
+  char* result_data = output->data.raw;
+
+  CpuBackendContext* cpu_backend_context =
+      CpuBackendContext::GetFromContext(context);
+  const int64_t max_thread_count = std::min<int64_t>(
+      gather.num_batches,
+      gather.num_batches * gather.slice_bytes / kMinBytesPerThread);
+  const int thread_count = std::max<int64_t>(
+      1, std::min<int64_t>(cpu_backend_context->max_num_threads(),
+                           max_thread_count));
+  if (thread_count == 1) {
+    GatherSlices(gather, params, start_indices_data, operand_data,
+                 /*batch_begin=*/0, gather.num_batches, result_data);
+    return kTfLiteOk;
+  }
+  std::vector<GatherSlicesTask<IndexType>> tasks;
+  tasks.reserve(thread_count);
+  int64_t batch_begin = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    const int64_t batch_end =
+        batch_begin + (gather.num_batches - batch_begin) / (thread_count - i);
+    tasks.emplace_back(gather, params, start_indices_data, operand_data,
+                       batch_begin, batch_end, result_data);
+    batch_begin = batch_end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+  return kTfLiteOk;
+}
+
 // Evaluates this node given the type of the elements in the start_indices
 // and the type of the elements in the operand tensor.
-template <typename IndexType, typename DataType>
+template <KernelType kernel_type, typename IndexType, typename DataType>
 TfLiteStatus EvalWithTypes(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, NumInputs(node), 2);
   TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
@@ -187,6 +412,15 @@ TfLiteStatus EvalWithTypes(TfLiteContext* context, TfLiteNode* node) {
     return kTfLiteOk;
   }
 
+  if (kernel_type == kGenericOptimized) {
+    SliceGather gather;
+    if (GetSliceGather(*data, operand_shape, start_indices_shape,
+                       result_runtime_shape, sizeof(DataType), &gather)) {
+      return EvalSliceGather<IndexType>(context, gather, *data, operand,
+                                        start_indices, output);
+    }
+  }
+
   do {
     TF_LITE_ENSURE_OK(
         context, SetBatchAndOffsetIndices(result_index, data->offset_dims,
@@ -232,18 +466,18 @@ TfLiteStatus EvalWithTypes(TfLiteContext* context, TfLiteNode* node) {
 
 // Evaluates this node given the type of the elements in the scatter_indices
 // tensor.
-template <typename IndexType>
+template <KernelType kernel_type, typename IndexType>
 TfLiteStatus EvalWithIndexType(TfLiteContext* context, TfLiteNode* node,
                                TfLiteType index_type, TfLiteType data_type) {
   switch (TfLiteTypeGetSizeBits(data_type)) {
     case 8:
-      return EvalWithTypes<IndexType, int8_t>(context, node);
+      return EvalWithTypes<kernel_type, IndexType, int8_t>(context, node);
     case 16:
-      return EvalWithTypes<IndexType, int16_t>(context, node);
+      return EvalWithTypes<kernel_type, IndexType, int16_t>(context, node);
     case 32:
-      return EvalWithTypes<IndexType, int32_t>(context, node);
+      return EvalWithTypes<kernel_type, IndexType, int32_t>(context, node);
     case 64:
-      return EvalWithTypes<IndexType, int64_t>(context, node);
+      return EvalWithTypes<kernel_type, IndexType, int64_t>(context, node);
     default:
       TF_LITE_KERNEL_LOG(context, "(Data Type: %s) currently not supported.\n",
                          TfLiteTypeGetName(data_type));
@@ -255,6 +489,7 @@ TfLiteStatus EvalWithIndexType(TfLiteContext* context, TfLiteNode* node,
 
 // This is the kernel for stablehlo.gather which receives `slice_sizes` as a
 // static attribute.
+template <KernelType kernel_type>
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* operand;
   TF_LITE_ENSURE_OK(context,
@@ -267,9 +502,11 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   TfLiteType data_type = operand->type;
 
   if (index_type == kTfLiteInt32) {
-    return EvalWithIndexType<int32_t>(context, node, index_type, data_type);
+    return EvalWithIndexType<kernel_type, int32_t>(context, node, index_type,
+                                                   data_type);
   } else if (index_type == kTfLiteInt64) {
-    return EvalWithIndexType<int64_t>(context, node, index_type, data_type);
+    return EvalWithIndexType<kernel_type, int64_t>(context, node, index_type,
+                                                   data_type);
   } else {
     TF_LITE_KERNEL_LOG(context, "(Index Type: %s) currently not supported.\n",
                        TfLiteTypeGetName(index_type));
@@ -322,12 +559,24 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
 }  // namespace stablehlo_gather
 
-TfLiteRegistration* Register_STABLEHLO_GATHER() {
-  static TfLiteRegistration r = {nullptr, nullptr, stablehlo_gather::Prepare,
-                                 stablehlo_gather::Eval};
+TfLiteRegistration* Register_STABLEHLO_GATHER_REF() {
+  static TfLiteRegistration r = {
+      nullptr, nullptr, stablehlo_gather::Prepare,
+      stablehlo_gather::Eval<stablehlo_gather::kReference>};
   return &r;
 }
 
+TfLiteRegistration* Register_STABLEHLO_GATHER_GENERIC_OPT() {
+  static TfLiteRegistration r = {
+      nullptr, nullptr, stablehlo_gather::Prepare,
+      stablehlo_gather::Eval<stablehlo_gather::kGenericOptimized>};
+  return &r;
+}
+
+TfLiteRegistration* Register_STABLEHLO_GATHER() {
+  return Register_STABLEHLO_GATHER_GENERIC_OPT();
+}
+
 }  // namespace builtin
 }  // namespace ops
 }  // namespace tflite
@@ -14,17 +14,28 @@ limitations under the License.
 ==============================================================================*/
 
 #include <cstdint>
+#include <functional>
 #include <initializer_list>
+#include <memory>
+#include <numeric>
 #include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/kernels/test_util.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
 namespace tflite {
+namespace ops {
+namespace builtin {
+TfLiteRegistration* Register_STABLEHLO_GATHER_REF();
+TfLiteRegistration* Register_STABLEHLO_GATHER_GENERIC_OPT();
+}  // namespace builtin
+}  // namespace ops
+
 namespace {
 
 using ::testing::ElementsAreArray;
@@ -32,10 +43,20 @@ using ::testing::ElementsAreArray;
 class StablehloGatherOpModel : public SingleOpModel {
  public:
   StablehloGatherOpModel(const TensorData& input, const TensorData& indices,
-                         const TfLiteStablehloGatherParams& params) {
+                         const TfLiteStablehloGatherParams& params)
+      : StablehloGatherOpModel(input, indices,
+                               TensorData(input.type, {2, 3, 2, 2}), params) {}
+
+  // The rank of `output` gives the rank of the result. Uses the builtin
+  // kernel if `registration` is null.
+  StablehloGatherOpModel(const TensorData& input, const TensorData& indices,
+                         const TensorData& output,
+                         const TfLiteStablehloGatherParams& params,
+                         TfLiteRegistration* registration = nullptr,
+                         int num_threads = -1) {
     input_ = AddInput(input);
     indices_ = AddInput(indices);
-    output_ = AddOutput(TensorData(input.type, {2, 3, 2, 2}));
+    output_ = AddOutput(output);
     SetBuiltinOp(
         BuiltinOperator_STABLEHLO_GATHER,
         BuiltinOptions2_StablehloGatherOptions,
@@ -56,7 +77,13 @@ class StablehloGatherOpModel : public SingleOpModel {
                             params.slice_sizes + params.num_slice_sizes)),
             params.indices_are_sorted)
             .Union());
-    BuildInterpreter({GetShape(input_), GetShape(indices_)});
+    if (registration != nullptr) {
+      SetResolver(std::make_unique<SingleOpResolver>(
+          BuiltinOperator_STABLEHLO_GATHER, registration));
+    }
+    BuildInterpreter({GetShape(input_), GetShape(indices_)}, num_threads,
+                     /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/true);
   }
 
   template <typename T>
@@ -64,11 +91,21 @@ class StablehloGatherOpModel : public SingleOpModel {
     PopulateTensor<T>(input_, data);
   }
 
+  template <typename T>
+  void SetInput(const std::vector<T>& data) {
+    PopulateTensor<T>(input_, data);
+  }
+
   template <typename T>
   void SetIndices(std::initializer_list<T> data) {
     PopulateTensor<T>(indices_, data);
   }
 
+  template <typename T>
+  void SetIndices(const std::vector<T>& data) {
+    PopulateTensor<T>(indices_, data);
+  }
+
   template <typename T>
   std::vector<T> GetOutput() {
     return ExtractVector<T>(output_);
@@ -181,5 +218,131 @@ TEST(StablehloScatterOpTest, WorksWithDynamicShapes) {
   EXPECT_THAT(model.GetOutput<float>(), ElementsAreArray(expected_values));
 }
 
+TEST(StablehloGatherOpTest, GathersWithImplicitIndexVectorDim) {
+  TfLiteStablehloGatherParams params = {
+      {1},     // offset_dims
+      1,       // num_offset_dims;
+      {0},     // collapsed_slice_dims
+      1,       // num_collapsed_slice_dims;
+      {0},     // start_index_map
+      1,       // num_start_index_map;
+      1,       // index_vector_dim;
+      {1, 2},  // slice_sizes
+      2,       // num_slice_sizes;
+      false    // indices_are_sorted;
+  };
+  StablehloGatherOpModel model({TensorType_FLOAT32, {3, 2}},
+                               {TensorType_INT32, {2}},
+                               {TensorType_FLOAT32, {2, 2}}, params);
+
+  model.SetInput<float>({1, 2, 3, 4, 5, 6});
+  model.SetIndices<int32_t>({2, 0});
+
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  EXPECT_THAT(model.GetOutput<float>(), ElementsAreArray({5, 6, 1, 2}));
+}
+
+struct GatherTestCase {
+  std::vector<int> operand_shape;
+  std::vector<int> indices_shape;
+  int result_rank;
+  TfLiteStablehloGatherParams params;
+};
+
+int NumElements(const std::vector<int>& shape) {
+  return std::accumulate(shape.begin(), shape.end(), 1,
+                         std::multiplies<int>());
+}
+
+// Runs the gather with the given kernel on `num_threads` threads, with
+// starting indices that are partly out of bounds.
+std::vector<float> Gather(const GatherTestCase& test_case,
+                          TfLiteRegistration* registration, int num_threads) {
+  StablehloGatherOpModel model(
+      {TensorType_FLOAT32, test_case.operand_shape},
+      {TensorType_INT64, test_case.indices_shape},
+      {TensorType_FLOAT32, std::vector<int>(test_case.result_rank, 1)},
+      test_case.params, registration, num_threads);
+  std::vector<float> input(NumElements(test_case.operand_shape));
+  for (int i = 0; i < input.size(); ++i) {
+    input[i] = i;
+  }
+  std::vector<int64_t> indices(NumElements(test_case.indices_shape));
+  for (int i = 0; i < indices.size(); ++i) {
+    indices[i] = (i * 37) % (test_case.operand_shape[0] + 20) - 10;
+  }
+  model.SetInput(input);
+  model.SetIndices(indices);
+  EXPECT_EQ(model.Invoke(), kTfLiteOk);
+  return model.GetOutput<float>();
+}
+
+TEST(StablehloGatherOpTest, OptimizedKernelMatchesReference) {
+  const std::vector<GatherTestCase> test_cases = {
+      // Rows of a matrix, enough to shard them.
+      {{300, 64},
+       {257, 1},
+       2,
+       {{1}, 1, {0}, 1, {0}, 1, 1, {1, 64}, 2, false}},
+      // Windows that are only contiguous along their innermost dim.
+      {{40, 30, 8},
+       {50, 2},
+       4,
+       {{1, 2, 3}, 3, {}, 0, {1, 0}, 2, 1, {3, 5, 8}, 3, false}},
+      // Offset dims that aren't trailing, which the optimized kernel computes
+      // like the reference one.
+      {{30, 8}, {20, 1}, 2, {{0}, 1, {0}, 1, {0}, 1, 1, {1, 8}, 2, false}},
+  };
+  for (const GatherTestCase& test_case : test_cases) {
+    const std::vector<float> expected =
+        Gather(test_case, ops::builtin::Register_STABLEHLO_GATHER_REF(),
+               /*num_threads=*/1);
+    for (int num_threads : {1, 4}) {
+      EXPECT_THAT(
+          Gather(test_case,
+                 ops::builtin::Register_STABLEHLO_GATHER_GENERIC_OPT(),
+                 num_threads),
+          ElementsAreArray(expected));
+    }
+  }
+}
+
+// Measures an embedding lookup of 1024 rows of 256 floats. `state.range(0)`
+// selects the reference (0) or the optimized (1) kernel.
+void BM_StablehloGatherRows(benchmark::State& state) {
+  constexpr int kNumRows = 4096;
+  constexpr int kRowSize = 256;
+  constexpr int kNumIndices = 1024;
+  TfLiteStablehloGatherParams params = {
+      {1}, 1, {0}, 1, {0}, 1, 1, {1, kRowSize}, 2, false};
+  StablehloGatherOpModel model(
+      {TensorType_FLOAT32, {kNumRows, kRowSize}},
+      {TensorType_INT32, {kNumIndices, 1}},
+      {TensorType_FLOAT32, {kNumIndices, kRowSize}}, params,
+      state.range(0) == 0
+          ? ops::builtin::Register_STABLEHLO_GATHER_REF()
+          : ops::builtin::Register_STABLEHLO_GATHER_GENERIC_OPT(),
+      /*num_threads=*/state.range(1));
+  model.SetInput(std::vector<float>(kNumRows * kRowSize, 1.0f));
+  std::vector<int32_t> indices(kNumIndices);
+  for (int i = 0; i < kNumIndices; ++i) {
+    indices[i] = (i * 97) % kNumRows;
+  }
+  model.SetIndices(indices);
+  for (auto _ : state) {
+    if (model.Invoke() != kTfLiteOk) {
+      state.SkipWithError("Invoke failed");
+      break;
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * kNumIndices * kRowSize *
+                          sizeof(float));
+}
+BENCHMARK(BM_StablehloGatherRows)
+    ->ArgNames({"optimized", "threads"})
+    ->ArgsProduct({{0, 1}, {1, 4}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
 }  // namespace
 }  // namespace tflite
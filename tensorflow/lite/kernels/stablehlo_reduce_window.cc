@@ -30,6 +30,8 @@ limitations under the License.
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/util.h"
 
@@ -466,6 +468,139 @@ void ReduceWindow(const ReduceWindowData& ctx, const Type* const input,
                              ctx.rank, /*depth=*/0);
 }
 
+// Reduces all the windows of a row of the output, i.e. of its innermost
+// dimension, at once.
+//
+// The windows are walked together, one window element at a time, so that the
+// inner loop is an elementwise operation between the output row and a view of
+// the input with the given stride. The compiler vectorizes it, in particular
+// when the stride is 1. Each output element still sees the window elements in
+// the same order as with StridedReduce, which gives the same results, even
+// for floating point types.
+template <class Op, class Type>
+void ReduceWindowRow(const Type* input, Type* output, const int64_t row_size,
+                     const int64_t row_stride,
+                     const int64_t* const window_shape,
+                     const int64_t* const window_reduce_strides,
+                     const int rank, const int depth) {
+  const int64_t stride = window_reduce_strides[depth];
+  const int64_t size = window_shape[depth];
+  if (depth + 1 == rank) {
+    const Op op;
+    for (int64_t k = 0; k < size; ++k) {
+      if (row_stride == 1) {
+        for (int64_t i = 0; i < row_size; ++i) {
+          output[i] = op(output[i], input[i]);
+        }
+      } else {
+        for (int64_t i = 0; i < row_size; ++i) {
+          output[i] = op(output[i], input[i * row_stride]);
+        }
+      }
+      input += stride;
+    }
+  } else {
+    for (int64_t k = 0; k < size; ++k) {
+      ReduceWindowRow<Op, Type>(input, output, row_size, row_stride,
+                                window_shape, window_reduce_strides, rank,
+                                depth + 1);
+      input += stride;
+    }
+  }
+}
+
+// Computes the rows of the output in [begin, end), a row being a slice of the
+// output along its innermost dimension. Rows are numbered in row-major order.
+template <class Op, class Type>
+void ReduceWindowRows(const ReduceWindowData& ctx, const Type* input,
+                      const Type init, Type* output, const int64_t begin,
+                      const int64_t end) {
+  const int last_dim = ctx.rank - 1;
+  const int64_t row_size = ctx.output_shape[last_dim];
+  for (int64_t row = begin; row < end; ++row) {
+    // Finds the first element of the first window of the row.
+    int64_t input_offset = 0;
+    int64_t outer_index = row;
+    for (int dim = last_dim - 1; dim >= 0; --dim) {
+      input_offset += (outer_index % ctx.output_shape[dim]) *
+                      ctx.window_offset_strides[dim];
+      outer_index /= ctx.output_shape[dim];
+    }
+    Type* const output_row = output + row * row_size;
+    std::fill(output_row, output_row + row_size, init);
+    ReduceWindowRow<Op, Type>(input + input_offset, output_row, row_size,
+                              ctx.window_offset_strides[last_dim],
+                              ctx.window_shape, ctx.window_reduce_strides,
+                              ctx.rank, /*depth=*/0);
+  }
+}
+
+template <class Op, class Type>
+struct ReduceWindowTask : cpu_backend_threadpool::Task {
+  ReduceWindowTask(const ReduceWindowData& ctx, const Type* input,
+                   const Type init, Type* output, int64_t begin, int64_t end)
+      : ctx(ctx),
+        input(input),
+        init(init),
+        output(output),
+        begin(begin),
+        end(end) {}
+
+  void Run() override {
+    ReduceWindowRows<Op, Type>(ctx, input, init, output, begin, end);
+  }
+
+ private:
+  const ReduceWindowData& ctx;
+  const Type* input;
+  const Type init;
+  Type* output;
+  int64_t begin;
+  int64_t end;
+};
+
+// Minimum number of reduction steps computed by each thread of a sharded
+// reduce window.
+constexpr int64_t kMinReductionsPerThread = 32 * 1024;
+
+// Optimized version of ReduceWindow that reduces the output a row at a time
+// and shards the rows over the threads of the CPU backend when there is enough
+// work.
+template <class Op, class Type>
+void ReduceWindowOptimized(const ReduceWindowData& ctx,
+                           const Type* const input, const Type init,
+                           Type* output,
+                           CpuBackendContext* cpu_backend_context) {
+  int64_t num_rows = 1;
+  int64_t reductions = 1;
+  for (int i = 0; i < ctx.rank; ++i) {
+    if (i + 1 < ctx.rank) {
+      num_rows *= ctx.output_shape[i];
+    }
+    reductions *= ctx.output_shape[i] * ctx.window_shape[i];
+  }
+  const int64_t max_thread_count =
+      std::min(num_rows, reductions / kMinReductionsPerThread);
+  const int thread_count = std::max<int64_t>(
+      1, std::min<int64_t>(cpu_backend_context->max_num_threads(),
+                           max_thread_count));
+  if (thread_count == 1) {
+    ReduceWindowRows<Op, Type>(ctx, input, init, output, /*begin=*/0,
+                               num_rows);
+    return;
+  }
+  std::vector<ReduceWindowTask<Op, Type>> tasks;
+  tasks.reserve(thread_count);
+  int64_t begin = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    const int64_t end = begin + (num_rows - begin) / (thread_count - i);
+    tasks.emplace_back(ctx, input, init, output, begin, end);
+    begin = end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
 }  // namespace
 }  // namespace reduce_window
 
@@ -474,6 +609,13 @@ void ReduceWindow(const ReduceWindowData& ctx, const Type* const input,
 namespace reduce_window_op {
 namespace {
 
+// This file has a reference implementation of the reduction, which reduces one
+// window at a time, and an optimized one.
+enum KernelType {
+  kReference,
+  kGenericOptimized,
+};
+
 // Holds the data needed throughout the node lifetime.
 struct NodeData {
   // These members are only for STABLEHLO_REDUCE_WINDOW
@@ -801,7 +943,7 @@ struct TFLiteData : public OpData {
 // [STABLEHLO_]REDUCE_WINDOW op.
 //
 // The ops that aren't needed are skipped.
-template <class Op, class Type>
+template <KernelType kernel_type, class Op, class Type>
 void PadCropReduceWindow(const OpData& op_ctx) {
   NodeData& node_data = *reinterpret_cast<NodeData*>(op_ctx.node->user_data);
   const char* input = op_ctx.input;
@@ -821,18 +963,26 @@ void PadCropReduceWindow(const OpData& op_ctx) {
     input_shape = node_data.pad_ctx.output_shape;
   }
 
-  reduce_window::ReduceWindow<Op, Type>(
-      node_data.reduce_window_ctx, reinterpret_cast<const Type*>(input),
-      *reinterpret_cast<const Type*>(op_ctx.init_value),
-      reinterpret_cast<Type*>(op_ctx.output));
+  if (kernel_type == kGenericOptimized) {
+    reduce_window::ReduceWindowOptimized<Op, Type>(
+        node_data.reduce_window_ctx, reinterpret_cast<const Type*>(input),
+        *reinterpret_cast<const Type*>(op_ctx.init_value),
+        reinterpret_cast<Type*>(op_ctx.output),
+        CpuBackendContext::GetFromContext(op_ctx.context));
+  } else {
+    reduce_window::ReduceWindow<Op, Type>(
+        node_data.reduce_window_ctx, reinterpret_cast<const Type*>(input),
+        *reinterpret_cast<const Type*>(op_ctx.init_value),
+        reinterpret_cast<Type*>(op_ctx.output));
+  }
 }
 
 // Dispatches to the template implementation according to the tensor type.
-template <class Op>
+template <KernelType kernel_type, class Op>
 TfLiteStatus DispatchReduceWindowType(OpData& ctx) {
-#define REDUCE_WINDOW_TYPE_CASE(CPP_TYPE, TENSOR_TYPE) \
-  case TENSOR_TYPE:                                    \
-    PadCropReduceWindow<Op, CPP_TYPE>(ctx);            \
+#define REDUCE_WINDOW_TYPE_CASE(CPP_TYPE, TENSOR_TYPE)   \
+  case TENSOR_TYPE:                                      \
+    PadCropReduceWindow<kernel_type, Op, CPP_TYPE>(ctx); \
     break;
   switch (ctx.type) {
     REDUCE_WINDOW_TYPE_CASE(int8_t, kTfLiteBool);
@@ -869,6 +1019,7 @@ struct Min {
 };
 
 // Dispatches to the template instanciation according to the reduction body.
+template <KernelType kernel_type>
 TfLiteStatus DispatchReduceWindowBody(OpData& ctx) {
   const NodeData& node_data = *static_cast<NodeData*>(ctx.node->user_data);
   switch (node_data.body) {
@@ -877,17 +1028,17 @@ TfLiteStatus DispatchReduceWindowBody(OpData& ctx) {
                          __FILE__, __LINE__);
       return kTfLiteError;
     case TfLiteReduceWindowFunctionAdd:
-      return DispatchReduceWindowType<std::plus<>>(ctx);
+      return DispatchReduceWindowType<kernel_type, std::plus<>>(ctx);
     case TfLiteReduceWindowFunctionMul:
-      return DispatchReduceWindowType<std::multiplies<>>(ctx);
+      return DispatchReduceWindowType<kernel_type, std::multiplies<>>(ctx);
     case TfLiteReduceWindowFunctionAll:
-      return DispatchReduceWindowType<std::logical_and<>>(ctx);
+      return DispatchReduceWindowType<kernel_type, std::logical_and<>>(ctx);
     case TfLiteReduceWindowFunctionAny:
-      return DispatchReduceWindowType<std::logical_or<>>(ctx);
+      return DispatchReduceWindowType<kernel_type, std::logical_or<>>(ctx);
     case TfLiteReduceWindowFunctionMin:
-      return DispatchReduceWindowType<Min>(ctx);
+      return DispatchReduceWindowType<kernel_type, Min>(ctx);
     case TfLiteReduceWindowFunctionMax:
-      return DispatchReduceWindowType<Max>(ctx);
+      return DispatchReduceWindowType<kernel_type, Max>(ctx);
   }
   TF_LITE_KERNEL_LOG(ctx.context, "%s:%d unhandled reduction body case.\n",
                      __FILE__, __LINE__);
@@ -922,7 +1073,7 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   return ctx.Setup();
 }
 
-template <class Semantic>
+template <class Semantic, KernelType kernel_type>
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   Semantic ctx(context, node);
   TF_LITE_ENSURE_OK(context, ctx.Initialize());
@@ -935,30 +1086,64 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       context, node_data.pad_ctx.skip || node_data.pad_ctx.output_size > 0,
       "The padding specification of stablehlo.reduce_window gives an empty "
       "tensor.");
-  return DispatchReduceWindowBody(ctx);
+  return DispatchReduceWindowBody<kernel_type>(ctx);
 }
 
 }  // namespace
 }  // namespace reduce_window_op
 
-TfLiteRegistration* Register_STABLEHLO_REDUCE_WINDOW() {
+TfLiteRegistration* Register_STABLEHLO_REDUCE_WINDOW_REF() {
   static TfLiteRegistration r = {
       /*.init=*/reduce_window_op::StablehloInit,
       /*.free=*/reduce_window_op::Free,
       /*.prepare=*/reduce_window_op::Prepare<reduce_window_op::StablehloData>,
-      /*.invoke=*/reduce_window_op::Eval<reduce_window_op::StablehloData>};
+      /*.invoke=*/
+      reduce_window_op::Eval<reduce_window_op::StablehloData,
+                             reduce_window_op::kReference>};
   return &r;
 }
 
-TfLiteRegistration* Register_REDUCE_WINDOW() {
+TfLiteRegistration* Register_STABLEHLO_REDUCE_WINDOW_GENERIC_OPT() {
+  static TfLiteRegistration r = {
+      /*.init=*/reduce_window_op::StablehloInit,
+      /*.free=*/reduce_window_op::Free,
+      /*.prepare=*/reduce_window_op::Prepare<reduce_window_op::StablehloData>,
+      /*.invoke=*/
+      reduce_window_op::Eval<reduce_window_op::StablehloData,
+                             reduce_window_op::kGenericOptimized>};
+  return &r;
+}
+
+TfLiteRegistration* Register_STABLEHLO_REDUCE_WINDOW() {
+  return Register_STABLEHLO_REDUCE_WINDOW_GENERIC_OPT();
+}
+
+TfLiteRegistration* Register_REDUCE_WINDOW_REF() {
   static TfLiteRegistration r = {
       /*.init=*/reduce_window_op::TFLiteInit,
       /*.free=*/reduce_window_op::Free,
       /*.prepare=*/reduce_window_op::Prepare<reduce_window_op::TFLiteData>,
-      /*.invoke=*/reduce_window_op::Eval<reduce_window_op::TFLiteData>};
+      /*.invoke=*/
+      reduce_window_op::Eval<reduce_window_op::TFLiteData,
+                             reduce_window_op::kReference>};
   return &r;
 }
 
+TfLiteRegistration* Register_REDUCE_WINDOW_GENERIC_OPT() {
+  static TfLiteRegistration r = {
+      /*.init=*/reduce_window_op::TFLiteInit,
+      /*.free=*/reduce_window_op::Free,
+      /*.prepare=*/reduce_window_op::Prepare<reduce_window_op::TFLiteData>,
+      /*.invoke=*/
+      reduce_window_op::Eval<reduce_window_op::TFLiteData,
+                             reduce_window_op::kGenericOptimized>};
+  return &r;
+}
+
+TfLiteRegistration* Register_REDUCE_WINDOW() {
+  return Register_REDUCE_WINDOW_GENERIC_OPT();
+}
+
 }  // namespace builtin
 }  // namespace ops
 }  // namespace tflite
@@ -18,6 +18,7 @@ limitations under the License.
 #include <functional>
 #include <initializer_list>
 #include <limits>
+#include <memory>
 #include <ostream>
 #include <type_traits>
 #include <vector>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "absl/random/distributions.h"
 #include "absl/random/random.h"
 #include "absl/types/span.h"
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/kernels/stablehlo_reduce_window_test_util.h"
@@ -38,6 +40,13 @@ limitations under the License.
 #include "tensorflow/lite/schema/schema_generated.h"
 
 namespace tflite {
+namespace ops {
+namespace builtin {
+TfLiteRegistration* Register_STABLEHLO_REDUCE_WINDOW_REF();
+TfLiteRegistration* Register_STABLEHLO_REDUCE_WINDOW_GENERIC_OPT();
+}  // namespace builtin
+}  // namespace ops
+
 namespace reduce_window {
 namespace {
 
@@ -199,6 +208,13 @@ class ReduceWindowOpModel : public SingleOpModel {
 
   void SetBody(const BodyFunction func) { body_function_ = func; }
 
+  void SetNumThreads(int num_threads) { num_threads_ = num_threads; }
+
+  // Uses the builtin kernel if `registration` is null.
+  void SetRegistration(TfLiteRegistration* registration) {
+    registration_ = registration;
+  }
+
   TfLiteStatus Build() {
     constexpr int kBodySubGraphIndex = 1;
 
@@ -227,10 +243,14 @@ class ReduceWindowOpModel : public SingleOpModel {
                      builder_.CreateVector(padding_), kBodySubGraphIndex)
                      .Union());
 
+    if (registration_ != nullptr) {
+      SetResolver(std::make_unique<SingleOpResolver>(
+          BuiltinOperator_STABLEHLO_REDUCE_WINDOW, registration_));
+    }
     BuildInterpreter(
         /*input_shapes=*/{std::vector<int>(input_shape_.begin(),
                                            input_shape_.end())},
-        /*num_threads=*/-1, /*allow_fp32_relax_to_fp16=*/false,
+        num_threads_, /*allow_fp32_relax_to_fp16=*/false,
         /*apply_delegate=*/true, /*allocate_and_delegate=*/false);
 
     int body_subgraph_index;
@@ -355,6 +375,8 @@ class ReduceWindowOpModel : public SingleOpModel {
   std::vector<int64_t> window_dilations_;
   std::vector<int64_t> padding_;
   BodyFunction body_function_{};
+  int num_threads_ = -1;
+  TfLiteRegistration* registration_ = nullptr;
   subgraph_test_util::SubgraphBuilder subgraph_builder_;
 };
 
@@ -796,6 +818,78 @@ TYPED_TEST(StablehloReduceWindowTest, FuzzyTest) {
   }
 }
 
+TYPED_TEST(StablehloReduceWindowTest, MultiThreadedMatchesReference) {
+  absl::BitGen bitgen;
+
+  for (BodyFunction func : {BodyFunction::kAdd, BodyFunction::kMax}) {
+    for (TfLiteRegistration* registration :
+         {ops::builtin::Register_STABLEHLO_REDUCE_WINDOW_REF(),
+          ops::builtin::Register_STABLEHLO_REDUCE_WINDOW_GENERIC_OPT()}) {
+      ReduceWindowOpModel<TypeParam> model;
+      const Body body{func};
+      model.SetInput(/*shape=*/{2, 16, 40, 40}, bitgen, /*min=*/-5, /*max=*/5);
+      model.SetBaseDilations({1, 1, 1, 1});
+      model.SetPadding({0, 0, 0, 0, 1, 1, 0, 2});
+      model.SetWindowDimensions({1, 2, 3, 3});
+      model.SetWindowStrides({1, 1, 2, 2});
+      model.SetWindowDilations({1, 1, 1, 2});
+      model.SetInitValue(body.init_value<TypeParam>());
+      model.SetBody(func);
+      model.SetNumThreads(4);
+      model.SetRegistration(registration);
+
+      const reference::Tensor<TypeParam> expected = reference::ReduceWindow(
+          reference::Tensor<TypeParam>{/*shape=*/model.GetInputShape(),
+                                       /*data=*/model.GetInput()},
+          model.GetBaseDilations(), model.GetPadding(), model.GetInitValue(),
+          model.GetWindowDimensions(), model.GetWindowDilations(),
+          model.GetWindowStrides(), body);
+
+      ASSERT_EQ(model.BuildAndInvoke(), kTfLiteOk);
+      EXPECT_THAT(model.GetOutputShape(), ElementsAreArray(expected.shape))
+          << model;
+      EXPECT_THAT(model.GetOutputData(), ElementsAreArray(expected.data))
+          << model;
+    }
+  }
+}
+
+// Measures a 3x3 max pooling with stride 2 of a [1, 64, 112, 112] tensor.
+// `state.range(0)` selects the reference (0) or the optimized (1) kernel.
+void BM_StablehloReduceWindowMaxPool(benchmark::State& state) {
+  absl::BitGen bitgen;
+  ReduceWindowOpModel<float> model;
+  model.SetInput(/*shape=*/{1, 64, 112, 112}, bitgen, /*min=*/-1, /*max=*/1);
+  model.SetBaseDilations({1, 1, 1, 1});
+  model.SetPadding({0, 0, 0, 0, 0, 1, 0, 1});
+  model.SetWindowDimensions({1, 1, 3, 3});
+  model.SetWindowStrides({1, 1, 2, 2});
+  model.SetWindowDilations({1, 1, 1, 1});
+  model.SetInitValue(std::numeric_limits<float>::lowest());
+  model.SetBody(BodyFunction::kMax);
+  model.SetNumThreads(state.range(1));
+  model.SetRegistration(
+      state.range(0) == 0
+          ? ops::builtin::Register_STABLEHLO_REDUCE_WINDOW_REF()
+          : ops::builtin::Register_STABLEHLO_REDUCE_WINDOW_GENERIC_OPT());
+  if (model.Build() != kTfLiteOk) {
+    state.SkipWithError("Build failed");
+    return;
+  }
+  for (auto _ : state) {
+    if (model.Invoke() != kTfLiteOk) {
+      state.SkipWithError("Invoke failed");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * model.GetInput().size());
+}
+BENCHMARK(BM_StablehloReduceWindowMaxPool)
+    ->ArgNames({"optimized", "threads"})
+    ->ArgsProduct({{0, 1}, {1, 4}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
 }  // namespace
 }  // namespace reduce_window
 }  // namespace tflite
@@ -26,6 +26,8 @@ limitations under the License.
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 #include "tensorflow/lite/kernels/internal/runtime_shape.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/internal/types.h"
@@ -36,6 +38,15 @@ namespace tflite {
 namespace ops {
 namespace builtin {
 namespace stablehlo_scatter {
+
+// This file has a reference implementation of the scatter, walking the
+// updates one element at a time, and an optimized one for the common
+// dimension numbers.
+enum KernelType {
+  kReference,
+  kGenericOptimized,
+};
+
 namespace {
 
 constexpr int kInputsTensor = 0;
@@ -43,6 +54,9 @@ constexpr int kScatterIndicesTensor = 1;
 constexpr int kUpdatesTensor = 2;
 constexpr int kOutputTensor = 0;
 
+// Minimum number of update bytes for each thread of a sharded scatter.
+constexpr int64_t kMinBytesPerThread = 16 * 1024;
+
 // Indicates the type of the computation performed in the op region of the
 // scatter kernel.
 enum class ComputationType {
@@ -196,9 +210,277 @@ static TfLiteStatus ApplyComputation(TfLiteTensor* tensor,
   return kTfLiteOk;
 }
 
+// Holds the parameters of a scatter whose updates are a sequence of whole
+// windows, one per scatter index.
+//
+// This is the case when the update window dims are the trailing dims of the
+// updates and the index vectors are the innermost dim of scatter_indices,
+// which covers most scatters in practice, e.g. updating rows of a matrix or a
+// KV cache. Each window is then applied to the part of the output it overlaps,
+// one contiguous row at a time, instead of computing the index of each update
+// element.
+struct WindowScatter {
+  int64_t num_windows = 0;
+  int64_t index_vector_size = 0;
+  int64_t window_elements = 0;
+  std::vector<int64_t> output_dims;
+  // The shape of a window in the output, i.e. the window dims of the updates
+  // with the inserted window dims of size 1.
+  std::vector<int64_t> window_shape;
+  std::vector<int64_t> output_strides;
+  std::vector<int64_t> window_strides;
+};
+
+// Returns true if the scatter can be computed with a WindowScatter, and fills
+// `scatter`.
+bool GetWindowScatter(const TfLiteStablehloScatterParams& params,
+                      const RuntimeShape& input_shape,
+                      const RuntimeShape& scatter_indices_shape,
+                      const RuntimeShape& updates_shape,
+                      WindowScatter* scatter) {
+  const int input_rank = input_shape.DimensionsCount();
+  const int indices_rank = scatter_indices_shape.DimensionsCount();
+  const int updates_rank = updates_shape.DimensionsCount();
+  const int num_scatter_dims = updates_rank - params.num_update_window_dims;
+  if (input_rank == 0 || params.num_update_window_dims +
+                                 params.num_inserted_window_dims !=
+                             input_rank) {
+    return false;
+  }
+  for (int i = 0; i < params.num_update_window_dims; ++i) {
+    if (params.update_window_dims[i] != num_scatter_dims + i) {
+      return false;
+    }
+  }
+  if (params.index_vector_dim == indices_rank) {
+    scatter->index_vector_size = 1;
+  } else if (params.index_vector_dim == indices_rank - 1) {
+    scatter->index_vector_size = scatter_indices_shape.Dims(indices_rank - 1);
+  } else {
+    return false;
+  }
+  if (params.num_scatter_dims_to_operand_dims != scatter->index_vector_size) {
+    return false;
+  }
+  for (int i = 0; i < params.num_scatter_dims_to_operand_dims; ++i) {
+    if (params.scatter_dims_to_operand_dims[i] < 0 ||
+        params.scatter_dims_to_operand_dims[i] >= input_rank) {
+      return false;
+    }
+  }
+
+  scatter->output_dims.resize(input_rank);
+  scatter->window_shape.resize(input_rank);
+  scatter->window_elements = 1;
+  int update_window_dim = num_scatter_dims;
+  for (int dim = 0; dim < input_rank; ++dim) {
+    scatter->output_dims[dim] = input_shape.Dims(dim);
+    if (ArrayContains(params.inserted_window_dims,
+                      params.num_inserted_window_dims, dim)) {
+      scatter->window_shape[dim] = 1;
+    } else if (update_window_dim < updates_rank) {
+      scatter->window_shape[dim] = updates_shape.Dims(update_window_dim++);
+    } else {
+      return false;
+    }
+    scatter->window_elements *= scatter->window_shape[dim];
+  }
+  if (update_window_dim != updates_rank) {
+    return false;
+  }
+  scatter->num_windows = 1;
+  for (int dim = 0; dim < num_scatter_dims; ++dim) {
+    scatter->num_windows *= updates_shape.Dims(dim);
+  }
+  if (scatter->num_windows * scatter->index_vector_size !=
+      scatter_indices_shape.FlatSize()) {
+    return false;
+  }
+
+  scatter->output_strides.resize(input_rank);
+  scatter->window_strides.resize(input_rank);
+  scatter->output_strides[input_rank - 1] = 1;
+  scatter->window_strides[input_rank - 1] = 1;
+  for (int dim = input_rank - 2; dim >= 0; --dim) {
+    scatter->output_strides[dim] =
+        scatter->output_strides[dim + 1] * scatter->output_dims[dim + 1];
+    scatter->window_strides[dim] =
+        scatter->window_strides[dim + 1] * scatter->window_shape[dim + 1];
+  }
+  return true;
+}
+
+struct Update {
+  template <typename T>
+  T operator()(const T& input, const T& update) const {
+    return update;
+  }
+};
+
+struct Add {
+  template <typename T>
+  T operator()(const T& input, const T& update) const {
+    return input + update;
+  }
+};
+
+struct Multiply {
+  template <typename T>
+  T operator()(const T& input, const T& update) const {
+    return input * update;
+  }
+};
+
+struct Maximum {
+  template <typename T>
+  T operator()(const T& input, const T& update) const {
+    return std::max(input, update);
+  }
+};
+
+struct Minimum {
+  template <typename T>
+  T operator()(const T& input, const T& update) const {
+    return std::min(input, update);
+  }
+};
+
+// Applies the part of a window in the box [begin, end) to the output.
+// `output_offset` and `update_offset` are the offsets of the window's origin.
+template <typename Op, typename DataType>
+void ApplyWindow(const WindowScatter& scatter, const int64_t* begin,
+                 const int64_t* end, const DataType* updates,
+                 int64_t update_offset, DataType* output,
+                 int64_t output_offset, int depth) {
+  if (depth + 1 == scatter.window_shape.size()) {
+    const Op op;
+    const DataType* update_row = updates + update_offset;
+    DataType* output_row = output + output_offset;
+    for (int64_t i = begin[depth]; i < end[depth]; ++i) {
+      output_row[i] = op(output_row[i], update_row[i]);
+    }
+    return;
+  }
+  for (int64_t i = begin[depth]; i < end[depth]; ++i) {
+    ApplyWindow<Op>(scatter, begin, end, updates,
+                    update_offset + i * scatter.window_strides[depth], output,
+                    output_offset + i * scatter.output_strides[depth],
+                    depth + 1);
+  }
+}
+
+// Applies all the windows to the rows of the output in [row_begin, row_end)
+// along its first dim. The windows are applied in order, so that overlapping
+// updates give the same result as the reference implementation. As in that
+// implementation, the parts of the windows that are out of bounds are ignored.
+template <typename Op, typename IndexType, typename DataType>
+void ScatterWindows(const WindowScatter& scatter,
+                    const TfLiteStablehloScatterParams& params,
+                    const IndexType* scatter_indices, const DataType* updates,
+                    int64_t row_begin, int64_t row_end, DataType* output) {
+  const int rank = scatter.window_shape.size();
+  std::vector<int64_t> start_index(rank);
+  std::vector<int64_t> begin(rank);
+  std::vector<int64_t> end(rank);
+  for (int64_t window = 0; window < scatter.num_windows; ++window) {
+    const IndexType* index_vector =
+        scatter_indices + window * scatter.index_vector_size;
+    std::fill(start_index.begin(), start_index.end(), 0);
+    for (int i = 0; i < params.num_scatter_dims_to_operand_dims; ++i) {
+      start_index[params.scatter_dims_to_operand_dims[i]] = index_vector[i];
+    }
+    bool empty = false;
+    int64_t output_offset = 0;
+    for (int dim = 0; dim < rank; ++dim) {
+      const int64_t dim_begin = dim == 0 ? row_begin : 0;
+      const int64_t dim_end = dim == 0 ? row_end : scatter.output_dims[dim];
+      begin[dim] = std::max<int64_t>(0, dim_begin - start_index[dim]);
+      end[dim] = std::min<int64_t>(scatter.window_shape[dim],
+                                   dim_end - start_index[dim]);
+      empty |= begin[dim] >= end[dim];
+      output_offset += start_index[dim] * scatter.output_strides[dim];
+    }
+    if (!empty) {
+      ApplyWindow<Op>(scatter, begin.data(), end.data(), updates,
+                      window * scatter.window_elements, output, output_offset,
+                      /*depth=*/0);
+    }
+  }
+}
+
+template <typename Op, typename IndexType, typename DataType>
+struct ScatterWindowsTask : cpu_backend_threadpool::Task {
+  ScatterWindowsTask(const WindowScatter& scatter,
+                     const TfLiteStablehloScatterParams& params,
+                     const IndexType* scatter_indices, const DataType* updates,
+                     int64_t row_begin, int64_t row_end, DataType* output)
+      : scatter(scatter),
+        params(params),
+        scatter_indices(scatter_indices),
+        updates(updates),
+        row_begin(row_begin),
+        row_end(row_end),
+        output(output) {}
+
+  void Run() override {
+    ScatterWindows<Op>(scatter, params, scatter_indices, updates, row_begin,
+                       row_end, output);
+  }
+
+ private:
+  const WindowScatter& scatter;
+  const TfLiteStablehloScatterParams& params;
+  const IndexType* scatter_indices;
+  const DataType* updates;
+  int64_t row_begin;
+  int64_t row_end;
+  DataType* output;
+};
+
+// Computes a WindowScatter, sharding the rows of the output over the threads
+// of the CPU backend when there are enough updates. Each thread walks all the
+// windows but only writes its own rows, so no two threads write the same
+// element.
+template <typename Op, typename IndexType, typename DataType>
+void EvalWindowScatter(TfLiteContext* context, const WindowScatter& scatter,
+                       const TfLiteStablehloScatterParams& params,
+                       const TfLiteTensor* scatter_indices,
+                       const TfLiteTensor* updates, TfLiteTensor* output) {
+  const IndexType* scatter_indices_data =
+      GetTensorData<IndexType>(scatter_indices);
+  const DataType* updates_data = GetTensorData<DataType>(updates);
+  DataType* output_data = GetTensorData<DataType>(output);
+  const int64_t num_rows = scatter.output_dims[0];
+
+  CpuBackendContext* cpu_backend_context =
+      CpuBackendContext::GetFromContext(context);
+  const int64_t max_thread_count = std::min<int64_t>(
+      num_rows, static_cast<int64_t>(updates->bytes) / kMinBytesPerThread);
+  const int thread_count = std::max<int64_t>(
+      1, std::min<int64_t>(cpu_backend_context->max_num_threads(),
+                           max_thread_count));
+  if (thread_count == 1) {
+    ScatterWindows<Op>(scatter, params, scatter_indices_data, updates_data,
+                       /*row_begin=*/0, num_rows, output_data);
+    return;
+  }
+  std::vector<ScatterWindowsTask<Op, IndexType, DataType>> tasks;
+  tasks.reserve(thread_count);
+  int64_t row_begin = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    const int64_t row_end =
+        row_begin + (num_rows - row_begin) / (thread_count - i);
+    tasks.emplace_back(scatter, params, scatter_indices_data, updates_data,
+                       row_begin, row_end, output_data);
+    row_begin = row_end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
 // Evaluates this node given the type of the elements in the scatter_indices
 // and the type of the elements in the input/updates tensors.
-template <typename IndexType, typename DataType>
+template <KernelType kernel_type, typename IndexType, typename DataType>
 TfLiteStatus EvalWithTypes(TfLiteContext* context, TfLiteNode* node) {
   OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
 
@@ -244,6 +526,37 @@ TfLiteStatus EvalWithTypes(TfLiteContext* context, TfLiteNode* node) {
     return kTfLiteOk;
   }
 
+  WindowScatter scatter;
+  if (kernel_type == kGenericOptimized &&
+      GetWindowScatter(*data, input_shape, scatter_indices_shape,
+                       updates_shape, &scatter)) {
+    switch (op_data->computation_type) {
+      case ComputationType::kUpdate:
+        EvalWindowScatter<Update, IndexType, DataType>(
+            context, scatter, *data, scatter_indices, updates, output);
+        return kTfLiteOk;
+      case ComputationType::kAdd:
+        EvalWindowScatter<Add, IndexType, DataType>(
+            context, scatter, *data, scatter_indices, updates, output);
+        return kTfLiteOk;
+      case ComputationType::kMultiply:
+        EvalWindowScatter<Multiply, IndexType, DataType>(
+            context, scatter, *data, scatter_indices, updates, output);
+        return kTfLiteOk;
+      case ComputationType::kMaximum:
+        EvalWindowScatter<Maximum, IndexType, DataType>(
+            context, scatter, *data, scatter_indices, updates, output);
+        return kTfLiteOk;
+      case ComputationType::kMinimum:
+        EvalWindowScatter<Minimum, IndexType, DataType>(
+            context, scatter, *data, scatter_indices, updates, output);
+        return kTfLiteOk;
+      case ComputationType::kOther:
+        // Reported by the reference implementation below.
+        break;
+    }
+  }
+
   do {
     Index<IndexType> update_scatter_index =
         GatherIndex(update_index, update_scatter_dims);
@@ -296,34 +609,34 @@ TfLiteStatus EvalWithTypes(TfLiteContext* context, TfLiteNode* node) {
 
 // Evaluates this node given the type of the elements in the scatter_indices
 // tensor.
-template <typename IndexType>
+template <KernelType kernel_type, typename IndexType>
 TfLiteStatus EvalWithIndexType(TfLiteContext* context, TfLiteNode* node,
                                TfLiteType index_type, TfLiteType data_type) {
   switch (data_type) {
     case kTfLiteFloat16:
-      return EvalWithTypes<IndexType, Eigen::half>(context, node);
+      return EvalWithTypes<kernel_type, IndexType, Eigen::half>(context, node);
     case kTfLiteFloat32:
-      return EvalWithTypes<IndexType, float>(context, node);
+      return EvalWithTypes<kernel_type, IndexType, float>(context, node);
     case kTfLiteFloat64:
-      return EvalWithTypes<IndexType, double>(context, node);
+      return EvalWithTypes<kernel_type, IndexType, double>(context, node);
     case kTfLiteInt8:
-      return EvalWithTypes<IndexType, int8_t>(context, node);
+      return EvalWithTypes<kernel_type, IndexType, int8_t>(context, node);
     case kTfLiteInt16:
-      return EvalWithTypes<IndexType, int16_t>(context, node);
+      return EvalWithTypes<kernel_type, IndexType, int16_t>(context, node);
     case kTfLiteInt32:
-      return EvalWithTypes<IndexType, int32_t>(context, node);
+      return EvalWithTypes<kernel_type, IndexType, int32_t>(context, node);
     case kTfLiteInt64:
-      return EvalWithTypes<IndexType, int64_t>(context, node);
+      return EvalWithTypes<kernel_type, IndexType, int64_t>(context, node);
     case kTfLiteUInt8:
-      return EvalWithTypes<IndexType, uint8_t>(context, node);
+      return EvalWithTypes<kernel_type, IndexType, uint8_t>(context, node);
     case kTfLiteUInt16:
-      return EvalWithTypes<IndexType, uint16_t>(context, node);
+      return EvalWithTypes<kernel_type, IndexType, uint16_t>(context, node);
     case kTfLiteUInt32:
-      return EvalWithTypes<IndexType, uint32_t>(context, node);
+      return EvalWithTypes<kernel_type, IndexType, uint32_t>(context, node);
     case kTfLiteUInt64:
-      return EvalWithTypes<IndexType, uint64_t>(context, node);
+      return EvalWithTypes<kernel_type, IndexType, uint64_t>(context, node);
     case kTfLiteBool:
-      return EvalWithTypes<IndexType, bool>(context, node);
+      return EvalWithTypes<kernel_type, IndexType, bool>(context, node);
     default:
       TF_LITE_KERNEL_LOG(
           context, "(Index Type: %s, Data Type: %s) currently not supported.\n",
@@ -403,6 +716,7 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
 }  // namespace
 
+template <KernelType kernel_type>
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* input;
   TF_LITE_ENSURE_OK(context,
@@ -415,9 +729,11 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   TfLiteType data_type = input->type;
 
   if (index_type == kTfLiteInt32) {
-    return EvalWithIndexType<int32_t>(context, node, index_type, data_type);
+    return EvalWithIndexType<kernel_type, int32_t>(context, node, index_type,
+                                                   data_type);
   } else if (index_type == kTfLiteInt64) {
-    return EvalWithIndexType<int64_t>(context, node, index_type, data_type);
+    return EvalWithIndexType<kernel_type, int64_t>(context, node, index_type,
+                                                   data_type);
   } else {
     TF_LITE_KERNEL_LOG(context, "(Index Type: %s) currently not supported.\n",
                        TfLiteTypeGetName(index_type));
@@ -427,13 +743,26 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 
 }  // namespace stablehlo_scatter
 
-TfLiteRegistration* Register_STABLEHLO_SCATTER() {
+TfLiteRegistration* Register_STABLEHLO_SCATTER_REF() {
+  static TfLiteRegistration r = {
+      stablehlo_scatter::Init, stablehlo_scatter::Free,
+      stablehlo_scatter::Prepare,
+      stablehlo_scatter::Eval<stablehlo_scatter::kReference>};
+  return &r;
+}
+
+TfLiteRegistration* Register_STABLEHLO_SCATTER_GENERIC_OPT() {
   static TfLiteRegistration r = {
       stablehlo_scatter::Init, stablehlo_scatter::Free,
-      stablehlo_scatter::Prepare, stablehlo_scatter::Eval};
+      stablehlo_scatter::Prepare,
+      stablehlo_scatter::Eval<stablehlo_scatter::kGenericOptimized>};
   return &r;
 }
 
+TfLiteRegistration* Register_STABLEHLO_SCATTER() {
+  return Register_STABLEHLO_SCATTER_GENERIC_OPT();
+}
+
 }  // namespace builtin
 }  // namespace ops
 }  // namespace tflite
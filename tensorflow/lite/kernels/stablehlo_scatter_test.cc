@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/subgraph.h"
@@ -28,6 +29,13 @@ limitations under the License.
 #include "tensorflow/lite/schema/schema_generated.h"
 
 namespace tflite {
+namespace ops {
+namespace builtin {
+TfLiteRegistration* Register_STABLEHLO_SCATTER_REF();
+TfLiteRegistration* Register_STABLEHLO_SCATTER_GENERIC_OPT();
+}  // namespace builtin
+}  // namespace ops
+
 namespace {
 
 using ::testing::ElementsAreArray;
@@ -36,10 +44,13 @@ enum class StablehloScatterOpType { kAdd, kMul, kMax, kMin, kUpdate };
 
 class StablehloScatterOpModel : public SingleOpModel {
  public:
+  // Uses the builtin kernel if `registration` is null.
   StablehloScatterOpModel(const TensorData& input, const TensorData& indices,
                           const TensorData& updates,
                           const TfLiteStablehloScatterParams& params,
-                          StablehloScatterOpType op_type) {
+                          StablehloScatterOpType op_type,
+                          TfLiteRegistration* registration = nullptr,
+                          int num_threads = -1) {
     input_ = AddInput(input);
     indices_ = AddInput(indices);
     updates_ = AddInput(updates);
@@ -61,8 +72,12 @@ class StablehloScatterOpModel : public SingleOpModel {
                                 params.num_scatter_dims_to_operand_dims)),
             params.index_vector_dim, params.unique_indices, 1)
             .Union());
+    if (registration != nullptr) {
+      SetResolver(std::make_unique<SingleOpResolver>(
+          BuiltinOperator_STABLEHLO_SCATTER, registration));
+    }
     BuildInterpreter({GetShape(input_), GetShape(indices_), GetShape(updates_)},
-                     /*num_threads=*/-1, /*allow_fp32_relax_to_fp16=*/false,
+                     num_threads, /*allow_fp32_relax_to_fp16=*/false,
                      /*apply_delegate=*/false, /*allocate_and_delegate=*/false);
 
     int* dummy = nullptr;
@@ -102,6 +117,21 @@ class StablehloScatterOpModel : public SingleOpModel {
     PopulateTensor<T>(updates_, data);
   }
 
+  template <typename T>
+  void SetInput(const std::vector<T>& data) {
+    PopulateTensor<T>(input_, data);
+  }
+
+  template <typename T>
+  void SetIndices(const std::vector<T>& data) {
+    PopulateTensor<T>(indices_, data);
+  }
+
+  template <typename T>
+  void SetUpdates(const std::vector<T>& data) {
+    PopulateTensor<T>(updates_, data);
+  }
+
   template <typename T>
   std::vector<T> GetOutput() {
     return ExtractVector<T>(output_);
@@ -270,5 +300,104 @@ TEST(StablehloScatterOpTest, PerformsUpdate) {
   EXPECT_THAT(model.GetOutput<float>(), ElementsAreArray(expected_values));
 }
 
+// Scatters 200 windows of shape [4, 16] into a [64, 32, 16] tensor. Some
+// windows overlap and some are out of bounds.
+std::vector<float> ScatterWindows(StablehloScatterOpType op_type,
+                                  TfLiteRegistration* registration,
+                                  int num_threads) {
+  constexpr int kNumWindows = 200;
+  TfLiteStablehloScatterParams params = {
+      false,   // indices_are_sorted
+      {1, 2},  // std::vector<update_window_dims>
+      2,       // num_update_window_dims
+      {0},     // std::vector<inserted_window_dims>
+      1,       // num_inserted_window_dims
+      {0, 1},  // std::vector<scatter_dims_to_operand_dims>
+      2,       // num_scatter_dims_to_operand_dims
+      1,       // index_vector_dim
+      false,   // unique_indices
+      1        // update_computation_subgraph_index
+  };
+  StablehloScatterOpModel model(
+      {TensorType_FLOAT32, {64, 32, 16}}, {TensorType_INT64, {kNumWindows, 2}},
+      {TensorType_FLOAT32, {kNumWindows, 4, 16}}, params, op_type,
+      registration, num_threads);
+  std::vector<float> input(64 * 32 * 16);
+  for (int i = 0; i < input.size(); ++i) {
+    input[i] = i % 101;
+  }
+  std::vector<int64_t> indices;
+  for (int i = 0; i < kNumWindows; ++i) {
+    indices.push_back((i * 7) % 70 - 3);
+    indices.push_back((i * 11) % 30);
+  }
+  std::vector<float> updates(kNumWindows * 4 * 16);
+  for (int i = 0; i < updates.size(); ++i) {
+    updates[i] = i % 13 - 6;
+  }
+  model.SetInput(input);
+  model.SetIndices(indices);
+  model.SetUpdates(updates);
+  EXPECT_EQ(model.Invoke(), kTfLiteOk);
+  return model.GetOutput<float>();
+}
+
+TEST(StablehloScatterOpTest, OptimizedKernelMatchesReference) {
+  for (StablehloScatterOpType op_type :
+       {StablehloScatterOpType::kAdd, StablehloScatterOpType::kMul,
+        StablehloScatterOpType::kMax, StablehloScatterOpType::kMin,
+        StablehloScatterOpType::kUpdate}) {
+    const std::vector<float> expected =
+        ScatterWindows(op_type, ops::builtin::Register_STABLEHLO_SCATTER_REF(),
+                       /*num_threads=*/1);
+    for (int num_threads : {1, 4}) {
+      EXPECT_THAT(
+          ScatterWindows(op_type,
+                         ops::builtin::Register_STABLEHLO_SCATTER_GENERIC_OPT(),
+                         num_threads),
+          ElementsAreArray(expected));
+    }
+  }
+}
+
+// Measures adding 4096 rows of 256 floats into a [1024, 256] tensor.
+// `state.range(0)` selects the reference (0) or the optimized (1) kernel.
+void BM_StablehloScatterAddRows(benchmark::State& state) {
+  constexpr int kNumRows = 1024;
+  constexpr int kRowSize = 256;
+  constexpr int kNumUpdates = 4096;
+  TfLiteStablehloScatterParams params = {
+      false, {1}, 1, {0}, 1, {0}, 1, 1, false, 1};
+  StablehloScatterOpModel model(
+      {TensorType_FLOAT32, {kNumRows, kRowSize}},
+      {TensorType_INT32, {kNumUpdates, 1}},
+      {TensorType_FLOAT32, {kNumUpdates, kRowSize}}, params,
+      StablehloScatterOpType::kAdd,
+      state.range(0) == 0
+          ? ops::builtin::Register_STABLEHLO_SCATTER_REF()
+          : ops::builtin::Register_STABLEHLO_SCATTER_GENERIC_OPT(),
+      /*num_threads=*/state.range(1));
+  model.SetInput(std::vector<float>(kNumRows * kRowSize, 0.0f));
+  std::vector<int32_t> indices(kNumUpdates);
+  for (int i = 0; i < kNumUpdates; ++i) {
+    indices[i] = (i * 97) % kNumRows;
+  }
+  model.SetIndices(indices);
+  model.SetUpdates(std::vector<float>(kNumUpdates * kRowSize, 1.0f));
+  for (auto _ : state) {
+    if (model.Invoke() != kTfLiteOk) {
+      state.SkipWithError("Invoke failed");
+      break;
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * kNumUpdates * kRowSize *
+                          sizeof(float));
+}
+BENCHMARK(BM_StablehloScatterAddRows)
+    ->ArgNames({"optimized", "threads"})
+    ->ArgsProduct({{0, 1}, {1, 4}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
 }  // namespace
 }  // namespace tflite
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/lite/kernels/subgraph_test_util.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
@@ -820,6 +821,53 @@ void SubgraphBuilder::BuildLargeLessEqualCondSubgraph(Subgraph* subgraph,
                                   0, nullptr, le_reg, &node_index);
 }
 
+void SubgraphBuilder::BuildResidualAddChainSubgraph(Subgraph* subgraph,
+                                                    int num_ops) {
+  // Tensor 0 is the input, tensor i + 1 is the output of node i.
+  const int kSkip = 3;
+  int first_new_tensor_index;
+  ASSERT_EQ(subgraph->AddTensors(num_ops + 1, &first_new_tensor_index),
+            kTfLiteOk);
+  ASSERT_EQ(first_new_tensor_index, 0);
+  ASSERT_EQ(subgraph->SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(subgraph->SetOutputs({num_ops}), kTfLiteOk);
+  for (int i = 0; i <= num_ops; ++i) {
+    SetupTensor(subgraph, i, kTfLiteInt32);
+  }
+  for (int i = 0; i < num_ops; ++i) {
+    AddAddNode(subgraph, i, std::max(0, i - kSkip), i + 1);
+  }
+}
+
+void SubgraphBuilder::BuildMultiBranchAddSubgraph(Subgraph* subgraph,
+                                                  int num_branches,
+                                                  int depth) {
+  // Tensor 0 is the input, tensor 1 + b * depth + d is the output of node d of
+  // branch b, followed by the outputs of the summing nodes.
+  const int num_tensors = 1 + num_branches * depth + num_branches - 1;
+  int first_new_tensor_index;
+  ASSERT_EQ(subgraph->AddTensors(num_tensors, &first_new_tensor_index),
+            kTfLiteOk);
+  ASSERT_EQ(first_new_tensor_index, 0);
+  ASSERT_EQ(subgraph->SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(subgraph->SetOutputs({num_tensors - 1}), kTfLiteOk);
+  for (int i = 0; i < num_tensors; ++i) {
+    SetupTensor(subgraph, i, kTfLiteInt32);
+  }
+  for (int b = 0; b < num_branches; ++b) {
+    for (int d = 0; d < depth; ++d) {
+      const int output = 1 + b * depth + d;
+      AddAddNode(subgraph, d == 0 ? 0 : output - 1, 0, output);
+    }
+  }
+  int sum = depth;
+  for (int b = 1; b < num_branches; ++b) {
+    const int output = num_branches * depth + b;
+    AddAddNode(subgraph, sum, (b + 1) * depth, output);
+    sum = output;
+  }
+}
+
 void SubgraphBuilder::BuildOffsetAddSharing(Subgraph* subgraph) {
   enum {
     kInput0,
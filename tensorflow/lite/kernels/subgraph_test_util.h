@@ -55,6 +55,18 @@ class SubgraphBuilder {
   // the second input but not the first.
   void BuildOffsetAddSharing(Subgraph* subgraph);
 
+  // Build a subgraph with a chain of `num_ops` ADD nodes. Each node adds the
+  // outputs of the previous node and of the node three steps earlier, so that
+  // many intermediate tensors are alive at the same time.
+  void BuildResidualAddChainSubgraph(Subgraph* subgraph, int num_ops);
+
+  // Build a subgraph with `num_branches` independent chains of `depth` ADD
+  // nodes, each adding the subgraph input to the output of the previous node,
+  // followed by a chain of ADD nodes summing the outputs of the branches. The
+  // output is `num_branches * (depth + 1)` times the input.
+  void BuildMultiBranchAddSubgraph(Subgraph* subgraph, int num_branches,
+                                   int depth);
+
   // Build a subgraph with a dynamic update slice op which operates on
   // a subgraph input tensor. The input buffer cannot be shared with the output.
   void BuildInputDynamicUpdateSliceSubgraph(Subgraph& subgraph);
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/types.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/kernels/prepacked_weights_cache.h"
 #include "tensorflow/lite/util.h"
 
 namespace tflite {
@@ -102,6 +103,9 @@ struct OpData {
 
   bool has_col2im = false;
   bool weights_are_transposed = false;
+  // The transposed weights, when they're shared with the other interpreters
+  // of the model.
+  std::shared_ptr<const PrepackedWeights> shared_transposed_weights;
 
   TfLiteType quantized_bias_type = kTfLiteNoType;
 };
@@ -239,22 +243,20 @@ TfLiteStatus ResizeCol2ImTensor(TfLiteContext* context,
   return context->ResizeTensor(context, col2im, col2im_shape_array.release());
 }
 
-TfLiteStatus ResizeAndTransposeWeights(TfLiteContext* context,
-                                       const TfLiteTensor* weights,
-                                       TfLiteTensor* transposed_weights) {
-  std::unique_ptr<TfLiteIntArray, void (*)(TfLiteIntArray*)>
-      transposed_weights_shape_array(TfLiteIntArrayCreate(4),
-                                     TfLiteIntArrayFree);
+TfLiteIntArray* TransposedWeightsShape(const TfLiteTensor* weights) {
+  TfLiteIntArray* transposed_weights_shape_array = TfLiteIntArrayCreate(4);
   const RuntimeShape& input_shape = GetTensorShape(weights);
   transposed_weights_shape_array->data[0] = input_shape.Dims(1);
   transposed_weights_shape_array->data[1] = input_shape.Dims(2);
   transposed_weights_shape_array->data[2] = input_shape.Dims(0);
   transposed_weights_shape_array->data[3] = input_shape.Dims(3);
+  return transposed_weights_shape_array;
+}
 
-  transposed_weights->type = weights->type;
-  transposed_weights->allocation_type = kTfLiteDynamic;
-  TF_LITE_ENSURE_STATUS(context->ResizeTensor(
-      context, transposed_weights, transposed_weights_shape_array.release()));
+TfLiteStatus TransposeWeights(TfLiteContext* context,
+                              const TfLiteTensor* weights,
+                              TfLiteTensor* transposed_weights) {
+  const RuntimeShape& input_shape = GetTensorShape(weights);
 
   // Transpose the weights from OHWI order to HWOI order.
   TransposeParams transpose_params;
@@ -291,6 +293,37 @@ TfLiteStatus ResizeAndTransposeWeights(TfLiteContext* context,
   return kTfLiteOk;
 }
 
+TfLiteStatus ResizeAndTransposeWeights(TfLiteContext* context,
+                                       const TfLiteTensor* weights,
+                                       TfLiteTensor* transposed_weights) {
+  transposed_weights->type = weights->type;
+  transposed_weights->allocation_type = kTfLiteDynamic;
+  TF_LITE_ENSURE_STATUS(context->ResizeTensor(
+      context, transposed_weights, TransposedWeightsShape(weights)));
+  return TransposeWeights(context, weights, transposed_weights);
+}
+
+// Points `transposed_weights` at the transposed copy of the constant `weights`
+// shared by all the interpreters of the model.
+TfLiteStatus ShareTransposedWeights(TfLiteContext* context,
+                                    const TfLiteTensor* weights,
+                                    TfLiteTensor* transposed_weights,
+                                    OpData* data) {
+  if (weights->type != kTfLiteFloat32 && weights->type != kTfLiteUInt8 &&
+      weights->type != kTfLiteInt8) {
+    // Reports the unsupported type.
+    return ResizeAndTransposeWeights(context, weights, transposed_weights);
+  }
+  transposed_weights->type = weights->type;
+  return ResizeAndSharePrepackedWeights(
+      context, weights, WeightsPackingFormat::kTransposeConvHwoi,
+      TransposedWeightsShape(weights), transposed_weights,
+      [context, weights](TfLiteTensor* packed) {
+        TransposeWeights(context, weights, packed);
+      },
+      &data->shared_transposed_weights);
+}
+
 template <KernelType kernel_type>
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   OpData* data = reinterpret_cast<OpData*>(node->user_data);
@@ -422,6 +455,9 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                          &transposed_weights));
     if (!IsConstantTensor(weights)) {
       SetTensorToDynamic(transposed_weights);
+    } else if (CanSharePrepackedWeights(weights)) {
+      TF_LITE_ENSURE_STATUS(ShareTransposedWeights(
+          context, weights, transposed_weights, user_data));
     } else {
       ResizeAndTransposeWeights(context, weights, transposed_weights);
     }
@@ -148,6 +148,16 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Schedule memory allocation like `Allocate`, but at the given `offset`
+  // instead of the best fitting gap. The caller must guarantee that the
+  // allocation doesn't overlap with any other allocation whose usage interval
+  // intersects [first_node, last_node], e.g. because `offset` was returned by
+  // `Allocate` for the same sequence of allocations.
+  TfLiteStatus AllocateAt(TfLiteContext* context, size_t alignment,
+                          size_t offset, size_t size, int32_t tensor,
+                          int32_t first_node, int32_t last_node,
+                          ArenaAllocWithUsageInterval* new_alloc);
+
   TfLiteStatus Commit(bool* arena_reallocated);
 
   TfLiteStatus ResolveAlloc(TfLiteContext* context,
@@ -123,6 +123,44 @@ TEST(SimpleMemoryArenaTest, BasicArenaOperations) {
   EXPECT_EQ(allocs[5].offset, 2048);
 }
 
+TEST(SimpleMemoryArenaTest, AllocateAtReproducesAllocate) {
+  TfLiteContext context;
+  SimpleMemoryArena arena(64);
+  ArenaAllocWithUsageInterval allocs[3];
+  ASSERT_EQ(arena.Allocate(&context, 32, 2047, 0, 1, 3, &allocs[0]), kTfLiteOk);
+  ASSERT_EQ(arena.Allocate(&context, 32, 2047, 1, 2, 5, &allocs[1]), kTfLiteOk);
+  ASSERT_EQ(arena.Allocate(&context, 32, 1023, 2, 4, 6, &allocs[2]), kTfLiteOk);
+
+  SimpleMemoryArena replayed_arena(64);
+  ArenaAllocWithUsageInterval replayed_allocs[3];
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(replayed_arena.AllocateAt(
+                  &context, 32, allocs[i].offset, allocs[i].size,
+                  allocs[i].tensor, allocs[i].first_node, allocs[i].last_node,
+                  &replayed_allocs[i]),
+              kTfLiteOk);
+    EXPECT_EQ(replayed_allocs[i].offset, allocs[i].offset);
+  }
+
+  // Both arenas need the same buffer and keep the same active allocs, so they
+  // place further allocations identically.
+  bool reallocated = false;
+  ASSERT_EQ(arena.Commit(&reallocated), kTfLiteOk);
+  ASSERT_EQ(replayed_arena.Commit(&reallocated), kTfLiteOk);
+  EXPECT_EQ(replayed_arena.GetBufferSize(), arena.GetBufferSize());
+  ArenaAllocWithUsageInterval next, replayed_next;
+  ASSERT_EQ(arena.Allocate(&context, 32, 512, 3, 4, 5, &next), kTfLiteOk);
+  ASSERT_EQ(replayed_arena.Allocate(&context, 32, 512, 3, 4, 5, &replayed_next),
+            kTfLiteOk);
+  EXPECT_EQ(replayed_next.offset, next.offset);
+
+  // Misaligned offsets are rejected.
+  context.ReportError = ReportError;
+  EXPECT_EQ(replayed_arena.AllocateAt(&context, 32, 16, 64, 4, 0, 1,
+                                      &replayed_next),
+            kTfLiteError);
+}
+
 TEST(ResizableAlignedBufferTest, FailedResizePreservesOriginalBuffer) {
   ResizableAlignedBuffer buffer(/*alignment=*/64, /*subgraph_index=*/0);
 
@@ -15,9 +15,11 @@
 """Benchmarks for `tf.data.Dataset.map()`."""
 import numpy as np
 
+from tensorflow.core.protobuf import config_pb2
 from tensorflow.python.data.benchmarks import benchmark_base
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.ops import map_op
+from tensorflow.python.data.ops import options as options_lib
 from tensorflow.python.framework import constant_op
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import map_fn
@@ -189,6 +191,37 @@ class MapBenchmark(benchmark_base.DatasetBenchmarkBase):
       for num_parallel_calls in nums_parallel_calls:
         self._benchmark_nested_parallel_map(cycle_length, num_parallel_calls)
 
+  def _benchmark_numa_node(self, numa_node):
+    # Elements of 4MB each, so that the throughput is bound by memory bandwidth.
+    dataset = dataset_ops.Dataset.range(1000).map(
+        lambda x: random_ops.random_uniform([1024 * 1024]) + math_ops.cast(
+            x, "float32"),
+        num_parallel_calls=dataset_ops.AUTOTUNE)
+    dataset = dataset.batch(16).prefetch(dataset_ops.AUTOTUNE)
+    if numa_node is not None:
+      options = options_lib.Options()
+      options.threading.numa_node = numa_node
+      dataset = dataset.with_options(options)
+    # Allocates from NUMA node-local CPU allocators.
+    session_config = config_pb2.ConfigProto(
+        experimental=config_pb2.ConfigProto.Experimental(
+            use_numa_affinity=True))
+
+    numa_node_str = "none" if numa_node is None else str(numa_node)
+    self.run_and_report_benchmark(
+        dataset,
+        num_elements=1000 // 16,
+        extras={
+            "model_name": "map.benchmark.11",
+            "parameters": numa_node_str,
+        },
+        name="parallel_map_and_batch_numa_node_%s" % numa_node_str,
+        session_config=session_config)
+
+  def benchmark_numa_node(self):
+    for numa_node in [None, 0]:
+      self._benchmark_numa_node(numa_node)
+
 
 if __name__ == "__main__":
   benchmark_base.test.main()
@@ -48,6 +48,7 @@ See [Importing Data](https://tensorflow.org/guide/datasets) for an overview.
 @@assert_cardinality
 @@at
 @@bucket_by_sequence_length
+@@bucket_by_token_budget
 @@cardinality
 @@choose_from_datasets
 @@copy_to_device
@@ -114,6 +115,7 @@ from tensorflow.python.data.experimental.ops.error_ops import ignore_errors
 from tensorflow.python.data.experimental.ops.from_list import from_list
 from tensorflow.python.data.experimental.ops.get_single_element import get_single_element
 from tensorflow.python.data.experimental.ops.grouping import bucket_by_sequence_length
+from tensorflow.python.data.experimental.ops.grouping import bucket_by_token_budget
 from tensorflow.python.data.experimental.ops.grouping import group_by_reducer
 from tensorflow.python.data.experimental.ops.grouping import group_by_window
 from tensorflow.python.data.experimental.ops.grouping import Reducer
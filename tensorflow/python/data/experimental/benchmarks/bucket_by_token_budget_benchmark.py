@@ -0,0 +1,114 @@
+# Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Benchmarks for `tf.data.experimental.bucket_by_token_budget()`."""
+import numpy as np
+
+from tensorflow.python.client import session
+from tensorflow.python.data.benchmarks import benchmark_base
+from tensorflow.python.data.experimental.ops import grouping
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.eager import context
+from tensorflow.python.framework import dtypes
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.ops.ragged import ragged_tensor
+
+_NUM_SEQUENCES = 10000
+_MAX_TOKENS = 4096
+_BUCKET_BOUNDARIES = [16, 32, 64, 128, 256]
+
+
+def _sequences():
+  """Returns a dataset of token sequences with log-normal lengths."""
+  lengths = np.random.RandomState(0).lognormal(mean=4.0, sigma=1.0,
+                                               size=_NUM_SEQUENCES)
+  lengths = np.clip(lengths, 1, 512).astype(np.int32)
+  return dataset_ops.Dataset.from_tensor_slices(lengths).map(
+      lambda n: array_ops.ones([n], dtypes.int32))
+
+
+def _batch_stats(batch):
+  """Returns the number of elements, tokens and padded tokens of `batch`."""
+  if isinstance(batch, ragged_tensor.RaggedTensor):
+    num_tokens = array_ops.size(batch.flat_values, out_type=dtypes.int64)
+    return batch.nrows(), num_tokens, num_tokens
+  return (array_ops.shape(batch, out_type=dtypes.int64)[0],
+          math_ops.count_nonzero(batch, dtype=dtypes.int64),
+          array_ops.size(batch, out_type=dtypes.int64))
+
+
+class BucketByTokenBudgetBenchmark(benchmark_base.DatasetBenchmarkBase):
+  """Benchmarks for `tf.data.experimental.bucket_by_token_budget()`."""
+
+  def _evaluate(self, tensors):
+    if context.executing_eagerly():
+      return [t.numpy() for t in tensors]
+    with session.Session() as sess:
+      return sess.run(tensors)
+
+  def _run_benchmark(self, bucket_fn, label, benchmark_id):
+    # Reports the padding ratio of the batches, and the number of elements
+    # batched per second.
+    batches = _sequences().apply(bucket_fn)
+    num_batches, num_elements, num_tokens, num_padded_tokens = self._evaluate(
+        batches.map(_batch_stats).reduce(
+            (np.int64(0), np.int64(0), np.int64(0), np.int64(0)),
+            lambda s, x: (s[0] + 1, s[1] + x[0], s[2] + x[1], s[3] + x[2])))
+    wall_time = self.run_and_report_benchmark(
+        dataset=_sequences().repeat().apply(bucket_fn),
+        num_elements=int(num_batches),
+        iters=5,
+        extras={
+            "model_name": "bucket_by_token_budget.benchmark.%d" % benchmark_id,
+            "parameters": "%d" % _MAX_TOKENS,
+            "padding_ratio": 1.0 - float(num_tokens) / num_padded_tokens,
+            "elements_per_batch": float(num_elements) / num_batches,
+        },
+        name=label)
+    print("%s: %.1f elements/sec, padding ratio %.3f" %
+          (label, float(num_elements) / num_batches / wall_time,
+           1.0 - float(num_tokens) / num_padded_tokens))
+
+  def benchmark_group_by_window(self):
+    # The `bucket_by_sequence_length` equivalent of the token budget: each
+    # bucket gets the batch size that fits its longest elements.
+    max_lengths = [b - 1 for b in _BUCKET_BOUNDARIES] + [512]
+    self._run_benchmark(
+        grouping.bucket_by_sequence_length(
+            element_length_func=lambda x: array_ops.shape(x)[0],
+            bucket_boundaries=_BUCKET_BOUNDARIES,
+            bucket_batch_sizes=[_MAX_TOKENS // n for n in max_lengths]),
+        label="group_by_window",
+        benchmark_id=1)
+
+  def benchmark_token_budget_padded(self):
+    self._run_benchmark(
+        grouping.bucket_by_token_budget(
+            max_tokens=_MAX_TOKENS, bucket_boundaries=_BUCKET_BOUNDARIES),
+        label="token_budget_padded",
+        benchmark_id=2)
+
+  def benchmark_token_budget_ragged(self):
+    self._run_benchmark(
+        grouping.bucket_by_token_budget(
+            max_tokens=_MAX_TOKENS,
+            bucket_boundaries=_BUCKET_BOUNDARIES,
+            ragged=True),
+        label="token_budget_ragged",
+        benchmark_id=3)
+
+
+if __name__ == "__main__":
+  benchmark_base.test.main()
@@ -20,6 +20,7 @@ import tempfile
 
 from tensorflow.python.data.benchmarks import benchmark_base
 from tensorflow.python.data.experimental.ops import readers
+from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.ops import readers as core_readers
 from tensorflow.python.ops import parsing_ops
 from tensorflow.python.platform import gfile
@@ -121,6 +122,42 @@ class CsvDatasetBenchmark(benchmark_base.DatasetBenchmarkBase):
           benchmark_id=4)
     self._tear_down()
 
+  def benchmark_csv_dataset_single_file_throughput(self):
+    """Reports how fast one large file is parsed, in GB/s."""
+    gfile.MakeDirs(googletest.GetTempDir())
+    self._temp_dir = tempfile.mkdtemp(dir=googletest.GetTempDir())
+    num_cols = 64
+    num_rows = 100000
+    filename = os.path.join(self._temp_dir, 'large.csv')
+    with open(filename, 'w') as f:
+      row = ','.join(self.FLOAT_VAL for _ in range(num_cols))
+      f.write('\n'.join(row for _ in range(num_rows)))
+    file_size = os.path.getsize(filename)
+    kwargs = {'record_defaults': [[0.0]] * num_cols}
+    for num_parallel_calls in [None, 1, 2, 4, 8, dataset_ops.AUTOTUNE]:
+      dataset = readers.CsvDataset(
+          filename, num_parallel_calls=num_parallel_calls, **kwargs)
+      # Each iteration goes through the whole file once.
+      wall_time = self.run_benchmark(
+          dataset=dataset, num_elements=num_rows, iters=3) * num_rows
+      if num_parallel_calls is None:
+        label = 'sequential'
+      elif num_parallel_calls == dataset_ops.AUTOTUNE:
+        label = 'parallel_calls_autotune'
+      else:
+        label = 'parallel_calls_%d' % num_parallel_calls
+      self.report_benchmark(
+          wall_time=wall_time,
+          iters=3,
+          name='csv_float_single_file_%s' % label,
+          extras={
+              'model_name': 'csv.benchmark.5',
+              'parameters': '%d' % num_cols,
+              'file_size_bytes': file_size,
+              'gb_per_sec': file_size / wall_time / 1e9,
+          })
+    self._tear_down()
+
 
 if __name__ == '__main__':
   benchmark_base.test.main()
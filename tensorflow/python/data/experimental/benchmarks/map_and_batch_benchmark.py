@@ -24,6 +24,7 @@ from tensorflow.python.data.experimental.ops import batching
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.ops import options as options_lib
 from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import dtypes
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import random_ops
 
@@ -194,6 +195,34 @@ class MapAndBatchBenchmark(benchmark_base.DatasetBenchmarkBase):
         fused_versus_chained_series,
         benchmark_id=8)
 
+  def benchmark_map_vectorization(self):
+    """Compares per-element and vectorized map functions on a cheap map."""
+    num_batches = 100
+    for batch_size in [32, 256, 1024]:
+      for map_vectorization in [False, True]:
+        dataset = dataset_ops.Dataset.range(1000000000).map(
+            lambda x: math_ops.cast(x, dtypes.float32) * 2.0 + 1.0,
+            num_parallel_calls=dataset_ops.AUTOTUNE).batch(batch_size)
+        options = options_lib.Options()
+        options.experimental_optimization.apply_default_optimizations = False
+        options.experimental_optimization.map_and_batch_fusion = True
+        options.experimental_optimization.map_vectorization = map_vectorization
+        dataset = dataset.with_options(options)
+
+        wall_time = self.run_and_report_benchmark(
+            dataset=dataset,
+            num_elements=num_batches,
+            iters=10,
+            warmup=True,
+            extras={
+                "model_name": "map_and_batch.benchmark.9",
+                "parameters": "%d.%s" % (batch_size, map_vectorization),
+            },
+            name="cheap_map_%s_batch_size_%d" %
+            ("vectorized" if map_vectorization else "per_element", batch_size))
+        print("batch_size %d, map_vectorization %s: %.1f elements/sec" %
+              (batch_size, map_vectorization, batch_size / wall_time))
+
 
 if __name__ == "__main__":
   benchmark_base.test.main()
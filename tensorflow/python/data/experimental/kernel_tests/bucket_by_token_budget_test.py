@@ -0,0 +1,165 @@
+# Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for `tf.data.experimental.bucket_by_token_budget()`."""
+from absl.testing import parameterized
+
+from tensorflow.python.data.experimental.ops import grouping
+from tensorflow.python.data.kernel_tests import checkpoint_test_base
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import combinations
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.ops.ragged import ragged_tensor
+
+
+def _sequences(lengths):
+  """Returns a dataset of vectors of the given lengths, filled with them."""
+  return dataset_ops.Dataset.from_tensor_slices(lengths).map(
+      lambda n: array_ops.fill([n], n))
+
+
+class BucketByTokenBudgetTest(test_base.DatasetTestBase,
+                              parameterized.TestCase):
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testPaddedBatches(self):
+    dataset = _sequences([1, 2, 3, 1, 4, 2]).apply(
+        grouping.bucket_by_token_budget(max_tokens=4, bucket_boundaries=[3]))
+    self.assertEqual([None, None], dataset.element_spec.shape.as_list())
+    self.assertDatasetProduces(
+        dataset,
+        expected_output=[[[1, 0], [2, 2]], [[3, 3, 3]], [[1, 0], [2, 2]],
+                         [[4, 4, 4, 4]]])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testMaxBatchSize(self):
+    dataset = _sequences([1, 1, 1, 1, 1]).apply(
+        grouping.bucket_by_token_budget(
+            max_tokens=100, bucket_boundaries=[], max_batch_size=2))
+    self.assertDatasetProduces(
+        dataset, expected_output=[[[1], [1]], [[1], [1]], [[1]]])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testDropRemainder(self):
+    dataset = _sequences([1, 1, 1, 1, 1]).apply(
+        grouping.bucket_by_token_budget(
+            max_tokens=100,
+            bucket_boundaries=[],
+            max_batch_size=2,
+            drop_remainder=True))
+    self.assertDatasetProduces(
+        dataset, expected_output=[[[1], [1]], [[1], [1]]])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testPaddingValues(self):
+    dataset = _sequences([1, 3]).apply(
+        grouping.bucket_by_token_budget(
+            max_tokens=100, bucket_boundaries=[], padding_values=-1))
+    self.assertDatasetProduces(
+        dataset, expected_output=[[[1, -1, -1], [3, 3, 3]]])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testPadsInnerDimensions(self):
+    dataset = dataset_ops.Dataset.from_tensor_slices([1, 2]).map(
+        lambda n: array_ops.fill([n, n], n))
+    dataset = dataset.apply(
+        grouping.bucket_by_token_budget(
+            max_tokens=100, bucket_boundaries=[]))
+    self.assertDatasetProduces(
+        dataset, expected_output=[[[[1, 0], [0, 0]], [[2, 2], [2, 2]]]])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testRaggedBatches(self):
+    dataset = _sequences([1, 2, 3, 1, 4, 2]).apply(
+        grouping.bucket_by_token_budget(
+            max_tokens=4, bucket_boundaries=[3], ragged=True))
+    self.assertIsInstance(dataset.element_spec,
+                          ragged_tensor.RaggedTensorSpec)
+    output = [batch.to_list() for batch in self.getDatasetOutput(dataset)]
+    self.assertEqual(
+        [[[1], [2, 2], [1]], [[3, 3, 3]], [[2, 2]], [[4, 4, 4, 4]]], output)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testElementLengthFunc(self):
+    dataset = dataset_ops.Dataset.from_tensor_slices([1, 2, 3]).map(
+        lambda n: {"tokens": array_ops.fill([n], n), "label": n})
+    # Counts every element as 2 tokens, so that each batch has 2 elements.
+    dataset = dataset.apply(
+        grouping.bucket_by_token_budget(
+            max_tokens=4,
+            bucket_boundaries=[],
+            element_length_func=lambda x: 2 + 0 * x["label"],
+            padding_values={"tokens": -1, "label": 0},
+            ragged=True))
+    self.assertEqual({"tokens", "label"}, set(dataset.element_spec))
+    output = self.getDatasetOutput(dataset)
+    self.assertEqual([[1, 2], [3]],
+                     [batch["label"].tolist() for batch in output])
+    self.assertEqual([[[1], [2, 2]], [[3, 3, 3]]],
+                     [batch["tokens"].to_list() for batch in output])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testScalarLengthComponent(self):
+    dataset = dataset_ops.Dataset.range(5).map(
+        lambda x: (math_ops.cast(x, dtypes.int32), x))
+    # The length of an element is the value of its first component.
+    dataset = dataset.apply(
+        grouping.bucket_by_token_budget(
+            max_tokens=4, bucket_boundaries=[2]))
+    self.assertDatasetProduces(
+        dataset,
+        expected_output=[([2], [2]), ([3], [3]), ([0, 1], [0, 1]),
+                         ([4], [4])])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testInvalidBucketBoundaries(self):
+    dataset = _sequences([1]).apply(
+        grouping.bucket_by_token_budget(
+            max_tokens=4, bucket_boundaries=[3, 2]))
+    self.assertDatasetProduces(
+        dataset,
+        expected_error=(errors.InvalidArgumentError,
+                        "must be strictly increasing"))
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testInvalidMaxTokens(self):
+    dataset = _sequences([1]).apply(
+        grouping.bucket_by_token_budget(max_tokens=0, bucket_boundaries=[]))
+    self.assertDatasetProduces(
+        dataset,
+        expected_error=(errors.InvalidArgumentError,
+                        "must be greater than zero"))
+
+
+class BucketByTokenBudgetCheckpointTest(
+    checkpoint_test_base.CheckpointTestBase, parameterized.TestCase):
+
+  def _build_dataset(self):
+    lengths = [(i * 7) % 5 + 1 for i in range(20)]
+    return _sequences(lengths).apply(
+        grouping.bucket_by_token_budget(max_tokens=8, bucket_boundaries=[2, 4]))
+
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         checkpoint_test_base.default_test_combinations()))
+  def test(self, verify_fn):
+    verify_fn(self, self._build_dataset, num_outputs=13)
+
+
+if __name__ == "__main__":
+  test_base.test.main()
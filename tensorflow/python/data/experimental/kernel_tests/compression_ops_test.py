@@ -93,6 +93,29 @@ class CompressionOpsTest(test_base.DatasetTestBase, parameterized.TestCase):
         compressed, structure.type_spec_from_value(element))
     self.assertValuesEqual(element, self.evaluate(uncompressed))
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(element=_test_objects()),
+          combinations.combine(
+              codec="ZSTD", level=[-5, 0, 3], byte_shuffle=[False, True]) +
+          combinations.combine(
+              codec="SNAPPY", level=0, byte_shuffle=True)))
+  def testCompressionCodec(self, element, codec, level, byte_shuffle):
+    element = element._obj
+
+    compressed = compression_ops.compress(
+        element, codec=codec, level=level, byte_shuffle=byte_shuffle)
+    uncompressed = compression_ops.uncompress(
+        compressed, structure.type_spec_from_value(element))
+    self.assertValuesEqual(element, self.evaluate(uncompressed))
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testUnknownCodec(self):
+    with self.assertRaisesRegex(errors.InvalidArgumentError,
+                                "Unknown compression codec"):
+      self.evaluate(compression_ops.compress(1, codec="LZ4"))
+
   @combinations.generate(
       combinations.times(test_base.default_test_combinations(),
                          combinations.combine(element=_test_objects())) +
@@ -24,6 +24,7 @@ from tensorflow.python.data.experimental.ops import error_ops
 from tensorflow.python.data.experimental.ops import readers
 from tensorflow.python.data.kernel_tests import checkpoint_test_base
 from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.ops import readers as core_readers
 from tensorflow.python.eager import context
 from tensorflow.python.framework import combinations
@@ -34,27 +35,33 @@ from tensorflow.python.ops import parsing_ops
 from tensorflow.python.platform import test
 
 
+def _write_files(directory, inputs, linebreak='\n', compression_type=None):
+  """Writes a CSV file of `inputs[i]` rows to `directory` for each `i`."""
+  filenames = []
+  for i, file_rows in enumerate(inputs):
+    fn = os.path.join(directory, 'temp_%d.csv' % i)
+    contents = linebreak.join(file_rows).encode('utf-8')
+    if compression_type is None:
+      with open(fn, 'wb') as f:
+        f.write(contents)
+    elif compression_type == 'GZIP':
+      with gzip.GzipFile(fn, 'wb') as f:
+        f.write(contents)
+    elif compression_type == 'ZLIB':
+      contents = zlib.compress(contents)
+      with open(fn, 'wb') as f:
+        f.write(contents)
+    else:
+      raise ValueError('Unsupported compression_type', compression_type)
+    filenames.append(fn)
+  return filenames
+
+
 class CsvDatasetTest(test_base.DatasetTestBase, parameterized.TestCase):
 
   def _setup_files(self, inputs, linebreak='\n', compression_type=None):
-    filenames = []
-    for i, file_rows in enumerate(inputs):
-      fn = os.path.join(self.get_temp_dir(), 'temp_%d.csv' % i)
-      contents = linebreak.join(file_rows).encode('utf-8')
-      if compression_type is None:
-        with open(fn, 'wb') as f:
-          f.write(contents)
-      elif compression_type == 'GZIP':
-        with gzip.GzipFile(fn, 'wb') as f:
-          f.write(contents)
-      elif compression_type == 'ZLIB':
-        contents = zlib.compress(contents)
-        with open(fn, 'wb') as f:
-          f.write(contents)
-      else:
-        raise ValueError('Unsupported compression_type', compression_type)
-      filenames.append(fn)
-    return filenames
+    return _write_files(self.get_temp_dir(), inputs, linebreak,
+                        compression_type)
 
   def _make_test_datasets(self, inputs, **kwargs):
     # Test by comparing its output to what we could get with map->decode_csv
@@ -594,6 +601,161 @@ class CsvDatasetTest(test_base.DatasetTestBase, parameterized.TestCase):
     self.assertAllEqual(select_cols, ['a', 'c'])
 
 
+class ParallelCsvDatasetTest(test_base.DatasetTestBase, parameterized.TestCase):
+
+  def _outputs(self, dataset):
+    """Returns the elements of `dataset`, with the messages of its errors."""
+    get_next = self.getNext(dataset)
+    outputs = []
+    while True:
+      try:
+        outputs.append(self.evaluate(get_next()))
+      except errors.OutOfRangeError:
+        return outputs
+      except errors.InvalidArgumentError as e:
+        outputs.append(e.message)
+
+  def _test_against_sequential(self,
+                               inputs,
+                               num_parallel_calls,
+                               linebreak='\n',
+                               compression_type=None,
+                               buffer_sizes=(1, 2, 3, 5, 8, 13, None),
+                               **kwargs):
+    """Checks that the parallel CsvDataset matches the sequential one."""
+    filenames = _write_files(self.get_temp_dir(), inputs, linebreak,
+                             compression_type)
+    for buffer_size in buffer_sizes:
+      expected = readers.CsvDataset(
+          filenames,
+          compression_type=compression_type,
+          buffer_size=buffer_size,
+          **kwargs)
+      actual = readers.CsvDataset(
+          filenames,
+          compression_type=compression_type,
+          buffer_size=buffer_size,
+          num_parallel_calls=num_parallel_calls,
+          **kwargs)
+      self.assertAllEqual(self._outputs(actual), self._outputs(expected))
+
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(
+              linebreak=['\n', '\r', '\r\n'],
+              num_parallel_calls=[1, 4, dataset_ops.AUTOTUNE])))
+  def testQuotedFields(self, linebreak, num_parallel_calls):
+    inputs = [[
+        '"\n\n\n","\r\r\r","abc"', 'x,y,z', '"0","1","2"', '"","",""',
+        '"she said: ""hi""",b,c'
+    ], ['d,e,f', '', 'g,h,i']]
+    self._test_against_sequential(
+        inputs,
+        num_parallel_calls,
+        linebreak=linebreak,
+        record_defaults=[['NA']] * 3)
+
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(num_parallel_calls=[1, 4])))
+  def testMixedTypes(self, num_parallel_calls):
+    inputs = [['1,2.5,3.25,4,abc', ',,,,', '-7,1e3,-0.5,9000000000,"x,y"'],
+              ['  8, 0.1,2 ,3,']]
+    record_defaults = [
+        constant_op.constant([0], dtype=dtypes.int32),
+        constant_op.constant([0.0], dtype=dtypes.float32),
+        constant_op.constant([0.0], dtype=dtypes.float64),
+        constant_op.constant([0], dtype=dtypes.int64),
+        constant_op.constant(['NA'], dtype=dtypes.string),
+    ]
+    self._test_against_sequential(
+        inputs, num_parallel_calls, record_defaults=record_defaults)
+
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(num_parallel_calls=[1, 4])))
+  def testWithHeader(self, num_parallel_calls):
+    inputs = [['"col\n1",col2', '1,2', '3,4'], ['col1,col2'], ['a,b', '5,6']]
+    self._test_against_sequential(
+        inputs, num_parallel_calls, header=True, record_defaults=[[0]] * 2)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testErrorWithHeaderEmptyFile(self):
+    filenames = _write_files(self.get_temp_dir(), [[]])
+    dataset = readers.CsvDataset(
+        filenames, record_defaults=[[0]], header=True, num_parallel_calls=2)
+    with self.assertRaisesOpError("Can't read header of file"):
+      self.getDatasetOutput(dataset)
+
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(num_parallel_calls=[1, 4])))
+  def testWithSelectAndExcludeCols(self, num_parallel_calls):
+    inputs = [['1,2,3,4', '5,"6\n",7,8', '9,10,11,12']]
+    self._test_against_sequential(
+        inputs,
+        num_parallel_calls,
+        select_cols=[1, 3],
+        record_defaults=[['']] * 2)
+    self._test_against_sequential(
+        inputs,
+        num_parallel_calls,
+        exclude_cols=[0, 2],
+        record_defaults=[['']] * 2)
+
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(num_parallel_calls=[1, 4])))
+  def testErrors(self, num_parallel_calls):
+    # Each malformed record fails with the same error as in the sequential
+    # dataset, and the records after it are still produced.
+    inputs = [[
+        '1,2,3', '1,2"3,x', '"1"2,3,4', '1,2', '1,2,3,4', 'x,y,3', ',2,3',
+        '"4","5","6"', '7,8,"9'
+    ]]
+    record_defaults = [[], [0], [0]]
+    self._test_against_sequential(
+        inputs, num_parallel_calls, record_defaults=record_defaults)
+    self._test_against_sequential(
+        inputs,
+        num_parallel_calls,
+        exclude_cols=[1],
+        record_defaults=record_defaults[:2])
+
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(
+              compression_type=['GZIP', 'ZLIB'], num_parallel_calls=[1, 4])))
+  def testWithCompressionType(self, compression_type, num_parallel_calls):
+    inputs = [['"\n\n\n","\r\r\r","abc"', '"0","1","2"', '"","",""']]
+    self._test_against_sequential(
+        inputs,
+        num_parallel_calls,
+        linebreak='\r\n',
+        compression_type=compression_type,
+        record_defaults=[['NA']] * 3)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testManyChunks(self):
+    inputs = [['%d,"%d\n",%d' % (i, i + 1, i + 2) for i in range(1000)]]
+    self._test_against_sequential(
+        inputs,
+        num_parallel_calls=8,
+        buffer_sizes=(7, 64),
+        record_defaults=[[0], [''], [0]])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testInvalidNumParallelCalls(self):
+    filenames = _write_files(self.get_temp_dir(), [['1,2']])
+    with self.assertRaisesOpError(
+        '`num_parallel_calls` must be greater than zero'):
+      dataset = readers.CsvDataset(
+          filenames, record_defaults=[[0]] * 2, num_parallel_calls=0)
+      self.getDatasetOutput(dataset)
+
+
 class CsvDatasetCheckpointTest(checkpoint_test_base.CheckpointTestBase,
                                parameterized.TestCase):
 
@@ -640,5 +802,12 @@ class CsvDatasetCheckpointTest(checkpoint_test_base.CheckpointTestBase,
               self._num_outputs)
 
 
+class ParallelCsvDatasetCheckpointTest(CsvDatasetCheckpointTest):
+
+  def ds_func(self, **kwargs):
+    return super(ParallelCsvDatasetCheckpointTest,
+                 self).ds_func(num_parallel_calls=3, **kwargs)
+
+
 if __name__ == '__main__':
   test.main()
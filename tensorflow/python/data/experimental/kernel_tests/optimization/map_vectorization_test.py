@@ -0,0 +1,92 @@
+# Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the `MapVectorization` optimization."""
+from absl.testing import parameterized
+
+from tensorflow.python.data.experimental.ops import testing
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.ops import options as options_lib
+from tensorflow.python.framework import combinations
+from tensorflow.python.framework import dtypes
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.platform import test
+
+
+def _with_map_vectorization(dataset):
+  options = options_lib.Options()
+  options.experimental_optimization.apply_default_optimizations = False
+  options.experimental_optimization.map_and_batch_fusion = True
+  options.experimental_optimization.map_vectorization = True
+  return dataset.with_options(options)
+
+
+class MapVectorizationTest(test_base.DatasetTestBase, parameterized.TestCase):
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testElementwiseFunction(self):
+    dataset = dataset_ops.Dataset.range(10).apply(
+        testing.assert_next(["Batch", "ParallelMap"])).map(
+            lambda x: math_ops.cast(x * x + 1, dtypes.float32)).batch(4)
+    dataset = _with_map_vectorization(dataset)
+    self.assertDatasetProduces(
+        dataset,
+        expected_output=[[1., 2., 5., 10.], [17., 26., 37., 50.], [65., 82.]])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testDropRemainder(self):
+    dataset = dataset_ops.Dataset.range(10).apply(
+        testing.assert_next(["Batch", "ParallelMap"])).map(
+            lambda x: x * 2).batch(4, drop_remainder=True)
+    dataset = _with_map_vectorization(dataset)
+    self.assertEqual([4], dataset.element_spec.shape.as_list())
+    self.assertDatasetProduces(
+        dataset, expected_output=[[0, 2, 4, 6], [8, 10, 12, 14]])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testPartiallyVectorizableFunction(self):
+    dataset = dataset_ops.Dataset.range(6).apply(
+        testing.assert_next(["Batch", "ParallelMap"])).map(
+            lambda x: (x * 2, array_ops.reshape(x, [1]))).batch(3)
+    dataset = _with_map_vectorization(dataset)
+    self.assertDatasetProduces(
+        dataset,
+        expected_output=[([0, 2, 4], [[0], [1], [2]]),
+                         ([6, 8, 10], [[3], [4], [5]])])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testUnvectorizableFunction(self):
+    dataset = dataset_ops.Dataset.range(4).apply(
+        testing.assert_next(["MapAndBatch"])).map(
+            lambda x: array_ops.reshape(x, [1])).batch(2)
+    dataset = _with_map_vectorization(dataset)
+    self.assertDatasetProduces(
+        dataset, expected_output=[[[0], [1]], [[2], [3]]])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testInputOfUnknownShape(self):
+    dataset = dataset_ops.Dataset.range(1, 5).map(
+        lambda x: (array_ops.fill([x], x), x))
+    # The first components of the input elements have different shapes, so
+    # the input elements cannot be batched before the map function drops them.
+    dataset = dataset.apply(testing.assert_next(["MapAndBatch"])).map(
+        lambda unused_x, y: y * 2).batch(2)
+    dataset = _with_map_vectorization(dataset)
+    self.assertDatasetProduces(dataset, expected_output=[[2, 4], [6, 8]])
+
+
+if __name__ == "__main__":
+  test.main()
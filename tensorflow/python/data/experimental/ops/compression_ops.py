@@ -17,11 +17,17 @@ from tensorflow.python.data.util import structure
 from tensorflow.python.ops import gen_experimental_dataset_ops as ged_ops
 
 
-def compress(element):
+def compress(element, codec="SNAPPY", level=0, byte_shuffle=False):
   """Compress a dataset element.
 
   Args:
     element: A nested structure of types supported by Tensorflow.
+    codec: The compression codec, "SNAPPY" or "ZSTD".
+    level: The ZSTD compression level. 0 selects the default level, and
+      negative levels trade compression ratio for speed. Ignored by "SNAPPY".
+    byte_shuffle: Whether to group the bytes of numeric tensors by significance
+      before compressing them, which usually improves the compression ratio of
+      numeric data.
 
   Returns:
     A variant tensor representing the compressed element. This variant can be
@@ -29,7 +35,11 @@ def compress(element):
   """
   element_spec = structure.type_spec_from_value(element)
   tensor_list = structure.to_tensor_list(element_spec, element)
-  return ged_ops.compress_element(tensor_list)
+  return ged_ops.compress_element(
+      tensor_list,
+      experimental_codec=codec,
+      experimental_level=level,
+      experimental_byte_shuffle=byte_shuffle)
 
 
 def uncompress(element, output_spec):
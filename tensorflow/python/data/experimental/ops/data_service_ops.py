@@ -42,6 +42,7 @@ from tensorflow.python.util.tf_export import tf_export
 COMPRESSION_AUTO = "AUTO"
 COMPRESSION_NONE = None
 COMPRESSION_SNAPPY = "SNAPPY"
+COMPRESSION_ZSTD = "ZSTD"
 _PARALLEL_EPOCHS = "parallel_epochs"
 _DISTRIBUTED_EPOCH = "distributed_epoch"
 
@@ -189,6 +190,7 @@ def _validate_compression(compression) -> None:
       COMPRESSION_AUTO,
       COMPRESSION_NONE,
       COMPRESSION_SNAPPY,
+      COMPRESSION_ZSTD,
   ]
   if compression not in valid_compressions:
     raise ValueError(f"Invalid `compression` argument: {compression}. "
@@ -201,6 +203,8 @@ def _get_compression_proto(
     return data_service_pb2.DataServiceMetadata.COMPRESSION_SNAPPY
   if compression == COMPRESSION_SNAPPY:
     return data_service_pb2.DataServiceMetadata.COMPRESSION_FORCED_SNAPPY
+  if compression == COMPRESSION_ZSTD:
+    return data_service_pb2.DataServiceMetadata.COMPRESSION_FORCED_ZSTD
   if compression == COMPRESSION_NONE:
     return data_service_pb2.DataServiceMetadata.COMPRESSION_OFF
   raise ValueError(f"Invalid `compression` argument: {compression}. "
@@ -534,7 +538,8 @@ def _distribute(
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
       tf.data service runtime. `None` indicates not to compress. "SNAPPY" forces
-      snappy compression.
+      snappy compression. "ZSTD" forces zstd compression, which usually
+      compresses numeric data better than snappy.
     cross_trainer_cache: (Optional.) If a `CrossTrainerCache` object is
       provided, dataset iteration will be shared across concurrently running
       trainers. See
@@ -794,7 +799,8 @@ def distribute(
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
       tf.data service runtime. `None` indicates not to compress. "SNAPPY" forces
-      the use of snappy compression.
+      the use of snappy compression. "ZSTD" forces the use of zstd compression,
+      which usually compresses numeric data better than snappy.
     cross_trainer_cache: (Optional.) If a `CrossTrainerCache` object is
       provided, dataset iteration will be shared across concurrently running
       trainers. See
@@ -843,7 +849,8 @@ def _register_dataset(
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
       tf.data service runtime. `None` indicates not to compress. "SNAPPY" forces
-      the use of snappy compression.
+      the use of snappy compression. "ZSTD" forces the use of zstd compression,
+      which usually compresses numeric data better than snappy.
     dataset_id: (Optional.) By default, tf.data service generates a unique
       (string) ID for each registered dataset. If a `dataset_id` is provided, it
       will use the specified ID. If a dataset with a matching ID already exists,
@@ -876,6 +883,11 @@ def _register_dataset(
     dataset = dataset.map(
         lambda *x: compression_ops.compress(x),
         num_parallel_calls=dataset_ops.AUTOTUNE)
+  elif compression == COMPRESSION_ZSTD:
+    dataset = dataset.map(
+        lambda *x: compression_ops.compress(
+            x, codec="ZSTD", byte_shuffle=True),
+        num_parallel_calls=dataset_ops.AUTOTUNE)
   dataset = dataset._apply_debug_options()  # pylint: disable=protected-access
 
   metadata = data_service_pb2.DataServiceMetadata(
@@ -933,7 +945,8 @@ def register_dataset(
     compression: (Optional.) How to compress the dataset's elements before
       transferring them over the network. "AUTO" leaves the decision of how to
       compress up to the tf.data service runtime. "SNAPPY" forces snappy
-      compression. `None` indicates not to compress.
+      compression. "ZSTD" forces zstd compression, which usually compresses
+      numeric data better than snappy. `None` indicates not to compress.
     dataset_id: (Optional.) By default, tf.data service generates a unique
       (string) ID for each registered dataset. If a `dataset_id` is provided, it
       will use the specified ID. If a dataset with a matching ID already exists,
@@ -14,13 +14,17 @@
 # ==============================================================================
 """Grouping dataset transformations."""
 from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.ops import padded_batch_op
 from tensorflow.python.data.ops import structured_function
 from tensorflow.python.data.util import nest
 from tensorflow.python.data.util import structure
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
+from tensorflow.python.framework import tensor_shape
 from tensorflow.python.framework import tensor_spec
 from tensorflow.python.ops import gen_experimental_dataset_ops as ged_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.ops.ragged import ragged_tensor
 from tensorflow.python.util import deprecation
 from tensorflow.python.util.tf_export import tf_export
 
@@ -257,6 +261,179 @@ def bucket_by_sequence_length(element_length_func,
   return _apply_fn
 
 
+@tf_export("data.experimental.bucket_by_token_budget")
+def bucket_by_token_budget(max_tokens,
+                           bucket_boundaries,
+                           max_batch_size=None,
+                           element_length_func=None,
+                           padding_values=None,
+                           ragged=False,
+                           drop_remainder=False):
+  """A transformation that batches elements of similar lengths by token count.
+
+  Like `tf.data.experimental.bucket_by_sequence_length`, this transformation
+  groups the elements of a `Dataset` into buckets by length. Rather than a
+  fixed number of elements, each batch holds as many elements of its bucket as
+  fit in a budget of `max_tokens` tokens, so batches of short elements are
+  larger than batches of long ones. The bucketing, padding and batching happen
+  in a single native transformation, which writes each batch once.
+
+  >>> elements = [[1], [2, 3], [4, 5, 6], [7], [8, 9, 10, 11], [12, 13]]
+  >>> dataset = tf.data.Dataset.from_generator(
+  ...     lambda: elements, tf.int64, output_shapes=[None])
+  >>> dataset = dataset.apply(
+  ...     tf.data.experimental.bucket_by_token_budget(
+  ...         max_tokens=4, bucket_boundaries=[3]))
+  >>> for elem in dataset.as_numpy_iterator():
+  ...   print(elem)
+  [[1 0]
+   [2 3]]
+  [[4 5 6]]
+  [[ 7  0]
+   [12 13]]
+  [[ 8  9 10 11]]
+
+  With `ragged=True`, components whose first dimension varies are batched into
+  `tf.RaggedTensor`s instead of being padded.
+
+  Args:
+    max_tokens: A `tf.int64` scalar, the maximum number of tokens in a batch.
+      The tokens of a padded batch are its number of elements times their
+      maximum length, and those of a ragged batch the sum of their lengths. An
+      element with more tokens forms a batch of its own.
+    bucket_boundaries: `list<int>`, increasing upper length boundaries of the
+      buckets.
+    max_batch_size: (Optional.) A `tf.int64` scalar, the maximum number of
+      elements in a batch. Defaults to no limit.
+    element_length_func: (Optional.) A function from an element to a scalar
+      integer, its length. Defaults to the size of the first dimension of the
+      first component of the element, which is computed without calling a
+      function.
+    padding_values: (Optional.) Values to pad with, as in
+      `tf.data.Dataset.padded_batch`. Defaults to padding with 0.
+    ragged: (Optional.) If `True`, components with a variable first dimension
+      are batched into ragged tensors rather than padded.
+    drop_remainder: (Optional.) A `tf.bool` scalar, representing whether the
+      partial batches left in the buckets at the end of the input should be
+      dropped.
+
+  Returns:
+    A `Dataset` transformation function, which can be passed to
+    `tf.data.Dataset.apply`.
+  """
+
+  def _apply_fn(dataset):
+    if element_length_func is None:
+      return _BucketByTokenBudgetDataset(
+          dataset,
+          max_tokens=max_tokens,
+          bucket_boundaries=bucket_boundaries,
+          max_batch_size=max_batch_size,
+          length_component=0,
+          padding_values=padding_values,
+          ragged=ragged,
+          drop_remainder=drop_remainder)
+
+    # Passes the lengths to the native transformation as an extra component,
+    # which is dropped from the batches.
+    def add_length(*args):
+      element = args[0] if len(args) == 1 else args
+      length = math_ops.cast(element_length_func(*args), dtypes.int64)
+      return element, length
+
+    element_padding_values = padding_values
+    if (nest.is_nested(dataset.element_spec) and
+        element_padding_values is not None and
+        not nest.is_nested(element_padding_values)):
+      element_padding_values = nest.map_structure(
+          lambda _: padding_values, dataset.element_spec)
+    dataset = dataset.map(add_length)
+    dataset = _BucketByTokenBudgetDataset(
+        dataset,
+        max_tokens=max_tokens,
+        bucket_boundaries=bucket_boundaries,
+        max_batch_size=max_batch_size,
+        length_component=len(nest.flatten(dataset.element_spec)) - 1,
+        padding_values=(element_padding_values, None),
+        ragged=ragged,
+        drop_remainder=drop_remainder)
+    return dataset.map(lambda element, length: element)
+
+  return _apply_fn
+
+
+class _BucketByTokenBudgetDataset(dataset_ops.UnaryDataset):
+  """A `Dataset` that batches elements of similar lengths by token count."""
+
+  def __init__(self, input_dataset, max_tokens, bucket_boundaries,
+               max_batch_size, length_component, padding_values, ragged,
+               drop_remainder):
+    """See `bucket_by_token_budget()` for details."""
+
+    def check_types(component_spec):
+      if not isinstance(component_spec, tensor_spec.TensorSpec):
+        raise TypeError(f"`bucket_by_token_budget` is only supported for "
+                        f"datasets that produce tensor elements but type spec "
+                        f"of elements in the input dataset is not a subclass "
+                        f"of TensorSpec: `{component_spec}`.")
+
+    nest.map_structure(check_types, input_dataset.element_spec)
+    self._input_dataset = input_dataset
+    self._max_tokens = ops.convert_to_tensor(
+        max_tokens, dtype=dtypes.int64, name="max_tokens")
+    self._bucket_boundaries = ops.convert_to_tensor(
+        bucket_boundaries, dtype=dtypes.int64, name="bucket_boundaries")
+    self._max_batch_size = ops.convert_to_tensor(
+        -1 if max_batch_size is None else max_batch_size,
+        dtype=dtypes.int64,
+        name="max_batch_size")
+    self._drop_remainder = ops.convert_to_tensor(
+        drop_remainder, dtype=dtypes.bool, name="drop_remainder")
+
+    # pylint: disable=protected-access
+    input_types = dataset_ops.get_legacy_output_types(input_dataset)
+    padding_values = padded_batch_op._padding_values_or_default(
+        padding_values, input_dataset)
+    if nest.is_nested(input_types) and not nest.is_nested(padding_values):
+      padding_values = nest.map_structure(lambda _: padding_values,
+                                          input_types)
+    self._padding_values = nest.map_structure_up_to(
+        input_types, padded_batch_op._padding_value_to_tensor, padding_values,
+        input_types)
+    # pylint: enable=protected-access
+
+    def batch_spec(component_spec):
+      shape = tensor_shape.TensorShape([None]).concatenate(
+          component_spec.shape)
+      if (ragged and component_spec.shape.rank and
+          tensor_shape.dimension_value(component_spec.shape[0]) is None):
+        return ragged_tensor.RaggedTensorSpec(
+            shape,
+            component_spec.dtype,
+            ragged_rank=1,
+            row_splits_dtype=dtypes.int64)
+      return tensor_spec.TensorSpec(shape, component_spec.dtype)
+
+    self._structure = nest.map_structure(batch_spec,
+                                         input_dataset.element_spec)
+    variant_tensor = ged_ops.bucket_by_token_budget_dataset(
+        input_dataset._variant_tensor,  # pylint: disable=protected-access
+        bucket_boundaries=self._bucket_boundaries,
+        max_tokens=self._max_tokens,
+        max_batch_size=self._max_batch_size,
+        padding_values=nest.flatten(self._padding_values),
+        drop_remainder=self._drop_remainder,
+        length_component=length_component,
+        ragged_output=ragged,
+        **self._flat_structure)
+    super(_BucketByTokenBudgetDataset, self).__init__(input_dataset,
+                                                      variant_tensor)
+
+  @property
+  def element_spec(self):
+    return self._structure
+
+
 class _GroupByReducerDataset(dataset_ops.UnaryDataset):
   """A `Dataset` that groups its input and performs a reduction."""
 
@@ -719,6 +719,7 @@ class CsvDatasetV2(dataset_ops.DatasetSource):
       na_value="",
       select_cols=None,
       exclude_cols=None,
+      num_parallel_calls=None,
   ):
     """Creates a `CsvDataset` by reading and decoding CSV files.
 
@@ -757,6 +758,11 @@ class CsvDatasetV2(dataset_ops.DatasetSource):
         the input data. If specified, only the complement of this set of column
         will be parsed. Defaults to parsing all columns. At most one of
         `select_cols` and `exclude_cols` can be specified.
+      num_parallel_calls: (Optional.) A `tf.int64` scalar representing the
+        number of chunks of `buffer_size` bytes to parse in parallel. Records
+        are produced in the same order as without it. If the value
+        `tf.data.AUTOTUNE` is used, the number is picked based on available
+        CPU. Defaults to parsing records sequentially.
 
     Raises:
        InvalidArgumentError: If exclude_cols is not None and
@@ -803,18 +809,35 @@ class CsvDatasetV2(dataset_ops.DatasetSource):
     )
     self._element_spec = tuple(
         tensor_spec.TensorSpec([], d.dtype) for d in self._record_defaults)
-    variant_tensor = gen_experimental_dataset_ops.csv_dataset_v2(
-        filenames=self._filenames,
-        record_defaults=self._record_defaults,
-        buffer_size=self._buffer_size,
-        header=self._header,
-        output_shapes=self._flat_shapes,
-        field_delim=self._field_delim,
-        use_quote_delim=self._use_quote_delim,
-        na_value=self._na_value,
-        select_cols=self._select_cols,
-        exclude_cols=self._exclude_cols,
-        compression_type=self._compression_type)
+    if num_parallel_calls is None:
+      variant_tensor = gen_experimental_dataset_ops.csv_dataset_v2(
+          filenames=self._filenames,
+          record_defaults=self._record_defaults,
+          buffer_size=self._buffer_size,
+          header=self._header,
+          output_shapes=self._flat_shapes,
+          field_delim=self._field_delim,
+          use_quote_delim=self._use_quote_delim,
+          na_value=self._na_value,
+          select_cols=self._select_cols,
+          exclude_cols=self._exclude_cols,
+          compression_type=self._compression_type)
+    else:
+      self._num_parallel_calls = ops.convert_to_tensor(
+          num_parallel_calls, dtype=dtypes.int64, name="num_parallel_calls")
+      variant_tensor = gen_experimental_dataset_ops.parallel_csv_dataset(
+          filenames=self._filenames,
+          record_defaults=self._record_defaults,
+          buffer_size=self._buffer_size,
+          header=self._header,
+          output_shapes=self._flat_shapes,
+          field_delim=self._field_delim,
+          use_quote_delim=self._use_quote_delim,
+          na_value=self._na_value,
+          select_cols=self._select_cols,
+          exclude_cols=self._exclude_cols,
+          num_parallel_calls=self._num_parallel_calls,
+          compression_type=self._compression_type)
     super(CsvDatasetV2, self).__init__(variant_tensor)
 
   @property
@@ -159,6 +159,7 @@ class OptionsTest(test_base.DatasetTestBase, parameterized.TestCase):
     options.experimental_optimization.map_and_filter_fusion = True
     options.experimental_optimization.map_fusion = True
     options.experimental_optimization.map_parallelization = True
+    options.experimental_optimization.map_vectorization = True
     options.experimental_optimization.noop_elimination = True
     options.experimental_optimization.parallel_batch = True
     options.experimental_optimization.shuffle_and_repeat_fusion = True
@@ -169,6 +170,7 @@ class OptionsTest(test_base.DatasetTestBase, parameterized.TestCase):
     options.framework_type = ["TFDS", "TfGrain"]
     options.threading.max_intra_op_parallelism = 30
     options.threading.private_threadpool_size = 40
+    options.threading.numa_node = 1
     pb = options._to_proto()
     result = options_lib.Options()
     result._from_proto(pb)
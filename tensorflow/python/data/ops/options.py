@@ -251,6 +251,18 @@ class AutotuneOptions(options_lib.OptionsBase):
       ),
   )
 
+  tunables_dir = options_lib.create_option(
+      name="tunables_dir",
+      ty=str,
+      docstring=(
+          "When autotuning is enabled (through `autotune`), the directory to"
+          " persist the tuned parameters of the input pipeline in. Later runs"
+          " of the same pipeline (identified by a fingerprint of its graph)"
+          " start autotuning from the persisted parameters instead of from"
+          " scratch. If None, the parameters are not persisted."
+      ),
+  )
+
   def _to_proto(self):
     pb = dataset_options_pb2.AutotuneOptions()
     if self.enabled is not None:
@@ -266,6 +278,8 @@ class AutotuneOptions(options_lib.OptionsBase):
       pb.initial_parallelism = self.initial_parallelism
     if self.min_parallelism is not None:
       pb.min_parallelism = self.min_parallelism
+    if self.tunables_dir is not None:
+      pb.tunables_dir = self.tunables_dir
     return pb
 
   def _from_proto(self, pb):
@@ -282,6 +296,8 @@ class AutotuneOptions(options_lib.OptionsBase):
       self.initial_parallelism = pb.initial_parallelism
     if pb.WhichOneof("optional_min_parallelism") is not None:
       self.min_parallelism = pb.min_parallelism
+    if pb.WhichOneof("optional_tunables_dir") is not None:
+      self.tunables_dir = pb.tunables_dir
 
   def _set_mutable(self, mutable):
     """Change the mutability value to `mutable` on this options and children."""
@@ -415,6 +431,14 @@ class OptimizationOptions(options_lib.OptionsBase):
       "Whether to parallelize stateless map transformations. If None, defaults "
       "to True.")
 
+  map_vectorization = options_lib.create_option(
+      name="map_vectorization",
+      ty=bool,
+      docstring=
+      "Whether to vectorize fused map and batch transformations whose map "
+      "function is elementwise, so that the function is invoked once per batch "
+      "instead of once per element. If None, defaults to False.")
+
   noop_elimination = options_lib.create_option(
       name="noop_elimination",
       ty=bool,
@@ -453,6 +477,8 @@ class OptimizationOptions(options_lib.OptionsBase):
       pb.map_fusion = self.map_fusion
     if self.map_parallelization is not None:
       pb.map_parallelization = self.map_parallelization
+    if self.map_vectorization is not None:
+      pb.map_vectorization = self.map_vectorization
     if self.noop_elimination is not None:
       pb.noop_elimination = self.noop_elimination
     if self.parallel_batch is not None:
@@ -480,6 +506,8 @@ class OptimizationOptions(options_lib.OptionsBase):
       self.map_fusion = pb.map_fusion
     if pb.WhichOneof("optional_map_parallelization") is not None:
       self.map_parallelization = pb.map_parallelization
+    if pb.WhichOneof("optional_map_vectorization") is not None:
+      self.map_vectorization = pb.map_vectorization
     if pb.WhichOneof("optional_noop_elimination") is not None:
       self.noop_elimination = pb.noop_elimination
     if pb.WhichOneof("optional_parallel_batch") is not None:
@@ -561,12 +589,24 @@ class ThreadingOptions(options_lib.OptionsBase):
       "The value 0 can be used to indicate that the threadpool size should be "
       "determined at runtime based on the number of available CPU cores.")
 
+  numa_node = options_lib.create_option(
+      name="numa_node",
+      ty=int,
+      docstring=
+      "If set, the threads of the dataset are pinned to the given NUMA node, "
+      "and its elements are allocated from memory of the node. The value -1 "
+      "selects the NUMA node of the device that the iterator runs on. Unless "
+      "`private_threadpool_size` is set, the dataset uses a private threadpool "
+      "with a thread for each CPU core of the node.")
+
   def _to_proto(self):
     pb = dataset_options_pb2.ThreadingOptions()
     if self.max_intra_op_parallelism is not None:
       pb.max_intra_op_parallelism = self.max_intra_op_parallelism
     if self.private_threadpool_size is not None:
       pb.private_threadpool_size = self.private_threadpool_size
+    if self.numa_node is not None:
+      pb.numa_node = self.numa_node
     return pb
 
   def _from_proto(self, pb):
@@ -574,6 +614,8 @@ class ThreadingOptions(options_lib.OptionsBase):
       self.max_intra_op_parallelism = pb.max_intra_op_parallelism
     if pb.WhichOneof("optional_private_threadpool_size") is not None:
       self.private_threadpool_size = pb.private_threadpool_size
+    if pb.WhichOneof("optional_numa_node") is not None:
+      self.numa_node = pb.numa_node
 
 
 @tf_export("data.Options")
@@ -3527,6 +3527,50 @@ class MutableHashTableOpTest(test.TestCase):
     self.assertAllEqual([b"brain", b"salad", b"surgery"], sorted_keys)
     self.assertAllEqual([0, 1, 2], sorted_values)
 
+  def testReadOptimizedMutableHashTable(self, is_anonymous):
+    if is_anonymous:
+      self.skipTest("Anonymous tables do not have a read-optimized mode.")
+    handle = gen_lookup_ops.mutable_hash_table_v2(
+        key_dtype=dtypes.int64,
+        value_dtype=dtypes.int64,
+        shared_name="read_optimized_table",
+        experimental_read_optimized=True)
+    keys = constant_op.constant([1, 2, 3], dtypes.int64)
+    values = constant_op.constant([10, 20, 30], dtypes.int64)
+    default_val = constant_op.constant(-1, dtypes.int64)
+
+    self.evaluate(gen_lookup_ops.lookup_table_insert_v2(handle, keys, values))
+    self.evaluate(
+        gen_lookup_ops.lookup_table_remove_v2(
+            handle, constant_op.constant([3], dtypes.int64)))
+    self.assertAllEqual(
+        2, self.evaluate(gen_lookup_ops.lookup_table_size_v2(handle)))
+
+    output = gen_lookup_ops.lookup_table_find_v2(
+        handle, constant_op.constant([1, 2, 3], dtypes.int64), default_val)
+    self.assertAllEqual([10, 20, -1], self.evaluate(output))
+
+  def testReadOptimizedMutableHashTableOfTensors(self, is_anonymous):
+    if is_anonymous:
+      self.skipTest("Anonymous tables do not have a read-optimized mode.")
+    handle = gen_lookup_ops.mutable_hash_table_of_tensors_v2(
+        key_dtype=dtypes.int64,
+        value_dtype=dtypes.int64,
+        value_shape=[2],
+        shared_name="read_optimized_table_of_tensors",
+        experimental_read_optimized=True)
+    keys = constant_op.constant([1, 2], dtypes.int64)
+    values = constant_op.constant([[10, 11], [20, 21]], dtypes.int64)
+    default_val = constant_op.constant([-1, -1], dtypes.int64)
+
+    self.evaluate(gen_lookup_ops.lookup_table_insert_v2(handle, keys, values))
+    self.assertAllEqual(
+        2, self.evaluate(gen_lookup_ops.lookup_table_size_v2(handle)))
+
+    output = gen_lookup_ops.lookup_table_find_v2(
+        handle, constant_op.constant([2, 3], dtypes.int64), default_val)
+    self.assertAllEqual([[20, 21], [-1, -1]], self.evaluate(output))
+
   # TODO(https://github.com/tensorflow/tensorflow/issues/24439): remove exepectedFailure when fixed
   @unittest.expectedFailure
   @test_util.run_v2_only
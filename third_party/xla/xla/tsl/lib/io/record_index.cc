@@ -0,0 +1,252 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/tsl/lib/io/record_index.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/status_macros.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "xla/tsl/lib/hash/crc32c.h"
+#include "xla/tsl/platform/env.h"
+#include "xla/tsl/platform/file_system.h"
+#include "tsl/platform/coding.h"
+#include "tsl/platform/raw_coding.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+constexpr char kIndexFileSuffix[] = ".index";
+constexpr size_t kMagicSize = 4;
+constexpr size_t kOffsetSize = sizeof(uint64_t);
+// Offsets are written to the file in batches of this many bytes.
+constexpr size_t kBufferSize = 64 << 10;
+
+// Every record is framed by a header of its length and the checksum of the
+// length, and a footer of the checksum of its payload.
+constexpr size_t kRecordHeaderSize = sizeof(uint64_t) + sizeof(uint32_t);
+constexpr uint64_t kRecordOverhead = kRecordHeaderSize + sizeof(uint32_t);
+
+// Reads exactly `n` bytes at `offset` of `file`. `*scratch` provides the
+// backing storage if the file system needs it.
+absl::Status ReadExactly(RandomAccessFile* file, uint64_t offset, size_t n,
+                         absl::string_view* result, char* scratch) {
+  absl::Status s = file->Read(offset, n, result, scratch);
+  if (absl::IsOutOfRange(s) || (s.ok() && result->size() != n)) {
+    return absl::DataLossError(absl::StrCat("Truncated file: expected ", n,
+                                            " bytes at offset ", offset,
+                                            ", got ", result->size()));
+  }
+  return s;
+}
+
+}  // namespace
+
+std::string RecordIndexFileName(absl::string_view filename) {
+  return absl::StrCat(filename, kIndexFileSuffix);
+}
+
+absl::Status RecordIndex::Read(RandomAccessFile* file, uint64_t file_size,
+                               std::unique_ptr<RecordIndex>* index) {
+  if (file_size < kHeaderSize + kFooterSize ||
+      (file_size - kHeaderSize - kFooterSize) % kOffsetSize != 0) {
+    return absl::DataLossError(
+        absl::StrCat("Record index has an invalid size: ", file_size));
+  }
+  std::string scratch(file_size, '\0');
+  absl::string_view contents;
+  ABSL_RETURN_IF_ERROR(
+      ReadExactly(file, 0, file_size, &contents, scratch.data()));
+
+  const char* header = contents.data();
+  const char* footer = contents.data() + file_size - kFooterSize;
+  if (std::memcmp(header, kMagic, kMagicSize) != 0 ||
+      std::memcmp(footer + 20, kMagic, kMagicSize) != 0) {
+    return absl::DataLossError("Not a record index: bad magic number");
+  }
+  const uint32_t version = core::DecodeFixed32(header + kMagicSize);
+  if (version != kVersion) {
+    return absl::DataLossError(
+        absl::StrCat("Unsupported record index version: ", version));
+  }
+  const uint32_t masked_crc = core::DecodeFixed32(footer + 16);
+  const size_t checksummed_size = file_size - kMagicSize - sizeof(uint32_t);
+  if (crc32c::Unmask(masked_crc) !=
+      crc32c::Value(contents.data(), checksummed_size)) {
+    return absl::DataLossError("Corrupted record index: checksum mismatch");
+  }
+
+  const uint64_t num_records = core::DecodeFixed64(footer);
+  const uint64_t data_file_size = core::DecodeFixed64(footer + 8);
+  if (num_records != (file_size - kHeaderSize - kFooterSize) / kOffsetSize) {
+    return absl::DataLossError(absl::StrCat(
+        "Corrupted record index: expected ", num_records, " records"));
+  }
+
+  auto result = absl::WrapUnique(new RecordIndex);
+  result->offsets_.resize(num_records + 1);
+  uint64_t min_offset = 0;
+  for (uint64_t i = 0; i < num_records; ++i) {
+    const uint64_t offset =
+        core::DecodeFixed64(contents.data() + kHeaderSize + i * kOffsetSize);
+    if (offset < min_offset) {
+      return absl::DataLossError(absl::StrCat(
+          "Corrupted record index: record ", i, " at offset ", offset,
+          " overlaps the previous record"));
+    }
+    result->offsets_[i] = offset;
+    min_offset = offset + kRecordOverhead;
+  }
+  if (data_file_size < min_offset) {
+    return absl::DataLossError(
+        absl::StrCat("Corrupted record index: data file size ", data_file_size,
+                     " is smaller than the indexed records"));
+  }
+  result->offsets_[num_records] = data_file_size;
+  *index = std::move(result);
+  return absl::OkStatus();
+}
+
+absl::Status RecordIndex::Read(Env* env, const std::string& filename,
+                               std::unique_ptr<RecordIndex>* index) {
+  uint64_t file_size;
+  ABSL_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  std::unique_ptr<RandomAccessFile> file;
+  ABSL_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  absl::Status s = Read(file.get(), file_size, index);
+  if (!s.ok()) {
+    return absl::Status(s.code(), absl::StrCat(s.message(), " in ", filename));
+  }
+  return absl::OkStatus();
+}
+
+uint64_t RecordIndex::record_length(int64_t i) const {
+  return offsets_[i + 1] - offsets_[i] - kRecordOverhead;
+}
+
+RecordIndexBuilder::RecordIndexBuilder(WritableFile* dest) : dest_(dest) {
+  buffer_.reserve(kBufferSize);
+  char header[RecordIndex::kHeaderSize];
+  std::memcpy(header, RecordIndex::kMagic, kMagicSize);
+  core::EncodeFixed32(header + kMagicSize, RecordIndex::kVersion);
+  buffer_.append(header, RecordIndex::kHeaderSize);
+}
+
+absl::Status RecordIndexBuilder::Append(absl::string_view data) {
+  buffer_.append(data.data(), data.size());
+  if (buffer_.size() >= kBufferSize) return FlushBuffer();
+  return absl::OkStatus();
+}
+
+absl::Status RecordIndexBuilder::FlushBuffer() {
+  crc_ = crc32c::Extend(crc_, buffer_.data(), buffer_.size());
+  absl::Status s = dest_->Append(buffer_);
+  buffer_.clear();
+  return s;
+}
+
+absl::Status RecordIndexBuilder::AddRecord(uint64_t offset) {
+  if (finished_) {
+    return absl::FailedPreconditionError("Record index is already finished");
+  }
+  char encoded[kOffsetSize];
+  core::EncodeFixed64(encoded, offset);
+  ++num_records_;
+  return Append(absl::string_view(encoded, kOffsetSize));
+}
+
+absl::Status RecordIndexBuilder::Finish(uint64_t data_file_size) {
+  if (finished_) {
+    return absl::FailedPreconditionError("Record index is already finished");
+  }
+  finished_ = true;
+  char footer[RecordIndex::kFooterSize];
+  core::EncodeFixed64(footer, num_records_);
+  core::EncodeFixed64(footer + 8, data_file_size);
+  buffer_.append(footer, 16);
+  ABSL_RETURN_IF_ERROR(FlushBuffer());
+  core::EncodeFixed32(footer + 16, crc32c::Mask(crc_));
+  std::memcpy(footer + 20, RecordIndex::kMagic, kMagicSize);
+  return dest_->Append(absl::string_view(footer + 16, 8));
+}
+
+absl::Status IndexedRecordReader::ParseRecord(int64_t i, const char* data,
+                                              tstring* record) const {
+  const uint64_t offset = index_->offset(i);
+  const uint64_t length = index_->record_length(i);
+  const uint32_t length_crc = core::DecodeFixed32(data + sizeof(uint64_t));
+  if (crc32c::Unmask(length_crc) != crc32c::Value(data, sizeof(uint64_t))) {
+    return absl::DataLossError(
+        absl::StrCat("corrupted record header at ", offset));
+  }
+  if (core::DecodeFixed64(data) != length) {
+    return absl::DataLossError(absl::StrCat(
+        "record at ", offset, " has length ", core::DecodeFixed64(data),
+        " but the record index expects ", length));
+  }
+  const char* payload = data + kRecordHeaderSize;
+  const uint32_t payload_crc = core::DecodeFixed32(payload + length);
+  if (crc32c::Unmask(payload_crc) != crc32c::Value(payload, length)) {
+    return absl::DataLossError(absl::StrCat("corrupted record at ", offset));
+  }
+  record->assign(payload, length);
+  return absl::OkStatus();
+}
+
+absl::Status IndexedRecordReader::ReadRecord(int64_t i,
+                                             tstring* record) const {
+  if (i < 0 || i >= num_records()) {
+    return absl::OutOfRangeError(absl::StrCat(
+        "Record ", i, " is out of range [0, ", num_records(), ")"));
+  }
+  const uint64_t n = index_->offset(i + 1) - index_->offset(i);
+  std::unique_ptr<char[]> scratch(new char[n]);
+  absl::string_view data;
+  ABSL_RETURN_IF_ERROR(
+      ReadExactly(file_, index_->offset(i), n, &data, scratch.get()));
+  return ParseRecord(i, data.data(), record);
+}
+
+absl::Status IndexedRecordReader::ReadRecords(
+    int64_t begin, int64_t end, std::vector<tstring>* records) const {
+  if (begin < 0 || begin > end || end > num_records()) {
+    return absl::OutOfRangeError(
+        absl::StrCat("Records [", begin, ", ", end, ") are out of range [0, ",
+                     num_records(), ")"));
+  }
+  records->resize(end - begin);
+  if (begin == end) return absl::OkStatus();
+  const uint64_t start = index_->offset(begin);
+  const uint64_t n = index_->offset(end) - start;
+  std::unique_ptr<char[]> scratch(new char[n]);
+  absl::string_view data;
+  ABSL_RETURN_IF_ERROR(ReadExactly(file_, start, n, &data, scratch.get()));
+  for (int64_t i = begin; i < end; ++i) {
+    ABSL_RETURN_IF_ERROR(ParseRecord(
+        i, data.data() + (index_->offset(i) - start), &(*records)[i - begin]));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
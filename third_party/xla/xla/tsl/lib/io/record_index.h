@@ -0,0 +1,144 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_TSL_LIB_IO_RECORD_INDEX_H_
+#define XLA_TSL_LIB_IO_RECORD_INDEX_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "xla/tsl/platform/env.h"
+#include "xla/tsl/platform/file_system.h"
+#include "tsl/platform/tstring.h"
+
+namespace tsl {
+namespace io {
+
+// An offset index of the records of an uncompressed TFRecord file, stored in a
+// sidecar file next to it (see RecordIndexFileName()).
+//
+// Format of the index file (all integers little-endian):
+//  char      magic[4] = "TFRI"
+//  uint32    version
+//  uint64    offset[num_records]   offset of each record in the data file
+//  uint64    num_records
+//  uint64    data file size
+//  uint32    masked crc32c of all the preceding bytes
+//  char      magic[4] = "TFRI"
+//
+// The footer is written last, so an index whose writer did not finish is
+// detected as corrupt, and the data file size detects an index that does not
+// belong to (the current version of) its data file.
+class RecordIndex {
+ public:
+  static constexpr char kMagic[] = "TFRI";
+  static constexpr uint32_t kVersion = 1;
+  static constexpr size_t kHeaderSize = 8;
+  static constexpr size_t kFooterSize = 24;
+
+  // Reads the index stored in `file`, which is `file_size` bytes long.
+  static absl::Status Read(RandomAccessFile* file, uint64_t file_size,
+                           std::unique_ptr<RecordIndex>* index);
+
+  // Reads the index stored in the file `filename`.
+  static absl::Status Read(Env* env, const std::string& filename,
+                           std::unique_ptr<RecordIndex>* index);
+
+  int64_t num_records() const { return offsets_.size() - 1; }
+  uint64_t data_file_size() const { return offsets_.back(); }
+
+  // Returns the offset of record `i` in the data file. `offset(num_records())`
+  // is the size of the data file.
+  uint64_t offset(int64_t i) const { return offsets_[i]; }
+
+  // Returns the length of the payload of record `i`.
+  uint64_t record_length(int64_t i) const;
+
+ private:
+  RecordIndex() = default;
+
+  // `num_records() + 1` entries, ending with the size of the data file.
+  std::vector<uint64_t> offsets_;
+};
+
+// Returns the name of the index of the TFRecord file `filename`.
+std::string RecordIndexFileName(absl::string_view filename);
+
+// Writes a RecordIndex to a file.
+class RecordIndexBuilder {
+ public:
+  // "*dest" must be initially empty and must remain live until Finish()
+  // returns.
+  explicit RecordIndexBuilder(WritableFile* dest);
+
+  // Adds the record that starts at `offset` in the data file.
+  absl::Status AddRecord(uint64_t offset);
+
+  // Writes the footer of the index. Does *not* close the WritableFile.
+  absl::Status Finish(uint64_t data_file_size);
+
+ private:
+  absl::Status Append(absl::string_view data);
+  absl::Status FlushBuffer();
+
+  WritableFile* dest_;
+  std::string buffer_;
+  uint64_t num_records_ = 0;
+  uint32_t crc_ = 0;
+  bool finished_ = false;
+
+  RecordIndexBuilder(const RecordIndexBuilder&) = delete;
+  void operator=(const RecordIndexBuilder&) = delete;
+};
+
+// Reads the records of an uncompressed TFRecord file by position, using its
+// RecordIndex.
+//
+// Unlike RecordReader, this class is thread-safe: it keeps no read position,
+// and every call issues its own reads to `file`, so several threads can read
+// (disjoint or overlapping) ranges of the same file in parallel.
+class IndexedRecordReader {
+ public:
+  // "*file" and "*index" must remain live while this reader is in use.
+  IndexedRecordReader(RandomAccessFile* file, const RecordIndex* index)
+      : file_(file), index_(index) {}
+
+  int64_t num_records() const { return index_->num_records(); }
+
+  // Reads record `i` into `*record`.
+  absl::Status ReadRecord(int64_t i, tstring* record) const;
+
+  // Reads records [begin, end) into `*records` with a single read of the
+  // underlying file.
+  absl::Status ReadRecords(int64_t begin, int64_t end,
+                           std::vector<tstring>* records) const;
+
+ private:
+  // Verifies the record `i` that starts at `data` and copies its payload into
+  // `*record`.
+  absl::Status ParseRecord(int64_t i, const char* data, tstring* record) const;
+
+  RandomAccessFile* const file_;
+  const RecordIndex* const index_;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // XLA_TSL_LIB_IO_RECORD_INDEX_H_
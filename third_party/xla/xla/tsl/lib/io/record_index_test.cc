@@ -0,0 +1,236 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/tsl/lib/io/record_index.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "xla/tsl/lib/io/record_reader.h"
+#include "xla/tsl/lib/io/record_writer.h"
+#include "xla/tsl/platform/env.h"
+#include "xla/tsl/platform/test.h"
+#include "xla/tsl/platform/test_benchmark.h"
+#include "tsl/platform/tstring.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+std::string TestFileName(const std::string& name) {
+  return absl::StrCat(testing::TmpDir(), "/record_index_test_", name);
+}
+
+std::vector<std::string> MakeRecords(int num_records) {
+  std::vector<std::string> records;
+  for (int i = 0; i < num_records; ++i) {
+    records.push_back(std::string(i % 37, 'a' + i % 26));
+  }
+  return records;
+}
+
+// Writes `records` to `filename` and its index to RecordIndexFileName().
+absl::Status WriteIndexedFile(const std::string& filename,
+                              const std::vector<std::string>& records) {
+  Env* env = Env::Default();
+  std::unique_ptr<WritableFile> file;
+  std::unique_ptr<WritableFile> index_file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+  TF_RETURN_IF_ERROR(
+      env->NewWritableFile(RecordIndexFileName(filename), &index_file));
+  RecordWriter writer(file.get(), index_file.get());
+  for (const std::string& record : records) {
+    TF_RETURN_IF_ERROR(writer.WriteRecord(record));
+  }
+  TF_RETURN_IF_ERROR(writer.Close());
+  TF_RETURN_IF_ERROR(file->Close());
+  return index_file->Close();
+}
+
+TEST(RecordIndexTest, WriterEmitsIndex) {
+  const std::string filename = TestFileName("emits");
+  const std::vector<std::string> records = MakeRecords(100);
+  TF_ASSERT_OK(WriteIndexedFile(filename, records));
+
+  std::unique_ptr<RecordIndex> index;
+  TF_ASSERT_OK(
+      RecordIndex::Read(Env::Default(), RecordIndexFileName(filename), &index));
+  ASSERT_EQ(records.size(), index->num_records());
+  uint64_t file_size;
+  TF_ASSERT_OK(Env::Default()->GetFileSize(filename, &file_size));
+  EXPECT_EQ(file_size, index->data_file_size());
+
+  // The offsets are the positions of the records seen by a sequential scan.
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(filename, &file));
+  SequentialRecordReader reader(file.get());
+  tstring record;
+  for (int64_t i = 0; i < index->num_records(); ++i) {
+    EXPECT_EQ(reader.TellOffset(), index->offset(i));
+    TF_ASSERT_OK(reader.ReadRecord(&record));
+    EXPECT_EQ(record.size(), index->record_length(i));
+  }
+}
+
+TEST(RecordIndexTest, IndexedReads) {
+  const std::string filename = TestFileName("reads");
+  const std::vector<std::string> records = MakeRecords(100);
+  TF_ASSERT_OK(WriteIndexedFile(filename, records));
+
+  std::unique_ptr<RecordIndex> index;
+  TF_ASSERT_OK(
+      RecordIndex::Read(Env::Default(), RecordIndexFileName(filename), &index));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(filename, &file));
+  IndexedRecordReader reader(file.get(), index.get());
+
+  tstring record;
+  for (int64_t i : {99, 0, 42, 1, 98}) {
+    TF_ASSERT_OK(reader.ReadRecord(i, &record));
+    EXPECT_EQ(records[i], record);
+  }
+  EXPECT_TRUE(absl::IsOutOfRange(reader.ReadRecord(100, &record)));
+  EXPECT_TRUE(absl::IsOutOfRange(reader.ReadRecord(-1, &record)));
+
+  std::vector<tstring> range;
+  TF_ASSERT_OK(reader.ReadRecords(10, 60, &range));
+  ASSERT_EQ(50, range.size());
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_EQ(records[10 + i], range[i]);
+  }
+  TF_ASSERT_OK(reader.ReadRecords(5, 5, &range));
+  EXPECT_TRUE(range.empty());
+  EXPECT_TRUE(absl::IsOutOfRange(reader.ReadRecords(90, 101, &range)));
+}
+
+TEST(RecordIndexTest, EmptyFile) {
+  const std::string filename = TestFileName("empty");
+  TF_ASSERT_OK(WriteIndexedFile(filename, {}));
+  std::unique_ptr<RecordIndex> index;
+  TF_ASSERT_OK(
+      RecordIndex::Read(Env::Default(), RecordIndexFileName(filename), &index));
+  EXPECT_EQ(0, index->num_records());
+  EXPECT_EQ(0, index->data_file_size());
+}
+
+TEST(RecordIndexTest, CompressedFilesCannotBeIndexed) {
+  const std::string filename = TestFileName("compressed");
+  std::unique_ptr<WritableFile> file;
+  std::unique_ptr<WritableFile> index_file;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(filename, &file));
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(RecordIndexFileName(filename),
+                                               &index_file));
+  RecordWriter writer(file.get(), index_file.get(),
+                      RecordWriterOptions::CreateRecordWriterOptions("ZLIB"));
+  EXPECT_TRUE(absl::IsInvalidArgument(writer.WriteRecord("abc")));
+}
+
+TEST(RecordIndexTest, RejectsCorruptIndexes) {
+  const std::string filename = TestFileName("corrupt_index");
+  TF_ASSERT_OK(WriteIndexedFile(filename, MakeRecords(10)));
+  const std::string index_filename = RecordIndexFileName(filename);
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), index_filename, &contents));
+
+  std::unique_ptr<RecordIndex> index;
+  // An index whose writer did not finish.
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), index_filename,
+                                 contents.substr(0, contents.size() - 8)));
+  EXPECT_TRUE(absl::IsDataLoss(
+      RecordIndex::Read(Env::Default(), index_filename, &index)));
+
+  std::string corrupt = contents;
+  corrupt[RecordIndex::kHeaderSize + 8] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), index_filename, corrupt));
+  EXPECT_TRUE(absl::IsDataLoss(
+      RecordIndex::Read(Env::Default(), index_filename, &index)));
+}
+
+TEST(RecordIndexTest, DetectsCorruptRecords) {
+  const std::string filename = TestFileName("corrupt_records");
+  const std::vector<std::string> records = MakeRecords(10);
+  TF_ASSERT_OK(WriteIndexedFile(filename, records));
+  std::unique_ptr<RecordIndex> index;
+  TF_ASSERT_OK(
+      RecordIndex::Read(Env::Default(), RecordIndexFileName(filename), &index));
+
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  contents[index->offset(5) + RecordWriter::kHeaderSize] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, contents));
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(filename, &file));
+  IndexedRecordReader reader(file.get(), index.get());
+  tstring record;
+  TF_EXPECT_OK(reader.ReadRecord(4, &record));
+  EXPECT_TRUE(absl::IsDataLoss(reader.ReadRecord(5, &record)));
+  std::vector<tstring> range;
+  EXPECT_TRUE(absl::IsDataLoss(reader.ReadRecords(0, 10, &range)));
+}
+
+constexpr int kBenchmarkRecords = 10000;
+
+const std::string& BenchmarkFile() {
+  static const std::string* filename = [] {
+    auto* filename = new std::string(TestFileName("benchmark"));
+    TF_CHECK_OK(WriteIndexedFile(*filename, MakeRecords(kBenchmarkRecords)));
+    return filename;
+  }();
+  return *filename;
+}
+
+// Reads records at random positions by scanning from the start of the file,
+// as required without an index.
+void BM_RandomReadsWithoutIndex(::testing::benchmark::State& state) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(Env::Default()->NewRandomAccessFile(BenchmarkFile(), &file));
+  int64_t i = 0;
+  tstring record;
+  for (auto s : state) {
+    i = (i + 7919) % kBenchmarkRecords;
+    SequentialRecordReader reader(file.get());
+    int num_skipped;
+    TF_CHECK_OK(reader.SkipRecords(i, &num_skipped));
+    TF_CHECK_OK(reader.ReadRecord(&record));
+  }
+}
+BENCHMARK(BM_RandomReadsWithoutIndex);
+
+// Reads records at random positions through the index.
+void BM_RandomReadsWithIndex(::testing::benchmark::State& state) {
+  std::unique_ptr<RecordIndex> index;
+  TF_CHECK_OK(RecordIndex::Read(Env::Default(),
+                                RecordIndexFileName(BenchmarkFile()), &index));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(Env::Default()->NewRandomAccessFile(BenchmarkFile(), &file));
+  IndexedRecordReader reader(file.get(), index.get());
+  int64_t i = 0;
+  tstring record;
+  for (auto s : state) {
+    i = (i + 7919) % kBenchmarkRecords;
+    TF_CHECK_OK(reader.ReadRecord(i, &record));
+  }
+}
+BENCHMARK(BM_RandomReadsWithIndex);
+
+}  // namespace
+}  // namespace io
+}  // namespace tsl
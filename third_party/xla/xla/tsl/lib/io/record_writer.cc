@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "xla/tsl/lib/io/record_writer.h"
 
+#include <memory>
+
+#include "absl/status/status.h"
 #include "absl/status/status_macros.h"
 #include "xla/tsl/lib/hash/crc32c.h"
 #include "xla/tsl/lib/io/compression.h"
@@ -87,6 +90,17 @@ RecordWriter::RecordWriter(WritableFile* dest,
 #endif
 }
 
+RecordWriter::RecordWriter(WritableFile* dest, WritableFile* index_dest,
+                           const RecordWriterOptions& options)
+    : RecordWriter(dest, options) {
+  if (options.compression_type != RecordWriterOptions::NONE) {
+    index_status_ = absl::InvalidArgumentError(
+        "Record indexes are only supported for uncompressed files");
+    return;
+  }
+  index_builder_ = std::make_unique<RecordIndexBuilder>(index_dest);
+}
+
 RecordWriter::~RecordWriter() {
   if (dest_ != nullptr) {
     absl::Status s = Close();
@@ -96,11 +110,21 @@ RecordWriter::~RecordWriter() {
   }
 }
 
+absl::Status RecordWriter::IndexRecord(size_t n) {
+  ABSL_RETURN_IF_ERROR(index_status_);
+  if (index_builder_ != nullptr) {
+    ABSL_RETURN_IF_ERROR(index_builder_->AddRecord(offset_));
+  }
+  offset_ += kHeaderSize + n + kFooterSize;
+  return absl::OkStatus();
+}
+
 absl::Status RecordWriter::WriteRecord(absl::string_view data) {
   if (dest_ == nullptr) {
     return absl::Status(absl::StatusCode::kFailedPrecondition,
                         "Writer not initialized or previously closed");
   }
+  ABSL_RETURN_IF_ERROR(IndexRecord(data.size()));
   // Format of a single record:
   //  uint64    length
   //  uint32    masked crc of length
@@ -121,6 +145,7 @@ absl::Status RecordWriter::WriteRecord(const absl::Cord& data) {
     return absl::Status(absl::StatusCode::kFailedPrecondition,
                         "Writer not initialized or previously closed");
   }
+  ABSL_RETURN_IF_ERROR(IndexRecord(data.size()));
   // Format of a single record:
   //  uint64    length
   //  uint32    masked crc of length
@@ -138,6 +163,11 @@ absl::Status RecordWriter::WriteRecord(const absl::Cord& data) {
 
 absl::Status RecordWriter::Close() {
   if (dest_ == nullptr) return absl::OkStatus();
+  if (index_builder_ != nullptr) {
+    absl::Status s = index_builder_->Finish(offset_);
+    index_builder_.reset();
+    ABSL_RETURN_IF_ERROR(s);
+  }
   if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
     absl::Status s = dest_->Close();
     delete dest_;
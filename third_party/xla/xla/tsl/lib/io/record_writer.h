@@ -16,7 +16,11 @@ limitations under the License.
 #ifndef XLA_TSL_LIB_IO_RECORD_WRITER_H_
 #define XLA_TSL_LIB_IO_RECORD_WRITER_H_
 
+#include <cstdint>
+#include <memory>
+
 #include "xla/tsl/lib/hash/crc32c.h"
+#include "xla/tsl/lib/io/record_index.h"
 #include "xla/tsl/platform/status.h"
 #include "tsl/platform/coding.h"
 #include "tsl/platform/stringpiece.h"
@@ -71,6 +75,14 @@ class RecordWriter {
   explicit RecordWriter(WritableFile* dest, const RecordWriterOptions& options =
                                                 RecordWriterOptions());
 
+  // Create a writer that will append data to "*dest", and a RecordIndex of
+  // the records to "*index_dest" (see record_index.h). The index is completed
+  // by Close(). Indexes are only supported for uncompressed files.
+  // "*dest" and "*index_dest" must be initially empty.
+  // "*dest" and "*index_dest" must remain live while this Writer is in use.
+  RecordWriter(WritableFile* dest, WritableFile* index_dest,
+               const RecordWriterOptions& options = RecordWriterOptions());
+
   // Calls Close() and logs if an error occurs.
   //
   // TODO(jhseu): Require that callers explicitly call Close() and remove the
@@ -88,7 +100,8 @@ class RecordWriter {
   // WritableFile.
   absl::Status Flush();
 
-  // Writes all output to the file. Does *not* close the WritableFile.
+  // Writes all output to the file, and the footer of the index if there is
+  // one. Does *not* close the WritableFiles.
   //
   // After calling Close(), any further calls to `WriteRecord()` or `Flush()`
   // are invalid.
@@ -111,9 +124,18 @@ class RecordWriter {
 #endif
 
  private:
+  // Adds the record about to be written to the index, if any, and advances
+  // `offset_` past it.
+  absl::Status IndexRecord(size_t n);
+
   WritableFile* dest_;
   RecordWriterOptions options_;
 
+  // Offset of the next record in the (uncompressed) output.
+  uint64_t offset_ = 0;
+  std::unique_ptr<RecordIndexBuilder> index_builder_;
+  absl::Status index_status_;
+
   inline static uint32_t MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
   }